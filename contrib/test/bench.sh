@@ -0,0 +1,77 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# the common part of the benchmark scripts, which are run from the source
+# root; BINARY, PORT and DURATION may be set in the environment, the name
+# NGINX is not used as nginx takes the inherited sockets from it
+
+BINARY=${BINARY:-objs/nginx}
+PORT=${PORT:-8180}
+DURATION=${DURATION:-10}
+
+LOAD=objs/test/http_load
+
+
+ngx_prefix() {
+    prefix=objs/test/$1
+
+    rm -rf $prefix
+    mkdir -p $prefix/conf $prefix/logs $prefix/html
+}
+
+
+ngx_start() {
+    ${1:-$BINARY} -p $prefix/ -c conf/nginx.conf || exit 1
+
+    for n in 1 2 3 4 5 6 7 8 9 10; do
+        test -s $prefix/logs/nginx.pid && return
+        sleep 0.1
+    done
+
+    echo "nginx has not started, see $prefix/logs/error.log"
+    exit 1
+}
+
+
+ngx_stop() {
+    pid=`cat $prefix/logs/nginx.pid`
+
+    kill -QUIT $pid
+
+    while kill -0 $pid 2>/dev/null; do
+        sleep 0.1
+    done
+
+    if grep -q '\[alert\]\|\[crit\]\|\[emerg\]' $prefix/logs/error.log; then
+        echo "errors in $prefix/logs/error.log"
+        exit 1
+    fi
+}
+
+
+ngx_rss() {
+    # the total resident memory of the worker processes, in kilobytes
+
+    for pid in `pgrep -P \`cat $prefix/logs/nginx.pid\``; do
+        grep '^VmRSS' /proc/$pid/status
+    done | awk '{ n += $2 } END { print n }'
+}
+
+
+ngx_cpu() {
+    # the total CPU time of the worker processes, in clock ticks
+
+    for pid in `pgrep -P \`cat $prefix/logs/nginx.pid\``; do
+        cat /proc/$pid/stat
+    done | awk '{ n += $14 + $15 } END { print n }'
+}
+
+
+ngx_faults() {
+    # the total minor page faults of the worker processes
+
+    for pid in `pgrep -P \`cat $prefix/logs/nginx.pid\``; do
+        cat /proc/$pid/stat
+    done | awk '{ n += $10 } END { print n }'
+}
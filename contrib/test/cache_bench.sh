@@ -0,0 +1,99 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# the throughput of proxy_cache hits with several worker processes looking
+# up random keys in one keys zone split into 1, 4 and 16 shards; if BASE is
+# set to a binary built before the shards, the old design with a single
+# lock and an LRU queue relinked on each hit is measured first
+#
+# WORKERS sets the number of worker processes, 4 by default, CLIENTS the
+# number of http_load processes, 4 by default, and KEYS the number of
+# cached keys, 10000 by default
+
+. contrib/test/bench.sh
+
+WORKERS=${WORKERS:-4}
+CLIENTS=${CLIENTS:-4}
+KEYS=${KEYS:-10000}
+
+if ! grep -q 'ngx_http_proxy_module' objs/ngx_modules.c; then
+    echo "cache_bench: skipped, nginx is built without the proxy module"
+    exit 0
+fi
+
+ngx_prefix cache
+
+echo 'a cached response' > $prefix/html/data
+
+
+cache_bench() {
+    nginx=$1
+    shards=$2
+
+    rm -rf $prefix/cache
+
+    cat > $prefix/conf/nginx.conf << END
+worker_processes  $WORKERS;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  1024;
+}
+
+http {
+    access_log  off;
+
+    proxy_cache_path  cache  levels=1:2  keys_zone=one:64m $shards;
+
+    server {
+        listen  127.0.0.1:$PORT;
+
+        location / {
+            proxy_pass         http://127.0.0.1:$(($PORT + 1))/;
+            proxy_cache        one;
+            proxy_cache_key    \$uri;
+            proxy_cache_valid  200  1h;
+        }
+    }
+
+    server {
+        listen  127.0.0.1:$(($PORT + 1));
+
+        location / {
+            root       html;
+            try_files  /data  =404;
+        }
+    }
+}
+END
+
+    ngx_start $nginx
+
+    # request each key once to fill the cache
+
+    $LOAD -c 16 -d 600 -n $KEYS -s 127.0.0.1:$PORT '/$n' > /dev/null
+
+    n=0
+    while [ $n -lt $CLIENTS ]; do
+        $LOAD -c 16 -d $DURATION -n $KEYS 127.0.0.1:$PORT '/$n' \
+              > $prefix/load.$n &
+        n=$(($n + 1))
+    done
+
+    wait
+
+    ngx_stop
+
+    echo "${shards:-old design}:" \
+         `cat $prefix/load.* | awk '{ n += $3 } END { print n }'` rps
+}
+
+
+if [ -n "$BASE" ]; then
+    cache_bench $BASE ""
+fi
+
+for shards in 1 4 16; do
+    cache_bench $BINARY shards=$shards
+done
@@ -0,0 +1,153 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# the configuration load time and the memory of a geo "ranges" base with
+# 1000000 IPv4 and 100000 IPv6 ranges in an included file, parsed from
+# the text and mapped from the binary base made by the first load; the
+# load time is that of "nginx -t", the memory is that of the master and
+# 4 worker processes after the workers have looked up addresses over all
+# of the IPv4 ranges for DURATION seconds; if BASE is set to a binary
+# built before the bases were mapped, it is measured as well, with IPv4
+# ranges only
+
+. contrib/test/bench.sh
+
+if ! grep -q 'ngx_http_geo_module' objs/ngx_modules.c; then
+    echo "geo_bench: skipped, nginx is built without geo"
+    exit 0
+fi
+
+RANGES=${RANGES:-1000000}
+
+if [ $RANGES -ge 1048576 ]; then
+    echo "geo_bench: RANGES must be less than 1048576"
+    exit 1
+fi
+RANGES6=${RANGES6:-100000}
+WORKERS=${WORKERS:-4}
+
+
+geo_bench() {
+    binary=$1
+    ranges6=$2
+
+    ngx_prefix geo
+
+    awk -v n=$RANGES -v n6=$ranges6 'BEGIN {
+        for (i = 0; i < n; i++) {
+            s = (i + 1) * 4096
+            e = s + 4095
+
+            printf("%d.%d.%d.%d-%d.%d.%d.%d v%d;\n",
+                   int(s / 16777216), int(s / 65536) % 256,
+                   int(s / 256) % 256, s % 256,
+                   int(e / 16777216), int(e / 65536) % 256,
+                   int(e / 256) % 256, e % 256, i % 200)
+        }
+
+        for (i = 0; i < n6; i++) {
+            printf("%x:%x::-%x:%x:ffff:ffff:ffff:ffff:ffff:ffff v%d;\n",
+                   8192 + int(i / 65536), i % 65536,
+                   8192 + int(i / 65536), i % 65536, i % 200)
+        }
+    }' > $prefix/conf/geo.conf
+
+    echo ok > $prefix/html/index.html
+
+    # the lookups are spread over all of the IPv4 ranges
+
+    uris=`awk 'BEGIN {
+        for (i = 0; i < 256; i += 4) print "/?ip=" i ".$n.0.1"
+    }'`
+
+    for mode in text binary; do
+
+        # an entry before the included file disables the binary base
+
+        if [ $mode = text ]; then
+            outside="0.0.0.0-0.0.15.255 ZZ;"
+        else
+            outside=
+        fi
+
+        cat > $prefix/conf/nginx.conf << END
+worker_processes  $WORKERS;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  1024;
+}
+
+http {
+    access_log  off;
+
+    geo \$arg_ip \$geo {
+        ranges;
+        default  ZZ;
+        $outside
+        include  geo.conf;
+    }
+
+    server {
+        listen  127.0.0.1:$PORT;
+
+        location / {
+            root        html;
+            add_header  X-Geo  \$geo;
+        }
+    }
+}
+END
+
+        if [ $mode = binary ]; then
+            start=`date +%s%N`
+            $binary -p $prefix/ -c conf/nginx.conf -t 2>/dev/null || exit 1
+            compile=$(((`date +%s%N` - $start) / 1000000))
+
+            if ! [ -f $prefix/conf/geo.conf.bin ]; then
+                echo "geo_bench: the binary base is not created"
+                exit 1
+            fi
+        fi
+
+        start=`date +%s%N`
+        $binary -p $prefix/ -c conf/nginx.conf -t 2>/dev/null || exit 1
+        load=$(((`date +%s%N` - $start) / 1000000))
+
+        ngx_start $binary
+
+        $LOAD -c $WORKERS -d $DURATION -n 256 127.0.0.1:$PORT $uris \
+              > $prefix/load
+
+        master=`cat $prefix/logs/nginx.pid`
+
+        anon=`awk '/^Anonymous/ { print $2 }' /proc/$master/smaps_rollup`
+        file=`awk '/^Pss_File/ { print $2 }' /proc/$master/smaps_rollup`
+
+        workers=`for pid in \`pgrep -P $master\`; do
+                     cat /proc/$pid/smaps_rollup
+                 done | awk '/^Private_/ { n += $2 } END { print n }'`
+
+        total=`for pid in $master \`pgrep -P $master\`; do
+                   cat /proc/$pid/smaps_rollup
+               done | awk '/^Pss:/ { n += $2 } END { print n }'`
+
+        ngx_stop
+
+        echo "${binary}, $mode:" \
+             ${compile:+"binary base made in ${compile}ms,"} \
+             "load ${load}ms; master anonymous ${anon}k, file ${file}k;" \
+             "workers private ${workers}k; total pss ${total}k;" \
+             `awk '{ print $3 }' $prefix/load` lookups/s
+
+        compile=
+    done
+}
+
+
+if [ -n "$BASE" ]; then
+    geo_bench $BASE 0
+fi
+
+geo_bench $BINARY $RANGES6
@@ -0,0 +1,91 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# compares gzip responses without the deflate state cache, "gzip_states 0",
+# and with it, on one worker process: 64 connections request 1k and 32k
+# files; the worker CPU time per response shows the cost of setting up
+# a deflate state, along with the page faults, and the resident memory is
+# sampled in the middle of a run
+
+. contrib/test/bench.sh
+
+if ! grep -q 'ngx_http_gzip_filter_module' objs/ngx_modules.c; then
+    echo "gzip_bench: skipped, nginx is built without gzip"
+    exit 0
+fi
+
+ngx_prefix gzip
+
+for size in 1 32; do
+    awk -v n=$(($size * 16)) 'BEGIN {
+        for (i = 0; i < n; i++) {
+            printf("%04d the quick brown fox jumps over the lazy dog %08x\n",
+                   i, i * 2654435761 % 4294967296)
+        }
+    }' > $prefix/html/$size.txt
+done
+
+tick=`getconf CLK_TCK`
+
+
+for states in 0 16; do
+
+    cat > $prefix/conf/nginx.conf << END
+worker_processes  1;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  1024;
+}
+
+http {
+    access_log  off;
+
+    gzip              on;
+    gzip_types        text/plain;
+    gzip_comp_level   1;
+    gzip_min_length   0;
+    gzip_states       $states;
+
+    types {
+        text/plain  txt;
+    }
+
+    server {
+        listen  127.0.0.1:$PORT;
+
+        location / {
+            root  html;
+        }
+    }
+}
+END
+
+    ngx_start
+
+    for size in 1 32; do
+        cpu=`ngx_cpu`
+        faults=`ngx_faults`
+
+        $LOAD -c 64 -d $DURATION -H 'Accept-Encoding: gzip' \
+              127.0.0.1:$PORT /$size.txt > $prefix/load &
+
+        sleep $(($DURATION / 2))
+        rss=`ngx_rss`
+
+        wait
+
+        cpu=$((`ngx_cpu` - $cpu))
+        faults=$((`ngx_faults` - $faults))
+        requests=`awk '{ print $2 + 0 }' $prefix/load`
+
+        echo "gzip_states $states, ${size}k:" `cat $prefix/load`
+        echo "    per response: worker cpu" \
+             "$(($cpu * 1000000 / $tick / $requests)) us," \
+             "page faults $(($faults * 1000 / $requests))/1000;" \
+             "worker rss ${rss}k"
+    done
+
+    ngx_stop
+done
@@ -0,0 +1,807 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * an HTTP/1.1 load generator for the benchmark scripts
+ *
+ *     http_load [-c connections] [-d seconds] [-n keys] [-s] [-k]
+ *               [-H header] address uri ...
+ *
+ * each connection sends a request, reads the whole response, and sends
+ * the next one; the uris are taken in turn, "$n" in an uri is replaced
+ * with a random number from 0 to keys - 1; with -s the keys are taken in
+ * turn, and the load stops after as many responses as there are keys,
+ * for example to fill a cache; with -k a new connection is made for each
+ * request
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_test.h>
+#include <poll.h>
+
+
+#define NGX_HTTP_LOAD_CONNECT       0
+#define NGX_HTTP_LOAD_SEND          1
+#define NGX_HTTP_LOAD_HEADER        2
+#define NGX_HTTP_LOAD_BODY          3
+#define NGX_HTTP_LOAD_CHUNK_SIZE    4
+#define NGX_HTTP_LOAD_CHUNK         5
+#define NGX_HTTP_LOAD_CHUNK_END     6
+#define NGX_HTTP_LOAD_LAST_CHUNK    7
+
+#define NGX_HTTP_LOAD_BUFFER        16384
+#define NGX_HTTP_LOAD_MAX_URIS      64
+
+
+typedef struct {
+    ngx_socket_t             fd;
+    ngx_uint_t               state;
+
+    u_char                   request[2048];
+    size_t                   size;
+    size_t                   sent;
+
+    u_char                   buf[NGX_HTTP_LOAD_BUFFER];
+    size_t                   len;
+
+    off_t                    rest;
+    ngx_uint_t               close;
+    ngx_uint_t               requests;
+
+    uint64_t                 start;
+} ngx_http_load_conn_t;
+
+
+typedef struct {
+    ngx_url_t                url;
+
+    ngx_uint_t               connections;
+    ngx_uint_t               seconds;
+    ngx_uint_t               keys;
+    ngx_uint_t               sequential;
+    ngx_uint_t               close;
+
+    ngx_str_t                uris[NGX_HTTP_LOAD_MAX_URIS];
+    ngx_uint_t               nuris;
+    ngx_uint_t               next;
+    ngx_uint_t               key;
+
+    u_char                   headers[1024];
+    u_char                  *last;
+
+    ngx_uint_t               requests;
+    ngx_uint_t               failed;
+    ngx_uint_t               errors;
+    off_t                    bytes;
+
+    ngx_array_t              latency;
+} ngx_http_load_t;
+
+
+static ngx_int_t ngx_http_load_options(ngx_http_load_t *hl, int argc,
+    char *const *argv);
+static ngx_int_t ngx_http_load_connect(ngx_http_load_t *hl,
+    ngx_http_load_conn_t *c);
+static void ngx_http_load_request(ngx_http_load_t *hl,
+    ngx_http_load_conn_t *c);
+static ngx_int_t ngx_http_load_send(ngx_http_load_conn_t *c);
+static ngx_int_t ngx_http_load_recv(ngx_http_load_t *hl,
+    ngx_http_load_conn_t *c);
+static ngx_int_t ngx_http_load_parse(ngx_http_load_t *hl,
+    ngx_http_load_conn_t *c);
+static ngx_int_t ngx_http_load_parse_header(ngx_http_load_t *hl,
+    ngx_http_load_conn_t *c);
+static void ngx_http_load_close(ngx_http_load_conn_t *c);
+static void ngx_http_load_report(ngx_http_load_t *hl, uint64_t time);
+static int ngx_libc_cdecl ngx_http_load_cmp(const void *one,
+    const void *two);
+
+
+static ngx_http_load_t  ngx_http_load;
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    int                    n;
+    uint64_t               start, end, now;
+    ngx_uint_t             i;
+    ngx_log_t             *log;
+    struct pollfd         *pfd;
+    ngx_http_load_t       *hl;
+    ngx_http_load_conn_t  *c, *conns;
+
+    log = ngx_test_init(argc, argv);
+    if (log == NULL) {
+        return 1;
+    }
+
+    hl = &ngx_http_load;
+
+    if (ngx_http_load_options(hl, argc, argv) != NGX_OK) {
+        ngx_log_stderr(0, "usage: http_load [-c connections] [-d seconds] "
+                       "[-n keys] [-s] [-k] [-H header] address uri ...");
+        return 1;
+    }
+
+    if (ngx_array_init(&hl->latency, ngx_cycle->pool, 65536, sizeof(uint32_t))
+        != NGX_OK)
+    {
+        return 1;
+    }
+
+    conns = ngx_calloc(hl->connections * sizeof(ngx_http_load_conn_t), log);
+    pfd = ngx_calloc(hl->connections * sizeof(struct pollfd), log);
+
+    if (conns == NULL || pfd == NULL) {
+        return 1;
+    }
+
+    for (i = 0; i < hl->connections; i++) {
+        conns[i].fd = (ngx_socket_t) -1;
+    }
+
+    start = ngx_test_nsec();
+    end = start + (uint64_t) hl->seconds * 1000000000;
+
+    for ( ;; ) {
+
+        for (i = 0; i < hl->connections; i++) {
+            c = &conns[i];
+
+            if (c->fd == (ngx_socket_t) -1
+                && ngx_http_load_connect(hl, c) != NGX_OK)
+            {
+                return 1;
+            }
+
+            pfd[i].fd = c->fd;
+            pfd[i].events = (c->state == NGX_HTTP_LOAD_CONNECT
+                             || c->state == NGX_HTTP_LOAD_SEND)
+                            ? POLLOUT : POLLIN;
+            pfd[i].revents = 0;
+        }
+
+        now = ngx_test_nsec();
+
+        if (now >= end) {
+            break;
+        }
+
+        if (hl->sequential && hl->requests >= hl->keys) {
+            break;
+        }
+
+        n = poll(pfd, hl->connections, (end - now) / 1000000 + 1);
+
+        if (n == -1) {
+            if (ngx_errno == NGX_EINTR) {
+                continue;
+            }
+
+            ngx_log_stderr(ngx_errno, "poll() failed");
+            return 1;
+        }
+
+        for (i = 0; i < hl->connections && n; i++) {
+            if (pfd[i].revents == 0) {
+                continue;
+            }
+
+            n--;
+            c = &conns[i];
+
+            if (c->state == NGX_HTTP_LOAD_CONNECT) {
+                if (pfd[i].revents & (POLLERR|POLLHUP)) {
+                    hl->errors++;
+                    ngx_http_load_close(c);
+                    continue;
+                }
+
+                c->state = NGX_HTTP_LOAD_SEND;
+            }
+
+            if (c->state == NGX_HTTP_LOAD_SEND) {
+                if (ngx_http_load_send(c) == NGX_ERROR) {
+                    hl->errors++;
+                    ngx_http_load_close(c);
+                }
+
+                continue;
+            }
+
+            if (ngx_http_load_recv(hl, c) == NGX_ERROR) {
+                hl->errors++;
+                ngx_http_load_close(c);
+            }
+        }
+    }
+
+    ngx_http_load_report(hl, ngx_test_nsec() - start);
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_http_load_options(ngx_http_load_t *hl, int argc, char *const *argv)
+{
+    u_char     *p;
+    ngx_int_t   n;
+    ngx_uint_t  i;
+
+    hl->connections = 10;
+    hl->seconds = 10;
+    hl->keys = 1;
+    hl->last = hl->headers;
+
+    for (i = 1; i < (ngx_uint_t) argc; i++) {
+
+        p = (u_char *) argv[i];
+
+        if (*p != '-') {
+            break;
+        }
+
+        if (p[1] == 'k' && p[2] == '\0') {
+            hl->close = 1;
+            continue;
+        }
+
+        if (p[1] == 's' && p[2] == '\0') {
+            hl->sequential = 1;
+            continue;
+        }
+
+        if (p[2] != '\0' || i + 1 == (ngx_uint_t) argc) {
+            return NGX_ERROR;
+        }
+
+        p = (u_char *) argv[++i];
+
+        switch (argv[i - 1][1]) {
+
+        case 'H':
+            if (hl->last + ngx_strlen(p) + 2 > hl->headers + 1024) {
+                return NGX_ERROR;
+            }
+
+            hl->last = ngx_sprintf(hl->last, "%s" CRLF, p);
+            continue;
+
+        case 'c':
+        case 'd':
+        case 'n':
+            n = ngx_atoi(p, ngx_strlen(p));
+
+            if (n <= 0) {
+                return NGX_ERROR;
+            }
+
+            if (argv[i - 1][1] == 'c') {
+                hl->connections = n;
+
+            } else if (argv[i - 1][1] == 'd') {
+                hl->seconds = n;
+
+            } else {
+                hl->keys = n;
+            }
+
+            continue;
+
+        default:
+            return NGX_ERROR;
+        }
+    }
+
+    if (i + 1 >= (ngx_uint_t) argc) {
+        return NGX_ERROR;
+    }
+
+    hl->url.url.data = (u_char *) argv[i];
+    hl->url.url.len = ngx_strlen(argv[i]);
+    hl->url.default_port = 80;
+
+    if (ngx_parse_url(ngx_cycle->pool, &hl->url) != NGX_OK) {
+        if (hl->url.err) {
+            ngx_log_stderr(0, "%s in \"%V\"", hl->url.err, &hl->url.url);
+        }
+
+        return NGX_ERROR;
+    }
+
+    if (hl->url.naddrs == 0) {
+        return NGX_ERROR;
+    }
+
+    for (i++; i < (ngx_uint_t) argc; i++) {
+        if (hl->nuris == NGX_HTTP_LOAD_MAX_URIS || ngx_strlen(argv[i]) > 1024) {
+            return NGX_ERROR;
+        }
+
+        hl->uris[hl->nuris].data = (u_char *) argv[i];
+        hl->uris[hl->nuris].len = ngx_strlen(argv[i]);
+        hl->nuris++;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_load_connect(ngx_http_load_t *hl, ngx_http_load_conn_t *c)
+{
+    int           tcp_nodelay;
+    ngx_err_t     err;
+    ngx_socket_t  s;
+
+    s = ngx_socket(hl->url.addrs[0].sockaddr->sa_family, SOCK_STREAM, 0);
+
+    if (s == (ngx_socket_t) -1) {
+        ngx_log_stderr(ngx_socket_errno, ngx_socket_n " failed");
+        return NGX_ERROR;
+    }
+
+    tcp_nodelay = 1;
+
+    (void) setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const void *) &tcp_nodelay,
+                      sizeof(int));
+
+    if (ngx_nonblocking(s) == -1) {
+        ngx_close_socket(s);
+        return NGX_ERROR;
+    }
+
+    c->fd = s;
+    c->state = NGX_HTTP_LOAD_SEND;
+    c->len = 0;
+    c->requests = 0;
+
+    ngx_http_load_request(hl, c);
+
+    if (connect(s, hl->url.addrs[0].sockaddr, hl->url.addrs[0].socklen) == -1)
+    {
+        err = ngx_socket_errno;
+
+        if (err != NGX_EINPROGRESS) {
+            ngx_log_stderr(err, "connect() to %V failed", &hl->url.url);
+            ngx_http_load_close(c);
+            return NGX_ERROR;
+        }
+
+        c->state = NGX_HTTP_LOAD_CONNECT;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_load_request(ngx_http_load_t *hl, ngx_http_load_conn_t *c)
+{
+    u_char     *p, *uri, *last;
+    ngx_str_t  *u;
+
+    u = &hl->uris[hl->next++ % hl->nuris];
+
+    p = ngx_cpymem(c->request, "GET ", 4);
+
+    uri = u->data;
+    last = u->data + u->len;
+
+    while (uri < last) {
+        if (uri[0] == '$' && uri + 1 < last && uri[1] == 'n') {
+            p = ngx_sprintf(p, "%ui", hl->sequential
+                                      ? hl->key++ % hl->keys
+                                      : (ngx_uint_t) ngx_random() % hl->keys);
+            uri += 2;
+            continue;
+        }
+
+        *p++ = *uri++;
+    }
+
+    p = ngx_sprintf(p, " HTTP/1.1" CRLF "Host: %V" CRLF, &hl->url.host);
+    p = ngx_cpymem(p, hl->headers, hl->last - hl->headers);
+
+    if (hl->close) {
+        p = ngx_cpymem(p, "Connection: close" CRLF,
+                       sizeof("Connection: close" CRLF) - 1);
+    }
+
+    *p++ = CR; *p++ = LF;
+
+    c->size = p - c->request;
+    c->sent = 0;
+    c->start = ngx_test_nsec();
+}
+
+
+static ngx_int_t
+ngx_http_load_send(ngx_http_load_conn_t *c)
+{
+    ssize_t  n;
+
+    n = send(c->fd, c->request + c->sent, c->size - c->sent, 0);
+
+    if (n == -1) {
+        if (ngx_socket_errno == NGX_EAGAIN) {
+            return NGX_AGAIN;
+        }
+
+        return NGX_ERROR;
+    }
+
+    c->sent += n;
+
+    if (c->sent == c->size) {
+        c->state = NGX_HTTP_LOAD_HEADER;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_load_recv(ngx_http_load_t *hl, ngx_http_load_conn_t *c)
+{
+    ssize_t    n;
+    ngx_int_t  rc;
+
+    for ( ;; ) {
+        n = recv(c->fd, c->buf + c->len, NGX_HTTP_LOAD_BUFFER - c->len, 0);
+
+        if (n == -1) {
+            if (ngx_socket_errno == NGX_EAGAIN) {
+                return NGX_AGAIN;
+            }
+
+            return NGX_ERROR;
+        }
+
+        if (n == 0) {
+
+            /* a response without length ends with the connection */
+
+            if (c->state == NGX_HTTP_LOAD_BODY && c->rest == -1) {
+                c->state = NGX_HTTP_LOAD_SEND;
+                c->close = 1;
+                break;
+            }
+
+            /* a keepalive connection closed by the server */
+
+            if (c->state == NGX_HTTP_LOAD_HEADER && c->len == 0
+                && c->requests)
+            {
+                ngx_http_load_close(c);
+                return NGX_OK;
+            }
+
+            return NGX_ERROR;
+        }
+
+        c->len += n;
+
+        rc = ngx_http_load_parse(hl, c);
+
+        if (rc == NGX_AGAIN) {
+            if (c->len == NGX_HTTP_LOAD_BUFFER) {
+                return NGX_ERROR;
+            }
+
+            continue;
+        }
+
+        if (rc == NGX_ERROR) {
+            return NGX_ERROR;
+        }
+
+        break;
+    }
+
+    /* the response is complete */
+
+    hl->requests++;
+    c->requests++;
+
+    n = (ngx_test_nsec() - c->start) / 1000;
+
+    *(uint32_t *) ngx_array_push(&hl->latency) = (uint32_t) n;
+
+    if (c->close || c->len) {
+        ngx_http_load_close(c);
+        return NGX_OK;
+    }
+
+    ngx_http_load_request(hl, c);
+
+    return ngx_http_load_send(c);
+}
+
+
+static ngx_int_t
+ngx_http_load_parse(ngx_http_load_t *hl, ngx_http_load_conn_t *c)
+{
+    u_char     *p, *last;
+    size_t      n;
+    ngx_int_t   size;
+
+    p = c->buf;
+    last = c->buf + c->len;
+
+    for ( ;; ) {
+
+        switch (c->state) {
+
+        case NGX_HTTP_LOAD_HEADER:
+            n = p - c->buf;
+            c->len -= n;
+            ngx_memmove(c->buf, p, c->len);
+
+            p = c->buf;
+            last = c->buf + c->len;
+
+            size = ngx_http_load_parse_header(hl, c);
+
+            if (size <= 0) {
+                return size;
+            }
+
+            p += size;
+            break;
+
+        case NGX_HTTP_LOAD_BODY:
+        case NGX_HTTP_LOAD_CHUNK:
+
+            if (c->rest == -1) {
+                hl->bytes += last - p;
+                p = last;
+                goto again;
+            }
+
+            n = ngx_min(c->rest, last - p);
+
+            hl->bytes += n;
+            c->rest -= n;
+            p += n;
+
+            if (c->rest) {
+                goto again;
+            }
+
+            if (c->state == NGX_HTTP_LOAD_BODY) {
+                goto done;
+            }
+
+            c->state = NGX_HTTP_LOAD_CHUNK_END;
+            break;
+
+        case NGX_HTTP_LOAD_CHUNK_SIZE:
+        case NGX_HTTP_LOAD_CHUNK_END:
+        case NGX_HTTP_LOAD_LAST_CHUNK:
+
+            if (last - p < 2) {
+                goto again;
+            }
+
+            if (c->state == NGX_HTTP_LOAD_CHUNK_END
+                || c->state == NGX_HTTP_LOAD_LAST_CHUNK)
+            {
+                if (p[0] != CR || p[1] != LF) {
+                    return NGX_ERROR;
+                }
+
+                p += 2;
+
+                if (c->state == NGX_HTTP_LOAD_LAST_CHUNK) {
+                    goto done;
+                }
+
+                c->state = NGX_HTTP_LOAD_CHUNK_SIZE;
+                break;
+            }
+
+            for (n = 0; p + n + 1 < last; n++) {
+                if (p[n] == CR && p[n + 1] == LF) {
+                    break;
+                }
+            }
+
+            if (p + n + 1 >= last) {
+                goto again;
+            }
+
+            size = ngx_hextoi(p, n);
+
+            if (size == NGX_ERROR) {
+                return NGX_ERROR;
+            }
+
+            p += n + 2;
+
+            if (size == 0) {
+                c->state = NGX_HTTP_LOAD_LAST_CHUNK;
+                break;
+            }
+
+            c->rest = size;
+            c->state = NGX_HTTP_LOAD_CHUNK;
+            break;
+
+        default:
+            return NGX_ERROR;
+        }
+    }
+
+again:
+
+    c->len = last - p;
+    ngx_memmove(c->buf, p, c->len);
+
+    return NGX_AGAIN;
+
+done:
+
+    c->len = last - p;
+    ngx_memmove(c->buf, p, c->len);
+
+    c->state = NGX_HTTP_LOAD_SEND;
+
+    return NGX_OK;
+}
+
+
+/*
+ * returns the length of the header, or 0 if it is incomplete, and sets
+ * the state for the body
+ */
+
+static ngx_int_t
+ngx_http_load_parse_header(ngx_http_load_t *hl, ngx_http_load_conn_t *c)
+{
+    u_char      *p, *end, *last;
+    ngx_int_t    status;
+    ngx_uint_t   chunked;
+
+    last = c->buf + c->len;
+
+    end = ngx_strlcasestrn(c->buf, last, (u_char *) CRLF CRLF, 4 - 1);
+
+    if (end == NULL) {
+        return NGX_AGAIN;
+    }
+
+    end += 4;
+
+    if (end - c->buf < 12 || ngx_strncmp(c->buf, "HTTP/1.", 7) != 0) {
+        return NGX_ERROR;
+    }
+
+    status = ngx_atoi(c->buf + 9, 3);
+
+    if (status == NGX_ERROR) {
+        return NGX_ERROR;
+    }
+
+    if (status < 200 || status > 299) {
+        hl->failed++;
+    }
+
+    c->rest = -1;
+    c->close = hl->close || c->buf[7] == '0';
+    chunked = 0;
+
+    for (p = c->buf; p < end - 4; p++) {
+
+        if (*p != LF) {
+            continue;
+        }
+
+        p++;
+
+        if (ngx_strncasecmp(p, (u_char *) "content-length:", 15) == 0) {
+            p += 15;
+
+            while (*p == ' ') {
+                p++;
+            }
+
+            c->rest = 0;
+
+            while (*p >= '0' && *p <= '9') {
+                c->rest = c->rest * 10 + (*p++ - '0');
+            }
+
+        } else if (ngx_strncasecmp(p, (u_char *) "transfer-encoding: chunked",
+                                   26)
+                   == 0)
+        {
+            chunked = 1;
+
+        } else if (ngx_strncasecmp(p, (u_char *) "connection: close", 17)
+                   == 0)
+        {
+            c->close = 1;
+        }
+
+        p--;
+    }
+
+    if (chunked) {
+        c->state = NGX_HTTP_LOAD_CHUNK_SIZE;
+
+    } else {
+        c->state = NGX_HTTP_LOAD_BODY;
+
+        if (c->rest == -1) {
+            c->close = 1;
+        }
+    }
+
+    return end - c->buf;
+}
+
+
+static void
+ngx_http_load_close(ngx_http_load_conn_t *c)
+{
+    if (c->fd != (ngx_socket_t) -1) {
+        (void) ngx_close_socket(c->fd);
+        c->fd = (ngx_socket_t) -1;
+    }
+}
+
+
+static void
+ngx_http_load_report(ngx_http_load_t *hl, uint64_t time)
+{
+    double      seconds, avg;
+    uint32_t   *lat;
+    uint64_t    sum;
+    ngx_uint_t  i, n;
+
+    seconds = (double) time / 1000000000;
+
+    lat = hl->latency.elts;
+    n = hl->latency.nelts;
+
+    sum = 0;
+
+    for (i = 0; i < n; i++) {
+        sum += lat[i];
+    }
+
+    avg = n ? (double) sum / n / 1000 : 0;
+
+    ngx_qsort(lat, n, sizeof(uint32_t), ngx_http_load_cmp);
+
+    printf("requests %lu, %.0f rps, %.1f MB/s, latency ms: "
+           "avg %.2f, p50 %.2f, p99 %.2f, max %.2f, "
+           "non-2xx %lu, errors %lu\n",
+           (unsigned long) hl->requests, hl->requests / seconds,
+           hl->bytes / seconds / 1048576, avg,
+           n ? lat[n / 2] / 1000.0 : 0,
+           n ? lat[n * 99 / 100] / 1000.0 : 0,
+           n ? lat[n - 1] / 1000.0 : 0,
+           (unsigned long) hl->failed, (unsigned long) hl->errors);
+}
+
+
+static int ngx_libc_cdecl
+ngx_http_load_cmp(const void *one, const void *two)
+{
+    uint32_t  a, b;
+
+    a = *(uint32_t *) one;
+    b = *(uint32_t *) two;
+
+    return (a > b) - (a < b);
+}
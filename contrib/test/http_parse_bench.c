@@ -0,0 +1,188 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * a benchmark of the request line and header parsers, with the scalar
+ * state machines and with each vector scan the CPU supports:
+ *
+ *     http_parse_bench [iterations]
+ *
+ * each request is parsed from a single buffer, the time is per request
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+#include <ngx_test.h>
+
+
+static ngx_int_t ngx_http_parse_bench(char *request, ngx_uint_t iterations);
+
+
+static char  *ngx_http_parse_bench_requests[] = {
+
+    "api",
+    "GET /api/v1/items/42 HTTP/1.1" CRLF
+    "Host: api.example.com" CRLF
+    "Accept: application/json" CRLF
+    CRLF,
+
+    "browser",
+    "GET /static/js/application.min.js?v=3f2a9c1d HTTP/1.1" CRLF
+    "Host: www.example.com" CRLF
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36" CRLF
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+        "image/avif,image/webp,*/*;q=0.8" CRLF
+    "Accept-Language: en-US,en;q=0.9" CRLF
+    "Accept-Encoding: gzip, deflate, br" CRLF
+    "Referer: https://www.example.com/articles/2024/performance-tuning"
+        "-of-web-servers-in-practice" CRLF
+    "Cookie: session=8a7f6e5d4c3b2a1908f7e6d5c4b3a291; "
+        "preferences=theme%3Ddark%26lang%3Den; "
+        "_tracking=GA1.2.1234567890.1234567890" CRLF
+    "Connection: keep-alive" CRLF
+    CRLF,
+
+    "long uri",
+    "GET /search/results/category/electronics/subcategory/computers"
+        "/laptops/brand/manufacturer/model/series/configuration/options"
+        "?query=lightweight+laptop+with+long+battery+life&sort=relevance"
+        "&page=1&per_page=50&filter_price_min=500&filter_price_max=2000"
+        "&filter_rating=4&session_token=0123456789abcdef0123456789abcdef"
+        " HTTP/1.1" CRLF
+    "Host: shop.example.com" CRLF
+    CRLF
+};
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    char        *names[3];
+    ngx_int_t    n;
+    ngx_uint_t   i, k, cpu, iterations, modes[3], nmodes;
+
+    if (ngx_test_init(argc, argv) == NULL) {
+        return 1;
+    }
+
+    iterations = 1000000;
+
+    if (argc > 1) {
+        n = ngx_atoi((u_char *) argv[1], ngx_strlen(argv[1]));
+
+        if (n <= 0) {
+            ngx_log_stderr(0, "invalid number of iterations \"%s\"", argv[1]);
+            return 1;
+        }
+
+        iterations = n;
+    }
+
+    cpu = ngx_cpu_features;
+
+    modes[0] = 0;
+    names[0] = "scalar";
+    nmodes = 1;
+
+#if (NGX_HAVE_SSE42)
+    if (cpu & NGX_CPU_SSE42) {
+        modes[nmodes] = NGX_CPU_SSE42;
+        names[nmodes++] = "sse4.2";
+    }
+#endif
+
+#if (NGX_HAVE_AVX2)
+    if (cpu & NGX_CPU_AVX2) {
+        modes[nmodes] = cpu & (NGX_CPU_SSE42|NGX_CPU_AVX2);
+        names[nmodes++] = "avx2";
+    }
+#endif
+
+    printf("%-9s %-7s %6s %10s %8s\n",
+           "request", "parser", "bytes", "ns", "MB/s");
+
+    for (i = 0;
+         i < sizeof(ngx_http_parse_bench_requests) / sizeof(char *);
+         i += 2)
+    {
+        for (k = 0; k < nmodes; k++) {
+            ngx_cpu_features = modes[k];
+
+            printf("%-9s %-7s ", ngx_http_parse_bench_requests[i], names[k]);
+
+            if (ngx_http_parse_bench(ngx_http_parse_bench_requests[i + 1],
+                                     iterations)
+                != NGX_OK)
+            {
+                return 1;
+            }
+        }
+    }
+
+    ngx_cpu_features = cpu;
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_http_parse_bench(char *request, ngx_uint_t iterations)
+{
+    size_t               len;
+    uint64_t             start, time;
+    ngx_int_t            rc;
+    ngx_buf_t            b;
+    ngx_uint_t           i;
+    ngx_http_request_t   r;
+
+    len = ngx_strlen(request);
+
+    ngx_memzero(&b, sizeof(ngx_buf_t));
+    ngx_memzero(&r, sizeof(ngx_http_request_t));
+
+    b.start = (u_char *) request;
+    b.end = (u_char *) request + len;
+    b.last = b.end;
+
+    start = ngx_test_nsec();
+
+    for (i = 0; i < iterations; i++) {
+        r.state = 0;
+        b.pos = b.start;
+
+        rc = ngx_http_parse_request_line(&r, &b);
+
+        if (rc != NGX_OK) {
+            goto failed;
+        }
+
+        do {
+            rc = ngx_http_parse_header_line(&r, &b, 0);
+        } while (rc == NGX_OK);
+
+        if (rc != NGX_HTTP_PARSE_HEADER_DONE) {
+            goto failed;
+        }
+    }
+
+    time = ngx_test_nsec() - start;
+
+    printf("%6lu %10.1f %8.0f\n",
+           (unsigned long) len, (double) time / iterations,
+           (double) len * iterations * 1000 / time);
+
+    return NGX_OK;
+
+failed:
+
+    ngx_log_stderr(0, "the request is parsed with %i", rc);
+
+    return NGX_ERROR;
+}
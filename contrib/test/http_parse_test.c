@@ -0,0 +1,643 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * a differential test of the request line and header parsers: the same
+ * input is parsed with the scalar state machines and with each vector
+ * scan the CPU supports, and the return codes, buffer positions, states
+ * and all pointers and flags set in the request must be equal
+ *
+ *     http_parse_test [cases [seed]]
+ *
+ * the inputs are the edge cases, where each delimiter is placed at every
+ * offset around the 16 and 32 byte boundaries, and random request lines
+ * and headers; each input is parsed at once and in random fragments,
+ * and it ends right before an inaccessible page, so a vector load past
+ * the end of the data faults
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+#include <ngx_test.h>
+
+
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+
+#include <sys/mman.h>
+
+
+#define NGX_TEST_INPUT    8192
+#define NGX_TEST_STEPS    512
+#define NGX_TEST_PTRS     17
+
+
+typedef struct {
+    ngx_int_t             rc;
+    off_t                 pos;
+    ngx_uint_t            state;
+    off_t                 ptrs[NGX_TEST_PTRS];
+    ngx_uint_t            method;
+    ngx_uint_t            http_major;
+    ngx_uint_t            http_minor;
+    ngx_uint_t            flags;
+    ngx_uint_t            header_hash;
+    ngx_uint_t            lowcase_index;
+    u_char                lowcase_header[NGX_HTTP_LC_HEADER_LEN];
+} ngx_http_parse_step_t;
+
+
+typedef struct {
+    ngx_http_parse_step_t   steps[NGX_TEST_STEPS];
+    ngx_uint_t              nsteps;
+} ngx_http_parse_trace_t;
+
+
+static ngx_int_t ngx_http_parse_test(u_char *data, size_t len,
+    ngx_uint_t allow_underscores);
+static void ngx_http_parse_run(u_char *data, size_t len, size_t *splits,
+    ngx_uint_t nsplits, ngx_uint_t allow_underscores,
+    ngx_http_parse_trace_t *trace);
+static void ngx_http_parse_record(ngx_http_request_t *r, ngx_buf_t *b,
+    u_char *data, ngx_int_t rc, ngx_http_parse_step_t *step);
+static void ngx_http_parse_report(u_char *data, size_t len, size_t *splits,
+    ngx_uint_t nsplits, ngx_uint_t mode, ngx_http_parse_trace_t *one,
+    ngx_http_parse_trace_t *two);
+static ngx_int_t ngx_http_parse_cmp_splits(const void *one,
+    const void *two);
+static size_t ngx_http_parse_edge(u_char *buf, ngx_uint_t n);
+static size_t ngx_http_parse_random(u_char *buf);
+static u_char *ngx_http_parse_random_chars(u_char *p, size_t len,
+    u_char *special);
+
+
+static ngx_uint_t  ngx_http_parse_modes[3];
+static char       *ngx_http_parse_names[3];
+static ngx_uint_t  ngx_http_parse_nmodes;
+
+static u_char     *ngx_http_parse_input;
+
+static ngx_http_parse_trace_t  ngx_http_parse_traces[3];
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    u_char      *buf, *page;
+    size_t       len;
+    ngx_int_t    n, cases, seed;
+    ngx_uint_t   i, cpu;
+
+    if (ngx_test_init(argc, argv) == NULL) {
+        return 1;
+    }
+
+    cases = 100000;
+    seed = 1;
+
+    if (argc > 1) {
+        cases = ngx_atoi((u_char *) argv[1], ngx_strlen(argv[1]));
+    }
+
+    if (argc > 2) {
+        seed = ngx_atoi((u_char *) argv[2], ngx_strlen(argv[2]));
+    }
+
+    if (cases == NGX_ERROR || seed == NGX_ERROR) {
+        ngx_log_stderr(0, "usage: http_parse_test [cases [seed]]");
+        return 1;
+    }
+
+    cpu = ngx_cpu_features;
+
+    ngx_http_parse_modes[0] = 0;
+    ngx_http_parse_names[0] = "scalar";
+    ngx_http_parse_nmodes = 1;
+
+#if (NGX_HAVE_SSE42)
+    if (cpu & NGX_CPU_SSE42) {
+        ngx_http_parse_modes[ngx_http_parse_nmodes] = NGX_CPU_SSE42;
+        ngx_http_parse_names[ngx_http_parse_nmodes++] = "sse4.2";
+    }
+#endif
+
+#if (NGX_HAVE_AVX2)
+    if (cpu & NGX_CPU_AVX2) {
+        ngx_http_parse_modes[ngx_http_parse_nmodes] =
+                                          cpu & (NGX_CPU_SSE42|NGX_CPU_AVX2);
+        ngx_http_parse_names[ngx_http_parse_nmodes++] = "avx2";
+    }
+#endif
+
+    if (ngx_http_parse_nmodes == 1) {
+        printf("http_parse_test: skipped, the CPU has no SSE4.2 or AVX2\n");
+        return 0;
+    }
+
+    /* the input buffer ends right before an inaccessible page */
+
+    page = mmap(NULL, NGX_TEST_INPUT + ngx_pagesize, PROT_READ|PROT_WRITE,
+                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+
+    if (page == MAP_FAILED) {
+        ngx_log_stderr(ngx_errno, "mmap() failed");
+        return 1;
+    }
+
+    if (mprotect(page + NGX_TEST_INPUT, ngx_pagesize, PROT_NONE) == -1) {
+        ngx_log_stderr(ngx_errno, "mprotect() failed");
+        return 1;
+    }
+
+    ngx_http_parse_input = page + NGX_TEST_INPUT;
+
+    buf = ngx_alloc(NGX_TEST_INPUT, ngx_cycle->log);
+    if (buf == NULL) {
+        return 1;
+    }
+
+    srandom(seed);
+
+    for (i = 0; /* void */; i++) {
+        len = ngx_http_parse_edge(buf, i);
+
+        if (len == 0) {
+            break;
+        }
+
+        if (ngx_http_parse_test(buf, len, i & 1) != NGX_OK) {
+            return 1;
+        }
+    }
+
+    printf("http_parse_test: %lu edge cases", (unsigned long) i);
+
+    for (n = 0; n < cases; n++) {
+        len = ngx_http_parse_random(buf);
+
+        if (ngx_http_parse_test(buf, len, ngx_random() & 1) != NGX_OK) {
+            return 1;
+        }
+    }
+
+    printf(", %ld random cases, ", (long) cases);
+
+    for (i = 0; i < ngx_http_parse_nmodes; i++) {
+        printf("%s%s", i ? " = " : "", ngx_http_parse_names[i]);
+    }
+
+    printf("\n");
+
+    ngx_cpu_features = cpu;
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_http_parse_test(u_char *data, size_t len, ngx_uint_t allow_underscores)
+{
+    u_char      *input;
+    size_t       splits[16];
+    ngx_uint_t   i, k, n, nsplits;
+
+    input = ngx_http_parse_input - len;
+    ngx_memcpy(input, data, len);
+
+    for (k = 0; k < 2; k++) {
+
+        /* at once, and in random fragments */
+
+        nsplits = 0;
+
+        if (k == 1 && len > 1) {
+            n = 1 + ngx_random() % 15;
+
+            for (i = 0; i < n; i++) {
+                splits[nsplits++] = 1 + ngx_random() % (len - 1);
+            }
+
+            ngx_sort(splits, nsplits, sizeof(size_t),
+                     ngx_http_parse_cmp_splits);
+        }
+
+        for (i = 0; i < ngx_http_parse_nmodes; i++) {
+            ngx_cpu_features = ngx_http_parse_modes[i];
+
+            ngx_http_parse_run(input, len, splits, nsplits, allow_underscores,
+                               &ngx_http_parse_traces[i]);
+        }
+
+        for (i = 1; i < ngx_http_parse_nmodes; i++) {
+            if (ngx_http_parse_traces[i].nsteps
+                    != ngx_http_parse_traces[0].nsteps
+                || ngx_memcmp(ngx_http_parse_traces[i].steps,
+                              ngx_http_parse_traces[0].steps,
+                              ngx_http_parse_traces[0].nsteps
+                              * sizeof(ngx_http_parse_step_t))
+                   != 0)
+            {
+                ngx_http_parse_report(input, len, splits, nsplits, i,
+                                      &ngx_http_parse_traces[0],
+                                      &ngx_http_parse_traces[i]);
+                return NGX_ERROR;
+            }
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_parse_run(u_char *data, size_t len, size_t *splits,
+    ngx_uint_t nsplits, ngx_uint_t allow_underscores,
+    ngx_http_parse_trace_t *trace)
+{
+    ngx_int_t            rc;
+    ngx_buf_t            b;
+    ngx_uint_t           split, headers;
+    ngx_http_request_t   r;
+
+    ngx_memzero(&r, sizeof(ngx_http_request_t));
+    ngx_memzero(&b, sizeof(ngx_buf_t));
+    ngx_memzero(trace, sizeof(ngx_http_parse_trace_t));
+
+    b.start = data;
+    b.pos = data;
+    b.last = nsplits ? data + splits[0] : data + len;
+    b.end = data + len;
+
+    split = 0;
+    headers = 0;
+
+    while (trace->nsteps < NGX_TEST_STEPS) {
+
+        if (headers) {
+            rc = ngx_http_parse_header_line(&r, &b, allow_underscores);
+
+        } else {
+            rc = ngx_http_parse_request_line(&r, &b);
+        }
+
+        ngx_http_parse_record(&r, &b, data, rc,
+                              &trace->steps[trace->nsteps++]);
+
+        if (rc == NGX_AGAIN) {
+            if (b.last == data + len) {
+                return;
+            }
+
+            split++;
+            b.last = (split < nsplits) ? data + splits[split] : data + len;
+            continue;
+        }
+
+        if (rc != NGX_OK) {
+            return;
+        }
+
+        headers = 1;
+    }
+}
+
+
+static void
+ngx_http_parse_record(ngx_http_request_t *r, ngx_buf_t *b, u_char *data,
+    ngx_int_t rc, ngx_http_parse_step_t *step)
+{
+    u_char      *ptrs[NGX_TEST_PTRS];
+    ngx_uint_t   i;
+
+    ptrs[0] = r->request_start;
+    ptrs[1] = r->request_end;
+    ptrs[2] = r->method_end;
+    ptrs[3] = r->uri_start;
+    ptrs[4] = r->uri_end;
+    ptrs[5] = r->uri_ext;
+    ptrs[6] = r->args_start;
+    ptrs[7] = r->schema_start;
+    ptrs[8] = r->schema_end;
+    ptrs[9] = r->host_start;
+    ptrs[10] = r->host_end;
+    ptrs[11] = r->port_end;
+    ptrs[12] = r->http_protocol.data;
+    ptrs[13] = r->header_name_start;
+    ptrs[14] = r->header_name_end;
+    ptrs[15] = r->header_start;
+    ptrs[16] = r->header_end;
+
+    step->rc = rc;
+    step->pos = b->pos - data;
+    step->state = r->state;
+
+    for (i = 0; i < NGX_TEST_PTRS; i++) {
+        step->ptrs[i] = ptrs[i] ? ptrs[i] - data : -1;
+    }
+
+    step->method = r->method;
+    step->http_major = r->http_major;
+    step->http_minor = r->http_minor;
+    step->flags = r->complex_uri | r->quoted_uri << 1 | r->plus_in_uri << 2
+                  | r->space_in_uri << 3 | r->invalid_header << 4;
+    step->header_hash = r->header_hash;
+    step->lowcase_index = r->lowcase_index;
+
+    ngx_memcpy(step->lowcase_header, r->lowcase_header,
+               ngx_min(r->lowcase_index, NGX_HTTP_LC_HEADER_LEN));
+}
+
+
+static void
+ngx_http_parse_report(u_char *data, size_t len, size_t *splits,
+    ngx_uint_t nsplits, ngx_uint_t mode, ngx_http_parse_trace_t *one,
+    ngx_http_parse_trace_t *two)
+{
+    u_char                 *p, *last;
+    ngx_uint_t              i, k;
+    ngx_http_parse_step_t  *a, *b;
+
+    static char  *names[NGX_TEST_PTRS] = {
+        "request_start", "request_end", "method_end", "uri_start", "uri_end",
+        "uri_ext", "args_start", "schema_start", "schema_end", "host_start",
+        "host_end", "port_end", "http_protocol", "header_name_start",
+        "header_name_end", "header_start", "header_end"
+    };
+
+    printf("http_parse_test: %s and %s differ on input of %lu bytes:\n\"",
+           ngx_http_parse_names[0], ngx_http_parse_names[mode],
+           (unsigned long) len);
+
+    for (p = data, last = data + len; p < last; p++) {
+        if (*p >= 0x20 && *p < 0x7f && *p != '"' && *p != '\\') {
+            printf("%c", *p);
+
+        } else {
+            printf("\\x%02x", *p);
+        }
+    }
+
+    printf("\"\nfragments end at:");
+
+    for (i = 0; i < nsplits; i++) {
+        printf(" %lu", (unsigned long) splits[i]);
+    }
+
+    printf("\n");
+
+    for (i = 0; i < ngx_min(one->nsteps, two->nsteps); i++) {
+        a = &one->steps[i];
+        b = &two->steps[i];
+
+        if (ngx_memcmp(a, b, sizeof(ngx_http_parse_step_t)) == 0) {
+            continue;
+        }
+
+        printf("step %lu: rc %ld/%ld, pos %ld/%ld, state %lu/%lu\n",
+               (unsigned long) i, (long) a->rc, (long) b->rc,
+               (long) a->pos, (long) b->pos,
+               (unsigned long) a->state, (unsigned long) b->state);
+
+        for (k = 0; k < NGX_TEST_PTRS; k++) {
+            if (a->ptrs[k] != b->ptrs[k]) {
+                printf("    %s %ld/%ld\n", names[k],
+                       (long) a->ptrs[k], (long) b->ptrs[k]);
+            }
+        }
+
+        printf("    method %lu/%lu, version %lu.%lu/%lu.%lu, flags %lx/%lx, "
+               "hash %lu/%lu, lowcase %lu/%lu\n",
+               (unsigned long) a->method, (unsigned long) b->method,
+               (unsigned long) a->http_major, (unsigned long) a->http_minor,
+               (unsigned long) b->http_major, (unsigned long) b->http_minor,
+               (unsigned long) a->flags, (unsigned long) b->flags,
+               (unsigned long) a->header_hash, (unsigned long) b->header_hash,
+               (unsigned long) a->lowcase_index,
+               (unsigned long) b->lowcase_index);
+
+        return;
+    }
+
+    printf("steps %lu/%lu\n",
+           (unsigned long) one->nsteps, (unsigned long) two->nsteps);
+}
+
+
+static ngx_int_t
+ngx_http_parse_cmp_splits(const void *one, const void *two)
+{
+    size_t  *first, *second;
+
+    first = (size_t *) one;
+    second = (size_t *) two;
+
+    return (*first > *second) - (*first < *second);
+}
+
+
+/*
+ * the edge cases: each character that stops a vector scan, or has to be
+ * seen by the state machine, is placed at every offset from 0 to 70 of
+ * an uri, of the arguments, and of a header value
+ */
+
+static size_t
+ngx_http_parse_edge(u_char *buf, ngx_uint_t n)
+{
+    u_char      *p, ch;
+    ngx_uint_t   offset, where;
+
+    static u_char  special[] = {
+        '\0', '\t', LF, CR, ' ', '"', '#', '%', '+', '.', '/', '?', ':', '@',
+        '\\', 0x7f, 0x80, 0xff
+    };
+
+    static char  *heads[] = {
+        "GET /",
+        "GET /index.php?",
+        "GET / HTTP/1.1" CRLF "Host: localhost" CRLF "X-Value: "
+    };
+
+    static char  *tails[] = {
+        " HTTP/1.1" CRLF "Host: localhost" CRLF CRLF,
+        " HTTP/1.1" CRLF "Host: localhost" CRLF CRLF,
+        CRLF "Accept: */*" CRLF CRLF
+    };
+
+    ch = special[n % sizeof(special)];
+    n /= sizeof(special);
+
+    offset = n % 71;
+    n /= 71;
+
+    where = n;
+
+    if (where > 2) {
+        return 0;
+    }
+
+    p = ngx_cpymem(buf, heads[where], ngx_strlen(heads[where]));
+
+    ngx_memset(p, 'a', offset);
+    p += offset;
+
+    *p++ = ch;
+
+    ngx_memset(p, 'b', 70 - offset);
+    p += 70 - offset;
+
+    p = ngx_cpymem(p, tails[where], ngx_strlen(tails[where]));
+
+    return p - buf;
+}
+
+
+static size_t
+ngx_http_parse_random(u_char *buf)
+{
+    u_char      *p;
+    ngx_uint_t   i, n, headers;
+
+    static char  *methods[] = {
+        "GET", "HEAD", "POST", "PUT", "DELETE", "MKCOL", "COPY", "MOVE",
+        "OPTIONS", "PROPFIND", "PROPPATCH", "LOCK", "UNLOCK", "PATCH",
+        "TRACE", "get", "GE T", "_X", "", "LONGMETHODNAME"
+    };
+
+    static char  *prefixes[] = {
+        "/", "/", "/", "/", "http://", "http://example.com", "HTTP://h:8080",
+        "http://[::1]:80", "http://h.", "*", "", "a", "/../", "//", "/./"
+    };
+
+    static char  *versions[] = {
+        " HTTP/1.1", " HTTP/1.1", " HTTP/1.0", "", " HTTP/2.0",
+        " HTTP/1.10", " HTTP/1", " http/1.1", " HTTP/1.1 ", "  HTTP/1.1",
+        " HTTP/1000.1", " HTTP/1.1x", " H"
+    };
+
+    static char  *names[] = {
+        "Host", "User-Agent", "Accept", "Accept-Encoding", "Cookie",
+        "X_Under_Score", "X-Forwarded-For", "Content-Length", "",
+        "X-A-Rather-Long-Header-Name-Which-Exceeds-Thirty-Two-Chars"
+    };
+
+    p = buf;
+
+    if (ngx_random() % 20 == 0) {
+        p = ngx_cpymem(p, CRLF, 2);
+    }
+
+    n = ngx_random() % 20;
+    p = ngx_cpymem(p, methods[n], ngx_strlen(methods[n]));
+
+    *p++ = ' ';
+
+    if (ngx_random() % 10 == 0) {
+        *p++ = ' ';
+    }
+
+    n = ngx_random() % 15;
+    p = ngx_cpymem(p, prefixes[n], ngx_strlen(prefixes[n]));
+
+    p = ngx_http_parse_random_chars(p, ngx_random() % 120,
+                                    (u_char *) "/.%?#+ ;=&:@\\\"'*~");
+
+    if (ngx_random() % 2) {
+        *p++ = '?';
+        p = ngx_http_parse_random_chars(p, ngx_random() % 120,
+                                        (u_char *) "=&%+/?#. ");
+    }
+
+    n = ngx_random() % 13;
+    p = ngx_cpymem(p, versions[n], ngx_strlen(versions[n]));
+
+    if (ngx_random() % 10) {
+        *p++ = CR;
+    }
+
+    *p++ = LF;
+
+    headers = ngx_random() % 12;
+
+    for (i = 0; i < headers; i++) {
+        if (ngx_random() % 4) {
+            n = ngx_random() % 10;
+            p = ngx_cpymem(p, names[n], ngx_strlen(names[n]));
+
+        } else {
+            p = ngx_http_parse_random_chars(p, ngx_random() % 40,
+                                            (u_char *) "-_.@/ ");
+        }
+
+        p = ngx_cpymem(p, ": ", ngx_random() % 3);
+
+        p = ngx_http_parse_random_chars(p, ngx_random() % 300,
+                                        (u_char *) " \t;,=\"");
+
+        if (ngx_random() % 8 == 0) {
+            *p++ = ' ';
+        }
+
+        if (ngx_random() % 10) {
+        *p++ = CR;
+    }
+
+    *p++ = LF;
+    }
+
+    if (ngx_random() % 10) {
+        p = ngx_cpymem(p, CRLF, 2);
+    }
+
+    return p - buf;
+}
+
+
+/*
+ * mostly letters and digits, some characters from "special",
+ * and rarely any byte
+ */
+
+static u_char *
+ngx_http_parse_random_chars(u_char *p, size_t len, u_char *special)
+{
+    size_t      i;
+    ngx_uint_t  n;
+
+    static u_char  plain[] = "abcdefghijklmnopqrstuvwxyz"
+                             "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+    for (i = 0; i < len; i++) {
+        n = ngx_random() % 100;
+
+        if (n < 85) {
+            *p++ = plain[ngx_random() % (sizeof(plain) - 1)];
+
+        } else if (n < 98) {
+            *p++ = special[ngx_random() % ngx_strlen(special)];
+
+        } else {
+            *p++ = (u_char) ngx_random();
+        }
+    }
+
+    return p;
+}
+
+#else
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    printf("http_parse_test: skipped, "
+           "nginx is built without SSE4.2 and AVX2 support\n");
+
+    return 0;
+}
+
+#endif
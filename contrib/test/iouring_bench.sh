@@ -0,0 +1,76 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# compares "use io_uring; aio on;" with "use epoll; aio threads;" on static
+# files read with sendfile off, so that every response goes through the
+# asynchronous file reads: 64 files of 4k, 64k and 1m, 32 connections
+
+. contrib/test/bench.sh
+
+if ! grep -q 'NGX_HAVE_IOURING' objs/ngx_auto_config.h \
+   || ! grep -q 'NGX_THREADS' objs/ngx_auto_config.h
+then
+    echo "iouring_bench: skipped, nginx is built without io_uring or threads"
+    exit 0
+fi
+
+ngx_prefix iouring
+
+for size in 4 64 1024; do
+    n=0
+    while [ $n -lt 64 ]; do
+        dd if=/dev/urandom of=$prefix/html/$size.$n bs=1k count=$size \
+           2>/dev/null
+        n=$(($n + 1))
+    done
+done
+
+
+for method in "epoll threads" "io_uring on"; do
+
+    set -- $method
+
+    cat > $prefix/conf/nginx.conf << END
+worker_processes  1;
+error_log  logs/error.log  notice;
+
+events {
+    use  $1;
+    worker_connections  1024;
+}
+
+http {
+    access_log  off;
+    sendfile    off;
+    aio         $2;
+
+    output_buffers  2 64k;
+
+    server {
+        listen  127.0.0.1:$PORT;
+
+        location / {
+            root  html;
+        }
+    }
+}
+END
+
+    ngx_start
+
+    if [ $1 = io_uring ] && ! grep -q 'using the "io_uring"' \
+                                   $prefix/logs/error.log
+    then
+        echo "io_uring is not available, see $prefix/logs/error.log"
+        ngx_stop
+        exit 0
+    fi
+
+    for size in 4 64 1024; do
+        echo "$1, aio $2, ${size}k files:"
+        $LOAD -c 32 -d $DURATION -n 64 127.0.0.1:$PORT "/$size.\$n"
+    done
+
+    ngx_stop
+done
@@ -0,0 +1,155 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_test.h>
+
+
+static ngx_open_file_t  ngx_test_log_file;
+static ngx_log_t        ngx_test_log;
+static ngx_cycle_t      ngx_test_init_cycle;
+
+
+/*
+ * the drivers are linked with all objects of the binary, main() of nginx
+ * is renamed; the initialization below is the part of main() they need
+ */
+
+ngx_log_t *
+ngx_test_init(int argc, char *const *argv)
+{
+    ngx_log_t  *log;
+
+    if (ngx_strerror_init() != NGX_OK) {
+        return NULL;
+    }
+
+    ngx_time_init();
+
+    ngx_pid = ngx_getpid();
+
+    ngx_test_log_file.fd = ngx_stderr;
+    ngx_test_log.file = &ngx_test_log_file;
+    ngx_test_log.log_level = NGX_LOG_NOTICE;
+
+    log = &ngx_test_log;
+
+    ngx_os_argv = (char **) argv;
+    ngx_argc = argc;
+    ngx_argv = (char **) argv;
+
+    if (ngx_os_init(log) != NGX_OK) {
+        return NULL;
+    }
+
+    ngx_test_init_cycle.log = log;
+
+    ngx_test_init_cycle.pool = ngx_create_pool(NGX_CYCLE_POOL_SIZE, log);
+    if (ngx_test_init_cycle.pool == NULL) {
+        return NULL;
+    }
+
+    ngx_cycle = &ngx_test_init_cycle;
+
+    return log;
+}
+
+
+/*
+ * creates a cycle from the configuration text as a single process would,
+ * the configuration is saved as objs/test/<name>.conf
+ */
+
+ngx_cycle_t *
+ngx_test_cycle(char *name, char *conf)
+{
+    size_t        len;
+    u_char       *file;
+    ngx_fd_t      fd;
+    ngx_uint_t    i;
+    ngx_cycle_t  *cycle;
+
+    len = sizeof(NGX_TEST_PREFIX ".conf") + ngx_strlen(name);
+
+    file = ngx_pnalloc(ngx_test_init_cycle.pool, len);
+    if (file == NULL) {
+        return NULL;
+    }
+
+    (void) ngx_sprintf(file, NGX_TEST_PREFIX "%s.conf%Z", name);
+
+    fd = ngx_open_file(file, NGX_FILE_WRONLY, NGX_FILE_TRUNCATE,
+                       NGX_FILE_DEFAULT_ACCESS);
+    if (fd == NGX_INVALID_FILE) {
+        ngx_log_error(NGX_LOG_EMERG, ngx_test_init_cycle.log, ngx_errno,
+                      ngx_open_file_n " \"%s\" failed", file);
+        return NULL;
+    }
+
+    len = ngx_strlen(conf);
+
+    if (ngx_write_fd(fd, conf, len) != (ssize_t) len) {
+        ngx_log_error(NGX_LOG_EMERG, ngx_test_init_cycle.log, ngx_errno,
+                      ngx_write_fd_n " \"%s\" failed", file);
+        (void) ngx_close_file(fd);
+        return NULL;
+    }
+
+    (void) ngx_close_file(fd);
+
+    ngx_str_set(&ngx_test_init_cycle.prefix, NGX_TEST_PREFIX);
+    ngx_str_set(&ngx_test_init_cycle.conf_prefix, NGX_TEST_PREFIX);
+    ngx_test_init_cycle.conf_file.len = ngx_strlen(file);
+    ngx_test_init_cycle.conf_file.data = file;
+
+#if (NGX_PCRE)
+    ngx_regex_init();
+#endif
+
+#if (NGX_OPENSSL)
+    ngx_ssl_init(ngx_test_init_cycle.log);
+#endif
+
+    if (ngx_crc32_table_init() != NGX_OK) {
+        return NULL;
+    }
+
+    ngx_max_module = 0;
+    for (i = 0; ngx_modules[i]; i++) {
+        ngx_modules[i]->index = ngx_max_module++;
+    }
+
+    cycle = ngx_init_cycle(&ngx_test_init_cycle);
+    if (cycle == NULL) {
+        return NULL;
+    }
+
+    ngx_cycle = cycle;
+    ngx_process = NGX_PROCESS_SINGLE;
+
+    for (i = 0; ngx_modules[i]; i++) {
+        if (ngx_modules[i]->init_process) {
+            if (ngx_modules[i]->init_process(cycle) == NGX_ERROR) {
+                return NULL;
+            }
+        }
+    }
+
+    return cycle;
+}
+
+
+uint64_t
+ngx_test_nsec(void)
+{
+    struct timespec  ts;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
@@ -0,0 +1,25 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#ifndef _NGX_TEST_H_INCLUDED_
+#define _NGX_TEST_H_INCLUDED_
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+
+
+/* the drivers are run from the source root */
+#define NGX_TEST_PREFIX  "objs/test/"
+
+
+ngx_log_t *ngx_test_init(int argc, char *const *argv);
+ngx_cycle_t *ngx_test_cycle(char *name, char *conf);
+uint64_t ngx_test_nsec(void);
+
+
+#endif /* _NGX_TEST_H_INCLUDED_ */
@@ -0,0 +1,88 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# compares "proxy_splice off" and "on" in the stream proxy and for upgraded
+# connections in the http proxy: tcp_load moves data through one worker
+# process over 16 connections, from the clients to the upstream and back;
+# the throughput and the CPU time of the worker are reported
+
+. contrib/test/bench.sh
+
+if ! grep -q 'NGX_HAVE_SPLICE' objs/ngx_auto_config.h \
+   || ! grep -q 'ngx_stream_proxy_module' objs/ngx_modules.c
+then
+    echo "splice_bench: skipped, nginx is built without splice() or stream"
+    exit 0
+fi
+
+ngx_prefix splice
+
+upstream=127.0.0.1:$(($PORT + 2))
+tick=`getconf CLK_TCK`
+
+
+for splice in off on; do
+
+    cat > $prefix/conf/nginx.conf << END
+worker_processes  1;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  1024;
+}
+
+stream {
+    server {
+        listen  127.0.0.1:$PORT;
+
+        proxy_pass               $upstream;
+        proxy_splice             $splice;
+        proxy_downstream_buffer  64k;
+        proxy_upstream_buffer    64k;
+    }
+}
+
+http {
+    access_log  off;
+
+    server {
+        listen  127.0.0.1:$(($PORT + 1));
+
+        location / {
+            proxy_pass          http://$upstream;
+            proxy_http_version  1.1;
+            proxy_set_header    Upgrade     \$http_upgrade;
+            proxy_set_header    Connection  upgrade;
+            proxy_buffer_size   64k;
+            proxy_buffers       4 64k;
+            proxy_splice        $splice;
+        }
+    }
+}
+END
+
+    ngx_start
+
+    for test in "stream 0" "stream 0 -r" "http 1 -u" "http 1 -u -r"; do
+
+        set -- $test
+
+        cpu=`ngx_cpu`
+
+        result=`objs/test/tcp_load -c 16 -d $DURATION $3 $4 \
+                                   $upstream 127.0.0.1:$(($PORT + $2))`
+
+        cpu=$((`ngx_cpu` - $cpu))
+
+        case "$3$4" in
+        *-r*) direction="upstream to client" ;;
+        *)    direction="client to upstream" ;;
+        esac
+
+        echo "$1, proxy_splice $splice, $direction: $result," \
+             "worker cpu $(($cpu * 100 / $tick / $DURATION))%"
+    done
+
+    ngx_stop
+done
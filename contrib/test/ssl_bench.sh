@@ -0,0 +1,81 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# compares "ssl_handshake_threads off" and "on" on one worker process with
+# an RSA 2048 key: 32 connections make full handshakes in a loop while
+# 4 keepalive connections request a small file over plain HTTP from the
+# same worker, to show the delay the handshakes add to other connections
+
+. contrib/test/bench.sh
+
+if ! grep -q 'NGX_OPENSSL' objs/ngx_auto_config.h \
+   || ! grep -q 'NGX_THREADS' objs/ngx_auto_config.h
+then
+    echo "ssl_bench: skipped, nginx is built without SSL or threads"
+    exit 0
+fi
+
+if ! type openssl >/dev/null 2>&1; then
+    echo "ssl_bench: skipped, openssl is not found"
+    exit 0
+fi
+
+ngx_prefix ssl
+
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost \
+        -keyout $prefix/conf/localhost.key -out $prefix/conf/localhost.crt \
+        2>/dev/null || exit 1
+
+echo 'a small response' > $prefix/html/index.html
+
+
+for threads in off on; do
+
+    cat > $prefix/conf/nginx.conf << END
+worker_processes  1;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  1024;
+}
+
+http {
+    access_log  off;
+
+    server {
+        listen  127.0.0.1:$PORT ssl;
+
+        ssl_certificate       localhost.crt;
+        ssl_certificate_key   localhost.key;
+        ssl_session_cache     off;
+        ssl_session_tickets   off;
+
+        ssl_handshake_threads  $threads;
+    }
+
+    server {
+        listen  127.0.0.1:$(($PORT + 1));
+
+        location / {
+            root  html;
+        }
+    }
+}
+END
+
+    ngx_start
+
+    objs/test/ssl_load -c 32 -d $DURATION 127.0.0.1:$PORT \
+                       > $prefix/ssl_load &
+
+    $LOAD -c 4 -d $DURATION 127.0.0.1:$(($PORT + 1)) / > $prefix/http_load
+
+    wait
+
+    ngx_stop
+
+    echo "ssl_handshake_threads $threads:"
+    echo "    ssl:  `cat $prefix/ssl_load`"
+    echo "    http: `cat $prefix/http_load`"
+done
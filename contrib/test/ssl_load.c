@@ -0,0 +1,419 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * a TLS handshake load generator for the benchmark scripts
+ *
+ *     ssl_load [-c connections] [-d seconds] address
+ *
+ * each connection makes a full handshake without a session to resume,
+ * closes the connection, and connects again; when the time is over, the
+ * handshakes in progress are finished, as closing a connection during
+ * a handshake makes nginx log errors
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+#include <ngx_test.h>
+
+
+#if (NGX_OPENSSL)
+
+#include <poll.h>
+
+
+typedef struct {
+    ngx_socket_t             fd;
+    SSL                     *ssl;
+    short                    events;
+    uint64_t                 start;
+} ngx_ssl_load_conn_t;
+
+
+typedef struct {
+    ngx_url_t                url;
+
+    ngx_uint_t               connections;
+    ngx_uint_t               seconds;
+
+    SSL_CTX                 *ctx;
+
+    ngx_uint_t               handshakes;
+    ngx_uint_t               errors;
+
+    ngx_array_t              latency;
+} ngx_ssl_load_t;
+
+
+static ngx_int_t ngx_ssl_load_options(ngx_ssl_load_t *sl, int argc,
+    char *const *argv);
+static ngx_int_t ngx_ssl_load_connect(ngx_ssl_load_t *sl,
+    ngx_ssl_load_conn_t *c);
+static void ngx_ssl_load_handshake(ngx_ssl_load_t *sl,
+    ngx_ssl_load_conn_t *c);
+static void ngx_ssl_load_close(ngx_ssl_load_conn_t *c);
+static void ngx_ssl_load_report(ngx_ssl_load_t *sl, uint64_t time);
+static int ngx_libc_cdecl ngx_ssl_load_cmp(const void *one,
+    const void *two);
+
+
+static ngx_ssl_load_t  ngx_ssl_load;
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    int                   n;
+    uint64_t              start, end, now, time;
+    ngx_uint_t            i, active;
+    ngx_log_t            *log;
+    struct pollfd        *pfd;
+    ngx_ssl_load_t       *sl;
+    ngx_ssl_load_conn_t  *c, *conns;
+
+    log = ngx_test_init(argc, argv);
+    if (log == NULL) {
+        return 1;
+    }
+
+    sl = &ngx_ssl_load;
+
+    if (ngx_ssl_load_options(sl, argc, argv) != NGX_OK) {
+        ngx_log_stderr(0, "usage: ssl_load [-c connections] [-d seconds] "
+                       "address");
+        return 1;
+    }
+
+    if (ngx_ssl_init(log) != NGX_OK) {
+        return 1;
+    }
+
+    sl->ctx = SSL_CTX_new(SSLv23_client_method());
+
+    if (sl->ctx == NULL) {
+        ngx_ssl_error(NGX_LOG_EMERG, log, 0, "SSL_CTX_new() failed");
+        return 1;
+    }
+
+    SSL_CTX_set_session_cache_mode(sl->ctx, SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_options(sl->ctx, SSL_OP_NO_TICKET);
+
+    if (ngx_array_init(&sl->latency, ngx_cycle->pool, 65536, sizeof(uint32_t))
+        != NGX_OK)
+    {
+        return 1;
+    }
+
+    conns = ngx_calloc(sl->connections * sizeof(ngx_ssl_load_conn_t), log);
+    pfd = ngx_calloc(sl->connections * sizeof(struct pollfd), log);
+
+    if (conns == NULL || pfd == NULL) {
+        return 1;
+    }
+
+    for (i = 0; i < sl->connections; i++) {
+        conns[i].fd = (ngx_socket_t) -1;
+    }
+
+    start = ngx_test_nsec();
+    end = start + (uint64_t) sl->seconds * 1000000000;
+
+    time = 0;
+
+    for ( ;; ) {
+
+        now = ngx_test_nsec();
+
+        if (now >= end && time == 0) {
+            time = now - start;
+            ngx_ssl_load_report(sl, time);
+        }
+
+        active = 0;
+
+        for (i = 0; i < sl->connections; i++) {
+            c = &conns[i];
+
+            if (c->fd == (ngx_socket_t) -1
+                && time == 0
+                && ngx_ssl_load_connect(sl, c) != NGX_OK)
+            {
+                return 1;
+            }
+
+            if (c->fd != (ngx_socket_t) -1) {
+                active++;
+            }
+
+            pfd[i].fd = c->fd;
+            pfd[i].events = c->events;
+            pfd[i].revents = 0;
+        }
+
+        if (active == 0) {
+            break;
+        }
+
+        n = poll(pfd, sl->connections,
+                 time ? 1000 : (int) ((end - now) / 1000000 + 1));
+
+        if (n == 0 && time) {
+            ngx_log_stderr(0, "%ui handshakes are not finished", active);
+            return 1;
+        }
+
+        if (n == -1) {
+            if (ngx_errno == NGX_EINTR) {
+                continue;
+            }
+
+            ngx_log_stderr(ngx_errno, "poll() failed");
+            return 1;
+        }
+
+        for (i = 0; i < sl->connections && n; i++) {
+            if (pfd[i].revents == 0) {
+                continue;
+            }
+
+            n--;
+
+            ngx_ssl_load_handshake(sl, &conns[i]);
+        }
+    }
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_ssl_load_options(ngx_ssl_load_t *sl, int argc, char *const *argv)
+{
+    u_char     *p;
+    ngx_int_t   n;
+    ngx_uint_t  i;
+
+    sl->connections = 10;
+    sl->seconds = 10;
+
+    for (i = 1; i < (ngx_uint_t) argc; i++) {
+
+        p = (u_char *) argv[i];
+
+        if (*p != '-') {
+            break;
+        }
+
+        if (p[2] != '\0' || i + 1 == (ngx_uint_t) argc) {
+            return NGX_ERROR;
+        }
+
+        p = (u_char *) argv[++i];
+
+        n = ngx_atoi(p, ngx_strlen(p));
+
+        if (n <= 0) {
+            return NGX_ERROR;
+        }
+
+        switch (argv[i - 1][1]) {
+
+        case 'c':
+            sl->connections = n;
+            continue;
+
+        case 'd':
+            sl->seconds = n;
+            continue;
+
+        default:
+            return NGX_ERROR;
+        }
+    }
+
+    if (i + 1 != (ngx_uint_t) argc) {
+        return NGX_ERROR;
+    }
+
+    sl->url.url.data = (u_char *) argv[i];
+    sl->url.url.len = ngx_strlen(argv[i]);
+    sl->url.default_port = 443;
+
+    if (ngx_parse_url(ngx_cycle->pool, &sl->url) != NGX_OK) {
+        if (sl->url.err) {
+            ngx_log_stderr(0, "%s in \"%V\"", sl->url.err, &sl->url.url);
+        }
+
+        return NGX_ERROR;
+    }
+
+    if (sl->url.naddrs == 0) {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_ssl_load_connect(ngx_ssl_load_t *sl, ngx_ssl_load_conn_t *c)
+{
+    ngx_err_t     err;
+    ngx_socket_t  s;
+
+    s = ngx_socket(sl->url.addrs[0].sockaddr->sa_family, SOCK_STREAM, 0);
+
+    if (s == (ngx_socket_t) -1) {
+        ngx_log_stderr(ngx_socket_errno, ngx_socket_n " failed");
+        return NGX_ERROR;
+    }
+
+    if (ngx_nonblocking(s) == -1) {
+        ngx_close_socket(s);
+        return NGX_ERROR;
+    }
+
+    c->fd = s;
+    c->events = POLLOUT;
+    c->start = ngx_test_nsec();
+
+    c->ssl = SSL_new(sl->ctx);
+
+    if (c->ssl == NULL || SSL_set_fd(c->ssl, s) == 0) {
+        ngx_ssl_error(NGX_LOG_EMERG, ngx_cycle->log, 0, "SSL_new() failed");
+        ngx_ssl_load_close(c);
+        return NGX_ERROR;
+    }
+
+    SSL_set_connect_state(c->ssl);
+
+    if (connect(s, sl->url.addrs[0].sockaddr, sl->url.addrs[0].socklen) == -1)
+    {
+        err = ngx_socket_errno;
+
+        if (err != NGX_EINPROGRESS) {
+            ngx_log_stderr(err, "connect() to %V failed", &sl->url.url);
+            ngx_ssl_load_close(c);
+            return NGX_ERROR;
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_ssl_load_handshake(ngx_ssl_load_t *sl, ngx_ssl_load_conn_t *c)
+{
+    int       n, sslerr;
+    uint32_t  latency;
+
+    n = SSL_do_handshake(c->ssl);
+
+    if (n == 1) {
+        latency = (uint32_t) ((ngx_test_nsec() - c->start) / 1000);
+        *(uint32_t *) ngx_array_push(&sl->latency) = latency;
+
+        sl->handshakes++;
+
+        (void) SSL_shutdown(c->ssl);
+        ngx_ssl_load_close(c);
+        return;
+    }
+
+    sslerr = SSL_get_error(c->ssl, n);
+
+    if (sslerr == SSL_ERROR_WANT_READ) {
+        c->events = POLLIN;
+        return;
+    }
+
+    if (sslerr == SSL_ERROR_WANT_WRITE) {
+        c->events = POLLOUT;
+        return;
+    }
+
+    ERR_clear_error();
+
+    sl->errors++;
+    ngx_ssl_load_close(c);
+}
+
+
+static void
+ngx_ssl_load_close(ngx_ssl_load_conn_t *c)
+{
+    if (c->ssl) {
+        SSL_free(c->ssl);
+        c->ssl = NULL;
+    }
+
+    if (c->fd != (ngx_socket_t) -1) {
+        (void) ngx_close_socket(c->fd);
+        c->fd = (ngx_socket_t) -1;
+    }
+}
+
+
+static void
+ngx_ssl_load_report(ngx_ssl_load_t *sl, uint64_t time)
+{
+    double      seconds, avg;
+    uint32_t   *lat;
+    uint64_t    sum;
+    ngx_uint_t  i, n;
+
+    seconds = (double) time / 1000000000;
+
+    lat = sl->latency.elts;
+    n = sl->latency.nelts;
+
+    sum = 0;
+
+    for (i = 0; i < n; i++) {
+        sum += lat[i];
+    }
+
+    avg = n ? (double) sum / n / 1000 : 0;
+
+    ngx_qsort(lat, n, sizeof(uint32_t), ngx_ssl_load_cmp);
+
+    printf("handshakes %lu, %.0f per second, latency ms: "
+           "avg %.2f, p50 %.2f, p99 %.2f, max %.2f, errors %lu\n",
+           (unsigned long) sl->handshakes, sl->handshakes / seconds, avg,
+           n ? lat[n / 2] / 1000.0 : 0,
+           n ? lat[n * 99 / 100] / 1000.0 : 0,
+           n ? lat[n - 1] / 1000.0 : 0,
+           (unsigned long) sl->errors);
+}
+
+
+static int ngx_libc_cdecl
+ngx_ssl_load_cmp(const void *one, const void *two)
+{
+    uint32_t  a, b;
+
+    a = *(uint32_t *) one;
+    b = *(uint32_t *) two;
+
+    return (a > b) - (a < b);
+}
+
+
+#else
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    printf("ssl_load: skipped, nginx is built without SSL\n");
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,119 @@
+
+# Copyright (C) Nginx, Inc.
+
+
+# "sub_filter ab 1; sub_filter abc 2;": of the strings starting at the same
+# position the longest one is replaced; the file is also read into buffers
+# of 1 to 4 bytes, so that the strings are split between buffers
+
+. contrib/test/bench.sh
+
+if ! grep -q 'ngx_http_sub_filter_module' objs/ngx_modules.c; then
+    echo "sub_filter_test: skipped, nginx is built without the sub module"
+    exit 0
+fi
+
+if ! type curl >/dev/null 2>&1; then
+    echo "sub_filter_test: skipped, curl is not found"
+    exit 0
+fi
+
+ngx_prefix sub_filter
+
+cat > $prefix/html/test.txt << END
+xabcx abx
+abc
+ab
+abab
+ababc
+aabc
+abcab
+abdabc
+a
+aab
+END
+
+cat > $prefix/expected << END
+x2x 1x
+2
+1
+11
+12
+a2
+21
+1d2
+a
+a1
+END
+
+cat > $prefix/conf/nginx.conf << END
+worker_processes  1;
+error_log  logs/error.log  notice;
+
+events {
+    worker_connections  64;
+}
+
+http {
+    access_log  off;
+    sendfile    off;
+
+    default_type  text/plain;
+
+    sub_filter_types  text/plain;
+    sub_filter_once   off;
+
+    sub_filter  ab   1;
+    sub_filter  abc  2;
+
+    server {
+        listen  127.0.0.1:$PORT;
+
+        location / {
+            root  html;
+        }
+
+        location /1/ {
+            alias  html/;
+            output_buffers  2 1;
+        }
+
+        location /2/ {
+            alias  html/;
+            output_buffers  2 2;
+        }
+
+        location /3/ {
+            alias  html/;
+            output_buffers  2 3;
+        }
+
+        location /4/ {
+            alias  html/;
+            output_buffers  2 4;
+        }
+    }
+}
+END
+
+ngx_start
+
+failed=0
+
+for uri in /test.txt /1/test.txt /2/test.txt /3/test.txt /4/test.txt; do
+    curl -s -o $prefix/result http://127.0.0.1:$PORT$uri
+
+    if ! cmp -s $prefix/expected $prefix/result; then
+        echo "sub_filter_test: $uri:"
+        diff $prefix/expected $prefix/result
+        failed=1
+    fi
+done
+
+ngx_stop
+
+if [ $failed = 1 ]; then
+    exit 1
+fi
+
+echo "sub_filter_test: ok"
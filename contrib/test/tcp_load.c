@@ -0,0 +1,547 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * a load generator for TCP relays, which is both the client and the
+ * upstream server of the relay
+ *
+ *     tcp_load [-c connections] [-d seconds] [-r] [-u] listen address
+ *
+ * the connections are made to the relay at "address", which connects to
+ * "listen"; then the clients send data as fast as possible, which the
+ * upstream side reads and discards, or the other way round with -r;
+ * with -u the client starts with an HTTP request to upgrade the
+ * connection, and the upstream side responds with 101
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_test.h>
+#include <poll.h>
+
+
+#define NGX_TCP_LOAD_CONNECT       0
+#define NGX_TCP_LOAD_HEADER        1
+#define NGX_TCP_LOAD_DATA          2
+
+#define NGX_TCP_LOAD_BUFFER        65536
+
+
+typedef struct {
+    ngx_socket_t             fd;
+    ngx_uint_t               state;
+    ngx_uint_t               upstream;
+
+    u_char                   header[1024];
+    size_t                   len;
+} ngx_tcp_load_conn_t;
+
+
+typedef struct {
+    ngx_url_t                listen;
+    ngx_url_t                url;
+
+    ngx_uint_t               connections;
+    ngx_uint_t               seconds;
+    ngx_uint_t               reverse;
+    ngx_uint_t               upgrade;
+
+    ngx_uint_t               established;
+    ngx_uint_t               errors;
+    off_t                    bytes;
+} ngx_tcp_load_t;
+
+
+static ngx_int_t ngx_tcp_load_options(ngx_tcp_load_t *tl, int argc,
+    char *const *argv);
+static ngx_int_t ngx_tcp_load_parse_url(ngx_url_t *u, char *url);
+static ngx_socket_t ngx_tcp_load_listen(ngx_tcp_load_t *tl);
+static ngx_int_t ngx_tcp_load_connect(ngx_tcp_load_t *tl,
+    ngx_tcp_load_conn_t *c);
+static void ngx_tcp_load_accept(ngx_tcp_load_t *tl, ngx_socket_t ls,
+    ngx_tcp_load_conn_t *conns);
+static ngx_int_t ngx_tcp_load_handler(ngx_tcp_load_t *tl,
+    ngx_tcp_load_conn_t *c);
+static ngx_int_t ngx_tcp_load_header(ngx_tcp_load_t *tl,
+    ngx_tcp_load_conn_t *c);
+static short ngx_tcp_load_events(ngx_tcp_load_t *tl, ngx_tcp_load_conn_t *c);
+
+
+static ngx_tcp_load_t  ngx_tcp_load;
+
+static u_char  ngx_tcp_load_buffer[NGX_TCP_LOAD_BUFFER];
+
+static char  ngx_tcp_load_request[] =
+    "GET / HTTP/1.1" CRLF
+    "Host: localhost" CRLF
+    "Upgrade: tcp_load" CRLF
+    "Connection: upgrade" CRLF
+    CRLF;
+
+static char  ngx_tcp_load_response[] =
+    "HTTP/1.1 101 Switching Protocols" CRLF
+    "Upgrade: tcp_load" CRLF
+    "Connection: upgrade" CRLF
+    CRLF;
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    int                   n;
+    uint64_t              start, end, now;
+    ngx_uint_t            i, nconns;
+    ngx_log_t            *log;
+    ngx_socket_t          ls;
+    struct pollfd        *pfd;
+    ngx_tcp_load_t       *tl;
+    ngx_tcp_load_conn_t  *c, *conns;
+
+    log = ngx_test_init(argc, argv);
+    if (log == NULL) {
+        return 1;
+    }
+
+    tl = &ngx_tcp_load;
+
+    if (ngx_tcp_load_options(tl, argc, argv) != NGX_OK) {
+        ngx_log_stderr(0, "usage: tcp_load [-c connections] [-d seconds] "
+                       "[-r] [-u] listen address");
+        return 1;
+    }
+
+    ls = ngx_tcp_load_listen(tl);
+    if (ls == (ngx_socket_t) -1) {
+        return 1;
+    }
+
+    /* the clients, and then the connections accepted from the relay */
+
+    nconns = 2 * tl->connections;
+
+    conns = ngx_calloc(nconns * sizeof(ngx_tcp_load_conn_t), log);
+    pfd = ngx_calloc((nconns + 1) * sizeof(struct pollfd), log);
+
+    if (conns == NULL || pfd == NULL) {
+        return 1;
+    }
+
+    for (i = 0; i < nconns; i++) {
+        conns[i].fd = (ngx_socket_t) -1;
+        conns[i].upstream = (i >= tl->connections);
+    }
+
+    for (i = 0; i < tl->connections; i++) {
+        if (ngx_tcp_load_connect(tl, &conns[i]) != NGX_OK) {
+            return 1;
+        }
+    }
+
+    start = ngx_test_nsec();
+    end = start + (uint64_t) tl->seconds * 1000000000;
+
+    for ( ;; ) {
+
+        pfd[0].fd = ls;
+        pfd[0].events = POLLIN;
+        pfd[0].revents = 0;
+
+        for (i = 0; i < nconns; i++) {
+            c = &conns[i];
+
+            pfd[i + 1].fd = c->fd;
+            pfd[i + 1].events = ngx_tcp_load_events(tl, c);
+            pfd[i + 1].revents = 0;
+        }
+
+        now = ngx_test_nsec();
+
+        if (now >= end) {
+            break;
+        }
+
+        n = poll(pfd, nconns + 1, (end - now) / 1000000 + 1);
+
+        if (n == -1) {
+            if (ngx_errno == NGX_EINTR) {
+                continue;
+            }
+
+            ngx_log_stderr(ngx_errno, "poll() failed");
+            return 1;
+        }
+
+        if (pfd[0].revents) {
+            ngx_tcp_load_accept(tl, ls, &conns[tl->connections]);
+        }
+
+        for (i = 0; i < nconns; i++) {
+            if (pfd[i + 1].revents == 0) {
+                continue;
+            }
+
+            c = &conns[i];
+
+            if (ngx_tcp_load_handler(tl, c) == NGX_ERROR) {
+                tl->errors++;
+                (void) ngx_close_socket(c->fd);
+                c->fd = (ngx_socket_t) -1;
+            }
+        }
+    }
+
+    now = ngx_test_nsec() - start;
+
+    printf("connections %lu, %.1f MB/s, errors %lu\n",
+           (unsigned long) tl->established,
+           (double) tl->bytes * 1000000000 / now / 1048576,
+           (unsigned long) tl->errors);
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_tcp_load_options(ngx_tcp_load_t *tl, int argc, char *const *argv)
+{
+    u_char     *p;
+    ngx_int_t   n;
+    ngx_uint_t  i;
+
+    tl->connections = 10;
+    tl->seconds = 10;
+
+    for (i = 1; i < (ngx_uint_t) argc; i++) {
+
+        p = (u_char *) argv[i];
+
+        if (*p != '-') {
+            break;
+        }
+
+        if (p[1] == 'r' && p[2] == '\0') {
+            tl->reverse = 1;
+            continue;
+        }
+
+        if (p[1] == 'u' && p[2] == '\0') {
+            tl->upgrade = 1;
+            continue;
+        }
+
+        if (p[2] != '\0' || i + 1 == (ngx_uint_t) argc) {
+            return NGX_ERROR;
+        }
+
+        p = (u_char *) argv[++i];
+
+        n = ngx_atoi(p, ngx_strlen(p));
+
+        if (n <= 0) {
+            return NGX_ERROR;
+        }
+
+        switch (argv[i - 1][1]) {
+
+        case 'c':
+            tl->connections = n;
+            continue;
+
+        case 'd':
+            tl->seconds = n;
+            continue;
+
+        default:
+            return NGX_ERROR;
+        }
+    }
+
+    if (i + 2 != (ngx_uint_t) argc) {
+        return NGX_ERROR;
+    }
+
+    if (ngx_tcp_load_parse_url(&tl->listen, argv[i]) != NGX_OK
+        || ngx_tcp_load_parse_url(&tl->url, argv[i + 1]) != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_tcp_load_parse_url(ngx_url_t *u, char *url)
+{
+    u->url.data = (u_char *) url;
+    u->url.len = ngx_strlen(url);
+    u->no_resolve = 1;
+
+    if (ngx_parse_url(ngx_cycle->pool, u) != NGX_OK) {
+        if (u->err) {
+            ngx_log_stderr(0, "%s in \"%V\"", u->err, &u->url);
+        }
+
+        return NGX_ERROR;
+    }
+
+    if (u->naddrs == 0) {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_socket_t
+ngx_tcp_load_listen(ngx_tcp_load_t *tl)
+{
+    int           reuseaddr;
+    ngx_socket_t  s;
+
+    s = ngx_socket(tl->listen.addrs[0].sockaddr->sa_family, SOCK_STREAM, 0);
+
+    if (s == (ngx_socket_t) -1) {
+        ngx_log_stderr(ngx_socket_errno, ngx_socket_n " failed");
+        return s;
+    }
+
+    reuseaddr = 1;
+
+    (void) setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const void *) &reuseaddr,
+                      sizeof(int));
+
+    if (bind(s, tl->listen.addrs[0].sockaddr, tl->listen.addrs[0].socklen)
+        == -1)
+    {
+        ngx_log_stderr(ngx_socket_errno, "bind() to %V failed",
+                       &tl->listen.url);
+        goto failed;
+    }
+
+    if (listen(s, 511) == -1) {
+        ngx_log_stderr(ngx_socket_errno, "listen() failed");
+        goto failed;
+    }
+
+    if (ngx_nonblocking(s) == -1) {
+        goto failed;
+    }
+
+    return s;
+
+failed:
+
+    (void) ngx_close_socket(s);
+
+    return (ngx_socket_t) -1;
+}
+
+
+static ngx_int_t
+ngx_tcp_load_connect(ngx_tcp_load_t *tl, ngx_tcp_load_conn_t *c)
+{
+    ngx_err_t     err;
+    ngx_socket_t  s;
+
+    s = ngx_socket(tl->url.addrs[0].sockaddr->sa_family, SOCK_STREAM, 0);
+
+    if (s == (ngx_socket_t) -1) {
+        ngx_log_stderr(ngx_socket_errno, ngx_socket_n " failed");
+        return NGX_ERROR;
+    }
+
+    if (ngx_nonblocking(s) == -1) {
+        (void) ngx_close_socket(s);
+        return NGX_ERROR;
+    }
+
+    c->fd = s;
+    c->state = NGX_TCP_LOAD_CONNECT;
+
+    if (connect(s, tl->url.addrs[0].sockaddr, tl->url.addrs[0].socklen) == -1)
+    {
+        err = ngx_socket_errno;
+
+        if (err != NGX_EINPROGRESS) {
+            ngx_log_stderr(err, "connect() to %V failed", &tl->url.url);
+            return NGX_ERROR;
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_tcp_load_accept(ngx_tcp_load_t *tl, ngx_socket_t ls,
+    ngx_tcp_load_conn_t *conns)
+{
+    ngx_uint_t    i;
+    ngx_socket_t  s;
+
+    for ( ;; ) {
+        s = accept(ls, NULL, NULL);
+
+        if (s == (ngx_socket_t) -1) {
+            return;
+        }
+
+        for (i = 0; i < tl->connections; i++) {
+            if (conns[i].fd == (ngx_socket_t) -1) {
+                break;
+            }
+        }
+
+        if (i == tl->connections || ngx_nonblocking(s) == -1) {
+            tl->errors++;
+            (void) ngx_close_socket(s);
+            continue;
+        }
+
+        conns[i].fd = s;
+        conns[i].len = 0;
+        conns[i].state = tl->upgrade ? NGX_TCP_LOAD_HEADER : NGX_TCP_LOAD_DATA;
+
+        if (!tl->upgrade) {
+            tl->established++;
+        }
+    }
+}
+
+
+static short
+ngx_tcp_load_events(ngx_tcp_load_t *tl, ngx_tcp_load_conn_t *c)
+{
+    switch (c->state) {
+
+    case NGX_TCP_LOAD_CONNECT:
+        return POLLOUT;
+
+    case NGX_TCP_LOAD_HEADER:
+        return POLLIN;
+
+    default: /* NGX_TCP_LOAD_DATA */
+
+        /* the clients send unless -r is set, the upstream side otherwise */
+
+        return (c->upstream == tl->reverse) ? POLLOUT : POLLIN;
+    }
+}
+
+
+static ngx_int_t
+ngx_tcp_load_handler(ngx_tcp_load_t *tl, ngx_tcp_load_conn_t *c)
+{
+    ssize_t  n;
+
+    switch (c->state) {
+
+    case NGX_TCP_LOAD_CONNECT:
+
+        if (tl->upgrade) {
+            n = send(c->fd, ngx_tcp_load_request,
+                     sizeof(ngx_tcp_load_request) - 1, 0);
+
+            if (n != sizeof(ngx_tcp_load_request) - 1) {
+                return NGX_ERROR;
+            }
+
+            c->len = 0;
+            c->state = NGX_TCP_LOAD_HEADER;
+
+            return NGX_OK;
+        }
+
+        c->state = NGX_TCP_LOAD_DATA;
+
+        return NGX_OK;
+
+    case NGX_TCP_LOAD_HEADER:
+        return ngx_tcp_load_header(tl, c);
+
+    default: /* NGX_TCP_LOAD_DATA */
+        break;
+    }
+
+    if (c->upstream == tl->reverse) {
+        n = send(c->fd, ngx_tcp_load_buffer, NGX_TCP_LOAD_BUFFER, 0);
+
+    } else {
+        n = recv(c->fd, ngx_tcp_load_buffer, NGX_TCP_LOAD_BUFFER, 0);
+
+        if (n == 0) {
+            return NGX_ERROR;
+        }
+
+        if (n > 0) {
+            tl->bytes += n;
+        }
+    }
+
+    if (n == -1 && ngx_socket_errno != NGX_EAGAIN) {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_tcp_load_header(ngx_tcp_load_t *tl, ngx_tcp_load_conn_t *c)
+{
+    u_char   *p;
+    ssize_t   n;
+
+    n = recv(c->fd, c->header + c->len, sizeof(c->header) - c->len, 0);
+
+    if (n == -1 && ngx_socket_errno == NGX_EAGAIN) {
+        return NGX_OK;
+    }
+
+    if (n <= 0) {
+        return NGX_ERROR;
+    }
+
+    c->len += n;
+
+    p = ngx_strlcasestrn(c->header, c->header + c->len,
+                         (u_char *) CRLF CRLF, 4 - 1);
+
+    if (p == NULL) {
+        return (c->len == sizeof(c->header)) ? NGX_ERROR : NGX_OK;
+    }
+
+    p += 4;
+
+    if (c->upstream) {
+        n = send(c->fd, ngx_tcp_load_response,
+                 sizeof(ngx_tcp_load_response) - 1, 0);
+
+        if (n != sizeof(ngx_tcp_load_response) - 1) {
+            return NGX_ERROR;
+        }
+
+    } else {
+        if (ngx_strncmp(c->header, "HTTP/1.1 101 ", 13) != 0) {
+            return NGX_ERROR;
+        }
+
+        tl->established++;
+
+        /* the data which came after the response */
+
+        if (tl->reverse) {
+            tl->bytes += c->header + c->len - p;
+        }
+    }
+
+    c->state = NGX_TCP_LOAD_DATA;
+
+    return NGX_OK;
+}
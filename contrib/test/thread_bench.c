@@ -0,0 +1,272 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * a stress benchmark of ngx_thread_task_post(): the event loop keeps
+ * a number of empty tasks in flight in pools of 1, 4 and 16 threads,
+ * and posts a task again as soon as its completion handler is called
+ *
+ *     thread_bench [tasks]
+ *
+ * post      the time spent in ngx_thread_task_post()
+ * latency   from posting a task to its completion handler
+ * queue     the maximum queue depth reported by the pool statistics
+ *
+ * every task must complete exactly once
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+#include <ngx_test.h>
+
+
+#if (NGX_THREADS)
+
+#include <ngx_thread_pool.h>
+
+
+typedef struct {
+    uint64_t             posted;
+    ngx_uint_t           runs;
+} ngx_thread_bench_ctx_t;
+
+
+static ngx_int_t ngx_thread_bench(ngx_cycle_t *cycle, char *name,
+    ngx_uint_t inflight);
+static ngx_int_t ngx_thread_bench_post(ngx_thread_task_t *task);
+static void ngx_thread_bench_handler(void *data, ngx_log_t *log);
+static void ngx_thread_bench_done(ngx_event_t *ev);
+
+
+static char  ngx_thread_bench_conf[] =
+    "daemon off;" CRLF
+    "master_process off;" CRLF
+    "error_log stderr notice;" CRLF
+    "thread_pool t1 threads=1 max_queue=65536;" CRLF
+    "thread_pool t4 threads=4 max_queue=65536;" CRLF
+    "thread_pool t16 threads=16 max_queue=65536;" CRLF
+    "events { worker_connections 64; }" CRLF;
+
+
+static ngx_thread_pool_t  *ngx_thread_bench_pool;
+static ngx_uint_t          ngx_thread_bench_total;
+static ngx_uint_t          ngx_thread_bench_posted;
+static ngx_uint_t          ngx_thread_bench_completed;
+static ngx_uint_t          ngx_thread_bench_errors;
+static uint64_t            ngx_thread_bench_post_time;
+static uint64_t            ngx_thread_bench_latency;
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    ngx_int_t     n;
+    ngx_uint_t    i, k;
+    ngx_cycle_t  *cycle;
+
+    static char        *pools[] = { "t1", "t4", "t16" };
+    static ngx_uint_t   inflight[] = { 1, 16, 256, 4096 };
+
+    if (ngx_test_init(argc, argv) == NULL) {
+        return 1;
+    }
+
+    ngx_thread_bench_total = 200000;
+
+    if (argc > 1) {
+        n = ngx_atoi((u_char *) argv[1], ngx_strlen(argv[1]));
+
+        if (n <= 0) {
+            ngx_log_stderr(0, "invalid number of tasks \"%s\"", argv[1]);
+            return 1;
+        }
+
+        ngx_thread_bench_total = n;
+    }
+
+    cycle = ngx_test_cycle("thread_bench", ngx_thread_bench_conf);
+    if (cycle == NULL) {
+        return 1;
+    }
+
+    printf("%7s %8s %10s %8s %12s %6s\n",
+           "threads", "inflight", "tasks/s", "post, ns", "latency, us",
+           "queue");
+
+    for (i = 0; i < sizeof(pools) / sizeof(char *); i++) {
+        for (k = 0; k < sizeof(inflight) / sizeof(ngx_uint_t); k++) {
+            if (ngx_thread_bench(cycle, pools[i], inflight[k]) != NGX_OK) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_thread_bench(ngx_cycle_t *cycle, char *name, ngx_uint_t inflight)
+{
+    uint64_t                 start, time;
+    ngx_str_t                pool;
+    ngx_uint_t               i, n;
+    ngx_thread_task_t       *task, *tasks;
+    ngx_thread_bench_ctx_t  *ctx;
+
+    static ngx_thread_pool_stats_t  stats;
+
+    pool.len = ngx_strlen(name);
+    pool.data = (u_char *) name;
+
+    ngx_thread_bench_pool = ngx_thread_pool_get(cycle, &pool);
+    if (ngx_thread_bench_pool == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_thread_pool_set_stats(ngx_thread_bench_pool, &stats);
+    ngx_memzero(&stats, sizeof(ngx_thread_pool_stats_t));
+
+    n = ngx_min(inflight, ngx_thread_bench_total);
+
+    tasks = ngx_calloc(n * (sizeof(ngx_thread_task_t)
+                            + sizeof(ngx_thread_bench_ctx_t)), cycle->log);
+    if (tasks == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_thread_bench_posted = 0;
+    ngx_thread_bench_completed = 0;
+    ngx_thread_bench_errors = 0;
+    ngx_thread_bench_post_time = 0;
+    ngx_thread_bench_latency = 0;
+
+    ctx = (ngx_thread_bench_ctx_t *) &tasks[n];
+
+    start = ngx_test_nsec();
+
+    for (i = 0; i < n; i++) {
+        task = &tasks[i];
+
+        task->ctx = &ctx[i];
+        task->handler = ngx_thread_bench_handler;
+        task->event.data = task;
+        task->event.handler = ngx_thread_bench_done;
+        task->event.log = cycle->log;
+
+        if (ngx_thread_bench_post(task) != NGX_OK) {
+            return NGX_ERROR;
+        }
+    }
+
+    while (ngx_thread_bench_completed < ngx_thread_bench_total
+           && ngx_thread_bench_errors == 0)
+    {
+        ngx_process_events_and_timers(cycle);
+    }
+
+    time = ngx_test_nsec() - start;
+
+    for (i = 0; i < n; i++) {
+        if (ctx[i].runs == 0 || tasks[i].event.active) {
+            ngx_thread_bench_errors++;
+        }
+    }
+
+    ngx_free(tasks);
+
+    printf("%7s %8lu %10.0f %8.1f %12.1f %6lu\n",
+           name + 1, (unsigned long) inflight,
+           (double) ngx_thread_bench_completed * 1000000000 / time,
+           (double) ngx_thread_bench_post_time / ngx_thread_bench_posted,
+           (double) ngx_thread_bench_latency / ngx_thread_bench_completed
+           / 1000,
+           (unsigned long) stats.max_queue);
+
+    if (ngx_thread_bench_errors
+        || ngx_thread_bench_completed != ngx_thread_bench_total
+        || stats.waiting != 0
+        || stats.posted != ngx_thread_bench_total)
+    {
+        ngx_log_stderr(0, "%s: %ui of %ui tasks completed, %ui posted, "
+                       "%ui errors, %uA waiting",
+                       name, ngx_thread_bench_completed,
+                       ngx_thread_bench_total, (ngx_uint_t) stats.posted,
+                       ngx_thread_bench_errors, stats.waiting);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_thread_bench_post(ngx_thread_task_t *task)
+{
+    uint64_t                 start;
+    ngx_int_t                rc;
+    ngx_thread_bench_ctx_t  *ctx;
+
+    ctx = task->ctx;
+
+    start = ngx_test_nsec();
+
+    rc = ngx_thread_task_post(ngx_thread_bench_pool, task);
+
+    ctx->posted = ngx_test_nsec();
+
+    ngx_thread_bench_post_time += ctx->posted - start;
+    ngx_thread_bench_posted++;
+
+    if (rc != NGX_OK) {
+        ngx_thread_bench_errors++;
+    }
+
+    return rc;
+}
+
+
+static void
+ngx_thread_bench_handler(void *data, ngx_log_t *log)
+{
+    ngx_thread_bench_ctx_t *ctx = data;
+
+    ctx->runs++;
+}
+
+
+static void
+ngx_thread_bench_done(ngx_event_t *ev)
+{
+    ngx_thread_task_t *task = ev->data;
+
+    ngx_thread_bench_ctx_t  *ctx;
+
+    ctx = task->ctx;
+
+    ngx_thread_bench_latency += ngx_test_nsec() - ctx->posted;
+    ngx_thread_bench_completed++;
+
+    if (ngx_thread_bench_posted < ngx_thread_bench_total) {
+        (void) ngx_thread_bench_post(task);
+    }
+}
+
+
+#else
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    printf("thread_bench: skipped, nginx is built without threads\n");
+
+    return 0;
+}
+
+#endif
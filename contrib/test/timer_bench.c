@@ -0,0 +1,225 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+/*
+ * compares the event timer backends, the red-black tree and the timing
+ * wheel ("timer_wheel on"), at several numbers of armed timers:
+ *
+ *     timer_bench [timers ...]
+ *
+ * add      adding a timer of 1 to 61 seconds
+ * rearm    moving an armed timer to a new random time
+ * find     ngx_event_find_timer()
+ * expire   ngx_event_find_timer() and ngx_event_expire_timers() called
+ *          every millisecond until all timers fire, per fired timer
+ *
+ * all timers must fire, none before its time and none late
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+#include <ngx_test.h>
+
+
+#define NGX_TEST_FIND  1000000
+
+
+static ngx_int_t ngx_timer_bench(ngx_log_t *log, ngx_uint_t n,
+    ngx_uint_t wheel);
+static void ngx_timer_bench_handler(ngx_event_t *ev);
+
+
+static ngx_event_t    *ngx_timer_bench_events;
+static ngx_msec_t     *ngx_timer_bench_keys;
+static ngx_uint_t      ngx_timer_bench_fired;
+static ngx_msec_int_t  ngx_timer_bench_early;
+static ngx_msec_int_t  ngx_timer_bench_late;
+
+
+int ngx_cdecl
+main(int argc, char *const *argv)
+{
+    ngx_int_t    n;
+    ngx_uint_t   i, k;
+    ngx_log_t   *log;
+    ngx_uint_t   counts[16];
+
+    log = ngx_test_init(argc, argv);
+    if (log == NULL) {
+        return 1;
+    }
+
+    k = 0;
+
+    for (i = 1; i < (ngx_uint_t) argc && k < 16; i++) {
+        n = ngx_atoi((u_char *) argv[i], ngx_strlen(argv[i]));
+
+        if (n <= 0) {
+            ngx_log_stderr(0, "invalid number of timers \"%s\"", argv[i]);
+            return 1;
+        }
+
+        counts[k++] = n;
+    }
+
+    if (k == 0) {
+        counts[k++] = 1000;
+        counts[k++] = 10000;
+        counts[k++] = 100000;
+        counts[k++] = 500000;
+    }
+
+    printf("%9s %-8s %10s %10s %10s %10s\n",
+           "timers", "backend", "add, ns", "rearm, ns", "find, ns",
+           "expire, ns");
+
+    for (i = 0; i < k; i++) {
+        if (ngx_timer_bench(log, counts[i], 0) != NGX_OK
+            || ngx_timer_bench(log, counts[i], 1) != NGX_OK)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static ngx_int_t
+ngx_timer_bench(ngx_log_t *log, ngx_uint_t n, ngx_uint_t wheel)
+{
+    uint64_t           start, add, rearm, find, expire;
+    ngx_msec_t         end;
+    ngx_uint_t         i, k;
+    ngx_msec_t        *keys;
+    ngx_event_t       *events;
+    ngx_connection_t   c;
+
+    ngx_use_timer_wheel = wheel;
+    ngx_current_msec = 1000;
+
+    if (ngx_event_timer_init(log) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    events = ngx_calloc(n * sizeof(ngx_event_t), log);
+    if (events == NULL) {
+        return NGX_ERROR;
+    }
+
+    /* the rbtree clears the key of a deleted node */
+
+    keys = ngx_alloc(n * sizeof(ngx_msec_t), log);
+    if (keys == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_timer_bench_events = events;
+    ngx_timer_bench_keys = keys;
+
+    ngx_memzero(&c, sizeof(ngx_connection_t));
+    c.fd = (ngx_socket_t) -1;
+
+    for (i = 0; i < n; i++) {
+        events[i].data = &c;
+        events[i].log = log;
+        events[i].handler = ngx_timer_bench_handler;
+    }
+
+    srandom(n);
+
+    start = ngx_test_nsec();
+
+    for (i = 0; i < n; i++) {
+        ngx_add_timer(&events[i], 1000 + ngx_random() % 60000);
+    }
+
+    add = ngx_test_nsec() - start;
+
+    for (i = 0; i < n; i++) {
+        keys[i] = events[i].timer.key;
+    }
+
+    start = ngx_test_nsec();
+
+    for (i = 0; i < n; i++) {
+        k = ngx_random() % n;
+        ngx_add_timer(&events[k], 1000 + ngx_random() % 60000);
+        keys[k] = events[k].timer.key;
+    }
+
+    rearm = ngx_test_nsec() - start;
+
+    start = ngx_test_nsec();
+
+    for (i = 0; i < NGX_TEST_FIND; i++) {
+        (void) ngx_event_find_timer();
+    }
+
+    find = ngx_test_nsec() - start;
+
+    ngx_timer_bench_fired = 0;
+    ngx_timer_bench_early = 0;
+    ngx_timer_bench_late = 0;
+
+    end = ngx_current_msec + 62000;
+
+    start = ngx_test_nsec();
+
+    while (ngx_current_msec != end) {
+        ngx_current_msec++;
+
+        (void) ngx_event_find_timer();
+        ngx_event_expire_timers();
+    }
+
+    expire = ngx_test_nsec() - start;
+
+    printf("%9lu %-8s %10.1f %10.1f %10.1f %10.1f\n",
+           (unsigned long) n, wheel ? "wheel" : "rbtree",
+           (double) add / n, (double) rearm / n,
+           (double) find / NGX_TEST_FIND, (double) expire / n);
+
+    ngx_free(events);
+    ngx_free(keys);
+
+    if (ngx_timer_bench_fired != n
+        || ngx_event_no_timers_left() != NGX_OK
+        || ngx_timer_bench_early
+        || ngx_timer_bench_late)
+    {
+        ngx_log_stderr(0, "%s: %ui of %ui timers fired, "
+                       "%M ms early, %M ms late",
+                       wheel ? "wheel" : "rbtree", ngx_timer_bench_fired, n,
+                       ngx_timer_bench_early, ngx_timer_bench_late);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_timer_bench_handler(ngx_event_t *ev)
+{
+    ngx_msec_int_t  diff;
+
+    ngx_timer_bench_fired++;
+
+    diff = (ngx_msec_int_t) (ngx_current_msec
+                             - ngx_timer_bench_keys[ev - ngx_timer_bench_events]);
+
+    if (diff < 0 && -diff > ngx_timer_bench_early) {
+        ngx_timer_bench_early = -diff;
+    }
+
+    if (diff > ngx_timer_bench_late) {
+        ngx_timer_bench_late = diff;
+    }
+}
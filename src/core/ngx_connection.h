@@ -118,7 +118,7 @@ typedef enum {
 
 #define NGX_LOWLEVEL_BUFFERED  0x0f
 #define NGX_SSL_BUFFERED       0x01
-#define NGX_SPDY_BUFFERED      0x02
+#define NGX_HTTP_V2_BUFFERED   0x02
 
 /* http */
 struct ngx_connection_s { 
@@ -127,6 +127,7 @@ struct ngx_connection_s {
     ngx_event_t        *write;    /* д¼Ϣ */
 
     ngx_socket_t        fd;  /* ӶӦfd */
+    int                 type;
 
     ngx_recv_pt         recv;  /* պָ   ngx_unix_recv */
     ngx_send_pt         send;  /* ͺָ    ngx_unix_send */
@@ -174,6 +175,7 @@ struct ngx_connection_s {
     unsigned            idle:1; 	/* Ϊ1ʾӴڿ״̬keepaliveм״̬ */
     unsigned            reusable:1; /* Ϊ1ʾӿãqueueֶζӦʹ */
     unsigned            close:1; 	/* ʾӹر */
+    unsigned            shared:1;
 	/* Ϊ1ʾڽļеݷӵһ  todo  */
     unsigned            sendfile:1; 
     
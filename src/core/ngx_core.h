@@ -27,6 +27,7 @@ typedef struct ngx_connection_s  ngx_connection_t;
 
 #if (NGX_THREADS)
 typedef struct ngx_thread_task_s  ngx_thread_task_t;
+typedef struct ngx_thread_pool_s  ngx_thread_pool_t;
 #endif
 
 typedef void (*ngx_event_handler_pt)(ngx_event_t *ev);
@@ -102,6 +103,11 @@ typedef void (*ngx_connection_handler_pt)(ngx_connection_t *c);
 
 void ngx_cpuinfo(void);
 
+#define NGX_CPU_SSE42        0x0001
+#define NGX_CPU_AVX2         0x0002
+
+extern ngx_uint_t  ngx_cpu_features;
+
 #if (NGX_HAVE_OPENAT)
 #define NGX_DISABLE_SYMLINKS_OFF        0
 #define NGX_DISABLE_SYMLINKS_ON         1
@@ -9,10 +9,14 @@
 #include <ngx_core.h>
 
 
+ngx_uint_t  ngx_cpu_features;
+
+
 #if (( __i386__ || __amd64__ ) && ( __GNUC__ || __INTEL_COMPILER ))
 
 
 static ngx_inline void ngx_cpuid(uint32_t i, uint32_t *buf);
+static ngx_inline uint32_t ngx_xgetbv(void);
 
 
 #if ( __i386__ )
@@ -31,6 +35,7 @@ ngx_cpuid(uint32_t i, uint32_t *buf)
 
     "    mov    %%ebx, %%esi;  "
 
+    "    xor    %%ecx, %%ecx;  "
     "    cpuid;                "
     "    mov    %%eax, (%1);   "
     "    mov    %%ebx, 4(%1);  "
@@ -55,7 +60,7 @@ ngx_cpuid(uint32_t i, uint32_t *buf)
 
         "cpuid"
 
-    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (i) );
+    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (i), "c" (0) );
 
     buf[0] = eax;
     buf[1] = ebx;
@@ -67,13 +72,30 @@ ngx_cpuid(uint32_t i, uint32_t *buf)
 #endif
 
 
+static ngx_inline uint32_t
+ngx_xgetbv(void)
+{
+    uint32_t  eax, edx;
+
+    /* xgetbv, the opcode is used for old assemblers */
+
+    __asm__ (
+
+        ".byte 0x0f, 0x01, 0xd0"
+
+    : "=a" (eax), "=d" (edx) : "c" (0) );
+
+    return eax;
+}
+
+
 /* auto detect the L2 cache line size of modern and widespread CPUs */
 
 void
 ngx_cpuinfo(void)
 {
     u_char    *vendor;
-    uint32_t   vbuf[5], cpu[4], model;
+    uint32_t   vbuf[5], cpu[4], ext[4], model;
 
     vbuf[0] = 0;
     vbuf[1] = 0;
@@ -91,6 +113,27 @@ ngx_cpuinfo(void)
 
     ngx_cpuid(1, cpu);
 
+    /* cpu[3] is %ecx */
+
+    if (cpu[3] & 0x00100000) {
+        ngx_cpu_features |= NGX_CPU_SSE42;
+    }
+
+    /* AVX2 requires the OS to save the YMM state, see OSXSAVE and XCR0 */
+
+    if (vbuf[0] >= 7
+        && (cpu[3] & 0x18000000) == 0x18000000
+        && (ngx_xgetbv() & 0x06) == 0x06)
+    {
+        ngx_cpuid(7, ext);
+
+        /* ext[1] is %ebx */
+
+        if (ext[1] & 0x00000020) {
+            ngx_cpu_features |= NGX_CPU_AVX2;
+        }
+    }
+
     if (ngx_strcmp(vendor, "GenuineIntel") == 0) {
 
         switch ((cpu[0] & 0xf00) >> 8) {
@@ -263,6 +263,46 @@ ngx_radix32tree_find(ngx_radix_tree_t *tree, uint32_t key)
 }
 
 
+/*
+ * returns the value of the most specific prefix that covers
+ * the whole key/mask network, longer prefixes are not looked at
+ */
+
+uintptr_t
+ngx_radix32tree_find_covering(ngx_radix_tree_t *tree, uint32_t key,
+    uint32_t mask)
+{
+    uint32_t           bit;
+    uintptr_t          value;
+    ngx_radix_node_t  *node;
+
+    bit = 0x80000000;
+    value = NGX_RADIX_NO_VALUE;
+    node = tree->root;
+
+    while (node) {
+        if (node->value != NGX_RADIX_NO_VALUE) {
+            value = node->value;
+        }
+
+        if (!(mask & bit)) {
+            break;
+        }
+
+        if (key & bit) {
+            node = node->right;
+
+        } else {
+            node = node->left;
+        }
+
+        bit >>= 1;
+    }
+
+    return value;
+}
+
+
 #if (NGX_HAVE_INET6)
 
 ngx_int_t
@@ -457,6 +497,49 @@ ngx_radix128tree_find(ngx_radix_tree_t *tree, u_char *key)
     return value;
 }
 
+
+uintptr_t
+ngx_radix128tree_find_covering(ngx_radix_tree_t *tree, u_char *key,
+    u_char *mask)
+{
+    u_char             bit;
+    uintptr_t          value;
+    ngx_uint_t         i;
+    ngx_radix_node_t  *node;
+
+    i = 0;
+    bit = 0x80;
+    value = NGX_RADIX_NO_VALUE;
+    node = tree->root;
+
+    while (node) {
+        if (node->value != NGX_RADIX_NO_VALUE) {
+            value = node->value;
+        }
+
+        if (i == 16 || !(mask[i] & bit)) {
+            break;
+        }
+
+        if (key[i] & bit) {
+            node = node->right;
+
+        } else {
+            node = node->left;
+        }
+
+        bit >>= 1;
+
+        if (bit == 0) {
+            i++;
+            bit = 0x80;
+        }
+    }
+
+    return value;
+}
+
+
 #endif
 
 
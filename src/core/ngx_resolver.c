@@ -48,6 +48,27 @@ typedef struct {
 } ngx_resolver_an_t;
 
 
+typedef struct {
+    ngx_rbtree_t            rbtree;
+    ngx_rbtree_node_t       sentinel;
+    ngx_queue_t             queue;
+} ngx_resolver_shctx_t;
+
+
+typedef struct {
+    ngx_rbtree_node_t       node;
+    ngx_queue_t             queue;
+    time_t                  valid;
+    u_short                 nlen;
+    u_short                 cnlen;
+    u_short                 naddrs;
+    u_short                 naddrs6;
+    u_char                  ipv6;
+    /* name, then either cname or IPv4 and IPv6 addresses */
+    u_char                  data[1];
+} ngx_resolver_shnode_t;
+
+
 #define ngx_resolver_node(n)                                                 \
     (ngx_resolver_node_t *)                                                  \
         ((u_char *) (n) - offsetof(ngx_resolver_node_t, node))
@@ -60,6 +81,8 @@ static void ngx_resolver_cleanup(void *data);
 static void ngx_resolver_cleanup_tree(ngx_resolver_t *r, ngx_rbtree_t *tree);
 static ngx_int_t ngx_resolve_name_locked(ngx_resolver_t *r,
     ngx_resolver_ctx_t *ctx);
+static ngx_int_t ngx_resolve_srv_locked(ngx_resolver_t *r,
+    ngx_resolver_ctx_t *ctx);
 static void ngx_resolver_expire(ngx_resolver_t *r, ngx_rbtree_t *tree,
     ngx_queue_t *queue);
 static ngx_int_t ngx_resolver_send_query(ngx_resolver_t *r,
@@ -68,6 +91,8 @@ static ngx_int_t ngx_resolver_create_name_query(ngx_resolver_node_t *rn,
     ngx_resolver_ctx_t *ctx);
 static ngx_int_t ngx_resolver_create_addr_query(ngx_resolver_node_t *rn,
     ngx_resolver_ctx_t *ctx);
+static ngx_int_t ngx_resolver_create_srv_query(ngx_resolver_node_t *rn,
+    ngx_resolver_ctx_t *ctx);
 static void ngx_resolver_resend_handler(ngx_event_t *ev);
 static time_t ngx_resolver_resend(ngx_resolver_t *r, ngx_rbtree_t *tree,
     ngx_queue_t *queue);
@@ -79,8 +104,12 @@ static void ngx_resolver_process_a(ngx_resolver_t *r, u_char *buf, size_t n,
     ngx_uint_t nan, ngx_uint_t ans);
 static void ngx_resolver_process_ptr(ngx_resolver_t *r, u_char *buf, size_t n,
     ngx_uint_t ident, ngx_uint_t code, ngx_uint_t nan);
+static void ngx_resolver_process_srv(ngx_resolver_t *r, u_char *buf, size_t n,
+    ngx_uint_t ident, ngx_uint_t code, ngx_uint_t nan, ngx_uint_t ans);
 static ngx_resolver_node_t *ngx_resolver_lookup_name(ngx_resolver_t *r,
     ngx_str_t *name, uint32_t hash);
+static ngx_resolver_node_t *ngx_resolver_lookup_srv(ngx_resolver_t *r,
+    ngx_str_t *name, uint32_t hash);
 static ngx_resolver_node_t *ngx_resolver_lookup_addr(ngx_resolver_t *r,
     in_addr_t addr);
 static void ngx_resolver_rbtree_insert_value(ngx_rbtree_node_t *temp,
@@ -98,6 +127,16 @@ static ngx_addr_t *ngx_resolver_export(ngx_resolver_t *r,
     ngx_resolver_node_t *rn, ngx_uint_t rotate);
 static u_char *ngx_resolver_log_error(ngx_log_t *log, u_char *buf, size_t len);
 
+static ngx_int_t ngx_resolver_init_zone(ngx_shm_zone_t *shm_zone, void *data);
+static ngx_int_t ngx_resolver_shared_lookup(ngx_resolver_t *r,
+    ngx_resolver_node_t *rn);
+static void ngx_resolver_shared_store(ngx_resolver_t *r,
+    ngx_resolver_node_t *rn);
+static ngx_resolver_shnode_t *ngx_resolver_shared_find(
+    ngx_resolver_shctx_t *sh, u_char *name, size_t len, uint32_t hash);
+static void ngx_resolver_shared_insert_value(ngx_rbtree_node_t *temp,
+    ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
+
 #if (NGX_HAVE_INET6)
 static void ngx_resolver_rbtree_insert_addr6_value(ngx_rbtree_node_t *temp,
     ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
@@ -106,10 +145,16 @@ static ngx_resolver_node_t *ngx_resolver_lookup_addr6(ngx_resolver_t *r,
 #endif
 
 
+/* the tag of resolver shared memory zones */
+static ngx_uint_t  ngx_resolver_zone_tag;
+
+
 ngx_resolver_t *
 ngx_resolver_create(ngx_conf_t *cf, ngx_str_t *names, ngx_uint_t n)
 {
-    ngx_str_t              s;
+    u_char                *p;
+    ssize_t                size;
+    ngx_str_t              s, z;
     ngx_url_t              u;
     ngx_uint_t             i, j;
     ngx_resolver_t        *r;
@@ -147,6 +192,12 @@ ngx_resolver_create(ngx_conf_t *cf, ngx_str_t *names, ngx_uint_t n)
     ngx_queue_init(&r->name_expire_queue);
     ngx_queue_init(&r->addr_expire_queue);
 
+    ngx_rbtree_init(&r->srv_rbtree, &r->srv_sentinel,
+                    ngx_resolver_rbtree_insert_value);
+
+    ngx_queue_init(&r->srv_resend_queue);
+    ngx_queue_init(&r->srv_expire_queue);
+
 #if (NGX_HAVE_INET6)
     r->ipv6 = 1;
 
@@ -195,6 +246,48 @@ ngx_resolver_create(ngx_conf_t *cf, ngx_str_t *names, ngx_uint_t n)
             continue;
         }
 
+        if (ngx_strncmp(names[i].data, "zone=", 5) == 0) {
+
+            s.data = names[i].data + 5;
+
+            p = (u_char *) ngx_strchr(s.data, ':');
+
+            if (p == NULL || p == s.data) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid parameter: %V", &names[i]);
+                return NULL;
+            }
+
+            s.len = p - s.data;
+
+            z.data = p + 1;
+            z.len = names[i].data + names[i].len - z.data;
+
+            size = ngx_parse_size(&z);
+
+            if (size == NGX_ERROR) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid parameter: %V", &names[i]);
+                return NULL;
+            }
+
+            if (size < (ssize_t) (8 * ngx_pagesize)) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "zone \"%V\" is too small", &s);
+                return NULL;
+            }
+
+            r->shm_zone = ngx_shared_memory_add(cf, &s, size,
+                                                &ngx_resolver_zone_tag);
+            if (r->shm_zone == NULL) {
+                return NULL;
+            }
+
+            r->shm_zone->init = ngx_resolver_init_zone;
+
+            continue;
+        }
+
 #if (NGX_HAVE_INET6)
         if (ngx_strncmp(names[i].data, "ipv6=", 5) == 0) {
 
@@ -263,6 +356,8 @@ ngx_resolver_cleanup(void *data)
 
         ngx_resolver_cleanup_tree(r, &r->addr_rbtree);
 
+        ngx_resolver_cleanup_tree(r, &r->srv_rbtree);
+
 #if (NGX_HAVE_INET6)
         ngx_resolver_cleanup_tree(r, &r->addr6_rbtree);
 #endif
@@ -519,6 +614,7 @@ ngx_resolve_name_locked(ngx_resolver_t *r, ngx_resolver_ctx_t *ctx)
                 do {
                     ctx->state = NGX_OK;
                     ctx->naddrs = naddrs;
+                    ctx->valid = rn->valid;
 
                     if (addrs == NULL) {
                         ctx->addrs = &ctx->addr;
@@ -626,6 +722,7 @@ ngx_resolve_name_locked(ngx_resolver_t *r, ngx_resolver_ctx_t *ctx)
 
         rn->node.key = hash;
         rn->nlen = (u_short) ctx->name.len;
+        rn->nsrvs = 0;
         rn->query = NULL;
 #if (NGX_HAVE_INET6)
         rn->query6 = NULL;
@@ -634,6 +731,19 @@ ngx_resolve_name_locked(ngx_resolver_t *r, ngx_resolver_ctx_t *ctx)
         ngx_rbtree_insert(&r->name_rbtree, &rn->node);
     }
 
+    if (r->shm_zone && ngx_resolver_shared_lookup(r, rn) == NGX_OK) {
+
+        /* the name was resolved by another worker */
+
+        rn->expire = ngx_time() + r->expire;
+
+        ngx_queue_insert_head(&r->name_expire_queue, &rn->queue);
+
+        rn->waiting = NULL;
+
+        return ngx_resolve_name_locked(r, ctx);
+    }
+
     rc = ngx_resolver_create_name_query(rn, ctx);
 
     if (rc == NGX_ERROR) {
@@ -711,88 +821,150 @@ failed:
 
 
 ngx_int_t
-ngx_resolve_addr(ngx_resolver_ctx_t *ctx)
+ngx_resolve_srv(ngx_resolver_ctx_t *ctx)
 {
-    u_char               *name;
-    in_addr_t             addr;
-    ngx_queue_t          *resend_queue, *expire_queue;
-    ngx_rbtree_t         *tree;
+    ngx_int_t        rc;
+    ngx_resolver_t  *r;
+
+    r = ctx->resolver;
+
+    if (ctx->name.len > 0 && ctx->name.data[ctx->name.len - 1] == '.') {
+        ctx->name.len--;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_CORE, r->log, 0,
+                   "resolve srv: \"%V\"", &ctx->name);
+
+    /* lock srv mutex */
+
+    rc = ngx_resolve_srv_locked(r, ctx);
+
+    /* unlock srv mutex */
+
+    if (rc == NGX_OK || rc == NGX_AGAIN) {
+        return NGX_OK;
+    }
+
+    /* NGX_ERROR */
+
+    if (ctx->event) {
+        ngx_resolver_free(r, ctx->event);
+    }
+
+    ngx_resolver_free(r, ctx);
+
+    return NGX_ERROR;
+}
+
+
+void
+ngx_resolve_srv_done(ngx_resolver_ctx_t *ctx)
+{
+    uint32_t              hash;
     ngx_resolver_t       *r;
-    struct sockaddr_in   *sin;
+    ngx_resolver_ctx_t   *w, **p;
     ngx_resolver_node_t  *rn;
-#if (NGX_HAVE_INET6)
-    uint32_t              hash;
-    struct sockaddr_in6  *sin6;
-#endif
-
-#if (NGX_SUPPRESS_WARN)
-    addr = 0;
-#if (NGX_HAVE_INET6)
-    hash = 0;
-    sin6 = NULL;
-#endif
-#endif
 
     r = ctx->resolver;
 
-    switch (ctx->addr.sockaddr->sa_family) {
+    ngx_log_debug1(NGX_LOG_DEBUG_CORE, r->log, 0,
+                   "resolve srv done: %i", ctx->state);
 
-#if (NGX_HAVE_INET6)
-    case AF_INET6:
-        sin6 = (struct sockaddr_in6 *) ctx->addr.sockaddr;
-        hash = ngx_crc32_short(sin6->sin6_addr.s6_addr, 16);
+    if (ctx->event && ctx->event->timer_set) {
+        ngx_del_timer(ctx->event);
+    }
 
-        /* lock addr mutex */
+    /* lock srv mutex */
 
-        rn = ngx_resolver_lookup_addr6(r, &sin6->sin6_addr, hash);
+    if (ctx->state == NGX_AGAIN) {
 
-        tree = &r->addr6_rbtree;
-        resend_queue = &r->addr6_resend_queue;
-        expire_queue = &r->addr6_expire_queue;
+        hash = ngx_crc32_short(ctx->name.data, ctx->name.len);
 
-        break;
-#endif
+        rn = ngx_resolver_lookup_srv(r, &ctx->name, hash);
 
-    default: /* AF_INET */
-        sin = (struct sockaddr_in *) ctx->addr.sockaddr;
-        addr = ntohl(sin->sin_addr.s_addr);
+        if (rn) {
+            p = &rn->waiting;
+            w = rn->waiting;
 
-        /* lock addr mutex */
+            while (w) {
+                if (w == ctx) {
+                    *p = w->next;
 
-        rn = ngx_resolver_lookup_addr(r, addr);
+                    goto done;
+                }
 
-        tree = &r->addr_rbtree;
-        resend_queue = &r->addr_resend_queue;
-        expire_queue = &r->addr_expire_queue;
+                p = &w->next;
+                w = w->next;
+            }
+        }
+
+        ngx_log_error(NGX_LOG_ALERT, r->log, 0,
+                      "could not cancel %V resolving", &ctx->name);
+    }
+
+done:
+
+    ngx_resolver_expire(r, &r->srv_rbtree, &r->srv_expire_queue);
+
+    /* unlock srv mutex */
+
+    /* lock alloc mutex */
+
+    if (ctx->event) {
+        ngx_resolver_free_locked(r, ctx->event);
     }
 
+    ngx_resolver_free_locked(r, ctx);
+
+    /* unlock alloc mutex */
+}
+
+
+static ngx_int_t
+ngx_resolve_srv_locked(ngx_resolver_t *r, ngx_resolver_ctx_t *ctx)
+{
+    uint32_t              hash;
+    ngx_int_t             rc;
+    ngx_uint_t            i;
+    ngx_resolver_ctx_t   *next;
+    ngx_resolver_node_t  *rn;
+
+    ngx_strlow(ctx->name.data, ctx->name.data, ctx->name.len);
+
+    hash = ngx_crc32_short(ctx->name.data, ctx->name.len);
+
+    rn = ngx_resolver_lookup_srv(r, &ctx->name, hash);
+
     if (rn) {
 
         if (rn->valid >= ngx_time()) {
 
-            ngx_log_debug0(NGX_LOG_DEBUG_CORE, r->log, 0, "resolve cached");
+            ngx_log_debug0(NGX_LOG_DEBUG_CORE, r->log, 0,
+                           "resolve srv cached");
 
             ngx_queue_remove(&rn->queue);
 
             rn->expire = ngx_time() + r->expire;
 
-            ngx_queue_insert_head(expire_queue, &rn->queue);
+            ngx_queue_insert_head(&r->srv_expire_queue, &rn->queue);
 
-            name = ngx_resolver_dup(r, rn->name, rn->nlen);
-            if (name == NULL) {
-                goto failed;
-            }
+            ctx->next = rn->waiting;
+            rn->waiting = NULL;
 
-            ctx->name.len = rn->nlen;
-            ctx->name.data = name;
+            /* unlock srv mutex */
 
-            /* unlock addr mutex */
+            do {
+                ctx->state = NGX_OK;
+                ctx->nsrvs = rn->nsrvs;
+                ctx->srvs = rn->u.srvs;
+                ctx->valid = rn->valid;
 
-            ctx->state = NGX_OK;
+                next = ctx->next;
 
-            ctx->handler(ctx);
+                ctx->handler(ctx);
 
-            ngx_resolver_free(r, name);
+                ctx = next;
+            } while (ctx);
 
             return NGX_OK;
         }
@@ -803,60 +975,277 @@ ngx_resolve_addr(ngx_resolver_ctx_t *ctx)
             rn->waiting = ctx;
             ctx->state = NGX_AGAIN;
 
-            /* unlock addr mutex */
-
-            return NGX_OK;
+            return NGX_AGAIN;
         }
 
         ngx_queue_remove(&rn->queue);
 
-        ngx_resolver_free(r, rn->query);
-        rn->query = NULL;
-#if (NGX_HAVE_INET6)
-        rn->query6 = NULL;
-#endif
+        /* lock alloc mutex */
+
+        if (rn->query) {
+            ngx_resolver_free_locked(r, rn->query);
+            rn->query = NULL;
+        }
+
+        for (i = 0; i < rn->nsrvs; i++) {
+            ngx_resolver_free_locked(r, rn->u.srvs[i].name.data);
+        }
+
+        if (rn->nsrvs) {
+            ngx_resolver_free_locked(r, rn->u.srvs);
+            rn->nsrvs = 0;
+        }
+
+        /* unlock alloc mutex */
 
     } else {
+
         rn = ngx_resolver_alloc(r, sizeof(ngx_resolver_node_t));
         if (rn == NULL) {
-            goto failed;
+            return NGX_ERROR;
         }
 
-        switch (ctx->addr.sockaddr->sa_family) {
-
-#if (NGX_HAVE_INET6)
-        case AF_INET6:
-            rn->addr6 = sin6->sin6_addr;
-            rn->node.key = hash;
-            break;
-#endif
-
-        default: /* AF_INET */
-            rn->node.key = addr;
+        rn->name = ngx_resolver_dup(r, ctx->name.data, ctx->name.len);
+        if (rn->name == NULL) {
+            ngx_resolver_free(r, rn);
+            return NGX_ERROR;
         }
 
+        rn->node.key = hash;
+        rn->nlen = (u_short) ctx->name.len;
+        rn->nsrvs = 0;
         rn->query = NULL;
 #if (NGX_HAVE_INET6)
         rn->query6 = NULL;
 #endif
 
-        ngx_rbtree_insert(tree, &rn->node);
+        ngx_rbtree_insert(&r->srv_rbtree, &rn->node);
     }
 
-    if (ngx_resolver_create_addr_query(rn, ctx) != NGX_OK) {
+    rc = ngx_resolver_create_srv_query(rn, ctx);
+
+    if (rc == NGX_ERROR) {
         goto failed;
     }
 
+    if (rc == NGX_DECLINED) {
+        ngx_rbtree_delete(&r->srv_rbtree, &rn->node);
+
+        ngx_resolver_free(r, rn->query);
+        ngx_resolver_free(r, rn->name);
+        ngx_resolver_free(r, rn);
+
+        ctx->state = NGX_RESOLVE_NXDOMAIN;
+        ctx->handler(ctx);
+
+        return NGX_OK;
+    }
+
     rn->naddrs = (u_short) -1;
 #if (NGX_HAVE_INET6)
-    rn->naddrs6 = (u_short) -1;
+    rn->naddrs6 = 0;
 #endif
 
     if (ngx_resolver_send_query(r, rn) != NGX_OK) {
         goto failed;
     }
 
-    ctx->event = ngx_resolver_calloc(r, sizeof(ngx_event_t));
+    if (ctx->event == NULL) {
+        ctx->event = ngx_resolver_calloc(r, sizeof(ngx_event_t));
+        if (ctx->event == NULL) {
+            goto failed;
+        }
+
+        ctx->event->handler = ngx_resolver_timeout_handler;
+        ctx->event->data = rn;
+        ctx->event->log = r->log;
+        rn->ident = -1;
+
+        ngx_add_timer(ctx->event, ctx->timeout);
+    }
+
+    if (ngx_queue_empty(&r->srv_resend_queue)) {
+        ngx_add_timer(r->event, (ngx_msec_t) (r->resend_timeout * 1000));
+    }
+
+    rn->expire = ngx_time() + r->resend_timeout;
+
+    ngx_queue_insert_head(&r->srv_resend_queue, &rn->queue);
+
+    rn->code = 0;
+    rn->cnlen = 0;
+    rn->valid = 0;
+    rn->ttl = NGX_MAX_UINT32_VALUE;
+    rn->waiting = ctx;
+
+    ctx->state = NGX_AGAIN;
+
+    return NGX_AGAIN;
+
+failed:
+
+    ngx_rbtree_delete(&r->srv_rbtree, &rn->node);
+
+    if (rn->query) {
+        ngx_resolver_free(r, rn->query);
+    }
+
+    ngx_resolver_free(r, rn->name);
+
+    ngx_resolver_free(r, rn);
+
+    return NGX_ERROR;
+}
+
+
+ngx_int_t
+ngx_resolve_addr(ngx_resolver_ctx_t *ctx)
+{
+    u_char               *name;
+    in_addr_t             addr;
+    ngx_queue_t          *resend_queue, *expire_queue;
+    ngx_rbtree_t         *tree;
+    ngx_resolver_t       *r;
+    struct sockaddr_in   *sin;
+    ngx_resolver_node_t  *rn;
+#if (NGX_HAVE_INET6)
+    uint32_t              hash;
+    struct sockaddr_in6  *sin6;
+#endif
+
+#if (NGX_SUPPRESS_WARN)
+    addr = 0;
+#if (NGX_HAVE_INET6)
+    hash = 0;
+    sin6 = NULL;
+#endif
+#endif
+
+    r = ctx->resolver;
+
+    switch (ctx->addr.sockaddr->sa_family) {
+
+#if (NGX_HAVE_INET6)
+    case AF_INET6:
+        sin6 = (struct sockaddr_in6 *) ctx->addr.sockaddr;
+        hash = ngx_crc32_short(sin6->sin6_addr.s6_addr, 16);
+
+        /* lock addr mutex */
+
+        rn = ngx_resolver_lookup_addr6(r, &sin6->sin6_addr, hash);
+
+        tree = &r->addr6_rbtree;
+        resend_queue = &r->addr6_resend_queue;
+        expire_queue = &r->addr6_expire_queue;
+
+        break;
+#endif
+
+    default: /* AF_INET */
+        sin = (struct sockaddr_in *) ctx->addr.sockaddr;
+        addr = ntohl(sin->sin_addr.s_addr);
+
+        /* lock addr mutex */
+
+        rn = ngx_resolver_lookup_addr(r, addr);
+
+        tree = &r->addr_rbtree;
+        resend_queue = &r->addr_resend_queue;
+        expire_queue = &r->addr_expire_queue;
+    }
+
+    if (rn) {
+
+        if (rn->valid >= ngx_time()) {
+
+            ngx_log_debug0(NGX_LOG_DEBUG_CORE, r->log, 0, "resolve cached");
+
+            ngx_queue_remove(&rn->queue);
+
+            rn->expire = ngx_time() + r->expire;
+
+            ngx_queue_insert_head(expire_queue, &rn->queue);
+
+            name = ngx_resolver_dup(r, rn->name, rn->nlen);
+            if (name == NULL) {
+                goto failed;
+            }
+
+            ctx->name.len = rn->nlen;
+            ctx->name.data = name;
+
+            /* unlock addr mutex */
+
+            ctx->state = NGX_OK;
+
+            ctx->handler(ctx);
+
+            ngx_resolver_free(r, name);
+
+            return NGX_OK;
+        }
+
+        if (rn->waiting) {
+
+            ctx->next = rn->waiting;
+            rn->waiting = ctx;
+            ctx->state = NGX_AGAIN;
+
+            /* unlock addr mutex */
+
+            return NGX_OK;
+        }
+
+        ngx_queue_remove(&rn->queue);
+
+        ngx_resolver_free(r, rn->query);
+        rn->query = NULL;
+#if (NGX_HAVE_INET6)
+        rn->query6 = NULL;
+#endif
+
+    } else {
+        rn = ngx_resolver_alloc(r, sizeof(ngx_resolver_node_t));
+        if (rn == NULL) {
+            goto failed;
+        }
+
+        switch (ctx->addr.sockaddr->sa_family) {
+
+#if (NGX_HAVE_INET6)
+        case AF_INET6:
+            rn->addr6 = sin6->sin6_addr;
+            rn->node.key = hash;
+            break;
+#endif
+
+        default: /* AF_INET */
+            rn->node.key = addr;
+        }
+
+        rn->nsrvs = 0;
+        rn->query = NULL;
+#if (NGX_HAVE_INET6)
+        rn->query6 = NULL;
+#endif
+
+        ngx_rbtree_insert(tree, &rn->node);
+    }
+
+    if (ngx_resolver_create_addr_query(rn, ctx) != NGX_OK) {
+        goto failed;
+    }
+
+    rn->naddrs = (u_short) -1;
+#if (NGX_HAVE_INET6)
+    rn->naddrs6 = (u_short) -1;
+#endif
+
+    if (ngx_resolver_send_query(r, rn) != NGX_OK) {
+        goto failed;
+    }
+
+    ctx->event = ngx_resolver_calloc(r, sizeof(ngx_event_t));
     if (ctx->event == NULL) {
         goto failed;
     }
@@ -1120,7 +1509,7 @@ ngx_resolver_send_query(ngx_resolver_t *r, ngx_resolver_node_t *rn)
 static void
 ngx_resolver_resend_handler(ngx_event_t *ev)
 {
-    time_t           timer, atimer, ntimer;
+    time_t           timer, atimer, stimer, ntimer;
 #if (NGX_HAVE_INET6)
     time_t           a6timer;
 #endif
@@ -1143,6 +1532,12 @@ ngx_resolver_resend_handler(ngx_event_t *ev)
 
     /* unlock addr mutex */
 
+    /* lock srv mutex */
+
+    stimer = ngx_resolver_resend(r, &r->srv_rbtree, &r->srv_resend_queue);
+
+    /* unlock srv mutex */
+
 #if (NGX_HAVE_INET6)
 
     /* lock addr6 mutex */
@@ -1162,6 +1557,13 @@ ngx_resolver_resend_handler(ngx_event_t *ev)
         timer = ngx_min(timer, atimer);
     }
 
+    if (timer == 0) {
+        timer = stimer;
+
+    } else if (stimer) {
+        timer = ngx_min(timer, stimer);
+    }
+
 #if (NGX_HAVE_INET6)
 
     if (timer == 0) {
@@ -1382,6 +1784,13 @@ found:
 
         break;
 
+    case NGX_RESOLVE_SRV:
+
+        ngx_resolver_process_srv(r, buf, n, ident, code, nan,
+                                 i + sizeof(ngx_resolver_qs_t));
+
+        break;
+
     default:
         ngx_log_error(r->log_level, r->log, 0,
                       "unknown query type %ui in DNS response", qtype);
@@ -1884,6 +2293,10 @@ ngx_resolver_process_a(ngx_resolver_t *r, u_char *buf, size_t last,
 
         ngx_queue_insert_head(&r->name_expire_queue, &rn->queue);
 
+        if (r->shm_zone) {
+            ngx_resolver_shared_store(r, rn);
+        }
+
         next = rn->waiting;
         rn->waiting = NULL;
 
@@ -1893,6 +2306,7 @@ ngx_resolver_process_a(ngx_resolver_t *r, u_char *buf, size_t last,
             ctx = next;
             ctx->state = NGX_OK;
             ctx->naddrs = naddrs;
+            ctx->valid = rn->valid;
 
             if (addrs == NULL) {
                 ctx->addrs = &ctx->addr;
@@ -1955,6 +2369,10 @@ ngx_resolver_process_a(ngx_resolver_t *r, u_char *buf, size_t last,
 
         ngx_queue_insert_head(&r->name_expire_queue, &rn->queue);
 
+        if (r->shm_zone) {
+            ngx_resolver_shared_store(r, rn);
+        }
+
         ctx = rn->waiting;
         rn->waiting = NULL;
 
@@ -2271,45 +2689,390 @@ failed:
 }
 
 
-static ngx_resolver_node_t *
-ngx_resolver_lookup_name(ngx_resolver_t *r, ngx_str_t *name, uint32_t hash)
+static void
+ngx_resolver_process_srv(ngx_resolver_t *r, u_char *buf, size_t last,
+    ngx_uint_t ident, ngx_uint_t code, ngx_uint_t nan, ngx_uint_t ans)
 {
-    ngx_int_t             rc;
-    ngx_rbtree_node_t    *node, *sentinel;
+    char                 *err;
+    size_t                len;
+    int32_t               ttl;
+    uint32_t              hash;
+    ngx_str_t             name;
+    ngx_uint_t            type, class, qident, nsrvs, a, i, n, start;
+    ngx_resolver_an_t    *an;
+    ngx_resolver_srv_t   *srvs;
+    ngx_resolver_ctx_t   *ctx, *next;
     ngx_resolver_node_t  *rn;
 
-    node = r->name_rbtree.root;
-    sentinel = r->name_rbtree.sentinel;
-
-    while (node != sentinel) {
-
-        if (hash < node->key) {
-            node = node->left;
-            continue;
-        }
-
-        if (hash > node->key) {
-            node = node->right;
-            continue;
-        }
+    if (ngx_resolver_copy(r, &name, buf,
+                          buf + sizeof(ngx_resolver_hdr_t), buf + last)
+        != NGX_OK)
+    {
+        return;
+    }
 
-        /* hash == node->key */
+    ngx_log_debug1(NGX_LOG_DEBUG_CORE, r->log, 0, "resolver qs:%V", &name);
 
-        rn = ngx_resolver_node(node);
+    hash = ngx_crc32_short(name.data, name.len);
 
-        rc = ngx_memn2cmp(name->data, rn->name, name->len, rn->nlen);
+    /* lock srv mutex */
 
-        if (rc == 0) {
-            return rn;
-        }
+    rn = ngx_resolver_lookup_srv(r, &name, hash);
 
-        node = (rc < 0) ? node->left : node->right;
+    if (rn == NULL || rn->query == NULL || rn->naddrs != (u_short) -1) {
+        ngx_log_error(r->log_level, r->log, 0,
+                      "unexpected response for %V", &name);
+        ngx_resolver_free(r, name.data);
+        goto failed;
     }
 
-    /* not found */
+    qident = (rn->query[0] << 8) + rn->query[1];
 
-    return NULL;
-}
+    if (ident != qident) {
+        ngx_log_error(r->log_level, r->log, 0,
+                      "wrong ident %ui response for %V, expect %ui",
+                      ident, &name, qident);
+        ngx_resolver_free(r, name.data);
+        goto failed;
+    }
+
+    ngx_resolver_free(r, name.data);
+
+    if (code == 0 && nan == 0) {
+        code = NGX_RESOLVE_NXDOMAIN;
+    }
+
+    if (code) {
+        goto error;
+    }
+
+    i = ans;
+    nsrvs = 0;
+
+    for (a = 0; a < nan; a++) {
+
+        start = i;
+
+        while (i < last) {
+
+            if (buf[i] & 0xc0) {
+                i += 2;
+                goto found;
+            }
+
+            if (buf[i] == 0) {
+                i++;
+                goto test_length;
+            }
+
+            i += 1 + buf[i];
+        }
+
+        goto short_response;
+
+    test_length:
+
+        if (i - start < 2) {
+            err = "invalid name in DNS response";
+            goto invalid;
+        }
+
+    found:
+
+        if (i + sizeof(ngx_resolver_an_t) >= last) {
+            goto short_response;
+        }
+
+        an = (ngx_resolver_an_t *) &buf[i];
+
+        type = (an->type_hi << 8) + an->type_lo;
+        class = (an->class_hi << 8) + an->class_lo;
+        len = (an->len_hi << 8) + an->len_lo;
+        ttl = (an->ttl[0] << 24) + (an->ttl[1] << 16)
+            + (an->ttl[2] << 8) + (an->ttl[3]);
+
+        if (class != 1) {
+            ngx_log_error(r->log_level, r->log, 0,
+                          "unexpected RR class %ui", class);
+            goto failed;
+        }
+
+        if (ttl < 0) {
+            ttl = 0;
+        }
+
+        rn->ttl = ngx_min(rn->ttl, (uint32_t) ttl);
+
+        i += sizeof(ngx_resolver_an_t);
+
+        switch (type) {
+
+        case NGX_RESOLVE_SRV:
+
+            if (len < 7) {
+                err = "invalid SRV record in DNS response";
+                goto invalid;
+            }
+
+            if (i + len > last) {
+                goto short_response;
+            }
+
+            if (ngx_resolver_copy(r, NULL, buf, &buf[i + 6], buf + last)
+                != NGX_OK)
+            {
+                goto failed;
+            }
+
+            nsrvs++;
+
+            break;
+
+        case NGX_RESOLVE_CNAME:
+        case NGX_RESOLVE_DNAME:
+
+            break;
+
+        default:
+
+            ngx_log_error(r->log_level, r->log, 0,
+                          "unexpected RR type %ui", type);
+        }
+
+        i += len;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_CORE, r->log, 0,
+                   "resolver nsrvs:%ui ttl:%uD", nsrvs, rn->ttl);
+
+    if (nsrvs == 0) {
+        ngx_log_error(r->log_level, r->log, 0,
+                      "no SRV type in DNS response");
+        code = NGX_RESOLVE_NXDOMAIN;
+        goto error;
+    }
+
+    srvs = ngx_resolver_calloc(r, nsrvs * sizeof(ngx_resolver_srv_t));
+    if (srvs == NULL) {
+        goto failed;
+    }
+
+    rn->u.srvs = srvs;
+    rn->nsrvs = (u_short) nsrvs;
+    rn->naddrs = 0;
+
+    n = 0;
+    i = ans;
+
+    for (a = 0; a < nan; a++) {
+
+        for ( ;; ) {
+
+            if (buf[i] & 0xc0) {
+                i += 2;
+                break;
+            }
+
+            if (buf[i] == 0) {
+                i++;
+                break;
+            }
+
+            i += 1 + buf[i];
+        }
+
+        an = (ngx_resolver_an_t *) &buf[i];
+
+        type = (an->type_hi << 8) + an->type_lo;
+        len = (an->len_hi << 8) + an->len_lo;
+
+        i += sizeof(ngx_resolver_an_t);
+
+        if (type == NGX_RESOLVE_SRV) {
+
+            srvs[n].priority = (buf[i] << 8) + buf[i + 1];
+            srvs[n].weight = (buf[i + 2] << 8) + buf[i + 3];
+            srvs[n].port = (buf[i + 4] << 8) + buf[i + 5];
+
+            if (ngx_resolver_copy(r, &srvs[n].name, buf, &buf[i + 6],
+                                  buf + last)
+                != NGX_OK)
+            {
+                goto failed;
+            }
+
+            /* the "." target means the service is not available */
+
+            if (srvs[n].name.len) {
+                n++;
+            }
+        }
+
+        i += len;
+    }
+
+    if (n == 0) {
+        ngx_resolver_free(r, srvs);
+        rn->nsrvs = 0;
+
+        code = NGX_RESOLVE_NXDOMAIN;
+        goto error;
+    }
+
+    rn->nsrvs = (u_short) n;
+
+    ngx_queue_remove(&rn->queue);
+
+    rn->valid = ngx_time() + (r->valid ? r->valid : (time_t) rn->ttl);
+    rn->expire = ngx_time() + r->expire;
+
+    ngx_queue_insert_head(&r->srv_expire_queue, &rn->queue);
+
+    next = rn->waiting;
+    rn->waiting = NULL;
+
+    /* unlock srv mutex */
+
+    while (next) {
+        ctx = next;
+        ctx->state = NGX_OK;
+        ctx->nsrvs = rn->nsrvs;
+        ctx->srvs = rn->u.srvs;
+        ctx->valid = rn->valid;
+
+        next = ctx->next;
+
+        ctx->handler(ctx);
+    }
+
+    ngx_resolver_free(r, rn->query);
+    rn->query = NULL;
+
+    return;
+
+error:
+
+    next = rn->waiting;
+    rn->waiting = NULL;
+
+    ngx_queue_remove(&rn->queue);
+
+    ngx_rbtree_delete(&r->srv_rbtree, &rn->node);
+
+    /* unlock srv mutex */
+
+    while (next) {
+        ctx = next;
+        ctx->state = code;
+        next = ctx->next;
+
+        ctx->handler(ctx);
+    }
+
+    ngx_resolver_free_node(r, rn);
+
+    return;
+
+short_response:
+
+    err = "short DNS response";
+
+invalid:
+
+    /* unlock srv mutex */
+
+    ngx_log_error(r->log_level, r->log, 0, err);
+
+    return;
+
+failed:
+
+    /* unlock srv mutex */
+
+    return;
+}
+
+
+static ngx_resolver_node_t *
+ngx_resolver_lookup_name(ngx_resolver_t *r, ngx_str_t *name, uint32_t hash)
+{
+    ngx_int_t             rc;
+    ngx_rbtree_node_t    *node, *sentinel;
+    ngx_resolver_node_t  *rn;
+
+    node = r->name_rbtree.root;
+    sentinel = r->name_rbtree.sentinel;
+
+    while (node != sentinel) {
+
+        if (hash < node->key) {
+            node = node->left;
+            continue;
+        }
+
+        if (hash > node->key) {
+            node = node->right;
+            continue;
+        }
+
+        /* hash == node->key */
+
+        rn = ngx_resolver_node(node);
+
+        rc = ngx_memn2cmp(name->data, rn->name, name->len, rn->nlen);
+
+        if (rc == 0) {
+            return rn;
+        }
+
+        node = (rc < 0) ? node->left : node->right;
+    }
+
+    /* not found */
+
+    return NULL;
+}
+
+
+static ngx_resolver_node_t *
+ngx_resolver_lookup_srv(ngx_resolver_t *r, ngx_str_t *name, uint32_t hash)
+{
+    ngx_int_t             rc;
+    ngx_rbtree_node_t    *node, *sentinel;
+    ngx_resolver_node_t  *rn;
+
+    node = r->srv_rbtree.root;
+    sentinel = r->srv_rbtree.sentinel;
+
+    while (node != sentinel) {
+
+        if (hash < node->key) {
+            node = node->left;
+            continue;
+        }
+
+        if (hash > node->key) {
+            node = node->right;
+            continue;
+        }
+
+        /* hash == node->key */
+
+        rn = ngx_resolver_node(node);
+
+        rc = ngx_memn2cmp(name->data, rn->name, name->len, rn->nlen);
+
+        if (rc == 0) {
+            return rn;
+        }
+
+        node = (rc < 0) ? node->left : node->right;
+    }
+
+    /* not found */
+
+    return NULL;
+}
 
 
 static ngx_resolver_node_t *
@@ -2670,29 +3433,116 @@ ngx_resolver_create_addr_query(ngx_resolver_node_t *rn, ngx_resolver_ctx_t *ctx)
                             (sin6->sin6_addr.s6_addr[n] >> 4) & 0xf);
         }
 
-        p = ngx_cpymem(p, "\3ip6\4arpa\0", 10);
+        p = ngx_cpymem(p, "\3ip6\4arpa\0", 10);
+
+        break;
+#endif
+
+    default: /* AF_INET */
+
+        sin = (struct sockaddr_in *) ctx->addr.sockaddr;
+        addr = ntohl(sin->sin_addr.s_addr);
+
+        for (n = 0; n < 32; n += 8) {
+            d = ngx_sprintf(&p[1], "%ud", (addr >> n) & 0xff);
+            *p = (u_char) (d - &p[1]);
+            p = d;
+        }
+
+        p = ngx_cpymem(p, "\7in-addr\4arpa\0", 14);
+    }
+
+    /* query type "PTR", IN query class */
+    p = ngx_cpymem(p, "\0\14\0\1", 4);
+
+    rn->qlen = (u_short) (p - rn->query);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_resolver_create_srv_query(ngx_resolver_node_t *rn, ngx_resolver_ctx_t *ctx)
+{
+    u_char              *p, *s;
+    size_t               len, nlen;
+    ngx_uint_t           ident;
+    ngx_resolver_qs_t   *qs;
+    ngx_resolver_hdr_t  *query;
+
+    nlen = ctx->name.len ? (1 + ctx->name.len + 1) : 1;
+
+    len = sizeof(ngx_resolver_hdr_t) + nlen + sizeof(ngx_resolver_qs_t);
+
+    p = ngx_resolver_alloc(ctx->resolver, len);
+    if (p == NULL) {
+        return NGX_ERROR;
+    }
+
+    rn->qlen = (u_short) len;
+    rn->query = p;
+
+    query = (ngx_resolver_hdr_t *) p;
+
+    ident = ngx_random();
+
+    ngx_log_debug2(NGX_LOG_DEBUG_CORE, ctx->resolver->log, 0,
+                   "resolve: \"%V\" SRV %i", &ctx->name, ident & 0xffff);
+
+    query->ident_hi = (u_char) ((ident >> 8) & 0xff);
+    query->ident_lo = (u_char) (ident & 0xff);
+
+    /* recursion query */
+    query->flags_hi = 1; query->flags_lo = 0;
+
+    /* one question */
+    query->nqs_hi = 0; query->nqs_lo = 1;
+    query->nan_hi = 0; query->nan_lo = 0;
+    query->nns_hi = 0; query->nns_lo = 0;
+    query->nar_hi = 0; query->nar_lo = 0;
+
+    p += sizeof(ngx_resolver_hdr_t) + nlen;
+
+    qs = (ngx_resolver_qs_t *) p;
+
+    /* query type */
+    qs->type_hi = 0; qs->type_lo = NGX_RESOLVE_SRV;
+
+    /* IN query class */
+    qs->class_hi = 0; qs->class_lo = 1;
+
+    /* convert "_http._tcp.example.com" to "\5_http\4_tcp\7example\3com\0" */
 
-        break;
-#endif
+    len = 0;
+    p--;
+    *p-- = '\0';
 
-    default: /* AF_INET */
+    if (ctx->name.len == 0)  {
+        return NGX_DECLINED;
+    }
 
-        sin = (struct sockaddr_in *) ctx->addr.sockaddr;
-        addr = ntohl(sin->sin_addr.s_addr);
+    for (s = ctx->name.data + ctx->name.len - 1; s >= ctx->name.data; s--) {
+        if (*s != '.') {
+            *p = *s;
+            len++;
 
-        for (n = 0; n < 32; n += 8) {
-            d = ngx_sprintf(&p[1], "%ud", (addr >> n) & 0xff);
-            *p = (u_char) (d - &p[1]);
-            p = d;
+        } else {
+            if (len == 0 || len > 255) {
+                return NGX_DECLINED;
+            }
+
+            *p = (u_char) len;
+            len = 0;
         }
 
-        p = ngx_cpymem(p, "\7in-addr\4arpa\0", 14);
+        p--;
     }
 
-    /* query type "PTR", IN query class */
-    p = ngx_cpymem(p, "\0\14\0\1", 4);
+    if (len == 0 || len > 255) {
+        return NGX_DECLINED;
+    }
 
-    rn->qlen = (u_short) (p - rn->query);
+    *p = (u_char) len;
 
     return NGX_OK;
 }
@@ -2816,6 +3666,8 @@ ngx_resolver_timeout_handler(ngx_event_t *ev)
 static void
 ngx_resolver_free_node(ngx_resolver_t *r, ngx_resolver_node_t *rn)
 {
+    ngx_uint_t  i;
+
     /* lock alloc mutex */
 
     if (rn->query) {
@@ -2840,6 +3692,14 @@ ngx_resolver_free_node(ngx_resolver_t *r, ngx_resolver_node_t *rn)
     }
 #endif
 
+    if (rn->nsrvs) {
+        for (i = 0; i < rn->nsrvs; i++) {
+            ngx_resolver_free_locked(r, rn->u.srvs[i].name.data);
+        }
+
+        ngx_resolver_free_locked(r, rn->u.srvs);
+    }
+
     ngx_resolver_free_locked(r, rn);
 
     /* unlock alloc mutex */
@@ -2994,6 +3854,370 @@ ngx_resolver_export(ngx_resolver_t *r, ngx_resolver_node_t *rn,
 }
 
 
+static ngx_int_t
+ngx_resolver_init_zone(ngx_shm_zone_t *shm_zone, void *data)
+{
+    size_t                 len;
+    ngx_slab_pool_t       *shpool;
+    ngx_resolver_shctx_t  *sh;
+
+    if (data) {
+        shm_zone->data = data;
+        return NGX_OK;
+    }
+
+    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+    if (shm_zone->shm.exists) {
+        shm_zone->data = shpool->data;
+        return NGX_OK;
+    }
+
+    sh = ngx_slab_alloc(shpool, sizeof(ngx_resolver_shctx_t));
+    if (sh == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_rbtree_init(&sh->rbtree, &sh->sentinel,
+                    ngx_resolver_shared_insert_value);
+
+    ngx_queue_init(&sh->queue);
+
+    shpool->data = sh;
+
+    len = sizeof(" in resolver zone \"\"") + shm_zone->shm.name.len;
+
+    shpool->log_ctx = ngx_slab_alloc(shpool, len);
+    if (shpool->log_ctx == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_sprintf(shpool->log_ctx, " in resolver zone \"%V\"%Z",
+                &shm_zone->shm.name);
+
+    shpool->log_nomem = 0;
+
+    shm_zone->data = sh;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_resolver_shared_lookup(ngx_resolver_t *r, ngx_resolver_node_t *rn)
+{
+    u_char                 *p;
+    ngx_uint_t              naddrs6;
+    ngx_slab_pool_t        *shpool;
+    ngx_resolver_shctx_t   *sh;
+    ngx_resolver_shnode_t  *sn;
+
+    sh = r->shm_zone->data;
+    shpool = (ngx_slab_pool_t *) r->shm_zone->shm.addr;
+
+    ngx_shmtx_lock(&shpool->mutex);
+
+    sn = ngx_resolver_shared_find(sh, rn->name, rn->nlen, rn->node.key);
+
+    if (sn == NULL || sn->valid < ngx_time()) {
+        goto declined;
+    }
+
+#if (NGX_HAVE_INET6)
+
+    /* the name was resolved without IPv6 addresses */
+
+    if (r->ipv6 && !sn->ipv6) {
+        goto declined;
+    }
+
+    naddrs6 = r->ipv6 ? sn->naddrs6 : 0;
+#else
+    naddrs6 = 0;
+#endif
+
+    if (sn->cnlen == 0 && sn->naddrs + naddrs6 == 0) {
+        goto declined;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_CORE, r->log, 0,
+                   "resolve shared \"%*s\"", (size_t) rn->nlen, rn->name);
+
+    p = sn->data + sn->nlen;
+
+    rn->cnlen = 0;
+    rn->naddrs = 0;
+#if (NGX_HAVE_INET6)
+    rn->naddrs6 = 0;
+#endif
+
+    if (sn->cnlen) {
+        rn->u.cname = ngx_resolver_dup(r, p, sn->cnlen);
+        if (rn->u.cname == NULL) {
+            goto declined;
+        }
+
+        rn->cnlen = sn->cnlen;
+
+        goto done;
+    }
+
+    if (sn->naddrs == 1) {
+        ngx_memcpy(&rn->u.addr, p, sizeof(in_addr_t));
+
+    } else if (sn->naddrs > 1) {
+        rn->u.addrs = ngx_resolver_dup(r, p, sn->naddrs * sizeof(in_addr_t));
+        if (rn->u.addrs == NULL) {
+            goto declined;
+        }
+    }
+
+    rn->naddrs = sn->naddrs;
+
+#if (NGX_HAVE_INET6)
+
+    p += sn->naddrs * sizeof(in_addr_t);
+
+    if (naddrs6 == 1) {
+        ngx_memcpy(&rn->u6.addr6, p, sizeof(struct in6_addr));
+
+    } else if (naddrs6 > 1) {
+        rn->u6.addrs6 = ngx_resolver_dup(r, p,
+                                         naddrs6 * sizeof(struct in6_addr));
+        if (rn->u6.addrs6 == NULL) {
+
+            if (rn->naddrs > 1) {
+                ngx_resolver_free_locked(r, rn->u.addrs);
+            }
+
+            rn->naddrs = 0;
+
+            goto declined;
+        }
+    }
+
+    rn->naddrs6 = (u_short) naddrs6;
+
+#endif
+
+done:
+
+    rn->code = 0;
+    rn->valid = sn->valid;
+    rn->ttl = (uint32_t) (sn->valid - ngx_time());
+
+    ngx_queue_remove(&sn->queue);
+    ngx_queue_insert_head(&sh->queue, &sn->queue);
+
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    return NGX_OK;
+
+declined:
+
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    return NGX_DECLINED;
+}
+
+
+static void
+ngx_resolver_shared_store(ngx_resolver_t *r, ngx_resolver_node_t *rn)
+{
+    u_char                 *p;
+    size_t                  size;
+    time_t                  now;
+    ngx_uint_t              i;
+    ngx_queue_t            *q;
+    ngx_slab_pool_t        *shpool;
+    ngx_resolver_shctx_t   *sh;
+    ngx_resolver_shnode_t  *sn;
+
+    sh = r->shm_zone->data;
+    shpool = (ngx_slab_pool_t *) r->shm_zone->shm.addr;
+
+    size = offsetof(ngx_resolver_shnode_t, data) + rn->nlen + rn->cnlen;
+
+    if (rn->cnlen == 0) {
+        size += rn->naddrs * sizeof(in_addr_t);
+#if (NGX_HAVE_INET6)
+        size += rn->naddrs6 * sizeof(struct in6_addr);
+#endif
+    }
+
+    now = ngx_time();
+
+    ngx_shmtx_lock(&shpool->mutex);
+
+    sn = ngx_resolver_shared_find(sh, rn->name, rn->nlen, rn->node.key);
+
+    if (sn) {
+        ngx_queue_remove(&sn->queue);
+        ngx_rbtree_delete(&sh->rbtree, &sn->node);
+        ngx_slab_free_locked(shpool, sn);
+    }
+
+    /* drop up to two expired names */
+
+    for (i = 0; i < 2 && !ngx_queue_empty(&sh->queue); i++) {
+
+        q = ngx_queue_last(&sh->queue);
+        sn = ngx_queue_data(q, ngx_resolver_shnode_t, queue);
+
+        if (now <= sn->valid) {
+            break;
+        }
+
+        ngx_queue_remove(q);
+        ngx_rbtree_delete(&sh->rbtree, &sn->node);
+        ngx_slab_free_locked(shpool, sn);
+    }
+
+    for ( ;; ) {
+        sn = ngx_slab_alloc_locked(shpool, size);
+
+        if (sn || ngx_queue_empty(&sh->queue)) {
+            break;
+        }
+
+        /* the least recently used name */
+
+        q = ngx_queue_last(&sh->queue);
+        sn = ngx_queue_data(q, ngx_resolver_shnode_t, queue);
+
+        ngx_queue_remove(q);
+        ngx_rbtree_delete(&sh->rbtree, &sn->node);
+        ngx_slab_free_locked(shpool, sn);
+    }
+
+    if (sn == NULL) {
+        ngx_shmtx_unlock(&shpool->mutex);
+        return;
+    }
+
+    sn->node.key = rn->node.key;
+    sn->valid = rn->valid;
+    sn->nlen = rn->nlen;
+    sn->cnlen = rn->cnlen;
+    sn->naddrs = 0;
+    sn->naddrs6 = 0;
+#if (NGX_HAVE_INET6)
+    sn->ipv6 = (u_char) r->ipv6;
+#else
+    sn->ipv6 = 0;
+#endif
+
+    p = ngx_cpymem(sn->data, rn->name, rn->nlen);
+
+    if (rn->cnlen) {
+        ngx_memcpy(p, rn->u.cname, rn->cnlen);
+        goto done;
+    }
+
+    if (rn->naddrs) {
+        p = ngx_cpymem(p, (rn->naddrs == 1) ? &rn->u.addr : rn->u.addrs,
+                       rn->naddrs * sizeof(in_addr_t));
+        sn->naddrs = rn->naddrs;
+    }
+
+#if (NGX_HAVE_INET6)
+    if (rn->naddrs6) {
+        ngx_memcpy(p, (rn->naddrs6 == 1) ? &rn->u6.addr6 : rn->u6.addrs6,
+                   rn->naddrs6 * sizeof(struct in6_addr));
+        sn->naddrs6 = rn->naddrs6;
+    }
+#endif
+
+done:
+
+    ngx_rbtree_insert(&sh->rbtree, &sn->node);
+    ngx_queue_insert_head(&sh->queue, &sn->queue);
+
+    ngx_shmtx_unlock(&shpool->mutex);
+}
+
+
+static ngx_resolver_shnode_t *
+ngx_resolver_shared_find(ngx_resolver_shctx_t *sh, u_char *name, size_t len,
+    uint32_t hash)
+{
+    ngx_int_t               rc;
+    ngx_rbtree_node_t      *node, *sentinel;
+    ngx_resolver_shnode_t  *sn;
+
+    node = sh->rbtree.root;
+    sentinel = sh->rbtree.sentinel;
+
+    while (node != sentinel) {
+
+        if (hash < node->key) {
+            node = node->left;
+            continue;
+        }
+
+        if (hash > node->key) {
+            node = node->right;
+            continue;
+        }
+
+        /* hash == node->key */
+
+        sn = (ngx_resolver_shnode_t *) node;
+
+        rc = ngx_memn2cmp(name, sn->data, len, sn->nlen);
+
+        if (rc == 0) {
+            return sn;
+        }
+
+        node = (rc < 0) ? node->left : node->right;
+    }
+
+    return NULL;
+}
+
+
+static void
+ngx_resolver_shared_insert_value(ngx_rbtree_node_t *temp,
+    ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel)
+{
+    ngx_rbtree_node_t      **p;
+    ngx_resolver_shnode_t   *sn, *sn_temp;
+
+    for ( ;; ) {
+
+        if (node->key < temp->key) {
+
+            p = &temp->left;
+
+        } else if (node->key > temp->key) {
+
+            p = &temp->right;
+
+        } else { /* node->key == temp->key */
+
+            sn = (ngx_resolver_shnode_t *) node;
+            sn_temp = (ngx_resolver_shnode_t *) temp;
+
+            p = (ngx_memn2cmp(sn->data, sn_temp->data, sn->nlen, sn_temp->nlen)
+                 < 0) ? &temp->left : &temp->right;
+        }
+
+        if (*p == sentinel) {
+            break;
+        }
+
+        temp = *p;
+    }
+
+    *p = node;
+    node->parent = temp;
+    node->left = sentinel;
+    node->right = sentinel;
+    ngx_rbt_red(node);
+}
+
+
 char *
 ngx_resolver_strerror(ngx_int_t err)
 {
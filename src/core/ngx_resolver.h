@@ -21,6 +21,7 @@
 #if (NGX_HAVE_INET6)
 #define NGX_RESOLVE_AAAA      28
 #endif
+#define NGX_RESOLVE_SRV       33
 #define NGX_RESOLVE_DNAME     39
 
 #define NGX_RESOLVE_FORMERR   1
@@ -51,7 +52,15 @@ typedef void (*ngx_resolver_handler_pt)(ngx_resolver_ctx_t *ctx);
 
 
 typedef struct {
-    /* PTR: resolved name, A: name to resolve */
+    ngx_str_t                 name;
+    u_short                   priority;
+    u_short                   weight;
+    u_short                   port;
+} ngx_resolver_srv_t;
+
+
+typedef struct {
+    /* PTR: resolved name, A and SRV: name to resolve */
     u_char                   *name;
 
     ngx_queue_t               queue;
@@ -78,10 +87,12 @@ typedef struct {
         in_addr_t             addr;
         in_addr_t            *addrs;
         u_char               *cname;
+        ngx_resolver_srv_t   *srvs;
     } u;
 
     u_char                    code;
     u_short                   naddrs;
+    u_short                   nsrvs;
     u_short                   cnlen;
 
 #if (NGX_HAVE_INET6)
@@ -126,6 +137,14 @@ typedef struct {
     ngx_queue_t               name_expire_queue;
     ngx_queue_t               addr_expire_queue;
 
+    ngx_rbtree_t              srv_rbtree;
+    ngx_rbtree_node_t         srv_sentinel;
+    ngx_queue_t               srv_resend_queue;
+    ngx_queue_t               srv_expire_queue;
+
+    /* names resolved by any worker, shared by all of them */
+    ngx_shm_zone_t           *shm_zone;
+
 #if (NGX_HAVE_INET6)
     ngx_uint_t                ipv6;                 /* unsigned  ipv6:1; */
     ngx_rbtree_t              addr6_rbtree;
@@ -155,6 +174,11 @@ struct ngx_resolver_ctx_s {
     ngx_addr_t                addr;
     struct sockaddr_in        sin;
 
+    ngx_uint_t                nsrvs;
+    ngx_resolver_srv_t       *srvs;
+
+    time_t                    valid;
+
     ngx_resolver_handler_pt   handler;
     void                     *data;
     ngx_msec_t                timeout;
@@ -171,6 +195,8 @@ ngx_resolver_ctx_t *ngx_resolve_start(ngx_resolver_t *r,
     ngx_resolver_ctx_t *temp);
 ngx_int_t ngx_resolve_name(ngx_resolver_ctx_t *ctx);
 void ngx_resolve_name_done(ngx_resolver_ctx_t *ctx);
+ngx_int_t ngx_resolve_srv(ngx_resolver_ctx_t *ctx);
+void ngx_resolve_srv_done(ngx_resolver_ctx_t *ctx);
 ngx_int_t ngx_resolve_addr(ngx_resolver_ctx_t *ctx);
 void ngx_resolve_addr_done(ngx_resolver_ctx_t *ctx);
 char *ngx_resolver_strerror(ngx_int_t err);
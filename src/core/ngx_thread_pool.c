@@ -16,22 +16,29 @@ typedef struct {
 } ngx_thread_pool_conf_t;
 
 
+/*
+ * the task queue is an intrusive lock-free multi-producer single-consumer
+ * queue: tasks are posted without locks, and the pool threads take turns
+ * to be the consumer under the mutex, which is also used to sleep on the
+ * condition variable while the queue is empty
+ */
+
 typedef struct {
-    ngx_thread_task_t        *first;
-    ngx_thread_task_t       **last;
+    ngx_atomic_t              head;
+    ngx_thread_task_t        *tail;
+    ngx_thread_task_t         stub;
 } ngx_thread_pool_queue_t;
 
-#define ngx_thread_pool_queue_init(q)                                         \
-    (q)->first = NULL;                                                        \
-    (q)->last = &(q)->first
-
 
 struct ngx_thread_pool_s {
     ngx_thread_mutex_t        mtx;
     ngx_thread_pool_queue_t   queue;
-    ngx_int_t                 waiting;
+    ngx_atomic_t              idle;
     ngx_thread_cond_t         cond;
 
+    ngx_thread_pool_stats_t  *stats;
+    ngx_thread_pool_stats_t   local_stats;
+
     ngx_log_t                *log;
 
     ngx_str_t                 name;
@@ -48,6 +55,12 @@ static ngx_int_t ngx_thread_pool_init(ngx_thread_pool_t *tp, ngx_log_t *log,
 static void ngx_thread_pool_destroy(ngx_thread_pool_t *tp);
 static void ngx_thread_pool_exit_handler(void *data, ngx_log_t *log);
 
+static void ngx_thread_pool_queue_init(ngx_thread_pool_queue_t *q);
+static void ngx_thread_pool_queue_push(ngx_thread_pool_queue_t *q,
+    ngx_thread_task_t *task);
+static ngx_thread_task_t *ngx_thread_pool_queue_pop(ngx_thread_pool_queue_t *q);
+static ngx_thread_task_t *ngx_thread_pool_queue_link(ngx_thread_task_t *task);
+
 static void *ngx_thread_pool_cycle(void *data);
 static void ngx_thread_pool_handler(ngx_event_t *ev);
 
@@ -99,8 +112,13 @@ ngx_module_t  ngx_thread_pool_module = {
 static ngx_str_t  ngx_thread_pool_default = ngx_string("default");
 
 static ngx_uint_t               ngx_thread_pool_task_id;
-static ngx_atomic_t             ngx_thread_pool_done_lock;
-static ngx_thread_pool_queue_t  ngx_thread_pool_done;
+
+/*
+ * completed tasks are pushed by the pool threads onto a lock-free stack,
+ * the event loop takes the whole stack at once in ngx_thread_pool_handler()
+ */
+
+static ngx_atomic_t             ngx_thread_pool_done;
 
 
 static ngx_int_t
@@ -119,6 +137,12 @@ ngx_thread_pool_init(ngx_thread_pool_t *tp, ngx_log_t *log, ngx_pool_t *pool)
 
     ngx_thread_pool_queue_init(&tp->queue);
 
+    tp->idle = 0;
+
+    if (tp->stats == NULL) {
+        tp->stats = &tp->local_stats;
+    }
+
     if (ngx_thread_mutex_create(&tp->mtx, log) != NGX_OK) {
         return NGX_ERROR;
     }
@@ -204,6 +228,83 @@ ngx_thread_pool_exit_handler(void *data, ngx_log_t *log)
 }
 
 
+static void
+ngx_thread_pool_queue_init(ngx_thread_pool_queue_t *q)
+{
+    q->stub.next = NULL;
+    q->head = (ngx_atomic_uint_t) &q->stub;
+    q->tail = &q->stub;
+}
+
+
+static void
+ngx_thread_pool_queue_push(ngx_thread_pool_queue_t *q, ngx_thread_task_t *task)
+{
+    ngx_atomic_uint_t   prev;
+
+    task->next = NULL;
+
+    do {
+        prev = q->head;
+
+    } while (!ngx_atomic_cmp_set(&q->head, prev, (ngx_atomic_uint_t) task));
+
+    /* until the link is set the consumer waits in queue_link() */
+
+    ((ngx_thread_task_t *) prev)->next = task;
+}
+
+
+static ngx_thread_task_t *
+ngx_thread_pool_queue_pop(ngx_thread_pool_queue_t *q)
+{
+    ngx_thread_task_t  *tail;
+
+    tail = q->tail;
+
+    if (tail == &q->stub) {
+
+        if ((ngx_thread_task_t *) q->head == tail) {
+            return NULL;
+        }
+
+        tail = ngx_thread_pool_queue_link(tail);
+        q->tail = tail;
+    }
+
+    /* the stub keeps the queue non-empty when the last task is taken */
+
+    if ((ngx_thread_task_t *) q->head == tail) {
+        ngx_thread_pool_queue_push(q, &q->stub);
+    }
+
+    q->tail = ngx_thread_pool_queue_link(tail);
+
+    return tail;
+}
+
+
+static ngx_thread_task_t *
+ngx_thread_pool_queue_link(ngx_thread_task_t *task)
+{
+    ngx_thread_task_t  *next;
+
+    for ( ;; ) {
+        next = *(ngx_thread_task_t * volatile *) &task->next;
+
+        if (next) {
+            break;
+        }
+
+        ngx_cpu_pause();
+    }
+
+    ngx_memory_barrier();
+
+    return next;
+}
+
+
 ngx_thread_task_t *
 ngx_thread_task_alloc(ngx_pool_t *pool, size_t size)
 {
@@ -223,41 +324,58 @@ ngx_thread_task_alloc(ngx_pool_t *pool, size_t size)
 ngx_int_t
 ngx_thread_task_post(ngx_thread_pool_t *tp, ngx_thread_task_t *task)
 {
+    ngx_int_t                 waiting;
+    ngx_thread_pool_stats_t  *stats;
+
     if (task->event.active) {
         ngx_log_error(NGX_LOG_ALERT, tp->log, 0,
                       "task #%ui already active", task->id);
         return NGX_ERROR;
     }
 
-    if (ngx_thread_mutex_lock(&tp->mtx, tp->log) != NGX_OK) {
-        return NGX_ERROR;
-    }
+    stats = tp->stats;
 
-    if (tp->waiting >= tp->max_queue) {
-        (void) ngx_thread_mutex_unlock(&tp->mtx, tp->log);
+    waiting = (ngx_int_t) ngx_atomic_fetch_add(&stats->waiting, 1);
+
+    if (waiting >= tp->max_queue) {
+        (void) ngx_atomic_fetch_add(&stats->waiting, -1);
 
         ngx_log_error(NGX_LOG_ERR, tp->log, 0,
                       "thread pool \"%V\" queue overflow: %i tasks waiting",
-                      &tp->name, tp->waiting);
+                      &tp->name, waiting);
         return NGX_ERROR;
     }
 
     task->event.active = 1;
 
     task->id = ngx_thread_pool_task_id++;
-    task->next = NULL;
+    task->posted = ngx_current_msec;
 
-    if (ngx_thread_cond_signal(&tp->cond, tp->log) != NGX_OK) {
-        (void) ngx_thread_mutex_unlock(&tp->mtx, tp->log);
-        return NGX_ERROR;
+    stats->posted++;
+
+    if ((ngx_atomic_uint_t) waiting >= stats->max_queue) {
+        stats->max_queue = waiting + 1;
     }
 
-    *tp->queue.last = task;
-    tp->queue.last = &task->next;
+    ngx_thread_pool_queue_push(&tp->queue, task);
+
+    /*
+     * an idle thread checks the queue again after it is counted
+     * as idle, so either the task is seen or the thread is woken up
+     */
+
+    if (tp->idle) {
+        if (ngx_thread_mutex_lock(&tp->mtx, tp->log) != NGX_OK) {
+            return NGX_ERROR;
+        }
 
-    tp->waiting++;
+        if (ngx_thread_cond_signal(&tp->cond, tp->log) != NGX_OK) {
+            (void) ngx_thread_mutex_unlock(&tp->mtx, tp->log);
+            return NGX_ERROR;
+        }
 
-    (void) ngx_thread_mutex_unlock(&tp->mtx, tp->log);
+        (void) ngx_thread_mutex_unlock(&tp->mtx, tp->log);
+    }
 
     ngx_log_debug2(NGX_LOG_DEBUG_CORE, tp->log, 0,
                    "task #%ui added to thread pool \"%V\"",
@@ -274,6 +392,8 @@ ngx_thread_pool_cycle(void *data)
 
     int                 err;
     sigset_t            set;
+    ngx_uint_t          idle;
+    ngx_atomic_uint_t   done;
     ngx_thread_task_t  *task;
 
 #if 0
@@ -301,10 +421,22 @@ ngx_thread_pool_cycle(void *data)
             return NULL;
         }
 
-        /* the number may become negative */
-        tp->waiting--;
+        idle = 0;
+
+        for ( ;; ) {
+            task = ngx_thread_pool_queue_pop(&tp->queue);
+
+            if (task) {
+                break;
+            }
+
+            if (!idle) {
+                /* the queue is checked again after the thread is counted */
+                (void) ngx_atomic_fetch_add(&tp->idle, 1);
+                idle = 1;
+                continue;
+            }
 
-        while (tp->queue.first == NULL) {
             if (ngx_thread_cond_wait(&tp->cond, &tp->mtx, tp->log)
                 != NGX_OK)
             {
@@ -313,13 +445,14 @@ ngx_thread_pool_cycle(void *data)
             }
         }
 
-        task = tp->queue.first;
-        tp->queue.first = task->next;
-
-        if (tp->queue.first == NULL) {
-            tp->queue.last = &tp->queue.first;
+        if (idle) {
+            (void) ngx_atomic_fetch_add(&tp->idle, -1);
         }
 
+        (void) ngx_atomic_fetch_add(&tp->stats->waiting, -1);
+
+        tp->stats->wait_time += ngx_current_msec - task->posted;
+
         if (ngx_thread_mutex_unlock(&tp->mtx, tp->log) != NGX_OK) {
             return NULL;
         }
@@ -338,16 +471,21 @@ ngx_thread_pool_cycle(void *data)
                        "complete task #%ui in thread pool \"%V\"",
                        task->id, &tp->name);
 
-        task->next = NULL;
-
-        ngx_spinlock(&ngx_thread_pool_done_lock, 1, 2048);
+        do {
+            done = ngx_thread_pool_done;
+            task->next = (ngx_thread_task_t *) done;
 
-        *ngx_thread_pool_done.last = task;
-        ngx_thread_pool_done.last = &task->next;
+        } while (!ngx_atomic_cmp_set(&ngx_thread_pool_done, done,
+                                     (ngx_atomic_uint_t) task));
 
-        ngx_unlock(&ngx_thread_pool_done_lock);
+        /*
+         * the event loop is already notified if the stack was not empty,
+         * it will take this task along with the others
+         */
 
-        (void) ngx_notify(ngx_thread_pool_handler);
+        if (done == 0) {
+            (void) ngx_notify(ngx_thread_pool_handler);
+        }
     }
 }
 
@@ -356,17 +494,27 @@ static void
 ngx_thread_pool_handler(ngx_event_t *ev)
 {
     ngx_event_t        *event;
-    ngx_thread_task_t  *task;
+    ngx_atomic_uint_t   done;
+    ngx_thread_task_t  *task, *next, *list;
 
     ngx_log_debug0(NGX_LOG_DEBUG_CORE, ev->log, 0, "thread pool handler");
 
-    ngx_spinlock(&ngx_thread_pool_done_lock, 1, 2048);
+    do {
+        done = ngx_thread_pool_done;
+
+    } while (!ngx_atomic_cmp_set(&ngx_thread_pool_done, done, 0));
+
+    /* the stack is in reverse order of completion */
+
+    list = NULL;
 
-    task = ngx_thread_pool_done.first;
-    ngx_thread_pool_done.first = NULL;
-    ngx_thread_pool_done.last = &ngx_thread_pool_done.first;
+    for (task = (ngx_thread_task_t *) done; task; task = next) {
+        next = task->next;
+        task->next = list;
+        list = task;
+    }
 
-    ngx_unlock(&ngx_thread_pool_done_lock);
+    task = list;
 
     while (task) {
         ngx_log_debug1(NGX_LOG_DEBUG_CORE, ev->log, 0,
@@ -568,6 +716,37 @@ ngx_thread_pool_get(ngx_cycle_t *cycle, ngx_str_t *name)
 }
 
 
+ngx_array_t *
+ngx_thread_pools(ngx_cycle_t *cycle)
+{
+    ngx_thread_pool_conf_t  *tcf;
+
+    tcf = (ngx_thread_pool_conf_t *) ngx_get_conf(cycle->conf_ctx,
+                                                  ngx_thread_pool_module);
+
+    return &tcf->pools;
+}
+
+
+ngx_str_t *
+ngx_thread_pool_name(ngx_thread_pool_t *tp)
+{
+    return &tp->name;
+}
+
+
+void
+ngx_thread_pool_set_stats(ngx_thread_pool_t *tp,
+    ngx_thread_pool_stats_t *stats)
+{
+    if (tp->stats) {
+        *stats = *tp->stats;
+    }
+
+    tp->stats = stats;
+}
+
+
 static ngx_int_t
 ngx_thread_pool_init_worker(ngx_cycle_t *cycle)
 {
@@ -588,7 +767,7 @@ ngx_thread_pool_init_worker(ngx_cycle_t *cycle)
         return NGX_OK;
     }
 
-    ngx_thread_pool_queue_init(&ngx_thread_pool_done);
+    ngx_thread_pool_done = 0;
 
     tpp = tcf->pools.elts;
 
@@ -19,15 +19,30 @@ struct ngx_thread_task_s {
     ngx_uint_t           id;
     void                *ctx;
     void               (*handler)(void *data, ngx_log_t *log);
+    ngx_msec_t           posted;
     ngx_event_t          event;
 };
 
 
-typedef struct ngx_thread_pool_s  ngx_thread_pool_t;
+/*
+ * the statistics of a pool are per worker process; they may be moved
+ * to shared memory with ngx_thread_pool_set_stats() before tasks are posted
+ */
+
+typedef struct {
+    ngx_atomic_t         waiting;        /* the current queue depth */
+    ngx_atomic_uint_t    max_queue;      /* the maximum queue depth seen */
+    ngx_atomic_uint_t    posted;
+    ngx_atomic_uint_t    wait_time;      /* the total time spent in queue */
+} ngx_thread_pool_stats_t;
 
 
 ngx_thread_pool_t *ngx_thread_pool_add(ngx_conf_t *cf, ngx_str_t *name);
 ngx_thread_pool_t *ngx_thread_pool_get(ngx_cycle_t *cycle, ngx_str_t *name);
+ngx_array_t *ngx_thread_pools(ngx_cycle_t *cycle);
+ngx_str_t *ngx_thread_pool_name(ngx_thread_pool_t *tp);
+void ngx_thread_pool_set_stats(ngx_thread_pool_t *tp,
+    ngx_thread_pool_stats_t *stats);
 
 ngx_thread_task_t *ngx_thread_task_alloc(ngx_pool_t *pool, size_t size);
 ngx_int_t ngx_thread_task_post(ngx_thread_pool_t *tp, ngx_thread_task_t *task);
@@ -29,6 +29,7 @@ ngx_os_io_t ngx_os_aio = {
     ngx_aio_read_chain,
     NULL,
     ngx_aio_write,
+    NULL,
     ngx_aio_write_chain,
     0
 };
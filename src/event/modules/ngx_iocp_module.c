@@ -93,6 +93,7 @@ ngx_os_io_t ngx_iocp_io = {
     NULL,
     ngx_udp_overlapped_wsarecv,
     NULL,
+    NULL,
     ngx_overlapped_wsasend_chain,
     0
 };
@@ -0,0 +1,833 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+
+
+/*
+ * The io_uring event module keeps one multishot poll request per active
+ * event, so the notifications have the same edge-triggered semantics as
+ * the epoll ones and the rest of nginx does not need to know the difference.
+ * The poll requests and the file AIO reads are queued to the submission ring
+ * and submitted in one io_uring_enter() along with waiting for completions.
+ *
+ * The kernel must support multishot poll and IORING_ENTER_EXT_ARG (5.13+),
+ * otherwise the module falls back to epoll.
+ */
+
+
+/* the file AIO requests are marked by the second bit of user_data */
+
+#define NGX_IOURING_AIO        2
+
+
+typedef struct {
+    ngx_uint_t  entries;
+} ngx_iouring_conf_t;
+
+
+static ngx_int_t ngx_iouring_init(ngx_cycle_t *cycle, ngx_msec_t timer);
+static ngx_int_t ngx_iouring_setup(ngx_cycle_t *cycle,
+    ngx_iouring_conf_t *iucf);
+static ngx_int_t ngx_iouring_notify_init(ngx_log_t *log);
+static void ngx_iouring_notify_handler(ngx_event_t *ev);
+static void ngx_iouring_done(ngx_cycle_t *cycle);
+static struct io_uring_sqe *ngx_iouring_get_sqe(ngx_log_t *log);
+static ngx_int_t ngx_iouring_submit(ngx_log_t *log);
+static ngx_int_t ngx_iouring_poll(ngx_event_t *ev, ngx_socket_t fd,
+    uint32_t events);
+static ngx_int_t ngx_iouring_add_event(ngx_event_t *ev, ngx_int_t event,
+    ngx_uint_t flags);
+static ngx_int_t ngx_iouring_del_event(ngx_event_t *ev, ngx_int_t event,
+    ngx_uint_t flags);
+static ngx_int_t ngx_iouring_notify(ngx_event_handler_pt handler);
+static ngx_int_t ngx_iouring_process_events(ngx_cycle_t *cycle,
+    ngx_msec_t timer, ngx_uint_t flags);
+
+static void *ngx_iouring_create_conf(ngx_cycle_t *cycle);
+static char *ngx_iouring_init_conf(ngx_cycle_t *cycle, void *conf);
+
+
+extern ngx_event_module_t   ngx_epoll_module_ctx;
+
+static int                  ring = -1;
+
+static void                *sq_ring;
+static size_t               sq_ring_size;
+static void                *cq_ring;
+static size_t               cq_ring_size;
+static struct io_uring_sqe *sqes;
+static size_t               sqes_size;
+
+static unsigned            *sq_head;
+static unsigned            *sq_tail;
+static unsigned             sq_mask;
+static unsigned             sq_entries;
+static unsigned             sq_local_tail;
+
+static unsigned            *cq_head;
+static unsigned            *cq_tail;
+static unsigned             cq_mask;
+static struct io_uring_cqe *cqes;
+
+static int                  notify_fd = -1;
+static ngx_event_t          notify_event;
+static ngx_connection_t     notify_conn;
+
+#if (NGX_HAVE_FILE_AIO)
+ngx_uint_t                  ngx_iouring_aio;
+#endif
+
+static ngx_str_t      iouring_name = ngx_string("io_uring");
+
+static ngx_command_t  ngx_iouring_commands[] = {
+
+    { ngx_string("io_uring_entries"),
+      NGX_EVENT_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      0,
+      offsetof(ngx_iouring_conf_t, entries),
+      NULL },
+
+      ngx_null_command
+};
+
+
+ngx_event_module_t  ngx_iouring_module_ctx = {
+    &iouring_name,
+    ngx_iouring_create_conf,             /* create configuration */
+    ngx_iouring_init_conf,               /* init configuration */
+
+    {
+        ngx_iouring_add_event,           /* add an event */
+        ngx_iouring_del_event,           /* delete an event */
+        ngx_iouring_add_event,           /* enable an event */
+        ngx_iouring_del_event,           /* disable an event */
+        NULL,                            /* add an connection */
+        NULL,                            /* delete an connection */
+        ngx_iouring_notify,              /* trigger a notify */
+        ngx_iouring_process_events,      /* process the events */
+        ngx_iouring_init,                /* init the events */
+        ngx_iouring_done,                /* done the events */
+    }
+};
+
+ngx_module_t  ngx_iouring_module = {
+    NGX_MODULE_V1,
+    &ngx_iouring_module_ctx,             /* module context */
+    ngx_iouring_commands,                /* module directives */
+    NGX_EVENT_MODULE,                    /* module type */
+    NULL,                                /* init master */
+    NULL,                                /* init module */
+    NULL,                                /* init process */
+    NULL,                                /* init thread */
+    NULL,                                /* exit thread */
+    NULL,                                /* exit process */
+    NULL,                                /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+/*
+ * We call io_uring_setup() and io_uring_enter() directly as syscalls
+ * to avoid the liburing dependency.
+ */
+
+static int
+io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(SYS_io_uring_setup, entries, p);
+}
+
+
+static int
+io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+    unsigned flags, void *arg, size_t size)
+{
+    return syscall(SYS_io_uring_enter, fd, to_submit, min_complete, flags,
+                   arg, size);
+}
+
+
+static ngx_int_t
+ngx_iouring_init(ngx_cycle_t *cycle, ngx_msec_t timer)
+{
+    ngx_iouring_conf_t  *iucf;
+
+    iucf = ngx_event_get_conf(cycle->conf_ctx, ngx_iouring_module);
+
+    if (ring == -1) {
+        if (ngx_iouring_setup(cycle, iucf) != NGX_OK) {
+            ngx_log_error(NGX_LOG_NOTICE, cycle->log, 0,
+                          "io_uring is not available, using epoll");
+
+            return ngx_epoll_module_ctx.actions.init(cycle, timer);
+        }
+
+#if (NGX_HAVE_FILE_AIO)
+        ngx_iouring_aio = 1;
+        ngx_file_aio = 1;
+#endif
+    }
+
+    ngx_io = ngx_os_io;
+
+    ngx_event_actions = ngx_iouring_module_ctx.actions;
+
+    ngx_event_flags = NGX_USE_CLEAR_EVENT|NGX_USE_GREEDY_EVENT;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_setup(ngx_cycle_t *cycle, ngx_iouring_conf_t *iucf)
+{
+    unsigned                i;
+    struct io_uring_params  p;
+
+    ngx_memzero(&p, sizeof(struct io_uring_params));
+
+    ring = io_uring_setup(iucf->entries, &p);
+
+    if (ring == -1) {
+        ngx_log_error(NGX_LOG_NOTICE, cycle->log, ngx_errno,
+                      "io_uring_setup() failed");
+        return NGX_ERROR;
+    }
+
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        ngx_log_error(NGX_LOG_NOTICE, cycle->log, 0,
+                      "io_uring does not support IORING_ENTER_EXT_ARG");
+        goto failed;
+    }
+
+    sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size = p.cq_off.cqes
+                   + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_ring_size = ngx_max(sq_ring_size, cq_ring_size);
+        cq_ring_size = sq_ring_size;
+    }
+
+    sq_ring = mmap(NULL, sq_ring_size, PROT_READ|PROT_WRITE,
+                   MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+
+    if (sq_ring == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "mmap(IORING_OFF_SQ_RING) failed");
+        sq_ring = NULL;
+        goto failed;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        cq_ring = sq_ring;
+
+    } else {
+        cq_ring = mmap(NULL, cq_ring_size, PROT_READ|PROT_WRITE,
+                       MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+
+        if (cq_ring == MAP_FAILED) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                          "mmap(IORING_OFF_CQ_RING) failed");
+            cq_ring = NULL;
+            goto failed;
+        }
+    }
+
+    sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    sqes = mmap(NULL, sqes_size, PROT_READ|PROT_WRITE,
+                MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQES);
+
+    if (sqes == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "mmap(IORING_OFF_SQES) failed");
+        sqes = NULL;
+        goto failed;
+    }
+
+    sq_head = (unsigned *) ((u_char *) sq_ring + p.sq_off.head);
+    sq_tail = (unsigned *) ((u_char *) sq_ring + p.sq_off.tail);
+    sq_mask = *(unsigned *) ((u_char *) sq_ring + p.sq_off.ring_mask);
+    sq_entries = p.sq_entries;
+    sq_local_tail = *sq_tail;
+
+    /* the submission array maps each ring slot to the same sqe index */
+
+    for (i = 0; i < sq_entries; i++) {
+        ((unsigned *) ((u_char *) sq_ring + p.sq_off.array))[i] = i;
+    }
+
+    cq_head = (unsigned *) ((u_char *) cq_ring + p.cq_off.head);
+    cq_tail = (unsigned *) ((u_char *) cq_ring + p.cq_off.tail);
+    cq_mask = *(unsigned *) ((u_char *) cq_ring + p.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe *) ((u_char *) cq_ring + p.cq_off.cqes);
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                   "io_uring: fd:%d sq:%ud cq:%ud",
+                   ring, p.sq_entries, p.cq_entries);
+
+    if (ngx_iouring_notify_init(cycle->log) == NGX_OK) {
+        return NGX_OK;
+    }
+
+failed:
+
+    ngx_iouring_done(cycle);
+
+    return NGX_ERROR;
+}
+
+
+static ngx_int_t
+ngx_iouring_notify_init(ngx_log_t *log)
+{
+    int                   n;
+    unsigned              head;
+    struct io_uring_cqe  *cqe;
+
+    notify_fd = eventfd(0, 0);
+
+    if (notify_fd == -1) {
+        ngx_log_error(NGX_LOG_EMERG, log, ngx_errno, "eventfd() failed");
+        return NGX_ERROR;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, log, 0,
+                   "notify eventfd: %d", notify_fd);
+
+    notify_event.handler = ngx_iouring_notify_handler;
+    notify_event.log = log;
+
+    notify_conn.fd = notify_fd;
+    notify_conn.read = &notify_event;
+    notify_conn.log = log;
+
+    if (ngx_iouring_poll(&notify_event, notify_fd, POLLIN) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    notify_event.active = 1;
+
+    /*
+     * the multishot poll on the idle eventfd is not completed immediately,
+     * so any completion here means that the kernel has rejected it
+     */
+
+    if (ngx_iouring_submit(log) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    head = *cq_head;
+    ngx_memory_barrier();
+
+    if (head == *cq_tail) {
+        return NGX_OK;
+    }
+
+    cqe = &cqes[head & cq_mask];
+    n = cqe->res;
+
+    ngx_memory_barrier();
+    *cq_head = head + 1;
+
+    if (n < 0) {
+        ngx_log_error(NGX_LOG_NOTICE, log, -n,
+                      "io_uring multishot poll failed");
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_iouring_notify_handler(ngx_event_t *ev)
+{
+    ssize_t               n;
+    uint64_t              count;
+    ngx_err_t             err;
+    ngx_event_handler_pt  handler;
+
+    if (++ev->index == NGX_MAX_UINT32_VALUE) {
+        ev->index = 0;
+
+        n = read(notify_fd, &count, sizeof(uint64_t));
+
+        err = ngx_errno;
+
+        ngx_log_debug3(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                       "read() eventfd %d: %z count:%uL", notify_fd, n, count);
+
+        if ((size_t) n != sizeof(uint64_t)) {
+            ngx_log_error(NGX_LOG_ALERT, ev->log, err,
+                          "read() eventfd %d failed", notify_fd);
+        }
+    }
+
+    handler = ev->data;
+    handler(ev);
+}
+
+
+static void
+ngx_iouring_done(ngx_cycle_t *cycle)
+{
+    if (sqes && munmap(sqes, sqes_size) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "munmap(sqes) failed");
+    }
+
+    if (cq_ring && cq_ring != sq_ring && munmap(cq_ring, cq_ring_size) == -1)
+    {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "munmap(cq ring) failed");
+    }
+
+    if (sq_ring && munmap(sq_ring, sq_ring_size) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "munmap(sq ring) failed");
+    }
+
+    sqes = NULL;
+    cq_ring = NULL;
+    sq_ring = NULL;
+
+    if (ring != -1 && close(ring) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "io_uring close() failed");
+    }
+
+    ring = -1;
+
+    if (notify_fd != -1 && close(notify_fd) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "eventfd close() failed");
+    }
+
+    notify_fd = -1;
+
+#if (NGX_HAVE_FILE_AIO)
+    ngx_iouring_aio = 0;
+#endif
+}
+
+
+static struct io_uring_sqe *
+ngx_iouring_get_sqe(ngx_log_t *log)
+{
+    struct io_uring_sqe  *sqe;
+
+    if (sq_local_tail - *sq_head >= sq_entries) {
+
+        /* the submission ring is full */
+
+        if (ngx_iouring_submit(log) != NGX_OK) {
+            return NULL;
+        }
+
+        if (sq_local_tail - *sq_head >= sq_entries) {
+            ngx_log_error(NGX_LOG_ALERT, log, 0,
+                          "io_uring submission queue overflow");
+            return NULL;
+        }
+    }
+
+    sqe = &sqes[sq_local_tail & sq_mask];
+    sq_local_tail++;
+
+    ngx_memzero(sqe, sizeof(struct io_uring_sqe));
+
+    return sqe;
+}
+
+
+static ngx_int_t
+ngx_iouring_submit(ngx_log_t *log)
+{
+    int        n;
+    ngx_err_t  err;
+
+    ngx_memory_barrier();
+    *sq_tail = sq_local_tail;
+
+    n = io_uring_enter(ring, sq_local_tail - *sq_head, 0, 0, NULL, 0);
+
+    if (n == -1) {
+        err = ngx_errno;
+
+        if (err == NGX_EAGAIN || err == NGX_EBUSY || err == NGX_EINTR) {
+            return NGX_OK;
+        }
+
+        ngx_log_error(NGX_LOG_ALERT, log, err, "io_uring_enter() failed");
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_poll(ngx_event_t *ev, ngx_socket_t fd, uint32_t events)
+{
+    struct io_uring_sqe  *sqe;
+
+    sqe = ngx_iouring_get_sqe(ev->log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+
+    /*
+     * a listening socket is polled once and rearmed after each completion:
+     * the accept handler may leave connections in the backlog, and they
+     * would not complete a multishot poll again until a new one arrives
+     */
+
+    sqe->len = ev->accept ? 0 : IORING_POLL_ADD_MULTI;
+    sqe->user_data = (uintptr_t) ev | ev->instance;
+
+#if (NGX_HAVE_LITTLE_ENDIAN)
+    sqe->poll32_events = events;
+#else
+    sqe->poll32_events = (events << 16) | (events >> 16);
+#endif
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_add_event(ngx_event_t *ev, ngx_int_t event, ngx_uint_t flags)
+{
+    uint32_t           events;
+    ngx_connection_t  *c;
+
+    if (ev->active) {
+        return NGX_OK;
+    }
+
+    c = ev->data;
+
+    if (event == NGX_READ_EVENT) {
+        events = POLLIN|POLLRDHUP;
+
+    } else {
+        events = POLLOUT;
+    }
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                   "io_uring add event: fd:%d ev:%04XD d:%p",
+                   c->fd, events, ev);
+
+    if (ngx_iouring_poll(ev, c->fd, events) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    ev->active = 1;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_del_event(ngx_event_t *ev, ngx_int_t event, ngx_uint_t flags)
+{
+    struct io_uring_sqe  *sqe;
+
+    /*
+     * the poll request holds a reference to the file, so it has to be
+     * removed explicitly even if the file descriptor is being closed
+     */
+
+    if (!ev->active) {
+        return NGX_OK;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                   "io_uring del event: d:%p", ev);
+
+    sqe = ngx_iouring_get_sqe(ev->log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (uintptr_t) ev | ev->instance;
+    sqe->user_data = 0;
+
+    ev->active = 0;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_notify(ngx_event_handler_pt handler)
+{
+    static uint64_t inc = 1;
+
+    notify_event.data = handler;
+
+    if ((size_t) write(notify_fd, &inc, sizeof(uint64_t)) != sizeof(uint64_t)) {
+        ngx_log_error(NGX_LOG_ALERT, notify_event.log, ngx_errno,
+                      "write() to eventfd %d failed", notify_fd);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_process_events(ngx_cycle_t *cycle, ngx_msec_t timer,
+    ngx_uint_t flags)
+{
+    int                             n, res;
+    unsigned                        head, tail, cflags;
+    uint64_t                        data;
+    ngx_int_t                       instance;
+    ngx_uint_t                      level;
+    ngx_err_t                       err;
+    ngx_event_t                    *ev;
+    ngx_queue_t                    *queue;
+    ngx_connection_t               *c;
+    struct timespec                 ts;
+    struct io_uring_getevents_arg   arg;
+#if (NGX_HAVE_FILE_AIO)
+    ngx_event_aio_t                *aio;
+#endif
+
+    ngx_log_debug2(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                   "io_uring timer: %M, submit: %ud",
+                   timer, sq_local_tail - *sq_head);
+
+    ngx_memzero(&arg, sizeof(struct io_uring_getevents_arg));
+
+    if (timer != NGX_TIMER_INFINITE) {
+        ts.tv_sec = timer / 1000;
+        ts.tv_nsec = (timer % 1000) * 1000000;
+        arg.ts = (uint64_t) (uintptr_t) &ts;
+    }
+
+    ngx_memory_barrier();
+    *sq_tail = sq_local_tail;
+
+    n = io_uring_enter(ring, sq_local_tail - *sq_head, 1,
+                       IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG,
+                       &arg, sizeof(struct io_uring_getevents_arg));
+
+    err = (n == -1) ? ngx_errno : 0;
+
+    if (flags & NGX_UPDATE_TIME || ngx_event_timer_alarm) {
+        ngx_time_update();
+    }
+
+    if (err && err != ETIME && err != NGX_EBUSY) {
+        if (err == NGX_EINTR) {
+
+            if (ngx_event_timer_alarm) {
+                ngx_event_timer_alarm = 0;
+                return NGX_OK;
+            }
+
+            level = NGX_LOG_INFO;
+
+        } else {
+            level = NGX_LOG_ALERT;
+        }
+
+        ngx_log_error(level, cycle->log, err, "io_uring_enter() failed");
+        return NGX_ERROR;
+    }
+
+    head = *cq_head;
+    tail = *cq_tail;
+    ngx_memory_barrier();
+
+    if (head == tail) {
+        if (timer != NGX_TIMER_INFINITE || err) {
+            return NGX_OK;
+        }
+
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, 0,
+                      "io_uring_enter() returned no events without timeout");
+        return NGX_ERROR;
+    }
+
+    for ( /* void */ ; head != tail; head++) {
+
+        data = cqes[head & cq_mask].user_data;
+        res = cqes[head & cq_mask].res;
+        cflags = cqes[head & cq_mask].flags;
+
+        /* release the completion slot before calling the handlers */
+
+        ngx_memory_barrier();
+        *cq_head = head + 1;
+
+        if (data == 0) {
+            /* a poll removal */
+            continue;
+        }
+
+        ev = (ngx_event_t *) (uintptr_t) (data & (uint64_t) ~3);
+
+#if (NGX_HAVE_FILE_AIO)
+
+        if (data & NGX_IOURING_AIO) {
+            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                           "io_uring aio event %p res:%d", ev, res);
+
+            aio = ev->data;
+            aio->res = res;
+
+            ev->active = 0;
+            ev->complete = 1;
+            ev->ready = 1;
+
+            ngx_post_event(ev, &ngx_posted_events);
+            continue;
+        }
+
+#endif
+
+        instance = data & 1;
+
+        if (res == -ECANCELED) {
+            continue;
+        }
+
+        if (ev == &notify_event) {
+            if (!(cflags & IORING_CQE_F_MORE)) {
+                (void) ngx_iouring_poll(ev, notify_fd, POLLIN);
+            }
+
+            ev->handler(ev);
+            continue;
+        }
+
+        c = ev->data;
+
+        if (c->fd == -1 || ev->instance != instance || !ev->active) {
+
+            /*
+             * the stale event from a file descriptor
+             * that was just closed in this iteration
+             */
+
+            ngx_log_debug1(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                           "io_uring: stale event %p", ev);
+            continue;
+        }
+
+        ngx_log_debug4(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                       "io_uring: fd:%d ev:%04XD f:%ud d:%p",
+                       c->fd, res, cflags, ev);
+
+        if (res < 0) {
+            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, cycle->log, -res,
+                           "io_uring poll error on fd:%d ev:%p", c->fd, ev);
+
+            /*
+             * the failed poll is not rearmed: otherwise a persistent
+             * error would complete it again on every iteration
+             */
+
+            ev->active = 0;
+            ev->error = 1;
+
+        } else if (!(cflags & IORING_CQE_F_MORE)) {
+
+            /* the kernel has terminated the multishot poll, rearm it */
+
+            ev->active = 0;
+
+            if (ngx_iouring_add_event(ev, ev->write ? NGX_WRITE_EVENT
+                                                    : NGX_READ_EVENT, 0)
+                != NGX_OK)
+            {
+                ev->error = 1;
+            }
+        }
+
+        ev->ready = 1;
+
+        if (flags & NGX_POST_EVENTS) {
+            queue = ev->accept ? &ngx_posted_accept_events
+                               : &ngx_posted_events;
+
+            ngx_post_event(ev, queue);
+
+        } else {
+            ev->handler(ev);
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+#if (NGX_HAVE_FILE_AIO)
+
+ngx_int_t
+ngx_iouring_aio_read(ngx_event_t *ev, ngx_fd_t fd, u_char *buf, size_t size,
+    off_t offset)
+{
+    struct io_uring_sqe  *sqe;
+
+    sqe = ngx_iouring_get_sqe(ev->log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t) buf;
+    sqe->len = size;
+    sqe->off = offset;
+    sqe->user_data = (uintptr_t) ev | NGX_IOURING_AIO;
+
+    return NGX_OK;
+}
+
+#endif
+
+
+static void *
+ngx_iouring_create_conf(ngx_cycle_t *cycle)
+{
+    ngx_iouring_conf_t  *iucf;
+
+    iucf = ngx_palloc(cycle->pool, sizeof(ngx_iouring_conf_t));
+    if (iucf == NULL) {
+        return NULL;
+    }
+
+    iucf->entries = NGX_CONF_UNSET;
+
+    return iucf;
+}
+
+
+static char *
+ngx_iouring_init_conf(ngx_cycle_t *cycle, void *conf)
+{
+    ngx_iouring_conf_t *iucf = conf;
+
+    ngx_conf_init_uint_value(iucf->entries, 1024);
+
+    return NGX_CONF_OK;
+}
@@ -154,6 +154,13 @@ static ngx_command_t  ngx_event_core_commands[] = {
       offsetof(ngx_event_conf_t, accept_mutex_delay),
       NULL },
 
+    { ngx_string("timer_wheel"),
+      NGX_EVENT_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      0,
+      offsetof(ngx_event_conf_t, timer_wheel),
+      NULL },
+
     { ngx_string("debug_connection"),
       NGX_EVENT_CONF|NGX_CONF_TAKE1,
       ngx_event_debug_connection,
@@ -601,11 +608,37 @@ ngx_event_process_init(ngx_cycle_t *cycle)
 
     ngx_use_accept_mutex = 0;
 
+#endif
+
+#if (NGX_HAVE_REUSEPORT)
+
+    if (ngx_use_accept_mutex) {
+
+        /*
+         * the accept mutex only serializes shared listening sockets;
+         * if each of them is cloned per worker with SO_REUSEPORT,
+         * the kernel balances connections and the mutex is not needed
+         */
+
+        ls = cycle->listening.elts;
+        for (i = 0; i < cycle->listening.nelts; i++) {
+            if (!ls[i].reuseport) {
+                break;
+            }
+        }
+
+        if (i == cycle->listening.nelts) {
+            ngx_use_accept_mutex = 0;
+        }
+    }
+
 #endif
 
     ngx_queue_init(&ngx_posted_accept_events);
     ngx_queue_init(&ngx_posted_events);
 
+    ngx_use_timer_wheel = ecf->timer_wheel;
+
     if (ngx_event_timer_init(cycle->log) == NGX_ERROR) {
         return NGX_ERROR;
     }
@@ -746,6 +779,7 @@ ngx_event_process_init(ngx_cycle_t *cycle)
             return NGX_ERROR;
         }
 
+        c->type = ls[i].type;
         c->log = &ls[i].log;
 
         c->listening = &ls[i];
@@ -818,7 +852,8 @@ ngx_event_process_init(ngx_cycle_t *cycle)
 
 #else
 		/* ӻص  */
-        rev->handler = ngx_event_accept;
+        rev->handler = (c->type == SOCK_STREAM) ? ngx_event_accept
+                                                : ngx_event_recvmsg;
 
         if (ngx_use_accept_mutex
 #if (NGX_HAVE_REUSEPORT)
@@ -1167,6 +1202,7 @@ ngx_event_core_create_conf(ngx_cycle_t *cycle)
     ecf->multi_accept = NGX_CONF_UNSET;
     ecf->accept_mutex = NGX_CONF_UNSET;
     ecf->accept_mutex_delay = NGX_CONF_UNSET_MSEC;
+    ecf->timer_wheel = NGX_CONF_UNSET;
     ecf->name = (void *) NGX_CONF_UNSET;
 
 #if (NGX_DEBUG)
@@ -1266,6 +1302,7 @@ ngx_event_core_init_conf(ngx_cycle_t *cycle, void *conf)
     ngx_conf_init_value(ecf->multi_accept, 0);
     ngx_conf_init_value(ecf->accept_mutex, 1);
     ngx_conf_init_msec_value(ecf->accept_mutex_delay, 500);
+    ngx_conf_init_value(ecf->timer_wheel, 0);
 
     return NGX_CONF_OK;
 }
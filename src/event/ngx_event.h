@@ -420,6 +420,7 @@ extern ngx_os_io_t  ngx_io;
 #define ngx_recv_chain       ngx_io.recv_chain
 #define ngx_udp_recv         ngx_io.udp_recv
 #define ngx_send             ngx_io.send
+#define ngx_udp_send         ngx_io.udp_send
 #define ngx_send_chain       ngx_io.send_chain    /* ngx_writev_chain */
 
 
@@ -436,6 +437,8 @@ typedef struct {
 
     ngx_msec_t    accept_mutex_delay;
 
+    ngx_flag_t    timer_wheel;
+
     u_char       *name;
 
 #if (NGX_DEBUG)
@@ -494,6 +497,9 @@ extern ngx_module_t           ngx_event_core_module;
 
 
 void ngx_event_accept(ngx_event_t *ev);
+#if !(NGX_WIN32)
+void ngx_event_recvmsg(ngx_event_t *ev);
+#endif
 ngx_int_t ngx_trylock_accept_mutex(ngx_cycle_t *cycle);
 u_char *ngx_accept_log_error(ngx_log_t *log, u_char *buf, size_t len);
 
@@ -10,9 +10,20 @@
 #include <ngx_event.h>
 
 
+#if (NGX_HAVE_RECVMMSG)
+#define NGX_RECVMMSG_BATCH  16
+#endif
+
+
 static ngx_int_t ngx_enable_accept_events(ngx_cycle_t *cycle);
 static ngx_int_t ngx_disable_accept_events(ngx_cycle_t *cycle, ngx_uint_t all);
 static void ngx_close_accepted_connection(ngx_connection_t *c);
+#if !(NGX_WIN32)
+static ngx_int_t ngx_event_udp_session(ngx_event_t *ev, u_char *buf,
+    size_t n, struct sockaddr *sa, socklen_t socklen);
+static ssize_t ngx_udp_shared_recv(ngx_connection_t *c, u_char *buf,
+    size_t size);
+#endif
 
 /* accept¼ */
 void
@@ -150,6 +161,8 @@ ngx_event_accept(ngx_event_t *ev)
             return;
         }
 
+        c->type = SOCK_STREAM;
+
 #if (NGX_STAT_STUB)
         (void) ngx_atomic_fetch_add(ngx_stat_active, 1);
 #endif
@@ -364,6 +377,313 @@ ngx_event_accept(ngx_event_t *ev)
 }
 
 
+#if !(NGX_WIN32)
+
+void
+ngx_event_recvmsg(ngx_event_t *ev)
+{
+    ssize_t            n;
+    ngx_err_t          err;
+    ngx_event_conf_t  *ecf;
+    ngx_connection_t  *lc;
+#if (NGX_HAVE_RECVMMSG)
+    ngx_uint_t         i;
+    struct iovec       iov[NGX_RECVMMSG_BATCH];
+    struct mmsghdr     msgs[NGX_RECVMMSG_BATCH];
+    u_char             sa[NGX_RECVMMSG_BATCH][NGX_SOCKADDRLEN];
+
+    static u_char      buffer[NGX_RECVMMSG_BATCH][65535];
+#else
+    struct iovec       iov[1];
+    struct msghdr      msg;
+    u_char             sa[NGX_SOCKADDRLEN];
+
+    static u_char      buffer[65535];
+#endif
+
+    if (ev->timedout) {
+        if (ngx_enable_accept_events((ngx_cycle_t *) ngx_cycle) != NGX_OK) {
+            return;
+        }
+
+        ev->timedout = 0;
+    }
+
+    ecf = ngx_event_get_conf(ngx_cycle->conf_ctx, ngx_event_core_module);
+
+    if (!(ngx_event_flags & NGX_USE_KQUEUE_EVENT)) {
+        ev->available = ecf->multi_accept;
+    }
+
+    lc = ev->data;
+    ev->ready = 0;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                   "recvmsg on %V, ready: %d",
+                   &lc->listening->addr_text, ev->available);
+
+    do {
+
+#if (NGX_HAVE_RECVMMSG)
+
+        /* up to NGX_RECVMMSG_BATCH datagrams are read with one syscall */
+
+        ngx_memzero(msgs, sizeof(msgs));
+
+        for (i = 0; i < NGX_RECVMMSG_BATCH; i++) {
+            iov[i].iov_base = (void *) buffer[i];
+            iov[i].iov_len = sizeof(buffer[i]);
+
+            msgs[i].msg_hdr.msg_name = sa[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sa[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        n = recvmmsg(lc->fd, msgs, NGX_RECVMMSG_BATCH, 0, NULL);
+
+        if (n == -1) {
+            err = ngx_socket_errno;
+
+            if (err == NGX_EAGAIN) {
+                ngx_log_debug0(NGX_LOG_DEBUG_EVENT, ev->log, err,
+                               "recvmmsg() not ready");
+                return;
+            }
+
+            ngx_log_error(NGX_LOG_ALERT, ev->log, err, "recvmmsg() failed");
+
+            return;
+        }
+
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                       "recvmmsg: %z datagrams", n);
+
+        for (i = 0; i < (ngx_uint_t) n; i++) {
+
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                ngx_log_error(NGX_LOG_WARN, ev->log, 0,
+                              "recvmmsg() truncated data");
+                continue;
+            }
+
+            if (ngx_event_udp_session(ev, buffer[i], msgs[i].msg_len,
+                                      msgs[i].msg_hdr.msg_name,
+                                      msgs[i].msg_hdr.msg_namelen)
+                != NGX_OK)
+            {
+                return;
+            }
+
+            if (ngx_event_flags & NGX_USE_KQUEUE_EVENT) {
+                ev->available -= msgs[i].msg_len;
+            }
+        }
+
+        if (n < NGX_RECVMMSG_BATCH) {
+            /* the socket buffer is drained */
+            return;
+        }
+
+#else
+
+        ngx_memzero(&msg, sizeof(struct msghdr));
+
+        iov[0].iov_base = (void *) buffer;
+        iov[0].iov_len = sizeof(buffer);
+
+        msg.msg_name = &sa;
+        msg.msg_namelen = sizeof(sa);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 1;
+
+        n = recvmsg(lc->fd, &msg, 0);
+
+        if (n == -1) {
+            err = ngx_socket_errno;
+
+            if (err == NGX_EAGAIN) {
+                ngx_log_debug0(NGX_LOG_DEBUG_EVENT, ev->log, err,
+                               "recvmsg() not ready");
+                return;
+            }
+
+            ngx_log_error(NGX_LOG_ALERT, ev->log, err, "recvmsg() failed");
+
+            return;
+        }
+
+        if (msg.msg_flags & MSG_TRUNC) {
+            ngx_log_error(NGX_LOG_WARN, ev->log, 0,
+                          "recvmsg() truncated data");
+            continue;
+        }
+
+        if (ngx_event_udp_session(ev, buffer, n, msg.msg_name,
+                                  msg.msg_namelen)
+            != NGX_OK)
+        {
+            return;
+        }
+
+        if (ngx_event_flags & NGX_USE_KQUEUE_EVENT) {
+            ev->available -= n;
+        }
+
+#endif
+
+    } while (ev->available > 0);
+}
+
+
+static ngx_int_t
+ngx_event_udp_session(ngx_event_t *ev, u_char *buf, size_t n,
+    struct sockaddr *sa, socklen_t socklen)
+{
+    ngx_log_t         *log;
+    ngx_event_t       *rev, *wev;
+    ngx_listening_t   *ls;
+    ngx_connection_t  *c, *lc;
+
+    lc = ev->data;
+    ls = lc->listening;
+
+#if (NGX_STAT_STUB)
+    (void) ngx_atomic_fetch_add(ngx_stat_accepted, 1);
+#endif
+
+    ngx_accept_disabled = ngx_cycle->connection_n / 8
+                          - ngx_cycle->free_connection_n;
+
+    c = ngx_get_connection(lc->fd, ev->log);
+    if (c == NULL) {
+        return NGX_ERROR;
+    }
+
+    c->shared = 1;
+    c->type = SOCK_DGRAM;
+    c->socklen = socklen;
+
+#if (NGX_STAT_STUB)
+    (void) ngx_atomic_fetch_add(ngx_stat_active, 1);
+#endif
+
+    c->pool = ngx_create_pool(ls->pool_size, ev->log);
+    if (c->pool == NULL) {
+        ngx_close_accepted_connection(c);
+        return NGX_ERROR;
+    }
+
+    c->sockaddr = ngx_palloc(c->pool, c->socklen);
+    if (c->sockaddr == NULL) {
+        ngx_close_accepted_connection(c);
+        return NGX_ERROR;
+    }
+
+    ngx_memcpy(c->sockaddr, sa, c->socklen);
+
+    log = ngx_palloc(c->pool, sizeof(ngx_log_t));
+    if (log == NULL) {
+        ngx_close_accepted_connection(c);
+        return NGX_ERROR;
+    }
+
+    *log = ls->log;
+
+    c->buffer = ngx_create_temp_buf(c->pool, n);
+    if (c->buffer == NULL) {
+        ngx_close_accepted_connection(c);
+        return NGX_ERROR;
+    }
+
+    c->buffer->last = ngx_cpymem(c->buffer->last, buf, n);
+
+    c->recv = ngx_udp_shared_recv;
+    c->send = ngx_udp_send;
+
+    c->log = log;
+    c->pool->log = log;
+
+    c->listening = ls;
+    c->local_sockaddr = ls->sockaddr;
+    c->local_socklen = ls->socklen;
+
+    rev = c->read;
+    wev = c->write;
+
+    /*
+     * the descriptor belongs to the listening socket, so the events
+     * of this connection are never passed to the event module
+     */
+
+    rev->active = 1;
+    rev->ready = 1;
+    wev->ready = 1;
+
+    rev->log = log;
+    wev->log = log;
+
+    c->number = ngx_atomic_fetch_add(ngx_connection_counter, 1);
+
+#if (NGX_STAT_STUB)
+    (void) ngx_atomic_fetch_add(ngx_stat_handled, 1);
+#endif
+
+    if (ls->addr_ntop) {
+        c->addr_text.data = ngx_pnalloc(c->pool, ls->addr_text_max_len);
+        if (c->addr_text.data == NULL) {
+            ngx_close_accepted_connection(c);
+            return NGX_ERROR;
+        }
+
+        c->addr_text.len = ngx_sock_ntop(c->sockaddr, c->socklen,
+                                         c->addr_text.data,
+                                         ls->addr_text_max_len, 0);
+        if (c->addr_text.len == 0) {
+            ngx_close_accepted_connection(c);
+            return NGX_ERROR;
+        }
+    }
+
+    ngx_log_debug4(NGX_LOG_DEBUG_EVENT, log, 0,
+                   "*%uA recvmsg: %V fd:%d n:%uz",
+                   c->number, &c->addr_text, c->fd, n);
+
+    log->data = NULL;
+    log->handler = NULL;
+
+    ls->handler(c);
+
+    return NGX_OK;
+}
+
+
+static ssize_t
+ngx_udp_shared_recv(ngx_connection_t *c, u_char *buf, size_t size)
+{
+    ssize_t     n;
+    ngx_buf_t  *b;
+
+    b = c->buffer;
+
+    if (b == NULL) {
+        c->read->ready = 0;
+        return NGX_AGAIN;
+    }
+
+    n = ngx_min(b->last - b->pos, (ssize_t) size);
+
+    ngx_memcpy(buf, b->pos, n);
+
+    c->buffer = NULL;
+    c->read->ready = 0;
+
+    return n;
+}
+
+#endif
+
+
 ngx_int_t
 ngx_trylock_accept_mutex(ngx_cycle_t *cycle)
 {
@@ -478,7 +798,7 @@ ngx_close_accepted_connection(ngx_connection_t *c)
     fd = c->fd;
     c->fd = (ngx_socket_t) -1;
 
-    if (ngx_close_socket(fd) == -1) {
+    if (!c->shared && ngx_close_socket(fd) == -1) {
         ngx_log_error(NGX_LOG_ALERT, c->log, ngx_socket_errno,
                       ngx_close_socket_n " failed");
     }
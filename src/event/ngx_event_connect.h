@@ -57,6 +57,8 @@ struct ngx_peer_connection_s {
 	/* SO_RCVBUF ѡϢ */
     int                              rcvbuf;
 
+    int                              type;
+
     ngx_log_t                       *log;
 
     unsigned                         cached:1;
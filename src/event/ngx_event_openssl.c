@@ -9,6 +9,10 @@
 #include <ngx_core.h>
 #include <ngx_event.h>
 
+#if (NGX_THREADS)
+#include <ngx_thread_pool.h>
+#endif
+
 
 #define NGX_SSL_PASSWORD_BUFFER_SIZE  4096
 
@@ -24,7 +28,30 @@ static int ngx_ssl_verify_callback(int ok, X509_STORE_CTX *x509_store);
 static void ngx_ssl_info_callback(const ngx_ssl_conn_t *ssl_conn, int where,
     int ret);
 static void ngx_ssl_passwords_cleanup(void *data);
+static ngx_int_t ngx_ssl_handshaked(ngx_connection_t *c);
+static ngx_int_t ngx_ssl_handshake_again(ngx_connection_t *c, int sslerr);
 static void ngx_ssl_handshake_handler(ngx_event_t *ev);
+#if (NGX_SSL_KTLS)
+static ngx_int_t ngx_ssl_ktls_start(ngx_connection_t *c);
+static ngx_int_t ngx_ssl_ktls_key_block(ngx_ssl_conn_t *ssl_conn,
+    const EVP_MD *md, u_char *out, size_t len);
+static void ngx_ssl_ktls_shutdown(ngx_connection_t *c);
+#endif
+#if (NGX_THREADS)
+static ngx_int_t ngx_ssl_thread_handshake(ngx_connection_t *c);
+static void ngx_ssl_handshake_thread_handler(void *data, ngx_log_t *log);
+static void ngx_ssl_handshake_thread_event_handler(ngx_event_t *ev);
+static void ngx_ssl_handshake_busy_handler(ngx_event_t *ev);
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static void ngx_ssl_locking_callback(int mode, int n, const char *file,
+    int line);
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+static void ngx_ssl_threadid_callback(CRYPTO_THREADID *id);
+#else
+static unsigned long ngx_ssl_id_callback(void);
+#endif
+#endif
+#endif
 static ngx_int_t ngx_ssl_handle_recv(ngx_connection_t *c, int n);
 static void ngx_ssl_write_handler(ngx_event_t *wev);
 static void ngx_ssl_read_handler(ngx_event_t *rev);
@@ -41,7 +68,7 @@ static int ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn,
 static ngx_ssl_session_t *ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn,
     u_char *id, int len, int *copy);
 static void ngx_ssl_remove_session(SSL_CTX *ssl, ngx_ssl_session_t *sess);
-static void ngx_ssl_expire_sessions(ngx_ssl_session_cache_t *cache,
+static void ngx_ssl_expire_sessions(ngx_ssl_session_shard_t *shard,
     ngx_slab_pool_t *shpool, ngx_uint_t n);
 static void ngx_ssl_session_rbtree_insert_value(ngx_rbtree_node_t *temp,
     ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
@@ -105,6 +132,24 @@ int  ngx_ssl_certificate_index;
 int  ngx_ssl_stapling_index;
 
 
+#if (NGX_THREADS)
+
+typedef struct {
+    ngx_connection_t           *connection;
+    int                         n;
+    int                         sslerr;
+    ngx_err_t                   err;
+    ngx_uint_t                  closed;
+} ngx_ssl_handshake_ctx_t;
+
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static ngx_thread_mutex_t  *ngx_ssl_locks;
+#endif
+
+#endif
+
+
 ngx_int_t
 ngx_ssl_init(ngx_log_t *log)
 {
@@ -1025,6 +1070,120 @@ ngx_ssl_ecdh_curve(ngx_conf_t *cf, ngx_ssl_t *ssl, ngx_str_t *name)
 }
 
 
+ngx_int_t
+ngx_ssl_ktls(ngx_conf_t *cf, ngx_ssl_t *ssl)
+{
+#if (NGX_SSL_KTLS)
+
+    /*
+     * the "tls" TCP ULP is set up after the handshake if the kernel
+     * supports it and the negotiated cipher, otherwise the connection
+     * is encrypted in user space as usual
+     */
+
+    ssl->ktls = 1;
+
+#else
+
+    ngx_log_error(NGX_LOG_WARN, ssl->log, 0,
+                  "kernel TLS is not supported by this build, ignored");
+
+#endif
+
+    return NGX_OK;
+}
+
+
+#if (NGX_THREADS)
+
+/*
+ * SSL_do_handshake() runs in a pool thread, and so do all callbacks it
+ * calls: SNI and ALPN/NPN selection, certificate verification, session
+ * tickets, the shared session cache (protected by its shmtx), and the info
+ * callback.  These may only use the connection, its pool and log, which the
+ * event loop does not touch until the task is done, and shared memory under
+ * a lock.  Anything that posts events or timers must not be called there:
+ * OCSP stapling is therefore refused together with handshake threads.
+ */
+
+ngx_int_t
+ngx_ssl_handshake_threads(ngx_conf_t *cf, ngx_ssl_t *ssl,
+    ngx_thread_pool_t *tp)
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+
+    int  i, n;
+
+    if (ngx_ssl_locks == NULL) {
+
+        /* OpenSSL prior to 1.1.0 needs locking callbacks to use threads */
+
+        n = CRYPTO_num_locks();
+
+        ngx_ssl_locks = ngx_alloc(n * sizeof(ngx_thread_mutex_t), cf->log);
+        if (ngx_ssl_locks == NULL) {
+            return NGX_ERROR;
+        }
+
+        for (i = 0; i < n; i++) {
+            if (ngx_thread_mutex_create(&ngx_ssl_locks[i], cf->log) != NGX_OK) {
+                return NGX_ERROR;
+            }
+        }
+
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+        CRYPTO_THREADID_set_callback(ngx_ssl_threadid_callback);
+#else
+        CRYPTO_set_id_callback(ngx_ssl_id_callback);
+#endif
+        CRYPTO_set_locking_callback(ngx_ssl_locking_callback);
+    }
+
+#endif
+
+    ssl->thread_pool = tp;
+
+    return NGX_OK;
+}
+
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+
+static void
+ngx_ssl_locking_callback(int mode, int n, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK) {
+        (void) ngx_thread_mutex_lock(&ngx_ssl_locks[n], ngx_cycle->log);
+
+    } else {
+        (void) ngx_thread_mutex_unlock(&ngx_ssl_locks[n], ngx_cycle->log);
+    }
+}
+
+
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+
+static void
+ngx_ssl_threadid_callback(CRYPTO_THREADID *id)
+{
+    CRYPTO_THREADID_set_numeric(id, (unsigned long) ngx_thread_tid());
+}
+
+#else
+
+static unsigned long
+ngx_ssl_id_callback(void)
+{
+    return (unsigned long) ngx_thread_tid();
+}
+
+#endif
+
+#endif
+
+#endif
+
+
 ngx_int_t
 ngx_ssl_create_connection(ngx_ssl_t *ssl, ngx_connection_t *c, ngx_uint_t flags)
 {
@@ -1055,6 +1214,12 @@ ngx_ssl_create_connection(ngx_ssl_t *ssl, ngx_connection_t *c, ngx_uint_t flags)
 
     } else {
         SSL_set_accept_state(sc->connection);
+
+        sc->ktls = ssl->ktls;
+
+#if (NGX_THREADS)
+        sc->thread_pool = ssl->thread_pool;
+#endif
     }
 
     if (SSL_set_ex_data(sc->connection, ngx_ssl_connection_index, c) == 0) {
@@ -1064,168 +1229,650 @@ ngx_ssl_create_connection(ngx_ssl_t *ssl, ngx_connection_t *c, ngx_uint_t flags)
 
     c->ssl = sc;
 
-    return NGX_OK;
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_ssl_set_session(ngx_connection_t *c, ngx_ssl_session_t *session)
+{
+    if (session) {
+        if (SSL_set_session(c->ssl->connection, session) == 0) {
+            ngx_ssl_error(NGX_LOG_ALERT, c->log, 0, "SSL_set_session() failed");
+            return NGX_ERROR;
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_ssl_handshake(ngx_connection_t *c)
+{
+    int        n, sslerr;
+    ngx_err_t  err;
+
+#if (NGX_THREADS)
+    if (c->ssl->thread_pool) {
+        return ngx_ssl_thread_handshake(c);
+    }
+#endif
+
+    ngx_ssl_clear_error(c->log);
+
+    n = SSL_do_handshake(c->ssl->connection);
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0, "SSL_do_handshake: %d", n);
+
+    if (n == 1) {
+        return ngx_ssl_handshaked(c);
+    }
+
+    sslerr = SSL_get_error(c->ssl->connection, n);
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0, "SSL_get_error: %d", sslerr);
+
+    if (sslerr == SSL_ERROR_WANT_READ || sslerr == SSL_ERROR_WANT_WRITE) {
+        return ngx_ssl_handshake_again(c, sslerr);
+    }
+
+    err = (sslerr == SSL_ERROR_SYSCALL) ? ngx_errno : 0;
+
+    c->ssl->no_wait_shutdown = 1;
+    c->ssl->no_send_shutdown = 1;
+    c->read->eof = 1;
+
+    if (sslerr == SSL_ERROR_ZERO_RETURN || ERR_peek_error() == 0) {
+        ngx_connection_error(c, err,
+                             "peer closed connection in SSL handshake");
+
+        return NGX_ERROR;
+    }
+
+    c->read->error = 1;
+
+    ngx_ssl_connection_error(c, sslerr, err, "SSL_do_handshake() failed");
+
+    return NGX_ERROR;
+}
+
+
+static ngx_int_t
+ngx_ssl_handshaked(ngx_connection_t *c)
+{
+    if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+#if (NGX_DEBUG)
+    {
+    char         buf[129], *s, *d;
+#if OPENSSL_VERSION_NUMBER >= 0x10000000L
+    const
+#endif
+    SSL_CIPHER  *cipher;
+
+    cipher = SSL_get_current_cipher(c->ssl->connection);
+
+    if (cipher) {
+        SSL_CIPHER_description(cipher, &buf[1], 128);
+
+        for (s = &buf[1], d = buf; *s; s++) {
+            if (*s == ' ' && *d == ' ') {
+                continue;
+            }
+
+            if (*s == LF || *s == CR) {
+                continue;
+            }
+
+            *++d = *s;
+        }
+
+        if (*d != ' ') {
+            d++;
+        }
+
+        *d = '\0';
+
+        ngx_log_debug2(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "SSL: %s, cipher: \"%s\"",
+                       SSL_get_version(c->ssl->connection), &buf[1]);
+
+        if (SSL_session_reused(c->ssl->connection)) {
+            ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                           "SSL reused session");
+        }
+
+    } else {
+        ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "SSL no shared ciphers");
+    }
+    }
+#endif
+
+    c->ssl->handshaked = 1;
+
+    c->recv = ngx_ssl_recv;
+    c->send = ngx_ssl_write;
+    c->recv_chain = ngx_ssl_recv_chain;
+    c->send_chain = ngx_ssl_send_chain;
+
+#if (NGX_SSL_KTLS)
+
+    if (c->ssl->ktls && ngx_ssl_ktls_start(c) == NGX_OK) {
+
+        /* the kernel encrypts all data sent, so files may use sendfile() */
+
+        c->send = ngx_send;
+        c->send_chain = ngx_send_chain;
+
+        c->ssl->sendfile = 1;
+    }
+
+#endif
+
+#ifdef SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS
+
+    /* initial handshake done, disable renegotiation (CVE-2009-3555) */
+    if (c->ssl->connection->s3) {
+        c->ssl->connection->s3->flags |= SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS;
+    }
+
+#endif
+
+    return NGX_OK;
+}
+
+
+#if (NGX_SSL_KTLS)
+
+static ngx_int_t
+ngx_ssl_ktls_start(ngx_connection_t *c)
+{
+    u_char          *key, *salt;
+    u_char           block[2 * 32 + 2 * EVP_GCM_TLS_FIXED_IV_LEN];
+    size_t           size;
+    BIO             *wbio;
+    ngx_int_t        rc;
+    const EVP_MD    *md;
+    ngx_ssl_conn_t  *ssl_conn;
+    union {
+        struct tls12_crypto_info_aes_gcm_128  gcm128;
+#ifdef TLS_CIPHER_AES_GCM_256
+        struct tls12_crypto_info_aes_gcm_256  gcm256;
+#endif
+    } ci;
+
+    ssl_conn = c->ssl->connection;
+
+    /* only TLS 1.2 AES-GCM, with nothing left in the OpenSSL write buffer */
+
+    if (ssl_conn->version != TLS1_2_VERSION
+        || ssl_conn->enc_write_ctx == NULL
+        || ssl_conn->s3->wbuf.left)
+    {
+        return NGX_DECLINED;
+    }
+
+    switch (EVP_CIPHER_CTX_nid(ssl_conn->enc_write_ctx)) {
+
+    case NID_aes_128_gcm:
+        size = 16;
+        md = EVP_sha256();
+        break;
+
+#ifdef TLS_CIPHER_AES_GCM_256
+    case NID_aes_256_gcm:
+        size = 32;
+        md = EVP_sha384();
+        break;
+#endif
+
+    default:
+        return NGX_DECLINED;
+    }
+
+    /*
+     * an AEAD key block holds no MAC keys: the client and server write keys
+     * are followed by the client and server implicit nonce parts
+     */
+
+    if (ngx_ssl_ktls_key_block(ssl_conn, md, block,
+                               2 * size + 2 * EVP_GCM_TLS_FIXED_IV_LEN)
+        != NGX_OK)
+    {
+        ngx_ssl_error(NGX_LOG_ALERT, c->log, 0, "HMAC() failed");
+        return NGX_ERROR;
+    }
+
+    if (ssl_conn->server) {
+        key = block + size;
+        salt = block + 2 * size + EVP_GCM_TLS_FIXED_IV_LEN;
+
+    } else {
+        key = block;
+        salt = block + 2 * size;
+    }
+
+    ngx_memzero(&ci, sizeof(ci));
+
+    /*
+     * the explicit nonce only has to be unique for the key,
+     * so it starts from the record sequence number
+     */
+
+#ifdef TLS_CIPHER_AES_GCM_256
+    if (size == 32) {
+        ci.gcm256.info.version = TLS_1_2_VERSION;
+        ci.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        ngx_memcpy(ci.gcm256.key, key, size);
+        ngx_memcpy(ci.gcm256.salt, salt, EVP_GCM_TLS_FIXED_IV_LEN);
+        ngx_memcpy(ci.gcm256.iv, ssl_conn->s3->write_sequence, 8);
+        ngx_memcpy(ci.gcm256.rec_seq, ssl_conn->s3->write_sequence, 8);
+
+        size = sizeof(struct tls12_crypto_info_aes_gcm_256);
+
+    } else
+#endif
+    {
+        ci.gcm128.info.version = TLS_1_2_VERSION;
+        ci.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        ngx_memcpy(ci.gcm128.key, key, size);
+        ngx_memcpy(ci.gcm128.salt, salt, EVP_GCM_TLS_FIXED_IV_LEN);
+        ngx_memcpy(ci.gcm128.iv, ssl_conn->s3->write_sequence, 8);
+        ngx_memcpy(ci.gcm128.rec_seq, ssl_conn->s3->write_sequence, 8);
+
+        size = sizeof(struct tls12_crypto_info_aes_gcm_128);
+    }
+
+    OPENSSL_cleanse(block, sizeof(block));
+
+    /*
+     * OpenSSL still decrypts the input, but anything it would send itself,
+     * such as alerts, must not get into the kernel record stream
+     */
+
+    wbio = BIO_new(BIO_s_null());
+    if (wbio == NULL) {
+        ngx_ssl_error(NGX_LOG_ALERT, c->log, 0, "BIO_new() failed");
+        rc = NGX_ERROR;
+        goto done;
+    }
+
+    if (setsockopt(c->fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == -1) {
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, ngx_socket_errno,
+                       "setsockopt(TCP_ULP, \"tls\") failed, fd:%d", c->fd);
+        rc = NGX_DECLINED;
+        goto failed;
+    }
+
+    if (setsockopt(c->fd, SOL_TLS, TLS_TX, &ci, size) == -1) {
+        ngx_log_error(NGX_LOG_INFO, c->log, ngx_socket_errno,
+                      "setsockopt(TLS_TX) failed, kernel TLS is not used");
+        rc = NGX_DECLINED;
+        goto failed;
+    }
+
+    SSL_set_bio(ssl_conn, SSL_get_rbio(ssl_conn), wbio);
+
+    ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0, "SSL kernel TLS send");
+
+    rc = NGX_OK;
+
+    goto done;
+
+failed:
+
+    BIO_free(wbio);
+
+done:
+
+    OPENSSL_cleanse(&ci, sizeof(ci));
+
+    return rc;
+}
+
+
+static ngx_int_t
+ngx_ssl_ktls_key_block(ngx_ssl_conn_t *ssl_conn, const EVP_MD *md,
+    u_char *out, size_t len)
+{
+    u_char        *p;
+    size_t         n;
+    unsigned int   alen, blen;
+    SSL_SESSION   *sess;
+    u_char         seed[sizeof("key expansion") - 1 + 2 * SSL3_RANDOM_SIZE];
+    u_char         a[EVP_MAX_MD_SIZE + sizeof(seed)];
+    u_char         b[EVP_MAX_MD_SIZE];
+
+    /*
+     * the TLS 1.2 PRF (RFC 5246, section 5):
+     *
+     *   P_hash(master_secret, "key expansion" + server_random + client_random)
+     *
+     *   A(0) = seed, A(i) = HMAC(secret, A(i - 1)),
+     *   output = HMAC(secret, A(1) + seed) + HMAC(secret, A(2) + seed) + ...
+     */
+
+    sess = SSL_get_session(ssl_conn);
+
+    p = ngx_cpymem(seed, "key expansion", sizeof("key expansion") - 1);
+    p = ngx_cpymem(p, ssl_conn->s3->server_random, SSL3_RANDOM_SIZE);
+    ngx_memcpy(p, ssl_conn->s3->client_random, SSL3_RANDOM_SIZE);
+
+    if (HMAC(md, sess->master_key, sess->master_key_length,
+             seed, sizeof(seed), a, &alen)
+        == NULL)
+    {
+        return NGX_ERROR;
+    }
+
+    for ( ;; ) {
+        ngx_memcpy(a + alen, seed, sizeof(seed));
+
+        if (HMAC(md, sess->master_key, sess->master_key_length,
+                 a, alen + sizeof(seed), b, &blen)
+            == NULL)
+        {
+            return NGX_ERROR;
+        }
+
+        n = ngx_min(len, blen);
+
+        out = ngx_cpymem(out, b, n);
+        len -= n;
+
+        if (len == 0) {
+            break;
+        }
+
+        if (HMAC(md, sess->master_key, sess->master_key_length,
+                 a, alen, b, &blen)
+            == NULL)
+        {
+            return NGX_ERROR;
+        }
+
+        ngx_memcpy(a, b, blen);
+        alen = blen;
+    }
+
+    OPENSSL_cleanse(a, sizeof(a));
+    OPENSSL_cleanse(b, sizeof(b));
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_ssl_ktls_shutdown(ngx_connection_t *c)
+{
+    u_char           alert[2];
+    struct iovec     iov;
+    struct msghdr    msg;
+    struct cmsghdr  *cmsg;
+    union {
+        struct cmsghdr  cm;
+        u_char          buf[CMSG_SPACE(sizeof(u_char))];
+    } control;
+
+    /* the close_notify alert is sent as a kernel TLS record of its own */
+
+    alert[0] = SSL3_AL_WARNING;
+    alert[1] = SSL3_AD_CLOSE_NOTIFY;
+
+    iov.iov_base = alert;
+    iov.iov_len = sizeof(alert);
+
+    ngx_memzero(&msg, sizeof(struct msghdr));
+    ngx_memzero(&control, sizeof(control));
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = &control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(u_char));
+
+    *CMSG_DATA(cmsg) = SSL3_RT_ALERT;
+
+    if (sendmsg(c->fd, &msg, 0) == -1) {
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, ngx_socket_errno,
+                       "sendmsg(close_notify) failed, fd:%d", c->fd);
+    }
+}
+
+#endif
+
+
+static ngx_int_t
+ngx_ssl_handshake_again(ngx_connection_t *c, int sslerr)
+{
+    if (sslerr == SSL_ERROR_WANT_READ) {
+        c->read->ready = 0;
+
+    } else {
+        c->write->ready = 0;
+    }
+
+    c->read->handler = ngx_ssl_handshake_handler;
+    c->write->handler = ngx_ssl_handshake_handler;
+
+    if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    return NGX_AGAIN;
 }
 
 
-ngx_int_t
-ngx_ssl_set_session(ngx_connection_t *c, ngx_ssl_session_t *session)
+#if (NGX_THREADS)
+
+static ngx_int_t
+ngx_ssl_thread_handshake(ngx_connection_t *c)
 {
-    if (session) {
-        if (SSL_set_session(c->ssl->connection, session) == 0) {
-            ngx_ssl_error(NGX_LOG_ALERT, c->log, 0, "SSL_set_session() failed");
+    ngx_thread_task_t        *task;
+    ngx_ssl_handshake_ctx_t  *ctx;
+
+    if (c->ssl->handshake_busy) {
+        return NGX_AGAIN;
+    }
+
+    task = c->ssl->handshake_task;
+
+    if (task == NULL) {
+        task = ngx_thread_task_alloc(c->pool, sizeof(ngx_ssl_handshake_ctx_t));
+        if (task == NULL) {
             return NGX_ERROR;
         }
+
+        task->handler = ngx_ssl_handshake_thread_handler;
+        task->event.data = c;
+        task->event.handler = ngx_ssl_handshake_thread_event_handler;
+
+        ctx = task->ctx;
+        ctx->connection = c;
+
+        c->ssl->handshake_task = task;
     }
 
-    return NGX_OK;
-}
+    ctx = task->ctx;
 
+    if (c->ssl->handshake_done) {
+        c->ssl->handshake_done = 0;
 
-ngx_int_t
-ngx_ssl_handshake(ngx_connection_t *c)
-{
-    int        n, sslerr;
-    ngx_err_t  err;
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "thread SSL_do_handshake: %d", ctx->n);
 
-    ngx_ssl_clear_error(c->log);
+        if (ctx->n == 1) {
+            return ngx_ssl_handshaked(c);
+        }
 
-    n = SSL_do_handshake(c->ssl->connection);
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "thread SSL_get_error: %d", ctx->sslerr);
 
-    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0, "SSL_do_handshake: %d", n);
+        if (ctx->sslerr != SSL_ERROR_WANT_READ
+            && ctx->sslerr != SSL_ERROR_WANT_WRITE)
+        {
+            /* the error was already logged in the thread */
 
-    if (n == 1) {
+            c->ssl->no_wait_shutdown = 1;
+            c->ssl->no_send_shutdown = 1;
+            c->read->eof = 1;
+
+            if (!ctx->closed) {
+                c->read->error = 1;
+            }
 
-        if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
             return NGX_ERROR;
         }
 
-        if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
-            return NGX_ERROR;
+        if (!c->ssl->handshake_pending) {
+            return ngx_ssl_handshake_again(c, ctx->sslerr);
         }
 
-#if (NGX_DEBUG)
-        {
-        char         buf[129], *s, *d;
-#if OPENSSL_VERSION_NUMBER >= 0x10000000L
-        const
-#endif
-        SSL_CIPHER  *cipher;
+        /*
+         * an edge-triggered event was reported while the thread was busy
+         * and will not be reported again, so the step is retried at once
+         */
 
-        cipher = SSL_get_current_cipher(c->ssl->connection);
+        ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "thread SSL handshake pending event");
+    }
 
-        if (cipher) {
-            SSL_CIPHER_description(cipher, &buf[1], 128);
+    /*
+     * the connection must not be touched by the event loop until
+     * the handshake step is finished: SSL_do_handshake() uses its
+     * socket, pool and log in the thread
+     */
 
-            for (s = &buf[1], d = buf; *s; s++) {
-                if (*s == ' ' && *d == ' ') {
-                    continue;
-                }
+    if (ngx_thread_task_post(c->ssl->thread_pool, task) != NGX_OK) {
+        return NGX_ERROR;
+    }
 
-                if (*s == LF || *s == CR) {
-                    continue;
-                }
+    c->ssl->handshake_busy = 1;
+    c->ssl->handshake_pending = 0;
 
-                *++d = *s;
-            }
+    c->read->handler = ngx_ssl_handshake_busy_handler;
+    c->write->handler = ngx_ssl_handshake_busy_handler;
 
-            if (*d != ' ') {
-                d++;
-            }
+    return NGX_AGAIN;
+}
 
-            *d = '\0';
 
-            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, c->log, 0,
-                           "SSL: %s, cipher: \"%s\"",
-                           SSL_get_version(c->ssl->connection), &buf[1]);
+static void
+ngx_ssl_handshake_thread_handler(void *data, ngx_log_t *log)
+{
+    ngx_ssl_handshake_ctx_t *ctx = data;
 
-            if (SSL_session_reused(c->ssl->connection)) {
-                ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
-                               "SSL reused session");
-            }
+    ngx_connection_t  *c;
 
-        } else {
-            ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
-                           "SSL no shared ciphers");
-        }
-        }
-#endif
+    c = ctx->connection;
 
-        c->ssl->handshaked = 1;
+    ngx_log_debug0(NGX_LOG_DEBUG_CORE, log, 0, "thread SSL handshake handler");
 
-        c->recv = ngx_ssl_recv;
-        c->send = ngx_ssl_write;
-        c->recv_chain = ngx_ssl_recv_chain;
-        c->send_chain = ngx_ssl_send_chain;
+    /* OpenSSL error queue is per thread, so errors are logged here */
 
-#ifdef SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS
+    ngx_ssl_clear_error(c->log);
 
-        /* initial handshake done, disable renegotiation (CVE-2009-3555) */
-        if (c->ssl->connection->s3) {
-            c->ssl->connection->s3->flags |= SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS;
-        }
+    ctx->n = SSL_do_handshake(c->ssl->connection);
+    ctx->closed = 0;
 
-#endif
+    if (ctx->n == 1) {
+        return;
+    }
 
-        return NGX_OK;
+    ctx->sslerr = SSL_get_error(c->ssl->connection, ctx->n);
+
+    if (ctx->sslerr == SSL_ERROR_WANT_READ
+        || ctx->sslerr == SSL_ERROR_WANT_WRITE)
+    {
+        return;
     }
 
-    sslerr = SSL_get_error(c->ssl->connection, n);
+    ctx->err = (ctx->sslerr == SSL_ERROR_SYSCALL) ? ngx_errno : 0;
 
-    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0, "SSL_get_error: %d", sslerr);
+    if (ctx->sslerr == SSL_ERROR_ZERO_RETURN || ERR_peek_error() == 0) {
+        ngx_connection_error(c, ctx->err,
+                             "peer closed connection in SSL handshake");
+        ctx->closed = 1;
+        return;
+    }
 
-    if (sslerr == SSL_ERROR_WANT_READ) {
-        c->read->ready = 0;
-        c->read->handler = ngx_ssl_handshake_handler;
-        c->write->handler = ngx_ssl_handshake_handler;
+    ngx_ssl_connection_error(c, ctx->sslerr, ctx->err,
+                             "SSL_do_handshake() failed");
+}
 
-        if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
-            return NGX_ERROR;
-        }
 
-        if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
-            return NGX_ERROR;
-        }
+static void
+ngx_ssl_handshake_thread_event_handler(ngx_event_t *ev)
+{
+    ngx_connection_t  *c;
 
-        return NGX_AGAIN;
-    }
+    c = ev->data;
 
-    if (sslerr == SSL_ERROR_WANT_WRITE) {
-        c->write->ready = 0;
-        c->read->handler = ngx_ssl_handshake_handler;
-        c->write->handler = ngx_ssl_handshake_handler;
+    ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                   "SSL handshake thread event handler");
 
-        if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
-            return NGX_ERROR;
-        }
+    c->ssl->handshake_busy = 0;
+    c->ssl->handshake_done = 1;
 
-        if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
-            return NGX_ERROR;
-        }
+    if (c->ssl->handshake_closing || c->read->timedout || c->close) {
+        c->ssl->handshake_closing = 0;
+        c->ssl->handler(c);
+        return;
+    }
 
-        return NGX_AGAIN;
+    if (ngx_ssl_handshake(c) == NGX_AGAIN) {
+        return;
     }
 
-    err = (sslerr == SSL_ERROR_SYSCALL) ? ngx_errno : 0;
+    c->ssl->handler(c);
+}
 
-    c->ssl->no_wait_shutdown = 1;
-    c->ssl->no_send_shutdown = 1;
-    c->read->eof = 1;
 
-    if (sslerr == SSL_ERROR_ZERO_RETURN || ERR_peek_error() == 0) {
-        ngx_connection_error(c, err,
-                             "peer closed connection in SSL handshake");
+static void
+ngx_ssl_handshake_busy_handler(ngx_event_t *ev)
+{
+    ngx_connection_t  *c;
 
-        return NGX_ERROR;
-    }
+    c = ev->data;
 
-    c->read->error = 1;
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                   "SSL handshake busy handler: %d", ev->write);
 
-    ngx_ssl_connection_error(c, sslerr, err, "SSL_do_handshake() failed");
+    /* timeouts and closing are handled when the thread task is done */
 
-    return NGX_ERROR;
+    if (!ev->timedout) {
+        c->ssl->handshake_pending = 1;
+    }
+
+    if ((ngx_event_flags & NGX_USE_LEVEL_EVENT) && ev->active) {
+        if (ngx_del_event(ev, ev->write ? NGX_WRITE_EVENT : NGX_READ_EVENT, 0)
+            != NGX_OK)
+        {
+            ngx_log_error(NGX_LOG_ALERT, c->log, 0,
+                          "SSL handshake: failed to delete event");
+        }
+    }
 }
 
+#endif
+
 
 static void
 ngx_ssl_handshake_handler(ngx_event_t *ev)
@@ -1763,6 +2410,13 @@ ngx_ssl_shutdown(ngx_connection_t *c)
     int        n, sslerr, mode;
     ngx_err_t  err;
 
+#if (NGX_THREADS)
+    if (c->ssl->handshake_busy) {
+        c->ssl->handshake_closing = 1;
+        return NGX_AGAIN;
+    }
+#endif
+
     if (c->timedout) {
         mode = SSL_RECEIVED_SHUTDOWN|SSL_SENT_SHUTDOWN;
         SSL_set_quiet_shutdown(c->ssl->connection, 1);
@@ -1783,6 +2437,12 @@ ngx_ssl_shutdown(ngx_connection_t *c)
         }
     }
 
+#if (NGX_SSL_KTLS)
+    if (c->ssl->sendfile && !(mode & SSL_SENT_SHUTDOWN)) {
+        ngx_ssl_ktls_shutdown(c);
+    }
+#endif
+
     SSL_set_shutdown(c->ssl->connection, mode);
 
     ngx_ssl_clear_error(c->log);
@@ -2210,37 +2870,93 @@ failed:
 }
 
 
+ngx_int_t
+ngx_ssl_session_cache_shards(ngx_conf_t *cf, ngx_shm_zone_t *shm_zone,
+    ngx_uint_t shards)
+{
+    ngx_ssl_session_cache_t  *cache;
+
+    cache = shm_zone->data;
+
+    if (cache == NULL) {
+        cache = ngx_pcalloc(cf->pool, sizeof(ngx_ssl_session_cache_t));
+        if (cache == NULL) {
+            return NGX_ERROR;
+        }
+
+        shm_zone->data = cache;
+    }
+
+    if (shards == 0) {
+        return NGX_OK;
+    }
+
+    if (cache->nshards && cache->nshards != shards) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "session cache \"%V\" is already configured "
+                           "with %ui shards",
+                           &shm_zone->shm.name, cache->nshards);
+        return NGX_ERROR;
+    }
+
+    if (shm_zone->shm.size / shards < 8 * ngx_pagesize) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "session cache \"%V\" is too small for %ui shards",
+                           &shm_zone->shm.name, shards);
+        return NGX_ERROR;
+    }
+
+    cache->nshards = shards;
+
+    return NGX_OK;
+}
+
+
 ngx_int_t
 ngx_ssl_session_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 {
-    size_t                    len;
-    ngx_slab_pool_t          *shpool;
+    ngx_ssl_session_cache_t  *ocache = data;
+
+    u_char                   *p, *file;
+    size_t                    len, size;
+    ngx_uint_t                i;
+    ngx_slab_pool_t          *shpool, *sp;
     ngx_ssl_session_cache_t  *cache;
+    ngx_ssl_session_shard_t  *shard;
+
+    cache = shm_zone->data;
+
+    if (cache->nshards == 0) {
+        cache->nshards = 1;
+    }
+
+    if (ocache) {
+        if (cache->nshards != ocache->nshards) {
+            ngx_log_error(NGX_LOG_EMERG, shm_zone->shm.log, 0,
+                          "session cache \"%V\" had previously %ui shards",
+                          &shm_zone->shm.name, ocache->nshards);
+            return NGX_ERROR;
+        }
+
+        cache->shards = ocache->shards;
 
-    if (data) {
-        shm_zone->data = data;
         return NGX_OK;
     }
 
     shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
 
     if (shm_zone->shm.exists) {
-        shm_zone->data = shpool->data;
+        cache->shards = shpool->data;
         return NGX_OK;
     }
 
-    cache = ngx_slab_alloc(shpool, sizeof(ngx_ssl_session_cache_t));
-    if (cache == NULL) {
+    cache->shards = ngx_slab_alloc(shpool,
+                                   cache->nshards * sizeof(ngx_slab_pool_t *));
+    if (cache->shards == NULL) {
         return NGX_ERROR;
     }
 
-    shpool->data = cache;
-    shm_zone->data = cache;
-
-    ngx_rbtree_init(&cache->session_rbtree, &cache->sentinel,
-                    ngx_ssl_session_rbtree_insert_value);
-
-    ngx_queue_init(&cache->expire_queue);
+    shpool->data = cache->shards;
 
     len = sizeof(" in SSL session shared cache \"\"") + shm_zone->shm.name.len;
 
@@ -2254,6 +2970,70 @@ ngx_ssl_session_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 
     shpool->log_nomem = 0;
 
+    /*
+     * the rest of the zone is split between the shards, each of them
+     * is a separate slab pool with its own mutex; up to two pages
+     * are taken by the small allocations above
+     */
+
+    size = (shpool->end - shpool->start) / ngx_pagesize - 2;
+    size = size / cache->nshards * ngx_pagesize;
+
+    for (i = 0; i < cache->nshards; i++) {
+
+        p = ngx_slab_alloc(shpool, size);
+        if (p == NULL) {
+            return NGX_ERROR;
+        }
+
+        sp = (ngx_slab_pool_t *) p;
+
+        sp->end = p + size;
+        sp->min_shift = 3;
+        sp->addr = p;
+
+        ngx_slab_init(sp);
+
+#if (NGX_HAVE_ATOMIC_OPS)
+
+        file = NULL;
+
+#else
+
+        len = ngx_cycle->lock_file.len + shm_zone->shm.name.len
+              + sizeof(".") + NGX_INT_T_LEN;
+
+        file = ngx_slab_alloc_locked(sp, len);
+        if (file == NULL) {
+            return NGX_ERROR;
+        }
+
+        (void) ngx_sprintf(file, "%V%V.%ui%Z", &ngx_cycle->lock_file,
+                           &shm_zone->shm.name, i);
+
+#endif
+
+        if (ngx_shmtx_create(&sp->mutex, &sp->lock, file) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
+        sp->log_ctx = shpool->log_ctx;
+        sp->log_nomem = 0;
+
+        shard = ngx_slab_calloc_locked(sp, sizeof(ngx_ssl_session_shard_t));
+        if (shard == NULL) {
+            return NGX_ERROR;
+        }
+
+        ngx_rbtree_init(&shard->session_rbtree, &shard->sentinel,
+                        ngx_ssl_session_rbtree_insert_value);
+
+        ngx_queue_init(&shard->expire_queue);
+
+        sp->data = shard;
+        cache->shards[i] = sp;
+    }
+
     return NGX_OK;
 }
 
@@ -2288,6 +3068,7 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
     ngx_slab_pool_t          *shpool;
     ngx_ssl_sess_id_t        *sess_id;
     ngx_ssl_session_cache_t  *cache;
+    ngx_ssl_session_shard_t  *shard;
     u_char                    buf[NGX_SSL_MAX_SESSION_SIZE];
 
     len = i2d_SSL_SESSION(sess, NULL);
@@ -2307,12 +3088,27 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
     shm_zone = SSL_CTX_get_ex_data(ssl_ctx, ngx_ssl_session_cache_index);
 
     cache = shm_zone->data;
-    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+#if OPENSSL_VERSION_NUMBER >= 0x0090800fL
+
+    session_id = (u_char *) SSL_SESSION_get_id(sess, &session_id_length);
+
+#else
+
+    session_id = sess->session_id;
+    session_id_length = sess->session_id_length;
+
+#endif
+
+    hash = ngx_crc32_short(session_id, session_id_length);
+
+    shpool = cache->shards[hash % cache->nshards];
+    shard = shpool->data;
 
     ngx_shmtx_lock(&shpool->mutex);
 
     /* drop one or two expired sessions */
-    ngx_ssl_expire_sessions(cache, shpool, 1);
+    ngx_ssl_expire_sessions(shard, shpool, 1);
 
     cached_sess = ngx_slab_alloc_locked(shpool, len);
 
@@ -2320,7 +3116,7 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
 
         /* drop the oldest non-expired session and try once more */
 
-        ngx_ssl_expire_sessions(cache, shpool, 0);
+        ngx_ssl_expire_sessions(shard, shpool, 0);
 
         cached_sess = ngx_slab_alloc_locked(shpool, len);
 
@@ -2336,7 +3132,7 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
 
         /* drop the oldest non-expired session and try once more */
 
-        ngx_ssl_expire_sessions(cache, shpool, 0);
+        ngx_ssl_expire_sessions(shard, shpool, 0);
 
         sess_id = ngx_slab_alloc_locked(shpool, sizeof(ngx_ssl_sess_id_t));
 
@@ -2345,17 +3141,6 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
         }
     }
 
-#if OPENSSL_VERSION_NUMBER >= 0x0090800fL
-
-    session_id = (u_char *) SSL_SESSION_get_id(sess, &session_id_length);
-
-#else
-
-    session_id = sess->session_id;
-    session_id_length = sess->session_id_length;
-
-#endif
-
 #if (NGX_PTR_SIZE == 8)
 
     id = sess_id->sess_id;
@@ -2368,7 +3153,7 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
 
         /* drop the oldest non-expired session and try once more */
 
-        ngx_ssl_expire_sessions(cache, shpool, 0);
+        ngx_ssl_expire_sessions(shard, shpool, 0);
 
         id = ngx_slab_alloc_locked(shpool, session_id_length);
 
@@ -2383,8 +3168,6 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
 
     ngx_memcpy(id, session_id, session_id_length);
 
-    hash = ngx_crc32_short(session_id, session_id_length);
-
     ngx_log_debug3(NGX_LOG_DEBUG_EVENT, c->log, 0,
                    "ssl new session: %08XD:%ud:%d",
                    hash, session_id_length, len);
@@ -2397,9 +3180,11 @@ ngx_ssl_new_session(ngx_ssl_conn_t *ssl_conn, ngx_ssl_session_t *sess)
 
     sess_id->expire = ngx_time() + SSL_CTX_get_timeout(ssl_ctx);
 
-    ngx_queue_insert_head(&cache->expire_queue, &sess_id->queue);
+    ngx_queue_insert_head(&shard->expire_queue, &sess_id->queue);
 
-    ngx_rbtree_insert(&cache->session_rbtree, &sess_id->node);
+    ngx_rbtree_insert(&shard->session_rbtree, &sess_id->node);
+
+    shard->stores++;
 
     ngx_shmtx_unlock(&shpool->mutex);
 
@@ -2440,6 +3225,7 @@ ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn, u_char *id, int len,
     ngx_ssl_session_t        *sess;
     ngx_ssl_sess_id_t        *sess_id;
     ngx_ssl_session_cache_t  *cache;
+    ngx_ssl_session_shard_t  *shard;
     u_char                    buf[NGX_SSL_MAX_SESSION_SIZE];
 #if (NGX_DEBUG)
     ngx_connection_t         *c;
@@ -2462,12 +3248,15 @@ ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn, u_char *id, int len,
 
     sess = NULL;
 
-    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+    shpool = cache->shards[hash % cache->nshards];
+    shard = shpool->data;
 
     ngx_shmtx_lock(&shpool->mutex);
 
-    node = cache->session_rbtree.root;
-    sentinel = cache->session_rbtree.sentinel;
+    shard->lookups++;
+
+    node = shard->session_rbtree.root;
+    sentinel = shard->session_rbtree.sentinel;
 
     while (node != sentinel) {
 
@@ -2490,6 +3279,8 @@ ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn, u_char *id, int len,
         if (rc == 0) {
 
             if (sess_id->expire > ngx_time()) {
+                shard->hits++;
+
                 ngx_memcpy(buf, sess_id->session, sess_id->len);
 
                 ngx_shmtx_unlock(&shpool->mutex);
@@ -2502,7 +3293,7 @@ ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn, u_char *id, int len,
 
             ngx_queue_remove(&sess_id->queue);
 
-            ngx_rbtree_delete(&cache->session_rbtree, node);
+            ngx_rbtree_delete(&shard->session_rbtree, node);
 
             ngx_slab_free_locked(shpool, sess_id->session);
 #if (NGX_PTR_SIZE == 4)
@@ -2510,6 +3301,8 @@ ngx_ssl_get_cached_session(ngx_ssl_conn_t *ssl_conn, u_char *id, int len,
 #endif
             ngx_slab_free_locked(shpool, sess_id);
 
+            shard->expired++;
+
             sess = NULL;
 
             goto done;
@@ -2547,6 +3340,7 @@ ngx_ssl_remove_session(SSL_CTX *ssl, ngx_ssl_session_t *sess)
     ngx_rbtree_node_t        *node, *sentinel;
     ngx_ssl_sess_id_t        *sess_id;
     ngx_ssl_session_cache_t  *cache;
+    ngx_ssl_session_shard_t  *shard;
 
     shm_zone = SSL_CTX_get_ex_data(ssl, ngx_ssl_session_cache_index);
 
@@ -2572,12 +3366,13 @@ ngx_ssl_remove_session(SSL_CTX *ssl, ngx_ssl_session_t *sess)
     ngx_log_debug2(NGX_LOG_DEBUG_EVENT, ngx_cycle->log, 0,
                    "ssl remove session: %08XD:%ud", hash, len);
 
-    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+    shpool = cache->shards[hash % cache->nshards];
+    shard = shpool->data;
 
     ngx_shmtx_lock(&shpool->mutex);
 
-    node = cache->session_rbtree.root;
-    sentinel = cache->session_rbtree.sentinel;
+    node = shard->session_rbtree.root;
+    sentinel = shard->session_rbtree.sentinel;
 
     while (node != sentinel) {
 
@@ -2601,7 +3396,7 @@ ngx_ssl_remove_session(SSL_CTX *ssl, ngx_ssl_session_t *sess)
 
             ngx_queue_remove(&sess_id->queue);
 
-            ngx_rbtree_delete(&cache->session_rbtree, node);
+            ngx_rbtree_delete(&shard->session_rbtree, node);
 
             ngx_slab_free_locked(shpool, sess_id->session);
 #if (NGX_PTR_SIZE == 4)
@@ -2622,7 +3417,7 @@ done:
 
 
 static void
-ngx_ssl_expire_sessions(ngx_ssl_session_cache_t *cache,
+ngx_ssl_expire_sessions(ngx_ssl_session_shard_t *shard,
     ngx_slab_pool_t *shpool, ngx_uint_t n)
 {
     time_t              now;
@@ -2633,11 +3428,11 @@ ngx_ssl_expire_sessions(ngx_ssl_session_cache_t *cache,
 
     while (n < 3) {
 
-        if (ngx_queue_empty(&cache->expire_queue)) {
+        if (ngx_queue_empty(&shard->expire_queue)) {
             return;
         }
 
-        q = ngx_queue_last(&cache->expire_queue);
+        q = ngx_queue_last(&shard->expire_queue);
 
         sess_id = ngx_queue_data(q, ngx_ssl_sess_id_t, queue);
 
@@ -2645,12 +3440,19 @@ ngx_ssl_expire_sessions(ngx_ssl_session_cache_t *cache,
             return;
         }
 
+        if (sess_id->expire > now) {
+            shard->evictions++;
+
+        } else {
+            shard->expired++;
+        }
+
         ngx_queue_remove(q);
 
         ngx_log_debug1(NGX_LOG_DEBUG_EVENT, ngx_cycle->log, 0,
                        "expire session: %08Xi", sess_id->node.key);
 
-        ngx_rbtree_delete(&cache->session_rbtree, &sess_id->node);
+        ngx_rbtree_delete(&shard->session_rbtree, &sess_id->node);
 
         ngx_slab_free_locked(shpool, sess_id->session);
 #if (NGX_PTR_SIZE == 4)
@@ -22,6 +22,7 @@
 #include <openssl/engine.h>
 #endif
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 #ifndef OPENSSL_NO_OCSP
 #include <openssl/ocsp.h>
 #endif
@@ -33,6 +34,14 @@
 #define NGX_SSL_NAME     "OpenSSL"
 
 
+/* the keys are taken from the SSL and SSL_SESSION structures */
+
+#if (NGX_HAVE_KTLS && OPENSSL_VERSION_NUMBER < 0x10100000L                   \
+     && !defined LIBRESSL_VERSION_NUMBER)
+#define NGX_SSL_KTLS  1
+#endif
+
+
 #define ngx_ssl_session_t       SSL_SESSION
 #define ngx_ssl_conn_t          SSL
 
@@ -41,6 +50,10 @@ typedef struct {
     SSL_CTX                    *ctx;
     ngx_log_t                  *log;
     size_t                      buffer_size;
+    ngx_flag_t                  ktls;
+#if (NGX_THREADS)
+    ngx_thread_pool_t          *thread_pool;
+#endif
 } ngx_ssl_t;
 
 
@@ -56,12 +69,23 @@ typedef struct {
     ngx_event_handler_pt        saved_read_handler;
     ngx_event_handler_pt        saved_write_handler;
 
+#if (NGX_THREADS)
+    ngx_thread_pool_t          *thread_pool;
+    ngx_thread_task_t          *handshake_task;
+#endif
+
     unsigned                    handshaked:1;
     unsigned                    renegotiation:1;
     unsigned                    buffer:1;
     unsigned                    no_wait_shutdown:1;
     unsigned                    no_send_shutdown:1;
     unsigned                    handshake_buffer_set:1;
+    unsigned                    ktls:1;
+    unsigned                    sendfile:1;
+    unsigned                    handshake_busy:1;
+    unsigned                    handshake_done:1;
+    unsigned                    handshake_pending:1;
+    unsigned                    handshake_closing:1;
 } ngx_ssl_connection_t;
 
 
@@ -89,10 +113,30 @@ struct ngx_ssl_sess_id_s {
 };
 
 
+#define NGX_SSL_MAX_SCACHE_SHARDS  64
+
+
+/*
+ * each shard is a separate slab pool carved out of the zone,
+ * the shard lives in the pool data and is locked by the pool mutex
+ */
+
 typedef struct {
     ngx_rbtree_t                session_rbtree;
     ngx_rbtree_node_t           sentinel;
     ngx_queue_t                 expire_queue;
+
+    ngx_atomic_uint_t           lookups;
+    ngx_atomic_uint_t           hits;
+    ngx_atomic_uint_t           stores;
+    ngx_atomic_uint_t           expired;
+    ngx_atomic_uint_t           evictions;
+} ngx_ssl_session_shard_t;
+
+
+typedef struct {
+    ngx_uint_t                  nshards;
+    ngx_slab_pool_t           **shards;
 } ngx_ssl_session_cache_t;
 
 
@@ -138,10 +182,17 @@ RSA *ngx_ssl_rsa512_key_callback(ngx_ssl_conn_t *ssl_conn, int is_export,
 ngx_array_t *ngx_ssl_read_password_file(ngx_conf_t *cf, ngx_str_t *file);
 ngx_int_t ngx_ssl_dhparam(ngx_conf_t *cf, ngx_ssl_t *ssl, ngx_str_t *file);
 ngx_int_t ngx_ssl_ecdh_curve(ngx_conf_t *cf, ngx_ssl_t *ssl, ngx_str_t *name);
+ngx_int_t ngx_ssl_ktls(ngx_conf_t *cf, ngx_ssl_t *ssl);
+#if (NGX_THREADS)
+ngx_int_t ngx_ssl_handshake_threads(ngx_conf_t *cf, ngx_ssl_t *ssl,
+    ngx_thread_pool_t *tp);
+#endif
 ngx_int_t ngx_ssl_session_cache(ngx_ssl_t *ssl, ngx_str_t *sess_ctx,
     ssize_t builtin_session_cache, ngx_shm_zone_t *shm_zone, time_t timeout);
 ngx_int_t ngx_ssl_session_ticket_keys(ngx_conf_t *cf, ngx_ssl_t *ssl,
     ngx_array_t *paths);
+ngx_int_t ngx_ssl_session_cache_shards(ngx_conf_t *cf,
+    ngx_shm_zone_t *shm_zone, ngx_uint_t shards);
 ngx_int_t ngx_ssl_session_cache_init(ngx_shm_zone_t *shm_zone, void *data);
 ngx_int_t ngx_ssl_create_connection(ngx_ssl_t *ssl, ngx_connection_t *c,
     ngx_uint_t flags);
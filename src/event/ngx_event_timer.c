@@ -13,6 +13,54 @@
 ngx_rbtree_t              ngx_event_timer_rbtree;
 static ngx_rbtree_node_t  ngx_event_timer_sentinel;
 
+ngx_uint_t                ngx_use_timer_wheel;
+
+
+/*
+ * the hierarchical timing wheel: the first level has 256 slots of
+ * 1 millisecond, each of the four upper levels has 64 slots covering
+ * the whole span of the level below; timers are moved one level down
+ * (cascaded) when the first level wraps around
+ *
+ * a timer node is linked into a slot list using its left and right
+ * pointers as prev and next, the slot heads are list sentinels
+ */
+
+#define NGX_TIMER_WHEEL_BITS        8
+#define NGX_TIMER_WHEEL_SIZE        (1 << NGX_TIMER_WHEEL_BITS)
+#define NGX_TIMER_WHEEL_MASK        (NGX_TIMER_WHEEL_SIZE - 1)
+#define NGX_TIMER_WHEEL_LEVEL_BITS  6
+#define NGX_TIMER_WHEEL_LEVEL_SIZE  (1 << NGX_TIMER_WHEEL_LEVEL_BITS)
+#define NGX_TIMER_WHEEL_LEVEL_MASK  (NGX_TIMER_WHEEL_LEVEL_SIZE - 1)
+#define NGX_TIMER_WHEEL_LEVELS      4
+#define NGX_TIMER_WHEEL_SLOTS                                                 \
+    (NGX_TIMER_WHEEL_SIZE + NGX_TIMER_WHEEL_LEVELS * NGX_TIMER_WHEEL_LEVEL_SIZE)
+
+#define ngx_event_timer_wheel_shift(level)                                    \
+    (NGX_TIMER_WHEEL_BITS + ((level) - 1) * NGX_TIMER_WHEEL_LEVEL_BITS)
+
+#define ngx_event_timer_wheel_level(level)                                    \
+    (&ngx_event_timer_wheel->slots[NGX_TIMER_WHEEL_SIZE                       \
+                                 + ((level) - 1) * NGX_TIMER_WHEEL_LEVEL_SIZE])
+
+
+typedef struct {
+    ngx_msec_t                clock;    /* the next unprocessed millisecond */
+    ngx_uint_t                count;
+    ngx_rbtree_node_t         slots[NGX_TIMER_WHEEL_SLOTS];
+} ngx_event_timer_wheel_t;
+
+
+static void ngx_event_timer_wheel_link(ngx_rbtree_node_t *node);
+static void ngx_event_timer_wheel_cascade(ngx_uint_t level);
+static ngx_msec_t ngx_event_timer_wheel_find(void);
+static void ngx_event_timer_wheel_expire(void);
+static void ngx_event_timer_wheel_cancel(void);
+
+
+static ngx_event_timer_wheel_t  *ngx_event_timer_wheel;
+
+
 /*
  * the event timer rbtree may contain the duplicate keys, however,
  * it should not be a problem, because we use the rbtree to find
@@ -22,9 +70,31 @@ static ngx_rbtree_node_t  ngx_event_timer_sentinel;
 ngx_int_t
 ngx_event_timer_init(ngx_log_t *log)
 {
+    ngx_uint_t          i;
+    ngx_rbtree_node_t  *slot;
+
     ngx_rbtree_init(&ngx_event_timer_rbtree, &ngx_event_timer_sentinel,
                     ngx_rbtree_insert_timer_value);
 
+    if (!ngx_use_timer_wheel) {
+        return NGX_OK;
+    }
+
+    ngx_event_timer_wheel = ngx_alloc(sizeof(ngx_event_timer_wheel_t), log);
+    if (ngx_event_timer_wheel == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_event_timer_wheel->clock = ngx_current_msec;
+    ngx_event_timer_wheel->count = 0;
+
+    slot = ngx_event_timer_wheel->slots;
+
+    for (i = 0; i < NGX_TIMER_WHEEL_SLOTS; i++) {
+        slot[i].left = &slot[i];
+        slot[i].right = &slot[i];
+    }
+
     return NGX_OK;
 }
 
@@ -35,6 +105,10 @@ ngx_event_find_timer(void)
     ngx_msec_int_t      timer;
     ngx_rbtree_node_t  *node, *root, *sentinel;
 
+    if (ngx_use_timer_wheel) {
+        return ngx_event_timer_wheel_find();
+    }
+
     if (ngx_event_timer_rbtree.root == &ngx_event_timer_sentinel) {
         return NGX_TIMER_INFINITE;
     }
@@ -58,6 +132,11 @@ ngx_event_expire_timers(void)
     ngx_event_t        *ev;
     ngx_rbtree_node_t  *node, *root, *sentinel;
 
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_expire();
+        return;
+    }
+
     sentinel = ngx_event_timer_rbtree.sentinel;
 
     for ( ;; ) {
@@ -107,6 +186,11 @@ ngx_event_cancel_timers(void)
     ngx_event_t        *ev;
     ngx_rbtree_node_t  *node, *root, *sentinel;
 
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_cancel();
+        return;
+    }
+
     sentinel = ngx_event_timer_rbtree.sentinel;
 
     for ( ;; ) {
@@ -141,3 +225,330 @@ ngx_event_cancel_timers(void)
         ev->handler(ev);
     }
 }
+
+
+ngx_int_t
+ngx_event_no_timers_left(void)
+{
+    if (ngx_use_timer_wheel) {
+        return ngx_event_timer_wheel->count ? NGX_AGAIN : NGX_OK;
+    }
+
+    if (ngx_event_timer_rbtree.root == ngx_event_timer_rbtree.sentinel) {
+        return NGX_OK;
+    }
+
+    return NGX_AGAIN;
+}
+
+
+void
+ngx_event_timer_wheel_add(ngx_event_t *ev)
+{
+    ngx_event_timer_wheel_link(&ev->timer);
+
+    ngx_event_timer_wheel->count++;
+}
+
+
+void
+ngx_event_timer_wheel_del(ngx_event_t *ev)
+{
+    ev->timer.left->right = ev->timer.right;
+    ev->timer.right->left = ev->timer.left;
+
+    ngx_event_timer_wheel->count--;
+}
+
+
+static void
+ngx_event_timer_wheel_link(ngx_rbtree_node_t *node)
+{
+    ngx_msec_t          key, delta;
+    ngx_uint_t          level, shift;
+    ngx_rbtree_node_t  *slot;
+
+    key = node->key;
+    delta = key - ngx_event_timer_wheel->clock;
+
+    if ((ngx_msec_int_t) delta < 0) {
+
+        /* an already expired timer runs on the next tick */
+
+        slot = &ngx_event_timer_wheel->slots[ngx_event_timer_wheel->clock
+                                             & NGX_TIMER_WHEEL_MASK];
+
+    } else if (delta < NGX_TIMER_WHEEL_SIZE) {
+        slot = &ngx_event_timer_wheel->slots[key & NGX_TIMER_WHEEL_MASK];
+
+    } else {
+        for (level = 1; level < NGX_TIMER_WHEEL_LEVELS; level++) {
+            shift = ngx_event_timer_wheel_shift(level);
+
+            if ((delta >> (shift + NGX_TIMER_WHEEL_LEVEL_BITS)) == 0) {
+                break;
+            }
+        }
+
+        shift = ngx_event_timer_wheel_shift(level);
+
+        if ((delta >> shift) > NGX_TIMER_WHEEL_LEVEL_MASK) {
+
+            /* too far in the future: park it, it is relinked on cascade */
+
+            key = ngx_event_timer_wheel->clock
+                  + ((ngx_msec_t) NGX_TIMER_WHEEL_LEVEL_MASK << shift);
+        }
+
+        slot = ngx_event_timer_wheel_level(level)
+               + ((key >> shift) & NGX_TIMER_WHEEL_LEVEL_MASK);
+    }
+
+    node->left = slot->left;
+    node->right = slot;
+    slot->left->right = node;
+    slot->left = node;
+}
+
+
+static void
+ngx_event_timer_wheel_cascade(ngx_uint_t level)
+{
+    ngx_uint_t          index;
+    ngx_rbtree_node_t  *slot, *node, list;
+
+    index = (ngx_event_timer_wheel->clock >> ngx_event_timer_wheel_shift(level))
+            & NGX_TIMER_WHEEL_LEVEL_MASK;
+
+    slot = ngx_event_timer_wheel_level(level) + index;
+
+    if (slot->right == slot) {
+        goto next;
+    }
+
+    /* detach the slot: parked timers may be linked into it again */
+
+    list.right = slot->right;
+    list.left = slot->left;
+    list.right->left = &list;
+    list.left->right = &list;
+
+    slot->left = slot;
+    slot->right = slot;
+
+    while (list.right != &list) {
+        node = list.right;
+
+        list.right = node->right;
+        node->right->left = &list;
+
+        ngx_event_timer_wheel_link(node);
+    }
+
+next:
+
+    if (index == 0 && level < NGX_TIMER_WHEEL_LEVELS) {
+        ngx_event_timer_wheel_cascade(level + 1);
+    }
+}
+
+
+static ngx_msec_t
+ngx_event_timer_wheel_find(void)
+{
+    ngx_msec_t          clock, next, t, base;
+    ngx_uint_t          i, index, level, shift;
+    ngx_msec_int_t      timer;
+    ngx_rbtree_node_t  *slot;
+
+    if (ngx_event_timer_wheel->count == 0) {
+        return NGX_TIMER_INFINITE;
+    }
+
+    clock = ngx_event_timer_wheel->clock;
+    index = clock & NGX_TIMER_WHEEL_MASK;
+    slot = ngx_event_timer_wheel->slots;
+
+    next = NGX_TIMER_INFINITE;
+
+    for (i = 0; i < NGX_TIMER_WHEEL_SIZE; i++) {
+        if (slot[(index + i) & NGX_TIMER_WHEEL_MASK].right
+            != &slot[(index + i) & NGX_TIMER_WHEEL_MASK])
+        {
+            next = clock + i;
+            break;
+        }
+    }
+
+    /*
+     * the first level slots hold exact expiration times, and nothing
+     * is cascaded from the upper levels until the first level wraps around
+     */
+
+    if (index && index + i < NGX_TIMER_WHEEL_SIZE) {
+        goto found;
+    }
+
+    /* an upper level slot needs a wakeup at its cascade time */
+
+    for (level = 1; level <= NGX_TIMER_WHEEL_LEVELS; level++) {
+        shift = ngx_event_timer_wheel_shift(level);
+        slot = ngx_event_timer_wheel_level(level);
+        base = clock >> shift;
+
+        i = (clock & (((ngx_msec_t) 1 << shift) - 1)) ? 1 : 0;
+
+        for ( /* void */ ; i <= NGX_TIMER_WHEEL_LEVEL_SIZE; i++) {
+            index = (base + i) & NGX_TIMER_WHEEL_LEVEL_MASK;
+
+            if (slot[index].right != &slot[index]) {
+                t = (base + i) << shift;
+
+                if (next == NGX_TIMER_INFINITE
+                    || (ngx_msec_int_t) (t - next) < 0)
+                {
+                    next = t;
+                }
+
+                break;
+            }
+        }
+    }
+
+found:
+
+    timer = (ngx_msec_int_t) (next - ngx_current_msec);
+
+    return (ngx_msec_t) (timer > 0 ? timer : 0);
+}
+
+
+static void
+ngx_event_timer_wheel_expire(void)
+{
+    ngx_uint_t          index;
+    ngx_event_t        *ev;
+    ngx_rbtree_node_t  *slot, *node, list;
+
+    if (ngx_event_timer_wheel->count == 0) {
+        ngx_event_timer_wheel->clock = ngx_current_msec + 1;
+        return;
+    }
+
+    while ((ngx_msec_int_t) (ngx_current_msec - ngx_event_timer_wheel->clock)
+           >= 0)
+    {
+        index = ngx_event_timer_wheel->clock & NGX_TIMER_WHEEL_MASK;
+
+        if (index == 0) {
+            ngx_event_timer_wheel_cascade(1);
+        }
+
+        /*
+         * the clock is advanced before calling handlers, so expired
+         * timers added by them are run on the next tick
+         */
+
+        ngx_event_timer_wheel->clock++;
+
+        slot = &ngx_event_timer_wheel->slots[index];
+
+        if (slot->right == slot) {
+            continue;
+        }
+
+        list.right = slot->right;
+        list.left = slot->left;
+        list.right->left = &list;
+        list.left->right = &list;
+
+        slot->left = slot;
+        slot->right = slot;
+
+        while (list.right != &list) {
+            node = list.right;
+
+            ev = (ngx_event_t *) ((char *) node - offsetof(ngx_event_t, timer));
+
+            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                           "event timer del: %d: %M",
+                           ngx_event_ident(ev->data), ev->timer.key);
+
+            ngx_event_timer_wheel_del(ev);
+
+#if (NGX_DEBUG)
+            ev->timer.left = NULL;
+            ev->timer.right = NULL;
+            ev->timer.parent = NULL;
+#endif
+
+            ev->timer_set = 0;
+
+            ev->timedout = 1;
+
+            ev->handler(ev);
+        }
+    }
+}
+
+
+static void
+ngx_event_timer_wheel_cancel(void)
+{
+    ngx_uint_t          i;
+    ngx_event_t        *ev;
+    ngx_rbtree_node_t  *slot, *node, list;
+
+    for (i = 0; i < NGX_TIMER_WHEEL_SLOTS; i++) {
+        slot = &ngx_event_timer_wheel->slots[i];
+
+        if (slot->right == slot) {
+            continue;
+        }
+
+        list.right = slot->right;
+        list.left = slot->left;
+        list.right->left = &list;
+        list.left->right = &list;
+
+        slot->left = slot;
+        slot->right = slot;
+
+        while (list.right != &list) {
+            node = list.right;
+
+            ev = (ngx_event_t *) ((char *) node - offsetof(ngx_event_t, timer));
+
+            if (!ev->cancelable) {
+
+                /* move it back to the slot */
+
+                list.right = node->right;
+                node->right->left = &list;
+
+                node->left = slot->left;
+                node->right = slot;
+                slot->left->right = node;
+                slot->left = node;
+
+                continue;
+            }
+
+            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                           "event timer cancel: %d: %M",
+                           ngx_event_ident(ev->data), ev->timer.key);
+
+            ngx_event_timer_wheel_del(ev);
+
+#if (NGX_DEBUG)
+            ev->timer.left = NULL;
+            ev->timer.right = NULL;
+            ev->timer.parent = NULL;
+#endif
+
+            ev->timer_set = 0;
+
+            ev->handler(ev);
+        }
+    }
+}
@@ -24,9 +24,14 @@ ngx_int_t ngx_event_timer_init(ngx_log_t *log);
 ngx_msec_t ngx_event_find_timer(void);
 void ngx_event_expire_timers(void);
 void ngx_event_cancel_timers(void);
+ngx_int_t ngx_event_no_timers_left(void);
+
+void ngx_event_timer_wheel_add(ngx_event_t *ev);
+void ngx_event_timer_wheel_del(ngx_event_t *ev);
 
 
 extern ngx_rbtree_t  ngx_event_timer_rbtree;
+extern ngx_uint_t    ngx_use_timer_wheel;
 
 /* Ӻɾʱ */
 static ngx_inline void
@@ -36,7 +41,12 @@ ngx_event_del_timer(ngx_event_t *ev)
                    "event timer del: %d: %M",
                     ngx_event_ident(ev->data), ev->timer.key);
 
-    ngx_rbtree_delete(&ngx_event_timer_rbtree, &ev->timer);
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_del(ev);
+
+    } else {
+        ngx_rbtree_delete(&ngx_event_timer_rbtree, &ev->timer);
+    }
 
 #if (NGX_DEBUG)
     ev->timer.left = NULL;
@@ -85,7 +95,12 @@ ngx_event_add_timer(ngx_event_t *ev, ngx_msec_t timer)
                    "event timer add: %d: %M:%M",
                     ngx_event_ident(ev->data), timer, ev->timer.key);
 	/* ¶ʱ */
-    ngx_rbtree_insert(&ngx_event_timer_rbtree, &ev->timer);
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_add(ev);
+
+    } else {
+        ngx_rbtree_insert(&ngx_event_timer_rbtree, &ev->timer);
+    }
 
 	/* 1ʾѾöʱ */
     ev->timer_set = 1;
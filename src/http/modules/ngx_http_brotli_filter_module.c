@@ -0,0 +1,1017 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+#include <brotli/encode.h>
+
+
+typedef struct {
+    ngx_flag_t           enable;
+
+    ngx_hash_t           types;
+
+    ngx_bufs_t           bufs;
+
+    size_t               postpone;
+    ngx_int_t            level;
+    size_t               lgwin;
+    ssize_t              min_length;
+
+    ngx_array_t         *types_keys;
+} ngx_http_brotli_conf_t;
+
+
+typedef struct {
+    ngx_chain_t         *in;
+    ngx_chain_t         *free;
+    ngx_chain_t         *busy;
+    ngx_chain_t         *out;
+    ngx_chain_t        **last_out;
+
+    ngx_chain_t         *copied;
+    ngx_chain_t         *copy_buf;
+
+    ngx_buf_t           *in_buf;
+    ngx_buf_t           *out_buf;
+    ngx_int_t            bufs;
+
+    BrotliEncoderState  *encoder;
+    BrotliEncoderOperation  op;
+
+    int                  lgwin;
+
+    const uint8_t       *next_in;
+    size_t               avail_in;
+    uint8_t             *next_out;
+    size_t               avail_out;
+
+    unsigned             redo:1;
+    unsigned             done:1;
+    unsigned             nomem:1;
+    unsigned             buffering:1;
+
+    size_t               zin;
+    size_t               zout;
+
+    ngx_http_request_t  *request;
+} ngx_http_brotli_ctx_t;
+
+
+static void ngx_http_brotli_filter_window(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+static ngx_int_t ngx_http_brotli_filter_buffer(ngx_http_brotli_ctx_t *ctx,
+    ngx_chain_t *in);
+static ngx_int_t ngx_http_brotli_filter_encode_start(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+static ngx_int_t ngx_http_brotli_filter_add_data(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+static ngx_int_t ngx_http_brotli_filter_get_buf(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+static ngx_int_t ngx_http_brotli_filter_encode(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+static ngx_int_t ngx_http_brotli_filter_encode_end(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+
+static void *ngx_http_brotli_filter_alloc(void *opaque, size_t size);
+static void ngx_http_brotli_filter_free(void *opaque, void *address);
+static void ngx_http_brotli_filter_free_copy_buf(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx);
+
+static ngx_int_t ngx_http_brotli_add_variables(ngx_conf_t *cf);
+static ngx_int_t ngx_http_brotli_ratio_variable(ngx_http_request_t *r,
+    ngx_http_variable_value_t *v, uintptr_t data);
+
+static ngx_int_t ngx_http_brotli_filter_init(ngx_conf_t *cf);
+static void *ngx_http_brotli_create_conf(ngx_conf_t *cf);
+static char *ngx_http_brotli_merge_conf(ngx_conf_t *cf,
+    void *parent, void *child);
+static char *ngx_http_brotli_window(ngx_conf_t *cf, void *post, void *data);
+
+
+static ngx_conf_num_bounds_t  ngx_http_brotli_comp_level_bounds = {
+    ngx_conf_check_num_bounds, BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY
+};
+
+static ngx_conf_post_handler_pt  ngx_http_brotli_window_p =
+    ngx_http_brotli_window;
+
+
+static ngx_command_t  ngx_http_brotli_filter_commands[] = {
+
+    { ngx_string("brotli"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_HTTP_LIF_CONF
+                        |NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, enable),
+      NULL },
+
+    { ngx_string("brotli_buffers"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_TAKE2,
+      ngx_conf_set_bufs_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, bufs),
+      NULL },
+
+    { ngx_string("brotli_types"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_1MORE,
+      ngx_http_types_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, types_keys),
+      &ngx_http_html_default_types[0] },
+
+    { ngx_string("brotli_comp_level"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, level),
+      &ngx_http_brotli_comp_level_bounds },
+
+    { ngx_string("brotli_window"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_size_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, lgwin),
+      &ngx_http_brotli_window_p },
+
+    { ngx_string("brotli_postpone"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_size_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, postpone),
+      NULL },
+
+    { ngx_string("brotli_min_length"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_size_slot,
+      NGX_HTTP_LOC_CONF_OFFSET,
+      offsetof(ngx_http_brotli_conf_t, min_length),
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_brotli_filter_module_ctx = {
+    ngx_http_brotli_add_variables,         /* preconfiguration */
+    ngx_http_brotli_filter_init,           /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    NULL,                                  /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    ngx_http_brotli_create_conf,           /* create location configuration */
+    ngx_http_brotli_merge_conf             /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_brotli_filter_module = {
+    NGX_MODULE_V1,
+    &ngx_http_brotli_filter_module_ctx,    /* module context */
+    ngx_http_brotli_filter_commands,       /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_str_t  ngx_http_brotli_ratio = ngx_string("brotli_ratio");
+
+static ngx_http_output_header_filter_pt  ngx_http_next_header_filter;
+static ngx_http_output_body_filter_pt    ngx_http_next_body_filter;
+
+
+static ngx_int_t
+ngx_http_brotli_header_filter(ngx_http_request_t *r)
+{
+    ngx_table_elt_t         *h;
+    ngx_http_brotli_ctx_t   *ctx;
+    ngx_http_brotli_conf_t  *conf;
+
+    conf = ngx_http_get_module_loc_conf(r, ngx_http_brotli_filter_module);
+
+    if (!conf->enable
+        || (r->headers_out.status != NGX_HTTP_OK
+            && r->headers_out.status != NGX_HTTP_FORBIDDEN
+            && r->headers_out.status != NGX_HTTP_NOT_FOUND)
+        || (r->headers_out.content_encoding
+            && r->headers_out.content_encoding->value.len)
+        || (r->headers_out.content_length_n != -1
+            && r->headers_out.content_length_n < conf->min_length)
+        || ngx_http_test_content_type(r, &conf->types) == NULL
+        || r->header_only)
+    {
+        return ngx_http_next_header_filter(r);
+    }
+
+    r->gzip_vary = 1;
+
+#if (NGX_HTTP_DEGRADATION)
+    {
+    ngx_http_core_loc_conf_t  *clcf;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    if (clcf->gzip_disable_degradation && ngx_http_degraded(r)) {
+        return ngx_http_next_header_filter(r);
+    }
+    }
+#endif
+
+    if (!r->brotli_tested) {
+        if (ngx_http_brotli_ok(r) != NGX_OK) {
+            return ngx_http_next_header_filter(r);
+        }
+
+    } else if (!r->brotli_ok) {
+        return ngx_http_next_header_filter(r);
+    }
+
+    ctx = ngx_pcalloc(r->pool, sizeof(ngx_http_brotli_ctx_t));
+    if (ctx == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_http_set_ctx(r, ctx, ngx_http_brotli_filter_module);
+
+    ctx->request = r;
+    ctx->buffering = (conf->postpone != 0);
+
+    ngx_http_brotli_filter_window(r, ctx);
+
+    h = ngx_list_push(&r->headers_out.headers);
+    if (h == NULL) {
+        return NGX_ERROR;
+    }
+
+    h->hash = 1;
+    ngx_str_set(&h->key, "Content-Encoding");
+    ngx_str_set(&h->value, "br");
+    r->headers_out.content_encoding = h;
+
+    r->main_filter_need_in_memory = 1;
+
+    ngx_http_clear_content_length(r);
+    ngx_http_clear_accept_ranges(r);
+    ngx_http_weak_etag(r);
+
+    return ngx_http_next_header_filter(r);
+}
+
+
+static ngx_int_t
+ngx_http_brotli_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
+{
+    ngx_int_t               rc;
+    ngx_uint_t              flush;
+    ngx_chain_t            *cl;
+    ngx_http_brotli_ctx_t  *ctx;
+
+    ctx = ngx_http_get_module_ctx(r, ngx_http_brotli_filter_module);
+
+    if (ctx == NULL || ctx->done || r->header_only) {
+        return ngx_http_next_body_filter(r, in);
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http brotli filter");
+
+    if (ctx->buffering) {
+
+        /*
+         * the encoder state takes from several hundred kilobytes
+         * to megabytes depending on the quality and the window,
+         * so it is allocated only after enough data is collected
+         */
+
+        if (in) {
+            switch (ngx_http_brotli_filter_buffer(ctx, in)) {
+
+            case NGX_OK:
+                return NGX_OK;
+
+            case NGX_DONE:
+                in = NULL;
+                break;
+
+            default:  /* NGX_ERROR */
+                goto failed;
+            }
+
+        } else {
+            ctx->buffering = 0;
+        }
+    }
+
+    if (ctx->encoder == NULL) {
+        if (ngx_http_brotli_filter_encode_start(r, ctx) != NGX_OK) {
+            goto failed;
+        }
+    }
+
+    if (in) {
+        if (ngx_chain_add_copy(r->pool, &ctx->in, in) != NGX_OK) {
+            goto failed;
+        }
+
+        r->connection->buffered |= NGX_HTTP_BROTLI_BUFFERED;
+    }
+
+    if (ctx->nomem) {
+
+        /* flush busy buffers */
+
+        if (ngx_http_next_body_filter(r, NULL) == NGX_ERROR) {
+            goto failed;
+        }
+
+        cl = NULL;
+
+        ngx_chain_update_chains(r->pool, &ctx->free, &ctx->busy, &cl,
+                                (ngx_buf_tag_t) &ngx_http_brotli_filter_module);
+        ctx->nomem = 0;
+        flush = 0;
+
+    } else {
+        flush = ctx->busy ? 1 : 0;
+    }
+
+    for ( ;; ) {
+
+        /* cycle while we can write to a client */
+
+        for ( ;; ) {
+
+            /* cycle while there is data to feed the encoder and ... */
+
+            rc = ngx_http_brotli_filter_add_data(r, ctx);
+
+            if (rc == NGX_DECLINED) {
+                break;
+            }
+
+            if (rc == NGX_AGAIN) {
+                continue;
+            }
+
+
+            /* ... there are buffers to write the encoder output */
+
+            rc = ngx_http_brotli_filter_get_buf(r, ctx);
+
+            if (rc == NGX_DECLINED) {
+                break;
+            }
+
+            if (rc == NGX_ERROR) {
+                goto failed;
+            }
+
+
+            rc = ngx_http_brotli_filter_encode(r, ctx);
+
+            if (rc == NGX_OK) {
+                break;
+            }
+
+            if (rc == NGX_ERROR) {
+                goto failed;
+            }
+
+            /* rc == NGX_AGAIN */
+        }
+
+        if (ctx->out == NULL && !flush) {
+            ngx_http_brotli_filter_free_copy_buf(r, ctx);
+
+            return ctx->busy ? NGX_AGAIN : NGX_OK;
+        }
+
+        rc = ngx_http_next_body_filter(r, ctx->out);
+
+        if (rc == NGX_ERROR) {
+            goto failed;
+        }
+
+        ngx_http_brotli_filter_free_copy_buf(r, ctx);
+
+        ngx_chain_update_chains(r->pool, &ctx->free, &ctx->busy, &ctx->out,
+                                (ngx_buf_tag_t) &ngx_http_brotli_filter_module);
+        ctx->last_out = &ctx->out;
+
+        ctx->nomem = 0;
+        flush = 0;
+
+        if (ctx->done) {
+            return rc;
+        }
+    }
+
+    /* unreachable */
+
+failed:
+
+    ctx->done = 1;
+
+    if (ctx->encoder) {
+        BrotliEncoderDestroyInstance(ctx->encoder);
+        ctx->encoder = NULL;
+    }
+
+    ngx_http_brotli_filter_free_copy_buf(r, ctx);
+
+    return NGX_ERROR;
+}
+
+
+static void
+ngx_http_brotli_filter_window(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    int                      lgwin;
+    ngx_http_brotli_conf_t  *conf;
+
+    conf = ngx_http_get_module_loc_conf(r, ngx_http_brotli_filter_module);
+
+    lgwin = conf->lgwin;
+
+    if (r->headers_out.content_length_n > 0) {
+
+        /* there is no need for a window larger than the response */
+
+        while (lgwin > BROTLI_MIN_WINDOW_BITS
+               && r->headers_out.content_length_n < (1 << (lgwin - 1)))
+        {
+            lgwin--;
+        }
+    }
+
+    ctx->lgwin = lgwin;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_buffer(ngx_http_brotli_ctx_t *ctx, ngx_chain_t *in)
+{
+    size_t                   size, buffered;
+    ngx_buf_t               *b, *buf;
+    ngx_chain_t             *cl, **ll;
+    ngx_http_request_t      *r;
+    ngx_http_brotli_conf_t  *conf;
+
+    r = ctx->request;
+
+    r->connection->buffered |= NGX_HTTP_BROTLI_BUFFERED;
+
+    buffered = 0;
+    ll = &ctx->in;
+
+    for (cl = ctx->in; cl; cl = cl->next) {
+        buffered += cl->buf->last - cl->buf->pos;
+        ll = &cl->next;
+    }
+
+    conf = ngx_http_get_module_loc_conf(r, ngx_http_brotli_filter_module);
+
+    while (in) {
+        cl = ngx_alloc_chain_link(r->pool);
+        if (cl == NULL) {
+            return NGX_ERROR;
+        }
+
+        b = in->buf;
+
+        size = b->last - b->pos;
+        buffered += size;
+
+        if (b->flush || b->last_buf || buffered > conf->postpone) {
+            ctx->buffering = 0;
+        }
+
+        if (ctx->buffering && size) {
+
+            buf = ngx_create_temp_buf(r->pool, size);
+            if (buf == NULL) {
+                return NGX_ERROR;
+            }
+
+            buf->last = ngx_cpymem(buf->pos, b->pos, size);
+            b->pos = b->last;
+
+            buf->last_buf = b->last_buf;
+            buf->tag = (ngx_buf_tag_t) &ngx_http_brotli_filter_module;
+
+            cl->buf = buf;
+
+        } else {
+            cl->buf = b;
+        }
+
+        *ll = cl;
+        ll = &cl->next;
+        in = in->next;
+    }
+
+    *ll = NULL;
+
+    return ctx->buffering ? NGX_OK : NGX_DONE;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_encode_start(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    ngx_http_brotli_conf_t  *conf;
+
+    conf = ngx_http_get_module_loc_conf(r, ngx_http_brotli_filter_module);
+
+    ctx->encoder = BrotliEncoderCreateInstance(ngx_http_brotli_filter_alloc,
+                                               ngx_http_brotli_filter_free,
+                                               ctx);
+    if (ctx->encoder == NULL) {
+        ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
+                      "BrotliEncoderCreateInstance() failed");
+        return NGX_ERROR;
+    }
+
+    if (!BrotliEncoderSetParameter(ctx->encoder, BROTLI_PARAM_QUALITY,
+                                   (uint32_t) conf->level)
+        || !BrotliEncoderSetParameter(ctx->encoder, BROTLI_PARAM_LGWIN,
+                                      (uint32_t) ctx->lgwin))
+    {
+        ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
+                      "BrotliEncoderSetParameter() failed");
+        return NGX_ERROR;
+    }
+
+    if (r->headers_out.content_length_n > 0
+        && r->headers_out.content_length_n < 1 << 30)
+    {
+        (void) BrotliEncoderSetParameter(ctx->encoder, BROTLI_PARAM_SIZE_HINT,
+                                 (uint32_t) r->headers_out.content_length_n);
+    }
+
+    ctx->last_out = &ctx->out;
+    ctx->op = BROTLI_OPERATION_PROCESS;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_add_data(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    if (ctx->avail_in || ctx->op != BROTLI_OPERATION_PROCESS || ctx->redo) {
+        return NGX_OK;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "brotli in: %p", ctx->in);
+
+    if (ctx->in == NULL) {
+        return NGX_DECLINED;
+    }
+
+    if (ctx->copy_buf) {
+
+        /*
+         * to avoid CPU cache trashing we do not free() just quit buf,
+         * but postpone free()ing after compressing and data output
+         */
+
+        ctx->copy_buf->next = ctx->copied;
+        ctx->copied = ctx->copy_buf;
+        ctx->copy_buf = NULL;
+    }
+
+    ctx->in_buf = ctx->in->buf;
+
+    if (ctx->in_buf->tag == (ngx_buf_tag_t) &ngx_http_brotli_filter_module) {
+        ctx->copy_buf = ctx->in;
+    }
+
+    ctx->in = ctx->in->next;
+
+    ctx->next_in = ctx->in_buf->pos;
+    ctx->avail_in = ctx->in_buf->last - ctx->in_buf->pos;
+
+    ctx->zin += ctx->avail_in;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "brotli in_buf:%p ni:%p ai:%uz",
+                   ctx->in_buf, ctx->next_in, ctx->avail_in);
+
+    if (ctx->in_buf->last_buf) {
+        ctx->op = BROTLI_OPERATION_FINISH;
+
+    } else if (ctx->in_buf->flush) {
+        ctx->op = BROTLI_OPERATION_FLUSH;
+    }
+
+    if (ctx->avail_in == 0 && ctx->op == BROTLI_OPERATION_PROCESS) {
+        return NGX_AGAIN;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_get_buf(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    ngx_http_brotli_conf_t  *conf;
+
+    if (ctx->avail_out) {
+        return NGX_OK;
+    }
+
+    conf = ngx_http_get_module_loc_conf(r, ngx_http_brotli_filter_module);
+
+    if (ctx->free) {
+        ctx->out_buf = ctx->free->buf;
+        ctx->free = ctx->free->next;
+
+    } else if (ctx->bufs < conf->bufs.num) {
+
+        ctx->out_buf = ngx_create_temp_buf(r->pool, conf->bufs.size);
+        if (ctx->out_buf == NULL) {
+            return NGX_ERROR;
+        }
+
+        ctx->out_buf->tag = (ngx_buf_tag_t) &ngx_http_brotli_filter_module;
+        ctx->out_buf->recycled = 1;
+        ctx->bufs++;
+
+    } else {
+        ctx->nomem = 1;
+        return NGX_DECLINED;
+    }
+
+    ctx->next_out = ctx->out_buf->pos;
+    ctx->avail_out = conf->bufs.size;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_encode(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    ngx_buf_t    *b;
+    ngx_chain_t  *cl;
+
+    ngx_log_debug6(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                 "brotli encode in: ni:%p no:%p ai:%uz ao:%uz op:%d redo:%d",
+                 ctx->next_in, ctx->next_out, ctx->avail_in, ctx->avail_out,
+                 ctx->op, ctx->redo);
+
+    if (!BrotliEncoderCompressStream(ctx->encoder, ctx->op,
+                                     &ctx->avail_in, &ctx->next_in,
+                                     &ctx->avail_out, &ctx->next_out,
+                                     &ctx->zout))
+    {
+        ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
+                      "BrotliEncoderCompressStream() failed: %d", ctx->op);
+        return NGX_ERROR;
+    }
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "brotli encode out: ni:%p no:%p ai:%uz ao:%uz",
+                   ctx->next_in, ctx->next_out,
+                   ctx->avail_in, ctx->avail_out);
+
+    if (ctx->next_in) {
+        ctx->in_buf->pos = (u_char *) ctx->next_in;
+
+        if (ctx->avail_in == 0) {
+            ctx->next_in = NULL;
+        }
+    }
+
+    ctx->out_buf->last = ctx->next_out;
+
+    if (ctx->avail_out == 0) {
+
+        /* the encoder wants to output some more data */
+
+        cl = ngx_alloc_chain_link(r->pool);
+        if (cl == NULL) {
+            return NGX_ERROR;
+        }
+
+        cl->buf = ctx->out_buf;
+        cl->next = NULL;
+        *ctx->last_out = cl;
+        ctx->last_out = &cl->next;
+
+        ctx->redo = 1;
+
+        return NGX_AGAIN;
+    }
+
+    ctx->redo = 0;
+
+    if (ctx->avail_in || BrotliEncoderHasMoreOutput(ctx->encoder)) {
+        return NGX_AGAIN;
+    }
+
+    if (ctx->op == BROTLI_OPERATION_FLUSH) {
+
+        ctx->op = BROTLI_OPERATION_PROCESS;
+
+        cl = ngx_alloc_chain_link(r->pool);
+        if (cl == NULL) {
+            return NGX_ERROR;
+        }
+
+        b = ctx->out_buf;
+
+        if (ngx_buf_size(b) == 0) {
+
+            b = ngx_calloc_buf(ctx->request->pool);
+            if (b == NULL) {
+                return NGX_ERROR;
+            }
+
+        } else {
+            ctx->avail_out = 0;
+        }
+
+        b->flush = 1;
+
+        cl->buf = b;
+        cl->next = NULL;
+        *ctx->last_out = cl;
+        ctx->last_out = &cl->next;
+
+        r->connection->buffered &= ~NGX_HTTP_BROTLI_BUFFERED;
+
+        return NGX_OK;
+    }
+
+    if (ctx->op == BROTLI_OPERATION_FINISH
+        && BrotliEncoderIsFinished(ctx->encoder))
+    {
+        if (ngx_http_brotli_filter_encode_end(r, ctx) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
+        return NGX_OK;
+    }
+
+    return NGX_AGAIN;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_encode_end(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    ngx_chain_t  *cl;
+
+    BrotliEncoderDestroyInstance(ctx->encoder);
+    ctx->encoder = NULL;
+
+    cl = ngx_alloc_chain_link(r->pool);
+    if (cl == NULL) {
+        return NGX_ERROR;
+    }
+
+    ctx->out_buf->last_buf = 1;
+
+    cl->buf = ctx->out_buf;
+    cl->next = NULL;
+    *ctx->last_out = cl;
+    ctx->last_out = &cl->next;
+
+    ctx->avail_in = 0;
+    ctx->avail_out = 0;
+
+    ctx->done = 1;
+
+    r->connection->buffered &= ~NGX_HTTP_BROTLI_BUFFERED;
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_http_brotli_filter_alloc(void *opaque, size_t size)
+{
+    ngx_http_brotli_ctx_t *ctx = opaque;
+
+    void  *p;
+
+    /*
+     * the encoder memory is taken from the request pool: large blocks
+     * are returned by ngx_pfree() as soon as the encoder is destroyed,
+     * and nothing leaks if the request is aborted while compressing
+     */
+
+    p = ngx_palloc(ctx->request->pool, size);
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, ctx->request->connection->log, 0,
+                   "brotli alloc: %uz p:%p", size, p);
+
+    return p;
+}
+
+
+static void
+ngx_http_brotli_filter_free(void *opaque, void *address)
+{
+    ngx_http_brotli_ctx_t *ctx = opaque;
+
+    if (address) {
+        ngx_pfree(ctx->request->pool, address);
+    }
+}
+
+
+static void
+ngx_http_brotli_filter_free_copy_buf(ngx_http_request_t *r,
+    ngx_http_brotli_ctx_t *ctx)
+{
+    ngx_chain_t  *cl;
+
+    for (cl = ctx->copied; cl; cl = cl->next) {
+        ngx_pfree(r->pool, cl->buf->start);
+    }
+
+    ctx->copied = NULL;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_add_variables(ngx_conf_t *cf)
+{
+    ngx_http_variable_t  *var;
+
+    var = ngx_http_add_variable(cf, &ngx_http_brotli_ratio,
+                                NGX_HTTP_VAR_NOHASH);
+    if (var == NULL) {
+        return NGX_ERROR;
+    }
+
+    var->get_handler = ngx_http_brotli_ratio_variable;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_ratio_variable(ngx_http_request_t *r,
+    ngx_http_variable_value_t *v, uintptr_t data)
+{
+    ngx_uint_t              zint, zfrac;
+    ngx_http_brotli_ctx_t  *ctx;
+
+    v->valid = 1;
+    v->no_cacheable = 0;
+    v->not_found = 0;
+
+    ctx = ngx_http_get_module_ctx(r, ngx_http_brotli_filter_module);
+
+    if (ctx == NULL || ctx->zout == 0) {
+        v->not_found = 1;
+        return NGX_OK;
+    }
+
+    v->data = ngx_pnalloc(r->pool, NGX_INT32_LEN + 3);
+    if (v->data == NULL) {
+        return NGX_ERROR;
+    }
+
+    zint = (ngx_uint_t) (ctx->zin / ctx->zout);
+    zfrac = (ngx_uint_t) ((ctx->zin * 100 / ctx->zout) % 100);
+
+    if ((ctx->zin * 1000 / ctx->zout) % 10 > 4) {
+
+        /* the rounding, e.g., 2.125 to 2.13 */
+
+        zfrac++;
+
+        if (zfrac > 99) {
+            zint++;
+            zfrac = 0;
+        }
+    }
+
+    v->len = ngx_sprintf(v->data, "%ui.%02ui", zint, zfrac) - v->data;
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_http_brotli_create_conf(ngx_conf_t *cf)
+{
+    ngx_http_brotli_conf_t  *conf;
+
+    conf = ngx_pcalloc(cf->pool, sizeof(ngx_http_brotli_conf_t));
+    if (conf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     conf->bufs.num = 0;
+     *     conf->types = { NULL };
+     *     conf->types_keys = NULL;
+     */
+
+    conf->enable = NGX_CONF_UNSET;
+
+    conf->postpone = NGX_CONF_UNSET_SIZE;
+    conf->level = NGX_CONF_UNSET;
+    conf->lgwin = NGX_CONF_UNSET_SIZE;
+    conf->min_length = NGX_CONF_UNSET;
+
+    return conf;
+}
+
+
+static char *
+ngx_http_brotli_merge_conf(ngx_conf_t *cf, void *parent, void *child)
+{
+    ngx_http_brotli_conf_t *prev = parent;
+    ngx_http_brotli_conf_t *conf = child;
+
+    ngx_conf_merge_value(conf->enable, prev->enable, 0);
+
+    ngx_conf_merge_bufs_value(conf->bufs, prev->bufs,
+                              (128 * 1024) / ngx_pagesize, ngx_pagesize);
+
+    ngx_conf_merge_size_value(conf->postpone, prev->postpone, 0);
+    ngx_conf_merge_value(conf->level, prev->level, 6);
+    ngx_conf_merge_size_value(conf->lgwin, prev->lgwin, 19);
+    ngx_conf_merge_value(conf->min_length, prev->min_length, 20);
+
+    if (ngx_http_merge_types(cf, &conf->types_keys, &conf->types,
+                             &prev->types_keys, &prev->types,
+                             ngx_http_html_default_types)
+        != NGX_OK)
+    {
+        return NGX_CONF_ERROR;
+    }
+
+    return NGX_CONF_OK;
+}
+
+
+static ngx_int_t
+ngx_http_brotli_filter_init(ngx_conf_t *cf)
+{
+    ngx_http_next_header_filter = ngx_http_top_header_filter;
+    ngx_http_top_header_filter = ngx_http_brotli_header_filter;
+
+    ngx_http_next_body_filter = ngx_http_top_body_filter;
+    ngx_http_top_body_filter = ngx_http_brotli_body_filter;
+
+    return NGX_OK;
+}
+
+
+static char *
+ngx_http_brotli_window(ngx_conf_t *cf, void *post, void *data)
+{
+    size_t *np = data;
+
+    size_t  lgwin, wsize;
+
+    lgwin = BROTLI_MAX_WINDOW_BITS;
+
+    for (wsize = 16 * 1024 * 1024; wsize >= 1024; wsize >>= 1) {
+
+        if (wsize == *np) {
+            *np = lgwin;
+
+            return NGX_CONF_OK;
+        }
+
+        lgwin--;
+    }
+
+    return "must be 1k, 2k, 4k, 8k, 16k, 32k, 64k, 128k, 256k, 512k, "
+           "1m, 2m, 4m, 8m, or 16m";
+}
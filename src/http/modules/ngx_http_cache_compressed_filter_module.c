@@ -0,0 +1,253 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/*
+ * the filter runs after gzip and brotli and copies their output of a cache
+ * hit into a compressed variant of the cache entry, so that the following
+ * hits with the same content encoding are sent without compression
+ */
+
+
+typedef struct {
+    ngx_http_cache_t    *cache;
+    ngx_temp_file_t     *temp_file;
+    unsigned             done:1;
+} ngx_http_cache_compressed_ctx_t;
+
+
+static ngx_int_t ngx_http_cache_compressed_write(ngx_http_request_t *r,
+    ngx_http_cache_compressed_ctx_t *ctx, u_char *p, size_t size);
+static ngx_int_t ngx_http_cache_compressed_filter_init(ngx_conf_t *cf);
+
+
+static ngx_http_module_t  ngx_http_cache_compressed_filter_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    ngx_http_cache_compressed_filter_init, /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    NULL,                                  /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_cache_compressed_filter_module = {
+    NGX_MODULE_V1,
+    &ngx_http_cache_compressed_filter_module_ctx, /* module context */
+    NULL,                                  /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_http_output_header_filter_pt  ngx_http_next_header_filter;
+static ngx_http_output_body_filter_pt    ngx_http_next_body_filter;
+
+
+static ngx_int_t
+ngx_http_cache_compressed_header_filter(ngx_http_request_t *r)
+{
+    ngx_str_t                        *encoding;
+    ngx_temp_file_t                  *tf;
+    ngx_http_cache_t                 *c, *ec;
+    ngx_http_upstream_t              *u;
+    ngx_http_file_cache_header_t     *h;
+    ngx_http_cache_compressed_ctx_t  *ctx;
+
+    u = r->upstream;
+    c = r->cache;
+
+    if (r != r->main
+        || u == NULL
+        || c == NULL
+        || !r->cached
+        || !u->conf->cache_compressed
+        || c->encoding.len
+        || c->secondary
+        || c->buf == NULL
+        || c->valid_sec < ngx_time()
+        || r->header_only
+        || r->headers_out.status != NGX_HTTP_OK
+        || r->headers_out.content_encoding == NULL
+        || u->headers_in.content_encoding)
+    {
+        return ngx_http_next_header_filter(r);
+    }
+
+    h = (ngx_http_file_cache_header_t *) c->buf->start;
+
+    if (h->vary_len) {
+        return ngx_http_next_header_filter(r);
+    }
+
+    encoding = &r->headers_out.content_encoding->value;
+
+    if (!((encoding->len == 4
+           && ngx_strncasecmp(encoding->data, (u_char *) "gzip", 4) == 0)
+          || (encoding->len == 2
+              && ngx_strncasecmp(encoding->data, (u_char *) "br", 2) == 0)))
+    {
+        return ngx_http_next_header_filter(r);
+    }
+
+    ec = ngx_http_file_cache_encoded_create(r, encoding);
+    if (ec == NULL) {
+        return ngx_http_next_header_filter(r);
+    }
+
+    ctx = ngx_pcalloc(r->pool, sizeof(ngx_http_cache_compressed_ctx_t));
+    if (ctx == NULL) {
+        return NGX_ERROR;
+    }
+
+    tf = ngx_pcalloc(r->pool, sizeof(ngx_temp_file_t));
+    if (tf == NULL) {
+        return NGX_ERROR;
+    }
+
+    tf->file.fd = NGX_INVALID_FILE;
+    tf->file.log = r->connection->log;
+    tf->path = c->file_cache->temp_path ? c->file_cache->temp_path
+                                        : u->conf->temp_path;
+    tf->pool = r->pool;
+    tf->persistent = 1;
+    tf->clean = 1;
+
+    ctx->cache = ec;
+    ctx->temp_file = tf;
+
+    ngx_http_set_ctx(r, ctx, ngx_http_cache_compressed_filter_module);
+
+    /* the cache file header and the original response header are reused */
+
+    if (ngx_http_cache_compressed_write(r, ctx, c->buf->start, c->body_start)
+        != NGX_OK)
+    {
+        ngx_http_file_cache_free(ec, NULL);
+        ctx->done = 1;
+    }
+
+    return ngx_http_next_header_filter(r);
+}
+
+
+static ngx_int_t
+ngx_http_cache_compressed_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
+{
+    ngx_buf_t                        *b;
+    ngx_chain_t                      *cl;
+    ngx_http_cache_t                 *ec;
+    ngx_http_cache_compressed_ctx_t  *ctx;
+
+    ctx = ngx_http_get_module_ctx(r, ngx_http_cache_compressed_filter_module);
+
+    if (ctx == NULL || ctx->done) {
+        return ngx_http_next_body_filter(r, in);
+    }
+
+    ec = ctx->cache;
+
+    for (cl = in; cl; cl = cl->next) {
+        b = cl->buf;
+
+        if (ngx_buf_size(b) && !ngx_buf_in_memory(b)) {
+            ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "cache compressed: file buf");
+            goto failed;
+        }
+
+        if (ngx_buf_in_memory(b) && b->last > b->pos) {
+            if (ngx_http_cache_compressed_write(r, ctx, b->pos,
+                                                b->last - b->pos)
+                != NGX_OK)
+            {
+                goto failed;
+            }
+        }
+
+        if (b->last_buf) {
+            ctx->done = 1;
+
+            if (ec->valid_sec >= ngx_time()) {
+                ngx_http_file_cache_store(r, ec, ctx->temp_file);
+
+            } else {
+                ngx_http_file_cache_free(ec, NULL);
+            }
+
+            break;
+        }
+    }
+
+    return ngx_http_next_body_filter(r, in);
+
+failed:
+
+    ctx->done = 1;
+
+    ngx_http_file_cache_free(ec, NULL);
+
+    return ngx_http_next_body_filter(r, in);
+}
+
+
+static ngx_int_t
+ngx_http_cache_compressed_write(ngx_http_request_t *r,
+    ngx_http_cache_compressed_ctx_t *ctx, u_char *p, size_t size)
+{
+    ssize_t       n;
+    ngx_buf_t     buf;
+    ngx_chain_t   out;
+
+    ngx_memzero(&buf, sizeof(ngx_buf_t));
+
+    buf.pos = p;
+    buf.last = p + size;
+    buf.memory = 1;
+
+    out.buf = &buf;
+    out.next = NULL;
+
+    n = ngx_write_chain_to_temp_file(ctx->temp_file, &out);
+
+    if (n == NGX_ERROR) {
+        return NGX_ERROR;
+    }
+
+    ctx->temp_file->offset += n;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_cache_compressed_filter_init(ngx_conf_t *cf)
+{
+    ngx_http_next_header_filter = ngx_http_top_header_filter;
+    ngx_http_top_header_filter = ngx_http_cache_compressed_header_filter;
+
+    ngx_http_next_body_filter = ngx_http_top_body_filter;
+    ngx_http_top_body_filter = ngx_http_cache_compressed_body_filter;
+
+    return NGX_OK;
+}
@@ -17,6 +17,13 @@ typedef struct {
 } ngx_http_geo_range_t;
 
 
+typedef struct {
+    u_char                           start[16];
+    u_char                           end[16];
+    ngx_http_variable_value_t       *value;
+} ngx_http_geo_range6_t;
+
+
 typedef struct {
     ngx_radix_tree_t                *tree;
 #if (NGX_HAVE_INET6)
@@ -26,9 +33,9 @@ typedef struct {
 
 
 typedef struct {
-    ngx_http_geo_range_t           **low;
+    u_char                          *base;
     ngx_http_variable_value_t       *default_value;
-} ngx_http_geo_high_ranges_t;
+} ngx_http_geo_ranges_t;
 
 
 typedef struct {
@@ -41,7 +48,10 @@ typedef struct {
 typedef struct {
     ngx_http_variable_value_t       *value;
     ngx_str_t                       *net;
-    ngx_http_geo_high_ranges_t       high;
+    ngx_http_geo_range_t           **low;
+    ngx_array_t                     *ranges6;
+    ngx_http_variable_value_t       *default_value;
+    u_char                          *base;
     ngx_radix_tree_t                *tree;
 #if (NGX_HAVE_INET6)
     ngx_radix_tree_t                *tree6;
@@ -69,10 +79,10 @@ typedef struct {
 typedef struct {
     union {
         ngx_http_geo_trees_t         trees;
-        ngx_http_geo_high_ranges_t   high;
+        ngx_http_geo_ranges_t        ranges;
     } u;
 
-    ngx_array_t                     *proxies;
+    ngx_http_proxies_t              *proxies;
     unsigned                         proxy_recursive:1;
 
     ngx_int_t                        index;
@@ -91,6 +101,14 @@ static char *ngx_http_geo_add_range(ngx_conf_t *cf,
     ngx_http_geo_conf_ctx_t *ctx, in_addr_t start, in_addr_t end);
 static ngx_uint_t ngx_http_geo_delete_range(ngx_conf_t *cf,
     ngx_http_geo_conf_ctx_t *ctx, in_addr_t start, in_addr_t end);
+#if (NGX_HAVE_INET6)
+static char *ngx_http_geo_add_range6(ngx_conf_t *cf,
+    ngx_http_geo_conf_ctx_t *ctx, u_char *start, u_char *end);
+static ngx_uint_t ngx_http_geo_delete_range6(ngx_conf_t *cf,
+    ngx_http_geo_conf_ctx_t *ctx, u_char *start, u_char *end);
+static void ngx_http_geo_inc6(u_char *addr);
+static void ngx_http_geo_dec6(u_char *addr);
+#endif
 static char *ngx_http_geo_cidr(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     ngx_str_t *value);
 static char *ngx_http_geo_cidr_add(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
@@ -105,6 +123,9 @@ static char *ngx_http_geo_include(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     ngx_str_t *name);
 static ngx_int_t ngx_http_geo_include_binary_base(ngx_conf_t *cf,
     ngx_http_geo_conf_ctx_t *ctx, ngx_str_t *name);
+static void ngx_http_geo_close_binary_base(void *data);
+static ngx_int_t ngx_http_geo_compile_ranges(ngx_conf_t *cf,
+    ngx_http_geo_conf_ctx_t *ctx);
 static void ngx_http_geo_create_binary_base(ngx_http_geo_conf_ctx_t *ctx);
 static u_char *ngx_http_geo_copy_values(u_char *base, u_char *p,
     ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
@@ -154,6 +175,12 @@ ngx_module_t  ngx_http_geo_module = {
 };
 
 
+/*
+ * the ranges are compiled into a position independent base: all references
+ * are offsets from the base start, so a binary base file can be mapped
+ * read-only and shared by all processes as is
+ */
+
 typedef struct {
     u_char    GEORNG[6];
     u_char    version;
@@ -163,13 +190,48 @@ typedef struct {
 } ngx_http_geo_header_t;
 
 
+typedef struct {
+    uint32_t  default_value;
+    uint32_t  ranges6;
+    uint32_t  nranges6;
+    uint32_t  low[0x10000];
+} ngx_http_geo_index_t;
+
+
+typedef struct {
+    uint32_t  len;
+    u_char    data[1];
+} ngx_http_geo_base_value_t;
+
+
+typedef struct {
+    uint32_t  value;
+    u_short   start;
+    u_short   end;
+} ngx_http_geo_base_range_t;
+
+
+typedef struct {
+    u_char    start[16];
+    u_char    end[16];
+    uint32_t  value;
+} ngx_http_geo_base_range6_t;
+
+
+#define ngx_http_geo_value_size(len)                                          \
+    ngx_align(offsetof(ngx_http_geo_base_value_t, data) + (len),              \
+              sizeof(uint32_t))
+
+
+#define ngx_http_geo_value_offset(vv)                                         \
+    (((ngx_http_geo_variable_value_node_t *) (vv)) - 1)->offset
+
+
 static ngx_http_geo_header_t  ngx_http_geo_header = {
-    { 'G', 'E', 'O', 'R', 'N', 'G' }, 0, sizeof(void *), 0x12345678, 0
+    { 'G', 'E', 'O', 'R', 'N', 'G' }, 1, sizeof(uint32_t), 0x12345678, 0
 };
 
 
-/* geo range is AF_INET only */
-
 static ngx_int_t
 ngx_http_geo_cidr_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
     uintptr_t data)
@@ -242,17 +304,31 @@ ngx_http_geo_range_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
 {
     ngx_http_geo_ctx_t *ctx = (ngx_http_geo_ctx_t *) data;
 
-    in_addr_t              inaddr;
-    ngx_addr_t             addr;
-    ngx_uint_t             n;
-    struct sockaddr_in    *sin;
-    ngx_http_geo_range_t  *range;
+    u_char                      *base;
+    uint32_t                     value;
+    in_addr_t                    inaddr;
+    ngx_addr_t                   addr;
+    ngx_uint_t                   n;
+    struct sockaddr_in          *sin;
+    ngx_http_geo_index_t        *index;
+    ngx_http_geo_base_range_t   *range;
 #if (NGX_HAVE_INET6)
-    u_char                *p;
-    struct in6_addr       *inaddr6;
+    u_char                      *p;
+    ngx_uint_t                   lo, hi, mid;
+    struct in6_addr             *inaddr6;
+    ngx_http_geo_base_range6_t  *range6;
 #endif
 
-    *v = *ctx->u.high.default_value;
+    *v = *ctx->u.ranges.default_value;
+
+    base = ctx->u.ranges.base;
+
+    if (base == NULL) {
+        goto done;
+    }
+
+    index = (ngx_http_geo_index_t *) (base + sizeof(ngx_http_geo_header_t));
+    value = 0;
 
     if (ngx_http_geo_addr(r, ctx, &addr) == NGX_OK) {
 
@@ -261,20 +337,40 @@ ngx_http_geo_range_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
 #if (NGX_HAVE_INET6)
         case AF_INET6:
             inaddr6 = &((struct sockaddr_in6 *) addr.sockaddr)->sin6_addr;
+            p = inaddr6->s6_addr;
 
             if (IN6_IS_ADDR_V4MAPPED(inaddr6)) {
-                p = inaddr6->s6_addr;
-
                 inaddr = p[12] << 24;
                 inaddr += p[13] << 16;
                 inaddr += p[14] << 8;
                 inaddr += p[15];
 
-            } else {
-                inaddr = INADDR_NONE;
+                break;
             }
 
-            break;
+            /* the last range that starts not after the address */
+
+            range6 = (ngx_http_geo_base_range6_t *) (base + index->ranges6);
+
+            lo = 0;
+            hi = index->nranges6;
+
+            while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+
+                if (ngx_memcmp(range6[mid].start, p, 16) <= 0) {
+                    lo = mid + 1;
+
+                } else {
+                    hi = mid;
+                }
+            }
+
+            if (lo && ngx_memcmp(p, range6[lo - 1].end, 16) <= 0) {
+                value = range6[lo - 1].value;
+            }
+
+            goto found;
 #endif
 
         default: /* AF_INET */
@@ -287,22 +383,35 @@ ngx_http_geo_range_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
         inaddr = INADDR_NONE;
     }
 
-    if (ctx->u.high.low) {
-        range = ctx->u.high.low[inaddr >> 16];
+    if (index->low[inaddr >> 16]) {
+        range = (ngx_http_geo_base_range_t *)
+                    (base + index->low[inaddr >> 16]);
 
-        if (range) {
-            n = inaddr & 0xffff;
-            do {
-                if (n >= (ngx_uint_t) range->start
-                    && n <= (ngx_uint_t) range->end)
-                {
-                    *v = *range->value;
-                    break;
-                }
-            } while ((++range)->value);
-        }
+        n = inaddr & 0xffff;
+        do {
+            if (n >= (ngx_uint_t) range->start
+                && n <= (ngx_uint_t) range->end)
+            {
+                value = range->value;
+                break;
+            }
+        } while ((++range)->value);
     }
 
+#if (NGX_HAVE_INET6)
+found:
+#endif
+
+    if (value) {
+        v->len = ((ngx_http_geo_base_value_t *) (base + value))->len;
+        v->valid = 1;
+        v->no_cacheable = 0;
+        v->not_found = 0;
+        v->data = ((ngx_http_geo_base_value_t *) (base + value))->data;
+    }
+
+done:
+
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "http geo: %v", v);
 
@@ -371,18 +480,18 @@ ngx_http_geo_real_addr(ngx_http_request_t *r, ngx_http_geo_ctx_t *ctx,
 static char *
 ngx_http_geo_block(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
-    char                     *rv;
-    size_t                    len;
-    ngx_str_t                *value, name;
-    ngx_uint_t                i;
-    ngx_conf_t                save;
-    ngx_pool_t               *pool;
-    ngx_array_t              *a;
-    ngx_http_variable_t      *var;
-    ngx_http_geo_ctx_t       *geo;
-    ngx_http_geo_conf_ctx_t   ctx;
+    char                       *rv;
+    ngx_str_t                  *value, name;
+    ngx_conf_t                  save;
+    ngx_pool_t                 *pool;
+    ngx_http_variable_t        *var;
+    ngx_http_geo_ctx_t         *geo;
+    ngx_http_geo_index_t       *index;
+    ngx_http_geo_conf_ctx_t     ctx;
+    ngx_http_geo_base_value_t  *bv;
+    ngx_http_variable_value_t  *vv;
 #if (NGX_HAVE_INET6)
-    static struct in6_addr    zero;
+    static struct in6_addr      zero;
 #endif
 
     value = cf->args->elts;
@@ -445,9 +554,6 @@ ngx_http_geo_block(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     ngx_rbtree_init(&ctx.rbtree, &ctx.sentinel, ngx_str_rbtree_insert_value);
 
     ctx.pool = cf->pool;
-    ctx.data_size = sizeof(ngx_http_geo_header_t)
-                  + sizeof(ngx_http_variable_value_t)
-                  + 0x10000 * sizeof(ngx_http_geo_range_t *);
     ctx.allow_binary_include = 1;
 
     save = *cf;
@@ -460,29 +566,21 @@ ngx_http_geo_block(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     *cf = save;
 
-    geo->proxies = ctx.proxies;
+    if (ctx.proxies) {
+        geo->proxies = ngx_http_proxies_create(cf, ctx.proxies);
+        if (geo->proxies == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
     geo->proxy_recursive = ctx.proxy_recursive;
 
     if (ctx.ranges) {
 
-        if (ctx.high.low && !ctx.binary_include) {
-            for (i = 0; i < 0x10000; i++) {
-                a = (ngx_array_t *) ctx.high.low[i];
-
-                if (a == NULL || a->nelts == 0) {
-                    continue;
-                }
-
-                len = a->nelts * sizeof(ngx_http_geo_range_t);
-
-                ctx.high.low[i] = ngx_palloc(cf->pool, len + sizeof(void *));
-                if (ctx.high.low[i] == NULL) {
-                    return NGX_CONF_ERROR;
-                }
+        if ((ctx.low || ctx.ranges6) && !ctx.binary_include) {
 
-                ngx_memcpy(ctx.high.low[i], a->elts, len);
-                ctx.high.low[i][a->nelts].value = NULL;
-                ctx.data_size += len + sizeof(void *);
+            if (ngx_http_geo_compile_ranges(cf, &ctx) != NGX_OK) {
+                return NGX_CONF_ERROR;
             }
 
             if (ctx.allow_binary_include
@@ -494,11 +592,40 @@ ngx_http_geo_block(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             }
         }
 
-        if (ctx.high.default_value == NULL) {
-            ctx.high.default_value = &ngx_http_variable_null_value;
+        vv = ngx_palloc(cf->pool, sizeof(ngx_http_variable_value_t));
+        if (vv == NULL) {
+            return NGX_CONF_ERROR;
         }
 
-        geo->u.high = ctx.high;
+        if (ctx.default_value) {
+            *vv = *ctx.default_value;
+
+            vv->data = ngx_pnalloc(cf->pool, vv->len);
+            if (vv->data == NULL) {
+                return NGX_CONF_ERROR;
+            }
+
+            ngx_memcpy(vv->data, ctx.default_value->data, vv->len);
+
+        } else {
+            *vv = ngx_http_variable_null_value;
+
+            if (ctx.base) {
+                index = (ngx_http_geo_index_t *)
+                            (ctx.base + sizeof(ngx_http_geo_header_t));
+
+                if (index->default_value) {
+                    bv = (ngx_http_geo_base_value_t *)
+                             (ctx.base + index->default_value);
+
+                    vv->len = bv->len;
+                    vv->data = bv->data;
+                }
+            }
+        }
+
+        geo->u.ranges.base = ctx.base;
+        geo->u.ranges.default_value = vv;
 
         var->get_handler = ngx_http_geo_range_variable;
         var->data = (uintptr_t) geo;
@@ -650,17 +777,20 @@ ngx_http_geo_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     in_addr_t    start, end;
     ngx_str_t   *net;
     ngx_uint_t   del;
+#if (NGX_HAVE_INET6)
+    u_char       start6[16], end6[16];
+#endif
 
     if (ngx_strcmp(value[0].data, "default") == 0) {
 
-        if (ctx->high.default_value) {
+        if (ctx->default_value) {
             ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
                 "duplicate default geo range value: \"%V\", old value: \"%v\"",
-                &value[1], ctx->high.default_value);
+                &value[1], ctx->default_value);
         }
 
-        ctx->high.default_value = ngx_http_geo_value(cf, ctx, &value[1]);
-        if (ctx->high.default_value == NULL) {
+        ctx->default_value = ngx_http_geo_value(cf, ctx, &value[1]);
+        if (ctx->default_value == NULL) {
             return NGX_CONF_ERROR;
         }
 
@@ -674,14 +804,6 @@ ngx_http_geo_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
         return NGX_CONF_ERROR;
     }
 
-    if (ctx->high.low == NULL) {
-        ctx->high.low = ngx_pcalloc(ctx->pool,
-                                    0x10000 * sizeof(ngx_http_geo_range_t *));
-        if (ctx->high.low == NULL) {
-            return NGX_CONF_ERROR;
-        }
-    }
-
     ctx->entries++;
     ctx->outside_entries = 1;
 
@@ -702,6 +824,54 @@ ngx_http_geo_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
         goto invalid;
     }
 
+#if (NGX_HAVE_INET6)
+
+    if (ngx_strlchr(net->data, p, ':')) {
+
+        if (ngx_inet6_addr(net->data, p - net->data, start6) != NGX_OK) {
+            goto invalid;
+        }
+
+        p++;
+
+        if (ngx_inet6_addr(p, last - p, end6) != NGX_OK) {
+            goto invalid;
+        }
+
+        if (ngx_memcmp(start6, end6, 16) > 0) {
+            goto invalid;
+        }
+
+        if (del) {
+            if (ngx_http_geo_delete_range6(cf, ctx, start6, end6)) {
+                ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                                   "no address range \"%V\" to delete", net);
+            }
+
+            return NGX_CONF_OK;
+        }
+
+        ctx->value = ngx_http_geo_value(cf, ctx, &value[1]);
+
+        if (ctx->value == NULL) {
+            return NGX_CONF_ERROR;
+        }
+
+        ctx->net = net;
+
+        return ngx_http_geo_add_range6(cf, ctx, start6, end6);
+    }
+
+#endif
+
+    if (ctx->low == NULL) {
+        ctx->low = ngx_pcalloc(ctx->temp_pool,
+                               0x10000 * sizeof(ngx_http_geo_range_t *));
+        if (ctx->low == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
     start = ngx_inet_addr(net->data, p - net->data);
 
     if (start == INADDR_NONE) {
@@ -779,7 +949,7 @@ ngx_http_geo_add_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
             e = 0xffff;
         }
 
-        a = (ngx_array_t *) ctx->high.low[h];
+        a = (ngx_array_t *) ctx->low[h];
 
         if (a == NULL) {
             a = ngx_array_create(ctx->temp_pool, 64,
@@ -788,7 +958,7 @@ ngx_http_geo_add_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
                 return NGX_CONF_ERROR;
             }
 
-            ctx->high.low[h] = (ngx_http_geo_range_t *) a;
+            ctx->low[h] = (ngx_http_geo_range_t *) a;
         }
 
         i = a->nelts;
@@ -976,7 +1146,7 @@ ngx_http_geo_delete_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
             e = 0xffff;
         }
 
-        a = (ngx_array_t *) ctx->high.low[h];
+        a = (ngx_array_t *) ctx->low[h];
 
         if (a == NULL) {
             warn = 1;
@@ -1011,6 +1181,208 @@ ngx_http_geo_delete_range(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
 }
 
 
+#if (NGX_HAVE_INET6)
+
+static void
+ngx_http_geo_inc6(u_char *addr)
+{
+    ngx_int_t  i;
+
+    for (i = 15; i >= 0; i--) {
+        if (++addr[i]) {
+            break;
+        }
+    }
+}
+
+
+static void
+ngx_http_geo_dec6(u_char *addr)
+{
+    ngx_int_t  i;
+
+    for (i = 15; i >= 0; i--) {
+        if (addr[i]--) {
+            break;
+        }
+    }
+}
+
+
+/* IPv6 ranges are kept sorted and never overlap */
+
+static char *
+ngx_http_geo_add_range6(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
+    u_char *start, u_char *end)
+{
+    u_char                  s[NGX_INET6_ADDRSTRLEN], e[NGX_INET6_ADDRSTRLEN];
+    size_t                  slen, elen;
+    ngx_uint_t              i, n, lo, hi, mid;
+    ngx_http_geo_range6_t  *range, *r;
+
+    if (ctx->ranges6 == NULL) {
+        ctx->ranges6 = ngx_array_create(ctx->temp_pool, 64,
+                                        sizeof(ngx_http_geo_range6_t));
+        if (ctx->ranges6 == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+    range = ctx->ranges6->elts;
+    n = ctx->ranges6->nelts;
+
+    /* the first range that starts after the new one */
+
+    if (n == 0 || ngx_memcmp(range[n - 1].start, start, 16) < 0) {
+        i = n;
+
+    } else {
+        lo = 0;
+        hi = n;
+
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+
+            if (ngx_memcmp(range[mid].start, start, 16) <= 0) {
+                lo = mid + 1;
+
+            } else {
+                hi = mid;
+            }
+        }
+
+        i = lo;
+    }
+
+    if (i && ngx_memcmp(start, range[i - 1].end, 16) <= 0) {
+
+        r = &range[i - 1];
+
+        if (ngx_memcmp(start, r->start, 16) == 0
+            && ngx_memcmp(end, r->end, 16) == 0)
+        {
+            ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                "duplicate range \"%V\", value: \"%v\", old value: \"%v\"",
+                ctx->net, ctx->value, r->value);
+
+            r->value = ctx->value;
+
+            return NGX_CONF_OK;
+        }
+
+        if (ngx_memcmp(end, r->end, 16) > 0) {
+            goto overlaps;
+        }
+
+        /* split the range and insert the new one */
+
+        n = (ngx_memcmp(start, r->start, 16) > 0)
+            + (ngx_memcmp(end, r->end, 16) < 0);
+
+        for ( /* void */ ; n; n--) {
+            if (ngx_array_push(ctx->ranges6) == NULL) {
+                return NGX_CONF_ERROR;
+            }
+        }
+
+        range = ctx->ranges6->elts;
+        r = &range[i - 1];
+
+        n = ctx->ranges6->nelts - (i - 1);
+
+        if (ngx_memcmp(start, r->start, 16) > 0) {
+            ngx_memmove(&r[1], &r[0],
+                        (n - 1) * sizeof(ngx_http_geo_range6_t));
+
+            ngx_memcpy(r->end, start, 16);
+            ngx_http_geo_dec6(r->end);
+
+            r++;
+            n--;
+        }
+
+        if (ngx_memcmp(end, r->end, 16) < 0) {
+            ngx_memmove(&r[1], &r[0],
+                        (n - 1) * sizeof(ngx_http_geo_range6_t));
+
+            ngx_memcpy(r[1].start, end, 16);
+            ngx_http_geo_inc6(r[1].start);
+        }
+
+        ngx_memcpy(r->start, start, 16);
+        ngx_memcpy(r->end, end, 16);
+        r->value = ctx->value;
+
+        return NGX_CONF_OK;
+    }
+
+    if (i < n && ngx_memcmp(range[i].start, end, 16) <= 0) {
+        r = &range[i];
+        goto overlaps;
+    }
+
+    if (ngx_array_push(ctx->ranges6) == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    range = ctx->ranges6->elts;
+
+    ngx_memmove(&range[i + 1], &range[i],
+                (n - i) * sizeof(ngx_http_geo_range6_t));
+
+    ngx_memcpy(range[i].start, start, 16);
+    ngx_memcpy(range[i].end, end, 16);
+    range[i].value = ctx->value;
+
+    return NGX_CONF_OK;
+
+overlaps:
+
+    slen = ngx_inet6_ntop(r->start, s, NGX_INET6_ADDRSTRLEN);
+    elen = ngx_inet6_ntop(r->end, e, NGX_INET6_ADDRSTRLEN);
+
+    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                       "range \"%V\" overlaps \"%*s-%*s\"",
+                       ctx->net, slen, s, elen, e);
+
+    return NGX_CONF_ERROR;
+}
+
+
+static ngx_uint_t
+ngx_http_geo_delete_range6(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
+    u_char *start, u_char *end)
+{
+    ngx_uint_t              i;
+    ngx_http_geo_range6_t  *range;
+
+    if (ctx->ranges6 == NULL) {
+        return 1;
+    }
+
+    range = ctx->ranges6->elts;
+
+    for (i = 0; i < ctx->ranges6->nelts; i++) {
+
+        if (ngx_memcmp(start, range[i].start, 16) == 0
+            && ngx_memcmp(end, range[i].end, 16) == 0)
+        {
+            ngx_memmove(&range[i], &range[i + 1],
+                        (ctx->ranges6->nelts - 1 - i)
+                        * sizeof(ngx_http_geo_range6_t));
+
+            ctx->ranges6->nelts--;
+
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#endif
+
+
 static char *
 ngx_http_geo_cidr(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     ngx_str_t *value)
@@ -1223,27 +1595,48 @@ ngx_http_geo_value(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
         return gvvn->value;
     }
 
-    val = ngx_palloc(ctx->pool, sizeof(ngx_http_variable_value_t));
-    if (val == NULL) {
-        return NULL;
+    if (ctx->ranges) {
+
+        /*
+         * range values are needed at configuration time only,
+         * they are copied into the compiled base
+         */
+
+        gvvn = ngx_palloc(ctx->temp_pool,
+                          sizeof(ngx_http_geo_variable_value_node_t)
+                          + sizeof(ngx_http_variable_value_t));
+        if (gvvn == NULL) {
+            return NULL;
+        }
+
+        val = (ngx_http_variable_value_t *) &gvvn[1];
+
+        val->data = ngx_pstrdup(ctx->temp_pool, value);
+
+    } else {
+        gvvn = ngx_palloc(ctx->temp_pool,
+                          sizeof(ngx_http_geo_variable_value_node_t));
+        if (gvvn == NULL) {
+            return NULL;
+        }
+
+        val = ngx_palloc(ctx->pool, sizeof(ngx_http_variable_value_t));
+        if (val == NULL) {
+            return NULL;
+        }
+
+        val->data = ngx_pstrdup(ctx->pool, value);
     }
 
-    val->len = value->len;
-    val->data = ngx_pstrdup(ctx->pool, value);
     if (val->data == NULL) {
         return NULL;
     }
 
+    val->len = value->len;
     val->valid = 1;
     val->no_cacheable = 0;
     val->not_found = 0;
 
-    gvvn = ngx_palloc(ctx->temp_pool,
-                      sizeof(ngx_http_geo_variable_value_node_t));
-    if (gvvn == NULL) {
-        return NULL;
-    }
-
     gvvn->sn.node.key = hash;
     gvvn->sn.str.len = val->len;
     gvvn->sn.str.data = val->data;
@@ -1252,8 +1645,7 @@ ngx_http_geo_value(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
 
     ngx_rbtree_insert(&ctx->rbtree, &gvvn->sn.node);
 
-    ctx->data_size += ngx_align(sizeof(ngx_http_variable_value_t) + value->len,
-                                sizeof(void *));
+    ctx->data_size += ngx_http_geo_value_size(value->len);
 
     return val;
 }
@@ -1368,30 +1760,22 @@ static ngx_int_t
 ngx_http_geo_include_binary_base(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     ngx_str_t *name)
 {
-    u_char                     *base, ch;
-    time_t                      mtime;
-    size_t                      size, len;
-    ssize_t                     n;
-    uint32_t                    crc32;
-    ngx_err_t                   err;
-    ngx_int_t                   rc;
-    ngx_uint_t                  i;
-    ngx_file_t                  file;
-    ngx_file_info_t             fi;
-    ngx_http_geo_range_t       *range, **ranges;
-    ngx_http_geo_header_t      *header;
-    ngx_http_variable_value_t  *vv;
-
-    ngx_memzero(&file, sizeof(ngx_file_t));
-    file.name = *name;
-    file.log = cf->log;
+    u_char                  ch;
+    time_t                  mtime;
+    size_t                  size;
+    uint32_t                crc32;
+    ngx_err_t               err;
+    ngx_file_info_t         fi;
+    ngx_pool_cleanup_t     *cln;
+    ngx_file_mapping_t     *fm;
+    ngx_http_geo_index_t   *index;
+    ngx_http_geo_header_t  *header;
 
-    file.fd = ngx_open_file(name->data, NGX_FILE_RDONLY, 0, 0);
-    if (file.fd == NGX_INVALID_FILE) {
+    if (ngx_file_info(name->data, &fi) == NGX_FILE_ERROR) {
         err = ngx_errno;
         if (err != NGX_ENOENT) {
             ngx_conf_log_error(NGX_LOG_CRIT, cf, err,
-                               ngx_open_file_n " \"%s\" failed", name->data);
+                               ngx_file_info_n " \"%s\" failed", name->data);
         }
         return NGX_DECLINED;
     }
@@ -1400,22 +1784,14 @@ ngx_http_geo_include_binary_base(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
         ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
             "binary geo range base \"%s\" cannot be mixed with usual entries",
             name->data);
-        rc = NGX_ERROR;
-        goto done;
+        return NGX_ERROR;
     }
 
     if (ctx->binary_include) {
         ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
             "second binary geo range base \"%s\" cannot be mixed with \"%s\"",
             name->data, ctx->include_name.data);
-        rc = NGX_ERROR;
-        goto done;
-    }
-
-    if (ngx_fd_info(file.fd, &fi) == NGX_FILE_ERROR) {
-        ngx_conf_log_error(NGX_LOG_CRIT, cf, ngx_errno,
-                           ngx_fd_info_n " \"%s\" failed", name->data);
-        goto failed;
+        return NGX_ERROR;
     }
 
     size = (size_t) ngx_file_size(&fi);
@@ -1427,7 +1803,8 @@ ngx_http_geo_include_binary_base(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     if (ngx_file_info(name->data, &fi) == NGX_FILE_ERROR) {
         ngx_conf_log_error(NGX_LOG_CRIT, cf, ngx_errno,
                            ngx_file_info_n " \"%s\" failed", name->data);
-        goto failed;
+        name->data[name->len - 4] = ch;
+        return NGX_DECLINED;
     }
 
     name->data[name->len - 4] = ch;
@@ -1435,183 +1812,250 @@ ngx_http_geo_include_binary_base(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx,
     if (mtime < ngx_file_mtime(&fi)) {
         ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
                            "stale binary geo range base \"%s\"", name->data);
-        goto failed;
+        return NGX_DECLINED;
     }
 
-    base = ngx_palloc(ctx->pool, size);
-    if (base == NULL) {
-        goto failed;
+    if (size < sizeof(ngx_http_geo_header_t) + sizeof(ngx_http_geo_index_t)) {
+        goto incompatible;
     }
 
-    n = ngx_read_file(&file, base, size, 0);
+    /* the base stays mapped while the configuration is in use */
 
-    if (n == NGX_ERROR) {
-        ngx_conf_log_error(NGX_LOG_CRIT, cf, ngx_errno,
-                           ngx_read_file_n " \"%s\" failed", name->data);
-        goto failed;
-    }
-
-    if ((size_t) n != size) {
-        ngx_conf_log_error(NGX_LOG_CRIT, cf, 0,
-            ngx_read_file_n " \"%s\" returned only %z bytes instead of %z",
-            name->data, n, size);
-        goto failed;
+    cln = ngx_pool_cleanup_add(ctx->pool, sizeof(ngx_file_mapping_t));
+    if (cln == NULL) {
+        return NGX_ERROR;
     }
 
-    header = (ngx_http_geo_header_t *) base;
+    fm = cln->data;
 
-    if (size < 16 || ngx_memcmp(&ngx_http_geo_header, header, 12) != 0) {
-        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
-             "incompatible binary geo range base \"%s\"", name->data);
-        goto failed;
+    fm->name = ngx_pnalloc(ctx->pool, name->len + 1);
+    if (fm->name == NULL) {
+        return NGX_ERROR;
     }
 
-    ngx_crc32_init(crc32);
-
-    vv = (ngx_http_variable_value_t *) (base + sizeof(ngx_http_geo_header_t));
-
-    while (vv->data) {
-        len = ngx_align(sizeof(ngx_http_variable_value_t) + vv->len,
-                        sizeof(void *));
-        ngx_crc32_update(&crc32, (u_char *) vv, len);
-        vv->data += (size_t) base;
-        vv = (ngx_http_variable_value_t *) ((u_char *) vv + len);
-    }
-    ngx_crc32_update(&crc32, (u_char *) vv, sizeof(ngx_http_variable_value_t));
-    vv++;
+    ngx_cpystrn(fm->name, name->data, name->len + 1);
 
-    ranges = (ngx_http_geo_range_t **) vv;
+    fm->log = ctx->pool->log;
 
-    for (i = 0; i < 0x10000; i++) {
-        ngx_crc32_update(&crc32, (u_char *) &ranges[i], sizeof(void *));
-        if (ranges[i]) {
-            ranges[i] = (ngx_http_geo_range_t *)
-                            ((u_char *) ranges[i] + (size_t) base);
-        }
+    if (ngx_open_file_mapping(fm) != NGX_OK) {
+        return NGX_DECLINED;
     }
 
-    range = (ngx_http_geo_range_t *) &ranges[0x10000];
+    header = fm->addr;
+    index = (ngx_http_geo_index_t *)
+                ((u_char *) fm->addr + sizeof(ngx_http_geo_header_t));
 
-    while ((u_char *) range < base + size) {
-        while (range->value) {
-            ngx_crc32_update(&crc32, (u_char *) range,
-                             sizeof(ngx_http_geo_range_t));
-            range->value = (ngx_http_variable_value_t *)
-                               ((u_char *) range->value + (size_t) base);
-            range++;
-        }
-        ngx_crc32_update(&crc32, (u_char *) range, sizeof(void *));
-        range = (ngx_http_geo_range_t *) ((u_char *) range + sizeof(void *));
+    if (fm->size < sizeof(ngx_http_geo_header_t) + sizeof(ngx_http_geo_index_t)
+        || ngx_memcmp(&ngx_http_geo_header, header, 12) != 0
+        || index->ranges6 > fm->size
+        || index->nranges6 > (fm->size - index->ranges6)
+                             / sizeof(ngx_http_geo_base_range6_t))
+    {
+        ngx_close_file_mapping(fm);
+        goto incompatible;
     }
 
-    ngx_crc32_final(crc32);
+    crc32 = ngx_crc32_long((u_char *) fm->addr + sizeof(ngx_http_geo_header_t),
+                           fm->size - sizeof(ngx_http_geo_header_t));
 
     if (crc32 != header->crc32) {
         ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
                   "CRC32 mismatch in binary geo range base \"%s\"", name->data);
-        goto failed;
+        ngx_close_file_mapping(fm);
+        return NGX_DECLINED;
     }
 
+    cln->handler = ngx_http_geo_close_binary_base;
+
     ngx_conf_log_error(NGX_LOG_NOTICE, cf, 0,
                        "using binary geo range base \"%s\"", name->data);
 
     ctx->include_name = *name;
     ctx->binary_include = 1;
-    ctx->high.low = ranges;
-    rc = NGX_OK;
+    ctx->base = fm->addr;
+    ctx->data_size = fm->size;
 
-    goto done;
+    return NGX_OK;
 
-failed:
+incompatible:
 
-    rc = NGX_DECLINED;
+    ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                       "incompatible binary geo range base \"%s\"", name->data);
 
-done:
+    return NGX_DECLINED;
+}
 
-    if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
-        ngx_log_error(NGX_LOG_ALERT, cf->log, ngx_errno,
-                      ngx_close_file_n " \"%s\" failed", name->data);
-    }
 
-    return rc;
+static void
+ngx_http_geo_close_binary_base(void *data)
+{
+    ngx_file_mapping_t  *fm = data;
+
+    ngx_close_file_mapping(fm);
 }
 
 
-static void
-ngx_http_geo_create_binary_base(ngx_http_geo_conf_ctx_t *ctx)
+static ngx_int_t
+ngx_http_geo_compile_ranges(ngx_conf_t *cf, ngx_http_geo_conf_ctx_t *ctx)
 {
-    u_char                              *p;
-    uint32_t                             hash;
-    ngx_str_t                            s;
-    ngx_uint_t                           i;
-    ngx_file_mapping_t                   fm;
-    ngx_http_geo_range_t                *r, *range, **ranges;
-    ngx_http_geo_header_t               *header;
-    ngx_http_geo_variable_value_node_t  *gvvn;
+    u_char                      *p;
+    size_t                       size;
+    ngx_uint_t                   i, j;
+    ngx_array_t                 *a;
+    ngx_http_geo_range_t        *range;
+    ngx_http_geo_index_t        *index;
+    ngx_http_geo_header_t       *header;
+    ngx_http_geo_base_range_t   *br;
+#if (NGX_HAVE_INET6)
+    ngx_http_geo_range6_t       *range6;
+    ngx_http_geo_base_range6_t  *br6;
+#endif
 
-    fm.name = ngx_pnalloc(ctx->temp_pool, ctx->include_name.len + 5);
-    if (fm.name == NULL) {
-        return;
-    }
+    size = sizeof(ngx_http_geo_header_t) + sizeof(ngx_http_geo_index_t)
+           + ctx->data_size;
 
-    ngx_sprintf(fm.name, "%V.bin%Z", &ctx->include_name);
+    if (ctx->low) {
+        for (i = 0; i < 0x10000; i++) {
+            a = (ngx_array_t *) ctx->low[i];
 
-    fm.size = ctx->data_size;
-    fm.log = ctx->pool->log;
+            if (a && a->nelts) {
+                size += (a->nelts + 1) * sizeof(ngx_http_geo_base_range_t);
+            }
+        }
+    }
 
-    ngx_log_error(NGX_LOG_NOTICE, fm.log, 0,
-                  "creating binary geo range base \"%s\"", fm.name);
+#if (NGX_HAVE_INET6)
+    if (ctx->ranges6) {
+        size += ctx->ranges6->nelts * sizeof(ngx_http_geo_base_range6_t);
+    }
+#endif
 
-    if (ngx_create_file_mapping(&fm) != NGX_OK) {
-        return;
+#if (NGX_PTR_SIZE == 8)
+    if (size > 0xffffffff) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "geo range base is too big: %uz bytes", size);
+        return NGX_ERROR;
     }
+#endif
+
+    ctx->base = ngx_pcalloc(cf->pool, size);
+    if (ctx->base == NULL) {
+        return NGX_ERROR;
+    }
+
+    ctx->data_size = size;
 
-    p = ngx_cpymem(fm.addr, &ngx_http_geo_header,
+    p = ngx_cpymem(ctx->base, &ngx_http_geo_header,
                    sizeof(ngx_http_geo_header_t));
 
-    p = ngx_http_geo_copy_values(fm.addr, p, ctx->rbtree.root,
+    index = (ngx_http_geo_index_t *) p;
+    p += sizeof(ngx_http_geo_index_t);
+
+    p = ngx_http_geo_copy_values(ctx->base, p, ctx->rbtree.root,
                                  ctx->rbtree.sentinel);
 
-    p += sizeof(ngx_http_variable_value_t);
+    if (ctx->default_value) {
+        index->default_value = ngx_http_geo_value_offset(ctx->default_value);
+    }
+
+    if (ctx->low) {
+        for (i = 0; i < 0x10000; i++) {
+            a = (ngx_array_t *) ctx->low[i];
 
-    ranges = (ngx_http_geo_range_t **) p;
+            if (a == NULL || a->nelts == 0) {
+                continue;
+            }
 
-    p += 0x10000 * sizeof(ngx_http_geo_range_t *);
+            index->low[i] = p - ctx->base;
 
-    for (i = 0; i < 0x10000; i++) {
-        r = ctx->high.low[i];
-        if (r == NULL) {
-            continue;
+            br = (ngx_http_geo_base_range_t *) p;
+            range = a->elts;
+
+            for (j = 0; j < a->nelts; j++) {
+                br[j].value = ngx_http_geo_value_offset(range[j].value);
+                br[j].start = range[j].start;
+                br[j].end = range[j].end;
+            }
+
+            /* the list is terminated by the zeroed range */
+
+            p = (u_char *) &br[j + 1];
         }
+    }
 
-        range = (ngx_http_geo_range_t *) p;
-        ranges[i] = (ngx_http_geo_range_t *) (p - (u_char *) fm.addr);
+#if (NGX_HAVE_INET6)
+    if (ctx->ranges6) {
+        index->ranges6 = p - ctx->base;
+        index->nranges6 = ctx->ranges6->nelts;
 
-        do {
-            s.len = r->value->len;
-            s.data = r->value->data;
-            hash = ngx_crc32_long(s.data, s.len);
-            gvvn = (ngx_http_geo_variable_value_node_t *)
-                        ngx_str_rbtree_lookup(&ctx->rbtree, &s, hash);
+        br6 = (ngx_http_geo_base_range6_t *) p;
+        range6 = ctx->ranges6->elts;
 
-            range->value = (ngx_http_variable_value_t *) gvvn->offset;
-            range->start = r->start;
-            range->end = r->end;
-            range++;
+        for (i = 0; i < ctx->ranges6->nelts; i++) {
+            ngx_memcpy(br6[i].start, range6[i].start, 16);
+            ngx_memcpy(br6[i].end, range6[i].end, 16);
+            br6[i].value = ngx_http_geo_value_offset(range6[i].value);
+        }
+    }
+#endif
 
-        } while ((++r)->value);
+    header = (ngx_http_geo_header_t *) ctx->base;
+    header->crc32 = ngx_crc32_long(ctx->base + sizeof(ngx_http_geo_header_t),
+                                   size - sizeof(ngx_http_geo_header_t));
 
-        range->value = NULL;
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_geo_create_binary_base(ngx_http_geo_conf_ctx_t *ctx)
+{
+    u_char              *name;
+    ngx_file_mapping_t   fm;
 
-        p = (u_char *) range + sizeof(void *);
+    name = ngx_pnalloc(ctx->temp_pool, ctx->include_name.len + 5);
+    if (name == NULL) {
+        return;
+    }
+
+    ngx_sprintf(name, "%V.bin%Z", &ctx->include_name);
+
+    fm.name = ngx_pnalloc(ctx->temp_pool, ctx->include_name.len + 9);
+    if (fm.name == NULL) {
+        return;
+    }
+
+    ngx_sprintf(fm.name, "%V.bin.tmp%Z", &ctx->include_name);
+
+    fm.size = ctx->data_size;
+    fm.log = ctx->pool->log;
+
+    ngx_log_error(NGX_LOG_NOTICE, fm.log, 0,
+                  "creating binary geo range base \"%s\"", name);
+
+    if (ngx_create_file_mapping(&fm) != NGX_OK) {
+        return;
     }
 
-    header = fm.addr;
-    header->crc32 = ngx_crc32_long((u_char *) fm.addr
-                                       + sizeof(ngx_http_geo_header_t),
-                                   fm.size - sizeof(ngx_http_geo_header_t));
+    ngx_memcpy(fm.addr, ctx->base, fm.size);
 
     ngx_close_file_mapping(&fm);
+
+    /*
+     * the base is renamed into place, so the running processes
+     * that have the previous base mapped are not affected
+     */
+
+    if (ngx_rename_file(fm.name, name) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, fm.log, ngx_errno,
+                      ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                      fm.name, name);
+
+        if (ngx_delete_file(fm.name) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_ALERT, fm.log, ngx_errno,
+                          ngx_delete_file_n " \"%s\" failed", fm.name);
+        }
+    }
 }
 
 
@@ -1619,7 +2063,7 @@ static u_char *
 ngx_http_geo_copy_values(u_char *base, u_char *p, ngx_rbtree_node_t *node,
     ngx_rbtree_node_t *sentinel)
 {
-    ngx_http_variable_value_t           *vv;
+    ngx_http_geo_base_value_t           *bv;
     ngx_http_geo_variable_value_node_t  *gvvn;
 
     if (node == sentinel) {
@@ -1629,14 +2073,11 @@ ngx_http_geo_copy_values(u_char *base, u_char *p, ngx_rbtree_node_t *node,
     gvvn = (ngx_http_geo_variable_value_node_t *) node;
     gvvn->offset = p - base;
 
-    vv = (ngx_http_variable_value_t *) p;
-    *vv = *gvvn->value;
-    p += sizeof(ngx_http_variable_value_t);
-    vv->data = (u_char *) (p - base);
-
-    p = ngx_cpymem(p, gvvn->sn.str.data, gvvn->sn.str.len);
+    bv = (ngx_http_geo_base_value_t *) p;
+    bv->len = (uint32_t) gvvn->sn.str.len;
+    ngx_memcpy(bv->data, gvvn->sn.str.data, gvvn->sn.str.len);
 
-    p = ngx_align_ptr(p, sizeof(void *));
+    p += ngx_http_geo_value_size(gvvn->sn.str.len);
 
     p = ngx_http_geo_copy_values(base, p, node->left, sentinel);
 
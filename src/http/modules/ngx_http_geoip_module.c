@@ -19,15 +19,16 @@
 
 
 typedef struct {
-    GeoIP        *country;
-    GeoIP        *org;
-    GeoIP        *city;
-    ngx_array_t  *proxies;    /* array of ngx_cidr_t */
-    ngx_flag_t    proxy_recursive;
+    GeoIP               *country;
+    GeoIP               *org;
+    GeoIP               *city;
+    ngx_array_t         *proxies;    /* array of ngx_cidr_t */
+    ngx_http_proxies_t  *trusted;
+    ngx_flag_t           proxy_recursive;
 #if (NGX_HAVE_GEOIP_V6)
-    unsigned      country_v6:1;
-    unsigned      org_v6:1;
-    unsigned      city_v6:1;
+    unsigned             country_v6:1;
+    unsigned             org_v6:1;
+    unsigned             city_v6:1;
 #endif
 } ngx_http_geoip_conf_t;
 
@@ -249,9 +250,9 @@ ngx_http_geoip_addr(ngx_http_request_t *r, ngx_http_geoip_conf_t *gcf)
 
     xfwd = &r->headers_in.x_forwarded_for;
 
-    if (xfwd->nelts > 0 && gcf->proxies != NULL) {
+    if (xfwd->nelts > 0 && gcf->trusted != NULL) {
         (void) ngx_http_get_forwarded_addr(r, &addr, xfwd, NULL,
-                                           gcf->proxies, gcf->proxy_recursive);
+                                           gcf->trusted, gcf->proxy_recursive);
     }
 
 #if (NGX_HAVE_INET6)
@@ -304,9 +305,9 @@ ngx_http_geoip_addr_v6(ngx_http_request_t *r, ngx_http_geoip_conf_t *gcf)
 
     xfwd = &r->headers_in.x_forwarded_for;
 
-    if (xfwd->nelts > 0 && gcf->proxies != NULL) {
+    if (xfwd->nelts > 0 && gcf->trusted != NULL) {
         (void) ngx_http_get_forwarded_addr(r, &addr, xfwd, NULL,
-                                           gcf->proxies, gcf->proxy_recursive);
+                                           gcf->trusted, gcf->proxy_recursive);
     }
 
     switch (addr.sockaddr->sa_family) {
@@ -669,6 +670,13 @@ ngx_http_geoip_init_conf(ngx_conf_t *cf, void *conf)
 
     ngx_conf_init_value(gcf->proxy_recursive, 0);
 
+    if (gcf->proxies) {
+        gcf->trusted = ngx_http_proxies_create(cf, gcf->proxies);
+        if (gcf->trusted == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
     return NGX_CONF_OK;
 }
 
@@ -30,6 +30,33 @@ typedef struct {
 } ngx_http_gzip_conf_t;
 
 
+typedef struct {
+    ngx_uint_t           states;
+} ngx_http_gzip_main_conf_t;
+
+
+typedef struct {
+    ngx_queue_t          queue;
+    z_stream             zstream;
+
+    ngx_int_t            level;
+    int                  wbits;
+    int                  memlevel;
+
+    unsigned             cacheable:1;
+} ngx_http_gzip_state_t;
+
+
+typedef struct {
+    ngx_queue_t          free;
+    ngx_uint_t           nfree;
+
+    ngx_uint_t           created;
+    ngx_uint_t           reused;
+    ngx_uint_t           evicted;
+} ngx_http_gzip_states_t;
+
+
 typedef struct {
     ngx_chain_t         *in;
     ngx_chain_t         *free;
@@ -44,7 +71,7 @@ typedef struct {
     ngx_buf_t           *out_buf;
     ngx_int_t            bufs;
 
-    void                *preallocated;
+    ngx_http_gzip_state_t  *state;
     char                *free_mem;
     ngx_uint_t           allocated;
 
@@ -62,7 +89,7 @@ typedef struct {
     size_t               zout;
 
     uint32_t             crc32;
-    z_stream             zstream;
+    z_stream            *zstream;
     ngx_http_request_t  *request;  /* Ӧrequest */
 } ngx_http_gzip_ctx_t;
 
@@ -106,17 +133,23 @@ static void *ngx_http_gzip_filter_alloc(void *opaque, u_int items,
 static void ngx_http_gzip_filter_free(void *opaque, void *address);
 static void ngx_http_gzip_filter_free_copy_buf(ngx_http_request_t *r,
     ngx_http_gzip_ctx_t *ctx);
+static void ngx_http_gzip_filter_release(ngx_http_gzip_ctx_t *ctx);
+static void ngx_http_gzip_filter_cleanup(void *data);
 
 static ngx_int_t ngx_http_gzip_add_variables(ngx_conf_t *cf);
 static ngx_int_t ngx_http_gzip_ratio_variable(ngx_http_request_t *r,
     ngx_http_variable_value_t *v, uintptr_t data);
 
 static ngx_int_t ngx_http_gzip_filter_init(ngx_conf_t *cf);
+static void *ngx_http_gzip_create_main_conf(ngx_conf_t *cf);
+static char *ngx_http_gzip_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_http_gzip_create_conf(ngx_conf_t *cf);
 static char *ngx_http_gzip_merge_conf(ngx_conf_t *cf,
     void *parent, void *child);
 static char *ngx_http_gzip_window(ngx_conf_t *cf, void *post, void *data);
 static char *ngx_http_gzip_hash(ngx_conf_t *cf, void *post, void *data);
+static ngx_int_t ngx_http_gzip_filter_init_process(ngx_cycle_t *cycle);
+static void ngx_http_gzip_filter_exit_process(ngx_cycle_t *cycle);
 
 
 static ngx_conf_num_bounds_t  ngx_http_gzip_comp_level_bounds = {
@@ -193,6 +226,13 @@ static ngx_command_t  ngx_http_gzip_filter_commands[] = {
       offsetof(ngx_http_gzip_conf_t, min_length),
       NULL },
 
+    { ngx_string("gzip_states"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_gzip_main_conf_t, states),
+      NULL },
+
       ngx_null_command
 };
 
@@ -201,8 +241,8 @@ static ngx_http_module_t  ngx_http_gzip_filter_module_ctx = {
     ngx_http_gzip_add_variables,           /* preconfiguration */
     ngx_http_gzip_filter_init,             /* postconfiguration */
 
-    NULL,                                  /* create main configuration */
-    NULL,                                  /* init main configuration */
+    ngx_http_gzip_create_main_conf,        /* create main configuration */
+    ngx_http_gzip_init_main_conf,          /* init main configuration */
 
     NULL,                                  /* create server configuration */
     NULL,                                  /* merge server configuration */
@@ -219,10 +259,10 @@ ngx_module_t  ngx_http_gzip_filter_module = {
     NGX_HTTP_MODULE,                       /* module type */
     NULL,                                  /* init master */
     NULL,                                  /* init module */
-    NULL,                                  /* init process */
+    ngx_http_gzip_filter_init_process,     /* init process */
     NULL,                                  /* init thread */
     NULL,                                  /* exit thread */
-    NULL,                                  /* exit process */
+    ngx_http_gzip_filter_exit_process,     /* exit process */
     NULL,                                  /* exit master */
     NGX_MODULE_V1_PADDING
 };
@@ -230,6 +270,8 @@ ngx_module_t  ngx_http_gzip_filter_module = {
 
 static ngx_str_t  ngx_http_gzip_ratio = ngx_string("gzip_ratio");
 
+static ngx_http_gzip_states_t  ngx_http_gzip_states;
+
 static ngx_http_output_header_filter_pt  ngx_http_next_header_filter;
 static ngx_http_output_body_filter_pt    ngx_http_next_body_filter;
 
@@ -359,7 +401,7 @@ ngx_http_gzip_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
         }
     }
 
-    if (ctx->preallocated == NULL) {
+    if (ctx->zstream == NULL) {
         if (ngx_http_gzip_filter_deflate_start(r, ctx) != NGX_OK) {
             goto failed;
         }
@@ -475,10 +517,9 @@ failed:
 
     ctx->done = 1;
 
-    if (ctx->preallocated) {
-        deflateEnd(&ctx->zstream);
-
-        ngx_pfree(r->pool, ctx->preallocated);
+    if (ctx->state) {
+        ctx->state->cacheable = 0;
+        ngx_http_gzip_filter_release(ctx);
     }
 
     ngx_http_gzip_filter_free_copy_buf(r, ctx);
@@ -519,8 +560,10 @@ ngx_http_gzip_filter_memory(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
      * We preallocate a memory for zlib in one buffer (200K-400K), this
      * decreases a number of malloc() and free() calls and also probably
      * decreases a number of syscalls (sbrk()/mmap() and so on).
-     * Besides we free the memory as soon as a gzipping will complete
-     * and do not wait while a whole response will be sent to a client.
+     * Besides we release the memory as soon as a gzipping will complete
+     * and do not wait while a whole response will be sent to a client:
+     * the initialized deflate state is kept in a per-worker cache and is
+     * reused by the next response with the same settings.
      *
      * 8K is for zlib deflate_state, it takes
      *  *) 5816 bytes on i386 and sparc64 (32-bit mode)
@@ -603,31 +646,85 @@ static ngx_int_t
 ngx_http_gzip_filter_deflate_start(ngx_http_request_t *r,
     ngx_http_gzip_ctx_t *ctx)
 {
-    int                    rc;
-    ngx_http_gzip_conf_t  *conf;
+    int                     rc;
+    ngx_queue_t            *q;
+    ngx_pool_cleanup_t     *cln;
+    ngx_http_gzip_conf_t   *conf;
+    ngx_http_gzip_state_t  *state;
 
     conf = ngx_http_get_module_loc_conf(r, ngx_http_gzip_filter_module);
 
-    ctx->preallocated = ngx_palloc(r->pool, ctx->allocated);
-    if (ctx->preallocated == NULL) {
+    cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (cln == NULL) {
+        return NGX_ERROR;
+    }
+
+    for (q = ngx_queue_head(&ngx_http_gzip_states.free);
+         q != ngx_queue_sentinel(&ngx_http_gzip_states.free);
+         q = ngx_queue_next(q))
+    {
+        state = ngx_queue_data(q, ngx_http_gzip_state_t, queue);
+
+        if (state->level == conf->level
+            && state->wbits == ctx->wbits
+            && state->memlevel == ctx->memlevel)
+        {
+            ngx_queue_remove(q);
+            ngx_http_gzip_states.nfree--;
+            ngx_http_gzip_states.reused++;
+
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "gzip reuse state: %p", state);
+
+            goto found;
+        }
+    }
+
+    state = ngx_alloc(sizeof(ngx_http_gzip_state_t) + ctx->allocated,
+                      r->connection->log);
+    if (state == NULL) {
         return NGX_ERROR;
     }
 
-    ctx->free_mem = ctx->preallocated;
+    ngx_memzero(&state->zstream, sizeof(z_stream));
 
-    ctx->zstream.zalloc = ngx_http_gzip_filter_alloc;
-    ctx->zstream.zfree = ngx_http_gzip_filter_free;
-    ctx->zstream.opaque = ctx;
+    state->level = conf->level;
+    state->wbits = ctx->wbits;
+    state->memlevel = ctx->memlevel;
+    state->cacheable = 1;
 
-    rc = deflateInit2(&ctx->zstream, (int) conf->level, Z_DEFLATED,
+    ctx->state = state;
+    ctx->free_mem = (char *) &state[1];
+
+    state->zstream.zalloc = ngx_http_gzip_filter_alloc;
+    state->zstream.zfree = ngx_http_gzip_filter_free;
+    state->zstream.opaque = ctx;
+
+    rc = deflateInit2(&state->zstream, (int) conf->level, Z_DEFLATED,
                       - ctx->wbits, ctx->memlevel, Z_DEFAULT_STRATEGY);
 
     if (rc != Z_OK) {
         ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
                       "deflateInit2() failed: %d", rc);
+
+        ngx_free(state);
+        ctx->state = NULL;
+
         return NGX_ERROR;
     }
 
+    ngx_http_gzip_states.created++;
+
+found:
+
+    state->zstream.opaque = ctx;
+
+    ctx->state = state;
+    ctx->zstream = &state->zstream;
+
+    cln->handler = ngx_http_gzip_filter_cleanup;
+    cln->data = ctx;
+
     ctx->last_out = &ctx->out;
     ctx->crc32 = crc32(0L, Z_NULL, 0);
     ctx->flush = Z_NO_FLUSH;
@@ -671,7 +768,7 @@ ngx_http_gzip_filter_gzheader(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 static ngx_int_t
 ngx_http_gzip_filter_add_data(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 {
-    if (ctx->zstream.avail_in || ctx->flush != Z_NO_FLUSH || ctx->redo) {
+    if (ctx->zstream->avail_in || ctx->flush != Z_NO_FLUSH || ctx->redo) {
         return NGX_OK;
     }
 
@@ -702,13 +799,13 @@ ngx_http_gzip_filter_add_data(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 
     ctx->in = ctx->in->next;
 
-    ctx->zstream.next_in = ctx->in_buf->pos;
-    ctx->zstream.avail_in = ctx->in_buf->last - ctx->in_buf->pos;
+    ctx->zstream->next_in = ctx->in_buf->pos;
+    ctx->zstream->avail_in = ctx->in_buf->last - ctx->in_buf->pos;
 
     ngx_log_debug3(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "gzip in_buf:%p ni:%p ai:%ud",
                    ctx->in_buf,
-                   ctx->zstream.next_in, ctx->zstream.avail_in);
+                   ctx->zstream->next_in, ctx->zstream->avail_in);
 
     if (ctx->in_buf->last_buf) {
         ctx->flush = Z_FINISH;
@@ -717,10 +814,10 @@ ngx_http_gzip_filter_add_data(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
         ctx->flush = Z_SYNC_FLUSH;
     }
 
-    if (ctx->zstream.avail_in) {
+    if (ctx->zstream->avail_in) {
 
-        ctx->crc32 = crc32(ctx->crc32, ctx->zstream.next_in,
-                           ctx->zstream.avail_in);
+        ctx->crc32 = crc32(ctx->crc32, ctx->zstream->next_in,
+                           ctx->zstream->avail_in);
 
     } else if (ctx->flush == Z_NO_FLUSH) {
         return NGX_AGAIN;
@@ -735,7 +832,7 @@ ngx_http_gzip_filter_get_buf(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 {
     ngx_http_gzip_conf_t  *conf;
 
-    if (ctx->zstream.avail_out) {
+    if (ctx->zstream->avail_out) {
         return NGX_OK;
     }
 
@@ -761,8 +858,8 @@ ngx_http_gzip_filter_get_buf(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
         return NGX_DECLINED;
     }
 
-    ctx->zstream.next_out = ctx->out_buf->pos;
-    ctx->zstream.avail_out = conf->bufs.size;
+    ctx->zstream->next_out = ctx->out_buf->pos;
+    ctx->zstream->avail_out = conf->bufs.size;
 
     return NGX_OK;
 }
@@ -778,11 +875,11 @@ ngx_http_gzip_filter_deflate(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 
     ngx_log_debug6(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                  "deflate in: ni:%p no:%p ai:%ud ao:%ud fl:%d redo:%d",
-                 ctx->zstream.next_in, ctx->zstream.next_out,
-                 ctx->zstream.avail_in, ctx->zstream.avail_out,
+                 ctx->zstream->next_in, ctx->zstream->next_out,
+                 ctx->zstream->avail_in, ctx->zstream->avail_out,
                  ctx->flush, ctx->redo);
 
-    rc = deflate(&ctx->zstream, ctx->flush);
+    rc = deflate(ctx->zstream, ctx->flush);
 
     if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
         ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
@@ -792,25 +889,25 @@ ngx_http_gzip_filter_deflate(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
 
     ngx_log_debug5(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "deflate out: ni:%p no:%p ai:%ud ao:%ud rc:%d",
-                   ctx->zstream.next_in, ctx->zstream.next_out,
-                   ctx->zstream.avail_in, ctx->zstream.avail_out,
+                   ctx->zstream->next_in, ctx->zstream->next_out,
+                   ctx->zstream->avail_in, ctx->zstream->avail_out,
                    rc);
 
     ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "gzip in_buf:%p pos:%p",
                    ctx->in_buf, ctx->in_buf->pos);
 
-    if (ctx->zstream.next_in) {
-        ctx->in_buf->pos = ctx->zstream.next_in;
+    if (ctx->zstream->next_in) {
+        ctx->in_buf->pos = ctx->zstream->next_in;
 
-        if (ctx->zstream.avail_in == 0) {
-            ctx->zstream.next_in = NULL;
+        if (ctx->zstream->avail_in == 0) {
+            ctx->zstream->next_in = NULL;
         }
     }
 
-    ctx->out_buf->last = ctx->zstream.next_out;
+    ctx->out_buf->last = ctx->zstream->next_out;
 
-    if (ctx->zstream.avail_out == 0) {
+    if (ctx->zstream->avail_out == 0) {
 
         /* zlib wants to output some more gzipped data */
 
@@ -850,7 +947,7 @@ ngx_http_gzip_filter_deflate(ngx_http_request_t *r, ngx_http_gzip_ctx_t *ctx)
             }
 
         } else {
-            ctx->zstream.avail_out = 0;
+            ctx->zstream->avail_out = 0;
         }
 
         b->flush = 1;
@@ -899,23 +996,17 @@ static ngx_int_t
 ngx_http_gzip_filter_deflate_end(ngx_http_request_t *r,
     ngx_http_gzip_ctx_t *ctx)
 {
-    int                rc;
+    uInt               avail_out;
     ngx_buf_t         *b;
     ngx_chain_t       *cl;
     struct gztrailer  *trailer;
 
-    ctx->zin = ctx->zstream.total_in;
-    ctx->zout = 10 + ctx->zstream.total_out + 8;
-
-    rc = deflateEnd(&ctx->zstream);
+    ctx->zin = ctx->zstream->total_in;
+    ctx->zout = 10 + ctx->zstream->total_out + 8;
 
-    if (rc != Z_OK) {
-        ngx_log_error(NGX_LOG_ALERT, r->connection->log, 0,
-                      "deflateEnd() failed: %d", rc);
-        return NGX_ERROR;
-    }
+    avail_out = ctx->zstream->avail_out;
 
-    ngx_pfree(r->pool, ctx->preallocated);
+    ngx_http_gzip_filter_release(ctx);
 
     cl = ngx_alloc_chain_link(r->pool);
     if (cl == NULL) {
@@ -927,7 +1018,7 @@ ngx_http_gzip_filter_deflate_end(ngx_http_request_t *r,
     *ctx->last_out = cl;
     ctx->last_out = &cl->next;
 
-    if (ctx->zstream.avail_out >= 8) {
+    if (avail_out >= 8) {
         trailer = (struct gztrailer *) ctx->out_buf->last;
         ctx->out_buf->last += 8;
         ctx->out_buf->last_buf = 1;
@@ -972,9 +1063,6 @@ ngx_http_gzip_filter_deflate_end(ngx_http_request_t *r,
 
 #endif
 
-    ctx->zstream.avail_in = 0;
-    ctx->zstream.avail_out = 0;
-
     ctx->done = 1;
 
     r->connection->buffered &= ~NGX_HTTP_GZIP_BUFFERED;
@@ -1019,6 +1107,10 @@ ngx_http_gzip_filter_alloc(void *opaque, u_int items, u_int size)
                   "gzip filter failed to use preallocated memory: %ud of %ud",
                   items * size, ctx->allocated);
 
+    /* the state refers to the request pool and cannot be cached */
+
+    ctx->state->cacheable = 0;
+
     p = ngx_palloc(ctx->request->pool, items * size);
 
     return p;
@@ -1051,6 +1143,70 @@ ngx_http_gzip_filter_free_copy_buf(ngx_http_request_t *r,
 }
 
 
+static void
+ngx_http_gzip_filter_release(ngx_http_gzip_ctx_t *ctx)
+{
+    ngx_queue_t                *q;
+    ngx_http_gzip_state_t      *state, *old;
+    ngx_http_gzip_main_conf_t  *gmcf;
+
+    state = ctx->state;
+    ctx->state = NULL;
+    ctx->zstream = NULL;
+
+    gmcf = ngx_http_get_module_main_conf(ctx->request,
+                                         ngx_http_gzip_filter_module);
+
+    if (state->cacheable
+        && gmcf->states
+        && deflateReset(&state->zstream) == Z_OK)
+    {
+        state->zstream.next_in = NULL;
+        state->zstream.avail_in = 0;
+        state->zstream.next_out = NULL;
+        state->zstream.avail_out = 0;
+
+        if (ngx_http_gzip_states.nfree == gmcf->states) {
+
+            /* evict the least recently used state */
+
+            q = ngx_queue_last(&ngx_http_gzip_states.free);
+            ngx_queue_remove(q);
+
+            old = ngx_queue_data(q, ngx_http_gzip_state_t, queue);
+
+            (void) deflateEnd(&old->zstream);
+            ngx_free(old);
+
+            ngx_http_gzip_states.evicted++;
+
+        } else {
+            ngx_http_gzip_states.nfree++;
+        }
+
+        ngx_queue_insert_head(&ngx_http_gzip_states.free, &state->queue);
+
+        return;
+    }
+
+    (void) deflateEnd(&state->zstream);
+    ngx_free(state);
+}
+
+
+static void
+ngx_http_gzip_filter_cleanup(void *data)
+{
+    ngx_http_gzip_ctx_t *ctx = data;
+
+    /* the request was finalized before the end of the response */
+
+    if (ctx->state) {
+        ngx_http_gzip_filter_release(ctx);
+    }
+}
+
+
 static ngx_int_t
 ngx_http_gzip_add_variables(ngx_conf_t *cf)
 {
@@ -1111,6 +1267,33 @@ ngx_http_gzip_ratio_variable(ngx_http_request_t *r,
 }
 
 
+static void *
+ngx_http_gzip_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_http_gzip_main_conf_t  *gmcf;
+
+    gmcf = ngx_palloc(cf->pool, sizeof(ngx_http_gzip_main_conf_t));
+    if (gmcf == NULL) {
+        return NULL;
+    }
+
+    gmcf->states = NGX_CONF_UNSET_UINT;
+
+    return gmcf;
+}
+
+
+static char *
+ngx_http_gzip_init_main_conf(ngx_conf_t *cf, void *conf)
+{
+    ngx_http_gzip_main_conf_t *gmcf = conf;
+
+    ngx_conf_init_uint_value(gmcf->states, 16);
+
+    return NGX_CONF_OK;
+}
+
+
 static void *
 ngx_http_gzip_create_conf(ngx_conf_t *cf)
 {
@@ -1233,3 +1416,41 @@ ngx_http_gzip_hash(ngx_conf_t *cf, void *post, void *data)
 
     return "must be 512, 1k, 2k, 4k, 8k, 16k, 32k, 64k, or 128k";
 }
+
+
+static ngx_int_t
+ngx_http_gzip_filter_init_process(ngx_cycle_t *cycle)
+{
+    ngx_queue_init(&ngx_http_gzip_states.free);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_gzip_filter_exit_process(ngx_cycle_t *cycle)
+{
+    ngx_queue_t            *q;
+    ngx_http_gzip_state_t  *state;
+
+    if (ngx_http_gzip_states.created == 0) {
+        return;
+    }
+
+    ngx_log_error(NGX_LOG_INFO, cycle->log, 0,
+                  "gzip states: %ui created, %ui reused, %ui evicted",
+                  ngx_http_gzip_states.created, ngx_http_gzip_states.reused,
+                  ngx_http_gzip_states.evicted);
+
+    while (!ngx_queue_empty(&ngx_http_gzip_states.free)) {
+        q = ngx_queue_head(&ngx_http_gzip_states.free);
+        ngx_queue_remove(q);
+
+        state = ngx_queue_data(q, ngx_http_gzip_state_t, queue);
+
+        (void) deflateEnd(&state->zstream);
+        ngx_free(state);
+    }
+
+    ngx_http_gzip_states.nfree = 0;
+}
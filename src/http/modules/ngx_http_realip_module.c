@@ -17,11 +17,12 @@
 
 
 typedef struct {
-    ngx_array_t       *from;     /* array of ngx_cidr_t */
-    ngx_uint_t         type;
-    ngx_uint_t         hash;
-    ngx_str_t          header;
-    ngx_flag_t         recursive;
+    ngx_array_t         *from;     /* array of ngx_cidr_t */
+    ngx_http_proxies_t  *proxies;
+    ngx_uint_t           type;
+    ngx_uint_t           hash;
+    ngx_str_t            header;
+    ngx_flag_t           recursive;
 } ngx_http_realip_loc_conf_t;
 
 
@@ -212,7 +213,7 @@ found:
     addr.socklen = c->socklen;
     /* addr.name = c->addr_text; */
 
-    if (ngx_http_get_forwarded_addr(r, &addr, xfwd, value, rlcf->from,
+    if (ngx_http_get_forwarded_addr(r, &addr, xfwd, value, rlcf->proxies,
                                     rlcf->recursive)
         != NGX_DECLINED)
     {
@@ -383,6 +384,7 @@ ngx_http_realip_create_loc_conf(ngx_conf_t *cf)
      * set by ngx_pcalloc():
      *
      *     conf->from = NULL;
+     *     conf->proxies = NULL;
      *     conf->hash = 0;
      *     conf->header = { 0, NULL };
      */
@@ -401,7 +403,22 @@ ngx_http_realip_merge_loc_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_http_realip_loc_conf_t  *conf = child;
 
     if (conf->from == NULL) {
+
+        if (prev->from && prev->proxies == NULL) {
+            prev->proxies = ngx_http_proxies_create(cf, prev->from);
+            if (prev->proxies == NULL) {
+                return NGX_CONF_ERROR;
+            }
+        }
+
         conf->from = prev->from;
+        conf->proxies = prev->proxies;
+
+    } else {
+        conf->proxies = ngx_http_proxies_create(cf, conf->from);
+        if (conf->proxies == NULL) {
+            return NGX_CONF_ERROR;
+        }
     }
 
     ngx_conf_merge_uint_value(conf->type, prev->type, NGX_HTTP_REALIP_XREALIP);
@@ -47,6 +47,8 @@ static char *ngx_http_ssl_password_file(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static char *ngx_http_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_http_ssl_handshake_threads(ngx_conf_t *cf,
+    ngx_command_t *cmd, void *conf);
 
 static ngx_int_t ngx_http_ssl_init(ngx_conf_t *cf);
 
@@ -170,8 +172,22 @@ static ngx_command_t  ngx_http_ssl_commands[] = {
       offsetof(ngx_http_ssl_srv_conf_t, prefer_server_ciphers),
       NULL },
 
+    { ngx_string("ssl_ktls"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_ssl_srv_conf_t, ktls),
+      NULL },
+
+    { ngx_string("ssl_handshake_threads"),
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_CONF_TAKE1,
+      ngx_http_ssl_handshake_threads,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      0,
+      NULL },
+
     { ngx_string("ssl_session_cache"),
-      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_CONF_TAKE12,
+      NGX_HTTP_MAIN_CONF|NGX_HTTP_SRV_CONF|NGX_CONF_TAKE123,
       ngx_http_ssl_session_cache,
       NGX_HTTP_SRV_CONF_OFFSET,
       0,
@@ -326,10 +342,10 @@ ngx_http_ssl_alpn_select(ngx_ssl_conn_t *ssl_conn, const unsigned char **out,
 #if (NGX_DEBUG)
     unsigned int            i;
 #endif
-#if (NGX_HTTP_SPDY)
+#if (NGX_HTTP_V2)
     ngx_http_connection_t  *hc;
 #endif
-#if (NGX_HTTP_SPDY || NGX_DEBUG)
+#if (NGX_HTTP_V2 || NGX_DEBUG)
     ngx_connection_t       *c;
 
     c = ngx_ssl_get_connection(ssl_conn);
@@ -342,12 +358,12 @@ ngx_http_ssl_alpn_select(ngx_ssl_conn_t *ssl_conn, const unsigned char **out,
     }
 #endif
 
-#if (NGX_HTTP_SPDY)
+#if (NGX_HTTP_V2)
     hc = c->data;
 
-    if (hc->addr_conf->spdy) {
-        srv = (unsigned char *) NGX_SPDY_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE;
-        srvlen = sizeof(NGX_SPDY_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE) - 1;
+    if (hc->addr_conf->http2) {
+        srv = (unsigned char *) NGX_HTTP_V2_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE;
+        srvlen = sizeof(NGX_HTTP_V2_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE) - 1;
 
     } else
 #endif
@@ -378,22 +394,22 @@ static int
 ngx_http_ssl_npn_advertised(ngx_ssl_conn_t *ssl_conn,
     const unsigned char **out, unsigned int *outlen, void *arg)
 {
-#if (NGX_HTTP_SPDY || NGX_DEBUG)
+#if (NGX_HTTP_V2 || NGX_DEBUG)
     ngx_connection_t  *c;
 
     c = ngx_ssl_get_connection(ssl_conn);
     ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "SSL NPN advertised");
 #endif
 
-#if (NGX_HTTP_SPDY)
+#if (NGX_HTTP_V2)
     {
     ngx_http_connection_t  *hc;
 
     hc = c->data;
 
-    if (hc->addr_conf->spdy) {
-        *out = (unsigned char *) NGX_SPDY_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE;
-        *outlen = sizeof(NGX_SPDY_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE) - 1;
+    if (hc->addr_conf->http2) {
+        *out = (unsigned char *) NGX_HTTP_V2_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE;
+        *outlen = sizeof(NGX_HTTP_V2_NPN_ADVERTISE NGX_HTTP_NPN_ADVERTISE) - 1;
 
         return SSL_TLSEXT_ERR_OK;
     }
@@ -520,6 +536,10 @@ ngx_http_ssl_create_srv_conf(ngx_conf_t *cf)
 
     sscf->enable = NGX_CONF_UNSET;
     sscf->prefer_server_ciphers = NGX_CONF_UNSET;
+    sscf->ktls = NGX_CONF_UNSET;
+#if (NGX_THREADS)
+    sscf->handshake_pool = NGX_CONF_UNSET_PTR;
+#endif
     sscf->buffer_size = NGX_CONF_UNSET_SIZE;
     sscf->verify = NGX_CONF_UNSET_UINT;
     sscf->verify_depth = NGX_CONF_UNSET_UINT;
@@ -560,6 +580,12 @@ ngx_http_ssl_merge_srv_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_conf_merge_value(conf->prefer_server_ciphers,
                          prev->prefer_server_ciphers, 0);
 
+    ngx_conf_merge_value(conf->ktls, prev->ktls, 0);
+
+#if (NGX_THREADS)
+    ngx_conf_merge_ptr_value(conf->handshake_pool, prev->handshake_pool, NULL);
+#endif
+
     ngx_conf_merge_bitmask_value(conf->protocols, prev->protocols,
                          (NGX_CONF_BITMASK_SET|NGX_SSL_TLSv1
                           |NGX_SSL_TLSv1_1|NGX_SSL_TLSv1_2));
@@ -715,6 +741,22 @@ ngx_http_ssl_merge_srv_conf(ngx_conf_t *cf, void *parent, void *child)
         SSL_CTX_set_options(conf->ssl.ctx, SSL_OP_CIPHER_SERVER_PREFERENCE);
     }
 
+    if (conf->ktls) {
+        if (ngx_ssl_ktls(cf, &conf->ssl) != NGX_OK) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+#if (NGX_THREADS)
+    if (conf->handshake_pool) {
+        if (ngx_ssl_handshake_threads(cf, &conf->ssl, conf->handshake_pool)
+            != NGX_OK)
+        {
+            return NGX_CONF_ERROR;
+        }
+    }
+#endif
+
 #ifndef LIBRESSL_VERSION_NUMBER
     /* a temporary 512-bit RSA key is required for export versions of MSIE */
     SSL_CTX_set_tmp_rsa_callback(conf->ssl.ctx, ngx_ssl_rsa512_key_callback);
@@ -826,10 +868,12 @@ ngx_http_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     size_t       len;
     ngx_str_t   *value, name, size;
     ngx_int_t    n;
-    ngx_uint_t   i, j;
+    ngx_uint_t   i, j, shards;
 
     value = cf->args->elts;
 
+    shards = 0;
+
     for (i = 1; i < cf->args->nelts; i++) {
 
         if (ngx_strcmp(value[i].data, "off") == 0) {
@@ -863,6 +907,19 @@ ngx_http_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             continue;
         }
 
+        if (ngx_strncmp(value[i].data, "shards=", 7) == 0) {
+
+            n = ngx_atoi(value[i].data + 7, value[i].len - 7);
+
+            if (n < 1 || n > NGX_SSL_MAX_SCACHE_SHARDS) {
+                goto invalid;
+            }
+
+            shards = n;
+
+            continue;
+        }
+
         if (value[i].len > sizeof("shared:") - 1
             && ngx_strncmp(value[i].data, "shared:", sizeof("shared:") - 1)
                == 0)
@@ -915,6 +972,20 @@ ngx_http_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         goto invalid;
     }
 
+    if (sscf->shm_zone == NULL) {
+
+        if (shards) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "\"shards\" requires a shared session cache");
+            return NGX_CONF_ERROR;
+        }
+
+    } else if (ngx_ssl_session_cache_shards(cf, sscf->shm_zone, shards)
+               != NGX_OK)
+    {
+        return NGX_CONF_ERROR;
+    }
+
     if (sscf->shm_zone && sscf->builtin_session_cache == NGX_CONF_UNSET) {
         sscf->builtin_session_cache = NGX_SSL_NO_BUILTIN_SCACHE;
     }
@@ -930,6 +1001,67 @@ invalid:
 }
 
 
+static char *
+ngx_http_ssl_handshake_threads(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_ssl_srv_conf_t *sscf = conf;
+
+    ngx_str_t  *value;
+
+#if (NGX_THREADS)
+    ngx_str_t   name;
+
+    if (sscf->handshake_pool != NGX_CONF_UNSET_PTR) {
+        return "is duplicate";
+    }
+#endif
+
+    value = cf->args->elts;
+
+    if (ngx_strcmp(value[1].data, "off") == 0) {
+#if (NGX_THREADS)
+        sscf->handshake_pool = NULL;
+#endif
+        return NGX_CONF_OK;
+    }
+
+    if (ngx_strcmp(value[1].data, "on") != 0
+        && ngx_strncmp(value[1].data, "pool=", 5) != 0)
+    {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "invalid value \"%V\"", &value[1]);
+        return NGX_CONF_ERROR;
+    }
+
+#if (NGX_THREADS)
+
+    if (value[1].data[0] == 'p') {
+        name.len = value[1].len - 5;
+        name.data = value[1].data + 5;
+
+        sscf->handshake_pool = ngx_thread_pool_add(cf, &name);
+
+    } else {
+        sscf->handshake_pool = ngx_thread_pool_add(cf, NULL);
+    }
+
+    if (sscf->handshake_pool == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    return NGX_CONF_OK;
+
+#else
+
+    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                       "\"ssl_handshake_threads\" "
+                       "is unsupported on this platform");
+    return NGX_CONF_ERROR;
+
+#endif
+}
+
+
 static ngx_int_t
 ngx_http_ssl_init(ngx_conf_t *cf)
 {
@@ -938,10 +1070,28 @@ ngx_http_ssl_init(ngx_conf_t *cf)
     ngx_http_core_loc_conf_t    *clcf;
     ngx_http_core_srv_conf_t   **cscfp;
     ngx_http_core_main_conf_t   *cmcf;
+#if (NGX_THREADS)
+    ngx_uint_t                   threads;
+#endif
 
     cmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_core_module);
     cscfp = cmcf->servers.elts;
 
+#if (NGX_THREADS)
+
+    threads = 0;
+
+    for (s = 0; s < cmcf->servers.nelts; s++) {
+        sscf = cscfp[s]->ctx->srv_conf[ngx_http_ssl_module.ctx_index];
+
+        if (sscf->ssl.ctx && sscf->handshake_pool) {
+            threads = 1;
+            break;
+        }
+    }
+
+#endif
+
     for (s = 0; s < cmcf->servers.nelts; s++) {
 
         sscf = cscfp[s]->ctx->srv_conf[ngx_http_ssl_module.ctx_index];
@@ -950,6 +1100,22 @@ ngx_http_ssl_init(ngx_conf_t *cf)
             continue;
         }
 
+#if (NGX_THREADS)
+
+        /*
+         * the stapling callback starts OCSP requests in the event loop,
+         * and SNI may switch a threaded handshake to any server
+         */
+
+        if (threads) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "\"ssl_stapling\" cannot be used "
+                          "with \"ssl_handshake_threads\"");
+            return NGX_ERROR;
+        }
+
+#endif
+
         clcf = cscfp[s]->ctx->loc_conf[ngx_http_core_module.ctx_index];
 
         if (ngx_ssl_stapling_resolver(cf, &sscf->ssl, clcf->resolver,
@@ -20,6 +20,11 @@ typedef struct {
     ngx_ssl_t                       ssl;
 
     ngx_flag_t                      prefer_server_ciphers;
+    ngx_flag_t                      ktls;
+
+#if (NGX_THREADS)
+    ngx_thread_pool_t              *handshake_pool;
+#endif
 
     ngx_uint_t                      protocols;
 
@@ -0,0 +1,1344 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+#include <nginx.h>
+
+
+/*
+ * Each worker updates its own slot in the status zone, so the counters
+ * are incremented without atomic operations; the status handler sums
+ * the slots of all workers.  The slots are aligned to the cache line
+ * size to avoid false sharing between workers.
+ *
+ * The counters of upstream peers are indexed by the peer id.  Upstreams
+ * in a shared zone reserve room for peers added at run time, and since
+ * ids of removed peers are reused, the counters carry the version of
+ * the peer they belong to.
+ */
+
+
+#define NGX_HTTP_STATUS_ZONE_PEERS  64
+
+
+typedef struct {
+    ngx_atomic_uint_t              requests;
+    ngx_atomic_uint_t              responses[5];
+    ngx_atomic_uint_t              received;
+    ngx_atomic_uint_t              sent;
+} ngx_http_status_server_t;
+
+
+typedef struct {
+    ngx_atomic_uint_t              requests;
+    ngx_atomic_uint_t              responses[5];
+    ngx_atomic_uint_t              fails;
+    ngx_atomic_uint_t              received;
+    ngx_atomic_uint_t              cached;
+    ngx_atomic_uint_t              response_time;   /* EWMA, usec */
+    ngx_atomic_uint_t              version;
+} ngx_http_status_peer_t;
+
+
+#if (NGX_HTTP_UPSTREAM_ZONE)
+#define ngx_http_status_peer_version(peer)  (peer)->version
+#else
+#define ngx_http_status_peer_version(peer)  0
+#endif
+
+
+#if (NGX_HTTP_CACHE)
+
+#define NGX_HTTP_STATUS_CACHE_STATES  (NGX_HTTP_CACHE_SCARCE + 1)
+
+typedef struct {
+    ngx_atomic_uint_t              states[NGX_HTTP_STATUS_CACHE_STATES];
+    ngx_atomic_uint_t              sent;
+} ngx_http_status_cache_t;
+
+#endif
+
+
+typedef struct {
+    ngx_shm_zone_t                *shm_zone;
+    ngx_cycle_t                   *cycle;
+
+    ngx_array_t                    servers;     /* of ngx_str_t */
+    ngx_array_t                    upstreams;   /* of srv_conf_t * */
+    ngx_uint_t                     npeers;
+#if (NGX_HTTP_CACHE)
+    ngx_array_t                    caches;      /* of file_cache_t * */
+#endif
+
+    size_t                         peers_offset;
+    size_t                         caches_offset;
+    size_t                         threads_offset;
+    size_t                         slot_size;
+
+    ngx_uint_t                     workers;
+    u_char                        *slots;
+} ngx_http_status_main_conf_t;
+
+
+typedef struct {
+    ngx_uint_t                     index;
+    ngx_uint_t                     npeers;
+} ngx_http_status_srv_conf_t;
+
+
+static ngx_int_t ngx_http_status_handler(ngx_http_request_t *r);
+static u_char *ngx_http_status_escape(u_char *dst, ngx_str_t *src);
+static u_char *ngx_http_status_servers(ngx_http_status_main_conf_t *smcf,
+    u_char *p);
+static u_char *ngx_http_status_upstreams(ngx_http_status_main_conf_t *smcf,
+    u_char *p, ngx_uint_t npeers);
+#if (NGX_HTTP_CACHE)
+static u_char *ngx_http_status_caches(ngx_http_status_main_conf_t *smcf,
+    u_char *p);
+#endif
+#if (NGX_HTTP_SSL)
+static ngx_ssl_session_cache_t *ngx_http_status_ssl_cache(
+    ngx_shm_zone_t *shm_zone);
+static size_t ngx_http_status_ssl_size(void);
+static u_char *ngx_http_status_ssl_session_caches(u_char *p);
+#endif
+#if (NGX_THREADS)
+static size_t ngx_http_status_thread_pools_size(void);
+static u_char *ngx_http_status_thread_pools(ngx_http_status_main_conf_t *smcf,
+    u_char *p);
+#endif
+static ngx_int_t ngx_http_status_log_handler(ngx_http_request_t *r);
+static void ngx_http_status_log_upstream(ngx_http_request_t *r,
+    ngx_http_status_main_conf_t *smcf, u_char *slot);
+static ngx_int_t ngx_http_status_init_zone(ngx_shm_zone_t *shm_zone,
+    void *data);
+
+static void *ngx_http_status_create_main_conf(ngx_conf_t *cf);
+static void *ngx_http_status_create_srv_conf(ngx_conf_t *cf);
+static char *ngx_http_status_zone(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+static char *ngx_http_status(ngx_conf_t *cf, ngx_command_t *cmd, void *conf);
+static ngx_int_t ngx_http_status_init(ngx_conf_t *cf);
+#if (NGX_THREADS)
+static ngx_int_t ngx_http_status_init_worker(ngx_cycle_t *cycle);
+#else
+#define ngx_http_status_init_worker  NULL
+#endif
+
+
+static ngx_command_t  ngx_http_status_commands[] = {
+
+    { ngx_string("status_zone"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE2,
+      ngx_http_status_zone,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("status"),
+      NGX_HTTP_SRV_CONF|NGX_HTTP_LOC_CONF|NGX_CONF_NOARGS,
+      ngx_http_status,
+      0,
+      0,
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_status_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    ngx_http_status_init,                  /* postconfiguration */
+
+    ngx_http_status_create_main_conf,      /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    ngx_http_status_create_srv_conf,       /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_status_module = {
+    NGX_MODULE_V1,
+    &ngx_http_status_module_ctx,           /* module context */
+    ngx_http_status_commands,              /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    ngx_http_status_init_worker,           /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+#define ngx_http_status_slot(smcf, n)  ((smcf)->slots + (n) * (smcf)->slot_size)
+
+#define ngx_http_status_sum(smcf, type, offset, field, sum)                   \
+    {                                                                         \
+        ngx_uint_t  w_;                                                       \
+                                                                              \
+        sum = 0;                                                              \
+                                                                              \
+        for (w_ = 0; w_ < (smcf)->workers; w_++) {                            \
+            sum += ((type *) (ngx_http_status_slot(smcf, w_) + offset))       \
+                   ->field;                                                   \
+        }                                                                     \
+    }
+
+
+static ngx_int_t
+ngx_http_status_handler(ngx_http_request_t *r)
+{
+    size_t                         size;
+    ngx_int_t                      rc;
+    ngx_buf_t                     *b;
+    ngx_uint_t                     i, npeers;
+    ngx_str_t                     *name;
+    ngx_chain_t                    out;
+    ngx_http_upstream_rr_peers_t  *peers;
+    ngx_http_upstream_srv_conf_t **uscfp;
+    ngx_http_status_main_conf_t   *smcf;
+
+    if (r->method != NGX_HTTP_GET && r->method != NGX_HTTP_HEAD) {
+        return NGX_HTTP_NOT_ALLOWED;
+    }
+
+    rc = ngx_http_discard_request_body(r);
+
+    if (rc != NGX_OK) {
+        return rc;
+    }
+
+    smcf = ngx_http_get_module_main_conf(r, ngx_http_status_module);
+
+    if (smcf->slots == NULL) {
+        return NGX_HTTP_SERVICE_UNAVAILABLE;
+    }
+
+    r->headers_out.content_type_len = sizeof("application/json") - 1;
+    ngx_str_set(&r->headers_out.content_type, "application/json");
+    r->headers_out.content_type_lowcase = NULL;
+
+    if (r->method == NGX_HTTP_HEAD) {
+        r->headers_out.status = NGX_HTTP_OK;
+
+        rc = ngx_http_send_header(r);
+
+        if (rc == NGX_ERROR || rc > NGX_OK || r->header_only) {
+            return rc;
+        }
+    }
+
+    /* the names are escaped, so they take twice their length at most */
+
+    size = sizeof("{\"version\":1,\"nginx_version\":\"" NGINX_VERSION "\","
+                  "\"pid\":,\"server_zones\":{},\"upstreams\":{},"
+                  "\"caches\":{}}" CRLF)
+           + NGX_INT64_LEN;
+
+    name = smcf->servers.elts;
+
+    for (i = 0; i < smcf->servers.nelts; i++) {
+        size += 2 * name[i].len
+                + sizeof("\"\":{\"requests\":,\"responses\":{\"1xx\":,"
+                         "\"2xx\":,\"3xx\":,\"4xx\":,\"5xx\":,\"total\":},"
+                         "\"received\":,\"sent\":},")
+                + 9 * NGX_ATOMIC_T_LEN;
+    }
+
+    npeers = 0;
+    uscfp = smcf->upstreams.elts;
+
+    for (i = 0; i < smcf->upstreams.nelts; i++) {
+        size += 2 * uscfp[i]->host.len + sizeof("\"\":[],");
+
+        for (peers = uscfp[i]->peer.data; peers; peers = peers->next) {
+            ngx_http_upstream_rr_peers_rlock(peers);
+            npeers += peers->number;
+            ngx_http_upstream_rr_peers_unlock(peers);
+        }
+    }
+
+    size += npeers
+            * (2 * NGX_SOCKADDR_STRLEN
+               + sizeof("{\"server\":\"\",\"backup\":false,"
+                        "\"state\":\"unhealthy\",\"active\":,"
+                        "\"requests\":,\"responses\":{\"1xx\":,\"2xx\":,"
+                        "\"3xx\":,\"4xx\":,\"5xx\":,\"total\":},"
+                        "\"fails\":,\"received\":,\"response_time\":,"
+                        "\"keepalive\":{\"hits\":,\"misses\":}},")
+               + 13 * NGX_ATOMIC_T_LEN);
+
+#if (NGX_HTTP_CACHE)
+    {
+    ngx_http_file_cache_t  **cache;
+
+    cache = smcf->caches.elts;
+
+    for (i = 0; i < smcf->caches.nelts; i++) {
+        size += 2 * cache[i]->shm_zone->shm.name.len
+                + sizeof("\"\":{\"miss\":,\"bypass\":,\"expired\":,"
+                         "\"stale\":,\"updating\":,\"revalidated\":,"
+                         "\"hit\":,\"scarce\":,\"sent\":},")
+                + 9 * NGX_ATOMIC_T_LEN;
+    }
+    }
+#endif
+
+#if (NGX_HTTP_SSL)
+    size += ngx_http_status_ssl_size();
+#endif
+
+#if (NGX_THREADS)
+    size += ngx_http_status_thread_pools_size();
+#endif
+
+    b = ngx_create_temp_buf(r->pool, size);
+    if (b == NULL) {
+        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    out.buf = b;
+    out.next = NULL;
+
+    b->last = ngx_sprintf(b->last, "{\"version\":1,\"nginx_version\":\""
+                          NGINX_VERSION "\",\"pid\":%P,", ngx_pid);
+
+    b->last = ngx_http_status_servers(smcf, b->last);
+    *b->last++ = ',';
+
+    b->last = ngx_http_status_upstreams(smcf, b->last, npeers);
+
+#if (NGX_HTTP_CACHE)
+    *b->last++ = ',';
+    b->last = ngx_http_status_caches(smcf, b->last);
+#else
+    b->last = ngx_cpymem(b->last, ",\"caches\":{}",
+                         sizeof(",\"caches\":{}") - 1);
+#endif
+
+#if (NGX_HTTP_SSL)
+    *b->last++ = ',';
+    b->last = ngx_http_status_ssl_session_caches(b->last);
+#endif
+
+#if (NGX_THREADS)
+    *b->last++ = ',';
+    b->last = ngx_http_status_thread_pools(smcf, b->last);
+#endif
+
+    *b->last++ = '}';
+    *b->last++ = CR; *b->last++ = LF;
+
+    r->headers_out.status = NGX_HTTP_OK;
+    r->headers_out.content_length_n = b->last - b->pos;
+
+    b->last_buf = (r == r->main) ? 1 : 0;
+    b->last_in_chain = 1;
+
+    rc = ngx_http_send_header(r);
+
+    if (rc == NGX_ERROR || rc > NGX_OK || r->header_only) {
+        return rc;
+    }
+
+    return ngx_http_output_filter(r, &out);
+}
+
+
+static u_char *
+ngx_http_status_escape(u_char *dst, ngx_str_t *src)
+{
+    u_char      ch;
+    ngx_uint_t  i;
+
+    for (i = 0; i < src->len; i++) {
+        ch = src->data[i];
+
+        if (ch < 0x20) {
+            continue;
+        }
+
+        if (ch == '"' || ch == '\\') {
+            *dst++ = '\\';
+        }
+
+        *dst++ = ch;
+    }
+
+    return dst;
+}
+
+
+static u_char *
+ngx_http_status_servers(ngx_http_status_main_conf_t *smcf, u_char *p)
+{
+    size_t              offset;
+    ngx_str_t          *name;
+    ngx_uint_t          i, n;
+    ngx_atomic_uint_t   requests, received, sent, total, responses[5];
+
+    p = ngx_cpymem(p, "\"server_zones\":{", sizeof("\"server_zones\":{") - 1);
+
+    name = smcf->servers.elts;
+
+    for (i = 0; i < smcf->servers.nelts; i++) {
+        offset = i * sizeof(ngx_http_status_server_t);
+
+        ngx_http_status_sum(smcf, ngx_http_status_server_t, offset,
+                            requests, requests);
+        ngx_http_status_sum(smcf, ngx_http_status_server_t, offset,
+                            received, received);
+        ngx_http_status_sum(smcf, ngx_http_status_server_t, offset,
+                            sent, sent);
+
+        total = 0;
+
+        for (n = 0; n < 5; n++) {
+            ngx_http_status_sum(smcf, ngx_http_status_server_t, offset,
+                                responses[n], responses[n]);
+            total += responses[n];
+        }
+
+        if (i) {
+            *p++ = ',';
+        }
+
+        *p++ = '"';
+        p = ngx_http_status_escape(p, &name[i]);
+
+        p = ngx_sprintf(p, "\":{\"requests\":%uA,\"responses\":{"
+                        "\"1xx\":%uA,\"2xx\":%uA,\"3xx\":%uA,\"4xx\":%uA,"
+                        "\"5xx\":%uA,\"total\":%uA},"
+                        "\"received\":%uA,\"sent\":%uA}",
+                        requests, responses[0], responses[1], responses[2],
+                        responses[3], responses[4], total, received, sent);
+    }
+
+    *p++ = '}';
+
+    return p;
+}
+
+
+static u_char *
+ngx_http_status_upstreams(ngx_http_status_main_conf_t *smcf, u_char *p,
+    ngx_uint_t npeers)
+{
+    char                          *state;
+    ngx_uint_t                     i, n, w, backup;
+    ngx_atomic_uint_t              total, rt, weight;
+    ngx_http_status_peer_t        *sp, sum;
+    ngx_http_upstream_rr_peer_t   *peer;
+    ngx_http_upstream_rr_peers_t  *peers;
+    ngx_http_status_srv_conf_t    *sscf;
+    ngx_http_upstream_srv_conf_t **uscfp;
+
+    p = ngx_cpymem(p, "\"upstreams\":{", sizeof("\"upstreams\":{") - 1);
+
+    uscfp = smcf->upstreams.elts;
+
+    for (i = 0; i < smcf->upstreams.nelts; i++) {
+
+        sscf = ngx_http_conf_upstream_srv_conf(uscfp[i],
+                                               ngx_http_status_module);
+
+        if (i) {
+            *p++ = ',';
+        }
+
+        *p++ = '"';
+        p = ngx_http_status_escape(p, &uscfp[i]->host);
+        p = ngx_cpymem(p, "\":[", 3);
+
+        backup = 0;
+
+        for (peers = uscfp[i]->peer.data; peers; peers = peers->next) {
+
+            ngx_http_upstream_rr_peers_rlock(peers);
+
+            /* the buffer was sized for the peers counted before */
+
+            for (peer = peers->peer; peer && npeers; peer = peer->next) {
+
+                npeers--;
+
+                ngx_memzero(&sum, sizeof(ngx_http_status_peer_t));
+
+                /* the workers' averages weighted by their request counts */
+
+                rt = 0;
+                weight = 0;
+
+                for (w = 0; w < smcf->workers; w++) {
+
+                    if (peer->id >= sscf->npeers) {
+                        break;
+                    }
+
+                    sp = (ngx_http_status_peer_t *)
+                             (ngx_http_status_slot(smcf, w)
+                              + smcf->peers_offset)
+                         + sscf->index + peer->id;
+
+                    if (sp->version != ngx_http_status_peer_version(peer)) {
+                        continue;
+                    }
+
+                    sum.requests += sp->requests;
+                    sum.fails += sp->fails;
+                    sum.received += sp->received;
+                    sum.cached += sp->cached;
+
+                    for (n = 0; n < 5; n++) {
+                        sum.responses[n] += sp->responses[n];
+                    }
+
+                    rt += sp->response_time * sp->requests;
+                    weight += sp->requests;
+                }
+
+                rt = weight ? rt / weight / 1000 : 0;
+
+                total = 0;
+
+                for (n = 0; n < 5; n++) {
+                    total += sum.responses[n];
+                }
+
+                if (peer->drain) {
+                    state = "draining";
+
+                } else if (peer->down) {
+                    state = "down";
+
+                } else if (peer->hc_down) {
+                    state = "unhealthy";
+
+                } else if (peer->max_fails && peer->fails >= peer->max_fails
+                           && ngx_time() - peer->checked <= peer->fail_timeout)
+                {
+                    state = "unavail";
+
+                } else {
+                    state = "up";
+                }
+
+                if (p[-1] != '[') {
+                    *p++ = ',';
+                }
+
+                p = ngx_cpymem(p, "{\"server\":\"",
+                               sizeof("{\"server\":\"") - 1);
+                p = ngx_http_status_escape(p, &peer->name);
+
+                p = ngx_sprintf(p, "\",\"backup\":%s,\"state\":\"%s\","
+                                "\"active\":%ui,\"requests\":%uA,"
+                                "\"responses\":{\"1xx\":%uA,\"2xx\":%uA,"
+                                "\"3xx\":%uA,\"4xx\":%uA,\"5xx\":%uA,"
+                                "\"total\":%uA},\"fails\":%uA,"
+                                "\"received\":%uA,\"response_time\":%uA,"
+                                "\"keepalive\":{\"hits\":%uA,"
+                                "\"misses\":%uA}}",
+                                backup ? "true" : "false", state,
+                                peer->conns, sum.requests, sum.responses[0],
+                                sum.responses[1], sum.responses[2],
+                                sum.responses[3], sum.responses[4], total,
+                                sum.fails, sum.received, rt, sum.cached,
+                                sum.requests - sum.cached);
+            }
+
+            ngx_http_upstream_rr_peers_unlock(peers);
+
+            backup = 1;
+        }
+
+        *p++ = ']';
+    }
+
+    *p++ = '}';
+
+    return p;
+}
+
+
+#if (NGX_HTTP_CACHE)
+
+static u_char *
+ngx_http_status_caches(ngx_http_status_main_conf_t *smcf, u_char *p)
+{
+    size_t                   offset;
+    ngx_uint_t               i, n;
+    ngx_atomic_uint_t        sent, states[NGX_HTTP_STATUS_CACHE_STATES];
+    ngx_http_file_cache_t  **cache;
+
+    p = ngx_cpymem(p, "\"caches\":{", sizeof("\"caches\":{") - 1);
+
+    cache = smcf->caches.elts;
+
+    for (i = 0; i < smcf->caches.nelts; i++) {
+        offset = smcf->caches_offset + i * sizeof(ngx_http_status_cache_t);
+
+        for (n = 0; n < NGX_HTTP_STATUS_CACHE_STATES; n++) {
+            ngx_http_status_sum(smcf, ngx_http_status_cache_t, offset,
+                                states[n], states[n]);
+        }
+
+        ngx_http_status_sum(smcf, ngx_http_status_cache_t, offset,
+                            sent, sent);
+
+        if (i) {
+            *p++ = ',';
+        }
+
+        *p++ = '"';
+        p = ngx_http_status_escape(p, &cache[i]->shm_zone->shm.name);
+
+        p = ngx_sprintf(p, "\":{\"miss\":%uA,\"bypass\":%uA,\"expired\":%uA,"
+                        "\"stale\":%uA,\"updating\":%uA,\"revalidated\":%uA,"
+                        "\"hit\":%uA,\"scarce\":%uA,\"sent\":%uA}",
+                        states[NGX_HTTP_CACHE_MISS],
+                        states[NGX_HTTP_CACHE_BYPASS],
+                        states[NGX_HTTP_CACHE_EXPIRED],
+                        states[NGX_HTTP_CACHE_STALE],
+                        states[NGX_HTTP_CACHE_UPDATING],
+                        states[NGX_HTTP_CACHE_REVALIDATED],
+                        states[NGX_HTTP_CACHE_HIT],
+                        states[NGX_HTTP_CACHE_SCARCE], sent);
+    }
+
+    *p++ = '}';
+
+    return p;
+}
+
+#endif
+
+
+#if (NGX_HTTP_SSL)
+
+static ngx_ssl_session_cache_t *
+ngx_http_status_ssl_cache(ngx_shm_zone_t *shm_zone)
+{
+    ngx_ssl_session_cache_t  *cache;
+
+    if (shm_zone->tag != &ngx_http_ssl_module
+        || shm_zone->init != ngx_ssl_session_cache_init)
+    {
+        return NULL;
+    }
+
+    cache = shm_zone->data;
+
+    if (cache == NULL || cache->shards == NULL) {
+        return NULL;
+    }
+
+    return cache;
+}
+
+
+static size_t
+ngx_http_status_ssl_size(void)
+{
+    size_t                    size;
+    ngx_uint_t                i;
+    ngx_shm_zone_t           *shm_zone;
+    ngx_list_part_t          *part;
+    ngx_ssl_session_cache_t  *cache;
+
+    size = sizeof(",\"ssl_session_caches\":{}");
+
+    part = (ngx_list_part_t *) &ngx_cycle->shared_memory.part;
+    shm_zone = part->elts;
+
+    for (i = 0; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            shm_zone = part->elts;
+            i = 0;
+        }
+
+        cache = ngx_http_status_ssl_cache(&shm_zone[i]);
+
+        if (cache == NULL) {
+            continue;
+        }
+
+        size += 2 * shm_zone[i].shm.name.len + sizeof("\"\":{\"shards\":[]},")
+                + cache->nshards
+                  * (sizeof("{\"lookups\":,\"hits\":,\"stores\":,"
+                            "\"expired\":,\"evictions\":},")
+                     + 5 * NGX_ATOMIC_T_LEN);
+    }
+
+    return size;
+}
+
+
+static u_char *
+ngx_http_status_ssl_session_caches(u_char *p)
+{
+    ngx_uint_t                i, n, next;
+    ngx_shm_zone_t           *shm_zone;
+    ngx_list_part_t          *part;
+    ngx_ssl_session_cache_t  *cache;
+    ngx_ssl_session_shard_t  *shard;
+
+    p = ngx_cpymem(p, "\"ssl_session_caches\":{",
+                   sizeof("\"ssl_session_caches\":{") - 1);
+
+    next = 0;
+
+    part = (ngx_list_part_t *) &ngx_cycle->shared_memory.part;
+    shm_zone = part->elts;
+
+    for (i = 0; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            shm_zone = part->elts;
+            i = 0;
+        }
+
+        cache = ngx_http_status_ssl_cache(&shm_zone[i]);
+
+        if (cache == NULL) {
+            continue;
+        }
+
+        if (next++) {
+            *p++ = ',';
+        }
+
+        *p++ = '"';
+        p = ngx_http_status_escape(p, &shm_zone[i].shm.name);
+        p = ngx_cpymem(p, "\":{\"shards\":[", sizeof("\":{\"shards\":[") - 1);
+
+        /* the counters are read without the shard locks */
+
+        for (n = 0; n < cache->nshards; n++) {
+            shard = cache->shards[n]->data;
+
+            if (n) {
+                *p++ = ',';
+            }
+
+            p = ngx_sprintf(p, "{\"lookups\":%uA,\"hits\":%uA,"
+                            "\"stores\":%uA,\"expired\":%uA,"
+                            "\"evictions\":%uA}",
+                            shard->lookups, shard->hits, shard->stores,
+                            shard->expired, shard->evictions);
+        }
+
+        *p++ = ']';
+        *p++ = '}';
+    }
+
+    *p++ = '}';
+
+    return p;
+}
+
+#endif
+
+#if (NGX_THREADS)
+
+static size_t
+ngx_http_status_thread_pools_size(void)
+{
+    size_t               size;
+    ngx_uint_t           i;
+    ngx_array_t         *pools;
+    ngx_thread_pool_t  **tpp;
+
+    size = sizeof(",\"thread_pools\":{}");
+
+    pools = ngx_thread_pools((ngx_cycle_t *) ngx_cycle);
+    tpp = pools->elts;
+
+    for (i = 0; i < pools->nelts; i++) {
+        size += 2 * ngx_thread_pool_name(tpp[i])->len
+                + sizeof("\"\":{\"queue\":,\"max_queue\":,\"tasks\":,"
+                         "\"wait_time\":},")
+                + 4 * NGX_ATOMIC_T_LEN;
+    }
+
+    return size;
+}
+
+
+static u_char *
+ngx_http_status_thread_pools(ngx_http_status_main_conf_t *smcf, u_char *p)
+{
+    ngx_uint_t                i, w;
+    ngx_array_t              *pools;
+    ngx_atomic_uint_t         queue, max_queue, posted, wait_time;
+    ngx_thread_pool_t       **tpp;
+    ngx_thread_pool_stats_t  *stats;
+
+    p = ngx_cpymem(p, "\"thread_pools\":{", sizeof("\"thread_pools\":{") - 1);
+
+    pools = ngx_thread_pools((ngx_cycle_t *) ngx_cycle);
+    tpp = pools->elts;
+
+    for (i = 0; i < pools->nelts; i++) {
+
+        /* the queue depth and wait time are sums, max_queue is a maximum */
+
+        queue = 0;
+        max_queue = 0;
+        posted = 0;
+        wait_time = 0;
+
+        for (w = 0; w < smcf->workers; w++) {
+            stats = (ngx_thread_pool_stats_t *)
+                        (ngx_http_status_slot(smcf, w) + smcf->threads_offset)
+                    + i;
+
+            queue += stats->waiting;
+            posted += stats->posted;
+            wait_time += stats->wait_time;
+
+            if (stats->max_queue > max_queue) {
+                max_queue = stats->max_queue;
+            }
+        }
+
+        if (i) {
+            *p++ = ',';
+        }
+
+        *p++ = '"';
+        p = ngx_http_status_escape(p, ngx_thread_pool_name(tpp[i]));
+
+        p = ngx_sprintf(p, "\":{\"queue\":%uA,\"max_queue\":%uA,"
+                        "\"tasks\":%uA,\"wait_time\":%uA}",
+                        queue, max_queue, posted, wait_time);
+    }
+
+    *p++ = '}';
+
+    return p;
+}
+
+
+static ngx_int_t
+ngx_http_status_init_worker(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                    i;
+    ngx_array_t                  *pools;
+    ngx_thread_pool_t           **tpp;
+    ngx_thread_pool_stats_t      *stats;
+    ngx_http_status_main_conf_t  *smcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER
+        && ngx_process != NGX_PROCESS_SINGLE)
+    {
+        return NGX_OK;
+    }
+
+    smcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_status_module);
+
+    if (smcf == NULL || smcf->slots == NULL || ngx_worker >= smcf->workers) {
+        return NGX_OK;
+    }
+
+    /* the pools count their tasks in the worker slot from now on */
+
+    stats = (ngx_thread_pool_stats_t *)
+                (ngx_http_status_slot(smcf, ngx_worker) + smcf->threads_offset);
+
+    pools = ngx_thread_pools(cycle);
+    tpp = pools->elts;
+
+    for (i = 0; i < pools->nelts; i++) {
+        ngx_thread_pool_set_stats(tpp[i], &stats[i]);
+    }
+
+    return NGX_OK;
+}
+
+#endif
+
+
+static ngx_int_t
+ngx_http_status_log_handler(ngx_http_request_t *r)
+{
+    u_char                       *slot;
+    ngx_uint_t                    status;
+    ngx_http_status_server_t     *ss;
+    ngx_http_status_srv_conf_t   *sscf;
+    ngx_http_status_main_conf_t  *smcf;
+
+    smcf = ngx_http_get_module_main_conf(r, ngx_http_status_module);
+
+    if (smcf->slots == NULL || ngx_worker >= smcf->workers) {
+        return NGX_OK;
+    }
+
+    slot = ngx_http_status_slot(smcf, ngx_worker);
+
+    sscf = ngx_http_get_module_srv_conf(r, ngx_http_status_module);
+
+    status = r->err_status ? r->err_status : r->headers_out.status;
+
+    if (sscf->index != NGX_CONF_UNSET_UINT) {
+        ss = (ngx_http_status_server_t *) slot + sscf->index;
+
+        ss->requests++;
+        ss->received += r->request_length;
+        ss->sent += r->connection->sent;
+
+        if (status >= 100 && status < 600) {
+            ss->responses[status / 100 - 1]++;
+        }
+    }
+
+    if (r->upstream) {
+        ngx_http_status_log_upstream(r, smcf, slot);
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_status_log_upstream(ngx_http_request_t *r,
+    ngx_http_status_main_conf_t *smcf, u_char *slot)
+{
+    ngx_uint_t                     i;
+    ngx_msec_int_t                 ms;
+    ngx_http_status_peer_t        *sp;
+    ngx_http_upstream_t           *u;
+    ngx_http_upstream_state_t     *state;
+    ngx_http_status_srv_conf_t    *sscf;
+    ngx_http_upstream_srv_conf_t  *uscf;
+
+    u = r->upstream;
+
+#if (NGX_HTTP_CACHE)
+
+    if (r->cache && u->cache_status) {
+        ngx_http_status_cache_t   *sc;
+        ngx_http_file_cache_t    **cache;
+
+        cache = smcf->caches.elts;
+
+        for (i = 0; i < smcf->caches.nelts; i++) {
+            if (cache[i] == r->cache->file_cache) {
+                sc = (ngx_http_status_cache_t *) (slot + smcf->caches_offset)
+                     + i;
+
+                sc->states[u->cache_status]++;
+                sc->sent += r->connection->sent;
+                break;
+            }
+        }
+    }
+
+#endif
+
+    uscf = u->conf->upstream;
+
+    if (uscf == NULL || uscf->srv_conf == NULL || r->upstream_states == NULL) {
+        return;
+    }
+
+    sscf = ngx_http_conf_upstream_srv_conf(uscf, ngx_http_status_module);
+
+    if (sscf->index == NGX_CONF_UNSET_UINT) {
+        return;
+    }
+
+    state = r->upstream_states->elts;
+
+    for (i = 0; i < r->upstream_states->nelts; i++) {
+
+        if (state[i].upstream != uscf || state[i].peer_id >= sscf->npeers) {
+            continue;
+        }
+
+        sp = (ngx_http_status_peer_t *) (slot + smcf->peers_offset)
+             + sscf->index + state[i].peer_id;
+
+        if (sp->version != state[i].peer_version) {
+            ngx_memzero(sp, sizeof(ngx_http_status_peer_t));
+            sp->version = state[i].peer_version;
+        }
+
+        sp->requests++;
+
+        if (state[i].cached) {
+            sp->cached++;
+        }
+
+        if (state[i].header_time == (ngx_msec_t) -1) {
+            sp->fails++;
+
+        } else if (state[i].status >= 100 && state[i].status < 600) {
+            sp->responses[state[i].status / 100 - 1]++;
+        }
+
+        if (state[i].response_length > 0) {
+            sp->received += state[i].response_length;
+        }
+
+        ms = (ngx_msec_int_t) state[i].response_time;
+
+        if (ms >= 0) {
+            if (sp->response_time == 0) {
+                sp->response_time = ms * 1000;
+
+            } else {
+                sp->response_time += (ngx_msec_int_t)
+                                     (ms * 1000 - sp->response_time) / 8;
+            }
+        }
+    }
+}
+
+
+static ngx_int_t
+ngx_http_status_init_zone(ngx_shm_zone_t *shm_zone, void *data)
+{
+    size_t                        size;
+    ngx_slab_pool_t              *shpool;
+    ngx_core_conf_t              *ccf;
+    ngx_http_status_main_conf_t  *smcf;
+
+    smcf = shm_zone->data;
+    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+    ccf = (ngx_core_conf_t *) ngx_get_conf(smcf->cycle->conf_ctx,
+                                           ngx_core_module);
+
+    smcf->workers = (ccf->master) ? ccf->worker_processes : 1;
+
+#if (NGX_THREADS)
+
+    /* the thread pools are known once the whole configuration is parsed */
+
+    smcf->threads_offset = smcf->slot_size;
+    smcf->slot_size = ngx_align(smcf->threads_offset
+                                + ngx_thread_pools(smcf->cycle)->nelts
+                                  * sizeof(ngx_thread_pool_stats_t),
+                                NGX_CPU_CACHE_LINE);
+#endif
+
+    if (shm_zone->shm.exists) {
+        smcf->slots = shpool->data;
+        return NGX_OK;
+    }
+
+    size = smcf->workers * smcf->slot_size + NGX_CPU_CACHE_LINE;
+
+    smcf->slots = ngx_slab_calloc(shpool, size);
+    if (smcf->slots == NULL) {
+        ngx_log_error(NGX_LOG_EMERG, shm_zone->shm.log, 0,
+                      "status zone \"%V\" is too small, %uz bytes needed",
+                      &shm_zone->shm.name, size);
+        return NGX_ERROR;
+    }
+
+    smcf->slots = ngx_align_ptr(smcf->slots, NGX_CPU_CACHE_LINE);
+
+    shpool->data = smcf->slots;
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_http_status_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_http_status_main_conf_t  *smcf;
+
+    smcf = ngx_pcalloc(cf->pool, sizeof(ngx_http_status_main_conf_t));
+    if (smcf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     smcf->shm_zone = NULL;
+     *     smcf->npeers = 0;
+     *     smcf->slots = NULL;
+     */
+
+    return smcf;
+}
+
+
+static void *
+ngx_http_status_create_srv_conf(ngx_conf_t *cf)
+{
+    ngx_http_status_srv_conf_t  *sscf;
+
+    sscf = ngx_palloc(cf->pool, sizeof(ngx_http_status_srv_conf_t));
+    if (sscf == NULL) {
+        return NULL;
+    }
+
+    sscf->index = NGX_CONF_UNSET_UINT;
+
+    return sscf;
+}
+
+
+static char *
+ngx_http_status_zone(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_status_main_conf_t *smcf = conf;
+
+    ssize_t     size;
+    ngx_str_t  *value;
+
+    if (smcf->shm_zone) {
+        return "is duplicate";
+    }
+
+    value = cf->args->elts;
+
+    size = ngx_parse_size(&value[2]);
+
+    if (size == NGX_ERROR) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "invalid zone size \"%V\"", &value[2]);
+        return NGX_CONF_ERROR;
+    }
+
+    if (size < (ssize_t) (8 * ngx_pagesize)) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "zone \"%V\" is too small", &value[1]);
+        return NGX_CONF_ERROR;
+    }
+
+    smcf->shm_zone = ngx_shared_memory_add(cf, &value[1], size,
+                                           &ngx_http_status_module);
+    if (smcf->shm_zone == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    if (smcf->shm_zone->data) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "duplicate zone \"%V\"", &value[1]);
+        return NGX_CONF_ERROR;
+    }
+
+    smcf->shm_zone->init = ngx_http_status_init_zone;
+    smcf->shm_zone->data = smcf;
+
+    /* the worker slots are not shared with the workers of the old cycle */
+
+    smcf->shm_zone->noreuse = 1;
+
+    smcf->cycle = cf->cycle;
+
+    return NGX_CONF_OK;
+}
+
+
+static char *
+ngx_http_status(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_core_loc_conf_t  *clcf;
+
+    clcf = ngx_http_conf_get_module_loc_conf(cf, ngx_http_core_module);
+    clcf->handler = ngx_http_status_handler;
+
+    return NGX_CONF_OK;
+}
+
+
+static ngx_int_t
+ngx_http_status_init(ngx_conf_t *cf)
+{
+    size_t                           size;
+    ngx_str_t                       *name;
+    ngx_uint_t                       i, n;
+    ngx_http_handler_pt             *h;
+    ngx_http_core_srv_conf_t       **cscfp;
+    ngx_http_status_srv_conf_t      *sscf;
+    ngx_http_upstream_rr_peer_t     *peer;
+    ngx_http_upstream_rr_peers_t    *peers;
+    ngx_http_core_main_conf_t       *cmcf;
+    ngx_http_status_main_conf_t     *smcf;
+    ngx_http_upstream_srv_conf_t   **uscfp, **uscfpp;
+    ngx_http_upstream_main_conf_t   *umcf;
+
+    smcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_status_module);
+
+    if (smcf->shm_zone == NULL) {
+        return NGX_OK;
+    }
+
+    cmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_core_module);
+
+    /* the servers with the same name share the counters */
+
+    if (ngx_array_init(&smcf->servers, cf->pool, 4, sizeof(ngx_str_t))
+        != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    cscfp = cmcf->servers.elts;
+
+    for (i = 0; i < cmcf->servers.nelts; i++) {
+
+        sscf = cscfp[i]->ctx->srv_conf[ngx_http_status_module.ctx_index];
+
+        name = smcf->servers.elts;
+
+        for (n = 0; n < smcf->servers.nelts; n++) {
+            if (name[n].len == cscfp[i]->server_name.len
+                && ngx_strncmp(name[n].data, cscfp[i]->server_name.data,
+                               name[n].len)
+                   == 0)
+            {
+                break;
+            }
+        }
+
+        if (n == smcf->servers.nelts) {
+            name = ngx_array_push(&smcf->servers);
+            if (name == NULL) {
+                return NGX_ERROR;
+            }
+
+            *name = cscfp[i]->server_name;
+        }
+
+        sscf->index = n;
+    }
+
+    /* the peers of the explicitly defined upstreams */
+
+    if (ngx_array_init(&smcf->upstreams, cf->pool, 4,
+                       sizeof(ngx_http_upstream_srv_conf_t *))
+        != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    umcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_upstream_module);
+
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+
+        if (uscfp[i]->srv_conf == NULL || uscfp[i]->peer.data == NULL) {
+            continue;
+        }
+
+        uscfpp = ngx_array_push(&smcf->upstreams);
+        if (uscfpp == NULL) {
+            return NGX_ERROR;
+        }
+
+        *uscfpp = uscfp[i];
+
+        sscf = ngx_http_conf_upstream_srv_conf(uscfp[i],
+                                               ngx_http_status_module);
+        sscf->index = smcf->npeers;
+        sscf->npeers = 0;
+
+        for (peers = uscfp[i]->peer.data; peers; peers = peers->next) {
+            sscf->npeers += peers->number;
+        }
+
+#if (NGX_HTTP_UPSTREAM_ZONE)
+        if (uscfp[i]->shm_zone) {
+            sscf->npeers += NGX_HTTP_STATUS_ZONE_PEERS;
+        }
+#endif
+
+        smcf->npeers += sscf->npeers;
+    }
+
+#if (NGX_HTTP_CACHE)
+    {
+    ngx_list_part_t         *part;
+    ngx_shm_zone_t          *shm_zone;
+    ngx_http_file_cache_t  **cache;
+
+    if (ngx_array_init(&smcf->caches, cf->pool, 4,
+                       sizeof(ngx_http_file_cache_t *))
+        != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    part = &cf->cycle->shared_memory.part;
+    shm_zone = part->elts;
+
+    for (i = 0; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            shm_zone = part->elts;
+            i = 0;
+        }
+
+        if (shm_zone[i].init != ngx_http_file_cache_init) {
+            continue;
+        }
+
+        cache = ngx_array_push(&smcf->caches);
+        if (cache == NULL) {
+            return NGX_ERROR;
+        }
+
+        *cache = shm_zone[i].data;
+    }
+    }
+#endif
+
+    size = smcf->servers.nelts * sizeof(ngx_http_status_server_t);
+
+    smcf->peers_offset = size;
+    size += smcf->npeers * sizeof(ngx_http_status_peer_t);
+
+    smcf->caches_offset = size;
+#if (NGX_HTTP_CACHE)
+    size += smcf->caches.nelts * sizeof(ngx_http_status_cache_t);
+#endif
+
+    smcf->slot_size = ngx_align(size, NGX_CPU_CACHE_LINE);
+
+    h = ngx_array_push(&cmcf->phases[NGX_HTTP_LOG_PHASE].handlers);
+    if (h == NULL) {
+        return NGX_ERROR;
+    }
+
+    *h = ngx_http_status_log_handler;
+
+    return NGX_OK;
+}
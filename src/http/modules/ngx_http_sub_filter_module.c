@@ -13,6 +13,31 @@
 typedef struct {
     ngx_str_t                  match;
     ngx_http_complex_value_t   value;
+} ngx_http_sub_pair_t;
+
+
+/*
+ * the Aho-Corasick automaton of all the sub_filter strings of a location,
+ * the goto and failure functions are merged into a single transition table,
+ * the table columns are the classes of the characters used in the strings
+ */
+
+typedef struct {
+    ngx_uint_t                 nclasses;
+    ngx_uint_t                *next;    /* [state * nclasses + class] */
+    ngx_uint_t                *output;  /* the longest match in a state */
+    ngx_uint_t                *dict;    /* the next shorter match */
+    ngx_uint_t                *index;   /* the string of a final state */
+    ngx_uint_t                *depth;
+    u_char                    *more;    /* a longer string goes on */
+    size_t                     max_len;
+    u_char                     map[256];
+} ngx_http_sub_tables_t;
+
+
+typedef struct {
+    ngx_array_t               *pairs;
+    ngx_http_sub_tables_t     *tables;
 
     ngx_hash_t                 types;
 
@@ -23,15 +48,7 @@ typedef struct {
 } ngx_http_sub_loc_conf_t;
 
 
-typedef enum {
-    sub_start_state = 0,
-    sub_match_state,
-} ngx_http_sub_state_e;
-
-
 typedef struct {
-    ngx_str_t                  match;
-    ngx_str_t                  saved;
     ngx_str_t                  looked;
 
     ngx_uint_t                 once;   /* unsigned  once:1 */
@@ -48,9 +65,20 @@ typedef struct {
     ngx_chain_t               *busy;
     ngx_chain_t               *free;
 
-    ngx_str_t                  sub;
+    ngx_http_sub_tables_t     *tables;
+    ngx_str_t                 *sub;
+
+    u_char                    *done;
+    ngx_uint_t                 left;
 
     ngx_uint_t                 state;
+    ngx_uint_t                 index;
+
+    ngx_uint_t                 found;
+    size_t                     back;
+
+    ngx_buf_t                 *resume;
+    u_char                    *resume_pos;
 } ngx_http_sub_ctx_t;
 
 
@@ -58,6 +86,8 @@ static ngx_int_t ngx_http_sub_output(ngx_http_request_t *r,
     ngx_http_sub_ctx_t *ctx);
 static ngx_int_t ngx_http_sub_parse(ngx_http_request_t *r,
     ngx_http_sub_ctx_t *ctx);
+static ngx_int_t ngx_http_sub_init_tables(ngx_conf_t *cf,
+    ngx_http_sub_loc_conf_t *slcf);
 
 static char * ngx_http_sub_filter(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
@@ -144,7 +174,7 @@ ngx_http_sub_header_filter(ngx_http_request_t *r)
 
     slcf = ngx_http_get_module_loc_conf(r, ngx_http_sub_filter_module);
 
-    if (slcf->match.len == 0
+    if (slcf->pairs == NULL
         || r->headers_out.content_length_n == 0
         || ngx_http_test_content_type(r, &slcf->types) == NULL)
     {
@@ -156,19 +186,28 @@ ngx_http_sub_header_filter(ngx_http_request_t *r)
         return NGX_ERROR;
     }
 
-    ctx->saved.data = ngx_pnalloc(r->pool, slcf->match.len);
-    if (ctx->saved.data == NULL) {
+    ctx->looked.data = ngx_pnalloc(r->pool, slcf->tables->max_len);
+    if (ctx->looked.data == NULL) {
         return NGX_ERROR;
     }
 
-    ctx->looked.data = ngx_pnalloc(r->pool, slcf->match.len);
-    if (ctx->looked.data == NULL) {
+    ctx->sub = ngx_pcalloc(r->pool, slcf->pairs->nelts * sizeof(ngx_str_t));
+    if (ctx->sub == NULL) {
         return NGX_ERROR;
     }
 
+    if (slcf->once) {
+        ctx->done = ngx_pcalloc(r->pool, slcf->pairs->nelts);
+        if (ctx->done == NULL) {
+            return NGX_ERROR;
+        }
+
+        ctx->left = slcf->pairs->nelts;
+    }
+
     ngx_http_set_ctx(r, ctx, ngx_http_sub_filter_module);
 
-    ctx->match = slcf->match;
+    ctx->tables = slcf->tables;
     ctx->last_out = &ctx->out;
 
     r->filter_need_in_memory = 1;
@@ -192,10 +231,12 @@ ngx_http_sub_header_filter(ngx_http_request_t *r)
 static ngx_int_t
 ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
 {
+    size_t                     hold, len, saved;
     ngx_int_t                  rc;
     ngx_buf_t                 *b;
     ngx_chain_t               *cl;
     ngx_http_sub_ctx_t        *ctx;
+    ngx_http_sub_pair_t       *pair;
     ngx_http_sub_loc_conf_t   *slcf;
 
     ctx = ngx_http_get_module_ctx(r, ngx_http_sub_filter_module);
@@ -242,33 +283,58 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
             ctx->pos = ctx->buf->pos;
         }
 
-        if (ctx->state == sub_start_state) {
-            ctx->copy_start = ctx->pos;
-            ctx->copy_end = ctx->pos;
-        }
+        ctx->copy_start = ctx->pos;
 
         b = NULL;
 
-        while (ctx->pos < ctx->buf->last) {
+        while (ctx->pos < ctx->buf->last
+               || (ctx->found
+                   && (ctx->buf->last_buf || ctx->buf->last_in_chain)))
+        {
 
             ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                           "saved: \"%V\" state: %d", &ctx->saved, ctx->state);
+                           "looked: \"%V\" state: %ui",
+                           &ctx->looked, ctx->state);
 
             rc = ngx_http_sub_parse(r, ctx);
 
-            ngx_log_debug4(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                           "parse: %d, looked: \"%V\" %p-%p",
-                           rc, &ctx->looked, ctx->copy_start, ctx->copy_end);
-
             if (rc == NGX_ERROR) {
                 return rc;
             }
 
-            if (ctx->saved.len) {
+            slcf = ngx_http_get_module_loc_conf(r, ngx_http_sub_filter_module);
+
+            pair = slcf->pairs->elts;
+
+            /*
+             * the last "hold" bytes of the looked bytes and the bytes
+             * parsed in this buffer are either a match to be replaced
+             * or a partial match to be kept until the next buffer
+             */
+
+            if (rc == NGX_OK) {
+                hold = pair[ctx->index].match.len + ctx->back;
+
+            } else {
+                hold = ctx->tables->depth[ctx->state];
+            }
+
+            len = ctx->pos - ctx->copy_start;
+
+            if (hold <= len) {
+                ctx->copy_end = ctx->pos - hold;
+                saved = ctx->looked.len;
 
-                ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                               "saved: \"%V\"", &ctx->saved);
+            } else {
+                ctx->copy_end = ctx->copy_start;
+                saved = ctx->looked.len + len - hold;
+            }
+
+            ngx_log_debug4(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "parse: %i, saved: %uz %p-%p",
+                           rc, saved, ctx->copy_start, ctx->copy_end);
 
+            if (saved) {
                 cl = ngx_chain_get_free_buf(r->pool, &ctx->free);
                 if (cl == NULL) {
                     return NGX_ERROR;
@@ -278,19 +344,17 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
 
                 ngx_memzero(b, sizeof(ngx_buf_t));
 
-                b->pos = ngx_pnalloc(r->pool, ctx->saved.len);
+                b->pos = ngx_pnalloc(r->pool, saved);
                 if (b->pos == NULL) {
                     return NGX_ERROR;
                 }
 
-                ngx_memcpy(b->pos, ctx->saved.data, ctx->saved.len);
-                b->last = b->pos + ctx->saved.len;
+                ngx_memcpy(b->pos, ctx->looked.data, saved);
+                b->last = b->pos + saved;
                 b->memory = 1;
 
                 *ctx->last_out = cl;
                 ctx->last_out = &cl->next;
-
-                ctx->saved.len = 0;
             }
 
             if (ctx->copy_start != ctx->copy_end) {
@@ -320,27 +384,32 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
                 ctx->last_out = &cl->next;
             }
 
-            if (ctx->state == sub_start_state) {
-                ctx->copy_start = ctx->pos;
-                ctx->copy_end = ctx->pos;
+            if (rc == NGX_AGAIN) {
 
-            } else {
-                ctx->copy_start = NULL;
-                ctx->copy_end = NULL;
-            }
+                /* keep the partial match */
 
-            if (ctx->looked.len > (size_t) (ctx->pos - ctx->buf->pos)) {
-                ctx->saved.len = ctx->looked.len - (ctx->pos - ctx->buf->pos);
-                ngx_memcpy(ctx->saved.data, ctx->looked.data, ctx->saved.len);
-            }
+                if (hold <= len) {
+                    ngx_memcpy(ctx->looked.data, ctx->pos - hold, hold);
+
+                } else {
+                    ngx_memmove(ctx->looked.data, ctx->looked.data + saved,
+                                ctx->looked.len - saved);
+                    ngx_memcpy(ctx->looked.data + ctx->looked.len - saved,
+                               ctx->copy_start, len);
+                }
+
+                ctx->looked.len = hold;
+                ctx->copy_start = ctx->pos;
 
-            if (rc == NGX_AGAIN) {
                 continue;
             }
 
 
             /* rc == NGX_OK */
 
+            ctx->looked.len = 0;
+            ctx->copy_start = ctx->pos;
+
             cl = ngx_chain_get_free_buf(r->pool, &ctx->free);
             if (cl == NULL) {
                 return NGX_ERROR;
@@ -350,21 +419,21 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
 
             ngx_memzero(b, sizeof(ngx_buf_t));
 
-            slcf = ngx_http_get_module_loc_conf(r, ngx_http_sub_filter_module);
-
-            if (ctx->sub.data == NULL) {
+            if (ctx->sub[ctx->index].data == NULL) {
 
-                if (ngx_http_complex_value(r, &slcf->value, &ctx->sub)
+                if (ngx_http_complex_value(r, &pair[ctx->index].value,
+                                           &ctx->sub[ctx->index])
                     != NGX_OK)
                 {
                     return NGX_ERROR;
                 }
             }
 
-            if (ctx->sub.len) {
+            if (ctx->sub[ctx->index].len) {
                 b->memory = 1;
-                b->pos = ctx->sub.data;
-                b->last = ctx->sub.data + ctx->sub.len;
+                b->pos = ctx->sub[ctx->index].data;
+                b->last = ctx->sub[ctx->index].data
+                          + ctx->sub[ctx->index].len;
 
             } else {
                 b->sync = 1;
@@ -373,8 +442,47 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
             *ctx->last_out = cl;
             ctx->last_out = &cl->next;
 
-            ctx->once = slcf->once;
+            if (ctx->back == 0) {
+                continue;
+            }
+
+            /*
+             * the bytes looked at after the match were kept from
+             * the previous buffers, they are parsed again before
+             * the rest of the current buffer
+             */
+
+            b = ngx_calloc_buf(r->pool);
+            if (b == NULL) {
+                return NGX_ERROR;
+            }
 
+            b->pos = ngx_pnalloc(r->pool, ctx->back);
+            if (b->pos == NULL) {
+                return NGX_ERROR;
+            }
+
+            ngx_memcpy(b->pos, ctx->looked.data + saved + hold - ctx->back,
+                       ctx->back);
+            b->last = b->pos + ctx->back;
+            b->memory = 1;
+
+            ctx->back = 0;
+
+            ctx->resume = ctx->buf;
+            ctx->resume_pos = ctx->pos;
+
+            ctx->buf = b;
+            ctx->pos = b->pos;
+            ctx->copy_start = ctx->pos;
+
+            b = NULL;
+        }
+
+        if (ctx->resume) {
+            ctx->buf = ctx->resume;
+            ctx->pos = ctx->resume_pos;
+            ctx->resume = NULL;
             continue;
         }
 
@@ -398,6 +506,7 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
             ctx->last_out = &cl->next;
 
             ctx->looked.len = 0;
+            ctx->state = 0;
         }
 
         if (ctx->buf->last_buf || ctx->buf->flush || ctx->buf->sync
@@ -428,9 +537,6 @@ ngx_http_sub_body_filter(ngx_http_request_t *r, ngx_chain_t *in)
         }
 
         ctx->buf = NULL;
-
-        ctx->saved.len = ctx->looked.len;
-        ngx_memcpy(ctx->saved.data, ctx->looked.data, ctx->looked.len);
     }
 
     if (ctx->out == NULL && ctx->busy == NULL) {
@@ -513,158 +619,122 @@ ngx_http_sub_output(ngx_http_request_t *r, ngx_http_sub_ctx_t *ctx)
 static ngx_int_t
 ngx_http_sub_parse(ngx_http_request_t *r, ngx_http_sub_ctx_t *ctx)
 {
-    u_char                *p, *last, *copy_end, ch, match;
-    size_t                 looked, i;
-    ngx_http_sub_state_e   state;
+    u_char                 *p, *last;
+    size_t                  ahead, len;
+    ngx_uint_t              state, found, s, t, i;
+    ngx_http_sub_tables_t  *tables;
 
     if (ctx->once) {
-        ctx->copy_start = ctx->pos;
-        ctx->copy_end = ctx->buf->last;
         ctx->pos = ctx->buf->last;
-        ctx->looked.len = 0;
+        ctx->state = 0;
 
         ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0, "once");
 
         return NGX_AGAIN;
     }
 
+    tables = ctx->tables;
     state = ctx->state;
-    looked = ctx->looked.len;
+    found = ctx->found;
     last = ctx->buf->last;
-    copy_end = ctx->copy_end;
 
     for (p = ctx->pos; p < last; p++) {
 
-        ch = *p;
-        ch = ngx_tolower(ch);
-
-        if (state == sub_start_state) {
-
-            /* the tight loop */
-
-            match = ctx->match.data[0];
-
-            for ( ;; ) {
-                if (ch == match) {
+        if (found) {
 
-                    if (ctx->match.len == 1) {
-                        ctx->pos = p + 1;
-                        ctx->copy_end = p;
-
-                        return NGX_OK;
-                    }
-
-                    copy_end = p;
-                    ctx->looked.data[0] = *p;
-                    looked = 1;
-                    state = sub_match_state;
+            /*
+             * a longer string starting at the same position as the found
+             * one is looked for, the state is a node of the trie
+             */
 
-                    goto match_started;
-                }
+            t = tables->next[state * tables->nclasses + tables->map[*p]];
 
-                if (++p == last) {
-                    break;
-                }
-
-                ch = *p;
-                ch = ngx_tolower(ch);
+            if (tables->depth[t] != tables->depth[state] + 1) {
+                goto matched;
             }
 
-            ctx->state = state;
-            ctx->pos = p;
-            ctx->looked.len = looked;
-            ctx->copy_end = p;
+            state = t;
 
-            if (ctx->copy_start == NULL) {
-                ctx->copy_start = ctx->buf->pos;
+            if (tables->output[t] == t
+                && (ctx->done == NULL || !ctx->done[tables->index[t]]))
+            {
+                found = t;
             }
 
-            return NGX_AGAIN;
-
-        match_started:
+            if (!tables->more[t]) {
+                p++;
+                goto matched;
+            }
 
             continue;
         }
 
-        /* state == sub_match_state */
+        state = tables->next[state * tables->nclasses + tables->map[*p]];
 
-        if (ch == ctx->match.data[looked]) {
-            ctx->looked.data[looked] = *p;
-            looked++;
+        /* the longest string ending here, which was not replaced yet */
 
-            if (looked == ctx->match.len) {
+        for (s = tables->output[state]; s; s = tables->dict[s]) {
 
-                ctx->state = sub_start_state;
-                ctx->pos = p + 1;
-                ctx->looked.len = 0;
-                ctx->saved.len = 0;
-                ctx->copy_end = copy_end;
+            if (ctx->done && ctx->done[tables->index[s]]) {
+                continue;
+            }
 
-                if (ctx->copy_start == NULL && copy_end) {
-                    ctx->copy_start = ctx->buf->pos;
-                }
+            found = s;
+            state = s;
 
-                return NGX_OK;
+            if (tables->more[s]) {
+                break;
             }
 
-        } else {
-            /*
-             * check if there is another partial match in previously
-             * matched substring to catch cases like "aab" in "aaab"
-             */
+            p++;
+            goto matched;
+        }
+    }
 
-            ctx->looked.data[looked] = *p;
-            looked++;
+    if (found == 0
+        || !(ctx->buf->last_buf || ctx->buf->last_in_chain))
+    {
+        ctx->state = state;
+        ctx->found = found;
+        ctx->pos = p;
 
-            for (i = 1; i < looked; i++) {
-                if (ngx_strncasecmp(ctx->looked.data + i,
-                                    ctx->match.data, looked - i)
-                    == 0)
-                {
-                    break;
-                }
-            }
+        return NGX_AGAIN;
+    }
 
-            if (i < looked) {
-                if (ctx->saved.len > i) {
-                    ctx->saved.len = i;
-                }
+matched:
 
-                if ((size_t) (p + 1 - ctx->buf->pos) >= looked - i) {
-                    copy_end = p + 1 - (looked - i);
-                }
+    /*
+     * the bytes looked at after the found string are parsed again:
+     * they are either in this buffer or kept from the previous ones
+     */
 
-                ngx_memmove(ctx->looked.data, ctx->looked.data + i, looked - i);
-                looked = looked - i;
+    ahead = tables->depth[state] - tables->depth[found];
+    len = p - ctx->copy_start;
 
-            } else {
-                copy_end = p;
-                looked = 0;
-                state = sub_start_state;
-            }
+    if (ahead <= len) {
+        ctx->pos = p - ahead;
+        ctx->back = 0;
 
-            if (ctx->saved.len) {
-                p++;
-                goto out;
-            }
-        }
+    } else {
+        ctx->pos = ctx->copy_start;
+        ctx->back = ahead - len;
     }
 
-    ctx->saved.len = 0;
-
-out:
+    i = tables->index[found];
 
-    ctx->state = state;
-    ctx->pos = p;
-    ctx->looked.len = looked;
+    if (ctx->done) {
+        ctx->done[i] = 1;
 
-    ctx->copy_end = (state == sub_start_state) ? p : copy_end;
-
-    if (ctx->copy_start == NULL && ctx->copy_end) {
-        ctx->copy_start = ctx->buf->pos;
+        if (--ctx->left == 0) {
+            ctx->once = 1;
+        }
     }
 
-    return NGX_AGAIN;
+    ctx->state = 0;
+    ctx->found = 0;
+    ctx->index = i;
+
+    return NGX_OK;
 }
 
 
@@ -674,23 +744,38 @@ ngx_http_sub_filter(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     ngx_http_sub_loc_conf_t *slcf = conf;
 
     ngx_str_t                         *value;
+    ngx_http_sub_pair_t               *pair;
     ngx_http_compile_complex_value_t   ccv;
 
-    if (slcf->match.data) {
-        return "is duplicate";
+    value = cf->args->elts;
+
+    if (value[1].len == 0) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0, "empty search pattern");
+        return NGX_CONF_ERROR;
     }
 
-    value = cf->args->elts;
+    if (slcf->pairs == NULL) {
+        slcf->pairs = ngx_array_create(cf->pool, 1,
+                                       sizeof(ngx_http_sub_pair_t));
+        if (slcf->pairs == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+    pair = ngx_array_push(slcf->pairs);
+    if (pair == NULL) {
+        return NGX_CONF_ERROR;
+    }
 
     ngx_strlow(value[1].data, value[1].data, value[1].len);
 
-    slcf->match = value[1];
+    pair->match = value[1];
 
     ngx_memzero(&ccv, sizeof(ngx_http_compile_complex_value_t));
 
     ccv.cf = cf;
     ccv.value = &value[2];
-    ccv.complex_value = &slcf->value;
+    ccv.complex_value = &pair->value;
 
     if (ngx_http_compile_complex_value(&ccv) != NGX_OK) {
         return NGX_CONF_ERROR;
@@ -700,6 +785,148 @@ ngx_http_sub_filter(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 }
 
 
+static ngx_int_t
+ngx_http_sub_init_tables(ngx_conf_t *cf, ngx_http_sub_loc_conf_t *slcf)
+{
+    u_char                 *p, *last;
+    ngx_uint_t              i, c, n, s, t, f, ft, states, head, tail;
+    ngx_uint_t             *fail, *queue;
+    ngx_http_sub_pair_t    *pair;
+    ngx_http_sub_tables_t  *tables;
+
+    tables = ngx_pcalloc(cf->pool, sizeof(ngx_http_sub_tables_t));
+    if (tables == NULL) {
+        return NGX_ERROR;
+    }
+
+    pair = slcf->pairs->elts;
+
+    /* the class 0 is used for all characters absent in the strings */
+
+    n = 1;
+    tables->nclasses = 1;
+
+    for (i = 0; i < slcf->pairs->nelts; i++) {
+
+        n += pair[i].match.len;
+
+        if (tables->max_len < pair[i].match.len) {
+            tables->max_len = pair[i].match.len;
+        }
+
+        last = pair[i].match.data + pair[i].match.len;
+
+        for (p = pair[i].match.data; p < last; p++) {
+
+            if (tables->map[*p]) {
+                continue;
+            }
+
+            tables->map[*p] = (u_char) tables->nclasses;
+
+            if (*p >= 'a' && *p <= 'z') {
+                tables->map[*p - 'a' + 'A'] = (u_char) tables->nclasses;
+            }
+
+            tables->nclasses++;
+        }
+    }
+
+    tables->next = ngx_pcalloc(cf->pool,
+                               n * tables->nclasses * sizeof(ngx_uint_t));
+    tables->output = ngx_pcalloc(cf->pool, n * sizeof(ngx_uint_t));
+    tables->dict = ngx_pcalloc(cf->pool, n * sizeof(ngx_uint_t));
+    tables->index = ngx_pcalloc(cf->pool, n * sizeof(ngx_uint_t));
+    tables->depth = ngx_pcalloc(cf->pool, n * sizeof(ngx_uint_t));
+    tables->more = ngx_pcalloc(cf->pool, n);
+    fail = ngx_pcalloc(cf->temp_pool, n * sizeof(ngx_uint_t));
+    queue = ngx_palloc(cf->temp_pool, n * sizeof(ngx_uint_t));
+
+    if (tables->next == NULL || tables->output == NULL
+        || tables->dict == NULL || tables->index == NULL
+        || tables->depth == NULL || tables->more == NULL
+        || fail == NULL || queue == NULL)
+    {
+        return NGX_ERROR;
+    }
+
+    /* the trie, the state 0 is the root */
+
+    states = 1;
+
+    for (i = 0; i < slcf->pairs->nelts; i++) {
+
+        s = 0;
+        last = pair[i].match.data + pair[i].match.len;
+
+        for (p = pair[i].match.data; p < last; p++) {
+
+            c = s * tables->nclasses + tables->map[*p];
+
+            if (tables->next[c] == 0) {
+                tables->next[c] = states;
+                tables->depth[states] = tables->depth[s] + 1;
+                tables->more[s] = 1;
+                states++;
+            }
+
+            s = tables->next[c];
+        }
+
+        if (tables->output[s] == 0) {
+            tables->output[s] = s;
+            tables->index[s] = i;
+        }
+    }
+
+    /*
+     * breadth-first walk to build the failure links and to replace
+     * the missing goto transitions with the transitions of the failure
+     * states, which are already complete as they are less deep
+     */
+
+    head = 0;
+    tail = 0;
+
+    for (c = 0; c < tables->nclasses; c++) {
+        if (tables->next[c]) {
+            queue[tail++] = tables->next[c];
+        }
+    }
+
+    while (head < tail) {
+
+        s = queue[head++];
+        f = fail[s];
+
+        for (c = 0; c < tables->nclasses; c++) {
+
+            t = tables->next[s * tables->nclasses + c];
+            ft = tables->next[f * tables->nclasses + c];
+
+            if (t == 0) {
+                tables->next[s * tables->nclasses + c] = ft;
+                continue;
+            }
+
+            fail[t] = ft;
+
+            if (tables->output[t] == 0) {
+                tables->output[t] = tables->output[fail[t]];
+            }
+
+            tables->dict[t] = tables->output[fail[t]];
+
+            queue[tail++] = t;
+        }
+    }
+
+    slcf->tables = tables;
+
+    return NGX_OK;
+}
+
+
 static void *
 ngx_http_sub_create_conf(ngx_conf_t *cf)
 {
@@ -713,7 +940,8 @@ ngx_http_sub_create_conf(ngx_conf_t *cf)
     /*
      * set by ngx_pcalloc():
      *
-     *     conf->match = { 0, NULL };
+     *     conf->pairs = NULL;
+     *     conf->tables = NULL;
      *     conf->types = { NULL };
      *     conf->types_keys = NULL;
      */
@@ -732,11 +960,23 @@ ngx_http_sub_merge_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_http_sub_loc_conf_t *conf = child;
 
     ngx_conf_merge_value(conf->once, prev->once, 1);
-    ngx_conf_merge_str_value(conf->match, prev->match, "");
     ngx_conf_merge_value(conf->last_modified, prev->last_modified, 0);
 
-    if (conf->value.value.data == NULL) {
-        conf->value = prev->value;
+    if (conf->pairs == NULL) {
+
+        if (prev->pairs && prev->tables == NULL) {
+            if (ngx_http_sub_init_tables(cf, prev) != NGX_OK) {
+                return NGX_CONF_ERROR;
+            }
+        }
+
+        conf->pairs = prev->pairs;
+        conf->tables = prev->tables;
+
+    } else if (conf->tables == NULL) {
+        if (ngx_http_sub_init_tables(cf, conf) != NGX_OK) {
+            return NGX_CONF_ERROR;
+        }
     }
 
     if (ngx_http_merge_types(cf, &conf->types_keys, &conf->types,
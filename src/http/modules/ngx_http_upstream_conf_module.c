@@ -0,0 +1,697 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/*
+ * The servers of an upstream in a shared zone are changed in place under
+ * the write locks of the peer lists, so all workers see the change at
+ * once.  New peers are appended to the list and removed ones are unlinked
+ * without touching the weights of others, so the smooth weighted round
+ * robin state is kept.  A removed peer is freed when the last connection
+ * to it is released.
+ */
+
+
+#define NGX_HTTP_UPSTREAM_CONF_LINE_LEN                                       \
+    (sizeof("server  weight= max_fails= fail_timeout=s backup drain;"         \
+            " # id=\n")                                                       \
+     + NGX_SOCKADDR_STRLEN + 3 * NGX_INT_T_LEN + NGX_TIME_T_LEN)
+
+
+typedef struct {
+    ngx_str_t                      upstream;
+    ngx_str_t                      server;
+
+    ngx_int_t                      id;
+    ngx_int_t                      weight;
+    ngx_int_t                      max_fails;
+    time_t                         fail_timeout;
+
+    unsigned                       add:1;
+    unsigned                       remove:1;
+    unsigned                       backup:1;
+    unsigned                       down:1;
+    unsigned                       up:1;
+    unsigned                       drain:1;
+} ngx_http_upstream_conf_args_t;
+
+
+static ngx_int_t ngx_http_upstream_conf_handler(ngx_http_request_t *r);
+static ngx_int_t ngx_http_upstream_conf_parse(ngx_http_request_t *r,
+    ngx_http_upstream_conf_args_t *args, char **err);
+static ngx_int_t ngx_http_upstream_conf_add(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err);
+static ngx_int_t ngx_http_upstream_conf_remove(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err);
+static ngx_int_t ngx_http_upstream_conf_update(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err);
+static ngx_http_upstream_rr_peer_t *ngx_http_upstream_conf_find(
+    ngx_http_upstream_rr_peers_t *peers, ngx_uint_t id,
+    ngx_http_upstream_rr_peers_t **list, ngx_http_upstream_rr_peer_t ***prev);
+static ngx_buf_t *ngx_http_upstream_conf_list(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *one);
+static u_char *ngx_http_upstream_conf_peer(u_char *p,
+    ngx_http_upstream_rr_peer_t *peer, ngx_uint_t backup);
+static void ngx_http_upstream_conf_wlock(ngx_http_upstream_rr_peers_t *peers);
+static void ngx_http_upstream_conf_unlock(ngx_http_upstream_rr_peers_t *peers);
+static ngx_int_t ngx_http_upstream_conf_send(ngx_http_request_t *r,
+    ngx_uint_t status, ngx_buf_t *b);
+
+static char *ngx_http_upstream_conf(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+
+
+static ngx_command_t  ngx_http_upstream_conf_commands[] = {
+
+    { ngx_string("upstream_conf"),
+      NGX_HTTP_LOC_CONF|NGX_CONF_NOARGS,
+      ngx_http_upstream_conf,
+      0,
+      0,
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_upstream_conf_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    NULL,                                  /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    NULL,                                  /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_upstream_conf_module = {
+    NGX_MODULE_V1,
+    &ngx_http_upstream_conf_module_ctx,    /* module context */
+    ngx_http_upstream_conf_commands,       /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_int_t
+ngx_http_upstream_conf_handler(ngx_http_request_t *r)
+{
+    char                           *err;
+    ngx_buf_t                      *b;
+    ngx_int_t                       rc;
+    ngx_uint_t                      i;
+    ngx_http_upstream_rr_peers_t   *peers;
+    ngx_http_upstream_conf_args_t   args;
+    ngx_http_upstream_srv_conf_t   *uscf, **uscfp;
+    ngx_http_upstream_main_conf_t  *umcf;
+
+    if (r->method != NGX_HTTP_GET && r->method != NGX_HTTP_HEAD) {
+        return NGX_HTTP_NOT_ALLOWED;
+    }
+
+    rc = ngx_http_discard_request_body(r);
+
+    if (rc != NGX_OK) {
+        return rc;
+    }
+
+    err = NULL;
+
+    if (ngx_http_upstream_conf_parse(r, &args, &err) != NGX_OK) {
+        if (err == NULL) {
+            return NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+
+        goto invalid;
+    }
+
+    umcf = ngx_http_get_module_main_conf(r, ngx_http_upstream_module);
+
+    uscf = NULL;
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+        if (uscfp[i]->srv_conf
+            && uscfp[i]->host.len == args.upstream.len
+            && ngx_strncasecmp(uscfp[i]->host.data, args.upstream.data,
+                               args.upstream.len)
+               == 0)
+        {
+            uscf = uscfp[i];
+            break;
+        }
+    }
+
+    if (uscf == NULL) {
+        err = "upstream not found";
+        rc = NGX_HTTP_NOT_FOUND;
+        goto failed;
+    }
+
+    peers = uscf->peer.data;
+
+    if (uscf->shm_zone == NULL || peers == NULL || peers->shpool == NULL) {
+        err = "upstream is not in a shared zone";
+        goto invalid;
+    }
+
+    b = NULL;
+
+    if (args.add) {
+        rc = ngx_http_upstream_conf_add(r, peers, &args, &b, &err);
+
+    } else if (args.remove) {
+        rc = ngx_http_upstream_conf_remove(r, peers, &args, &b, &err);
+
+    } else if (args.id != NGX_CONF_UNSET) {
+        rc = ngx_http_upstream_conf_update(r, peers, &args, &b, &err);
+
+    } else {
+        b = ngx_http_upstream_conf_list(r, peers, NULL);
+        rc = (b == NULL) ? NGX_HTTP_INTERNAL_SERVER_ERROR : NGX_OK;
+    }
+
+    if (rc != NGX_OK) {
+        goto failed;
+    }
+
+    return ngx_http_upstream_conf_send(r, NGX_HTTP_OK, b);
+
+invalid:
+
+    rc = NGX_HTTP_BAD_REQUEST;
+
+failed:
+
+    if (err == NULL) {
+        return rc;
+    }
+
+    b = ngx_create_temp_buf(r->pool, ngx_strlen(err) + 1);
+    if (b == NULL) {
+        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    b->last = ngx_cpymem(b->last, err, ngx_strlen(err));
+    *b->last++ = LF;
+
+    return ngx_http_upstream_conf_send(r, rc, b);
+}
+
+
+static ngx_int_t
+ngx_http_upstream_conf_parse(ngx_http_request_t *r,
+    ngx_http_upstream_conf_args_t *args, char **err)
+{
+    u_char     *dst, *src;
+    ngx_str_t   value;
+
+    ngx_memzero(args, sizeof(ngx_http_upstream_conf_args_t));
+
+    args->id = NGX_CONF_UNSET;
+    args->weight = NGX_CONF_UNSET;
+    args->max_fails = NGX_CONF_UNSET;
+    args->fail_timeout = NGX_CONF_UNSET;
+
+    if (ngx_http_arg(r, (u_char *) "upstream", 8, &args->upstream) != NGX_OK
+        || args->upstream.len == 0)
+    {
+        *err = "upstream is not specified";
+        return NGX_ERROR;
+    }
+
+    args->add = (ngx_http_arg(r, (u_char *) "add", 3, &value) == NGX_OK);
+    args->remove = (ngx_http_arg(r, (u_char *) "remove", 6, &value) == NGX_OK);
+    args->backup = (ngx_http_arg(r, (u_char *) "backup", 6, &value) == NGX_OK);
+    args->down = (ngx_http_arg(r, (u_char *) "down", 4, &value) == NGX_OK);
+    args->up = (ngx_http_arg(r, (u_char *) "up", 2, &value) == NGX_OK);
+    args->drain = (ngx_http_arg(r, (u_char *) "drain", 5, &value) == NGX_OK);
+
+    if (args->add + args->remove > 1
+        || args->down + args->up + args->drain > 1)
+    {
+        *err = "conflicting arguments";
+        return NGX_ERROR;
+    }
+
+    if (ngx_http_arg(r, (u_char *) "id", 2, &value) == NGX_OK) {
+        args->id = ngx_atoi(value.data, value.len);
+
+        if (args->id == NGX_ERROR) {
+            *err = "invalid id";
+            return NGX_ERROR;
+        }
+    }
+
+    if (ngx_http_arg(r, (u_char *) "weight", 6, &value) == NGX_OK) {
+        args->weight = ngx_atoi(value.data, value.len);
+
+        if (args->weight == NGX_ERROR || args->weight == 0) {
+            *err = "invalid weight";
+            return NGX_ERROR;
+        }
+    }
+
+    if (ngx_http_arg(r, (u_char *) "max_fails", 9, &value) == NGX_OK) {
+        args->max_fails = ngx_atoi(value.data, value.len);
+
+        if (args->max_fails == NGX_ERROR) {
+            *err = "invalid max_fails";
+            return NGX_ERROR;
+        }
+    }
+
+    if (ngx_http_arg(r, (u_char *) "fail_timeout", 12, &value) == NGX_OK) {
+        args->fail_timeout = ngx_parse_time(&value, 1);
+
+        if (args->fail_timeout == (time_t) NGX_ERROR) {
+            *err = "invalid fail_timeout";
+            return NGX_ERROR;
+        }
+    }
+
+    if (ngx_http_arg(r, (u_char *) "server", 6, &value) == NGX_OK) {
+
+        dst = ngx_pnalloc(r->pool, value.len);
+        if (dst == NULL) {
+            return NGX_ERROR;
+        }
+
+        args->server.data = dst;
+
+        src = value.data;
+        ngx_unescape_uri(&dst, &src, value.len, 0);
+
+        args->server.len = dst - args->server.data;
+    }
+
+    if ((args->add && args->server.len == 0)
+        || (args->remove && args->id == NGX_CONF_UNSET))
+    {
+        *err = args->add ? "server is not specified" : "id is not specified";
+        return NGX_ERROR;
+    }
+
+    if (!args->add && args->id == NGX_CONF_UNSET
+        && (args->weight != NGX_CONF_UNSET
+            || args->max_fails != NGX_CONF_UNSET
+            || args->fail_timeout != NGX_CONF_UNSET
+            || args->down || args->up || args->drain))
+    {
+        *err = "id is not specified";
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_conf_add(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err)
+{
+    ngx_url_t                      u;
+    ngx_uint_t                     id;
+    ngx_http_upstream_rr_peer_t    peer, *p, **last;
+    ngx_http_upstream_rr_peers_t  *list;
+
+    ngx_memzero(&u, sizeof(ngx_url_t));
+
+    u.url = args->server;
+    u.default_port = 80;
+    u.no_resolve = 1;
+
+    if (ngx_parse_url(r->pool, &u) != NGX_OK || u.naddrs == 0) {
+        *err = "invalid server address";
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    if (args->up || args->drain) {
+        *err = "invalid server state";
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    ngx_memzero(&peer, sizeof(ngx_http_upstream_rr_peer_t));
+
+    peer.sockaddr = u.addrs[0].sockaddr;
+    peer.socklen = u.addrs[0].socklen;
+    peer.name = u.addrs[0].name;
+    peer.server = args->server;
+    peer.weight = (args->weight != NGX_CONF_UNSET) ? args->weight : 1;
+    peer.effective_weight = peer.weight;
+    peer.max_fails = (args->max_fails != NGX_CONF_UNSET) ? args->max_fails : 1;
+    peer.fail_timeout = (args->fail_timeout != NGX_CONF_UNSET)
+                        ? args->fail_timeout : 10;
+    peer.down = args->down;
+
+    ngx_http_upstream_conf_wlock(peers);
+
+    list = args->backup ? peers->next : peers;
+
+    if (list == NULL) {
+        ngx_http_upstream_conf_unlock(peers);
+        *err = "upstream has no backup servers";
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    /* the lowest id not in use */
+
+    for (id = 0; /* void */; id++) {
+        if (ngx_http_upstream_conf_find(peers, id, NULL, NULL) == NULL) {
+            break;
+        }
+    }
+
+    peer.id = id;
+    peer.version = ++(*peers->config);
+
+    p = ngx_http_upstream_zone_copy_peer(list, &peer);
+    if (p == NULL) {
+        ngx_http_upstream_conf_unlock(peers);
+        *err = "upstream zone is too small";
+        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    p->next = NULL;
+
+    for (last = &list->peer; *last; last = &(*last)->next) { /* void */ }
+
+    *last = p;
+
+    list->number++;
+    list->total_weight += p->weight;
+    list->weighted = (list->total_weight != list->number);
+
+    if (list == peers) {
+        peers->single = (peers->number == 1 && peers->next == NULL);
+    }
+
+    *bp = ngx_http_upstream_conf_list(r, peers, p);
+
+    ngx_http_upstream_conf_unlock(peers);
+
+    ngx_log_error(NGX_LOG_NOTICE, r->connection->log, 0,
+                  "upstream server %V added to upstream \"%V\"",
+                  &peer.name, &args->upstream);
+
+    return (*bp == NULL) ? NGX_HTTP_INTERNAL_SERVER_ERROR : NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_conf_remove(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err)
+{
+    ngx_http_upstream_rr_peer_t    *peer, **prev;
+    ngx_http_upstream_rr_peers_t   *list;
+
+    ngx_http_upstream_conf_wlock(peers);
+
+    peer = ngx_http_upstream_conf_find(peers, args->id, &list, &prev);
+
+    if (peer == NULL) {
+        ngx_http_upstream_conf_unlock(peers);
+        *err = "server not found";
+        return NGX_HTTP_NOT_FOUND;
+    }
+
+    if (list == peers && peers->number == 1) {
+        ngx_http_upstream_conf_unlock(peers);
+        *err = "cannot remove the last server";
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    ngx_log_error(NGX_LOG_NOTICE, r->connection->log, 0,
+                  "upstream server %V removed from upstream \"%V\"",
+                  &peer->name, &args->upstream);
+
+    *prev = peer->next;
+
+    list->number--;
+    list->total_weight -= peer->weight;
+    list->weighted = (list->total_weight != list->number);
+
+    if (list == peers) {
+        peers->single = (peers->number == 1 && peers->next == NULL);
+    }
+
+    (*peers->config)++;
+
+    ngx_http_upstream_rr_peer_free(peers, peer);
+
+    *bp = ngx_http_upstream_conf_list(r, peers, NULL);
+
+    ngx_http_upstream_conf_unlock(peers);
+
+    return (*bp == NULL) ? NGX_HTTP_INTERNAL_SERVER_ERROR : NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_conf_update(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_conf_args_t *args,
+    ngx_buf_t **bp, char **err)
+{
+    ngx_http_upstream_rr_peer_t    *peer;
+    ngx_http_upstream_rr_peers_t   *list;
+
+    if (args->server.len || args->backup) {
+        *err = "server address and backup cannot be changed";
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    ngx_http_upstream_conf_wlock(peers);
+
+    peer = ngx_http_upstream_conf_find(peers, args->id, &list, NULL);
+
+    if (peer == NULL) {
+        ngx_http_upstream_conf_unlock(peers);
+        *err = "server not found";
+        return NGX_HTTP_NOT_FOUND;
+    }
+
+    if (args->weight != NGX_CONF_UNSET) {
+
+        /* current_weight is kept, so the selection order is not reset */
+
+        list->total_weight += args->weight - peer->weight;
+        list->weighted = (list->total_weight != list->number);
+
+        peer->weight = args->weight;
+        peer->effective_weight = args->weight;
+    }
+
+    if (args->max_fails != NGX_CONF_UNSET) {
+        peer->max_fails = args->max_fails;
+    }
+
+    if (args->fail_timeout != NGX_CONF_UNSET) {
+        peer->fail_timeout = args->fail_timeout;
+    }
+
+    if (args->down || args->drain) {
+        peer->down = 1;
+        peer->drain = args->drain;
+
+    } else if (args->up) {
+        peer->down = 0;
+        peer->drain = 0;
+    }
+
+    *bp = ngx_http_upstream_conf_list(r, peers, peer);
+
+    ngx_http_upstream_conf_unlock(peers);
+
+    return (*bp == NULL) ? NGX_HTTP_INTERNAL_SERVER_ERROR : NGX_OK;
+}
+
+
+static ngx_http_upstream_rr_peer_t *
+ngx_http_upstream_conf_find(ngx_http_upstream_rr_peers_t *peers,
+    ngx_uint_t id, ngx_http_upstream_rr_peers_t **list,
+    ngx_http_upstream_rr_peer_t ***prev)
+{
+    ngx_http_upstream_rr_peer_t  *peer, **peerp;
+
+    for ( /* void */ ; peers; peers = peers->next) {
+
+        for (peerp = &peers->peer; *peerp; peerp = &peer->next) {
+            peer = *peerp;
+
+            if (peer->id != id) {
+                continue;
+            }
+
+            if (list) {
+                *list = peers;
+            }
+
+            if (prev) {
+                *prev = peerp;
+            }
+
+            return peer;
+        }
+    }
+
+    return NULL;
+}
+
+
+static ngx_buf_t *
+ngx_http_upstream_conf_list(ngx_http_request_t *r,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *one)
+{
+    size_t                         size;
+    ngx_buf_t                     *b;
+    ngx_uint_t                     backup;
+    ngx_http_upstream_rr_peer_t   *peer;
+    ngx_http_upstream_rr_peers_t  *list;
+
+    size = 0;
+
+    if (one) {
+        size = NGX_HTTP_UPSTREAM_CONF_LINE_LEN;
+
+    } else {
+        for (list = peers; list; list = list->next) {
+            size += list->number * NGX_HTTP_UPSTREAM_CONF_LINE_LEN;
+        }
+    }
+
+    b = ngx_create_temp_buf(r->pool, size);
+    if (b == NULL) {
+        return NULL;
+    }
+
+    backup = 0;
+
+    for (list = peers; list; list = list->next) {
+
+        for (peer = list->peer; peer; peer = peer->next) {
+            if (one == NULL || peer == one) {
+                b->last = ngx_http_upstream_conf_peer(b->last, peer, backup);
+            }
+        }
+
+        backup = 1;
+    }
+
+    return b;
+}
+
+
+static u_char *
+ngx_http_upstream_conf_peer(u_char *p, ngx_http_upstream_rr_peer_t *peer,
+    ngx_uint_t backup)
+{
+    p = ngx_sprintf(p, "server %V weight=%i max_fails=%ui fail_timeout=%Ts",
+                    &peer->name, peer->weight, peer->max_fails,
+                    peer->fail_timeout);
+
+    if (backup) {
+        p = ngx_cpymem(p, " backup", sizeof(" backup") - 1);
+    }
+
+    if (peer->drain) {
+        p = ngx_cpymem(p, " drain", sizeof(" drain") - 1);
+
+    } else if (peer->down) {
+        p = ngx_cpymem(p, " down", sizeof(" down") - 1);
+    }
+
+    return ngx_sprintf(p, "; # id=%ui\n", peer->id);
+}
+
+
+static void
+ngx_http_upstream_conf_wlock(ngx_http_upstream_rr_peers_t *peers)
+{
+    ngx_http_upstream_rr_peers_wlock(peers);
+
+    if (peers->next) {
+        ngx_http_upstream_rr_peers_wlock(peers->next);
+    }
+}
+
+
+static void
+ngx_http_upstream_conf_unlock(ngx_http_upstream_rr_peers_t *peers)
+{
+    if (peers->next) {
+        ngx_http_upstream_rr_peers_unlock(peers->next);
+    }
+
+    ngx_http_upstream_rr_peers_unlock(peers);
+}
+
+
+static ngx_int_t
+ngx_http_upstream_conf_send(ngx_http_request_t *r, ngx_uint_t status,
+    ngx_buf_t *b)
+{
+    ngx_int_t    rc;
+    ngx_chain_t  out;
+
+    r->headers_out.status = status;
+    r->headers_out.content_length_n = b->last - b->pos;
+
+    ngx_str_set(&r->headers_out.content_type, "text/plain");
+    r->headers_out.content_type_len = sizeof("text/plain") - 1;
+    r->headers_out.content_type_lowcase = NULL;
+
+    rc = ngx_http_send_header(r);
+
+    if (rc == NGX_ERROR || rc > NGX_OK || r->header_only) {
+        return rc;
+    }
+
+    if (b->last == b->pos) {
+        return ngx_http_send_special(r, NGX_HTTP_LAST);
+    }
+
+    b->last_buf = (r == r->main) ? 1 : 0;
+    b->last_in_chain = 1;
+
+    out.buf = b;
+    out.next = NULL;
+
+    return ngx_http_output_filter(r, &out);
+}
+
+
+static char *
+ngx_http_upstream_conf(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_core_loc_conf_t  *clcf;
+
+    clcf = ngx_http_conf_get_module_loc_conf(cf, ngx_http_core_module);
+    clcf->handler = ngx_http_upstream_conf_handler;
+
+    return NGX_CONF_OK;
+}
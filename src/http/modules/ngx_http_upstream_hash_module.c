@@ -178,7 +178,10 @@ ngx_http_upstream_get_hash_peer(ngx_peer_connection_t *pc, void *data)
 
     ngx_http_upstream_rr_peers_wlock(hp->rrp.peers);
 
-    if (hp->tries > 20 || hp->rrp.peers->single) {
+    if (hp->tries > 20 || hp->rrp.peers->single
+        || hp->rrp.peers->number == 0
+        || ngx_http_upstream_rr_peers_changed(&hp->rrp))
+    {
         ngx_http_upstream_rr_peers_unlock(hp->rrp.peers);
         return hp->get_rr_peer(pc, &hp->rrp);
     }
@@ -231,7 +234,7 @@ ngx_http_upstream_get_hash_peer(ngx_peer_connection_t *pc, void *data)
         ngx_log_debug2(NGX_LOG_DEBUG_HTTP, pc->log, 0,
                        "get hash peer, value:%uD, peer:%ui", hp->hash, p);
 
-        if (peer->down) {
+        if (peer->down || peer->hc_down) {
             goto next;
         }
 
@@ -252,7 +255,7 @@ ngx_http_upstream_get_hash_peer(ngx_peer_connection_t *pc, void *data)
         }
     }
 
-    hp->rrp.current = peer;
+    ngx_http_upstream_rr_set_current(&hp->rrp, peer);
 
     pc->sockaddr = peer->sockaddr;
     pc->socklen = peer->socklen;
@@ -296,6 +299,15 @@ ngx_http_upstream_init_chash(ngx_conf_t *cf, ngx_http_upstream_srv_conf_t *us)
     us->peer.init = ngx_http_upstream_init_chash_peer;
 
     peers = us->peer.data;
+
+    if (peers->number == 0) {
+        ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                      "consistent hash requires servers resolved at start "
+                      "in upstream \"%V\" in %s:%ui",
+                      &us->host, us->file_name, us->line);
+        return NGX_ERROR;
+    }
+
     npoints = peers->total_weight * 160;
 
     size = sizeof(ngx_http_upstream_chash_points_t)
@@ -499,6 +511,11 @@ ngx_http_upstream_get_chash_peer(ngx_peer_connection_t *pc, void *data)
 
     ngx_http_upstream_rr_peers_wlock(hp->rrp.peers);
 
+    if (ngx_http_upstream_rr_peers_changed(&hp->rrp)) {
+        ngx_http_upstream_rr_peers_unlock(hp->rrp.peers);
+        return NGX_BUSY;
+    }
+
     pc->cached = 0;
     pc->connection = NULL;
 
@@ -531,7 +548,7 @@ ngx_http_upstream_get_chash_peer(ngx_peer_connection_t *pc, void *data)
                 continue;
             }
 
-            if (peer->down) {
+            if (peer->down || peer->hc_down) {
                 continue;
             }
 
@@ -578,7 +595,7 @@ ngx_http_upstream_get_chash_peer(ngx_peer_connection_t *pc, void *data)
 
 found:
 
-    hp->rrp.current = best;
+    ngx_http_upstream_rr_set_current(&hp->rrp, best);
 
     pc->sockaddr = best->sockaddr;
     pc->socklen = best->socklen;
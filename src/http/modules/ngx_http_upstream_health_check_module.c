@@ -0,0 +1,750 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+#define NGX_HTTP_UPSTREAM_HC_BUFFER  16384
+
+
+typedef struct {
+    ngx_msec_t                         interval;
+    ngx_msec_t                         timeout;
+    ngx_uint_t                         fails;
+    ngx_uint_t                         passes;
+    ngx_uint_t                         status_min;
+    ngx_uint_t                         status_max;
+    ngx_str_t                          uri;
+    ngx_str_t                          match;
+    ngx_str_t                          request;
+    ngx_http_upstream_srv_conf_t      *upstream;
+    ngx_event_t                        event;
+} ngx_http_upstream_hc_srv_conf_t;
+
+
+typedef struct {
+    ngx_http_upstream_hc_srv_conf_t   *conf;
+    ngx_http_upstream_rr_peers_t      *peers;
+    ngx_http_upstream_rr_peer_t       *peer;
+    ngx_peer_connection_t              pc;
+    ngx_buf_t                          request;
+    ngx_buf_t                         *response;
+    ngx_pool_t                        *pool;
+    ngx_log_t                          log;
+} ngx_http_upstream_hc_peer_t;
+
+
+static void ngx_http_upstream_hc_handler(ngx_event_t *ev);
+static void ngx_http_upstream_hc_start(ngx_http_upstream_hc_srv_conf_t *hcf,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *peer);
+static void ngx_http_upstream_hc_write_handler(ngx_event_t *wev);
+static void ngx_http_upstream_hc_read_handler(ngx_event_t *rev);
+static ngx_int_t ngx_http_upstream_hc_test(ngx_http_upstream_hc_peer_t *hp);
+static void ngx_http_upstream_hc_finalize(ngx_http_upstream_hc_peer_t *hp,
+    ngx_int_t rc);
+static u_char *ngx_http_upstream_hc_log_error(ngx_log_t *log, u_char *buf,
+    size_t len);
+static void ngx_http_upstream_hc_update(ngx_http_upstream_hc_srv_conf_t *hcf,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *peer,
+    ngx_int_t rc);
+
+static void *ngx_http_upstream_hc_create_conf(ngx_conf_t *cf);
+static char *ngx_http_upstream_hc(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+static ngx_int_t ngx_http_upstream_hc_init_module(ngx_cycle_t *cycle);
+static ngx_int_t ngx_http_upstream_hc_init_process(ngx_cycle_t *cycle);
+
+
+static ngx_command_t  ngx_http_upstream_hc_commands[] = {
+
+    { ngx_string("health_check"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_ANY,
+      ngx_http_upstream_hc,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      0,
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_upstream_health_check_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    NULL,                                  /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    ngx_http_upstream_hc_create_conf,      /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_upstream_health_check_module = {
+    NGX_MODULE_V1,
+    &ngx_http_upstream_health_check_module_ctx, /* module context */
+    ngx_http_upstream_hc_commands,         /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    ngx_http_upstream_hc_init_module,      /* init module */
+    ngx_http_upstream_hc_init_process,     /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static void
+ngx_http_upstream_hc_handler(ngx_event_t *ev)
+{
+    ngx_uint_t                        claimed;
+    ngx_http_upstream_rr_peer_t      *peer;
+    ngx_http_upstream_rr_peers_t     *peers;
+    ngx_http_upstream_hc_srv_conf_t  *hcf;
+
+    if (ngx_exiting) {
+        return;
+    }
+
+    hcf = ev->data;
+
+    /*
+     * the time of the last check is kept in the shared peer, so only
+     * the worker that is the first to notice the interval has passed
+     * checks the peer
+     */
+
+    for (peers = hcf->upstream->peer.data; peers; peers = peers->next) {
+
+        ngx_http_upstream_rr_peers_rlock(peers);
+
+        for (peer = peers->peer; peer; peer = peer->next) {
+
+            ngx_http_upstream_rr_peer_lock(peers, peer);
+
+            claimed = 0;
+
+            if (ngx_current_msec - peer->hc_checked >= hcf->interval) {
+                peer->hc_checked = ngx_current_msec;
+                claimed = 1;
+            }
+
+            ngx_http_upstream_rr_peer_unlock(peers, peer);
+
+            if (claimed) {
+                ngx_http_upstream_hc_start(hcf, peers, peer);
+            }
+        }
+
+        ngx_http_upstream_rr_peers_unlock(peers);
+    }
+
+    ngx_add_timer(ev, hcf->interval);
+}
+
+
+static void
+ngx_http_upstream_hc_start(ngx_http_upstream_hc_srv_conf_t *hcf,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *peer)
+{
+    ngx_int_t                     rc;
+    ngx_pool_t                   *pool;
+    ngx_connection_t             *c;
+    ngx_http_upstream_hc_peer_t  *hp;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "health check peer %V", &peer->name);
+
+    pool = ngx_create_pool(NGX_HTTP_UPSTREAM_HC_BUFFER + 1024,
+                           ngx_cycle->log);
+    if (pool == NULL) {
+        return;
+    }
+
+    hp = ngx_pcalloc(pool, sizeof(ngx_http_upstream_hc_peer_t));
+    if (hp == NULL) {
+        ngx_destroy_pool(pool);
+        return;
+    }
+
+    hp->response = ngx_create_temp_buf(pool, NGX_HTTP_UPSTREAM_HC_BUFFER);
+    if (hp->response == NULL) {
+        ngx_destroy_pool(pool);
+        return;
+    }
+
+    hp->conf = hcf;
+    hp->peers = peers;
+    hp->peer = peer;
+    hp->pool = pool;
+
+    /* the peer may be removed while it is being checked */
+
+    ngx_http_upstream_rr_peer_lock(peers, peer);
+    peer->refs++;
+    ngx_http_upstream_rr_peer_unlock(peers, peer);
+
+    hp->request.pos = hcf->request.data;
+    hp->request.last = hcf->request.data + hcf->request.len;
+
+    hp->pc.sockaddr = peer->sockaddr;
+    hp->pc.socklen = peer->socklen;
+    hp->pc.name = &peer->name;
+    hp->pc.get = ngx_event_get_peer;
+    hp->log = *ngx_cycle->log;
+    hp->log.handler = ngx_http_upstream_hc_log_error;
+    hp->log.data = hp;
+
+    hp->pc.log = &hp->log;
+    hp->pc.log_error = NGX_ERROR_ERR;
+
+    rc = ngx_event_connect_peer(&hp->pc);
+
+    if (rc == NGX_ERROR || rc == NGX_BUSY || rc == NGX_DECLINED) {
+        ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+        return;
+    }
+
+    c = hp->pc.connection;
+
+    c->data = hp;
+    c->pool = pool;
+
+    c->write->handler = ngx_http_upstream_hc_write_handler;
+    c->read->handler = ngx_http_upstream_hc_read_handler;
+
+    ngx_add_timer(c->write, hcf->timeout);
+    ngx_add_timer(c->read, hcf->timeout);
+
+    if (rc == NGX_OK) {
+        ngx_http_upstream_hc_write_handler(c->write);
+    }
+}
+
+
+static void
+ngx_http_upstream_hc_write_handler(ngx_event_t *wev)
+{
+    ssize_t                       n;
+    ngx_connection_t             *c;
+    ngx_http_upstream_hc_peer_t  *hp;
+
+    c = wev->data;
+    hp = c->data;
+
+    if (wev->timedout) {
+        ngx_log_error(NGX_LOG_ERR, c->log, NGX_ETIMEDOUT,
+                      "health check timed out");
+        ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+        return;
+    }
+
+    while (hp->request.pos < hp->request.last) {
+
+        n = c->send(c, hp->request.pos, hp->request.last - hp->request.pos);
+
+        if (n == NGX_AGAIN) {
+            if (ngx_handle_write_event(wev, 0) != NGX_OK) {
+                ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+            }
+
+            return;
+        }
+
+        if (n == NGX_ERROR) {
+            ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+            return;
+        }
+
+        hp->request.pos += n;
+    }
+
+    if (wev->timer_set) {
+        ngx_del_timer(wev);
+    }
+
+    if (c->read->ready) {
+        ngx_http_upstream_hc_read_handler(c->read);
+    }
+}
+
+
+static void
+ngx_http_upstream_hc_read_handler(ngx_event_t *rev)
+{
+    ssize_t                       n;
+    ngx_buf_t                    *b;
+    ngx_connection_t             *c;
+    ngx_http_upstream_hc_peer_t  *hp;
+
+    c = rev->data;
+    hp = c->data;
+
+    if (rev->timedout) {
+        ngx_log_error(NGX_LOG_ERR, c->log, NGX_ETIMEDOUT,
+                      "health check timed out");
+        ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+        return;
+    }
+
+    b = hp->response;
+
+    while (b->last < b->end) {
+
+        n = c->recv(c, b->last, b->end - b->last);
+
+        if (n == NGX_AGAIN) {
+            if (ngx_handle_read_event(rev, 0) != NGX_OK) {
+                ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+            }
+
+            return;
+        }
+
+        if (n == NGX_ERROR) {
+            ngx_http_upstream_hc_finalize(hp, NGX_ERROR);
+            return;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        b->last += n;
+    }
+
+    /* the response is complete or only its beginning is tested */
+
+    ngx_http_upstream_hc_finalize(hp, ngx_http_upstream_hc_test(hp));
+}
+
+
+static ngx_int_t
+ngx_http_upstream_hc_test(ngx_http_upstream_hc_peer_t *hp)
+{
+    u_char                           *p, *last, *body;
+    ngx_int_t                         status;
+    ngx_http_upstream_hc_srv_conf_t  *hcf;
+
+    hcf = hp->conf;
+
+    p = hp->response->pos;
+    last = hp->response->last;
+
+    /* "HTTP/1.x NNN" */
+
+    if (last - p < 12 || ngx_strncmp(p, "HTTP/", 5) != 0) {
+        ngx_log_error(NGX_LOG_ERR, hp->pc.connection->log, 0,
+                      "upstream sent invalid response");
+        return NGX_ERROR;
+    }
+
+    p = ngx_strlchr(p, last, ' ');
+
+    if (p == NULL || last - p < 4) {
+        ngx_log_error(NGX_LOG_ERR, hp->pc.connection->log, 0,
+                      "upstream sent invalid status line");
+        return NGX_ERROR;
+    }
+
+    status = ngx_atoi(p + 1, 3);
+
+    if (status < (ngx_int_t) hcf->status_min
+        || status > (ngx_int_t) hcf->status_max)
+    {
+        ngx_log_error(NGX_LOG_ERR, hp->pc.connection->log, 0,
+                      "upstream sent unexpected status %i", status);
+        return NGX_ERROR;
+    }
+
+    if (hcf->match.len == 0) {
+        return NGX_OK;
+    }
+
+    p = hp->response->pos;
+
+    body = ngx_strnstr(p, CRLF CRLF, last - p);
+
+    if (body == NULL
+        || ngx_strnstr(body + 4, (char *) hcf->match.data, last - body - 4)
+           == NULL)
+    {
+        ngx_log_error(NGX_LOG_ERR, hp->pc.connection->log, 0,
+                      "upstream response does not match \"%V\"",
+                      &hcf->match);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_hc_finalize(ngx_http_upstream_hc_peer_t *hp, ngx_int_t rc)
+{
+    ngx_http_upstream_hc_update(hp->conf, hp->peers, hp->peer, rc);
+
+    if (hp->pc.connection) {
+        ngx_close_connection(hp->pc.connection);
+    }
+
+    ngx_destroy_pool(hp->pool);
+}
+
+
+static u_char *
+ngx_http_upstream_hc_log_error(ngx_log_t *log, u_char *buf, size_t len)
+{
+    ngx_http_upstream_hc_peer_t  *hp;
+
+    hp = log->data;
+
+    return ngx_snprintf(buf, len,
+                        " while health checking %V in upstream \"%V\"",
+                        hp->pc.name, &hp->conf->upstream->host);
+}
+
+
+static void
+ngx_http_upstream_hc_update(ngx_http_upstream_hc_srv_conf_t *hcf,
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *peer,
+    ngx_int_t rc)
+{
+    ngx_uint_t  zombie;
+
+    ngx_http_upstream_rr_peers_rlock(peers);
+    ngx_http_upstream_rr_peer_lock(peers, peer);
+
+    peer->refs--;
+
+    if (peer->zombie) {
+        zombie = (peer->conns == 0 && peer->refs == 0);
+
+        ngx_http_upstream_rr_peer_unlock(peers, peer);
+        ngx_http_upstream_rr_peers_unlock(peers);
+
+        if (zombie) {
+            ngx_http_upstream_rr_peer_free(peers, peer);
+        }
+
+        return;
+    }
+
+    if (rc == NGX_OK) {
+        peer->hc_fails = 0;
+        peer->hc_passes++;
+
+        if (peer->hc_down && peer->hc_passes >= hcf->passes) {
+            peer->hc_down = 0;
+            peer->fails = 0;
+
+            ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
+                          "upstream server %V in upstream \"%V\" is up",
+                          &peer->name, &hcf->upstream->host);
+        }
+
+    } else {
+        peer->hc_passes = 0;
+        peer->hc_fails++;
+
+        if (!peer->hc_down && peer->hc_fails >= hcf->fails) {
+            peer->hc_down = 1;
+
+            ngx_log_error(NGX_LOG_WARN, ngx_cycle->log, 0,
+                          "upstream server %V in upstream \"%V\" is down",
+                          &peer->name, &hcf->upstream->host);
+        }
+    }
+
+    ngx_http_upstream_rr_peer_unlock(peers, peer);
+    ngx_http_upstream_rr_peers_unlock(peers);
+}
+
+
+static void *
+ngx_http_upstream_hc_create_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_hc_srv_conf_t  *conf;
+
+    conf = ngx_pcalloc(cf->pool, sizeof(ngx_http_upstream_hc_srv_conf_t));
+    if (conf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     conf->interval = 0;
+     *     conf->uri = { 0, NULL };
+     *     conf->match = { 0, NULL };
+     *     conf->request = { 0, NULL };
+     *     conf->upstream = NULL;
+     */
+
+    return conf;
+}
+
+
+static char *
+ngx_http_upstream_hc(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_upstream_hc_srv_conf_t *hcf = conf;
+
+    u_char                        *p;
+    ngx_int_t                      n, m;
+    ngx_str_t                     *value, s;
+    ngx_uint_t                     i;
+    ngx_http_upstream_srv_conf_t  *uscf;
+
+    if (hcf->interval) {
+        return "is duplicate";
+    }
+
+    hcf->interval = 5000;
+    hcf->timeout = 1000;
+    hcf->fails = 1;
+    hcf->passes = 1;
+    hcf->status_min = 200;
+    hcf->status_max = 399;
+    ngx_str_set(&hcf->uri, "/");
+
+    value = cf->args->elts;
+
+    for (i = 1; i < cf->args->nelts; i++) {
+
+        if (ngx_strncmp(value[i].data, "interval=", 9) == 0) {
+
+            s.len = value[i].len - 9;
+            s.data = &value[i].data[9];
+
+            hcf->interval = ngx_parse_time(&s, 0);
+
+            if (hcf->interval == (ngx_msec_t) NGX_ERROR
+                || hcf->interval == 0)
+            {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "timeout=", 8) == 0) {
+
+            s.len = value[i].len - 8;
+            s.data = &value[i].data[8];
+
+            hcf->timeout = ngx_parse_time(&s, 0);
+
+            if (hcf->timeout == (ngx_msec_t) NGX_ERROR || hcf->timeout == 0) {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "fails=", 6) == 0) {
+
+            n = ngx_atoi(&value[i].data[6], value[i].len - 6);
+
+            if (n == NGX_ERROR || n == 0) {
+                goto invalid;
+            }
+
+            hcf->fails = n;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "passes=", 7) == 0) {
+
+            n = ngx_atoi(&value[i].data[7], value[i].len - 7);
+
+            if (n == NGX_ERROR || n == 0) {
+                goto invalid;
+            }
+
+            hcf->passes = n;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "uri=", 4) == 0) {
+
+            hcf->uri.len = value[i].len - 4;
+            hcf->uri.data = &value[i].data[4];
+
+            if (hcf->uri.len == 0 || hcf->uri.data[0] != '/') {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "status=", 7) == 0) {
+
+            s.len = value[i].len - 7;
+            s.data = &value[i].data[7];
+
+            p = ngx_strlchr(s.data, s.data + s.len, '-');
+
+            if (p) {
+                n = ngx_atoi(s.data, p - s.data);
+                m = ngx_atoi(p + 1, s.data + s.len - p - 1);
+
+            } else {
+                n = ngx_atoi(s.data, s.len);
+                m = n;
+            }
+
+            if (n < 100 || m > 599 || n > m) {
+                goto invalid;
+            }
+
+            hcf->status_min = n;
+            hcf->status_max = m;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "match=", 6) == 0) {
+
+            hcf->match.len = value[i].len - 6;
+            hcf->match.data = &value[i].data[6];
+
+            if (hcf->match.len == 0) {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        goto invalid;
+    }
+
+    uscf = ngx_http_conf_get_module_srv_conf(cf, ngx_http_upstream_module);
+
+    hcf->upstream = uscf;
+
+    hcf->request.len = sizeof("GET  HTTP/1.0" CRLF) - 1 + hcf->uri.len
+                       + sizeof("Host: " CRLF) - 1 + uscf->host.len
+                       + sizeof("User-Agent: nginx health check" CRLF) - 1
+                       + sizeof(CRLF) - 1;
+
+    hcf->request.data = ngx_pnalloc(cf->pool, hcf->request.len);
+    if (hcf->request.data == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    ngx_sprintf(hcf->request.data,
+                "GET %V HTTP/1.0" CRLF
+                "Host: %V" CRLF
+                "User-Agent: nginx health check" CRLF CRLF,
+                &hcf->uri, &uscf->host);
+
+    return NGX_CONF_OK;
+
+invalid:
+
+    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                       "invalid parameter \"%V\"", &value[i]);
+
+    return NGX_CONF_ERROR;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_hc_init_module(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                        i;
+    ngx_http_upstream_srv_conf_t    **uscfp;
+    ngx_http_upstream_main_conf_t    *umcf;
+    ngx_http_upstream_hc_srv_conf_t  *hcf;
+
+    umcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_upstream_module);
+
+    if (umcf == NULL) {
+        return NGX_OK;
+    }
+
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+
+        if (uscfp[i]->srv_conf == NULL) {
+            continue;
+        }
+
+        hcf = ngx_http_conf_upstream_srv_conf(uscfp[i],
+                                        ngx_http_upstream_health_check_module);
+
+        if (hcf->interval && uscfp[i]->shm_zone == NULL) {
+            ngx_log_error(NGX_LOG_EMERG, cycle->log, 0,
+                          "\"health_check\" requires \"zone\" in upstream "
+                          "\"%V\" in %s:%ui", &uscfp[i]->host,
+                          uscfp[i]->file_name, uscfp[i]->line);
+            return NGX_ERROR;
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_hc_init_process(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                        i;
+    ngx_http_upstream_srv_conf_t    **uscfp;
+    ngx_http_upstream_main_conf_t    *umcf;
+    ngx_http_upstream_hc_srv_conf_t  *hcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER
+        && ngx_process != NGX_PROCESS_SINGLE)
+    {
+        return NGX_OK;
+    }
+
+    umcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_upstream_module);
+
+    if (umcf == NULL) {
+        return NGX_OK;
+    }
+
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+
+        if (uscfp[i]->srv_conf == NULL) {
+            continue;
+        }
+
+        hcf = ngx_http_conf_upstream_srv_conf(uscfp[i],
+                                        ngx_http_upstream_health_check_module);
+
+        if (hcf->interval == 0) {
+            continue;
+        }
+
+        hcf->event.handler = ngx_http_upstream_hc_handler;
+        hcf->event.data = hcf;
+        hcf->event.log = cycle->log;
+        hcf->event.cancelable = 1;
+
+        /* spread the first checks of the workers */
+
+        ngx_add_timer(&hcf->event, ngx_random() % 1000);
+    }
+
+    return NGX_OK;
+}
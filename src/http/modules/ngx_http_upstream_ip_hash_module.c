@@ -163,7 +163,10 @@ ngx_http_upstream_get_ip_hash_peer(ngx_peer_connection_t *pc, void *data)
 
     ngx_http_upstream_rr_peers_wlock(iphp->rrp.peers);
 
-    if (iphp->tries > 20 || iphp->rrp.peers->single) {
+    if (iphp->tries > 20 || iphp->rrp.peers->single
+        || iphp->rrp.peers->number == 0
+        || ngx_http_upstream_rr_peers_changed(&iphp->rrp))
+    {
         ngx_http_upstream_rr_peers_unlock(iphp->rrp.peers);
         return iphp->get_rr_peer(pc, &iphp->rrp);
     }
@@ -201,7 +204,7 @@ ngx_http_upstream_get_ip_hash_peer(ngx_peer_connection_t *pc, void *data)
         ngx_log_debug2(NGX_LOG_DEBUG_HTTP, pc->log, 0,
                        "get ip hash peer, hash: %ui %04XA", p, m);
 
-        if (peer->down) {
+        if (peer->down || peer->hc_down) {
             goto next;
         }
 
@@ -222,7 +225,7 @@ ngx_http_upstream_get_ip_hash_peer(ngx_peer_connection_t *pc, void *data)
         }
     }
 
-    iphp->rrp.current = peer;
+    ngx_http_upstream_rr_set_current(&iphp->rrp, peer);
 
     pc->sockaddr = peer->sockaddr;
     pc->socklen = peer->socklen;
@@ -10,11 +10,21 @@
 #include <ngx_http.h>
 
 
+#define NGX_HTTP_UPSTREAM_KEEPALIVE_FILL  1000
+
+
 typedef struct {
     ngx_uint_t                         max_cached;
+    ngx_uint_t                         min_idle;
+    ngx_uint_t                         requests;
+    ngx_msec_t                         timeout;
 
     ngx_queue_t                        cache;
     ngx_queue_t                        free;
+    ngx_queue_t                        connecting;
+
+    ngx_http_upstream_srv_conf_t      *upstream;
+    ngx_event_t                        event;
 
     ngx_http_upstream_init_pt          original_init_upstream;
     ngx_http_upstream_init_peer_pt     original_init_peer;
@@ -63,6 +73,15 @@ static void ngx_http_upstream_keepalive_dummy_handler(ngx_event_t *ev);
 static void ngx_http_upstream_keepalive_close_handler(ngx_event_t *ev);
 static void ngx_http_upstream_keepalive_close(ngx_connection_t *c);
 
+static void ngx_http_upstream_keepalive_fill_handler(ngx_event_t *ev);
+static ngx_uint_t ngx_http_upstream_keepalive_count(
+    ngx_http_upstream_keepalive_srv_conf_t *kcf,
+    ngx_http_upstream_rr_peer_t *peer);
+static ngx_int_t ngx_http_upstream_keepalive_prewarm(
+    ngx_http_upstream_keepalive_srv_conf_t *kcf,
+    ngx_http_upstream_rr_peer_t *peer);
+static void ngx_http_upstream_keepalive_connect_handler(ngx_event_t *ev);
+
 #if (NGX_HTTP_SSL)
 static ngx_int_t ngx_http_upstream_keepalive_set_session(
     ngx_peer_connection_t *pc, void *data);
@@ -73,17 +92,32 @@ static void ngx_http_upstream_keepalive_save_session(ngx_peer_connection_t *pc,
 static void *ngx_http_upstream_keepalive_create_conf(ngx_conf_t *cf);
 static char *ngx_http_upstream_keepalive(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static ngx_int_t ngx_http_upstream_keepalive_init_process(ngx_cycle_t *cycle);
 
 
 static ngx_command_t  ngx_http_upstream_keepalive_commands[] = {
 
     { ngx_string("keepalive"),
-      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE12,
       ngx_http_upstream_keepalive,
       NGX_HTTP_SRV_CONF_OFFSET,
       0,
       NULL },
 
+    { ngx_string("keepalive_timeout"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_msec_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_upstream_keepalive_srv_conf_t, timeout),
+      NULL },
+
+    { ngx_string("keepalive_requests"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_upstream_keepalive_srv_conf_t, requests),
+      NULL },
+
       ngx_null_command
 };
 
@@ -110,7 +144,7 @@ ngx_module_t  ngx_http_upstream_keepalive_module = {
     NGX_HTTP_MODULE,                       /* module type */
     NULL,                                  /* init master */
     NULL,                                  /* init module */
-    NULL,                                  /* init process */
+    ngx_http_upstream_keepalive_init_process, /* init process */
     NULL,                                  /* init thread */
     NULL,                                  /* exit thread */
     NULL,                                  /* exit process */
@@ -137,6 +171,9 @@ ngx_http_upstream_init_keepalive(ngx_conf_t *cf,
         return NGX_ERROR;
     }
 
+    ngx_conf_init_msec_value(kcf->timeout, 60000);
+    ngx_conf_init_uint_value(kcf->requests, 100);
+
     kcf->original_init_peer = us->peer.init;
 
     us->peer.init = ngx_http_upstream_init_keepalive_peer;
@@ -151,6 +188,7 @@ ngx_http_upstream_init_keepalive(ngx_conf_t *cf,
 
     ngx_queue_init(&kcf->cache);
     ngx_queue_init(&kcf->free);
+    ngx_queue_init(&kcf->connecting);
 
     for (i = 0; i < kcf->max_cached; i++) {
         ngx_queue_insert_head(&kcf->free, &cached[i].queue);
@@ -254,6 +292,10 @@ found:
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, pc->log, 0,
                    "get keepalive peer: using connection %p", c);
 
+    if (c->read->timer_set) {
+        ngx_del_timer(c->read);
+    }
+
     c->idle = 0;
     c->sent = 0;
     c->log = pc->log;
@@ -302,6 +344,10 @@ ngx_http_upstream_free_keepalive_peer(ngx_peer_connection_t *pc, void *data,
         goto invalid;
     }
 
+    if (c->requests >= kp->conf->requests) {
+        goto invalid;
+    }
+
     if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
         goto invalid;
     }
@@ -338,6 +384,8 @@ ngx_http_upstream_free_keepalive_peer(ngx_peer_connection_t *pc, void *data,
         ngx_del_timer(c->write);
     }
 
+    ngx_add_timer(c->read, kp->conf->timeout);
+
     c->write->handler = ngx_http_upstream_keepalive_dummy_handler;
     c->read->handler = ngx_http_upstream_keepalive_close_handler;
 
@@ -384,7 +432,7 @@ ngx_http_upstream_keepalive_close_handler(ngx_event_t *ev)
 
     c = ev->data;
 
-    if (c->close) {
+    if (c->close || ev->timedout) {
         goto close;
     }
 
@@ -435,6 +483,260 @@ ngx_http_upstream_keepalive_close(ngx_connection_t *c)
 }
 
 
+static void
+ngx_http_upstream_keepalive_fill_handler(ngx_event_t *ev)
+{
+    ngx_uint_t                               n, skip;
+    ngx_http_upstream_rr_peer_t             *peer;
+    ngx_http_upstream_rr_peers_t            *peers;
+    ngx_http_upstream_keepalive_srv_conf_t  *kcf;
+
+    if (ngx_exiting) {
+        return;
+    }
+
+    kcf = ev->data;
+
+    /* only the primary servers are kept warm */
+
+    peers = kcf->upstream->peer.data;
+
+    ngx_http_upstream_rr_peers_rlock(peers);
+
+    for (peer = peers->peer; peer; peer = peer->next) {
+
+        if (ngx_queue_empty(&kcf->free)) {
+            break;
+        }
+
+        ngx_http_upstream_rr_peer_lock(peers, peer);
+
+        skip = peer->down || peer->drain || peer->hc_down
+               || (peer->max_fails && peer->fails >= peer->max_fails
+                   && ngx_time() - peer->checked <= peer->fail_timeout);
+
+        ngx_http_upstream_rr_peer_unlock(peers, peer);
+
+        if (skip) {
+            continue;
+        }
+
+        for (n = ngx_http_upstream_keepalive_count(kcf, peer);
+             n < kcf->min_idle && !ngx_queue_empty(&kcf->free);
+             n++)
+        {
+            if (ngx_http_upstream_keepalive_prewarm(kcf, peer) != NGX_OK) {
+                break;
+            }
+        }
+    }
+
+    ngx_http_upstream_rr_peers_unlock(peers);
+
+    ngx_add_timer(ev, NGX_HTTP_UPSTREAM_KEEPALIVE_FILL);
+}
+
+
+static ngx_uint_t
+ngx_http_upstream_keepalive_count(ngx_http_upstream_keepalive_srv_conf_t *kcf,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+    ngx_uint_t                            n;
+    ngx_queue_t                          *q;
+    ngx_http_upstream_keepalive_cache_t  *item;
+
+    n = 0;
+
+    for (q = ngx_queue_head(&kcf->cache);
+         q != ngx_queue_sentinel(&kcf->cache);
+         q = ngx_queue_next(q))
+    {
+        item = ngx_queue_data(q, ngx_http_upstream_keepalive_cache_t, queue);
+
+        if (ngx_memn2cmp((u_char *) &item->sockaddr, (u_char *) peer->sockaddr,
+                         item->socklen, peer->socklen)
+            == 0)
+        {
+            n++;
+        }
+    }
+
+    for (q = ngx_queue_head(&kcf->connecting);
+         q != ngx_queue_sentinel(&kcf->connecting);
+         q = ngx_queue_next(q))
+    {
+        item = ngx_queue_data(q, ngx_http_upstream_keepalive_cache_t, queue);
+
+        if (ngx_memn2cmp((u_char *) &item->sockaddr, (u_char *) peer->sockaddr,
+                         item->socklen, peer->socklen)
+            == 0)
+        {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_keepalive_prewarm(ngx_http_upstream_keepalive_srv_conf_t *kcf,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+    ngx_int_t                             rc;
+    ngx_queue_t                          *q;
+    ngx_connection_t                     *c;
+    ngx_peer_connection_t                 pc;
+    ngx_http_upstream_keepalive_cache_t  *item;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "keepalive prewarm %V", &peer->name);
+
+    ngx_memzero(&pc, sizeof(ngx_peer_connection_t));
+
+    pc.sockaddr = peer->sockaddr;
+    pc.socklen = peer->socklen;
+    pc.name = &peer->name;
+    pc.get = ngx_event_get_peer;
+    pc.log = ngx_cycle->log;
+    pc.log_error = NGX_ERROR_ERR;
+
+    rc = ngx_event_connect_peer(&pc);
+
+    if (rc == NGX_ERROR || rc == NGX_BUSY || rc == NGX_DECLINED) {
+        return NGX_ERROR;
+    }
+
+    c = pc.connection;
+
+    c->pool = ngx_create_pool(128, ngx_cycle->log);
+    if (c->pool == NULL) {
+        ngx_close_connection(c);
+        return NGX_ERROR;
+    }
+
+    q = ngx_queue_head(&kcf->free);
+    ngx_queue_remove(q);
+
+    item = ngx_queue_data(q, ngx_http_upstream_keepalive_cache_t, queue);
+
+    ngx_queue_insert_head(&kcf->connecting, q);
+
+    item->connection = c;
+    item->socklen = pc.socklen;
+    ngx_memcpy(&item->sockaddr, pc.sockaddr, pc.socklen);
+
+    c->data = item;
+    c->idle = 1;
+
+    c->write->handler = ngx_http_upstream_keepalive_connect_handler;
+    c->read->handler = ngx_http_upstream_keepalive_connect_handler;
+
+    if (rc == NGX_AGAIN) {
+        ngx_add_timer(c->write, kcf->timeout);
+        return NGX_OK;
+    }
+
+    ngx_http_upstream_keepalive_connect_handler(c->write);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_keepalive_connect_handler(ngx_event_t *ev)
+{
+    int                                      err;
+    socklen_t                                len;
+    ngx_connection_t                        *c;
+    ngx_http_upstream_keepalive_cache_t     *item;
+    ngx_http_upstream_keepalive_srv_conf_t  *kcf;
+
+    c = ev->data;
+    item = c->data;
+    kcf = item->conf;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ev->log, 0,
+                   "keepalive connect handler");
+
+    if (c->close) {
+        goto failed;
+    }
+
+    if (ev->timedout) {
+        ngx_log_error(NGX_LOG_ERR, c->log, NGX_ETIMEDOUT,
+                      "upstream timed out while prewarming connection");
+        goto failed;
+    }
+
+#if (NGX_HAVE_KQUEUE)
+
+    if (ngx_event_flags & NGX_USE_KQUEUE_EVENT)  {
+        if (c->write->pending_eof || c->read->pending_eof) {
+            err = c->write->pending_eof ? c->write->kq_errno
+                                        : c->read->kq_errno;
+
+            ngx_log_error(NGX_LOG_ERR, c->log, err,
+                          "kevent() reported that connect() failed");
+            goto failed;
+        }
+
+    } else
+#endif
+    {
+        err = 0;
+        len = sizeof(int);
+
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, (void *) &err, &len)
+            == -1)
+        {
+            err = ngx_socket_errno;
+        }
+
+        if (err) {
+            ngx_log_error(NGX_LOG_ERR, c->log, err, "connect() failed");
+            goto failed;
+        }
+    }
+
+    if (c->write->timer_set) {
+        ngx_del_timer(c->write);
+    }
+
+    if (ngx_handle_write_event(c->write, 0) != NGX_OK) {
+        goto failed;
+    }
+
+    if (ngx_handle_read_event(c->read, 0) != NGX_OK) {
+        goto failed;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ev->log, 0,
+                   "keepalive prewarm: saving connection %p", c);
+
+    ngx_queue_remove(&item->queue);
+    ngx_queue_insert_head(&kcf->cache, &item->queue);
+
+    ngx_add_timer(c->read, kcf->timeout);
+
+    c->write->handler = ngx_http_upstream_keepalive_dummy_handler;
+    c->read->handler = ngx_http_upstream_keepalive_close_handler;
+
+    if (c->read->ready) {
+        ngx_http_upstream_keepalive_close_handler(c->read);
+    }
+
+    return;
+
+failed:
+
+    ngx_queue_remove(&item->queue);
+    ngx_queue_insert_head(&kcf->free, &item->queue);
+
+    ngx_http_upstream_keepalive_close(c);
+}
+
+
 #if (NGX_HTTP_SSL)
 
 static ngx_int_t
@@ -475,8 +777,13 @@ ngx_http_upstream_keepalive_create_conf(ngx_conf_t *cf)
      *     conf->original_init_upstream = NULL;
      *     conf->original_init_peer = NULL;
      *     conf->max_cached = 0;
+     *     conf->min_idle = 0;
+     *     conf->upstream = NULL;
      */
 
+    conf->timeout = NGX_CONF_UNSET_MSEC;
+    conf->requests = NGX_CONF_UNSET_UINT;
+
     return conf;
 }
 
@@ -487,7 +794,7 @@ ngx_http_upstream_keepalive(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     ngx_http_upstream_srv_conf_t            *uscf;
     ngx_http_upstream_keepalive_srv_conf_t  *kcf = conf;
 
-    ngx_int_t    n;
+    ngx_int_t    n, m;
     ngx_str_t   *value;
 
     if (kcf->max_cached) {
@@ -509,8 +816,29 @@ ngx_http_upstream_keepalive(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     kcf->max_cached = n;
 
+    if (cf->args->nelts == 3) {
+
+        if (ngx_strncmp(value[2].data, "min_idle=", 9) != 0) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "invalid parameter \"%V\"", &value[2]);
+            return NGX_CONF_ERROR;
+        }
+
+        m = ngx_atoi(value[2].data + 9, value[2].len - 9);
+
+        if (m == NGX_ERROR || m > n) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "invalid parameter \"%V\"", &value[2]);
+            return NGX_CONF_ERROR;
+        }
+
+        kcf->min_idle = m;
+    }
+
     uscf = ngx_http_conf_get_module_srv_conf(cf, ngx_http_upstream_module);
 
+    kcf->upstream = uscf;
+
     kcf->original_init_upstream = uscf->peer.init_upstream
                                   ? uscf->peer.init_upstream
                                   : ngx_http_upstream_init_round_robin;
@@ -519,3 +847,50 @@ ngx_http_upstream_keepalive(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     return NGX_CONF_OK;
 }
+
+
+static ngx_int_t
+ngx_http_upstream_keepalive_init_process(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                               i;
+    ngx_http_upstream_srv_conf_t           **uscfp;
+    ngx_http_upstream_main_conf_t           *umcf;
+    ngx_http_upstream_keepalive_srv_conf_t  *kcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER
+        && ngx_process != NGX_PROCESS_SINGLE)
+    {
+        return NGX_OK;
+    }
+
+    umcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_upstream_module);
+
+    if (umcf == NULL) {
+        return NGX_OK;
+    }
+
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+
+        if (uscfp[i]->srv_conf == NULL) {
+            continue;
+        }
+
+        kcf = ngx_http_conf_upstream_srv_conf(uscfp[i],
+                                          ngx_http_upstream_keepalive_module);
+
+        if (kcf->min_idle == 0) {
+            continue;
+        }
+
+        kcf->event.handler = ngx_http_upstream_keepalive_fill_handler;
+        kcf->event.data = kcf;
+        kcf->event.log = cycle->log;
+        kcf->event.cancelable = 1;
+
+        ngx_add_timer(&kcf->event, ngx_random() % 1000);
+    }
+
+    return NGX_OK;
+}
@@ -124,6 +124,11 @@ ngx_http_upstream_get_least_conn_peer(ngx_peer_connection_t *pc, void *data)
 
     ngx_http_upstream_rr_peers_wlock(peers);
 
+    if (ngx_http_upstream_rr_peers_changed(rrp)) {
+        ngx_http_upstream_rr_peers_unlock(peers);
+        return ngx_http_upstream_get_round_robin_peer(pc, rrp);
+    }
+
     best = NULL;
     total = 0;
 
@@ -144,7 +149,7 @@ ngx_http_upstream_get_least_conn_peer(ngx_peer_connection_t *pc, void *data)
             continue;
         }
 
-        if (peer->down) {
+        if (peer->down || peer->hc_down) {
             continue;
         }
 
@@ -195,7 +200,7 @@ ngx_http_upstream_get_least_conn_peer(ngx_peer_connection_t *pc, void *data)
                 continue;
             }
 
-            if (peer->down) {
+            if (peer->down || peer->hc_down) {
                 continue;
             }
 
@@ -236,7 +241,7 @@ ngx_http_upstream_get_least_conn_peer(ngx_peer_connection_t *pc, void *data)
 
     best->conns++;
 
-    rrp->current = best;
+    ngx_http_upstream_rr_set_current(rrp, best);
 
     n = p / (8 * sizeof(uintptr_t));
     m = (uintptr_t) 1 << p % (8 * sizeof(uintptr_t));
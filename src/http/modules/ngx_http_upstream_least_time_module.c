@@ -0,0 +1,508 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+#define NGX_HTTP_UPSTREAM_LT_HEADER     0
+#define NGX_HTTP_UPSTREAM_LT_LAST_BYTE  1
+
+/* the period over which old samples lose most of their weight, msec */
+#define NGX_HTTP_UPSTREAM_LT_DECAY      10000
+
+
+typedef struct {
+    ngx_uint_t                         mode;
+} ngx_http_upstream_least_time_srv_conf_t;
+
+
+typedef struct {
+    /* the round robin data must be first */
+    ngx_http_upstream_rr_peer_data_t   rrp;
+
+    ngx_http_upstream_least_time_srv_conf_t  *conf;
+    ngx_http_upstream_t               *upstream;
+} ngx_http_upstream_least_time_peer_data_t;
+
+
+static ngx_int_t ngx_http_upstream_init_least_time_peer(ngx_http_request_t *r,
+    ngx_http_upstream_srv_conf_t *us);
+static ngx_int_t ngx_http_upstream_get_least_time_peer(
+    ngx_peer_connection_t *pc, void *data);
+static void ngx_http_upstream_free_least_time_peer(ngx_peer_connection_t *pc,
+    void *data, ngx_uint_t state);
+static ngx_uint_t ngx_http_upstream_least_time_usable(
+    ngx_http_upstream_rr_peer_data_t *rrp, ngx_http_upstream_rr_peer_t *peer,
+    ngx_uint_t i, time_t now);
+static uint64_t ngx_http_upstream_least_time_cost(
+    ngx_http_upstream_rr_peer_t *peer, ngx_msec_t now);
+static void *ngx_http_upstream_least_time_create_conf(ngx_conf_t *cf);
+static char *ngx_http_upstream_least_time(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+
+
+static ngx_command_t  ngx_http_upstream_least_time_commands[] = {
+
+    { ngx_string("least_time"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      ngx_http_upstream_least_time,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      0,
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_upstream_least_time_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    NULL,                                  /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    ngx_http_upstream_least_time_create_conf, /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_upstream_least_time_module = {
+    NGX_MODULE_V1,
+    &ngx_http_upstream_least_time_module_ctx, /* module context */
+    ngx_http_upstream_least_time_commands, /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_int_t
+ngx_http_upstream_init_least_time(ngx_conf_t *cf,
+    ngx_http_upstream_srv_conf_t *us)
+{
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, cf->log, 0,
+                   "init least time");
+
+    if (ngx_http_upstream_init_round_robin(cf, us) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    us->peer.init = ngx_http_upstream_init_least_time_peer;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_init_least_time_peer(ngx_http_request_t *r,
+    ngx_http_upstream_srv_conf_t *us)
+{
+    ngx_http_upstream_least_time_peer_data_t  *ltp;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "init least time peer");
+
+    ltp = ngx_palloc(r->pool, sizeof(ngx_http_upstream_least_time_peer_data_t));
+    if (ltp == NULL) {
+        return NGX_ERROR;
+    }
+
+    r->upstream->peer.data = &ltp->rrp;
+
+    if (ngx_http_upstream_init_round_robin_peer(r, us) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    ltp->conf = ngx_http_conf_upstream_srv_conf(us,
+                                          ngx_http_upstream_least_time_module);
+    ltp->upstream = r->upstream;
+
+    r->upstream->peer.get = ngx_http_upstream_get_least_time_peer;
+    r->upstream->peer.free = ngx_http_upstream_free_least_time_peer;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_get_least_time_peer(ngx_peer_connection_t *pc, void *data)
+{
+    ngx_http_upstream_rr_peer_data_t  *rrp = data;
+
+    time_t                         now;
+    uint64_t                       c1, c2;
+    uintptr_t                      m;
+    ngx_int_t                      rc;
+    ngx_uint_t                     i, n, p, p1, p2, k, k1, k2, usable;
+    ngx_msec_t                     msec;
+    ngx_http_upstream_rr_peer_t   *peer, *best, *peer1, *peer2;
+    ngx_http_upstream_rr_peers_t  *peers;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                   "get least time peer, try: %ui", pc->tries);
+
+    if (rrp->peers->single) {
+        return ngx_http_upstream_get_round_robin_peer(pc, rrp);
+    }
+
+    pc->cached = 0;
+    pc->connection = NULL;
+
+    now = ngx_time();
+    msec = ngx_current_msec;
+
+    peers = rrp->peers;
+
+    ngx_http_upstream_rr_peers_wlock(peers);
+
+    if (ngx_http_upstream_rr_peers_changed(rrp)) {
+        ngx_http_upstream_rr_peers_unlock(peers);
+        return ngx_http_upstream_get_round_robin_peer(pc, rrp);
+    }
+
+    usable = 0;
+
+    for (peer = peers->peer, i = 0;
+         peer;
+         peer = peer->next, i++)
+    {
+        if (ngx_http_upstream_least_time_usable(rrp, peer, i, now)) {
+            usable++;
+        }
+    }
+
+    if (usable == 0) {
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                       "get least time peer, no peer found");
+
+        goto failed;
+    }
+
+    /*
+     * power of two choices: pick two distinct usable peers at random
+     * and use the one with the lower expected latency
+     */
+
+    k1 = ngx_random() % usable;
+
+    if (usable > 1) {
+        k2 = ngx_random() % (usable - 1);
+
+        if (k2 >= k1) {
+            k2++;
+        }
+
+    } else {
+        k2 = k1;
+    }
+
+    peer1 = NULL;
+    peer2 = NULL;
+    p1 = 0;
+    p2 = 0;
+
+    for (peer = peers->peer, i = 0, k = 0;
+         peer;
+         peer = peer->next, i++)
+    {
+        if (!ngx_http_upstream_least_time_usable(rrp, peer, i, now)) {
+            continue;
+        }
+
+        if (k == k1) {
+            peer1 = peer;
+            p1 = i;
+        }
+
+        if (k == k2) {
+            peer2 = peer;
+            p2 = i;
+        }
+
+        k++;
+    }
+
+    c1 = ngx_http_upstream_least_time_cost(peer1, msec);
+    c2 = ngx_http_upstream_least_time_cost(peer2, msec);
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                   "get least time peer, choices: %ui:%uL %ui:%uL",
+                   p1, c1, p2, c2);
+
+    if (c2 < c1) {
+        best = peer2;
+        p = p2;
+
+    } else {
+        best = peer1;
+        p = p1;
+    }
+
+    if (now - best->checked > best->fail_timeout) {
+        best->checked = now;
+    }
+
+    pc->sockaddr = best->sockaddr;
+    pc->socklen = best->socklen;
+    pc->name = &best->name;
+
+    best->conns++;
+
+    ngx_http_upstream_rr_set_current(rrp, best);
+
+    n = p / (8 * sizeof(uintptr_t));
+    m = (uintptr_t) 1 << p % (8 * sizeof(uintptr_t));
+
+    rrp->tried[n] |= m;
+
+    ngx_http_upstream_rr_peers_unlock(peers);
+
+    return NGX_OK;
+
+failed:
+
+    if (peers->next) {
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                       "get least time peer, backup servers");
+
+        rrp->peers = peers->next;
+
+        n = (rrp->peers->number + (8 * sizeof(uintptr_t) - 1))
+                / (8 * sizeof(uintptr_t));
+
+        for (i = 0; i < n; i++) {
+             rrp->tried[i] = 0;
+        }
+
+        ngx_http_upstream_rr_peers_unlock(peers);
+
+        rc = ngx_http_upstream_get_least_time_peer(pc, rrp);
+
+        if (rc != NGX_BUSY) {
+            return rc;
+        }
+
+        ngx_http_upstream_rr_peers_wlock(peers);
+    }
+
+    /* all peers failed, mark them as live for quick recovery */
+
+    for (peer = peers->peer; peer; peer = peer->next) {
+        peer->fails = 0;
+    }
+
+    ngx_http_upstream_rr_peers_unlock(peers);
+
+    pc->name = peers->name;
+
+    return NGX_BUSY;
+}
+
+
+static void
+ngx_http_upstream_free_least_time_peer(ngx_peer_connection_t *pc, void *data,
+    ngx_uint_t state)
+{
+    ngx_http_upstream_least_time_peer_data_t  *ltp = data;
+
+    uint64_t                       sample;
+    ngx_msec_t                     now, elapsed;
+    ngx_http_upstream_t           *u;
+    ngx_http_upstream_rr_peer_t   *peer;
+    ngx_http_upstream_rr_peers_t  *peers;
+
+    u = ltp->upstream;
+
+    if (state & NGX_PEER_FAILED || u->state == NULL) {
+        goto done;
+    }
+
+    /*
+     * the response time is only converted to a duration when
+     * the request is finalized, that is, with zero state
+     */
+
+    if (ltp->conf->mode == NGX_HTTP_UPSTREAM_LT_HEADER) {
+        if (u->state->header_time == (ngx_msec_t) -1) {
+            goto done;
+        }
+
+        sample = (uint64_t) u->state->header_time * 1000;
+
+    } else {
+        if (state != 0) {
+            goto done;
+        }
+
+        sample = (uint64_t) u->state->response_time * 1000;
+    }
+
+    peers = ltp->rrp.peers;
+    peer = ltp->rrp.current;
+
+    now = ngx_current_msec;
+
+    ngx_http_upstream_rr_peers_rlock(peers);
+    ngx_http_upstream_rr_peer_lock(peers, peer);
+
+    /* peak ewma: jump to slower samples at once, decay towards faster ones */
+
+    if (sample > peer->ewma || peer->ewma_updated == 0) {
+        peer->ewma = sample;
+
+    } else {
+        elapsed = now - peer->ewma_updated + 1;
+
+        if (elapsed > NGX_HTTP_UPSTREAM_LT_DECAY) {
+            elapsed = NGX_HTTP_UPSTREAM_LT_DECAY;
+        }
+
+        peer->ewma = (peer->ewma * NGX_HTTP_UPSTREAM_LT_DECAY
+                      + sample * elapsed)
+                     / (NGX_HTTP_UPSTREAM_LT_DECAY + elapsed);
+    }
+
+    peer->ewma_updated = now;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                   "free least time peer, sample: %uL ewma: %uL",
+                   sample, peer->ewma);
+
+    ngx_http_upstream_rr_peer_unlock(peers, peer);
+    ngx_http_upstream_rr_peers_unlock(peers);
+
+done:
+
+    ngx_http_upstream_free_round_robin_peer(pc, &ltp->rrp, state);
+}
+
+
+static ngx_uint_t
+ngx_http_upstream_least_time_usable(ngx_http_upstream_rr_peer_data_t *rrp,
+    ngx_http_upstream_rr_peer_t *peer, ngx_uint_t i, time_t now)
+{
+    uintptr_t   m;
+    ngx_uint_t  n;
+
+    n = i / (8 * sizeof(uintptr_t));
+    m = (uintptr_t) 1 << i % (8 * sizeof(uintptr_t));
+
+    if (rrp->tried[n] & m) {
+        return 0;
+    }
+
+    if (peer->down || peer->hc_down) {
+        return 0;
+    }
+
+    if (peer->max_fails
+        && peer->fails >= peer->max_fails
+        && now - peer->checked <= peer->fail_timeout)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+
+static uint64_t
+ngx_http_upstream_least_time_cost(ngx_http_upstream_rr_peer_t *peer,
+    ngx_msec_t now)
+{
+    uint64_t    ewma;
+    ngx_msec_t  elapsed;
+
+    /*
+     * a peer that was not sampled for a while decays towards zero,
+     * so that a slow peer is retried once it is no longer chosen
+     */
+
+    ewma = peer->ewma;
+
+    if (ewma && peer->conns == 0) {
+        elapsed = now - peer->ewma_updated;
+        ewma = ewma * NGX_HTTP_UPSTREAM_LT_DECAY
+               / (NGX_HTTP_UPSTREAM_LT_DECAY + elapsed);
+    }
+
+    return (ewma + 1) * (peer->conns + 1) * 100 / peer->weight;
+}
+
+
+static void *
+ngx_http_upstream_least_time_create_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_least_time_srv_conf_t  *conf;
+
+    conf = ngx_pcalloc(cf->pool,
+                       sizeof(ngx_http_upstream_least_time_srv_conf_t));
+    if (conf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     conf->mode = NGX_HTTP_UPSTREAM_LT_HEADER;
+     */
+
+    return conf;
+}
+
+
+static char *
+ngx_http_upstream_least_time(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_upstream_least_time_srv_conf_t  *ltcf = conf;
+
+    ngx_str_t                     *value;
+    ngx_http_upstream_srv_conf_t  *uscf;
+
+    uscf = ngx_http_conf_get_module_srv_conf(cf, ngx_http_upstream_module);
+
+    value = cf->args->elts;
+
+    if (ngx_strcmp(value[1].data, "header") == 0) {
+        ltcf->mode = NGX_HTTP_UPSTREAM_LT_HEADER;
+
+    } else if (ngx_strcmp(value[1].data, "last_byte") == 0) {
+        ltcf->mode = NGX_HTTP_UPSTREAM_LT_LAST_BYTE;
+
+    } else {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "invalid parameter \"%V\"", &value[1]);
+        return NGX_CONF_ERROR;
+    }
+
+    if (uscf->peer.init_upstream) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "load balancing method redefined");
+    }
+
+    uscf->peer.init_upstream = ngx_http_upstream_init_least_time;
+
+    uscf->flags = NGX_HTTP_UPSTREAM_CREATE
+                  |NGX_HTTP_UPSTREAM_WEIGHT
+                  |NGX_HTTP_UPSTREAM_MAX_FAILS
+                  |NGX_HTTP_UPSTREAM_FAIL_TIMEOUT
+                  |NGX_HTTP_UPSTREAM_DOWN
+                  |NGX_HTTP_UPSTREAM_BACKUP;
+
+    return NGX_CONF_OK;
+}
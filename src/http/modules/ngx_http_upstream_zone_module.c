@@ -10,12 +10,58 @@
 #include <ngx_http.h>
 
 
+/* retry in 10s if a name could not be resolved */
+#define NGX_HTTP_UPSTREAM_ZONE_RESOLVE_RETRY  10
+
+
+typedef struct {
+    ngx_event_t                     event;
+    ngx_http_upstream_srv_conf_t   *upstream;
+    ngx_http_upstream_server_t     *server;
+    ngx_pool_t                     *pool;
+    ngx_array_t                     addrs;
+    ngx_uint_t                      pending;
+    ngx_uint_t                      failed;   /* unsigned  failed:1; */
+    time_t                          valid;
+} ngx_http_upstream_zone_host_t;
+
+
+typedef struct {
+    ngx_http_upstream_zone_host_t  *host;
+    in_port_t                       port;
+    ngx_uint_t                      weight;
+} ngx_http_upstream_zone_target_t;
+
+
+typedef struct {
+    struct sockaddr                *sockaddr;
+    socklen_t                       socklen;
+    ngx_str_t                       name;
+    ngx_uint_t                      weight;
+    ngx_uint_t                      found;    /* unsigned  found:1; */
+} ngx_http_upstream_zone_addr_t;
+
+
 static char *ngx_http_upstream_zone(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static ngx_int_t ngx_http_upstream_init_zone(ngx_shm_zone_t *shm_zone,
     void *data);
 static ngx_int_t ngx_http_upstream_zone_copy_peers(ngx_slab_pool_t *shpool,
     ngx_http_upstream_srv_conf_t *uscf);
+static ngx_int_t ngx_http_upstream_zone_init_worker(ngx_cycle_t *cycle);
+static void ngx_http_upstream_zone_resolve_handler(ngx_event_t *ev);
+static ngx_int_t ngx_http_upstream_zone_resolve_name(
+    ngx_http_upstream_zone_host_t *host, ngx_str_t *name, in_port_t port,
+    ngx_uint_t weight);
+static void ngx_http_upstream_zone_resolve_srv_handler(ngx_resolver_ctx_t *ctx);
+static void ngx_http_upstream_zone_resolve_name_handler(
+    ngx_resolver_ctx_t *ctx);
+static void ngx_http_upstream_zone_resolve_done(
+    ngx_http_upstream_zone_host_t *host);
+static void ngx_http_upstream_zone_resolve_update(
+    ngx_http_upstream_zone_host_t *host);
+static ngx_uint_t ngx_http_upstream_zone_peer_id(
+    ngx_http_upstream_rr_peers_t *peers);
 
 
 static ngx_command_t  ngx_http_upstream_zone_commands[] = {
@@ -53,7 +99,7 @@ ngx_module_t  ngx_http_upstream_zone_module = {
     NGX_HTTP_MODULE,                       /* module type */
     NULL,                                  /* init master */
     NULL,                                  /* init module */
-    NULL,                                  /* init process */
+    ngx_http_upstream_zone_init_worker,    /* init process */
     NULL,                                  /* init thread */
     NULL,                                  /* exit thread */
     NULL,                                  /* exit process */
@@ -166,8 +212,14 @@ static ngx_int_t
 ngx_http_upstream_zone_copy_peers(ngx_slab_pool_t *shpool,
     ngx_http_upstream_srv_conf_t *uscf)
 {
-    ngx_http_upstream_rr_peer_t   *peer, **peerp;
-    ngx_http_upstream_rr_peers_t  *peers, *backup;
+    ngx_uint_t                     *config;
+    ngx_http_upstream_rr_peer_t    *peer, **peerp;
+    ngx_http_upstream_rr_peers_t   *peers, *backup;
+
+    config = ngx_slab_calloc(shpool, sizeof(ngx_uint_t));
+    if (config == NULL) {
+        return NGX_ERROR;
+    }
 
     peers = ngx_slab_alloc(shpool, sizeof(ngx_http_upstream_rr_peers_t));
     if (peers == NULL) {
@@ -177,17 +229,14 @@ ngx_http_upstream_zone_copy_peers(ngx_slab_pool_t *shpool,
     ngx_memcpy(peers, uscf->peer.data, sizeof(ngx_http_upstream_rr_peers_t));
 
     peers->shpool = shpool;
+    peers->config = config;
 
     for (peerp = &peers->peer; *peerp; peerp = &peer->next) {
-        /* pool is unlocked */
-        peer = ngx_slab_calloc_locked(shpool,
-                                      sizeof(ngx_http_upstream_rr_peer_t));
+        peer = ngx_http_upstream_zone_copy_peer(peers, *peerp);
         if (peer == NULL) {
             return NGX_ERROR;
         }
 
-        ngx_memcpy(peer, *peerp, sizeof(ngx_http_upstream_rr_peer_t));
-
         *peerp = peer;
     }
 
@@ -203,17 +252,14 @@ ngx_http_upstream_zone_copy_peers(ngx_slab_pool_t *shpool,
     ngx_memcpy(backup, peers->next, sizeof(ngx_http_upstream_rr_peers_t));
 
     backup->shpool = shpool;
+    backup->config = config;
 
     for (peerp = &backup->peer; *peerp; peerp = &peer->next) {
-        /* pool is unlocked */
-        peer = ngx_slab_calloc_locked(shpool,
-                                      sizeof(ngx_http_upstream_rr_peer_t));
+        peer = ngx_http_upstream_zone_copy_peer(backup, *peerp);
         if (peer == NULL) {
             return NGX_ERROR;
         }
 
-        ngx_memcpy(peer, *peerp, sizeof(ngx_http_upstream_rr_peer_t));
-
         *peerp = peer;
     }
 
@@ -225,3 +271,660 @@ done:
 
     return NGX_OK;
 }
+
+
+ngx_http_upstream_rr_peer_t *
+ngx_http_upstream_zone_copy_peer(ngx_http_upstream_rr_peers_t *peers,
+    ngx_http_upstream_rr_peer_t *src)
+{
+    ngx_slab_pool_t              *shpool;
+    ngx_http_upstream_rr_peer_t  *dst;
+
+    shpool = peers->shpool;
+
+    ngx_shmtx_lock(&shpool->mutex);
+
+    dst = ngx_slab_calloc_locked(shpool, sizeof(ngx_http_upstream_rr_peer_t));
+    if (dst == NULL) {
+        goto failed;
+    }
+
+    ngx_memcpy(dst, src, sizeof(ngx_http_upstream_rr_peer_t));
+
+    dst->sockaddr = NULL;
+    dst->name.data = NULL;
+    dst->server.data = NULL;
+#if (NGX_HTTP_SSL)
+    dst->ssl_session = NULL;
+    dst->ssl_session_len = 0;
+#endif
+
+    dst->sockaddr = ngx_slab_alloc_locked(shpool, src->socklen);
+    if (dst->sockaddr == NULL) {
+        goto failed;
+    }
+
+    ngx_memcpy(dst->sockaddr, src->sockaddr, src->socklen);
+
+    dst->name.data = ngx_slab_alloc_locked(shpool, src->name.len);
+    if (dst->name.data == NULL) {
+        goto failed;
+    }
+
+    ngx_memcpy(dst->name.data, src->name.data, src->name.len);
+
+    if (src->server.len) {
+        dst->server.data = ngx_slab_alloc_locked(shpool, src->server.len);
+        if (dst->server.data == NULL) {
+            goto failed;
+        }
+
+        ngx_memcpy(dst->server.data, src->server.data, src->server.len);
+    }
+
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    return dst;
+
+failed:
+
+    if (dst) {
+        if (dst->sockaddr) {
+            ngx_slab_free_locked(shpool, dst->sockaddr);
+        }
+
+        if (dst->name.data) {
+            ngx_slab_free_locked(shpool, dst->name.data);
+        }
+
+        ngx_slab_free_locked(shpool, dst);
+    }
+
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    return NULL;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_zone_init_worker(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                      i, j;
+    ngx_http_upstream_server_t     *server;
+    ngx_http_upstream_srv_conf_t   *uscf, **uscfp;
+    ngx_http_upstream_main_conf_t  *umcf;
+    ngx_http_upstream_zone_host_t  *host;
+
+    if (ngx_process != NGX_PROCESS_WORKER
+        && ngx_process != NGX_PROCESS_SINGLE)
+    {
+        return NGX_OK;
+    }
+
+    /* the peers are shared, so one worker resolves the names for all */
+
+    if (ngx_worker != 0) {
+        return NGX_OK;
+    }
+
+    umcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_upstream_module);
+
+    if (umcf == NULL) {
+        return NGX_OK;
+    }
+
+    uscfp = umcf->upstreams.elts;
+
+    for (i = 0; i < umcf->upstreams.nelts; i++) {
+        uscf = uscfp[i];
+
+        if (uscf->shm_zone == NULL || uscf->servers == NULL) {
+            continue;
+        }
+
+        server = uscf->servers->elts;
+
+        for (j = 0; j < uscf->servers->nelts; j++) {
+
+            if (server[j].host.len == 0) {
+                continue;
+            }
+
+            host = ngx_pcalloc(cycle->pool,
+                               sizeof(ngx_http_upstream_zone_host_t));
+            if (host == NULL) {
+                return NGX_ERROR;
+            }
+
+            host->upstream = uscf;
+            host->server = &server[j];
+
+            host->event.handler = ngx_http_upstream_zone_resolve_handler;
+            host->event.data = host;
+            host->event.log = cycle->log;
+            host->event.cancelable = 1;
+
+            ngx_add_timer(&host->event, 1);
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_zone_resolve_handler(ngx_event_t *ev)
+{
+    u_char                         *p;
+    ngx_str_t                      *service;
+    ngx_resolver_ctx_t             *ctx;
+    ngx_http_upstream_server_t     *server;
+    ngx_http_upstream_zone_host_t  *host;
+
+    if (ngx_exiting) {
+        return;
+    }
+
+    host = ev->data;
+    server = host->server;
+
+    host->pool = ngx_create_pool(1024, ev->log);
+    if (host->pool == NULL) {
+        ngx_add_timer(ev, NGX_HTTP_UPSTREAM_ZONE_RESOLVE_RETRY * 1000);
+        return;
+    }
+
+    /* one reference is held until all queries are sent */
+
+    host->pending = 1;
+    host->failed = 0;
+    host->valid = 0;
+
+    if (ngx_array_init(&host->addrs, host->pool, 4,
+                       sizeof(ngx_http_upstream_zone_addr_t))
+        != NGX_OK)
+    {
+        goto failed;
+    }
+
+    if (server->service.len == 0) {
+
+        if (ngx_http_upstream_zone_resolve_name(host, &server->host,
+                                                server->port, server->weight)
+            != NGX_OK)
+        {
+            goto failed;
+        }
+
+        ngx_http_upstream_zone_resolve_done(host);
+        return;
+    }
+
+    ctx = ngx_resolve_start(host->upstream->resolver, NULL);
+    if (ctx == NULL || ctx == NGX_NO_RESOLVER) {
+        goto failed;
+    }
+
+    /* "http" is looked up as "_http._tcp.host", "_sip._udp" as is */
+
+    service = &server->service;
+
+    p = ngx_pnalloc(host->pool,
+                    sizeof("_._tcp.") - 1 + service->len + server->host.len);
+    if (p == NULL) {
+        goto failed;
+    }
+
+    ctx->name.data = p;
+
+    if (service->data[0] == '_') {
+        p = ngx_sprintf(p, "%V.%V", service, &server->host);
+
+    } else {
+        p = ngx_sprintf(p, "_%V._tcp.%V", service, &server->host);
+    }
+
+    ctx->name.len = p - ctx->name.data;
+    ctx->handler = ngx_http_upstream_zone_resolve_srv_handler;
+    ctx->data = host;
+    ctx->timeout = host->upstream->resolver_timeout;
+
+    host->pending++;
+
+    if (ngx_resolve_srv(ctx) != NGX_OK) {
+        host->pending--;
+        goto failed;
+    }
+
+    ngx_http_upstream_zone_resolve_done(host);
+    return;
+
+failed:
+
+    host->failed = 1;
+
+    ngx_http_upstream_zone_resolve_done(host);
+}
+
+
+static ngx_int_t
+ngx_http_upstream_zone_resolve_name(ngx_http_upstream_zone_host_t *host,
+    ngx_str_t *name, in_port_t port, ngx_uint_t weight)
+{
+    ngx_resolver_ctx_t               *ctx;
+    ngx_http_upstream_zone_target_t  *target;
+
+    target = ngx_palloc(host->pool, sizeof(ngx_http_upstream_zone_target_t));
+    if (target == NULL) {
+        return NGX_ERROR;
+    }
+
+    target->host = host;
+    target->port = port;
+    target->weight = weight;
+
+    ctx = ngx_resolve_start(host->upstream->resolver, NULL);
+    if (ctx == NULL || ctx == NGX_NO_RESOLVER) {
+        return NGX_ERROR;
+    }
+
+    ctx->name = *name;
+    ctx->handler = ngx_http_upstream_zone_resolve_name_handler;
+    ctx->data = target;
+    ctx->timeout = host->upstream->resolver_timeout;
+
+    host->pending++;
+
+    if (ngx_resolve_name(ctx) != NGX_OK) {
+        host->pending--;
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_zone_resolve_srv_handler(ngx_resolver_ctx_t *ctx)
+{
+    ngx_str_t                      *name;
+    ngx_uint_t                      i, n, priority;
+    ngx_resolver_srv_t             *srv, *srvs;
+    ngx_http_upstream_zone_host_t  *host;
+
+    host = ctx->data;
+
+    if (ctx->state) {
+        ngx_log_error(NGX_LOG_ERR, host->event.log, 0,
+                      "%V could not be resolved (%i: %s)",
+                      &ctx->name, ctx->state,
+                      ngx_resolver_strerror(ctx->state));
+
+        host->failed = 1;
+
+        ngx_resolve_srv_done(ctx);
+        ngx_http_upstream_zone_resolve_done(host);
+        return;
+    }
+
+    host->valid = ctx->valid;
+
+    /* only the targets of the highest priority are used */
+
+    priority = ctx->srvs[0].priority;
+
+    for (i = 1; i < ctx->nsrvs; i++) {
+        priority = ngx_min(priority, ctx->srvs[i].priority);
+    }
+
+    srvs = ngx_palloc(host->pool, ctx->nsrvs * sizeof(ngx_resolver_srv_t));
+    if (srvs == NULL) {
+        host->failed = 1;
+
+        ngx_resolve_srv_done(ctx);
+        ngx_http_upstream_zone_resolve_done(host);
+        return;
+    }
+
+    n = 0;
+
+    for (i = 0; i < ctx->nsrvs; i++) {
+        srv = &ctx->srvs[i];
+
+        if (srv->priority != priority) {
+            continue;
+        }
+
+        srvs[n] = *srv;
+
+        /* the resolver changes the case of names in place */
+
+        name = &srvs[n].name;
+
+        name->data = ngx_pstrdup(host->pool, &srv->name);
+        if (name->data == NULL) {
+            break;
+        }
+
+        n++;
+    }
+
+    ngx_resolve_srv_done(ctx);
+
+    for (i = 0; i < n; i++) {
+        if (ngx_http_upstream_zone_resolve_name(host, &srvs[i].name,
+                                                srvs[i].port,
+                                                srvs[i].weight
+                                                ? srvs[i].weight : 1)
+            != NGX_OK)
+        {
+            host->failed = 1;
+        }
+    }
+
+    ngx_http_upstream_zone_resolve_done(host);
+}
+
+
+static void
+ngx_http_upstream_zone_resolve_name_handler(ngx_resolver_ctx_t *ctx)
+{
+    u_char                           *p;
+    size_t                            len;
+    ngx_uint_t                        i, j;
+    struct sockaddr                  *sockaddr;
+    ngx_http_upstream_zone_addr_t    *addr;
+    ngx_http_upstream_zone_host_t    *host;
+    ngx_http_upstream_zone_target_t  *target;
+
+    target = ctx->data;
+    host = target->host;
+
+    if (ctx->state) {
+        ngx_log_error(NGX_LOG_ERR, host->event.log, 0,
+                      "%V could not be resolved (%i: %s)",
+                      &ctx->name, ctx->state,
+                      ngx_resolver_strerror(ctx->state));
+
+        host->failed = 1;
+
+        goto done;
+    }
+
+    if (host->valid == 0 || ctx->valid < host->valid) {
+        host->valid = ctx->valid;
+    }
+
+    for (i = 0; i < ctx->naddrs; i++) {
+
+        len = ctx->addrs[i].socklen;
+
+        sockaddr = ngx_palloc(host->pool, len);
+        if (sockaddr == NULL) {
+            host->failed = 1;
+            goto done;
+        }
+
+        ngx_memcpy(sockaddr, ctx->addrs[i].sockaddr, len);
+
+        switch (sockaddr->sa_family) {
+#if (NGX_HAVE_INET6)
+        case AF_INET6:
+            ((struct sockaddr_in6 *) sockaddr)->sin6_port = htons(target->port);
+            break;
+#endif
+        default: /* AF_INET */
+            ((struct sockaddr_in *) sockaddr)->sin_port = htons(target->port);
+        }
+
+        /* the same address may be returned for several targets */
+
+        addr = host->addrs.elts;
+
+        for (j = 0; j < host->addrs.nelts; j++) {
+            if (ngx_cmp_sockaddr(addr[j].sockaddr, addr[j].socklen,
+                                 sockaddr, len, 1)
+                == NGX_OK)
+            {
+                break;
+            }
+        }
+
+        if (j < host->addrs.nelts) {
+            continue;
+        }
+
+        p = ngx_pnalloc(host->pool, NGX_SOCKADDR_STRLEN);
+        if (p == NULL) {
+            host->failed = 1;
+            goto done;
+        }
+
+        addr = ngx_array_push(&host->addrs);
+        if (addr == NULL) {
+            host->failed = 1;
+            goto done;
+        }
+
+        addr->sockaddr = sockaddr;
+        addr->socklen = len;
+        addr->name.data = p;
+        addr->name.len = ngx_sock_ntop(sockaddr, len, p, NGX_SOCKADDR_STRLEN,
+                                       1);
+        addr->weight = target->weight;
+        addr->found = 0;
+    }
+
+done:
+
+    ngx_resolve_name_done(ctx);
+
+    ngx_http_upstream_zone_resolve_done(host);
+}
+
+
+static void
+ngx_http_upstream_zone_resolve_done(ngx_http_upstream_zone_host_t *host)
+{
+    time_t  timer;
+
+    if (--host->pending) {
+        return;
+    }
+
+    /* the peers are kept as is if no address is known */
+
+    if (host->addrs.nelts) {
+        ngx_http_upstream_zone_resolve_update(host);
+    }
+
+    if (host->addrs.nelts == 0 || host->valid == 0) {
+        timer = NGX_HTTP_UPSTREAM_ZONE_RESOLVE_RETRY;
+
+    } else {
+        timer = host->valid - ngx_time() + 1;
+
+        if (timer < 1) {
+            timer = 1;
+        }
+    }
+
+    ngx_destroy_pool(host->pool);
+    host->pool = NULL;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, host->event.log, 0,
+                   "upstream resolve \"%V\" again in %T",
+                   &host->server->name, timer);
+
+    if (!ngx_exiting) {
+        ngx_add_timer(&host->event, (ngx_msec_t) timer * 1000);
+    }
+}
+
+
+static void
+ngx_http_upstream_zone_resolve_update(ngx_http_upstream_zone_host_t *host)
+{
+    ngx_uint_t                      i, changed;
+    ngx_http_upstream_server_t     *server;
+    ngx_http_upstream_rr_peer_t     peer, *p, **peerp;
+    ngx_http_upstream_rr_peers_t   *peers, *list;
+    ngx_http_upstream_zone_addr_t  *addr;
+
+    server = host->server;
+    peers = host->upstream->peer.data;
+
+    addr = host->addrs.elts;
+    changed = 0;
+
+    ngx_http_upstream_rr_peers_wlock(peers);
+
+    if (peers->next) {
+        ngx_http_upstream_rr_peers_wlock(peers->next);
+    }
+
+    list = server->backup ? peers->next : peers;
+
+    if (list == NULL) {
+        goto done;
+    }
+
+    /* remove the peers whose addresses are no longer returned */
+
+    for (peerp = &list->peer; *peerp; /* void */ ) {
+        p = *peerp;
+
+        if (p->server.len != server->name.len
+            || ngx_strncmp(p->server.data, server->name.data,
+                           server->name.len)
+               != 0)
+        {
+            peerp = &p->next;
+            continue;
+        }
+
+        for (i = 0; i < host->addrs.nelts; i++) {
+            if (ngx_cmp_sockaddr(p->sockaddr, p->socklen,
+                                 addr[i].sockaddr, addr[i].socklen, 1)
+                == NGX_OK)
+            {
+                break;
+            }
+        }
+
+        if (i < host->addrs.nelts) {
+            addr[i].found = 1;
+            peerp = &p->next;
+            continue;
+        }
+
+        ngx_log_error(NGX_LOG_NOTICE, host->event.log, 0,
+                      "upstream server %V of %V removed from "
+                      "upstream \"%V\"",
+                      &p->name, &server->name, &host->upstream->host);
+
+        *peerp = p->next;
+
+        list->number--;
+        list->total_weight -= p->weight;
+
+        ngx_http_upstream_rr_peer_free(list, p);
+
+        changed = 1;
+    }
+
+    /* add the new addresses */
+
+    for (i = 0; i < host->addrs.nelts; i++) {
+
+        if (addr[i].found) {
+            continue;
+        }
+
+        ngx_memzero(&peer, sizeof(ngx_http_upstream_rr_peer_t));
+
+        peer.sockaddr = addr[i].sockaddr;
+        peer.socklen = addr[i].socklen;
+        peer.name = addr[i].name;
+        peer.server = server->name;
+        peer.weight = addr[i].weight;
+        peer.effective_weight = peer.weight;
+        peer.max_fails = server->max_fails;
+        peer.fail_timeout = server->fail_timeout;
+        peer.down = server->down;
+        peer.id = ngx_http_upstream_zone_peer_id(peers);
+        peer.version = ++(*peers->config);
+
+        p = ngx_http_upstream_zone_copy_peer(list, &peer);
+        if (p == NULL) {
+            ngx_log_error(NGX_LOG_ERR, host->event.log, 0,
+                          "upstream zone \"%V\" is too small to add "
+                          "server %V", &host->upstream->shm_zone->shm.name,
+                          &peer.name);
+            break;
+        }
+
+        p->next = NULL;
+
+        for (peerp = &list->peer; *peerp; peerp = &(*peerp)->next) {
+            /* void */
+        }
+
+        *peerp = p;
+
+        list->number++;
+        list->total_weight += p->weight;
+
+        ngx_log_error(NGX_LOG_NOTICE, host->event.log, 0,
+                      "upstream server %V of %V added to upstream \"%V\"",
+                      &p->name, &server->name, &host->upstream->host);
+
+        changed = 1;
+    }
+
+    if (changed) {
+        list->weighted = (list->total_weight != list->number);
+
+        if (list == peers) {
+            peers->single = (peers->number == 1 && peers->next == NULL);
+        }
+
+        (*peers->config)++;
+    }
+
+done:
+
+    if (peers->next) {
+        ngx_http_upstream_rr_peers_unlock(peers->next);
+    }
+
+    ngx_http_upstream_rr_peers_unlock(peers);
+}
+
+
+static ngx_uint_t
+ngx_http_upstream_zone_peer_id(ngx_http_upstream_rr_peers_t *peers)
+{
+    ngx_uint_t                     id;
+    ngx_http_upstream_rr_peer_t   *peer;
+    ngx_http_upstream_rr_peers_t  *list;
+
+    /* the lowest id not in use */
+
+    for (id = 0; /* void */; id++) {
+
+        for (list = peers; list; list = list->next) {
+            for (peer = list->peer; peer; peer = peer->next) {
+                if (peer->id == id) {
+                    goto next;
+                }
+            }
+        }
+
+        return id;
+
+    next:
+
+        continue;
+    }
+}
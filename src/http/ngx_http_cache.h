@@ -50,7 +50,8 @@ typedef struct {
     unsigned                         exists:1;
     unsigned                         updating:1;
     unsigned                         deleting:1;
-                                     /* 11 unused bits */
+    unsigned                         referenced:1;
+                                     /* 10 unused bits */
 
     ngx_file_uniq_t                  uniq;
     time_t                           expire;
@@ -77,6 +78,8 @@ struct ngx_http_cache_s {
     ngx_str_t                        vary;
     u_char                           variant[NGX_HTTP_CACHE_KEY_LEN];
 
+    ngx_str_t                        encoding;
+
     size_t                           header_start;
     size_t                           body_start;
     off_t                            length;
@@ -135,9 +138,17 @@ typedef struct {
     ngx_rbtree_t                     rbtree;
     ngx_rbtree_node_t                sentinel;
     ngx_queue_t                      queue; /* нڵ */
+    ngx_shmtx_sh_t                   lock;
+    ngx_shmtx_t                      mutex;
+    off_t                            size;
+} ngx_http_file_cache_shard_t;
+
+
+typedef struct {
+    ngx_http_file_cache_shard_t    **shards;
+    ngx_atomic_t                     hand;
     ngx_atomic_t                     cold;
     ngx_atomic_t                     loading;
-    off_t                            size;
 } ngx_http_file_cache_sh_t;
 
 
@@ -159,6 +170,10 @@ struct ngx_http_file_cache_s {
     ngx_msec_t                       loader_sleep;
     ngx_msec_t                       loader_threshold;
 
+    ngx_uint_t                       shards;
+
+    ngx_str_t                        index;
+
     ngx_shm_zone_t                  *shm_zone;
 };
 
@@ -169,11 +184,20 @@ void ngx_http_file_cache_create_key(ngx_http_request_t *r);
 ngx_int_t ngx_http_file_cache_open(ngx_http_request_t *r);
 ngx_int_t ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf);
 void ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf);
+void ngx_http_file_cache_store(ngx_http_request_t *r, ngx_http_cache_t *c,
+    ngx_temp_file_t *tf);
 void ngx_http_file_cache_update_header(ngx_http_request_t *r);
 ngx_int_t ngx_http_cache_send(ngx_http_request_t *);
 void ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf);
+ngx_int_t ngx_http_file_cache_encoded_open(ngx_http_request_t *r,
+    ngx_str_t *encoding);
+void ngx_http_file_cache_encoded_close(ngx_http_request_t *r);
+ngx_http_cache_t *ngx_http_file_cache_encoded_create(ngx_http_request_t *r,
+    ngx_str_t *encoding);
 time_t ngx_http_file_cache_valid(ngx_array_t *cache_valid, ngx_uint_t status);
+void ngx_http_file_cache_exit_master(ngx_cycle_t *cycle);
 
+ngx_int_t ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data);
 char *ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 char *ngx_http_file_cache_valid_set_slot(ngx_conf_t *cf, ngx_command_t *cmd,
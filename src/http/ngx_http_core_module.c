@@ -74,13 +74,14 @@ static char *ngx_http_core_internal(ngx_conf_t *cf, ngx_command_t *cmd,
 static char *ngx_http_core_resolver(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 #if (NGX_HTTP_GZIP)
-static ngx_int_t ngx_http_gzip_accept_encoding(ngx_str_t *ae);
+static ngx_int_t ngx_http_gzip_allowed(ngx_http_request_t *r);
+static ngx_int_t ngx_http_accept_encoding(ngx_str_t *ae, char *e, size_t n);
 static ngx_uint_t ngx_http_gzip_quantity(u_char *p, u_char *last);
 static char *ngx_http_gzip_disable(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 #endif
 static ngx_int_t ngx_http_get_forwarded_addr_internal(ngx_http_request_t *r,
-    ngx_addr_t *addr, u_char *xff, size_t xfflen, ngx_array_t *proxies,
+    ngx_addr_t *addr, u_char *xff, size_t xfflen, ngx_http_proxies_t *proxies,
     int recursive);
 #if (NGX_HAVE_OPENAT)
 static char *ngx_http_disable_symlinks(ngx_conf_t *cf, ngx_command_t *cmd,
@@ -817,6 +818,10 @@ ngx_http_handler(ngx_http_request_t *r)
     r->gzip_tested = 0;
     r->gzip_ok = 0;
     r->gzip_vary = 0;
+#endif
+#if (NGX_HTTP_BROTLI)
+    r->brotli_tested = 0;
+    r->brotli_ok = 0;
 #endif
 	/* д¼handerΪngx_http_core_run_phasesִngx_http_core_run_phases */
     r->write_event_handler = ngx_http_core_run_phases;
@@ -2146,11 +2151,7 @@ ngx_http_auth_basic_user(ngx_http_request_t *r)
 ngx_int_t
 ngx_http_gzip_ok(ngx_http_request_t *r)
 {
-    time_t                     date, expires;
-    ngx_uint_t                 p;
-    ngx_array_t               *cc;
-    ngx_table_elt_t           *e, *d, *ae;
-    ngx_http_core_loc_conf_t  *clcf;
+    ngx_table_elt_t  *ae;
 
     r->gzip_tested = 1;
 
@@ -2158,8 +2159,8 @@ ngx_http_gzip_ok(ngx_http_request_t *r)
         return NGX_DECLINED;
     }
 
-#if (NGX_HTTP_SPDY)
-    if (r->spdy_stream) {
+#if (NGX_HTTP_V2)
+    if (r->stream) {
         r->gzip_ok = 1;
         return NGX_OK;
     }
@@ -2184,11 +2185,70 @@ ngx_http_gzip_ok(ngx_http_request_t *r)
      */
 
     if (ngx_memcmp(ae->value.data, "gzip,", 5) != 0
-        && ngx_http_gzip_accept_encoding(&ae->value) != NGX_OK)
+        && ngx_http_accept_encoding(&ae->value, "gzip", 4) != NGX_OK)
     {
         return NGX_DECLINED;
     }
 
+    if (ngx_http_gzip_allowed(r) != NGX_OK) {
+        return NGX_DECLINED;
+    }
+
+    r->gzip_ok = 1;
+
+    return NGX_OK;
+}
+
+
+#if (NGX_HTTP_BROTLI)
+
+ngx_int_t
+ngx_http_brotli_ok(ngx_http_request_t *r)
+{
+    ngx_table_elt_t  *ae;
+
+    r->brotli_tested = 1;
+
+    if (r != r->main) {
+        return NGX_DECLINED;
+    }
+
+    ae = r->headers_in.accept_encoding;
+    if (ae == NULL) {
+        return NGX_DECLINED;
+    }
+
+    if (ae->value.len < sizeof("br") - 1) {
+        return NGX_DECLINED;
+    }
+
+    if (ngx_http_accept_encoding(&ae->value, "br", 2) != NGX_OK) {
+        return NGX_DECLINED;
+    }
+
+    /* the brotli modules share the gzip_* policy directives */
+
+    if (ngx_http_gzip_allowed(r) != NGX_OK) {
+        return NGX_DECLINED;
+    }
+
+    r->brotli_ok = 1;
+
+    return NGX_OK;
+}
+
+#endif
+
+
+static ngx_int_t
+ngx_http_gzip_allowed(ngx_http_request_t *r)
+{
+    time_t                     date, expires;
+    ngx_uint_t                 p;
+    ngx_array_t               *cc;
+    ngx_table_elt_t           *e, *d;
+    ngx_http_core_loc_conf_t  *clcf;
+
     clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
 
     if (r->headers_in.msie6 && clcf->gzip_disable_msie6) {
@@ -2305,21 +2365,19 @@ ok:
 
 #endif
 
-    r->gzip_ok = 1;
-
     return NGX_OK;
 }
 
 
 /*
- * gzip is enabled for the following quantities:
+ * an encoding is enabled for the following quantities:
  *     "gzip; q=0.001" ... "gzip; q=1.000"
- * gzip is disabled for the following quantities:
+ * an encoding is disabled for the following quantities:
  *     "gzip; q=0" ... "gzip; q=0.000", and for any invalid cases
  */
 
 static ngx_int_t
-ngx_http_gzip_accept_encoding(ngx_str_t *ae)
+ngx_http_accept_encoding(ngx_str_t *ae, char *e, size_t n)
 {
     u_char  *p, *start, *last;
 
@@ -2327,19 +2385,24 @@ ngx_http_gzip_accept_encoding(ngx_str_t *ae)
     last = start + ae->len;
 
     for ( ;; ) {
-        p = ngx_strcasestrn(start, "gzip", 4 - 1);
+        p = ngx_strcasestrn(start, e, n - 1);
         if (p == NULL) {
             return NGX_DECLINED;
         }
 
-        if (p == start || (*(p - 1) == ',' || *(p - 1) == ' ')) {
+        /* skip longer tokens, e.g., "brotli" for "br" */
+
+        if ((p == start || (*(p - 1) == ',' || *(p - 1) == ' '))
+            && (p + n == last
+                || p[n] == ',' || p[n] == ';' || p[n] == ' '))
+        {
             break;
         }
 
-        start = p + 4;
+        start = p + n;
     }
 
-    p += 4;
+    p += n;
 
     while (p < last) {
         switch (*p++) {
@@ -2499,8 +2562,8 @@ ngx_http_subrequest(ngx_http_request_t *r,
 
     sr->request_body = r->request_body;
 
-#if (NGX_HTTP_SPDY)
-    sr->spdy_stream = r->spdy_stream;
+#if (NGX_HTTP_V2)
+    sr->stream = r->stream;
 #endif
 
     sr->method = NGX_HTTP_GET;
@@ -2791,9 +2854,76 @@ ngx_http_set_disable_symlinks(ngx_http_request_t *r,
 }
 
 
+ngx_http_proxies_t *
+ngx_http_proxies_create(ngx_conf_t *cf, ngx_array_t *cidrs)
+{
+    ngx_int_t            rc;
+    ngx_uint_t           i;
+    ngx_cidr_t          *cidr;
+    ngx_http_proxies_t  *proxies;
+
+    proxies = ngx_pcalloc(cf->pool, sizeof(ngx_http_proxies_t));
+    if (proxies == NULL) {
+        return NULL;
+    }
+
+    cidr = cidrs->elts;
+
+    for (i = 0; i < cidrs->nelts; i++) {
+
+        switch (cidr[i].family) {
+
+#if (NGX_HAVE_INET6)
+        case AF_INET6:
+
+            if (proxies->tree6 == NULL) {
+                proxies->tree6 = ngx_radix_tree_create(cf->pool, -1);
+                if (proxies->tree6 == NULL) {
+                    return NULL;
+                }
+            }
+
+            rc = ngx_radix128tree_insert(proxies->tree6,
+                                         cidr[i].u.in6.addr.s6_addr,
+                                         cidr[i].u.in6.mask.s6_addr, 1);
+            break;
+#endif
+
+#if (NGX_HAVE_UNIX_DOMAIN)
+        case AF_UNIX:
+            proxies->unix_domain = 1;
+            continue;
+#endif
+
+        default: /* AF_INET */
+
+            if (proxies->tree == NULL) {
+                proxies->tree = ngx_radix_tree_create(cf->pool, -1);
+                if (proxies->tree == NULL) {
+                    return NULL;
+                }
+            }
+
+            rc = ngx_radix32tree_insert(proxies->tree,
+                                        ntohl(cidr[i].u.in.addr),
+                                        ntohl(cidr[i].u.in.mask), 1);
+            break;
+        }
+
+        /* NGX_BUSY is a duplicate network */
+
+        if (rc == NGX_ERROR) {
+            return NULL;
+        }
+    }
+
+    return proxies;
+}
+
+
 ngx_int_t
 ngx_http_get_forwarded_addr(ngx_http_request_t *r, ngx_addr_t *addr,
-    ngx_array_t *headers, ngx_str_t *value, ngx_array_t *proxies,
+    ngx_array_t *headers, ngx_str_t *value, ngx_http_proxies_t *proxies,
     int recursive)
 {
     ngx_int_t          rc;
@@ -2840,16 +2970,14 @@ ngx_http_get_forwarded_addr(ngx_http_request_t *r, ngx_addr_t *addr,
 
 static ngx_int_t
 ngx_http_get_forwarded_addr_internal(ngx_http_request_t *r, ngx_addr_t *addr,
-    u_char *xff, size_t xfflen, ngx_array_t *proxies, int recursive)
+    u_char *xff, size_t xfflen, ngx_http_proxies_t *proxies, int recursive)
 {
     u_char           *p;
     in_addr_t         inaddr;
     ngx_int_t         rc;
     ngx_addr_t        paddr;
-    ngx_cidr_t       *cidr;
-    ngx_uint_t        family, i;
+    ngx_uint_t        family;
 #if (NGX_HAVE_INET6)
-    ngx_uint_t        n;
     struct in6_addr  *inaddr6;
 #endif
 
@@ -2885,75 +3013,69 @@ ngx_http_get_forwarded_addr_internal(ngx_http_request_t *r, ngx_addr_t *addr,
     }
 #endif
 
-    for (cidr = proxies->elts, i = 0; i < proxies->nelts; i++) {
-        if (cidr[i].family != family) {
-            goto next;
-        }
-
-        switch (family) {
+    switch (family) {
 
 #if (NGX_HAVE_INET6)
-        case AF_INET6:
-            for (n = 0; n < 16; n++) {
-                if ((inaddr6->s6_addr[n] & cidr[i].u.in6.mask.s6_addr[n])
-                    != cidr[i].u.in6.addr.s6_addr[n])
-                {
-                    goto next;
-                }
-            }
-            break;
+    case AF_INET6:
+        if (proxies->tree6 == NULL
+            || ngx_radix128tree_find(proxies->tree6, inaddr6->s6_addr)
+               == NGX_RADIX_NO_VALUE)
+        {
+            return NGX_DECLINED;
+        }
+        break;
 #endif
 
 #if (NGX_HAVE_UNIX_DOMAIN)
-        case AF_UNIX:
-            break;
-#endif
-
-        default: /* AF_INET */
-            if ((inaddr & cidr[i].u.in.mask) != cidr[i].u.in.addr) {
-                goto next;
-            }
-            break;
+    case AF_UNIX:
+        if (!proxies->unix_domain) {
+            return NGX_DECLINED;
         }
+        break;
+#endif
 
-        for (p = xff + xfflen - 1; p > xff; p--, xfflen--) {
-            if (*p != ' ' && *p != ',') {
-                break;
-            }
+    default: /* AF_INET */
+        if (proxies->tree == NULL
+            || ngx_radix32tree_find(proxies->tree, ntohl(inaddr))
+               == NGX_RADIX_NO_VALUE)
+        {
+            return NGX_DECLINED;
         }
+        break;
+    }
 
-        for ( /* void */ ; p > xff; p--) {
-            if (*p == ' ' || *p == ',') {
-                p++;
-                break;
-            }
+    for (p = xff + xfflen - 1; p > xff; p--, xfflen--) {
+        if (*p != ' ' && *p != ',') {
+            break;
         }
+    }
 
-        if (ngx_parse_addr(r->pool, &paddr, p, xfflen - (p - xff)) != NGX_OK) {
-            return NGX_DECLINED;
+    for ( /* void */ ; p > xff; p--) {
+        if (*p == ' ' || *p == ',') {
+            p++;
+            break;
         }
+    }
 
-        *addr = paddr;
+    if (ngx_parse_addr(r->pool, &paddr, p, xfflen - (p - xff)) != NGX_OK) {
+        return NGX_DECLINED;
+    }
 
-        if (recursive && p > xff) {
-            rc = ngx_http_get_forwarded_addr_internal(r, addr, xff, p - 1 - xff,
-                                                      proxies, 1);
+    *addr = paddr;
 
-            if (rc == NGX_DECLINED) {
-                return NGX_DONE;
-            }
+    if (recursive && p > xff) {
+        rc = ngx_http_get_forwarded_addr_internal(r, addr, xff, p - 1 - xff,
+                                                  proxies, 1);
 
-            /* rc == NGX_OK || rc == NGX_DONE  */
-            return rc;
+        if (rc == NGX_DECLINED) {
+            return NGX_DONE;
         }
 
-        return NGX_OK;
-
-    next:
-        continue;
+        /* rc == NGX_OK || rc == NGX_DONE  */
+        return rc;
     }
 
-    return NGX_DECLINED;
+    return NGX_OK;
 }
 
 
@@ -4228,18 +4350,26 @@ ngx_http_core_listen(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 #endif
         }
 
-        if (ngx_strcmp(value[n].data, "spdy") == 0) {
-#if (NGX_HTTP_SPDY)
-            lsopt.spdy = 1;
+        if (ngx_strcmp(value[n].data, "http2") == 0) {
+#if (NGX_HTTP_V2)
+            lsopt.http2 = 1;
             continue;
 #else
             ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
-                               "the \"spdy\" parameter requires "
-                               "ngx_http_spdy_module");
+                               "the \"http2\" parameter requires "
+                               "ngx_http_v2_module");
             return NGX_CONF_ERROR;
 #endif
         }
 
+        if (ngx_strcmp(value[n].data, "spdy") == 0) {
+            ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                               "invalid parameter \"spdy\": "
+                               "ngx_http_spdy_module was superseded "
+                               "by ngx_http_v2_module");
+            continue;
+        }
+
         if (ngx_strncmp(value[n].data, "so_keepalive=", 13) == 0) {
 
             if (ngx_strcmp(&value[n].data[13], "on") == 0) {
@@ -79,8 +79,8 @@ typedef struct {
 #if (NGX_HTTP_SSL)
     unsigned                   ssl:1;
 #endif
-#if (NGX_HTTP_SPDY)
-    unsigned                   spdy:1;
+#if (NGX_HTTP_V2)
+    unsigned                   http2:1;
 #endif
 #if (NGX_HAVE_INET6 && defined IPV6_V6ONLY)
     unsigned                   ipv6only:1;
@@ -300,8 +300,8 @@ struct ngx_http_addr_conf_s {
 #if (NGX_HTTP_SSL)
     unsigned                   ssl:1;
 #endif
-#if (NGX_HTTP_SPDY)
-    unsigned                   spdy:1;
+#if (NGX_HTTP_V2)
+    unsigned                   http2:1;
 #endif
     unsigned                   proxy_protocol:1;
 };
@@ -544,6 +544,15 @@ struct ngx_http_location_tree_node_s {
 };
 
 
+typedef struct {
+    ngx_radix_tree_t                *tree;
+#if (NGX_HAVE_INET6)
+    ngx_radix_tree_t                *tree6;
+#endif
+    unsigned                         unix_domain:1;
+} ngx_http_proxies_t;
+
+
 void ngx_http_core_run_phases(ngx_http_request_t *r);
 ngx_int_t ngx_http_core_generic_phase(ngx_http_request_t *r,
     ngx_http_phase_handler_t *ph);
@@ -576,6 +585,9 @@ ngx_int_t ngx_http_auth_basic_user(ngx_http_request_t *r);
 #if (NGX_HTTP_GZIP)
 ngx_int_t ngx_http_gzip_ok(ngx_http_request_t *r);
 #endif
+#if (NGX_HTTP_BROTLI)
+ngx_int_t ngx_http_brotli_ok(ngx_http_request_t *r);
+#endif
 
 
 ngx_int_t ngx_http_subrequest(ngx_http_request_t *r,
@@ -605,8 +617,10 @@ ngx_int_t ngx_http_request_body_save_filter(ngx_http_request_t *r,
 ngx_int_t ngx_http_set_disable_symlinks(ngx_http_request_t *r,
     ngx_http_core_loc_conf_t *clcf, ngx_str_t *path, ngx_open_file_info_t *of);
 
+ngx_http_proxies_t *ngx_http_proxies_create(ngx_conf_t *cf,
+    ngx_array_t *cidrs);
 ngx_int_t ngx_http_get_forwarded_addr(ngx_http_request_t *r, ngx_addr_t *addr,
-    ngx_array_t *headers, ngx_str_t *value, ngx_array_t *proxies,
+    ngx_array_t *headers, ngx_str_t *value, ngx_http_proxies_t *proxies,
     int recursive);
 
 
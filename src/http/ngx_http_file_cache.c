@@ -11,6 +11,29 @@
 #include <ngx_md5.h>
 
 
+#define NGX_HTTP_FILE_CACHE_INDEX_VERSION  1
+#define NGX_HTTP_FILE_CACHE_INDEX_BATCH    1024
+
+
+typedef struct {
+    u_char                       magic[8];
+    uint32_t                     version;
+    uint32_t                     endianness;
+    uint32_t                     entry_size;
+    uint32_t                     bsize;
+    u_char                       levels[NGX_MAX_PATH_LEVEL];
+    u_char                       reserved[5];
+    uint64_t                     entries;
+    uint64_t                     time;
+} ngx_http_file_cache_index_header_t;
+
+
+typedef struct {
+    u_char                       key[NGX_HTTP_CACHE_KEY_LEN];
+    off_t                        fs_size;
+} ngx_http_file_cache_index_entry_t;
+
+
 static ngx_int_t ngx_http_file_cache_lock(ngx_http_request_t *r,
     ngx_http_cache_t *c);
 static void ngx_http_file_cache_lock_wait_handler(ngx_event_t *ev);
@@ -31,9 +54,12 @@ static void ngx_http_cache_thread_event_handler(ngx_event_t *ev);
 static ngx_int_t ngx_http_file_cache_exists(ngx_http_file_cache_t *cache,
     ngx_http_cache_t *c);
 static ngx_int_t ngx_http_file_cache_name(ngx_http_request_t *r,
-    ngx_path_t *path);
+    ngx_http_cache_t *c, ngx_path_t *path);
+static ngx_http_file_cache_shard_t *ngx_http_file_cache_shard(
+    ngx_http_file_cache_t *cache, u_char *key);
 static ngx_http_file_cache_node_t *
-    ngx_http_file_cache_lookup(ngx_http_file_cache_t *cache, u_char *key);
+    ngx_http_file_cache_lookup(ngx_http_file_cache_shard_t *shard,
+    u_char *key);
 static void ngx_http_file_cache_rbtree_insert_value(ngx_rbtree_node_t *temp,
     ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
 static void ngx_http_file_cache_vary(ngx_http_request_t *r, u_char *vary,
@@ -45,10 +71,20 @@ static ngx_int_t ngx_http_file_cache_reopen(ngx_http_request_t *r,
 static ngx_int_t ngx_http_file_cache_update_variant(ngx_http_request_t *r,
     ngx_http_cache_t *c);
 static void ngx_http_file_cache_cleanup(void *data);
+static void ngx_http_file_cache_encoded_key(ngx_http_cache_t *c,
+    ngx_str_t *encoding, u_char *key);
+static ngx_int_t ngx_http_file_cache_encoded_valid(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_encoded_drop(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_encoded_cleanup(void *data);
 static time_t ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache);
 static time_t ngx_http_file_cache_expire(ngx_http_file_cache_t *cache);
+static time_t ngx_http_file_cache_expire_shard(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_shard_t *shard, u_char *name);
 static void ngx_http_file_cache_delete(ngx_http_file_cache_t *cache,
-    ngx_queue_t *q, u_char *name);
+    ngx_http_file_cache_shard_t *shard, ngx_queue_t *q, u_char *name);
+static off_t ngx_http_file_cache_size(ngx_http_file_cache_t *cache);
 static void ngx_http_file_cache_loader_sleep(ngx_http_file_cache_t *cache);
 static ngx_int_t ngx_http_file_cache_noop(ngx_tree_ctx_t *ctx,
     ngx_str_t *path);
@@ -59,9 +95,25 @@ static ngx_int_t ngx_http_file_cache_manage_directory(ngx_tree_ctx_t *ctx,
 static ngx_int_t ngx_http_file_cache_add_file(ngx_tree_ctx_t *ctx,
     ngx_str_t *path);
 static ngx_int_t ngx_http_file_cache_add(ngx_http_file_cache_t *cache,
-    ngx_http_cache_t *c);
+    u_char *key, off_t fs_size);
 static ngx_int_t ngx_http_file_cache_delete_file(ngx_tree_ctx_t *ctx,
     ngx_str_t *path);
+static ngx_int_t ngx_http_file_cache_index_write(
+    ngx_http_file_cache_t *cache);
+static ngx_rbtree_node_t *ngx_http_file_cache_index_next(
+    ngx_http_file_cache_shard_t *shard, u_char *key);
+static ngx_int_t ngx_http_file_cache_index_load(ngx_http_file_cache_t *cache);
+static void ngx_http_file_cache_index_header(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_index_header_t *h);
+
+
+static ngx_http_file_cache_index_header_t  ngx_http_file_cache_index_tmpl = {
+    { 'N', 'G', 'X', 'C', 'I', 'D', 'X', '\0' },
+    NGX_HTTP_FILE_CACHE_INDEX_VERSION,
+    0x12345678,
+    sizeof(ngx_http_file_cache_index_entry_t),
+    0, { 0 }, { 0 }, 0, 0
+};
 
 
 ngx_str_t  ngx_http_cache_status[] = {
@@ -78,14 +130,16 @@ ngx_str_t  ngx_http_cache_status[] = {
 static u_char  ngx_http_file_cache_key[] = { LF, 'K', 'E', 'Y', ':', ' ' };
 
 
-static ngx_int_t
+ngx_int_t
 ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 {
     ngx_http_file_cache_t  *ocache = data;
 
-    size_t                  len;
-    ngx_uint_t              n;
-    ngx_http_file_cache_t  *cache;
+    u_char                       *file;
+    size_t                        len;
+    ngx_uint_t                    n;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     cache = shm_zone->data;
 
@@ -109,6 +163,13 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
             }
         }
 
+        if (cache->shards != ocache->shards) {
+            ngx_log_error(NGX_LOG_EMERG, shm_zone->shm.log, 0,
+                          "cache \"%V\" had previously different shards",
+                          &shm_zone->shm.name);
+            return NGX_ERROR;
+        }
+
         cache->sh = ocache->sh;
 
         cache->shpool = ocache->shpool;
@@ -139,14 +200,58 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 
     cache->shpool->data = cache->sh;
 
-    ngx_rbtree_init(&cache->sh->rbtree, &cache->sh->sentinel,
-                    ngx_http_file_cache_rbtree_insert_value);
+    cache->sh->shards = ngx_slab_alloc(cache->shpool,
+                                   cache->shards
+                                   * sizeof(ngx_http_file_cache_shard_t *));
+    if (cache->sh->shards == NULL) {
+        return NGX_ERROR;
+    }
+
+    /*
+     * shards are allocated one by one: slab chunks are aligned to their
+     * size, so the mutexes of different shards do not share cache lines
+     */
+
+    for (n = 0; n < cache->shards; n++) {
+
+        shard = ngx_slab_calloc(cache->shpool,
+                                sizeof(ngx_http_file_cache_shard_t));
+        if (shard == NULL) {
+            return NGX_ERROR;
+        }
+
+        ngx_rbtree_init(&shard->rbtree, &shard->sentinel,
+                        ngx_http_file_cache_rbtree_insert_value);
+
+        ngx_queue_init(&shard->queue);
+
+#if (NGX_HAVE_ATOMIC_OPS)
+
+        file = NULL;
+
+#else
 
-    ngx_queue_init(&cache->sh->queue);
+        len = cache->path->name.len + sizeof("/.shard") + NGX_INT_T_LEN;
 
+        file = ngx_slab_alloc(cache->shpool, len);
+        if (file == NULL) {
+            return NGX_ERROR;
+        }
+
+        (void) ngx_sprintf(file, "%V/.shard%ui%Z", &cache->path->name, n);
+
+#endif
+
+        if (ngx_shmtx_create(&shard->mutex, &shard->lock, file) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
+        cache->sh->shards[n] = shard;
+    }
+
+    cache->sh->hand = 0;
     cache->sh->cold = 1;
     cache->sh->loading = 0;
-    cache->sh->size = 0;
 
     cache->bsize = ngx_fs_bsize(cache->path->name.data);
 
@@ -212,7 +317,7 @@ ngx_http_file_cache_create(ngx_http_request_t *r)
         return NGX_ERROR;
     }
 
-    if (ngx_http_file_cache_name(r, cache->path) != NGX_OK) {
+    if (ngx_http_file_cache_name(r, c, cache->path) != NGX_OK) {
         return NGX_ERROR;
     }
 
@@ -331,7 +436,7 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
         }
     }
 
-    if (ngx_http_file_cache_name(r, cache->path) != NGX_OK) {
+    if (ngx_http_file_cache_name(r, c, cache->path) != NGX_OK) {
         return NGX_ERROR;
     }
 
@@ -398,8 +503,9 @@ done:
 static ngx_int_t
 ngx_http_file_cache_lock(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-    ngx_msec_t                 now, timer;
-    ngx_http_file_cache_t     *cache;
+    ngx_msec_t                    now, timer;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     if (!c->lock) {
         return NGX_DECLINED;
@@ -408,8 +514,9 @@ ngx_http_file_cache_lock(ngx_http_request_t *r, ngx_http_cache_t *c)
     now = ngx_current_msec;
 
     cache = c->file_cache;
+    shard = ngx_http_file_cache_shard(cache, c->key);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
     timer = c->node->lock_time - now;
 
@@ -420,7 +527,7 @@ ngx_http_file_cache_lock(ngx_http_request_t *r, ngx_http_cache_t *c)
         c->lock_time = c->node->lock_time;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "http file cache lock u:%d wt:%M",
@@ -477,9 +584,10 @@ ngx_http_file_cache_lock_wait_handler(ngx_event_t *ev)
 static void
 ngx_http_file_cache_lock_wait(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-    ngx_uint_t              wait;
-    ngx_msec_t              now, timer;
-    ngx_http_file_cache_t  *cache;
+    ngx_uint_t                    wait;
+    ngx_msec_t                    now, timer;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     now = ngx_current_msec;
 
@@ -493,9 +601,10 @@ ngx_http_file_cache_lock_wait(ngx_http_request_t *r, ngx_http_cache_t *c)
     }
 
     cache = c->file_cache;
+    shard = ngx_http_file_cache_shard(cache, c->key);
     wait = 0;
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
     timer = c->node->lock_time - now;
 
@@ -503,7 +612,7 @@ ngx_http_file_cache_lock_wait(ngx_http_request_t *r, ngx_http_cache_t *c)
         wait = 1;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     if (wait) {
         ngx_add_timer(&c->wait_event, (timer > 500) ? 500 : timer);
@@ -525,6 +634,7 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
     ssize_t                        n;
     ngx_int_t                      rc;
     ngx_http_file_cache_t         *cache;
+    ngx_http_file_cache_shard_t   *shard;
     ngx_http_file_cache_header_t  *h;
 
     n = ngx_http_file_cache_aio_read(r, c);
@@ -592,9 +702,11 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
 
     cache = c->file_cache;
 
+    shard = ngx_http_file_cache_shard(cache, c->key);
+
     if (cache->sh->cold) {
 
-        ngx_shmtx_lock(&cache->shpool->mutex);
+        ngx_shmtx_lock(&shard->mutex);
 
         if (!c->node->exists) {
             c->node->uses = 1;
@@ -603,17 +715,17 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
             c->node->uniq = c->uniq;
             c->node->fs_size = c->fs_size;
 
-            cache->sh->size += c->fs_size;
+            shard->size += c->fs_size;
         }
 
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+        ngx_shmtx_unlock(&shard->mutex);
     }
 
     now = ngx_time();
 
     if (c->valid_sec < now) {
 
-        ngx_shmtx_lock(&cache->shpool->mutex);
+        ngx_shmtx_lock(&shard->mutex);
 
         if (c->node->updating) {
             rc = NGX_HTTP_CACHE_UPDATING;
@@ -625,7 +737,7 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
             rc = NGX_HTTP_CACHE_STALE;
         }
 
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+        ngx_shmtx_unlock(&shard->mutex);
 
         ngx_log_debug3(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                        "http file cache expired: %i %T %T",
@@ -793,19 +905,28 @@ ngx_http_cache_thread_event_handler(ngx_event_t *ev)
 static ngx_int_t
 ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
 {
-    ngx_int_t                    rc;
-    ngx_http_file_cache_node_t  *fcn;
+    ngx_int_t                     rc;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    shard = ngx_http_file_cache_shard(cache, c->key);
+
+    ngx_shmtx_lock(&shard->mutex);
 
     fcn = c->node;
 
     if (fcn == NULL) {
-        fcn = ngx_http_file_cache_lookup(cache, c->key);
+        fcn = ngx_http_file_cache_lookup(shard, c->key);
     }
 
     if (fcn) {
-        ngx_queue_remove(&fcn->queue);
+
+        /*
+         * a hit only marks the node as referenced, the node is moved
+         * in the queue later, when the expiration reaches it
+         */
+
+        fcn->referenced = 1;
 
         if (c->node == NULL) {
             fcn->uses++;
@@ -840,17 +961,16 @@ ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
         goto done;
     }
 
-    fcn = ngx_slab_calloc_locked(cache->shpool,
-                                 sizeof(ngx_http_file_cache_node_t));
+    fcn = ngx_slab_calloc(cache->shpool, sizeof(ngx_http_file_cache_node_t));
     if (fcn == NULL) {
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+        ngx_shmtx_unlock(&shard->mutex);
 
         (void) ngx_http_file_cache_forced_expire(cache);
 
-        ngx_shmtx_lock(&cache->shpool->mutex);
+        ngx_shmtx_lock(&shard->mutex);
 
-        fcn = ngx_slab_calloc_locked(cache->shpool,
-                                     sizeof(ngx_http_file_cache_node_t));
+        fcn = ngx_slab_calloc(cache->shpool,
+                              sizeof(ngx_http_file_cache_node_t));
         if (fcn == NULL) {
             ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, 0,
                           "could not allocate node%s", cache->shpool->log_ctx);
@@ -864,7 +984,9 @@ ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
     ngx_memcpy(fcn->key, &c->key[sizeof(ngx_rbtree_key_t)],
                NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
 
-    ngx_rbtree_insert(&cache->sh->rbtree, &fcn->node);
+    ngx_rbtree_insert(&shard->rbtree, &fcn->node);
+
+    ngx_queue_insert_head(&shard->queue, &fcn->queue);
 
     fcn->uses = 1;
     fcn->count = 1;
@@ -885,27 +1007,23 @@ done:
 
     fcn->expire = ngx_time() + cache->inactive;
 
-    ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
-
     c->uniq = fcn->uniq;
     c->error = fcn->error;
     c->node = fcn;
 
 failed:
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     return rc;
 }
 
 
 static ngx_int_t
-ngx_http_file_cache_name(ngx_http_request_t *r, ngx_path_t *path)
+ngx_http_file_cache_name(ngx_http_request_t *r, ngx_http_cache_t *c,
+    ngx_path_t *path)
 {
-    u_char            *p;
-    ngx_http_cache_t  *c;
-
-    c = r->cache;
+    u_char  *p;
 
     if (c->file.name.len) {
         return NGX_OK;
@@ -934,8 +1052,20 @@ ngx_http_file_cache_name(ngx_http_request_t *r, ngx_path_t *path)
 }
 
 
+static ngx_http_file_cache_shard_t *
+ngx_http_file_cache_shard(ngx_http_file_cache_t *cache, u_char *key)
+{
+    ngx_uint_t  n;
+
+    n = (key[NGX_HTTP_CACHE_KEY_LEN - 2] << 8)
+        + key[NGX_HTTP_CACHE_KEY_LEN - 1];
+
+    return cache->sh->shards[n % cache->shards];
+}
+
+
 static ngx_http_file_cache_node_t *
-ngx_http_file_cache_lookup(ngx_http_file_cache_t *cache, u_char *key)
+ngx_http_file_cache_lookup(ngx_http_file_cache_shard_t *shard, u_char *key)
 {
     ngx_int_t                    rc;
     ngx_rbtree_key_t             node_key;
@@ -944,8 +1074,8 @@ ngx_http_file_cache_lookup(ngx_http_file_cache_t *cache, u_char *key)
 
     ngx_memcpy((u_char *) &node_key, key, sizeof(ngx_rbtree_key_t));
 
-    node = cache->sh->rbtree.root;
-    sentinel = cache->sh->rbtree.sentinel;
+    node = shard->rbtree.root;
+    sentinel = shard->rbtree.sentinel;
 
     while (node != sentinel) {
 
@@ -1177,7 +1307,8 @@ ngx_http_file_cache_vary_header(ngx_http_request_t *r, ngx_md5_t *md5,
 static ngx_int_t
 ngx_http_file_cache_reopen(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-    ngx_http_file_cache_t  *cache;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
                    "http file cache reopen");
@@ -1190,13 +1321,14 @@ ngx_http_file_cache_reopen(ngx_http_request_t *r, ngx_http_cache_t *c)
     }
 
     cache = c->file_cache;
+    shard = ngx_http_file_cache_shard(cache, c->key);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
     c->node->count--;
     c->node = NULL;
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     c->secondary = 1;
     c->file.name.len = 0;
@@ -1274,7 +1406,8 @@ ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf)
 static ngx_int_t
 ngx_http_file_cache_update_variant(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-    ngx_http_file_cache_t  *cache;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     if (!c->secondary) {
         return NGX_OK;
@@ -1292,17 +1425,18 @@ ngx_http_file_cache_update_variant(ngx_http_request_t *r, ngx_http_cache_t *c)
      */
 
     cache = c->file_cache;
+    shard = ngx_http_file_cache_shard(cache, c->key);
 
     ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "http file cache main key");
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
     c->node->count--;
     c->node->updating = 0;
     c->node = NULL;
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     c->file.name.len = 0;
 
@@ -1312,7 +1446,7 @@ ngx_http_file_cache_update_variant(ngx_http_request_t *r, ngx_http_cache_t *c)
         return NGX_ERROR;
     }
 
-    if (ngx_http_file_cache_name(r, cache->path) != NGX_OK) {
+    if (ngx_http_file_cache_name(r, c, cache->path) != NGX_OK) {
         return NGX_ERROR;
     }
 
@@ -1323,15 +1457,21 @@ ngx_http_file_cache_update_variant(ngx_http_request_t *r, ngx_http_cache_t *c)
 void
 ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf)
 {
-    off_t                   fs_size;
-    ngx_int_t               rc;
-    ngx_file_uniq_t         uniq;
-    ngx_file_info_t         fi;
-    ngx_http_cache_t        *c;
-    ngx_ext_rename_file_t   ext;
-    ngx_http_file_cache_t  *cache;
+    ngx_http_file_cache_store(r, r->cache, tf);
+}
 
-    c = r->cache;
+
+void
+ngx_http_file_cache_store(ngx_http_request_t *r, ngx_http_cache_t *c,
+    ngx_temp_file_t *tf)
+{
+    off_t                         fs_size;
+    ngx_int_t                     rc;
+    ngx_file_uniq_t               uniq;
+    ngx_file_info_t               fi;
+    ngx_ext_rename_file_t         ext;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_shard_t  *shard;
 
     if (c->updated) {
         return;
@@ -1375,22 +1515,45 @@ ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf)
         }
     }
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    if (rc == NGX_OK && c->encoding.len
+        && ngx_http_file_cache_encoded_valid(r, c) != NGX_OK)
+    {
+        if (ngx_delete_file(c->file.name.data) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_CRIT, r->connection->log, ngx_errno,
+                          ngx_delete_file_n " \"%s\" failed",
+                          c->file.name.data);
+        }
+
+        rc = NGX_DECLINED;
+        uniq = 0;
+        fs_size = 0;
+    }
+
+    shard = ngx_http_file_cache_shard(cache, c->key);
+
+    ngx_shmtx_lock(&shard->mutex);
 
     c->node->count--;
     c->node->uniq = uniq;
     c->node->body_start = c->body_start;
 
-    cache->sh->size += fs_size - c->node->fs_size;
+    shard->size += fs_size - c->node->fs_size;
     c->node->fs_size = fs_size;
 
     if (rc == NGX_OK) {
         c->node->exists = 1;
+
+    } else if (rc == NGX_DECLINED) {
+        c->node->exists = 0;
     }
 
     c->node->updating = 0;
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
+
+    if (rc == NGX_OK && c->encoding.len == 0) {
+        ngx_http_file_cache_encoded_drop(r, c);
+    }
 }
 
 
@@ -1580,19 +1743,21 @@ ngx_http_cache_send(ngx_http_request_t *r)
 void
 ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf)
 {
-    ngx_http_file_cache_t       *cache;
-    ngx_http_file_cache_node_t  *fcn;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
 
     if (c->updated || c->node == NULL) {
         return;
     }
 
     cache = c->file_cache;
+    shard = ngx_http_file_cache_shard(cache, c->key);
 
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
                    "http file cache free, fd: %d", c->file.fd);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
     fcn = c->node;
     fcn->count--;
@@ -1611,12 +1776,12 @@ ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf)
 
     } else if (!fcn->exists && fcn->count == 0 && c->min_uses == 1) {
         ngx_queue_remove(&fcn->queue);
-        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
-        ngx_slab_free_locked(cache->shpool, fcn);
+        ngx_rbtree_delete(&shard->rbtree, &fcn->node);
+        ngx_slab_free(cache->shpool, fcn);
         c->node = NULL;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
     c->updated = 1;
     c->updating = 0;
@@ -1662,232 +1827,629 @@ ngx_http_file_cache_cleanup(void *data)
 }
 
 
-static time_t
-ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache)
-{
-    u_char                      *name;
-    size_t                       len;
-    time_t                       wait;
-    ngx_uint_t                   tries;
-    ngx_path_t                  *path;
-    ngx_queue_t                 *q;
-    ngx_http_file_cache_node_t  *fcn;
+/*
+ * a compressed variant is a copy of the main cache file with the response
+ * body replaced by the output of the gzip or brotli filter; it is stored
+ * under the main key hashed together with the content encoding, and it is
+ * dropped whenever a new main response is stored under the same key
+ */
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                   "http file cache forced expire");
+static ngx_str_t  ngx_http_file_cache_encodings[] = {
+    ngx_string("gzip"),
+    ngx_string("br")
+};
 
-    path = cache->path;
-    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
 
-    name = ngx_alloc(len + 1, ngx_cycle->log);
-    if (name == NULL) {
-        return 10;
-    }
+ngx_int_t
+ngx_http_file_cache_encoded_open(ngx_http_request_t *r, ngx_str_t *encoding)
+{
+    u_char                        key[NGX_HTTP_CACHE_KEY_LEN];
+    ngx_uint_t                    exists;
+    ngx_http_cache_t             *c;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
 
-    ngx_memcpy(name, path->name.data, path->name.len);
+    c = r->cache;
 
-    wait = 10;
-    tries = 20;
+    ngx_http_file_cache_encoded_key(c, encoding, key);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    shard = ngx_http_file_cache_shard(c->file_cache, key);
 
-    for (q = ngx_queue_last(&cache->sh->queue);
-         q != ngx_queue_sentinel(&cache->sh->queue);
-         q = ngx_queue_prev(q))
-    {
-        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+    ngx_shmtx_lock(&shard->mutex);
 
-        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                  "http file cache forced expire: #%d %d %02xd%02xd%02xd%02xd",
-                  fcn->count, fcn->exists,
-                  fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+    fcn = ngx_http_file_cache_lookup(shard, key);
 
-        if (fcn->count == 0) {
-            ngx_http_file_cache_delete(cache, q, name);
-            wait = 0;
+    exists = (fcn && fcn->exists && !fcn->error && !fcn->updating);
 
-        } else {
-            if (--tries) {
-                continue;
-            }
+    ngx_shmtx_unlock(&shard->mutex);
 
-            wait = 1;
-        }
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache encoded: \"%V\" %ui", encoding, exists);
 
-        break;
+    if (!exists) {
+        return NGX_DECLINED;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
-
-    ngx_free(name);
+    ngx_memcpy(c->key, key, NGX_HTTP_CACHE_KEY_LEN);
+    c->encoding = *encoding;
 
-    return wait;
+    return NGX_OK;
 }
 
 
-static time_t
-ngx_http_file_cache_expire(ngx_http_file_cache_t *cache)
+void
+ngx_http_file_cache_encoded_close(ngx_http_request_t *r)
 {
-    u_char                      *name, *p;
-    size_t                       len;
-    time_t                       now, wait;
-    ngx_path_t                  *path;
-    ngx_queue_t                 *q;
-    ngx_http_file_cache_node_t  *fcn;
-    u_char                       key[2 * NGX_HTTP_CACHE_KEY_LEN];
-
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                   "http file cache expire");
-
-    path = cache->path;
-    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+    ngx_http_cache_t  *c;
 
-    name = ngx_alloc(len + 1, ngx_cycle->log);
-    if (name == NULL) {
-        return 10;
-    }
+    c = r->cache;
 
-    ngx_memcpy(name, path->name.data, path->name.len);
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache encoded close");
 
-    now = ngx_time();
+    ngx_http_file_cache_free(c, NULL);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    c->node = NULL;
+    c->buf = NULL;
 
-    for ( ;; ) {
+    c->file.fd = NGX_INVALID_FILE;
+    c->file.name.len = 0;
 
-        if (ngx_quit || ngx_terminate) {
-            wait = 1;
-            break;
-        }
+    c->uniq = 0;
+    c->valid_sec = 0;
+    c->last_modified = 0;
+    c->date = 0;
+    c->length = 0;
+    c->fs_size = 0;
+    c->error = 0;
+    c->valid_msec = 0;
 
-        if (ngx_queue_empty(&cache->sh->queue)) {
-            wait = 10;
-            break;
-        }
+    ngx_str_null(&c->etag);
+    ngx_str_null(&c->encoding);
 
-        q = ngx_queue_last(&cache->sh->queue);
+    c->updated = 0;
+    c->updating = 0;
+    c->exists = 0;
+    c->temp_file = 0;
+    c->reading = 0;
 
-        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+    r->cached = 0;
 
-        wait = fcn->expire - now;
+    ngx_memcpy(c->key, c->main, NGX_HTTP_CACHE_KEY_LEN);
+}
 
-        if (wait > 0) {
-            wait = wait > 10 ? 10 : wait;
-            break;
-        }
 
-        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache expire: #%d %d %02xd%02xd%02xd%02xd",
-                       fcn->count, fcn->exists,
-                       fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+ngx_http_cache_t *
+ngx_http_file_cache_encoded_create(ngx_http_request_t *r, ngx_str_t *encoding)
+{
+    ngx_uint_t                    busy;
+    ngx_http_cache_t             *c, *ec;
+    ngx_pool_cleanup_t           *cln;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
 
-        if (fcn->count == 0) {
-            ngx_http_file_cache_delete(cache, q, name);
-            continue;
-        }
+    c = r->cache;
+    cache = c->file_cache;
 
-        if (fcn->deleting) {
-            wait = 1;
-            break;
-        }
+    ec = ngx_pcalloc(r->pool, sizeof(ngx_http_cache_t));
+    if (ec == NULL) {
+        return NULL;
+    }
 
-        p = ngx_hex_dump(key, (u_char *) &fcn->node.key,
-                         sizeof(ngx_rbtree_key_t));
-        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
-        (void) ngx_hex_dump(p, fcn->key, len);
+    ec->keys = c->keys;
+    ec->crc32 = c->crc32;
+    ngx_memcpy(ec->main, c->main, NGX_HTTP_CACHE_KEY_LEN);
+    ngx_http_file_cache_encoded_key(c, encoding, ec->key);
 
-        /*
-         * abnormally exited workers may leave locked cache entries,
-         * and although it may be safe to remove them completely,
-         * we prefer to just move them to the top of the inactive queue
-         */
+    ec->encoding = *encoding;
+    ec->valid_sec = c->valid_sec;
+    ec->header_start = c->header_start;
+    ec->body_start = c->body_start;
+    ec->min_uses = 1;
+    ec->file_cache = cache;
 
-        ngx_queue_remove(q);
-        fcn->expire = ngx_time() + cache->inactive;
-        ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+    ec->file.log = r->connection->log;
+    ec->file.fd = NGX_INVALID_FILE;
 
-        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, 0,
-                      "ignore long locked inactive cache entry %*s, count:%d",
-                      2 * NGX_HTTP_CACHE_KEY_LEN, key, fcn->count);
+    cln = ngx_pool_cleanup_add(r->pool, 0);
+    if (cln == NULL) {
+        return NULL;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    if (ngx_http_file_cache_exists(cache, ec) == NGX_ERROR) {
+        return NULL;
+    }
 
-    ngx_free(name);
+    cln->handler = ngx_http_file_cache_encoded_cleanup;
+    cln->data = ec;
 
-    return wait;
-}
+    /* only one request stores a variant, a stalled one is taken over */
 
+    shard = ngx_http_file_cache_shard(cache, ec->key);
 
-static void
-ngx_http_file_cache_delete(ngx_http_file_cache_t *cache, ngx_queue_t *q,
-    u_char *name)
-{
-    u_char                      *p;
-    size_t                       len;
-    ngx_path_t                  *path;
-    ngx_http_file_cache_node_t  *fcn;
+    ngx_shmtx_lock(&shard->mutex);
 
-    fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+    fcn = ec->node;
 
-    if (fcn->exists) {
-        cache->sh->size -= fcn->fs_size;
+    if (fcn->updating
+        && (ngx_msec_int_t) (fcn->lock_time - ngx_current_msec) > 0)
+    {
+        busy = 1;
 
-        path = cache->path;
-        p = name + path->name.len + 1 + path->len;
-        p = ngx_hex_dump(p, (u_char *) &fcn->node.key,
-                         sizeof(ngx_rbtree_key_t));
-        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
-        p = ngx_hex_dump(p, fcn->key, len);
-        *p = '\0';
+    } else {
+        busy = 0;
 
-        fcn->count++;
-        fcn->deleting = 1;
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+        fcn->updating = 1;
+        fcn->lock_time = ngx_current_msec + c->lock_age;
 
-        len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
-        ngx_create_hashed_filename(path, name, len);
+        ec->updating = 1;
+        ec->lock_time = fcn->lock_time;
+    }
 
-        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache expire: \"%s\"", name);
+    ngx_shmtx_unlock(&shard->mutex);
 
-        if (ngx_delete_file(name) == NGX_FILE_ERROR) {
-            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
-                          ngx_delete_file_n " \"%s\" failed", name);
-        }
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache encoded create: \"%V\" busy:%ui",
+                   encoding, busy);
 
-        ngx_shmtx_lock(&cache->shpool->mutex);
-        fcn->count--;
-        fcn->deleting = 0;
+    if (busy) {
+        ngx_http_file_cache_free(ec, NULL);
+        return NULL;
     }
 
-    if (fcn->count == 0) {
-        ngx_queue_remove(q);
-        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
-        ngx_slab_free_locked(cache->shpool, fcn);
+    if (ngx_http_file_cache_name(r, ec, cache->path) != NGX_OK) {
+        ngx_http_file_cache_free(ec, NULL);
+        return NULL;
     }
+
+    ec->temp_file = 1;
+
+    return ec;
 }
 
 
-static time_t
-ngx_http_file_cache_manager(void *data)
+static void
+ngx_http_file_cache_encoded_key(ngx_http_cache_t *c, ngx_str_t *encoding,
+    u_char *key)
 {
-    ngx_http_file_cache_t  *cache = data;
-
-    off_t   size;
-    time_t  next, wait;
+    ngx_md5_t  md5;
 
-    next = ngx_http_file_cache_expire(cache);
+    ngx_md5_init(&md5);
+    ngx_md5_update(&md5, c->main, NGX_HTTP_CACHE_KEY_LEN);
+    ngx_md5_update(&md5, encoding->data, encoding->len);
+    ngx_md5_final(key, &md5);
+}
 
-    cache->last = ngx_current_msec;
-    cache->files = 0;
 
-    for ( ;; ) {
-        ngx_shmtx_lock(&cache->shpool->mutex);
+static ngx_int_t
+ngx_http_file_cache_encoded_valid(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+    ngx_file_info_t    fi;
+    ngx_http_cache_t  *mc;
 
-        size = cache->sh->size;
+    /*
+     * the variant is renamed in place before the check, so either the check
+     * sees the new main file, or the main update drops the variant after it
+     */
+
+    mc = r->cache;
+
+    if (ngx_file_info(mc->file.name.data, &fi) == NGX_FILE_ERROR) {
+        return NGX_DECLINED;
+    }
+
+    if (ngx_file_uniq(&fi) != mc->uniq) {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http file cache encoded: \"%V\" outdated",
+                       &c->encoding);
+        return NGX_DECLINED;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_file_cache_encoded_drop(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+    u_char                       *p, *name;
+    u_char                        key[NGX_HTTP_CACHE_KEY_LEN];
+    size_t                        len;
+    ngx_uint_t                    i, exists;
+    ngx_path_t                   *path;
+    ngx_http_file_cache_t        *cache;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
+
+    cache = c->file_cache;
+    path = cache->path;
+
+    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+
+    name = NULL;
+
+    for (i = 0; i < sizeof(ngx_http_file_cache_encodings) / sizeof(ngx_str_t);
+         i++)
+    {
+        ngx_http_file_cache_encoded_key(c, &ngx_http_file_cache_encodings[i],
+                                        key);
+
+        shard = ngx_http_file_cache_shard(cache, key);
+
+        ngx_shmtx_lock(&shard->mutex);
+
+        fcn = ngx_http_file_cache_lookup(shard, key);
+
+        exists = (fcn && fcn->exists);
+
+        if (exists) {
+            fcn->exists = 0;
+            fcn->uniq = 0;
+
+            shard->size -= fcn->fs_size;
+            fcn->fs_size = 0;
+        }
+
+        ngx_shmtx_unlock(&shard->mutex);
+
+        /* the cache loader may not have seen the variant file yet */
+
+        if (!exists && !cache->sh->cold) {
+            continue;
+        }
+
+        if (name == NULL) {
+            name = ngx_pnalloc(r->pool, len + 1);
+            if (name == NULL) {
+                return;
+            }
+
+            ngx_memcpy(name, path->name.data, path->name.len);
+        }
+
+        p = name + path->name.len + 1 + path->len;
+        p = ngx_hex_dump(p, key, NGX_HTTP_CACHE_KEY_LEN);
+        *p = '\0';
+
+        ngx_create_hashed_filename(path, name, len);
+
+        ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http file cache encoded drop: \"%V\" \"%s\"",
+                       &ngx_http_file_cache_encodings[i], name);
+
+        if (ngx_delete_file(name) == NGX_FILE_ERROR
+            && ngx_errno != NGX_ENOENT)
+        {
+            ngx_log_error(NGX_LOG_CRIT, r->connection->log, ngx_errno,
+                          ngx_delete_file_n " \"%s\" failed", name);
+        }
+    }
+}
+
+
+static void
+ngx_http_file_cache_encoded_cleanup(void *data)
+{
+    ngx_http_cache_t  *c = data;
+
+    ngx_http_file_cache_free(c, NULL);
+}
+
+
+static time_t
+ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache)
+{
+    u_char                       *name;
+    size_t                        len;
+    time_t                        wait;
+    ngx_uint_t                    n, tries;
+    ngx_path_t                   *path;
+    ngx_queue_t                  *q, *prev;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache forced expire");
+
+    path = cache->path;
+    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+
+    name = ngx_alloc(len + 1, ngx_cycle->log);
+    if (name == NULL) {
+        return 10;
+    }
+
+    ngx_memcpy(name, path->name.data, path->name.len);
+
+    wait = 10;
+
+    /*
+     * the shards are tried in turn starting from the clock hand,
+     * so each call evicts from the next shard
+     */
+
+    for (n = 0; n < cache->shards; n++) {
+
+        shard = cache->sh->shards[ngx_atomic_fetch_add(&cache->sh->hand, 1)
+                                  % cache->shards];
+
+        tries = 20;
+
+        ngx_shmtx_lock(&shard->mutex);
+
+        for (q = ngx_queue_last(&shard->queue);
+             q != ngx_queue_sentinel(&shard->queue);
+             q = prev)
+        {
+            prev = ngx_queue_prev(q);
+
+            fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+            ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                  "http file cache forced expire: #%d %d %02xd%02xd%02xd%02xd",
+                  fcn->count, fcn->exists,
+                  fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+
+            if (fcn->count == 0) {
+
+                if (fcn->referenced) {
+                    fcn->referenced = 0;
+                    ngx_queue_remove(q);
+                    ngx_queue_insert_head(&shard->queue, q);
+                    continue;
+                }
+
+                ngx_http_file_cache_delete(cache, shard, q, name);
+                wait = 0;
+
+            } else {
+                if (--tries) {
+                    continue;
+                }
+
+                wait = 1;
+            }
+
+            break;
+        }
+
+        ngx_shmtx_unlock(&shard->mutex);
+
+        if (wait == 0) {
+            break;
+        }
+    }
+
+    ngx_free(name);
+
+    return wait;
+}
+
+
+static time_t
+ngx_http_file_cache_expire(ngx_http_file_cache_t *cache)
+{
+    u_char      *name;
+    size_t       len;
+    time_t       wait, next;
+    ngx_uint_t   n;
+    ngx_path_t  *path;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache expire");
+
+    path = cache->path;
+    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+
+    name = ngx_alloc(len + 1, ngx_cycle->log);
+    if (name == NULL) {
+        return 10;
+    }
+
+    ngx_memcpy(name, path->name.data, path->name.len);
+
+    next = 10;
+
+    for (n = 0; n < cache->shards; n++) {
+
+        wait = ngx_http_file_cache_expire_shard(cache, cache->sh->shards[n],
+                                                name);
+        if (wait < next) {
+            next = wait;
+        }
+
+        if (ngx_quit || ngx_terminate) {
+            break;
+        }
+    }
+
+    ngx_free(name);
+
+    return next;
+}
 
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+static time_t
+ngx_http_file_cache_expire_shard(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_shard_t *shard, u_char *name)
+{
+    u_char                      *p;
+    size_t                       len;
+    time_t                       now, wait;
+    ngx_queue_t                 *q;
+    ngx_http_file_cache_node_t  *fcn;
+    u_char                       key[2 * NGX_HTTP_CACHE_KEY_LEN];
+
+    now = ngx_time();
+
+    ngx_shmtx_lock(&shard->mutex);
+
+    for ( ;; ) {
+
+        if (ngx_quit || ngx_terminate) {
+            wait = 1;
+            break;
+        }
+
+        if (ngx_queue_empty(&shard->queue)) {
+            wait = 10;
+            break;
+        }
+
+        q = ngx_queue_last(&shard->queue);
+
+        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+        wait = fcn->expire - now;
+
+        if (wait > 0) {
+
+            /*
+             * the queue is kept in the order of insertion, entries
+             * used since they were last seen here get a second chance
+             */
+
+            if (fcn->referenced) {
+                fcn->referenced = 0;
+                ngx_queue_remove(q);
+                ngx_queue_insert_head(&shard->queue, q);
+                continue;
+            }
+
+            wait = wait > 10 ? 10 : wait;
+            break;
+        }
+
+        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache expire: #%d %d %02xd%02xd%02xd%02xd",
+                       fcn->count, fcn->exists,
+                       fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+
+        if (fcn->count == 0) {
+            ngx_http_file_cache_delete(cache, shard, q, name);
+            continue;
+        }
+
+        if (fcn->deleting) {
+            wait = 1;
+            break;
+        }
+
+        p = ngx_hex_dump(key, (u_char *) &fcn->node.key,
+                         sizeof(ngx_rbtree_key_t));
+        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
+        (void) ngx_hex_dump(p, fcn->key, len);
+
+        /*
+         * abnormally exited workers may leave locked cache entries,
+         * and although it may be safe to remove them completely,
+         * we prefer to just move them to the top of the inactive queue
+         */
+
+        ngx_queue_remove(q);
+        fcn->expire = ngx_time() + cache->inactive;
+        ngx_queue_insert_head(&shard->queue, &fcn->queue);
+
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, 0,
+                      "ignore long locked inactive cache entry %*s, count:%d",
+                      2 * NGX_HTTP_CACHE_KEY_LEN, key, fcn->count);
+    }
+
+    ngx_shmtx_unlock(&shard->mutex);
+
+    return wait;
+}
+
+
+static void
+ngx_http_file_cache_delete(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_shard_t *shard, ngx_queue_t *q, u_char *name)
+{
+    u_char                      *p;
+    size_t                       len;
+    ngx_path_t                  *path;
+    ngx_http_file_cache_node_t  *fcn;
+
+    fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+    if (fcn->exists) {
+        shard->size -= fcn->fs_size;
+
+        path = cache->path;
+        p = name + path->name.len + 1 + path->len;
+        p = ngx_hex_dump(p, (u_char *) &fcn->node.key,
+                         sizeof(ngx_rbtree_key_t));
+        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
+        p = ngx_hex_dump(p, fcn->key, len);
+        *p = '\0';
+
+        fcn->count++;
+        fcn->deleting = 1;
+        ngx_shmtx_unlock(&shard->mutex);
+
+        len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+        ngx_create_hashed_filename(path, name, len);
+
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache expire: \"%s\"", name);
+
+        if (ngx_delete_file(name) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                          ngx_delete_file_n " \"%s\" failed", name);
+        }
+
+        ngx_shmtx_lock(&shard->mutex);
+        fcn->count--;
+        fcn->deleting = 0;
+    }
+
+    if (fcn->count == 0) {
+        ngx_queue_remove(q);
+        ngx_rbtree_delete(&shard->rbtree, &fcn->node);
+        ngx_slab_free(cache->shpool, fcn);
+    }
+}
+
+
+static off_t
+ngx_http_file_cache_size(ngx_http_file_cache_t *cache)
+{
+    off_t                         size;
+    ngx_uint_t                    n;
+    ngx_http_file_cache_shard_t  *shard;
+
+    /* the sizes are kept per shard to be updated under the shard locks */
+
+    size = 0;
+
+    for (n = 0; n < cache->shards; n++) {
+        shard = cache->sh->shards[n];
+
+        ngx_shmtx_lock(&shard->mutex);
+        size += shard->size;
+        ngx_shmtx_unlock(&shard->mutex);
+    }
+
+    return size;
+}
+
+
+static time_t
+ngx_http_file_cache_manager(void *data)
+{
+    ngx_http_file_cache_t  *cache = data;
+
+    off_t   size;
+    time_t  next, wait;
+
+    next = ngx_http_file_cache_expire(cache);
+
+    cache->last = ngx_current_msec;
+    cache->files = 0;
+
+    for ( ;; ) {
+        size = ngx_http_file_cache_size(cache);
 
         ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
                        "http file cache size: %O", size);
@@ -1914,6 +2476,7 @@ ngx_http_file_cache_loader(void *data)
 {
     ngx_http_file_cache_t  *cache = data;
 
+    ngx_int_t       rc;
     ngx_tree_ctx_t  tree;
 
     if (!cache->sh->cold || cache->sh->loading) {
@@ -1927,19 +2490,29 @@ ngx_http_file_cache_loader(void *data)
     ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
                    "http file cache loader");
 
-    tree.init_handler = NULL;
-    tree.file_handler = ngx_http_file_cache_manage_file;
-    tree.pre_tree_handler = ngx_http_file_cache_manage_directory;
-    tree.post_tree_handler = ngx_http_file_cache_noop;
-    tree.spec_handler = ngx_http_file_cache_delete_file;
-    tree.data = cache;
-    tree.alloc = 0;
-    tree.log = ngx_cycle->log;
+    rc = NGX_DECLINED;
 
-    cache->last = ngx_current_msec;
-    cache->files = 0;
+    if (cache->index.len) {
+        rc = ngx_http_file_cache_index_load(cache);
+    }
+
+    if (rc == NGX_DECLINED) {
+        tree.init_handler = NULL;
+        tree.file_handler = ngx_http_file_cache_manage_file;
+        tree.pre_tree_handler = ngx_http_file_cache_manage_directory;
+        tree.post_tree_handler = ngx_http_file_cache_noop;
+        tree.spec_handler = ngx_http_file_cache_delete_file;
+        tree.data = cache;
+        tree.alloc = 0;
+        tree.log = ngx_cycle->log;
+
+        cache->last = ngx_current_msec;
+        cache->files = 0;
 
-    if (ngx_walk_tree(&tree, &cache->path->name) == NGX_ABORT) {
+        rc = ngx_walk_tree(&tree, &cache->path->name);
+    }
+
+    if (rc == NGX_ABORT) {
         cache->sh->loading = 0;
         return;
     }
@@ -1950,7 +2523,8 @@ ngx_http_file_cache_loader(void *data)
     ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
                   "http file cache: %V %.3fM, bsize: %uz",
                   &cache->path->name,
-                  ((double) cache->sh->size * cache->bsize) / (1024 * 1024),
+                  ((double) ngx_http_file_cache_size(cache) * cache->bsize)
+                  / (1024 * 1024),
                   cache->bsize);
 }
 
@@ -2058,52 +2632,61 @@ ngx_http_file_cache_add_file(ngx_tree_ctx_t *ctx, ngx_str_t *name)
         c.key[i] = (u_char) n;
     }
 
-    return ngx_http_file_cache_add(cache, &c);
+    return ngx_http_file_cache_add(cache, c.key, c.fs_size);
 }
 
 
 static ngx_int_t
-ngx_http_file_cache_add(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
+ngx_http_file_cache_add(ngx_http_file_cache_t *cache, u_char *key,
+    off_t fs_size)
 {
-    ngx_http_file_cache_node_t  *fcn;
+    ngx_int_t                     rc;
+    ngx_http_file_cache_node_t   *fcn;
+    ngx_http_file_cache_shard_t  *shard;
+
+    shard = ngx_http_file_cache_shard(cache, key);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&shard->mutex);
 
-    fcn = ngx_http_file_cache_lookup(cache, c->key);
+    fcn = ngx_http_file_cache_lookup(shard, key);
 
     if (fcn == NULL) {
 
-        fcn = ngx_slab_calloc_locked(cache->shpool,
-                                     sizeof(ngx_http_file_cache_node_t));
+        fcn = ngx_slab_calloc(cache->shpool,
+                              sizeof(ngx_http_file_cache_node_t));
         if (fcn == NULL) {
-            ngx_shmtx_unlock(&cache->shpool->mutex);
-            return NGX_ERROR;
+            rc = NGX_ERROR;
+            goto done;
         }
 
-        ngx_memcpy((u_char *) &fcn->node.key, c->key, sizeof(ngx_rbtree_key_t));
+        ngx_memcpy((u_char *) &fcn->node.key, key, sizeof(ngx_rbtree_key_t));
 
-        ngx_memcpy(fcn->key, &c->key[sizeof(ngx_rbtree_key_t)],
+        ngx_memcpy(fcn->key, &key[sizeof(ngx_rbtree_key_t)],
                    NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
 
-        ngx_rbtree_insert(&cache->sh->rbtree, &fcn->node);
+        ngx_rbtree_insert(&shard->rbtree, &fcn->node);
+
+        ngx_queue_insert_head(&shard->queue, &fcn->queue);
 
         fcn->uses = 1;
         fcn->exists = 1;
-        fcn->fs_size = c->fs_size;
+        fcn->fs_size = fs_size;
 
-        cache->sh->size += c->fs_size;
+        shard->size += fs_size;
 
     } else {
-        ngx_queue_remove(&fcn->queue);
+        fcn->referenced = 1;
     }
 
     fcn->expire = ngx_time() + cache->inactive;
 
-    ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+    rc = NGX_OK;
+
+done:
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_shmtx_unlock(&shard->mutex);
 
-    return NGX_OK;
+    return rc;
 }
 
 
@@ -2122,6 +2705,424 @@ ngx_http_file_cache_delete_file(ngx_tree_ctx_t *ctx, ngx_str_t *path)
 }
 
 
+void
+ngx_http_file_cache_exit_master(ngx_cycle_t *cycle)
+{
+    ngx_uint_t              i;
+    ngx_path_t            **path;
+    ngx_http_file_cache_t  *cache;
+
+    /*
+     * the index is written by the master process after all other processes
+     * have exited, so no cache file can be added or removed after it;
+     * an upgraded binary keeps running with the cache and writes its own
+     */
+
+    if (ngx_new_binary) {
+        return;
+    }
+
+    path = cycle->paths.elts;
+
+    for (i = 0; i < cycle->paths.nelts; i++) {
+
+        if (path[i]->manager != ngx_http_file_cache_manager) {
+            continue;
+        }
+
+        cache = path[i]->data;
+
+        /* an index of a cache that is still loading would be incomplete */
+
+        if (cache->index.len == 0 || cache->sh->cold) {
+            continue;
+        }
+
+        (void) ngx_http_file_cache_index_write(cache);
+    }
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_index_write(ngx_http_file_cache_t *cache)
+{
+    u_char                              *p, *last, key[NGX_HTTP_CACHE_KEY_LEN];
+    off_t                                offset;
+    size_t                               size;
+    ngx_str_t                            temp;
+    ngx_uint_t                           i, k, n;
+    ngx_file_t                           file;
+    ngx_rbtree_node_t                   *node, *prev;
+    ngx_http_file_cache_node_t          *fcn;
+    ngx_http_file_cache_shard_t         *shard;
+    ngx_http_file_cache_index_entry_t   *entries;
+    ngx_http_file_cache_index_header_t   header;
+
+    entries = ngx_alloc(NGX_HTTP_FILE_CACHE_INDEX_BATCH
+                        * sizeof(ngx_http_file_cache_index_entry_t)
+                        + cache->index.len + sizeof(".tmp"),
+                        ngx_cycle->log);
+    if (entries == NULL) {
+        return NGX_ERROR;
+    }
+
+    temp.len = cache->index.len + sizeof(".tmp") - 1;
+    temp.data = (u_char *) &entries[NGX_HTTP_FILE_CACHE_INDEX_BATCH];
+
+    p = ngx_cpymem(temp.data, cache->index.data, cache->index.len);
+    ngx_memcpy(p, ".tmp", sizeof(".tmp"));
+
+    ngx_memzero(&file, sizeof(ngx_file_t));
+
+    file.name = temp;
+    file.log = ngx_cycle->log;
+
+    file.fd = ngx_open_file(temp.data, NGX_FILE_WRONLY, NGX_FILE_TRUNCATE,
+                            NGX_FILE_DEFAULT_ACCESS);
+
+    if (file.fd == NGX_INVALID_FILE) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_open_file_n " \"%s\" failed", temp.data);
+        ngx_free(entries);
+        return NGX_ERROR;
+    }
+
+    ngx_http_file_cache_index_header(cache, &header);
+
+    offset = sizeof(ngx_http_file_cache_index_header_t);
+
+    /*
+     * the tree of each shard is walked in key order in small batches,
+     * so the shard mutex is never held for long and the walk can resume
+     * after the last key even if nodes were added or removed in between
+     */
+
+    for (k = 0; k < cache->shards; k++) {
+
+        shard = cache->sh->shards[k];
+        last = NULL;
+
+        do {
+            n = 0;
+            prev = NULL;
+
+            ngx_shmtx_lock(&shard->mutex);
+
+            node = ngx_http_file_cache_index_next(shard, last);
+
+            for (i = 0; node && i < NGX_HTTP_FILE_CACHE_INDEX_BATCH; i++) {
+
+                fcn = (ngx_http_file_cache_node_t *) node;
+
+                if (fcn->exists && !fcn->deleting) {
+                    p = ngx_cpymem(entries[n].key, (u_char *) &node->key,
+                                   sizeof(ngx_rbtree_key_t));
+                    ngx_memcpy(p, fcn->key, NGX_HTTP_CACHE_KEY_LEN
+                                            - sizeof(ngx_rbtree_key_t));
+                    entries[n].fs_size = fcn->fs_size;
+                    n++;
+                }
+
+                prev = node;
+                node = ngx_rbtree_next(&shard->rbtree, node);
+            }
+
+            if (prev) {
+                fcn = (ngx_http_file_cache_node_t *) prev;
+
+                p = ngx_cpymem(key, (u_char *) &prev->key,
+                               sizeof(ngx_rbtree_key_t));
+                ngx_memcpy(p, fcn->key,
+                           NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+            }
+
+            ngx_shmtx_unlock(&shard->mutex);
+
+            if (n) {
+                size = n * sizeof(ngx_http_file_cache_index_entry_t);
+
+                if (ngx_write_file(&file, (u_char *) entries, size, offset)
+                    == NGX_ERROR)
+                {
+                    goto failed;
+                }
+
+                offset += size;
+                header.entries += n;
+            }
+
+            last = key;
+
+        } while (node);
+    }
+
+    if (ngx_write_file(&file, (u_char *) &header, sizeof(header), 0)
+        == NGX_ERROR)
+    {
+        goto failed;
+    }
+
+    if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", temp.data);
+    }
+
+    if (ngx_rename_file(temp.data, cache->index.data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                      temp.data, cache->index.data);
+        goto delete;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache index: \"%V\" %uL entries",
+                   &cache->index, header.entries);
+
+    ngx_free(entries);
+
+    return NGX_OK;
+
+failed:
+
+    if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", temp.data);
+    }
+
+delete:
+
+    if (ngx_delete_file(temp.data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_delete_file_n " \"%s\" failed", temp.data);
+    }
+
+    ngx_free(entries);
+
+    return NGX_ERROR;
+}
+
+
+static ngx_rbtree_node_t *
+ngx_http_file_cache_index_next(ngx_http_file_cache_shard_t *shard, u_char *key)
+{
+    ngx_int_t                    rc;
+    ngx_rbtree_key_t             node_key;
+    ngx_rbtree_node_t           *node, *next, *sentinel;
+    ngx_http_file_cache_node_t  *fcn;
+
+    node = shard->rbtree.root;
+    sentinel = shard->rbtree.sentinel;
+
+    if (node == sentinel) {
+        return NULL;
+    }
+
+    if (key == NULL) {
+        return ngx_rbtree_min(node, sentinel);
+    }
+
+    /* the first node with a key greater than the given one */
+
+    ngx_memcpy((u_char *) &node_key, key, sizeof(ngx_rbtree_key_t));
+
+    next = NULL;
+
+    while (node != sentinel) {
+
+        if (node_key < node->key) {
+            next = node;
+            node = node->left;
+            continue;
+        }
+
+        if (node_key > node->key) {
+            node = node->right;
+            continue;
+        }
+
+        /* node_key == node->key */
+
+        fcn = (ngx_http_file_cache_node_t *) node;
+
+        rc = ngx_memcmp(&key[sizeof(ngx_rbtree_key_t)], fcn->key,
+                        NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+        if (rc < 0) {
+            next = node;
+            node = node->left;
+            continue;
+        }
+
+        node = node->right;
+    }
+
+    return next;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_index_load(ngx_http_file_cache_t *cache)
+{
+    off_t                                offset;
+    size_t                               size;
+    ssize_t                              n;
+    uint64_t                             left;
+    ngx_int_t                            rc;
+    ngx_err_t                            err;
+    ngx_uint_t                           i, count;
+    ngx_file_t                           file;
+    ngx_file_info_t                      fi;
+    ngx_http_file_cache_index_entry_t   *entries;
+    ngx_http_file_cache_index_header_t   header, h;
+
+    ngx_memzero(&file, sizeof(ngx_file_t));
+
+    file.name = cache->index;
+    file.log = ngx_cycle->log;
+
+    file.fd = ngx_open_file(cache->index.data, NGX_FILE_RDONLY,
+                            NGX_FILE_OPEN, 0);
+
+    if (file.fd == NGX_INVALID_FILE) {
+        err = ngx_errno;
+
+        if (err != NGX_ENOENT) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                          ngx_open_file_n " \"%s\" failed",
+                          cache->index.data);
+        }
+
+        return NGX_DECLINED;
+    }
+
+    entries = NULL;
+    rc = NGX_DECLINED;
+
+    /*
+     * the index is used only once: it does not reflect changes made after
+     * this start, so a restart without a clean exit walks the directory
+     */
+
+    if (ngx_delete_file(cache->index.data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_delete_file_n " \"%s\" failed", cache->index.data);
+        goto done;
+    }
+
+    n = ngx_read_file(&file, (u_char *) &h, sizeof(h), 0);
+
+    if (n == NGX_ERROR) {
+        goto done;
+    }
+
+    ngx_http_file_cache_index_header(cache, &header);
+
+    if (n != sizeof(h)
+        || ngx_memcmp(&h, &header,
+                      offsetof(ngx_http_file_cache_index_header_t, entries))
+           != 0)
+    {
+        goto stale;
+    }
+
+    if (ngx_fd_info(file.fd, &fi) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_fd_info_n " \"%s\" failed", cache->index.data);
+        goto done;
+    }
+
+    if ((uint64_t) ngx_file_size(&fi)
+        != sizeof(h) + h.entries * sizeof(ngx_http_file_cache_index_entry_t))
+    {
+        goto stale;
+    }
+
+    entries = ngx_alloc(NGX_HTTP_FILE_CACHE_INDEX_BATCH
+                        * sizeof(ngx_http_file_cache_index_entry_t),
+                        ngx_cycle->log);
+    if (entries == NULL) {
+        goto done;
+    }
+
+    offset = sizeof(h);
+
+    for (left = h.entries; left; left -= count) {
+
+        count = (left < NGX_HTTP_FILE_CACHE_INDEX_BATCH)
+                ? (ngx_uint_t) left : NGX_HTTP_FILE_CACHE_INDEX_BATCH;
+
+        size = count * sizeof(ngx_http_file_cache_index_entry_t);
+
+        n = ngx_read_file(&file, (u_char *) entries, size, offset);
+
+        if (n != (ssize_t) size) {
+            goto done;
+        }
+
+        offset += size;
+
+        for (i = 0; i < count; i++) {
+            if (ngx_http_file_cache_add(cache, entries[i].key,
+                                        entries[i].fs_size)
+                != NGX_OK)
+            {
+                goto done;
+            }
+        }
+
+        if (ngx_quit || ngx_terminate) {
+            rc = NGX_ABORT;
+            goto done;
+        }
+    }
+
+    ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
+                  "http file cache: %V %uL entries loaded from \"%V\"",
+                  &cache->path->name, h.entries, &cache->index);
+
+    rc = NGX_OK;
+
+    goto done;
+
+stale:
+
+    ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
+                  "http file cache index \"%V\" is stale, ignored",
+                  &cache->index);
+
+done:
+
+    if (entries) {
+        ngx_free(entries);
+    }
+
+    if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", cache->index.data);
+    }
+
+    return rc;
+}
+
+
+static void
+ngx_http_file_cache_index_header(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_index_header_t *h)
+{
+    ngx_uint_t  i;
+
+    *h = ngx_http_file_cache_index_tmpl;
+
+    h->bsize = (uint32_t) cache->bsize;
+
+    for (i = 0; i < NGX_MAX_PATH_LEVEL; i++) {
+        h->levels[i] = (u_char) cache->path->level[i];
+    }
+
+    h->time = (uint64_t) ngx_time();
+}
+
+
 time_t
 ngx_http_file_cache_valid(ngx_array_t *cache_valid, ngx_uint_t status)
 {
@@ -2158,8 +3159,8 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     time_t                  inactive;
     size_t                  len;
     ssize_t                 size;
-    ngx_str_t               s, name, *value;
-    ngx_int_t               loader_files;
+    ngx_str_t               s, name, index, *value;
+    ngx_int_t               loader_files, shards;
     ngx_msec_t              loader_sleep, loader_threshold;
     ngx_uint_t              i, n, use_temp_path;
     ngx_array_t            *caches;
@@ -2182,6 +3183,10 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     loader_sleep = 50;
     loader_threshold = 200;
 
+    ngx_str_null(&index);
+
+    shards = 1;
+
     name.len = 0;
     size = 0;
     max_size = NGX_MAX_OFF_T_VALUE;
@@ -2353,6 +3358,36 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             continue;
         }
 
+        if (ngx_strncmp(value[i].data, "index=", 6) == 0) {
+
+            index.len = value[i].len - 6;
+            index.data = value[i].data + 6;
+
+            if (index.len == 0) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid index value \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            if (ngx_conf_full_name(cf->cycle, &index, 0) != NGX_OK) {
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "shards=", 7) == 0) {
+
+            shards = ngx_atoi(value[i].data + 7, value[i].len - 7);
+            if (shards == NGX_ERROR || shards == 0 || shards > 256) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid shards value \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
         ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
                            "invalid parameter \"%V\"", &value[i]);
         return NGX_CONF_ERROR;
@@ -2373,6 +3408,8 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     cache->loader_files = loader_files;
     cache->loader_sleep = loader_sleep;
     cache->loader_threshold = loader_threshold;
+    cache->index = index;
+    cache->shards = shards;
 
     if (ngx_add_path(cf, &cache->path) != NGX_OK) {
         return NGX_CONF_ERROR;
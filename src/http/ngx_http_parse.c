@@ -9,6 +9,79 @@
 #include <ngx_core.h>
 #include <ngx_http.h>
 
+#if (NGX_HAVE_SSE42)
+#include <nmmintrin.h>
+#endif
+
+#if (NGX_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
+
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+
+typedef struct {
+    u_char    chars[16];
+    u_char    nibbles[16];
+    int       len;
+} ngx_http_parse_stop_t;
+
+
+static ngx_inline u_char *ngx_http_parse_skip(u_char *p, u_char *last,
+    ngx_http_parse_stop_t *stop);
+
+#if (NGX_HAVE_SSE42)
+static u_char *ngx_http_parse_skip_sse42(u_char *p, u_char *last,
+    ngx_http_parse_stop_t *stop) __attribute__((target("sse4.2")));
+#endif
+
+#if (NGX_HAVE_AVX2)
+static u_char *ngx_http_parse_skip_avx2(u_char *p, u_char *last,
+    ngx_http_parse_stop_t *stop) __attribute__((target("avx2")));
+#endif
+
+
+/*
+ * the characters which are not "usual" in sw_check_uri and
+ * the characters which end a run in sw_uri and in a header value;
+ * "chars" are padded to 16 bytes for unaligned vector loads, and
+ * bit N of nibbles[L] is set if the character 0xNL is in the set
+ */
+
+static ngx_http_parse_stop_t  ngx_http_parse_uri_stop = {
+    { '\0', LF, CR, ' ', '#', '%', '+', '.', '/', '?',
+#if (NGX_WIN32)
+      '\\'
+#endif
+    },
+    { 0x05, 0, 0, 0x04, 0, 0x04, 0, 0, 0, 0, 0x01, 0x04,
+#if (NGX_WIN32)
+      0x20,
+#else
+      0,
+#endif
+      0x01, 0x04, 0x0c },
+#if (NGX_WIN32)
+    11
+#else
+    10
+#endif
+};
+
+static ngx_http_parse_stop_t  ngx_http_parse_args_stop = {
+    { '\0', LF, CR, ' ', '#' },
+    { 0x05, 0, 0, 0x04, 0, 0, 0, 0, 0, 0, 0x01, 0, 0, 0x01, 0, 0 },
+    5
+};
+
+static ngx_http_parse_stop_t  ngx_http_parse_value_stop = {
+    { '\0', LF, CR, ' ' },
+    { 0x05, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0, 0, 0x01, 0, 0 },
+    4
+};
+
+#endif
+
 
 static uint32_t  usual[] = {
     0xffffdbfe, /* 1111 1111 1111 1111  1101 1011 1111 1110 */
@@ -540,6 +613,11 @@ ngx_http_parse_request_line(ngx_http_request_t *r, ngx_buf_t *b)
         /* check "/", "%" and "\" (Win32) in URI */
         case sw_check_uri:
 
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+            p = ngx_http_parse_skip(p, b->last, &ngx_http_parse_uri_stop);
+            ch = *p;
+#endif
+
             if (usual[ch >> 5] & (1 << (ch & 0x1f))) {
                 break;
             }
@@ -626,6 +704,11 @@ ngx_http_parse_request_line(ngx_http_request_t *r, ngx_buf_t *b)
         /* URI */
         case sw_uri:
 
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+            p = ngx_http_parse_skip(p, b->last, &ngx_http_parse_args_stop);
+            ch = *p;
+#endif
+
             if (usual[ch >> 5] & (1 << (ch & 0x1f))) {
                 break;
             }
@@ -998,6 +1081,12 @@ ngx_http_parse_header_line(ngx_http_request_t *r, ngx_buf_t *b,
 
         /* header value */
         case sw_value:
+
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+            p = ngx_http_parse_skip(p, b->last, &ngx_http_parse_value_stop);
+            ch = *p;
+#endif
+
             switch (ch) {
             case ' ':
                 r->header_end = p;
@@ -2361,3 +2450,120 @@ invalid:
 
     return NGX_ERROR;
 }
+
+
+#if (NGX_HAVE_SSE42 || NGX_HAVE_AVX2)
+
+/*
+ * skips a run of characters not listed in "stop", at least one byte is
+ * always left before "last", so the caller may dereference the result;
+ * the remaining bytes are handled by the state machines, and the runs of
+ * up to 32 bytes, which are common, are left to SSE4.2
+ */
+
+static ngx_inline u_char *
+ngx_http_parse_skip(u_char *p, u_char *last, ngx_http_parse_stop_t *stop)
+{
+    if (last - p <= 16) {
+        return p;
+    }
+
+#if (NGX_HAVE_AVX2)
+    if ((ngx_cpu_features & NGX_CPU_AVX2) && last - p > 32) {
+        return ngx_http_parse_skip_avx2(p, last, stop);
+    }
+#endif
+
+#if (NGX_HAVE_SSE42)
+    if (ngx_cpu_features & NGX_CPU_SSE42) {
+        return ngx_http_parse_skip_sse42(p, last, stop);
+    }
+#endif
+
+    return p;
+}
+
+
+#if (NGX_HAVE_SSE42)
+
+static u_char *
+ngx_http_parse_skip_sse42(u_char *p, u_char *last,
+    ngx_http_parse_stop_t *stop)
+{
+    int      i;
+    __m128i  set, v;
+
+    set = _mm_loadu_si128((__m128i *) stop->chars);
+
+    while (last - p > 16) {
+        v = _mm_loadu_si128((__m128i *) p);
+
+        i = _mm_cmpestri(set, stop->len, v, 16,
+                         _SIDD_UBYTE_OPS|_SIDD_CMP_EQUAL_ANY
+                         |_SIDD_LEAST_SIGNIFICANT);
+
+        if (i < 16) {
+            return p + i;
+        }
+
+        p += 16;
+    }
+
+    return p;
+}
+
+#endif
+
+
+#if (NGX_HAVE_AVX2)
+
+static u_char *
+ngx_http_parse_skip_avx2(u_char *p, u_char *last, ngx_http_parse_stop_t *stop)
+{
+    uint32_t  mask;
+    __m128i   set;
+    __m256i   lo, hi, nibble, zero, v, m;
+
+    /*
+     * a byte is in the set if the bits its low nibble selects in "nibbles"
+     * include the bit of its high nibble, the bytes above 0x7f are not
+     */
+
+    set = _mm_loadu_si128((__m128i *) stop->nibbles);
+
+    lo = _mm256_broadcastsi128_si256(set);
+    hi = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                          0, 0, 0, 0, 0, 0, 0, 0,
+                          1, 2, 4, 8, 16, 32, 64, -128,
+                          0, 0, 0, 0, 0, 0, 0, 0);
+    nibble = _mm256_set1_epi8(0x0f);
+    zero = _mm256_setzero_si256();
+
+    while (last - p > 32) {
+        v = _mm256_loadu_si256((__m256i *) p);
+
+        m = _mm256_and_si256(
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble)),
+                _mm256_shuffle_epi8(hi, _mm256_and_si256(
+                                            _mm256_srli_epi16(v, 4), nibble)));
+
+        mask = ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(m, zero));
+
+        if (mask) {
+            p += __builtin_ctz(mask);
+            break;
+        }
+
+        p += 32;
+    }
+
+    /* avoid the AVX to SSE transition penalty in the code that follows */
+
+    _mm256_zeroupper();
+
+    return p;
+}
+
+#endif
+
+#endif
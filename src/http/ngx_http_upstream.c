@@ -17,6 +17,10 @@ static ngx_int_t ngx_http_upstream_cache_get(ngx_http_request_t *r,
     ngx_http_upstream_t *u, ngx_http_file_cache_t **cache);
 static ngx_int_t ngx_http_upstream_cache_send(ngx_http_request_t *r,
     ngx_http_upstream_t *u);
+#if (NGX_HTTP_GZIP)
+static void ngx_http_upstream_cache_encoded(ngx_http_request_t *r,
+    ngx_http_upstream_t *u);
+#endif
 static ngx_int_t ngx_http_upstream_cache_status(ngx_http_request_t *r,
     ngx_http_variable_value_t *v, uintptr_t data);
 static ngx_int_t ngx_http_upstream_cache_last_modified(ngx_http_request_t *r,
@@ -65,6 +69,10 @@ static void ngx_http_upstream_upgraded_write_upstream(ngx_http_request_t *r,
     ngx_http_upstream_t *u);
 static void ngx_http_upstream_process_upgraded(ngx_http_request_t *r,
     ngx_uint_t from_upstream, ngx_uint_t do_write);
+#if (NGX_HAVE_SPLICE)
+static ngx_int_t ngx_http_upstream_splice_upgraded(ngx_http_request_t *r,
+    ngx_uint_t from_upstream, ngx_uint_t do_write);
+#endif
 static void
     ngx_http_upstream_process_non_buffered_downstream(ngx_http_request_t *r);
 static void
@@ -348,7 +356,11 @@ ngx_module_t  ngx_http_upstream_module = {
     NULL,                                  /* init thread */
     NULL,                                  /* exit thread */
     NULL,                                  /* exit process */
+#if (NGX_HTTP_CACHE)
+    ngx_http_file_cache_exit_master,       /* exit master */
+#else
     NULL,                                  /* exit master */
+#endif
     NGX_MODULE_V1_PADDING
 };
 
@@ -475,8 +487,8 @@ ngx_http_upstream_init(ngx_http_request_t *r)
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->log, 0,
                    "http init upstream, client timer: %d", c->read->timer_set);
 
-#if (NGX_HTTP_SPDY)
-    if (r->spdy_stream) {
+#if (NGX_HTTP_V2)
+    if (r->stream) {
         ngx_http_upstream_init_request(r);
         return;
     }
@@ -710,6 +722,8 @@ found:
         return;
     }
 
+    u->upstream = uscf;
+
 #if (NGX_HTTP_SSL)
     u->ssl_name = uscf->host;
 #endif
@@ -808,13 +822,38 @@ ngx_http_upstream_cache(ngx_http_request_t *r, ngx_http_upstream_t *u)
         c->lock_age = u->conf->cache_lock_age;
 
         u->cache_status = NGX_HTTP_CACHE_MISS;
+
+#if (NGX_HTTP_GZIP)
+        if (u->conf->cache_compressed) {
+            ngx_http_upstream_cache_encoded(r, u);
+        }
+#endif
     }
 
+open:
+
     rc = ngx_http_file_cache_open(r);
 
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
                    "http upstream cache: %i", rc);
 
+#if (NGX_HTTP_GZIP)
+
+    if (c->encoding.len
+        && rc != NGX_OK && rc != NGX_AGAIN && rc != NGX_ERROR)
+    {
+        /* the compressed variant is unusable, fall back to the original */
+
+        ngx_http_file_cache_encoded_close(r);
+
+        c->body_start = u->conf->buffer_size;
+        c->lock = u->conf->cache_lock;
+
+        goto open;
+    }
+
+#endif
+
     switch (rc) {
 
     case NGX_HTTP_CACHE_UPDATING:
@@ -843,6 +882,20 @@ ngx_http_upstream_cache(ngx_http_request_t *r, ngx_http_upstream_t *u)
             return rc;
         }
 
+#if (NGX_HTTP_GZIP)
+
+        if (c->encoding.len) {
+            ngx_http_file_cache_encoded_close(r);
+
+            c->body_start = u->conf->buffer_size;
+            c->lock = u->conf->cache_lock;
+            u->cache_status = NGX_HTTP_CACHE_MISS;
+
+            goto open;
+        }
+
+#endif
+
         break;
 
     case NGX_HTTP_CACHE_STALE:
@@ -942,6 +995,9 @@ ngx_http_upstream_cache_send(ngx_http_request_t *r, ngx_http_upstream_t *u)
 {
     ngx_int_t          rc;
     ngx_http_cache_t  *c;
+#if (NGX_HTTP_GZIP)
+    ngx_table_elt_t   *h;
+#endif
 
     r->cached = 1;
     c = r->cache;
@@ -975,6 +1031,39 @@ ngx_http_upstream_cache_send(ngx_http_request_t *r, ngx_http_upstream_t *u)
             return NGX_DONE;
         }
 
+#if (NGX_HTTP_GZIP)
+
+        if (c->encoding.len) {
+            h = ngx_list_push(&r->headers_out.headers);
+            if (h == NULL) {
+                return NGX_ERROR;
+            }
+
+            h->hash = 1;
+            ngx_str_set(&h->key, "Content-Encoding");
+            h->value = c->encoding;
+
+            r->headers_out.content_encoding = h;
+
+            ngx_http_clear_content_length(r);
+            r->headers_out.content_length_n = c->length - c->body_start;
+
+            ngx_http_weak_etag(r);
+
+            /* unlike the gzip filter, regardless of "gzip_vary" */
+
+            h = ngx_list_push(&r->headers_out.headers);
+            if (h == NULL) {
+                return NGX_ERROR;
+            }
+
+            h->hash = 1;
+            ngx_str_set(&h->key, "Vary");
+            ngx_str_set(&h->value, "Accept-Encoding");
+        }
+
+#endif
+
         return ngx_http_cache_send(r);
     }
 
@@ -989,6 +1078,48 @@ ngx_http_upstream_cache_send(ngx_http_request_t *r, ngx_http_upstream_t *u)
     return rc;
 }
 
+
+#if (NGX_HTTP_GZIP)
+
+static void
+ngx_http_upstream_cache_encoded(ngx_http_request_t *r, ngx_http_upstream_t *u)
+{
+    ngx_str_t  encoding;
+
+#if (NGX_HTTP_BROTLI)
+
+    if (ngx_http_brotli_ok(r) == NGX_OK) {
+        ngx_str_set(&encoding, "br");
+
+        if (ngx_http_file_cache_encoded_open(r, &encoding) == NGX_OK) {
+            goto found;
+        }
+    }
+
+#endif
+
+    if (ngx_http_gzip_ok(r) == NGX_OK) {
+        ngx_str_set(&encoding, "gzip");
+
+        if (ngx_http_file_cache_encoded_open(r, &encoding) == NGX_OK) {
+            goto found;
+        }
+    }
+
+    return;
+
+found:
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http upstream cache encoding: \"%V\"", &encoding);
+
+    /* the variant is only ever written by a cache hit, nothing to wait for */
+
+    r->cache->lock = 0;
+}
+
+#endif
+
 #endif
 
 
@@ -1148,8 +1279,8 @@ ngx_http_upstream_check_broken_connection(ngx_http_request_t *r,
         return;
     }
 
-#if (NGX_HTTP_SPDY)
-    if (r->spdy_stream) {
+#if (NGX_HTTP_V2)
+    if (r->stream) {
         return;
     }
 #endif
@@ -1336,6 +1467,33 @@ ngx_http_upstream_connect(ngx_http_request_t *r, ngx_http_upstream_t *u)
         return;
     }
 
+#if (NGX_HTTP_UPSTREAM_ZONE)
+
+    /* a peer in a shared zone may be removed before the request ends */
+
+    if (u->upstream && u->upstream->shm_zone && rc != NGX_BUSY) {
+        ngx_str_t  *name;
+
+        name = ngx_palloc(r->pool, sizeof(ngx_str_t));
+        if (name == NULL) {
+            ngx_http_upstream_finalize_request(r, u,
+                                               NGX_HTTP_INTERNAL_SERVER_ERROR);
+            return;
+        }
+
+        name->len = u->peer.name->len;
+        name->data = ngx_pstrdup(r->pool, u->peer.name);
+        if (name->data == NULL) {
+            ngx_http_upstream_finalize_request(r, u,
+                                               NGX_HTTP_INTERNAL_SERVER_ERROR);
+            return;
+        }
+
+        u->peer.name = name;
+    }
+
+#endif
+
     u->state->peer = u->peer.name;
 
     if (rc == NGX_BUSY) {
@@ -1353,6 +1511,9 @@ ngx_http_upstream_connect(ngx_http_request_t *r, ngx_http_upstream_t *u)
 
     c = u->peer.connection;
 
+    c->requests++;
+    u->state->cached = u->peer.cached;
+
     c->data = r;
 
     c->write->handler = ngx_http_upstream_handler;
@@ -3070,9 +3231,13 @@ ngx_http_upstream_process_upgraded(ngx_http_request_t *r,
     size_t                     size;
     ssize_t                    n;
     ngx_buf_t                 *b;
+    ngx_uint_t                 upstream_busy, downstream_busy;
     ngx_connection_t          *c, *downstream, *upstream, *dst, *src;
     ngx_http_upstream_t       *u;
     ngx_http_core_loc_conf_t  *clcf;
+#if (NGX_HAVE_SPLICE)
+    ngx_int_t                  rc;
+#endif
 
     c = r->connection;
     u = r->upstream;
@@ -3127,6 +3292,23 @@ ngx_http_upstream_process_upgraded(ngx_http_request_t *r,
         }
     }
 
+#if (NGX_HAVE_SPLICE)
+
+    if (b->pos == b->last) {
+        rc = ngx_http_upstream_splice_upgraded(r, from_upstream, do_write);
+
+        if (rc == NGX_ERROR) {
+            ngx_http_upstream_finalize_request(r, u, NGX_ERROR);
+            return;
+        }
+
+        if (rc == NGX_OK) {
+            goto done;
+        }
+    }
+
+#endif
+
     for ( ;; ) {
 
         if (do_write) {
@@ -3178,8 +3360,27 @@ ngx_http_upstream_process_upgraded(ngx_http_request_t *r,
         break;
     }
 
-    if ((upstream->read->eof && u->buffer.pos == u->buffer.last)
-        || (downstream->read->eof && u->from_client.pos == u->from_client.last)
+#if (NGX_HAVE_SPLICE)
+done:
+#endif
+
+    upstream_busy = (u->buffer.pos != u->buffer.last);
+    downstream_busy = (u->from_client.pos != u->from_client.last);
+
+#if (NGX_HAVE_SPLICE)
+
+    if (u->splice_upstream && u->splice_upstream->size) {
+        upstream_busy = 1;
+    }
+
+    if (u->splice_downstream && u->splice_downstream->size) {
+        downstream_busy = 1;
+    }
+
+#endif
+
+    if ((upstream->read->eof && !upstream_busy)
+        || (downstream->read->eof && !downstream_busy)
         || (downstream->read->eof && upstream->read->eof))
     {
         ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0,
@@ -3237,6 +3438,97 @@ ngx_http_upstream_process_upgraded(ngx_http_request_t *r,
 }
 
 
+#if (NGX_HAVE_SPLICE)
+
+static ngx_int_t
+ngx_http_upstream_splice_upgraded(ngx_http_request_t *r,
+    ngx_uint_t from_upstream, ngx_uint_t do_write)
+{
+    size_t                size;
+    ssize_t               n;
+    ngx_connection_t     *c, *src, *dst;
+    ngx_splice_pipe_t   **pp, *p;
+    ngx_http_upstream_t  *u;
+
+    c = r->connection;
+    u = r->upstream;
+
+    if (!u->conf->splice) {
+        return NGX_DECLINED;
+    }
+
+#if (NGX_HTTP_V2)
+    if (r->stream) {
+        return NGX_DECLINED;
+    }
+#endif
+
+#if (NGX_SSL)
+    if (c->ssl || u->peer.connection->ssl) {
+        return NGX_DECLINED;
+    }
+#endif
+
+    if (from_upstream) {
+        src = u->peer.connection;
+        dst = c;
+        pp = &u->splice_upstream;
+
+    } else {
+        src = c;
+        dst = u->peer.connection;
+        pp = &u->splice_downstream;
+    }
+
+    if (*pp == NULL) {
+        *pp = ngx_splice_pipe(r->pool, c->log);
+        if (*pp == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    p = *pp;
+
+    for ( ;; ) {
+
+        if (do_write && p->size && dst->write->ready) {
+
+            n = ngx_splice_send(dst, p);
+
+            if (n == NGX_ERROR) {
+                return NGX_ERROR;
+            }
+        }
+
+        size = p->capacity - p->size;
+
+        if (size && src->read->ready) {
+
+            n = ngx_splice_recv(src, p, size);
+
+            if (n == NGX_AGAIN || n == 0) {
+                break;
+            }
+
+            if (n > 0) {
+                do_write = 1;
+                continue;
+            }
+
+            if (n == NGX_ERROR) {
+                src->read->eof = 1;
+            }
+        }
+
+        break;
+    }
+
+    return NGX_OK;
+}
+
+#endif
+
+
 static void
 ngx_http_upstream_process_non_buffered_downstream(ngx_http_request_t *r)
 {
@@ -5375,7 +5667,7 @@ ngx_http_upstream_server(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     ngx_str_t                   *value, s;
     ngx_url_t                    u;
     ngx_int_t                    weight, max_fails;
-    ngx_uint_t                   i;
+    ngx_uint_t                   i, resolve;
     ngx_http_upstream_server_t  *us;
 
     us = ngx_array_push(uscf->servers);
@@ -5390,6 +5682,7 @@ ngx_http_upstream_server(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     weight = 1;
     max_fails = 1;
     fail_timeout = 10;
+    resolve = 0;
 
     for (i = 2; i < cf->args->nelts; i++) {
 
@@ -5463,13 +5756,42 @@ ngx_http_upstream_server(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             continue;
         }
 
+#if (NGX_HTTP_UPSTREAM_ZONE)
+
+        if (ngx_strcmp(value[i].data, "resolve") == 0) {
+            resolve = 1;
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "service=", 8) == 0) {
+
+            us->service.len = value[i].len - 8;
+            us->service.data = &value[i].data[8];
+
+            if (us->service.len == 0) {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+#endif
+
         goto invalid;
     }
 
+    if (us->service.len && !resolve) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "service upstream \"%V\" requires "
+                           "\"resolve\" parameter", &value[1]);
+        return NGX_CONF_ERROR;
+    }
+
     ngx_memzero(&u, sizeof(ngx_url_t));
 
     u.url = value[1];
     u.default_port = 80;
+    u.no_resolve = resolve;
 
     if (ngx_parse_url(cf->pool, &u) != NGX_OK) {
         if (u.err) {
@@ -5480,6 +5802,31 @@ ngx_http_upstream_server(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (resolve && u.naddrs == 0) {
+
+        /* the name is resolved again by a worker when its TTL expires */
+
+        us->host = u.host;
+        us->port = u.port;
+
+        if (us->service.len) {
+
+            if (!u.no_port) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "service upstream \"%V\" may not have "
+                                   "port", &value[1]);
+                return NGX_CONF_ERROR;
+            }
+
+        } else if (ngx_inet_resolve_host(cf->pool, &u) != NGX_OK) {
+            ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                               "%s in upstream \"%V\", "
+                               "will be resolved at run time",
+                               u.err ? u.err : "host not found", &u.url);
+            u.naddrs = 0;
+        }
+    }
+
     us->name = u.url;
     us->addrs = u.addrs;
     us->naddrs = u.naddrs;
@@ -53,6 +53,9 @@
 #define NGX_HTTP_UPSTREAM_IGN_VARY           0x00000200
 
 
+typedef struct ngx_http_upstream_srv_conf_s  ngx_http_upstream_srv_conf_t;
+
+
 typedef struct {
     ngx_msec_t                       bl_time;
     ngx_uint_t                       bl_state;
@@ -62,8 +65,13 @@ typedef struct {
     ngx_msec_t                       connect_time;
     ngx_msec_t                       header_time;
     off_t                            response_length;
+    ngx_uint_t                       cached;   /* unsigned  cached:1; */
 
     ngx_str_t                       *peer;
+
+    ngx_http_upstream_srv_conf_t    *upstream;
+    ngx_uint_t                       peer_id;
+    ngx_uint_t                       peer_version;
 } ngx_http_upstream_state_t;
 
 
@@ -73,8 +81,6 @@ typedef struct {
                                              /* ngx_http_upstream_srv_conf_t */
 } ngx_http_upstream_main_conf_t;
 
-typedef struct ngx_http_upstream_srv_conf_s  ngx_http_upstream_srv_conf_t;
-
 typedef ngx_int_t (*ngx_http_upstream_init_pt)(ngx_conf_t *cf,
     ngx_http_upstream_srv_conf_t *us);
 typedef ngx_int_t (*ngx_http_upstream_init_peer_pt)(ngx_http_request_t *r,
@@ -96,6 +102,11 @@ typedef struct {
     ngx_uint_t                       max_fails;
     time_t                           fail_timeout;
 
+    /* a name to resolve at run time */
+    ngx_str_t                        host;
+    in_port_t                        port;
+    ngx_str_t                        service;
+
     unsigned                         down:1;
     unsigned                         backup:1;
 } ngx_http_upstream_server_t;
@@ -125,6 +136,8 @@ struct ngx_http_upstream_srv_conf_s {
 
 #if (NGX_HTTP_UPSTREAM_ZONE)
     ngx_shm_zone_t                  *shm_zone;
+    ngx_resolver_t                  *resolver;
+    ngx_msec_t                       resolver_timeout;
 #endif
 };
 
@@ -164,6 +177,7 @@ typedef struct {
     ngx_uint_t                       next_upstream_tries;
     ngx_flag_t                       buffering;
     ngx_flag_t                       request_buffering;
+    ngx_flag_t                       splice;
     ngx_flag_t                       pass_request_headers;
     ngx_flag_t                       pass_request_body;
 
@@ -193,6 +207,7 @@ typedef struct {
     ngx_msec_t                       cache_lock_age;
 
     ngx_flag_t                       cache_revalidate;
+    ngx_flag_t                       cache_compressed;
 
     ngx_array_t                     *cache_valid;
     ngx_array_t                     *cache_bypass;
@@ -307,6 +322,7 @@ struct ngx_http_upstream_s {
     ngx_chain_writer_ctx_t           writer;
 
     ngx_http_upstream_conf_t        *conf;
+    ngx_http_upstream_srv_conf_t    *upstream;
 #if (NGX_HTTP_CACHE)
     ngx_array_t                     *caches;
 #endif
@@ -320,6 +336,11 @@ struct ngx_http_upstream_s {
     ngx_buf_t                        buffer;
     off_t                            length;
 
+#if (NGX_HAVE_SPLICE)
+    ngx_splice_pipe_t               *splice_upstream;
+    ngx_splice_pipe_t               *splice_downstream;
+#endif
+
     ngx_chain_t                     *out_bufs;
     ngx_chain_t                     *busy_bufs;
     ngx_chain_t                     *free_bufs;
@@ -16,6 +16,12 @@
 
 static ngx_http_upstream_rr_peer_t *ngx_http_upstream_get_peer(
     ngx_http_upstream_rr_peer_data_t *rrp);
+static void ngx_http_upstream_rr_peer_release(
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *peer);
+#if (NGX_HTTP_UPSTREAM_ZONE)
+static ngx_int_t ngx_http_upstream_init_resolve(ngx_conf_t *cf,
+    ngx_http_upstream_srv_conf_t *us);
+#endif
 
 #if (NGX_HTTP_SSL)
 
@@ -32,7 +38,7 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
     ngx_http_upstream_srv_conf_t *us)
 {
     ngx_url_t                      u;
-    ngx_uint_t                     i, j, n, w;
+    ngx_uint_t                     i, j, n, r, w;
     ngx_http_upstream_server_t    *server;
     ngx_http_upstream_rr_peer_t   *peer, **peerp;
     ngx_http_upstream_rr_peers_t  *peers, *backup;
@@ -42,7 +48,14 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
     if (us->servers) {
         server = us->servers->elts;
 
+#if (NGX_HTTP_UPSTREAM_ZONE)
+        if (ngx_http_upstream_init_resolve(cf, us) != NGX_OK) {
+            return NGX_ERROR;
+        }
+#endif
+
         n = 0;
+        r = 0;
         w = 0;
 
         for (i = 0; i < us->servers->nelts; i++) {
@@ -51,10 +64,11 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
             }
 
             n += server[i].naddrs;
+            r += server[i].host.len ? 1 : 0;
             w += server[i].naddrs * server[i].weight;
         }
 
-        if (n == 0) {
+        if (n + r == 0) {
             ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
                           "no servers in upstream \"%V\" in %s:%ui",
                           &us->host, us->file_name, us->line);
@@ -96,6 +110,7 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
                 peer[n].fail_timeout = server[i].fail_timeout;
                 peer[n].down = server[i].down;
                 peer[n].server = server[i].name;
+                peer[n].id = n;
 
                 *peerp = &peer[n];
                 peerp = &peer[n].next;
@@ -108,6 +123,7 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
         /* backup servers */
 
         n = 0;
+        r = 0;
         w = 0;
 
         for (i = 0; i < us->servers->nelts; i++) {
@@ -116,10 +132,11 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
             }
 
             n += server[i].naddrs;
+            r += server[i].host.len ? 1 : 0;
             w += server[i].naddrs * server[i].weight;
         }
 
-        if (n == 0) {
+        if (n + r == 0) {
             return NGX_OK;
         }
 
@@ -159,6 +176,7 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
                 peer[n].fail_timeout = server[i].fail_timeout;
                 peer[n].down = server[i].down;
                 peer[n].server = server[i].name;
+                peer[n].id = peers->number + n;
 
                 *peerp = &peer[n];
                 peerp = &peer[n].next;
@@ -225,6 +243,7 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
         peer[i].current_weight = 0;
         peer[i].max_fails = 1;
         peer[i].fail_timeout = 10;
+        peer[i].id = i;
         *peerp = &peer[i];
         peerp = &peer[i].next;
     }
@@ -237,6 +256,57 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
 }
 
 
+#if (NGX_HTTP_UPSTREAM_ZONE)
+
+static ngx_int_t
+ngx_http_upstream_init_resolve(ngx_conf_t *cf, ngx_http_upstream_srv_conf_t *us)
+{
+    ngx_uint_t                   i;
+    ngx_http_core_loc_conf_t    *clcf;
+    ngx_http_upstream_server_t  *server;
+
+    server = us->servers->elts;
+
+    for (i = 0; i < us->servers->nelts; i++) {
+        if (server[i].host.len) {
+            goto found;
+        }
+    }
+
+    return NGX_OK;
+
+found:
+
+    if (us->shm_zone == NULL) {
+        ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                      "resolving names at run time requires "
+                      "upstream \"%V\" in %s:%ui to be in shared memory",
+                      &us->host, us->file_name, us->line);
+        return NGX_ERROR;
+    }
+
+    clcf = ngx_http_conf_get_module_loc_conf(cf, ngx_http_core_module);
+
+    if (clcf->resolver == NULL
+        || clcf->resolver->udp_connections.nelts == 0)
+    {
+        ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                      "no resolver defined to resolve names at run time "
+                      "in upstream \"%V\" in %s:%ui",
+                      &us->host, us->file_name, us->line);
+        return NGX_ERROR;
+    }
+
+    us->resolver = clcf->resolver;
+    us->resolver_timeout = (clcf->resolver_timeout == NGX_CONF_UNSET_MSEC)
+                           ? 30000 : clcf->resolver_timeout;
+
+    return NGX_OK;
+}
+
+#endif
+
+
 ngx_int_t
 ngx_http_upstream_init_round_robin_peer(ngx_http_request_t *r,
     ngx_http_upstream_srv_conf_t *us)
@@ -255,15 +325,26 @@ ngx_http_upstream_init_round_robin_peer(ngx_http_request_t *r,
         r->upstream->peer.data = rrp;
     }
 
+    rrp->upstream = r->upstream;
     rrp->peers = us->peer.data;
     rrp->current = NULL;
 
+    ngx_http_upstream_rr_peers_rlock(rrp->peers);
+
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    rrp->config = rrp->peers->config ? *rrp->peers->config : 0;
+#endif
+
     n = rrp->peers->number;
 
     if (rrp->peers->next && rrp->peers->next->number > n) {
         n = rrp->peers->next->number;
     }
 
+    r->upstream->peer.tries = ngx_http_upstream_tries(rrp->peers);
+
+    ngx_http_upstream_rr_peers_unlock(rrp->peers);
+
     if (n <= 8 * sizeof(uintptr_t)) {
         rrp->tried = &rrp->data;
         rrp->data = 0;
@@ -279,7 +360,6 @@ ngx_http_upstream_init_round_robin_peer(ngx_http_request_t *r,
 
     r->upstream->peer.get = ngx_http_upstream_get_round_robin_peer;
     r->upstream->peer.free = ngx_http_upstream_free_round_robin_peer;
-    r->upstream->peer.tries = ngx_http_upstream_tries(rrp->peers);
 #if (NGX_HTTP_SSL)
     r->upstream->peer.set_session =
                                ngx_http_upstream_set_round_robin_peer_session;
@@ -386,8 +466,12 @@ ngx_http_upstream_create_round_robin_peer(ngx_http_request_t *r,
         }
     }
 
+    rrp->upstream = r->upstream;
     rrp->peers = peers;
     rrp->current = NULL;
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    rrp->config = 0;
+#endif
 
     if (rrp->peers->number <= 8 * sizeof(uintptr_t)) {
         rrp->tried = &rrp->data;
@@ -434,14 +518,18 @@ ngx_http_upstream_get_round_robin_peer(ngx_peer_connection_t *pc, void *data)
     peers = rrp->peers;
     ngx_http_upstream_rr_peers_wlock(peers);
 
+    if (ngx_http_upstream_rr_peers_changed(rrp)) {
+        goto busy;
+    }
+
     if (peers->single) {
         peer = peers->peer;
 
-        if (peer->down) {
+        if (peer->down || peer->hc_down) {
             goto failed;
         }
 
-        rrp->current = peer;
+        ngx_http_upstream_rr_set_current(rrp, peer);
 
     } else {
 
@@ -500,6 +588,8 @@ failed:
         peer->fails = 0;
     }
 
+busy:
+
     ngx_http_upstream_rr_peers_unlock(peers);
 
     pc->name = peers->name;
@@ -538,7 +628,7 @@ ngx_http_upstream_get_peer(ngx_http_upstream_rr_peer_data_t *rrp)
             continue;
         }
 
-        if (peer->down) {
+        if (peer->down || peer->hc_down) {
             continue;
         }
 
@@ -566,7 +656,7 @@ ngx_http_upstream_get_peer(ngx_http_upstream_rr_peer_data_t *rrp)
         return NULL;
     }
 
-    rrp->current = best;
+    ngx_http_upstream_rr_set_current(rrp, best);
 
     n = p / (8 * sizeof(uintptr_t));
     m = (uintptr_t) 1 << p % (8 * sizeof(uintptr_t));
@@ -583,6 +673,33 @@ ngx_http_upstream_get_peer(ngx_http_upstream_rr_peer_data_t *rrp)
 }
 
 
+void
+ngx_http_upstream_rr_set_current(ngx_http_upstream_rr_peer_data_t *rrp,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+    ngx_http_upstream_state_t  *state;
+
+    rrp->current = peer;
+
+    /*
+     * the peer is recorded in the upstream state by its id and version:
+     * a peer of a shared zone may be removed before the request is logged
+     */
+
+    state = rrp->upstream->state;
+
+    if (state == NULL) {
+        return;
+    }
+
+    state->upstream = rrp->upstream->upstream;
+    state->peer_id = peer->id;
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    state->peer_version = peer->version;
+#endif
+}
+
+
 void
 ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc, void *data,
     ngx_uint_t state)
@@ -604,10 +721,7 @@ ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc, void *data,
 
     if (rrp->peers->single) {
 
-        peer->conns--;
-
-        ngx_http_upstream_rr_peer_unlock(rrp->peers, peer);
-        ngx_http_upstream_rr_peers_unlock(rrp->peers);
+        ngx_http_upstream_rr_peer_release(rrp->peers, peer);
 
         pc->tries = 0;
         return;
@@ -646,10 +760,7 @@ ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc, void *data,
         }
     }
 
-    peer->conns--;
-
-    ngx_http_upstream_rr_peer_unlock(rrp->peers, peer);
-    ngx_http_upstream_rr_peers_unlock(rrp->peers);
+    ngx_http_upstream_rr_peer_release(rrp->peers, peer);
 
     if (pc->tries) {
         pc->tries--;
@@ -657,6 +768,35 @@ ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc, void *data,
 }
 
 
+static void
+ngx_http_upstream_rr_peer_release(ngx_http_upstream_rr_peers_t *peers,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    ngx_uint_t  zombie;
+#endif
+
+    peer->conns--;
+
+#if (NGX_HTTP_UPSTREAM_ZONE)
+
+    /* the last connection to a removed peer */
+
+    zombie = (peer->zombie && peer->conns == 0 && peer->refs == 0);
+
+#endif
+
+    ngx_http_upstream_rr_peer_unlock(peers, peer);
+    ngx_http_upstream_rr_peers_unlock(peers);
+
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    if (zombie) {
+        ngx_http_upstream_rr_peer_free(peers, peer);
+    }
+#endif
+}
+
+
 #if (NGX_HTTP_SSL)
 
 ngx_int_t
@@ -28,6 +28,9 @@ struct ngx_http_upstream_rr_peer_s {
 
     ngx_uint_t                      conns;
 
+    uint64_t                        ewma;          /* usec */
+    ngx_msec_t                      ewma_updated;
+
     ngx_uint_t                      fails;
     time_t                          accessed;
     time_t                          checked;
@@ -36,16 +39,27 @@ struct ngx_http_upstream_rr_peer_s {
     time_t                          fail_timeout;
 
     ngx_uint_t                      down;          /* unsigned  down:1; */
+    ngx_uint_t                      drain;         /* unsigned  drain:1; */
+
+    ngx_uint_t                      hc_down;       /* unsigned  hc_down:1; */
+    ngx_uint_t                      hc_fails;
+    ngx_uint_t                      hc_passes;
+    ngx_msec_t                      hc_checked;
 
 #if (NGX_HTTP_SSL)
     void                           *ssl_session;
     int                             ssl_session_len;
 #endif
 
+    ngx_uint_t                      id;
+
     ngx_http_upstream_rr_peer_t    *next;
 
 #if (NGX_HTTP_UPSTREAM_ZONE)
     ngx_atomic_t                    lock;
+    ngx_uint_t                      version;
+    ngx_uint_t                      refs;
+    ngx_uint_t                      zombie;        /* unsigned  zombie:1; */
 #endif
 };
 
@@ -58,6 +72,7 @@ struct ngx_http_upstream_rr_peers_s {
 #if (NGX_HTTP_UPSTREAM_ZONE)
     ngx_slab_pool_t                *shpool;
     ngx_atomic_t                    rwlock;
+    ngx_uint_t                     *config;
 #endif
 
     ngx_uint_t                      total_weight;
@@ -106,6 +121,14 @@ struct ngx_http_upstream_rr_peers_s {
         ngx_rwlock_unlock(&peer->lock);                                       \
     }
 
+/*
+ * the peers list was changed since the request started, so the positions
+ * in the "tried" bitmap no longer match the peers
+ */
+
+#define ngx_http_upstream_rr_peers_changed(rrp)                               \
+    ((rrp)->peers->config && (rrp)->config != *(rrp)->peers->config)
+
 #else
 
 #define ngx_http_upstream_rr_peers_rlock(peers)
@@ -113,18 +136,67 @@ struct ngx_http_upstream_rr_peers_s {
 #define ngx_http_upstream_rr_peers_unlock(peers)
 #define ngx_http_upstream_rr_peer_lock(peers, peer)
 #define ngx_http_upstream_rr_peer_unlock(peers, peer)
+#define ngx_http_upstream_rr_peers_changed(rrp)  0
 
 #endif
 
 
 typedef struct {
+    ngx_http_upstream_t            *upstream;
     ngx_http_upstream_rr_peers_t   *peers;
     ngx_http_upstream_rr_peer_t    *current;
     uintptr_t                      *tried;
     uintptr_t                       data;
+#if (NGX_HTTP_UPSTREAM_ZONE)
+    ngx_uint_t                      config;
+#endif
 } ngx_http_upstream_rr_peer_data_t;
 
 
+#if (NGX_HTTP_UPSTREAM_ZONE)
+
+ngx_http_upstream_rr_peer_t *ngx_http_upstream_zone_copy_peer(
+    ngx_http_upstream_rr_peers_t *peers, ngx_http_upstream_rr_peer_t *src);
+
+
+static ngx_inline void
+ngx_http_upstream_rr_peer_free_locked(ngx_http_upstream_rr_peers_t *peers,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+    if (peer->conns || peer->refs) {
+        peer->zombie = 1;
+        return;
+    }
+
+    ngx_slab_free_locked(peers->shpool, peer->sockaddr);
+    ngx_slab_free_locked(peers->shpool, peer->name.data);
+
+    if (peer->server.data) {
+        ngx_slab_free_locked(peers->shpool, peer->server.data);
+    }
+
+#if (NGX_HTTP_SSL)
+    if (peer->ssl_session) {
+        ngx_slab_free_locked(peers->shpool, peer->ssl_session);
+    }
+#endif
+
+    ngx_slab_free_locked(peers->shpool, peer);
+}
+
+
+static ngx_inline void
+ngx_http_upstream_rr_peer_free(ngx_http_upstream_rr_peers_t *peers,
+    ngx_http_upstream_rr_peer_t *peer)
+{
+    ngx_shmtx_lock(&peers->shpool->mutex);
+    ngx_http_upstream_rr_peer_free_locked(peers, peer);
+    ngx_shmtx_unlock(&peers->shpool->mutex);
+}
+
+#endif
+
+
 ngx_int_t ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
     ngx_http_upstream_srv_conf_t *us);
 ngx_int_t ngx_http_upstream_init_round_robin_peer(ngx_http_request_t *r,
@@ -135,6 +207,8 @@ ngx_int_t ngx_http_upstream_get_round_robin_peer(ngx_peer_connection_t *pc,
     void *data);
 void ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc,
     void *data, ngx_uint_t state);
+void ngx_http_upstream_rr_set_current(ngx_http_upstream_rr_peer_data_t *rrp,
+    ngx_http_upstream_rr_peer_t *peer);
 
 #if (NGX_HTTP_SSL)
 ngx_int_t
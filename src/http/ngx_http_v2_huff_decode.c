@@ -0,0 +1,1903 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/*
+ * The decoder walks the static Huffman code of RFC 7541, Appendix B,
+ * four bits at a time.  A state is an internal node of the code tree
+ * (the root is state 0); every entry holds the state reached after
+ * the nibble, whether a symbol was emitted on the way, the symbol
+ * itself, and whether the bits consumed since the last symbol form
+ * valid padding.  A transition that completes EOS is encoded as
+ * {0, 0, 0, 0}, which cannot occur otherwise.
+ */
+
+typedef struct {
+    u_char  next;
+    u_char  emit;
+    u_char  sym;
+    u_char  ending;
+} ngx_http_v2_huff_decode_code_t;
+
+
+static ngx_inline ngx_int_t ngx_http_v2_huff_decode_bits(u_char *state,
+    u_char *ending, ngx_uint_t bits, u_char **dst);
+
+
+static ngx_http_v2_huff_decode_code_t  ngx_http_v2_huff_decode_codes[256][16] =
+{
+    /* 0 */
+    {
+        {87, 0, 0, 0}, {88, 0, 0, 0}, {131, 0, 0, 0}, {135, 0, 0, 0},
+        {143, 0, 0, 0}, {69, 0, 0, 0}, {83, 0, 0, 0}, {90, 0, 0, 0},
+        {100, 0, 0, 0}, {132, 0, 0, 0}, {138, 0, 0, 0}, {95, 0, 0, 0},
+        {105, 0, 0, 0}, {112, 0, 0, 0}, {119, 0, 0, 0}, {4, 0, 0, 1}
+    },
+    /* 1 */
+    {
+        {101, 0, 0, 0}, {129, 0, 0, 0}, {133, 0, 0, 0}, {134, 0, 0, 0},
+        {139, 0, 0, 0}, {140, 0, 0, 0}, {142, 0, 0, 0}, {96, 0, 0, 0},
+        {106, 0, 0, 0}, {109, 0, 0, 0}, {113, 0, 0, 0}, {116, 0, 0, 0},
+        {120, 0, 0, 0}, {136, 0, 0, 0}, {144, 0, 0, 0}, {5, 0, 0, 1}
+    },
+    /* 2 */
+    {
+        {107, 0, 0, 0}, {108, 0, 0, 0}, {110, 0, 0, 0}, {111, 0, 0, 0},
+        {114, 0, 0, 0}, {115, 0, 0, 0}, {117, 0, 0, 0}, {118, 0, 0, 0},
+        {121, 0, 0, 0}, {122, 0, 0, 0}, {137, 0, 0, 0}, {141, 0, 0, 0},
+        {145, 0, 0, 0}, {146, 0, 0, 0}, {75, 0, 0, 0}, {6, 0, 0, 1}
+    },
+    /* 3 */
+    {
+        {0, 1, 85, 1}, {0, 1, 86, 1}, {0, 1, 87, 1}, {0, 1, 89, 1},
+        {0, 1, 106, 1}, {0, 1, 107, 1}, {0, 1, 113, 1}, {0, 1, 118, 1},
+        {0, 1, 119, 1}, {0, 1, 120, 1}, {0, 1, 121, 1}, {0, 1, 122, 1},
+        {76, 0, 0, 0}, {80, 0, 0, 0}, {123, 0, 0, 0}, {7, 0, 0, 1}
+    },
+    /* 4 */
+    {
+        {66, 1, 119, 0}, {1, 1, 119, 1}, {66, 1, 120, 0}, {1, 1, 120, 1},
+        {66, 1, 121, 0}, {1, 1, 121, 1}, {66, 1, 122, 0}, {1, 1, 122, 1},
+        {0, 1, 38, 1}, {0, 1, 42, 1}, {0, 1, 44, 1}, {0, 1, 59, 1},
+        {0, 1, 88, 1}, {0, 1, 90, 1}, {71, 0, 0, 0}, {8, 0, 0, 0}
+    },
+    /* 5 */
+    {
+        {66, 1, 38, 0}, {1, 1, 38, 1}, {66, 1, 42, 0}, {1, 1, 42, 1},
+        {66, 1, 44, 0}, {1, 1, 44, 1}, {66, 1, 59, 0}, {1, 1, 59, 1},
+        {66, 1, 88, 0}, {1, 1, 88, 1}, {66, 1, 90, 0}, {1, 1, 90, 1},
+        {72, 0, 0, 0}, {79, 0, 0, 0}, {77, 0, 0, 0}, {9, 0, 0, 0}
+    },
+    /* 6 */
+    {
+        {85, 1, 88, 0}, {67, 1, 88, 0}, {93, 1, 88, 0}, {2, 1, 88, 1},
+        {85, 1, 90, 0}, {67, 1, 90, 0}, {93, 1, 90, 0}, {2, 1, 90, 1},
+        {0, 1, 33, 1}, {0, 1, 34, 1}, {0, 1, 40, 1}, {0, 1, 41, 1},
+        {0, 1, 63, 1}, {78, 0, 0, 0}, {73, 0, 0, 0}, {10, 0, 0, 0}
+    },
+    /* 7 */
+    {
+        {66, 1, 33, 0}, {1, 1, 33, 1}, {66, 1, 34, 0}, {1, 1, 34, 1},
+        {66, 1, 40, 0}, {1, 1, 40, 1}, {66, 1, 41, 0}, {1, 1, 41, 1},
+        {66, 1, 63, 0}, {1, 1, 63, 1}, {0, 1, 39, 1}, {0, 1, 43, 1},
+        {0, 1, 124, 1}, {74, 0, 0, 0}, {11, 0, 0, 0}, {13, 0, 0, 0}
+    },
+    /* 8 */
+    {
+        {85, 1, 63, 0}, {67, 1, 63, 0}, {93, 1, 63, 0}, {2, 1, 63, 1},
+        {66, 1, 39, 0}, {1, 1, 39, 1}, {66, 1, 43, 0}, {1, 1, 43, 1},
+        {66, 1, 124, 0}, {1, 1, 124, 1}, {0, 1, 35, 1}, {0, 1, 62, 1},
+        {12, 0, 0, 0}, {102, 0, 0, 0}, {127, 0, 0, 0}, {14, 0, 0, 0}
+    },
+    /* 9 */
+    {
+        {85, 1, 124, 0}, {67, 1, 124, 0}, {93, 1, 124, 0}, {2, 1, 124, 1},
+        {66, 1, 35, 0}, {1, 1, 35, 1}, {66, 1, 62, 0}, {1, 1, 62, 1},
+        {0, 1, 0, 1}, {0, 1, 36, 1}, {0, 1, 64, 1}, {0, 1, 91, 1},
+        {0, 1, 93, 1}, {0, 1, 126, 1}, {128, 0, 0, 0}, {15, 0, 0, 0}
+    },
+    /* 10 */
+    {
+        {66, 1, 0, 0}, {1, 1, 0, 1}, {66, 1, 36, 0}, {1, 1, 36, 1},
+        {66, 1, 64, 0}, {1, 1, 64, 1}, {66, 1, 91, 0}, {1, 1, 91, 1},
+        {66, 1, 93, 0}, {1, 1, 93, 1}, {66, 1, 126, 0}, {1, 1, 126, 1},
+        {0, 1, 94, 1}, {0, 1, 125, 1}, {98, 0, 0, 0}, {16, 0, 0, 0}
+    },
+    /* 11 */
+    {
+        {85, 1, 0, 0}, {67, 1, 0, 0}, {93, 1, 0, 0}, {2, 1, 0, 1},
+        {85, 1, 36, 0}, {67, 1, 36, 0}, {93, 1, 36, 0}, {2, 1, 36, 1},
+        {85, 1, 64, 0}, {67, 1, 64, 0}, {93, 1, 64, 0}, {2, 1, 64, 1},
+        {85, 1, 91, 0}, {67, 1, 91, 0}, {93, 1, 91, 0}, {2, 1, 91, 1}
+    },
+    /* 12 */
+    {
+        {86, 1, 0, 0}, {130, 1, 0, 0}, {68, 1, 0, 0}, {82, 1, 0, 0},
+        {99, 1, 0, 0}, {94, 1, 0, 0}, {104, 1, 0, 0}, {3, 1, 0, 1},
+        {86, 1, 36, 0}, {130, 1, 36, 0}, {68, 1, 36, 0}, {82, 1, 36, 0},
+        {99, 1, 36, 0}, {94, 1, 36, 0}, {104, 1, 36, 0}, {3, 1, 36, 1}
+    },
+    /* 13 */
+    {
+        {85, 1, 93, 0}, {67, 1, 93, 0}, {93, 1, 93, 0}, {2, 1, 93, 1},
+        {85, 1, 126, 0}, {67, 1, 126, 0}, {93, 1, 126, 0}, {2, 1, 126, 1},
+        {66, 1, 94, 0}, {1, 1, 94, 1}, {66, 1, 125, 0}, {1, 1, 125, 1},
+        {0, 1, 60, 1}, {0, 1, 96, 1}, {0, 1, 123, 1}, {17, 0, 0, 0}
+    },
+    /* 14 */
+    {
+        {85, 1, 94, 0}, {67, 1, 94, 0}, {93, 1, 94, 0}, {2, 1, 94, 1},
+        {85, 1, 125, 0}, {67, 1, 125, 0}, {93, 1, 125, 0}, {2, 1, 125, 1},
+        {66, 1, 60, 0}, {1, 1, 60, 1}, {66, 1, 96, 0}, {1, 1, 96, 1},
+        {66, 1, 123, 0}, {1, 1, 123, 1}, {124, 0, 0, 0}, {18, 0, 0, 0}
+    },
+    /* 15 */
+    {
+        {85, 1, 60, 0}, {67, 1, 60, 0}, {93, 1, 60, 0}, {2, 1, 60, 1},
+        {85, 1, 96, 0}, {67, 1, 96, 0}, {93, 1, 96, 0}, {2, 1, 96, 1},
+        {85, 1, 123, 0}, {67, 1, 123, 0}, {93, 1, 123, 0}, {2, 1, 123, 1},
+        {125, 0, 0, 0}, {155, 0, 0, 0}, {150, 0, 0, 0}, {19, 0, 0, 0}
+    },
+    /* 16 */
+    {
+        {86, 1, 123, 0}, {130, 1, 123, 0}, {68, 1, 123, 0}, {82, 1, 123, 0},
+        {99, 1, 123, 0}, {94, 1, 123, 0}, {104, 1, 123, 0}, {3, 1, 123, 1},
+        {126, 0, 0, 0}, {148, 0, 0, 0}, {156, 0, 0, 0}, {175, 0, 0, 0},
+        {196, 0, 0, 0}, {151, 0, 0, 0}, {20, 0, 0, 0}, {25, 0, 0, 0}
+    },
+    /* 17 */
+    {
+        {0, 1, 92, 1}, {0, 1, 195, 1}, {0, 1, 208, 1}, {149, 0, 0, 0},
+        {157, 0, 0, 0}, {204, 0, 0, 0}, {241, 0, 0, 0}, {176, 0, 0, 0},
+        {197, 0, 0, 0}, {235, 0, 0, 0}, {152, 0, 0, 0}, {178, 0, 0, 0},
+        {199, 0, 0, 0}, {21, 0, 0, 0}, {167, 0, 0, 0}, {26, 0, 0, 0}
+    },
+    /* 18 */
+    {
+        {198, 0, 0, 0}, {202, 0, 0, 0}, {236, 0, 0, 0}, {242, 0, 0, 0},
+        {153, 0, 0, 0}, {158, 0, 0, 0}, {179, 0, 0, 0}, {183, 0, 0, 0},
+        {200, 0, 0, 0}, {206, 0, 0, 0}, {216, 0, 0, 0}, {22, 0, 0, 0},
+        {168, 0, 0, 0}, {185, 0, 0, 0}, {41, 0, 0, 0}, {27, 0, 0, 0}
+    },
+    /* 19 */
+    {
+        {201, 0, 0, 0}, {205, 0, 0, 0}, {207, 0, 0, 0}, {210, 0, 0, 0},
+        {217, 0, 0, 0}, {243, 0, 0, 0}, {23, 0, 0, 0}, {162, 0, 0, 0},
+        {169, 0, 0, 0}, {173, 0, 0, 0}, {186, 0, 0, 0}, {194, 0, 0, 0},
+        {208, 0, 0, 0}, {42, 0, 0, 0}, {191, 0, 0, 0}, {28, 0, 0, 0}
+    },
+    /* 20 */
+    {
+        {0, 1, 178, 1}, {0, 1, 181, 1}, {0, 1, 185, 1}, {0, 1, 186, 1},
+        {0, 1, 187, 1}, {0, 1, 189, 1}, {0, 1, 190, 1}, {0, 1, 196, 1},
+        {0, 1, 198, 1}, {0, 1, 228, 1}, {0, 1, 232, 1}, {0, 1, 233, 1},
+        {24, 0, 0, 0}, {161, 0, 0, 0}, {163, 0, 0, 0}, {164, 0, 0, 0}
+    },
+    /* 21 */
+    {
+        {66, 1, 198, 0}, {1, 1, 198, 1}, {66, 1, 228, 0}, {1, 1, 228, 1},
+        {66, 1, 232, 0}, {1, 1, 232, 1}, {66, 1, 233, 0}, {1, 1, 233, 1},
+        {0, 1, 1, 1}, {0, 1, 135, 1}, {0, 1, 137, 1}, {0, 1, 138, 1},
+        {0, 1, 139, 1}, {0, 1, 140, 1}, {0, 1, 141, 1}, {0, 1, 143, 1}
+    },
+    /* 22 */
+    {
+        {66, 1, 1, 0}, {1, 1, 1, 1}, {66, 1, 135, 0}, {1, 1, 135, 1},
+        {66, 1, 137, 0}, {1, 1, 137, 1}, {66, 1, 138, 0}, {1, 1, 138, 1},
+        {66, 1, 139, 0}, {1, 1, 139, 1}, {66, 1, 140, 0}, {1, 1, 140, 1},
+        {66, 1, 141, 0}, {1, 1, 141, 1}, {66, 1, 143, 0}, {1, 1, 143, 1}
+    },
+    /* 23 */
+    {
+        {85, 1, 1, 0}, {67, 1, 1, 0}, {93, 1, 1, 0}, {2, 1, 1, 1},
+        {85, 1, 135, 0}, {67, 1, 135, 0}, {93, 1, 135, 0}, {2, 1, 135, 1},
+        {85, 1, 137, 0}, {67, 1, 137, 0}, {93, 1, 137, 0}, {2, 1, 137, 1},
+        {85, 1, 138, 0}, {67, 1, 138, 0}, {93, 1, 138, 0}, {2, 1, 138, 1}
+    },
+    /* 24 */
+    {
+        {86, 1, 1, 0}, {130, 1, 1, 0}, {68, 1, 1, 0}, {82, 1, 1, 0},
+        {99, 1, 1, 0}, {94, 1, 1, 0}, {104, 1, 1, 0}, {3, 1, 1, 1},
+        {86, 1, 135, 0}, {130, 1, 135, 0}, {68, 1, 135, 0}, {82, 1, 135, 0},
+        {99, 1, 135, 0}, {94, 1, 135, 0}, {104, 1, 135, 0}, {3, 1, 135, 1}
+    },
+    /* 25 */
+    {
+        {170, 0, 0, 0}, {172, 0, 0, 0}, {174, 0, 0, 0}, {181, 0, 0, 0},
+        {187, 0, 0, 0}, {189, 0, 0, 0}, {195, 0, 0, 0}, {203, 0, 0, 0},
+        {209, 0, 0, 0}, {215, 0, 0, 0}, {43, 0, 0, 0}, {165, 0, 0, 0},
+        {192, 0, 0, 0}, {218, 0, 0, 0}, {211, 0, 0, 0}, {29, 0, 0, 0}
+    },
+    /* 26 */
+    {
+        {0, 1, 188, 1}, {0, 1, 191, 1}, {0, 1, 197, 1}, {0, 1, 231, 1},
+        {0, 1, 239, 1}, {44, 0, 0, 0}, {166, 0, 0, 0}, {171, 0, 0, 0},
+        {193, 0, 0, 0}, {234, 0, 0, 0}, {245, 0, 0, 0}, {219, 0, 0, 0},
+        {212, 0, 0, 0}, {224, 0, 0, 0}, {229, 0, 0, 0}, {30, 0, 0, 0}
+    },
+    /* 27 */
+    {
+        {0, 1, 171, 1}, {0, 1, 206, 1}, {0, 1, 215, 1}, {0, 1, 225, 1},
+        {0, 1, 236, 1}, {0, 1, 237, 1}, {220, 0, 0, 0}, {244, 0, 0, 0},
+        {213, 0, 0, 0}, {222, 0, 0, 0}, {237, 0, 0, 0}, {225, 0, 0, 0},
+        {230, 0, 0, 0}, {249, 0, 0, 0}, {31, 0, 0, 0}, {45, 0, 0, 0}
+    },
+    /* 28 */
+    {
+        {214, 0, 0, 0}, {221, 0, 0, 0}, {223, 0, 0, 0}, {228, 0, 0, 0},
+        {238, 0, 0, 0}, {246, 0, 0, 0}, {248, 0, 0, 0}, {226, 0, 0, 0},
+        {231, 0, 0, 0}, {239, 0, 0, 0}, {250, 0, 0, 0}, {253, 0, 0, 0},
+        {32, 0, 0, 0}, {38, 0, 0, 0}, {55, 0, 0, 0}, {46, 0, 0, 0}
+    },
+    /* 29 */
+    {
+        {232, 0, 0, 0}, {233, 0, 0, 0}, {240, 0, 0, 0}, {247, 0, 0, 0},
+        {251, 0, 0, 0}, {252, 0, 0, 0}, {254, 0, 0, 0}, {255, 0, 0, 0},
+        {33, 0, 0, 0}, {35, 0, 0, 0}, {39, 0, 0, 0}, {52, 0, 0, 0},
+        {56, 0, 0, 0}, {60, 0, 0, 0}, {63, 0, 0, 0}, {47, 0, 0, 0}
+    },
+    /* 30 */
+    {
+        {0, 1, 254, 1}, {34, 0, 0, 0}, {36, 0, 0, 0}, {37, 0, 0, 0},
+        {40, 0, 0, 0}, {51, 0, 0, 0}, {53, 0, 0, 0}, {54, 0, 0, 0},
+        {57, 0, 0, 0}, {58, 0, 0, 0}, {61, 0, 0, 0}, {62, 0, 0, 0},
+        {64, 0, 0, 0}, {65, 0, 0, 0}, {147, 0, 0, 0}, {48, 0, 0, 0}
+    },
+    /* 31 */
+    {
+        {66, 1, 254, 0}, {1, 1, 254, 1}, {0, 1, 2, 1}, {0, 1, 3, 1},
+        {0, 1, 4, 1}, {0, 1, 5, 1}, {0, 1, 6, 1}, {0, 1, 7, 1},
+        {0, 1, 8, 1}, {0, 1, 11, 1}, {0, 1, 12, 1}, {0, 1, 14, 1},
+        {0, 1, 15, 1}, {0, 1, 16, 1}, {0, 1, 17, 1}, {0, 1, 18, 1}
+    },
+    /* 32 */
+    {
+        {85, 1, 254, 0}, {67, 1, 254, 0}, {93, 1, 254, 0}, {2, 1, 254, 1},
+        {66, 1, 2, 0}, {1, 1, 2, 1}, {66, 1, 3, 0}, {1, 1, 3, 1},
+        {66, 1, 4, 0}, {1, 1, 4, 1}, {66, 1, 5, 0}, {1, 1, 5, 1},
+        {66, 1, 6, 0}, {1, 1, 6, 1}, {66, 1, 7, 0}, {1, 1, 7, 1}
+    },
+    /* 33 */
+    {
+        {86, 1, 254, 0}, {130, 1, 254, 0}, {68, 1, 254, 0}, {82, 1, 254, 0},
+        {99, 1, 254, 0}, {94, 1, 254, 0}, {104, 1, 254, 0}, {3, 1, 254, 1},
+        {85, 1, 2, 0}, {67, 1, 2, 0}, {93, 1, 2, 0}, {2, 1, 2, 1},
+        {85, 1, 3, 0}, {67, 1, 3, 0}, {93, 1, 3, 0}, {2, 1, 3, 1}
+    },
+    /* 34 */
+    {
+        {86, 1, 2, 0}, {130, 1, 2, 0}, {68, 1, 2, 0}, {82, 1, 2, 0},
+        {99, 1, 2, 0}, {94, 1, 2, 0}, {104, 1, 2, 0}, {3, 1, 2, 1},
+        {86, 1, 3, 0}, {130, 1, 3, 0}, {68, 1, 3, 0}, {82, 1, 3, 0},
+        {99, 1, 3, 0}, {94, 1, 3, 0}, {104, 1, 3, 0}, {3, 1, 3, 1}
+    },
+    /* 35 */
+    {
+        {85, 1, 4, 0}, {67, 1, 4, 0}, {93, 1, 4, 0}, {2, 1, 4, 1},
+        {85, 1, 5, 0}, {67, 1, 5, 0}, {93, 1, 5, 0}, {2, 1, 5, 1},
+        {85, 1, 6, 0}, {67, 1, 6, 0}, {93, 1, 6, 0}, {2, 1, 6, 1},
+        {85, 1, 7, 0}, {67, 1, 7, 0}, {93, 1, 7, 0}, {2, 1, 7, 1}
+    },
+    /* 36 */
+    {
+        {86, 1, 4, 0}, {130, 1, 4, 0}, {68, 1, 4, 0}, {82, 1, 4, 0},
+        {99, 1, 4, 0}, {94, 1, 4, 0}, {104, 1, 4, 0}, {3, 1, 4, 1},
+        {86, 1, 5, 0}, {130, 1, 5, 0}, {68, 1, 5, 0}, {82, 1, 5, 0},
+        {99, 1, 5, 0}, {94, 1, 5, 0}, {104, 1, 5, 0}, {3, 1, 5, 1}
+    },
+    /* 37 */
+    {
+        {86, 1, 6, 0}, {130, 1, 6, 0}, {68, 1, 6, 0}, {82, 1, 6, 0},
+        {99, 1, 6, 0}, {94, 1, 6, 0}, {104, 1, 6, 0}, {3, 1, 6, 1},
+        {86, 1, 7, 0}, {130, 1, 7, 0}, {68, 1, 7, 0}, {82, 1, 7, 0},
+        {99, 1, 7, 0}, {94, 1, 7, 0}, {104, 1, 7, 0}, {3, 1, 7, 1}
+    },
+    /* 38 */
+    {
+        {66, 1, 8, 0}, {1, 1, 8, 1}, {66, 1, 11, 0}, {1, 1, 11, 1},
+        {66, 1, 12, 0}, {1, 1, 12, 1}, {66, 1, 14, 0}, {1, 1, 14, 1},
+        {66, 1, 15, 0}, {1, 1, 15, 1}, {66, 1, 16, 0}, {1, 1, 16, 1},
+        {66, 1, 17, 0}, {1, 1, 17, 1}, {66, 1, 18, 0}, {1, 1, 18, 1}
+    },
+    /* 39 */
+    {
+        {85, 1, 8, 0}, {67, 1, 8, 0}, {93, 1, 8, 0}, {2, 1, 8, 1},
+        {85, 1, 11, 0}, {67, 1, 11, 0}, {93, 1, 11, 0}, {2, 1, 11, 1},
+        {85, 1, 12, 0}, {67, 1, 12, 0}, {93, 1, 12, 0}, {2, 1, 12, 1},
+        {85, 1, 14, 0}, {67, 1, 14, 0}, {93, 1, 14, 0}, {2, 1, 14, 1}
+    },
+    /* 40 */
+    {
+        {86, 1, 8, 0}, {130, 1, 8, 0}, {68, 1, 8, 0}, {82, 1, 8, 0},
+        {99, 1, 8, 0}, {94, 1, 8, 0}, {104, 1, 8, 0}, {3, 1, 8, 1},
+        {86, 1, 11, 0}, {130, 1, 11, 0}, {68, 1, 11, 0}, {82, 1, 11, 0},
+        {99, 1, 11, 0}, {94, 1, 11, 0}, {104, 1, 11, 0}, {3, 1, 11, 1}
+    },
+    /* 41 */
+    {
+        {66, 1, 188, 0}, {1, 1, 188, 1}, {66, 1, 191, 0}, {1, 1, 191, 1},
+        {66, 1, 197, 0}, {1, 1, 197, 1}, {66, 1, 231, 0}, {1, 1, 231, 1},
+        {66, 1, 239, 0}, {1, 1, 239, 1}, {0, 1, 9, 1}, {0, 1, 142, 1},
+        {0, 1, 144, 1}, {0, 1, 145, 1}, {0, 1, 148, 1}, {0, 1, 159, 1}
+    },
+    /* 42 */
+    {
+        {85, 1, 239, 0}, {67, 1, 239, 0}, {93, 1, 239, 0}, {2, 1, 239, 1},
+        {66, 1, 9, 0}, {1, 1, 9, 1}, {66, 1, 142, 0}, {1, 1, 142, 1},
+        {66, 1, 144, 0}, {1, 1, 144, 1}, {66, 1, 145, 0}, {1, 1, 145, 1},
+        {66, 1, 148, 0}, {1, 1, 148, 1}, {66, 1, 159, 0}, {1, 1, 159, 1}
+    },
+    /* 43 */
+    {
+        {86, 1, 239, 0}, {130, 1, 239, 0}, {68, 1, 239, 0}, {82, 1, 239, 0},
+        {99, 1, 239, 0}, {94, 1, 239, 0}, {104, 1, 239, 0}, {3, 1, 239, 1},
+        {85, 1, 9, 0}, {67, 1, 9, 0}, {93, 1, 9, 0}, {2, 1, 9, 1},
+        {85, 1, 142, 0}, {67, 1, 142, 0}, {93, 1, 142, 0}, {2, 1, 142, 1}
+    },
+    /* 44 */
+    {
+        {86, 1, 9, 0}, {130, 1, 9, 0}, {68, 1, 9, 0}, {82, 1, 9, 0},
+        {99, 1, 9, 0}, {94, 1, 9, 0}, {104, 1, 9, 0}, {3, 1, 9, 1},
+        {86, 1, 142, 0}, {130, 1, 142, 0}, {68, 1, 142, 0}, {82, 1, 142, 0},
+        {99, 1, 142, 0}, {94, 1, 142, 0}, {104, 1, 142, 0}, {3, 1, 142, 1}
+    },
+    /* 45 */
+    {
+        {0, 1, 19, 1}, {0, 1, 20, 1}, {0, 1, 21, 1}, {0, 1, 23, 1},
+        {0, 1, 24, 1}, {0, 1, 25, 1}, {0, 1, 26, 1}, {0, 1, 27, 1},
+        {0, 1, 28, 1}, {0, 1, 29, 1}, {0, 1, 30, 1}, {0, 1, 31, 1},
+        {0, 1, 127, 1}, {0, 1, 220, 1}, {0, 1, 249, 1}, {49, 0, 0, 0}
+    },
+    /* 46 */
+    {
+        {66, 1, 28, 0}, {1, 1, 28, 1}, {66, 1, 29, 0}, {1, 1, 29, 1},
+        {66, 1, 30, 0}, {1, 1, 30, 1}, {66, 1, 31, 0}, {1, 1, 31, 1},
+        {66, 1, 127, 0}, {1, 1, 127, 1}, {66, 1, 220, 0}, {1, 1, 220, 1},
+        {66, 1, 249, 0}, {1, 1, 249, 1}, {50, 0, 0, 0}, {59, 0, 0, 0}
+    },
+    /* 47 */
+    {
+        {85, 1, 127, 0}, {67, 1, 127, 0}, {93, 1, 127, 0}, {2, 1, 127, 1},
+        {85, 1, 220, 0}, {67, 1, 220, 0}, {93, 1, 220, 0}, {2, 1, 220, 1},
+        {85, 1, 249, 0}, {67, 1, 249, 0}, {93, 1, 249, 0}, {2, 1, 249, 1},
+        {0, 1, 10, 1}, {0, 1, 13, 1}, {0, 1, 22, 1}, {0, 0, 0, 0}
+    },
+    /* 48 */
+    {
+        {86, 1, 249, 0}, {130, 1, 249, 0}, {68, 1, 249, 0}, {82, 1, 249, 0},
+        {99, 1, 249, 0}, {94, 1, 249, 0}, {104, 1, 249, 0}, {3, 1, 249, 1},
+        {66, 1, 10, 0}, {1, 1, 10, 1}, {66, 1, 13, 0}, {1, 1, 13, 1},
+        {66, 1, 22, 0}, {1, 1, 22, 1}, {0, 0, 0, 0}, {0, 0, 0, 0}
+    },
+    /* 49 */
+    {
+        {85, 1, 10, 0}, {67, 1, 10, 0}, {93, 1, 10, 0}, {2, 1, 10, 1},
+        {85, 1, 13, 0}, {67, 1, 13, 0}, {93, 1, 13, 0}, {2, 1, 13, 1},
+        {85, 1, 22, 0}, {67, 1, 22, 0}, {93, 1, 22, 0}, {2, 1, 22, 1},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}
+    },
+    /* 50 */
+    {
+        {86, 1, 10, 0}, {130, 1, 10, 0}, {68, 1, 10, 0}, {82, 1, 10, 0},
+        {99, 1, 10, 0}, {94, 1, 10, 0}, {104, 1, 10, 0}, {3, 1, 10, 1},
+        {86, 1, 13, 0}, {130, 1, 13, 0}, {68, 1, 13, 0}, {82, 1, 13, 0},
+        {99, 1, 13, 0}, {94, 1, 13, 0}, {104, 1, 13, 0}, {3, 1, 13, 1}
+    },
+    /* 51 */
+    {
+        {86, 1, 12, 0}, {130, 1, 12, 0}, {68, 1, 12, 0}, {82, 1, 12, 0},
+        {99, 1, 12, 0}, {94, 1, 12, 0}, {104, 1, 12, 0}, {3, 1, 12, 1},
+        {86, 1, 14, 0}, {130, 1, 14, 0}, {68, 1, 14, 0}, {82, 1, 14, 0},
+        {99, 1, 14, 0}, {94, 1, 14, 0}, {104, 1, 14, 0}, {3, 1, 14, 1}
+    },
+    /* 52 */
+    {
+        {85, 1, 15, 0}, {67, 1, 15, 0}, {93, 1, 15, 0}, {2, 1, 15, 1},
+        {85, 1, 16, 0}, {67, 1, 16, 0}, {93, 1, 16, 0}, {2, 1, 16, 1},
+        {85, 1, 17, 0}, {67, 1, 17, 0}, {93, 1, 17, 0}, {2, 1, 17, 1},
+        {85, 1, 18, 0}, {67, 1, 18, 0}, {93, 1, 18, 0}, {2, 1, 18, 1}
+    },
+    /* 53 */
+    {
+        {86, 1, 15, 0}, {130, 1, 15, 0}, {68, 1, 15, 0}, {82, 1, 15, 0},
+        {99, 1, 15, 0}, {94, 1, 15, 0}, {104, 1, 15, 0}, {3, 1, 15, 1},
+        {86, 1, 16, 0}, {130, 1, 16, 0}, {68, 1, 16, 0}, {82, 1, 16, 0},
+        {99, 1, 16, 0}, {94, 1, 16, 0}, {104, 1, 16, 0}, {3, 1, 16, 1}
+    },
+    /* 54 */
+    {
+        {86, 1, 17, 0}, {130, 1, 17, 0}, {68, 1, 17, 0}, {82, 1, 17, 0},
+        {99, 1, 17, 0}, {94, 1, 17, 0}, {104, 1, 17, 0}, {3, 1, 17, 1},
+        {86, 1, 18, 0}, {130, 1, 18, 0}, {68, 1, 18, 0}, {82, 1, 18, 0},
+        {99, 1, 18, 0}, {94, 1, 18, 0}, {104, 1, 18, 0}, {3, 1, 18, 1}
+    },
+    /* 55 */
+    {
+        {66, 1, 19, 0}, {1, 1, 19, 1}, {66, 1, 20, 0}, {1, 1, 20, 1},
+        {66, 1, 21, 0}, {1, 1, 21, 1}, {66, 1, 23, 0}, {1, 1, 23, 1},
+        {66, 1, 24, 0}, {1, 1, 24, 1}, {66, 1, 25, 0}, {1, 1, 25, 1},
+        {66, 1, 26, 0}, {1, 1, 26, 1}, {66, 1, 27, 0}, {1, 1, 27, 1}
+    },
+    /* 56 */
+    {
+        {85, 1, 19, 0}, {67, 1, 19, 0}, {93, 1, 19, 0}, {2, 1, 19, 1},
+        {85, 1, 20, 0}, {67, 1, 20, 0}, {93, 1, 20, 0}, {2, 1, 20, 1},
+        {85, 1, 21, 0}, {67, 1, 21, 0}, {93, 1, 21, 0}, {2, 1, 21, 1},
+        {85, 1, 23, 0}, {67, 1, 23, 0}, {93, 1, 23, 0}, {2, 1, 23, 1}
+    },
+    /* 57 */
+    {
+        {86, 1, 19, 0}, {130, 1, 19, 0}, {68, 1, 19, 0}, {82, 1, 19, 0},
+        {99, 1, 19, 0}, {94, 1, 19, 0}, {104, 1, 19, 0}, {3, 1, 19, 1},
+        {86, 1, 20, 0}, {130, 1, 20, 0}, {68, 1, 20, 0}, {82, 1, 20, 0},
+        {99, 1, 20, 0}, {94, 1, 20, 0}, {104, 1, 20, 0}, {3, 1, 20, 1}
+    },
+    /* 58 */
+    {
+        {86, 1, 21, 0}, {130, 1, 21, 0}, {68, 1, 21, 0}, {82, 1, 21, 0},
+        {99, 1, 21, 0}, {94, 1, 21, 0}, {104, 1, 21, 0}, {3, 1, 21, 1},
+        {86, 1, 23, 0}, {130, 1, 23, 0}, {68, 1, 23, 0}, {82, 1, 23, 0},
+        {99, 1, 23, 0}, {94, 1, 23, 0}, {104, 1, 23, 0}, {3, 1, 23, 1}
+    },
+    /* 59 */
+    {
+        {86, 1, 22, 0}, {130, 1, 22, 0}, {68, 1, 22, 0}, {82, 1, 22, 0},
+        {99, 1, 22, 0}, {94, 1, 22, 0}, {104, 1, 22, 0}, {3, 1, 22, 1},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}
+    },
+    /* 60 */
+    {
+        {85, 1, 24, 0}, {67, 1, 24, 0}, {93, 1, 24, 0}, {2, 1, 24, 1},
+        {85, 1, 25, 0}, {67, 1, 25, 0}, {93, 1, 25, 0}, {2, 1, 25, 1},
+        {85, 1, 26, 0}, {67, 1, 26, 0}, {93, 1, 26, 0}, {2, 1, 26, 1},
+        {85, 1, 27, 0}, {67, 1, 27, 0}, {93, 1, 27, 0}, {2, 1, 27, 1}
+    },
+    /* 61 */
+    {
+        {86, 1, 24, 0}, {130, 1, 24, 0}, {68, 1, 24, 0}, {82, 1, 24, 0},
+        {99, 1, 24, 0}, {94, 1, 24, 0}, {104, 1, 24, 0}, {3, 1, 24, 1},
+        {86, 1, 25, 0}, {130, 1, 25, 0}, {68, 1, 25, 0}, {82, 1, 25, 0},
+        {99, 1, 25, 0}, {94, 1, 25, 0}, {104, 1, 25, 0}, {3, 1, 25, 1}
+    },
+    /* 62 */
+    {
+        {86, 1, 26, 0}, {130, 1, 26, 0}, {68, 1, 26, 0}, {82, 1, 26, 0},
+        {99, 1, 26, 0}, {94, 1, 26, 0}, {104, 1, 26, 0}, {3, 1, 26, 1},
+        {86, 1, 27, 0}, {130, 1, 27, 0}, {68, 1, 27, 0}, {82, 1, 27, 0},
+        {99, 1, 27, 0}, {94, 1, 27, 0}, {104, 1, 27, 0}, {3, 1, 27, 1}
+    },
+    /* 63 */
+    {
+        {85, 1, 28, 0}, {67, 1, 28, 0}, {93, 1, 28, 0}, {2, 1, 28, 1},
+        {85, 1, 29, 0}, {67, 1, 29, 0}, {93, 1, 29, 0}, {2, 1, 29, 1},
+        {85, 1, 30, 0}, {67, 1, 30, 0}, {93, 1, 30, 0}, {2, 1, 30, 1},
+        {85, 1, 31, 0}, {67, 1, 31, 0}, {93, 1, 31, 0}, {2, 1, 31, 1}
+    },
+    /* 64 */
+    {
+        {86, 1, 28, 0}, {130, 1, 28, 0}, {68, 1, 28, 0}, {82, 1, 28, 0},
+        {99, 1, 28, 0}, {94, 1, 28, 0}, {104, 1, 28, 0}, {3, 1, 28, 1},
+        {86, 1, 29, 0}, {130, 1, 29, 0}, {68, 1, 29, 0}, {82, 1, 29, 0},
+        {99, 1, 29, 0}, {94, 1, 29, 0}, {104, 1, 29, 0}, {3, 1, 29, 1}
+    },
+    /* 65 */
+    {
+        {86, 1, 30, 0}, {130, 1, 30, 0}, {68, 1, 30, 0}, {82, 1, 30, 0},
+        {99, 1, 30, 0}, {94, 1, 30, 0}, {104, 1, 30, 0}, {3, 1, 30, 1},
+        {86, 1, 31, 0}, {130, 1, 31, 0}, {68, 1, 31, 0}, {82, 1, 31, 0},
+        {99, 1, 31, 0}, {94, 1, 31, 0}, {104, 1, 31, 0}, {3, 1, 31, 1}
+    },
+    /* 66 */
+    {
+        {0, 1, 48, 1}, {0, 1, 49, 1}, {0, 1, 50, 1}, {0, 1, 97, 1},
+        {0, 1, 99, 1}, {0, 1, 101, 1}, {0, 1, 105, 1}, {0, 1, 111, 1},
+        {0, 1, 115, 1}, {0, 1, 116, 1}, {70, 0, 0, 0}, {81, 0, 0, 0},
+        {84, 0, 0, 0}, {89, 0, 0, 0}, {91, 0, 0, 0}, {92, 0, 0, 0}
+    },
+    /* 67 */
+    {
+        {66, 1, 115, 0}, {1, 1, 115, 1}, {66, 1, 116, 0}, {1, 1, 116, 1},
+        {0, 1, 32, 1}, {0, 1, 37, 1}, {0, 1, 45, 1}, {0, 1, 46, 1},
+        {0, 1, 47, 1}, {0, 1, 51, 1}, {0, 1, 52, 1}, {0, 1, 53, 1},
+        {0, 1, 54, 1}, {0, 1, 55, 1}, {0, 1, 56, 1}, {0, 1, 57, 1}
+    },
+    /* 68 */
+    {
+        {85, 1, 115, 0}, {67, 1, 115, 0}, {93, 1, 115, 0}, {2, 1, 115, 1},
+        {85, 1, 116, 0}, {67, 1, 116, 0}, {93, 1, 116, 0}, {2, 1, 116, 1},
+        {66, 1, 32, 0}, {1, 1, 32, 1}, {66, 1, 37, 0}, {1, 1, 37, 1},
+        {66, 1, 45, 0}, {1, 1, 45, 1}, {66, 1, 46, 0}, {1, 1, 46, 1}
+    },
+    /* 69 */
+    {
+        {85, 1, 32, 0}, {67, 1, 32, 0}, {93, 1, 32, 0}, {2, 1, 32, 1},
+        {85, 1, 37, 0}, {67, 1, 37, 0}, {93, 1, 37, 0}, {2, 1, 37, 1},
+        {85, 1, 45, 0}, {67, 1, 45, 0}, {93, 1, 45, 0}, {2, 1, 45, 1},
+        {85, 1, 46, 0}, {67, 1, 46, 0}, {93, 1, 46, 0}, {2, 1, 46, 1}
+    },
+    /* 70 */
+    {
+        {86, 1, 32, 0}, {130, 1, 32, 0}, {68, 1, 32, 0}, {82, 1, 32, 0},
+        {99, 1, 32, 0}, {94, 1, 32, 0}, {104, 1, 32, 0}, {3, 1, 32, 1},
+        {86, 1, 37, 0}, {130, 1, 37, 0}, {68, 1, 37, 0}, {82, 1, 37, 0},
+        {99, 1, 37, 0}, {94, 1, 37, 0}, {104, 1, 37, 0}, {3, 1, 37, 1}
+    },
+    /* 71 */
+    {
+        {85, 1, 33, 0}, {67, 1, 33, 0}, {93, 1, 33, 0}, {2, 1, 33, 1},
+        {85, 1, 34, 0}, {67, 1, 34, 0}, {93, 1, 34, 0}, {2, 1, 34, 1},
+        {85, 1, 40, 0}, {67, 1, 40, 0}, {93, 1, 40, 0}, {2, 1, 40, 1},
+        {85, 1, 41, 0}, {67, 1, 41, 0}, {93, 1, 41, 0}, {2, 1, 41, 1}
+    },
+    /* 72 */
+    {
+        {86, 1, 33, 0}, {130, 1, 33, 0}, {68, 1, 33, 0}, {82, 1, 33, 0},
+        {99, 1, 33, 0}, {94, 1, 33, 0}, {104, 1, 33, 0}, {3, 1, 33, 1},
+        {86, 1, 34, 0}, {130, 1, 34, 0}, {68, 1, 34, 0}, {82, 1, 34, 0},
+        {99, 1, 34, 0}, {94, 1, 34, 0}, {104, 1, 34, 0}, {3, 1, 34, 1}
+    },
+    /* 73 */
+    {
+        {86, 1, 124, 0}, {130, 1, 124, 0}, {68, 1, 124, 0}, {82, 1, 124, 0},
+        {99, 1, 124, 0}, {94, 1, 124, 0}, {104, 1, 124, 0}, {3, 1, 124, 1},
+        {85, 1, 35, 0}, {67, 1, 35, 0}, {93, 1, 35, 0}, {2, 1, 35, 1},
+        {85, 1, 62, 0}, {67, 1, 62, 0}, {93, 1, 62, 0}, {2, 1, 62, 1}
+    },
+    /* 74 */
+    {
+        {86, 1, 35, 0}, {130, 1, 35, 0}, {68, 1, 35, 0}, {82, 1, 35, 0},
+        {99, 1, 35, 0}, {94, 1, 35, 0}, {104, 1, 35, 0}, {3, 1, 35, 1},
+        {86, 1, 62, 0}, {130, 1, 62, 0}, {68, 1, 62, 0}, {82, 1, 62, 0},
+        {99, 1, 62, 0}, {94, 1, 62, 0}, {104, 1, 62, 0}, {3, 1, 62, 1}
+    },
+    /* 75 */
+    {
+        {85, 1, 38, 0}, {67, 1, 38, 0}, {93, 1, 38, 0}, {2, 1, 38, 1},
+        {85, 1, 42, 0}, {67, 1, 42, 0}, {93, 1, 42, 0}, {2, 1, 42, 1},
+        {85, 1, 44, 0}, {67, 1, 44, 0}, {93, 1, 44, 0}, {2, 1, 44, 1},
+        {85, 1, 59, 0}, {67, 1, 59, 0}, {93, 1, 59, 0}, {2, 1, 59, 1}
+    },
+    /* 76 */
+    {
+        {86, 1, 38, 0}, {130, 1, 38, 0}, {68, 1, 38, 0}, {82, 1, 38, 0},
+        {99, 1, 38, 0}, {94, 1, 38, 0}, {104, 1, 38, 0}, {3, 1, 38, 1},
+        {86, 1, 42, 0}, {130, 1, 42, 0}, {68, 1, 42, 0}, {82, 1, 42, 0},
+        {99, 1, 42, 0}, {94, 1, 42, 0}, {104, 1, 42, 0}, {3, 1, 42, 1}
+    },
+    /* 77 */
+    {
+        {86, 1, 63, 0}, {130, 1, 63, 0}, {68, 1, 63, 0}, {82, 1, 63, 0},
+        {99, 1, 63, 0}, {94, 1, 63, 0}, {104, 1, 63, 0}, {3, 1, 63, 1},
+        {85, 1, 39, 0}, {67, 1, 39, 0}, {93, 1, 39, 0}, {2, 1, 39, 1},
+        {85, 1, 43, 0}, {67, 1, 43, 0}, {93, 1, 43, 0}, {2, 1, 43, 1}
+    },
+    /* 78 */
+    {
+        {86, 1, 39, 0}, {130, 1, 39, 0}, {68, 1, 39, 0}, {82, 1, 39, 0},
+        {99, 1, 39, 0}, {94, 1, 39, 0}, {104, 1, 39, 0}, {3, 1, 39, 1},
+        {86, 1, 43, 0}, {130, 1, 43, 0}, {68, 1, 43, 0}, {82, 1, 43, 0},
+        {99, 1, 43, 0}, {94, 1, 43, 0}, {104, 1, 43, 0}, {3, 1, 43, 1}
+    },
+    /* 79 */
+    {
+        {86, 1, 40, 0}, {130, 1, 40, 0}, {68, 1, 40, 0}, {82, 1, 40, 0},
+        {99, 1, 40, 0}, {94, 1, 40, 0}, {104, 1, 40, 0}, {3, 1, 40, 1},
+        {86, 1, 41, 0}, {130, 1, 41, 0}, {68, 1, 41, 0}, {82, 1, 41, 0},
+        {99, 1, 41, 0}, {94, 1, 41, 0}, {104, 1, 41, 0}, {3, 1, 41, 1}
+    },
+    /* 80 */
+    {
+        {86, 1, 44, 0}, {130, 1, 44, 0}, {68, 1, 44, 0}, {82, 1, 44, 0},
+        {99, 1, 44, 0}, {94, 1, 44, 0}, {104, 1, 44, 0}, {3, 1, 44, 1},
+        {86, 1, 59, 0}, {130, 1, 59, 0}, {68, 1, 59, 0}, {82, 1, 59, 0},
+        {99, 1, 59, 0}, {94, 1, 59, 0}, {104, 1, 59, 0}, {3, 1, 59, 1}
+    },
+    /* 81 */
+    {
+        {86, 1, 45, 0}, {130, 1, 45, 0}, {68, 1, 45, 0}, {82, 1, 45, 0},
+        {99, 1, 45, 0}, {94, 1, 45, 0}, {104, 1, 45, 0}, {3, 1, 45, 1},
+        {86, 1, 46, 0}, {130, 1, 46, 0}, {68, 1, 46, 0}, {82, 1, 46, 0},
+        {99, 1, 46, 0}, {94, 1, 46, 0}, {104, 1, 46, 0}, {3, 1, 46, 1}
+    },
+    /* 82 */
+    {
+        {66, 1, 47, 0}, {1, 1, 47, 1}, {66, 1, 51, 0}, {1, 1, 51, 1},
+        {66, 1, 52, 0}, {1, 1, 52, 1}, {66, 1, 53, 0}, {1, 1, 53, 1},
+        {66, 1, 54, 0}, {1, 1, 54, 1}, {66, 1, 55, 0}, {1, 1, 55, 1},
+        {66, 1, 56, 0}, {1, 1, 56, 1}, {66, 1, 57, 0}, {1, 1, 57, 1}
+    },
+    /* 83 */
+    {
+        {85, 1, 47, 0}, {67, 1, 47, 0}, {93, 1, 47, 0}, {2, 1, 47, 1},
+        {85, 1, 51, 0}, {67, 1, 51, 0}, {93, 1, 51, 0}, {2, 1, 51, 1},
+        {85, 1, 52, 0}, {67, 1, 52, 0}, {93, 1, 52, 0}, {2, 1, 52, 1},
+        {85, 1, 53, 0}, {67, 1, 53, 0}, {93, 1, 53, 0}, {2, 1, 53, 1}
+    },
+    /* 84 */
+    {
+        {86, 1, 47, 0}, {130, 1, 47, 0}, {68, 1, 47, 0}, {82, 1, 47, 0},
+        {99, 1, 47, 0}, {94, 1, 47, 0}, {104, 1, 47, 0}, {3, 1, 47, 1},
+        {86, 1, 51, 0}, {130, 1, 51, 0}, {68, 1, 51, 0}, {82, 1, 51, 0},
+        {99, 1, 51, 0}, {94, 1, 51, 0}, {104, 1, 51, 0}, {3, 1, 51, 1}
+    },
+    /* 85 */
+    {
+        {66, 1, 48, 0}, {1, 1, 48, 1}, {66, 1, 49, 0}, {1, 1, 49, 1},
+        {66, 1, 50, 0}, {1, 1, 50, 1}, {66, 1, 97, 0}, {1, 1, 97, 1},
+        {66, 1, 99, 0}, {1, 1, 99, 1}, {66, 1, 101, 0}, {1, 1, 101, 1},
+        {66, 1, 105, 0}, {1, 1, 105, 1}, {66, 1, 111, 0}, {1, 1, 111, 1}
+    },
+    /* 86 */
+    {
+        {85, 1, 48, 0}, {67, 1, 48, 0}, {93, 1, 48, 0}, {2, 1, 48, 1},
+        {85, 1, 49, 0}, {67, 1, 49, 0}, {93, 1, 49, 0}, {2, 1, 49, 1},
+        {85, 1, 50, 0}, {67, 1, 50, 0}, {93, 1, 50, 0}, {2, 1, 50, 1},
+        {85, 1, 97, 0}, {67, 1, 97, 0}, {93, 1, 97, 0}, {2, 1, 97, 1}
+    },
+    /* 87 */
+    {
+        {86, 1, 48, 0}, {130, 1, 48, 0}, {68, 1, 48, 0}, {82, 1, 48, 0},
+        {99, 1, 48, 0}, {94, 1, 48, 0}, {104, 1, 48, 0}, {3, 1, 48, 1},
+        {86, 1, 49, 0}, {130, 1, 49, 0}, {68, 1, 49, 0}, {82, 1, 49, 0},
+        {99, 1, 49, 0}, {94, 1, 49, 0}, {104, 1, 49, 0}, {3, 1, 49, 1}
+    },
+    /* 88 */
+    {
+        {86, 1, 50, 0}, {130, 1, 50, 0}, {68, 1, 50, 0}, {82, 1, 50, 0},
+        {99, 1, 50, 0}, {94, 1, 50, 0}, {104, 1, 50, 0}, {3, 1, 50, 1},
+        {86, 1, 97, 0}, {130, 1, 97, 0}, {68, 1, 97, 0}, {82, 1, 97, 0},
+        {99, 1, 97, 0}, {94, 1, 97, 0}, {104, 1, 97, 0}, {3, 1, 97, 1}
+    },
+    /* 89 */
+    {
+        {86, 1, 52, 0}, {130, 1, 52, 0}, {68, 1, 52, 0}, {82, 1, 52, 0},
+        {99, 1, 52, 0}, {94, 1, 52, 0}, {104, 1, 52, 0}, {3, 1, 52, 1},
+        {86, 1, 53, 0}, {130, 1, 53, 0}, {68, 1, 53, 0}, {82, 1, 53, 0},
+        {99, 1, 53, 0}, {94, 1, 53, 0}, {104, 1, 53, 0}, {3, 1, 53, 1}
+    },
+    /* 90 */
+    {
+        {85, 1, 54, 0}, {67, 1, 54, 0}, {93, 1, 54, 0}, {2, 1, 54, 1},
+        {85, 1, 55, 0}, {67, 1, 55, 0}, {93, 1, 55, 0}, {2, 1, 55, 1},
+        {85, 1, 56, 0}, {67, 1, 56, 0}, {93, 1, 56, 0}, {2, 1, 56, 1},
+        {85, 1, 57, 0}, {67, 1, 57, 0}, {93, 1, 57, 0}, {2, 1, 57, 1}
+    },
+    /* 91 */
+    {
+        {86, 1, 54, 0}, {130, 1, 54, 0}, {68, 1, 54, 0}, {82, 1, 54, 0},
+        {99, 1, 54, 0}, {94, 1, 54, 0}, {104, 1, 54, 0}, {3, 1, 54, 1},
+        {86, 1, 55, 0}, {130, 1, 55, 0}, {68, 1, 55, 0}, {82, 1, 55, 0},
+        {99, 1, 55, 0}, {94, 1, 55, 0}, {104, 1, 55, 0}, {3, 1, 55, 1}
+    },
+    /* 92 */
+    {
+        {86, 1, 56, 0}, {130, 1, 56, 0}, {68, 1, 56, 0}, {82, 1, 56, 0},
+        {99, 1, 56, 0}, {94, 1, 56, 0}, {104, 1, 56, 0}, {3, 1, 56, 1},
+        {86, 1, 57, 0}, {130, 1, 57, 0}, {68, 1, 57, 0}, {82, 1, 57, 0},
+        {99, 1, 57, 0}, {94, 1, 57, 0}, {104, 1, 57, 0}, {3, 1, 57, 1}
+    },
+    /* 93 */
+    {
+        {0, 1, 61, 1}, {0, 1, 65, 1}, {0, 1, 95, 1}, {0, 1, 98, 1},
+        {0, 1, 100, 1}, {0, 1, 102, 1}, {0, 1, 103, 1}, {0, 1, 104, 1},
+        {0, 1, 108, 1}, {0, 1, 109, 1}, {0, 1, 110, 1}, {0, 1, 112, 1},
+        {0, 1, 114, 1}, {0, 1, 117, 1}, {97, 0, 0, 0}, {103, 0, 0, 0}
+    },
+    /* 94 */
+    {
+        {66, 1, 108, 0}, {1, 1, 108, 1}, {66, 1, 109, 0}, {1, 1, 109, 1},
+        {66, 1, 110, 0}, {1, 1, 110, 1}, {66, 1, 112, 0}, {1, 1, 112, 1},
+        {66, 1, 114, 0}, {1, 1, 114, 1}, {66, 1, 117, 0}, {1, 1, 117, 1},
+        {0, 1, 58, 1}, {0, 1, 66, 1}, {0, 1, 67, 1}, {0, 1, 68, 1}
+    },
+    /* 95 */
+    {
+        {85, 1, 114, 0}, {67, 1, 114, 0}, {93, 1, 114, 0}, {2, 1, 114, 1},
+        {85, 1, 117, 0}, {67, 1, 117, 0}, {93, 1, 117, 0}, {2, 1, 117, 1},
+        {66, 1, 58, 0}, {1, 1, 58, 1}, {66, 1, 66, 0}, {1, 1, 66, 1},
+        {66, 1, 67, 0}, {1, 1, 67, 1}, {66, 1, 68, 0}, {1, 1, 68, 1}
+    },
+    /* 96 */
+    {
+        {85, 1, 58, 0}, {67, 1, 58, 0}, {93, 1, 58, 0}, {2, 1, 58, 1},
+        {85, 1, 66, 0}, {67, 1, 66, 0}, {93, 1, 66, 0}, {2, 1, 66, 1},
+        {85, 1, 67, 0}, {67, 1, 67, 0}, {93, 1, 67, 0}, {2, 1, 67, 1},
+        {85, 1, 68, 0}, {67, 1, 68, 0}, {93, 1, 68, 0}, {2, 1, 68, 1}
+    },
+    /* 97 */
+    {
+        {86, 1, 58, 0}, {130, 1, 58, 0}, {68, 1, 58, 0}, {82, 1, 58, 0},
+        {99, 1, 58, 0}, {94, 1, 58, 0}, {104, 1, 58, 0}, {3, 1, 58, 1},
+        {86, 1, 66, 0}, {130, 1, 66, 0}, {68, 1, 66, 0}, {82, 1, 66, 0},
+        {99, 1, 66, 0}, {94, 1, 66, 0}, {104, 1, 66, 0}, {3, 1, 66, 1}
+    },
+    /* 98 */
+    {
+        {86, 1, 60, 0}, {130, 1, 60, 0}, {68, 1, 60, 0}, {82, 1, 60, 0},
+        {99, 1, 60, 0}, {94, 1, 60, 0}, {104, 1, 60, 0}, {3, 1, 60, 1},
+        {86, 1, 96, 0}, {130, 1, 96, 0}, {68, 1, 96, 0}, {82, 1, 96, 0},
+        {99, 1, 96, 0}, {94, 1, 96, 0}, {104, 1, 96, 0}, {3, 1, 96, 1}
+    },
+    /* 99 */
+    {
+        {66, 1, 61, 0}, {1, 1, 61, 1}, {66, 1, 65, 0}, {1, 1, 65, 1},
+        {66, 1, 95, 0}, {1, 1, 95, 1}, {66, 1, 98, 0}, {1, 1, 98, 1},
+        {66, 1, 100, 0}, {1, 1, 100, 1}, {66, 1, 102, 0}, {1, 1, 102, 1},
+        {66, 1, 103, 0}, {1, 1, 103, 1}, {66, 1, 104, 0}, {1, 1, 104, 1}
+    },
+    /* 100 */
+    {
+        {85, 1, 61, 0}, {67, 1, 61, 0}, {93, 1, 61, 0}, {2, 1, 61, 1},
+        {85, 1, 65, 0}, {67, 1, 65, 0}, {93, 1, 65, 0}, {2, 1, 65, 1},
+        {85, 1, 95, 0}, {67, 1, 95, 0}, {93, 1, 95, 0}, {2, 1, 95, 1},
+        {85, 1, 98, 0}, {67, 1, 98, 0}, {93, 1, 98, 0}, {2, 1, 98, 1}
+    },
+    /* 101 */
+    {
+        {86, 1, 61, 0}, {130, 1, 61, 0}, {68, 1, 61, 0}, {82, 1, 61, 0},
+        {99, 1, 61, 0}, {94, 1, 61, 0}, {104, 1, 61, 0}, {3, 1, 61, 1},
+        {86, 1, 65, 0}, {130, 1, 65, 0}, {68, 1, 65, 0}, {82, 1, 65, 0},
+        {99, 1, 65, 0}, {94, 1, 65, 0}, {104, 1, 65, 0}, {3, 1, 65, 1}
+    },
+    /* 102 */
+    {
+        {86, 1, 64, 0}, {130, 1, 64, 0}, {68, 1, 64, 0}, {82, 1, 64, 0},
+        {99, 1, 64, 0}, {94, 1, 64, 0}, {104, 1, 64, 0}, {3, 1, 64, 1},
+        {86, 1, 91, 0}, {130, 1, 91, 0}, {68, 1, 91, 0}, {82, 1, 91, 0},
+        {99, 1, 91, 0}, {94, 1, 91, 0}, {104, 1, 91, 0}, {3, 1, 91, 1}
+    },
+    /* 103 */
+    {
+        {86, 1, 67, 0}, {130, 1, 67, 0}, {68, 1, 67, 0}, {82, 1, 67, 0},
+        {99, 1, 67, 0}, {94, 1, 67, 0}, {104, 1, 67, 0}, {3, 1, 67, 1},
+        {86, 1, 68, 0}, {130, 1, 68, 0}, {68, 1, 68, 0}, {82, 1, 68, 0},
+        {99, 1, 68, 0}, {94, 1, 68, 0}, {104, 1, 68, 0}, {3, 1, 68, 1}
+    },
+    /* 104 */
+    {
+        {0, 1, 69, 1}, {0, 1, 70, 1}, {0, 1, 71, 1}, {0, 1, 72, 1},
+        {0, 1, 73, 1}, {0, 1, 74, 1}, {0, 1, 75, 1}, {0, 1, 76, 1},
+        {0, 1, 77, 1}, {0, 1, 78, 1}, {0, 1, 79, 1}, {0, 1, 80, 1},
+        {0, 1, 81, 1}, {0, 1, 82, 1}, {0, 1, 83, 1}, {0, 1, 84, 1}
+    },
+    /* 105 */
+    {
+        {66, 1, 69, 0}, {1, 1, 69, 1}, {66, 1, 70, 0}, {1, 1, 70, 1},
+        {66, 1, 71, 0}, {1, 1, 71, 1}, {66, 1, 72, 0}, {1, 1, 72, 1},
+        {66, 1, 73, 0}, {1, 1, 73, 1}, {66, 1, 74, 0}, {1, 1, 74, 1},
+        {66, 1, 75, 0}, {1, 1, 75, 1}, {66, 1, 76, 0}, {1, 1, 76, 1}
+    },
+    /* 106 */
+    {
+        {85, 1, 69, 0}, {67, 1, 69, 0}, {93, 1, 69, 0}, {2, 1, 69, 1},
+        {85, 1, 70, 0}, {67, 1, 70, 0}, {93, 1, 70, 0}, {2, 1, 70, 1},
+        {85, 1, 71, 0}, {67, 1, 71, 0}, {93, 1, 71, 0}, {2, 1, 71, 1},
+        {85, 1, 72, 0}, {67, 1, 72, 0}, {93, 1, 72, 0}, {2, 1, 72, 1}
+    },
+    /* 107 */
+    {
+        {86, 1, 69, 0}, {130, 1, 69, 0}, {68, 1, 69, 0}, {82, 1, 69, 0},
+        {99, 1, 69, 0}, {94, 1, 69, 0}, {104, 1, 69, 0}, {3, 1, 69, 1},
+        {86, 1, 70, 0}, {130, 1, 70, 0}, {68, 1, 70, 0}, {82, 1, 70, 0},
+        {99, 1, 70, 0}, {94, 1, 70, 0}, {104, 1, 70, 0}, {3, 1, 70, 1}
+    },
+    /* 108 */
+    {
+        {86, 1, 71, 0}, {130, 1, 71, 0}, {68, 1, 71, 0}, {82, 1, 71, 0},
+        {99, 1, 71, 0}, {94, 1, 71, 0}, {104, 1, 71, 0}, {3, 1, 71, 1},
+        {86, 1, 72, 0}, {130, 1, 72, 0}, {68, 1, 72, 0}, {82, 1, 72, 0},
+        {99, 1, 72, 0}, {94, 1, 72, 0}, {104, 1, 72, 0}, {3, 1, 72, 1}
+    },
+    /* 109 */
+    {
+        {85, 1, 73, 0}, {67, 1, 73, 0}, {93, 1, 73, 0}, {2, 1, 73, 1},
+        {85, 1, 74, 0}, {67, 1, 74, 0}, {93, 1, 74, 0}, {2, 1, 74, 1},
+        {85, 1, 75, 0}, {67, 1, 75, 0}, {93, 1, 75, 0}, {2, 1, 75, 1},
+        {85, 1, 76, 0}, {67, 1, 76, 0}, {93, 1, 76, 0}, {2, 1, 76, 1}
+    },
+    /* 110 */
+    {
+        {86, 1, 73, 0}, {130, 1, 73, 0}, {68, 1, 73, 0}, {82, 1, 73, 0},
+        {99, 1, 73, 0}, {94, 1, 73, 0}, {104, 1, 73, 0}, {3, 1, 73, 1},
+        {86, 1, 74, 0}, {130, 1, 74, 0}, {68, 1, 74, 0}, {82, 1, 74, 0},
+        {99, 1, 74, 0}, {94, 1, 74, 0}, {104, 1, 74, 0}, {3, 1, 74, 1}
+    },
+    /* 111 */
+    {
+        {86, 1, 75, 0}, {130, 1, 75, 0}, {68, 1, 75, 0}, {82, 1, 75, 0},
+        {99, 1, 75, 0}, {94, 1, 75, 0}, {104, 1, 75, 0}, {3, 1, 75, 1},
+        {86, 1, 76, 0}, {130, 1, 76, 0}, {68, 1, 76, 0}, {82, 1, 76, 0},
+        {99, 1, 76, 0}, {94, 1, 76, 0}, {104, 1, 76, 0}, {3, 1, 76, 1}
+    },
+    /* 112 */
+    {
+        {66, 1, 77, 0}, {1, 1, 77, 1}, {66, 1, 78, 0}, {1, 1, 78, 1},
+        {66, 1, 79, 0}, {1, 1, 79, 1}, {66, 1, 80, 0}, {1, 1, 80, 1},
+        {66, 1, 81, 0}, {1, 1, 81, 1}, {66, 1, 82, 0}, {1, 1, 82, 1},
+        {66, 1, 83, 0}, {1, 1, 83, 1}, {66, 1, 84, 0}, {1, 1, 84, 1}
+    },
+    /* 113 */
+    {
+        {85, 1, 77, 0}, {67, 1, 77, 0}, {93, 1, 77, 0}, {2, 1, 77, 1},
+        {85, 1, 78, 0}, {67, 1, 78, 0}, {93, 1, 78, 0}, {2, 1, 78, 1},
+        {85, 1, 79, 0}, {67, 1, 79, 0}, {93, 1, 79, 0}, {2, 1, 79, 1},
+        {85, 1, 80, 0}, {67, 1, 80, 0}, {93, 1, 80, 0}, {2, 1, 80, 1}
+    },
+    /* 114 */
+    {
+        {86, 1, 77, 0}, {130, 1, 77, 0}, {68, 1, 77, 0}, {82, 1, 77, 0},
+        {99, 1, 77, 0}, {94, 1, 77, 0}, {104, 1, 77, 0}, {3, 1, 77, 1},
+        {86, 1, 78, 0}, {130, 1, 78, 0}, {68, 1, 78, 0}, {82, 1, 78, 0},
+        {99, 1, 78, 0}, {94, 1, 78, 0}, {104, 1, 78, 0}, {3, 1, 78, 1}
+    },
+    /* 115 */
+    {
+        {86, 1, 79, 0}, {130, 1, 79, 0}, {68, 1, 79, 0}, {82, 1, 79, 0},
+        {99, 1, 79, 0}, {94, 1, 79, 0}, {104, 1, 79, 0}, {3, 1, 79, 1},
+        {86, 1, 80, 0}, {130, 1, 80, 0}, {68, 1, 80, 0}, {82, 1, 80, 0},
+        {99, 1, 80, 0}, {94, 1, 80, 0}, {104, 1, 80, 0}, {3, 1, 80, 1}
+    },
+    /* 116 */
+    {
+        {85, 1, 81, 0}, {67, 1, 81, 0}, {93, 1, 81, 0}, {2, 1, 81, 1},
+        {85, 1, 82, 0}, {67, 1, 82, 0}, {93, 1, 82, 0}, {2, 1, 82, 1},
+        {85, 1, 83, 0}, {67, 1, 83, 0}, {93, 1, 83, 0}, {2, 1, 83, 1},
+        {85, 1, 84, 0}, {67, 1, 84, 0}, {93, 1, 84, 0}, {2, 1, 84, 1}
+    },
+    /* 117 */
+    {
+        {86, 1, 81, 0}, {130, 1, 81, 0}, {68, 1, 81, 0}, {82, 1, 81, 0},
+        {99, 1, 81, 0}, {94, 1, 81, 0}, {104, 1, 81, 0}, {3, 1, 81, 1},
+        {86, 1, 82, 0}, {130, 1, 82, 0}, {68, 1, 82, 0}, {82, 1, 82, 0},
+        {99, 1, 82, 0}, {94, 1, 82, 0}, {104, 1, 82, 0}, {3, 1, 82, 1}
+    },
+    /* 118 */
+    {
+        {86, 1, 83, 0}, {130, 1, 83, 0}, {68, 1, 83, 0}, {82, 1, 83, 0},
+        {99, 1, 83, 0}, {94, 1, 83, 0}, {104, 1, 83, 0}, {3, 1, 83, 1},
+        {86, 1, 84, 0}, {130, 1, 84, 0}, {68, 1, 84, 0}, {82, 1, 84, 0},
+        {99, 1, 84, 0}, {94, 1, 84, 0}, {104, 1, 84, 0}, {3, 1, 84, 1}
+    },
+    /* 119 */
+    {
+        {66, 1, 85, 0}, {1, 1, 85, 1}, {66, 1, 86, 0}, {1, 1, 86, 1},
+        {66, 1, 87, 0}, {1, 1, 87, 1}, {66, 1, 89, 0}, {1, 1, 89, 1},
+        {66, 1, 106, 0}, {1, 1, 106, 1}, {66, 1, 107, 0}, {1, 1, 107, 1},
+        {66, 1, 113, 0}, {1, 1, 113, 1}, {66, 1, 118, 0}, {1, 1, 118, 1}
+    },
+    /* 120 */
+    {
+        {85, 1, 85, 0}, {67, 1, 85, 0}, {93, 1, 85, 0}, {2, 1, 85, 1},
+        {85, 1, 86, 0}, {67, 1, 86, 0}, {93, 1, 86, 0}, {2, 1, 86, 1},
+        {85, 1, 87, 0}, {67, 1, 87, 0}, {93, 1, 87, 0}, {2, 1, 87, 1},
+        {85, 1, 89, 0}, {67, 1, 89, 0}, {93, 1, 89, 0}, {2, 1, 89, 1}
+    },
+    /* 121 */
+    {
+        {86, 1, 85, 0}, {130, 1, 85, 0}, {68, 1, 85, 0}, {82, 1, 85, 0},
+        {99, 1, 85, 0}, {94, 1, 85, 0}, {104, 1, 85, 0}, {3, 1, 85, 1},
+        {86, 1, 86, 0}, {130, 1, 86, 0}, {68, 1, 86, 0}, {82, 1, 86, 0},
+        {99, 1, 86, 0}, {94, 1, 86, 0}, {104, 1, 86, 0}, {3, 1, 86, 1}
+    },
+    /* 122 */
+    {
+        {86, 1, 87, 0}, {130, 1, 87, 0}, {68, 1, 87, 0}, {82, 1, 87, 0},
+        {99, 1, 87, 0}, {94, 1, 87, 0}, {104, 1, 87, 0}, {3, 1, 87, 1},
+        {86, 1, 89, 0}, {130, 1, 89, 0}, {68, 1, 89, 0}, {82, 1, 89, 0},
+        {99, 1, 89, 0}, {94, 1, 89, 0}, {104, 1, 89, 0}, {3, 1, 89, 1}
+    },
+    /* 123 */
+    {
+        {86, 1, 88, 0}, {130, 1, 88, 0}, {68, 1, 88, 0}, {82, 1, 88, 0},
+        {99, 1, 88, 0}, {94, 1, 88, 0}, {104, 1, 88, 0}, {3, 1, 88, 1},
+        {86, 1, 90, 0}, {130, 1, 90, 0}, {68, 1, 90, 0}, {82, 1, 90, 0},
+        {99, 1, 90, 0}, {94, 1, 90, 0}, {104, 1, 90, 0}, {3, 1, 90, 1}
+    },
+    /* 124 */
+    {
+        {66, 1, 92, 0}, {1, 1, 92, 1}, {66, 1, 195, 0}, {1, 1, 195, 1},
+        {66, 1, 208, 0}, {1, 1, 208, 1}, {0, 1, 128, 1}, {0, 1, 130, 1},
+        {0, 1, 131, 1}, {0, 1, 162, 1}, {0, 1, 184, 1}, {0, 1, 194, 1},
+        {0, 1, 224, 1}, {0, 1, 226, 1}, {177, 0, 0, 0}, {188, 0, 0, 0}
+    },
+    /* 125 */
+    {
+        {85, 1, 92, 0}, {67, 1, 92, 0}, {93, 1, 92, 0}, {2, 1, 92, 1},
+        {85, 1, 195, 0}, {67, 1, 195, 0}, {93, 1, 195, 0}, {2, 1, 195, 1},
+        {85, 1, 208, 0}, {67, 1, 208, 0}, {93, 1, 208, 0}, {2, 1, 208, 1},
+        {66, 1, 128, 0}, {1, 1, 128, 1}, {66, 1, 130, 0}, {1, 1, 130, 1}
+    },
+    /* 126 */
+    {
+        {86, 1, 92, 0}, {130, 1, 92, 0}, {68, 1, 92, 0}, {82, 1, 92, 0},
+        {99, 1, 92, 0}, {94, 1, 92, 0}, {104, 1, 92, 0}, {3, 1, 92, 1},
+        {86, 1, 195, 0}, {130, 1, 195, 0}, {68, 1, 195, 0}, {82, 1, 195, 0},
+        {99, 1, 195, 0}, {94, 1, 195, 0}, {104, 1, 195, 0}, {3, 1, 195, 1}
+    },
+    /* 127 */
+    {
+        {86, 1, 93, 0}, {130, 1, 93, 0}, {68, 1, 93, 0}, {82, 1, 93, 0},
+        {99, 1, 93, 0}, {94, 1, 93, 0}, {104, 1, 93, 0}, {3, 1, 93, 1},
+        {86, 1, 126, 0}, {130, 1, 126, 0}, {68, 1, 126, 0}, {82, 1, 126, 0},
+        {99, 1, 126, 0}, {94, 1, 126, 0}, {104, 1, 126, 0}, {3, 1, 126, 1}
+    },
+    /* 128 */
+    {
+        {86, 1, 94, 0}, {130, 1, 94, 0}, {68, 1, 94, 0}, {82, 1, 94, 0},
+        {99, 1, 94, 0}, {94, 1, 94, 0}, {104, 1, 94, 0}, {3, 1, 94, 1},
+        {86, 1, 125, 0}, {130, 1, 125, 0}, {68, 1, 125, 0}, {82, 1, 125, 0},
+        {99, 1, 125, 0}, {94, 1, 125, 0}, {104, 1, 125, 0}, {3, 1, 125, 1}
+    },
+    /* 129 */
+    {
+        {86, 1, 95, 0}, {130, 1, 95, 0}, {68, 1, 95, 0}, {82, 1, 95, 0},
+        {99, 1, 95, 0}, {94, 1, 95, 0}, {104, 1, 95, 0}, {3, 1, 95, 1},
+        {86, 1, 98, 0}, {130, 1, 98, 0}, {68, 1, 98, 0}, {82, 1, 98, 0},
+        {99, 1, 98, 0}, {94, 1, 98, 0}, {104, 1, 98, 0}, {3, 1, 98, 1}
+    },
+    /* 130 */
+    {
+        {85, 1, 99, 0}, {67, 1, 99, 0}, {93, 1, 99, 0}, {2, 1, 99, 1},
+        {85, 1, 101, 0}, {67, 1, 101, 0}, {93, 1, 101, 0}, {2, 1, 101, 1},
+        {85, 1, 105, 0}, {67, 1, 105, 0}, {93, 1, 105, 0}, {2, 1, 105, 1},
+        {85, 1, 111, 0}, {67, 1, 111, 0}, {93, 1, 111, 0}, {2, 1, 111, 1}
+    },
+    /* 131 */
+    {
+        {86, 1, 99, 0}, {130, 1, 99, 0}, {68, 1, 99, 0}, {82, 1, 99, 0},
+        {99, 1, 99, 0}, {94, 1, 99, 0}, {104, 1, 99, 0}, {3, 1, 99, 1},
+        {86, 1, 101, 0}, {130, 1, 101, 0}, {68, 1, 101, 0}, {82, 1, 101, 0},
+        {99, 1, 101, 0}, {94, 1, 101, 0}, {104, 1, 101, 0}, {3, 1, 101, 1}
+    },
+    /* 132 */
+    {
+        {85, 1, 100, 0}, {67, 1, 100, 0}, {93, 1, 100, 0}, {2, 1, 100, 1},
+        {85, 1, 102, 0}, {67, 1, 102, 0}, {93, 1, 102, 0}, {2, 1, 102, 1},
+        {85, 1, 103, 0}, {67, 1, 103, 0}, {93, 1, 103, 0}, {2, 1, 103, 1},
+        {85, 1, 104, 0}, {67, 1, 104, 0}, {93, 1, 104, 0}, {2, 1, 104, 1}
+    },
+    /* 133 */
+    {
+        {86, 1, 100, 0}, {130, 1, 100, 0}, {68, 1, 100, 0}, {82, 1, 100, 0},
+        {99, 1, 100, 0}, {94, 1, 100, 0}, {104, 1, 100, 0}, {3, 1, 100, 1},
+        {86, 1, 102, 0}, {130, 1, 102, 0}, {68, 1, 102, 0}, {82, 1, 102, 0},
+        {99, 1, 102, 0}, {94, 1, 102, 0}, {104, 1, 102, 0}, {3, 1, 102, 1}
+    },
+    /* 134 */
+    {
+        {86, 1, 103, 0}, {130, 1, 103, 0}, {68, 1, 103, 0}, {82, 1, 103, 0},
+        {99, 1, 103, 0}, {94, 1, 103, 0}, {104, 1, 103, 0}, {3, 1, 103, 1},
+        {86, 1, 104, 0}, {130, 1, 104, 0}, {68, 1, 104, 0}, {82, 1, 104, 0},
+        {99, 1, 104, 0}, {94, 1, 104, 0}, {104, 1, 104, 0}, {3, 1, 104, 1}
+    },
+    /* 135 */
+    {
+        {86, 1, 105, 0}, {130, 1, 105, 0}, {68, 1, 105, 0}, {82, 1, 105, 0},
+        {99, 1, 105, 0}, {94, 1, 105, 0}, {104, 1, 105, 0}, {3, 1, 105, 1},
+        {86, 1, 111, 0}, {130, 1, 111, 0}, {68, 1, 111, 0}, {82, 1, 111, 0},
+        {99, 1, 111, 0}, {94, 1, 111, 0}, {104, 1, 111, 0}, {3, 1, 111, 1}
+    },
+    /* 136 */
+    {
+        {85, 1, 106, 0}, {67, 1, 106, 0}, {93, 1, 106, 0}, {2, 1, 106, 1},
+        {85, 1, 107, 0}, {67, 1, 107, 0}, {93, 1, 107, 0}, {2, 1, 107, 1},
+        {85, 1, 113, 0}, {67, 1, 113, 0}, {93, 1, 113, 0}, {2, 1, 113, 1},
+        {85, 1, 118, 0}, {67, 1, 118, 0}, {93, 1, 118, 0}, {2, 1, 118, 1}
+    },
+    /* 137 */
+    {
+        {86, 1, 106, 0}, {130, 1, 106, 0}, {68, 1, 106, 0}, {82, 1, 106, 0},
+        {99, 1, 106, 0}, {94, 1, 106, 0}, {104, 1, 106, 0}, {3, 1, 106, 1},
+        {86, 1, 107, 0}, {130, 1, 107, 0}, {68, 1, 107, 0}, {82, 1, 107, 0},
+        {99, 1, 107, 0}, {94, 1, 107, 0}, {104, 1, 107, 0}, {3, 1, 107, 1}
+    },
+    /* 138 */
+    {
+        {85, 1, 108, 0}, {67, 1, 108, 0}, {93, 1, 108, 0}, {2, 1, 108, 1},
+        {85, 1, 109, 0}, {67, 1, 109, 0}, {93, 1, 109, 0}, {2, 1, 109, 1},
+        {85, 1, 110, 0}, {67, 1, 110, 0}, {93, 1, 110, 0}, {2, 1, 110, 1},
+        {85, 1, 112, 0}, {67, 1, 112, 0}, {93, 1, 112, 0}, {2, 1, 112, 1}
+    },
+    /* 139 */
+    {
+        {86, 1, 108, 0}, {130, 1, 108, 0}, {68, 1, 108, 0}, {82, 1, 108, 0},
+        {99, 1, 108, 0}, {94, 1, 108, 0}, {104, 1, 108, 0}, {3, 1, 108, 1},
+        {86, 1, 109, 0}, {130, 1, 109, 0}, {68, 1, 109, 0}, {82, 1, 109, 0},
+        {99, 1, 109, 0}, {94, 1, 109, 0}, {104, 1, 109, 0}, {3, 1, 109, 1}
+    },
+    /* 140 */
+    {
+        {86, 1, 110, 0}, {130, 1, 110, 0}, {68, 1, 110, 0}, {82, 1, 110, 0},
+        {99, 1, 110, 0}, {94, 1, 110, 0}, {104, 1, 110, 0}, {3, 1, 110, 1},
+        {86, 1, 112, 0}, {130, 1, 112, 0}, {68, 1, 112, 0}, {82, 1, 112, 0},
+        {99, 1, 112, 0}, {94, 1, 112, 0}, {104, 1, 112, 0}, {3, 1, 112, 1}
+    },
+    /* 141 */
+    {
+        {86, 1, 113, 0}, {130, 1, 113, 0}, {68, 1, 113, 0}, {82, 1, 113, 0},
+        {99, 1, 113, 0}, {94, 1, 113, 0}, {104, 1, 113, 0}, {3, 1, 113, 1},
+        {86, 1, 118, 0}, {130, 1, 118, 0}, {68, 1, 118, 0}, {82, 1, 118, 0},
+        {99, 1, 118, 0}, {94, 1, 118, 0}, {104, 1, 118, 0}, {3, 1, 118, 1}
+    },
+    /* 142 */
+    {
+        {86, 1, 114, 0}, {130, 1, 114, 0}, {68, 1, 114, 0}, {82, 1, 114, 0},
+        {99, 1, 114, 0}, {94, 1, 114, 0}, {104, 1, 114, 0}, {3, 1, 114, 1},
+        {86, 1, 117, 0}, {130, 1, 117, 0}, {68, 1, 117, 0}, {82, 1, 117, 0},
+        {99, 1, 117, 0}, {94, 1, 117, 0}, {104, 1, 117, 0}, {3, 1, 117, 1}
+    },
+    /* 143 */
+    {
+        {86, 1, 115, 0}, {130, 1, 115, 0}, {68, 1, 115, 0}, {82, 1, 115, 0},
+        {99, 1, 115, 0}, {94, 1, 115, 0}, {104, 1, 115, 0}, {3, 1, 115, 1},
+        {86, 1, 116, 0}, {130, 1, 116, 0}, {68, 1, 116, 0}, {82, 1, 116, 0},
+        {99, 1, 116, 0}, {94, 1, 116, 0}, {104, 1, 116, 0}, {3, 1, 116, 1}
+    },
+    /* 144 */
+    {
+        {85, 1, 119, 0}, {67, 1, 119, 0}, {93, 1, 119, 0}, {2, 1, 119, 1},
+        {85, 1, 120, 0}, {67, 1, 120, 0}, {93, 1, 120, 0}, {2, 1, 120, 1},
+        {85, 1, 121, 0}, {67, 1, 121, 0}, {93, 1, 121, 0}, {2, 1, 121, 1},
+        {85, 1, 122, 0}, {67, 1, 122, 0}, {93, 1, 122, 0}, {2, 1, 122, 1}
+    },
+    /* 145 */
+    {
+        {86, 1, 119, 0}, {130, 1, 119, 0}, {68, 1, 119, 0}, {82, 1, 119, 0},
+        {99, 1, 119, 0}, {94, 1, 119, 0}, {104, 1, 119, 0}, {3, 1, 119, 1},
+        {86, 1, 120, 0}, {130, 1, 120, 0}, {68, 1, 120, 0}, {82, 1, 120, 0},
+        {99, 1, 120, 0}, {94, 1, 120, 0}, {104, 1, 120, 0}, {3, 1, 120, 1}
+    },
+    /* 146 */
+    {
+        {86, 1, 121, 0}, {130, 1, 121, 0}, {68, 1, 121, 0}, {82, 1, 121, 0},
+        {99, 1, 121, 0}, {94, 1, 121, 0}, {104, 1, 121, 0}, {3, 1, 121, 1},
+        {86, 1, 122, 0}, {130, 1, 122, 0}, {68, 1, 122, 0}, {82, 1, 122, 0},
+        {99, 1, 122, 0}, {94, 1, 122, 0}, {104, 1, 122, 0}, {3, 1, 122, 1}
+    },
+    /* 147 */
+    {
+        {86, 1, 127, 0}, {130, 1, 127, 0}, {68, 1, 127, 0}, {82, 1, 127, 0},
+        {99, 1, 127, 0}, {94, 1, 127, 0}, {104, 1, 127, 0}, {3, 1, 127, 1},
+        {86, 1, 220, 0}, {130, 1, 220, 0}, {68, 1, 220, 0}, {82, 1, 220, 0},
+        {99, 1, 220, 0}, {94, 1, 220, 0}, {104, 1, 220, 0}, {3, 1, 220, 1}
+    },
+    /* 148 */
+    {
+        {86, 1, 208, 0}, {130, 1, 208, 0}, {68, 1, 208, 0}, {82, 1, 208, 0},
+        {99, 1, 208, 0}, {94, 1, 208, 0}, {104, 1, 208, 0}, {3, 1, 208, 1},
+        {85, 1, 128, 0}, {67, 1, 128, 0}, {93, 1, 128, 0}, {2, 1, 128, 1},
+        {85, 1, 130, 0}, {67, 1, 130, 0}, {93, 1, 130, 0}, {2, 1, 130, 1}
+    },
+    /* 149 */
+    {
+        {86, 1, 128, 0}, {130, 1, 128, 0}, {68, 1, 128, 0}, {82, 1, 128, 0},
+        {99, 1, 128, 0}, {94, 1, 128, 0}, {104, 1, 128, 0}, {3, 1, 128, 1},
+        {86, 1, 130, 0}, {130, 1, 130, 0}, {68, 1, 130, 0}, {82, 1, 130, 0},
+        {99, 1, 130, 0}, {94, 1, 130, 0}, {104, 1, 130, 0}, {3, 1, 130, 1}
+    },
+    /* 150 */
+    {
+        {0, 1, 176, 1}, {0, 1, 177, 1}, {0, 1, 179, 1}, {0, 1, 209, 1},
+        {0, 1, 216, 1}, {0, 1, 217, 1}, {0, 1, 227, 1}, {0, 1, 229, 1},
+        {0, 1, 230, 1}, {154, 0, 0, 0}, {159, 0, 0, 0}, {160, 0, 0, 0},
+        {180, 0, 0, 0}, {182, 0, 0, 0}, {184, 0, 0, 0}, {190, 0, 0, 0}
+    },
+    /* 151 */
+    {
+        {66, 1, 230, 0}, {1, 1, 230, 1}, {0, 1, 129, 1}, {0, 1, 132, 1},
+        {0, 1, 133, 1}, {0, 1, 134, 1}, {0, 1, 136, 1}, {0, 1, 146, 1},
+        {0, 1, 154, 1}, {0, 1, 156, 1}, {0, 1, 160, 1}, {0, 1, 163, 1},
+        {0, 1, 164, 1}, {0, 1, 169, 1}, {0, 1, 170, 1}, {0, 1, 173, 1}
+    },
+    /* 152 */
+    {
+        {85, 1, 230, 0}, {67, 1, 230, 0}, {93, 1, 230, 0}, {2, 1, 230, 1},
+        {66, 1, 129, 0}, {1, 1, 129, 1}, {66, 1, 132, 0}, {1, 1, 132, 1},
+        {66, 1, 133, 0}, {1, 1, 133, 1}, {66, 1, 134, 0}, {1, 1, 134, 1},
+        {66, 1, 136, 0}, {1, 1, 136, 1}, {66, 1, 146, 0}, {1, 1, 146, 1}
+    },
+    /* 153 */
+    {
+        {86, 1, 230, 0}, {130, 1, 230, 0}, {68, 1, 230, 0}, {82, 1, 230, 0},
+        {99, 1, 230, 0}, {94, 1, 230, 0}, {104, 1, 230, 0}, {3, 1, 230, 1},
+        {85, 1, 129, 0}, {67, 1, 129, 0}, {93, 1, 129, 0}, {2, 1, 129, 1},
+        {85, 1, 132, 0}, {67, 1, 132, 0}, {93, 1, 132, 0}, {2, 1, 132, 1}
+    },
+    /* 154 */
+    {
+        {86, 1, 129, 0}, {130, 1, 129, 0}, {68, 1, 129, 0}, {82, 1, 129, 0},
+        {99, 1, 129, 0}, {94, 1, 129, 0}, {104, 1, 129, 0}, {3, 1, 129, 1},
+        {86, 1, 132, 0}, {130, 1, 132, 0}, {68, 1, 132, 0}, {82, 1, 132, 0},
+        {99, 1, 132, 0}, {94, 1, 132, 0}, {104, 1, 132, 0}, {3, 1, 132, 1}
+    },
+    /* 155 */
+    {
+        {66, 1, 131, 0}, {1, 1, 131, 1}, {66, 1, 162, 0}, {1, 1, 162, 1},
+        {66, 1, 184, 0}, {1, 1, 184, 1}, {66, 1, 194, 0}, {1, 1, 194, 1},
+        {66, 1, 224, 0}, {1, 1, 224, 1}, {66, 1, 226, 0}, {1, 1, 226, 1},
+        {0, 1, 153, 1}, {0, 1, 161, 1}, {0, 1, 167, 1}, {0, 1, 172, 1}
+    },
+    /* 156 */
+    {
+        {85, 1, 131, 0}, {67, 1, 131, 0}, {93, 1, 131, 0}, {2, 1, 131, 1},
+        {85, 1, 162, 0}, {67, 1, 162, 0}, {93, 1, 162, 0}, {2, 1, 162, 1},
+        {85, 1, 184, 0}, {67, 1, 184, 0}, {93, 1, 184, 0}, {2, 1, 184, 1},
+        {85, 1, 194, 0}, {67, 1, 194, 0}, {93, 1, 194, 0}, {2, 1, 194, 1}
+    },
+    /* 157 */
+    {
+        {86, 1, 131, 0}, {130, 1, 131, 0}, {68, 1, 131, 0}, {82, 1, 131, 0},
+        {99, 1, 131, 0}, {94, 1, 131, 0}, {104, 1, 131, 0}, {3, 1, 131, 1},
+        {86, 1, 162, 0}, {130, 1, 162, 0}, {68, 1, 162, 0}, {82, 1, 162, 0},
+        {99, 1, 162, 0}, {94, 1, 162, 0}, {104, 1, 162, 0}, {3, 1, 162, 1}
+    },
+    /* 158 */
+    {
+        {85, 1, 133, 0}, {67, 1, 133, 0}, {93, 1, 133, 0}, {2, 1, 133, 1},
+        {85, 1, 134, 0}, {67, 1, 134, 0}, {93, 1, 134, 0}, {2, 1, 134, 1},
+        {85, 1, 136, 0}, {67, 1, 136, 0}, {93, 1, 136, 0}, {2, 1, 136, 1},
+        {85, 1, 146, 0}, {67, 1, 146, 0}, {93, 1, 146, 0}, {2, 1, 146, 1}
+    },
+    /* 159 */
+    {
+        {86, 1, 133, 0}, {130, 1, 133, 0}, {68, 1, 133, 0}, {82, 1, 133, 0},
+        {99, 1, 133, 0}, {94, 1, 133, 0}, {104, 1, 133, 0}, {3, 1, 133, 1},
+        {86, 1, 134, 0}, {130, 1, 134, 0}, {68, 1, 134, 0}, {82, 1, 134, 0},
+        {99, 1, 134, 0}, {94, 1, 134, 0}, {104, 1, 134, 0}, {3, 1, 134, 1}
+    },
+    /* 160 */
+    {
+        {86, 1, 136, 0}, {130, 1, 136, 0}, {68, 1, 136, 0}, {82, 1, 136, 0},
+        {99, 1, 136, 0}, {94, 1, 136, 0}, {104, 1, 136, 0}, {3, 1, 136, 1},
+        {86, 1, 146, 0}, {130, 1, 146, 0}, {68, 1, 146, 0}, {82, 1, 146, 0},
+        {99, 1, 146, 0}, {94, 1, 146, 0}, {104, 1, 146, 0}, {3, 1, 146, 1}
+    },
+    /* 161 */
+    {
+        {86, 1, 137, 0}, {130, 1, 137, 0}, {68, 1, 137, 0}, {82, 1, 137, 0},
+        {99, 1, 137, 0}, {94, 1, 137, 0}, {104, 1, 137, 0}, {3, 1, 137, 1},
+        {86, 1, 138, 0}, {130, 1, 138, 0}, {68, 1, 138, 0}, {82, 1, 138, 0},
+        {99, 1, 138, 0}, {94, 1, 138, 0}, {104, 1, 138, 0}, {3, 1, 138, 1}
+    },
+    /* 162 */
+    {
+        {85, 1, 139, 0}, {67, 1, 139, 0}, {93, 1, 139, 0}, {2, 1, 139, 1},
+        {85, 1, 140, 0}, {67, 1, 140, 0}, {93, 1, 140, 0}, {2, 1, 140, 1},
+        {85, 1, 141, 0}, {67, 1, 141, 0}, {93, 1, 141, 0}, {2, 1, 141, 1},
+        {85, 1, 143, 0}, {67, 1, 143, 0}, {93, 1, 143, 0}, {2, 1, 143, 1}
+    },
+    /* 163 */
+    {
+        {86, 1, 139, 0}, {130, 1, 139, 0}, {68, 1, 139, 0}, {82, 1, 139, 0},
+        {99, 1, 139, 0}, {94, 1, 139, 0}, {104, 1, 139, 0}, {3, 1, 139, 1},
+        {86, 1, 140, 0}, {130, 1, 140, 0}, {68, 1, 140, 0}, {82, 1, 140, 0},
+        {99, 1, 140, 0}, {94, 1, 140, 0}, {104, 1, 140, 0}, {3, 1, 140, 1}
+    },
+    /* 164 */
+    {
+        {86, 1, 141, 0}, {130, 1, 141, 0}, {68, 1, 141, 0}, {82, 1, 141, 0},
+        {99, 1, 141, 0}, {94, 1, 141, 0}, {104, 1, 141, 0}, {3, 1, 141, 1},
+        {86, 1, 143, 0}, {130, 1, 143, 0}, {68, 1, 143, 0}, {82, 1, 143, 0},
+        {99, 1, 143, 0}, {94, 1, 143, 0}, {104, 1, 143, 0}, {3, 1, 143, 1}
+    },
+    /* 165 */
+    {
+        {85, 1, 144, 0}, {67, 1, 144, 0}, {93, 1, 144, 0}, {2, 1, 144, 1},
+        {85, 1, 145, 0}, {67, 1, 145, 0}, {93, 1, 145, 0}, {2, 1, 145, 1},
+        {85, 1, 148, 0}, {67, 1, 148, 0}, {93, 1, 148, 0}, {2, 1, 148, 1},
+        {85, 1, 159, 0}, {67, 1, 159, 0}, {93, 1, 159, 0}, {2, 1, 159, 1}
+    },
+    /* 166 */
+    {
+        {86, 1, 144, 0}, {130, 1, 144, 0}, {68, 1, 144, 0}, {82, 1, 144, 0},
+        {99, 1, 144, 0}, {94, 1, 144, 0}, {104, 1, 144, 0}, {3, 1, 144, 1},
+        {86, 1, 145, 0}, {130, 1, 145, 0}, {68, 1, 145, 0}, {82, 1, 145, 0},
+        {99, 1, 145, 0}, {94, 1, 145, 0}, {104, 1, 145, 0}, {3, 1, 145, 1}
+    },
+    /* 167 */
+    {
+        {0, 1, 147, 1}, {0, 1, 149, 1}, {0, 1, 150, 1}, {0, 1, 151, 1},
+        {0, 1, 152, 1}, {0, 1, 155, 1}, {0, 1, 157, 1}, {0, 1, 158, 1},
+        {0, 1, 165, 1}, {0, 1, 166, 1}, {0, 1, 168, 1}, {0, 1, 174, 1},
+        {0, 1, 175, 1}, {0, 1, 180, 1}, {0, 1, 182, 1}, {0, 1, 183, 1}
+    },
+    /* 168 */
+    {
+        {66, 1, 147, 0}, {1, 1, 147, 1}, {66, 1, 149, 0}, {1, 1, 149, 1},
+        {66, 1, 150, 0}, {1, 1, 150, 1}, {66, 1, 151, 0}, {1, 1, 151, 1},
+        {66, 1, 152, 0}, {1, 1, 152, 1}, {66, 1, 155, 0}, {1, 1, 155, 1},
+        {66, 1, 157, 0}, {1, 1, 157, 1}, {66, 1, 158, 0}, {1, 1, 158, 1}
+    },
+    /* 169 */
+    {
+        {85, 1, 147, 0}, {67, 1, 147, 0}, {93, 1, 147, 0}, {2, 1, 147, 1},
+        {85, 1, 149, 0}, {67, 1, 149, 0}, {93, 1, 149, 0}, {2, 1, 149, 1},
+        {85, 1, 150, 0}, {67, 1, 150, 0}, {93, 1, 150, 0}, {2, 1, 150, 1},
+        {85, 1, 151, 0}, {67, 1, 151, 0}, {93, 1, 151, 0}, {2, 1, 151, 1}
+    },
+    /* 170 */
+    {
+        {86, 1, 147, 0}, {130, 1, 147, 0}, {68, 1, 147, 0}, {82, 1, 147, 0},
+        {99, 1, 147, 0}, {94, 1, 147, 0}, {104, 1, 147, 0}, {3, 1, 147, 1},
+        {86, 1, 149, 0}, {130, 1, 149, 0}, {68, 1, 149, 0}, {82, 1, 149, 0},
+        {99, 1, 149, 0}, {94, 1, 149, 0}, {104, 1, 149, 0}, {3, 1, 149, 1}
+    },
+    /* 171 */
+    {
+        {86, 1, 148, 0}, {130, 1, 148, 0}, {68, 1, 148, 0}, {82, 1, 148, 0},
+        {99, 1, 148, 0}, {94, 1, 148, 0}, {104, 1, 148, 0}, {3, 1, 148, 1},
+        {86, 1, 159, 0}, {130, 1, 159, 0}, {68, 1, 159, 0}, {82, 1, 159, 0},
+        {99, 1, 159, 0}, {94, 1, 159, 0}, {104, 1, 159, 0}, {3, 1, 159, 1}
+    },
+    /* 172 */
+    {
+        {86, 1, 150, 0}, {130, 1, 150, 0}, {68, 1, 150, 0}, {82, 1, 150, 0},
+        {99, 1, 150, 0}, {94, 1, 150, 0}, {104, 1, 150, 0}, {3, 1, 150, 1},
+        {86, 1, 151, 0}, {130, 1, 151, 0}, {68, 1, 151, 0}, {82, 1, 151, 0},
+        {99, 1, 151, 0}, {94, 1, 151, 0}, {104, 1, 151, 0}, {3, 1, 151, 1}
+    },
+    /* 173 */
+    {
+        {85, 1, 152, 0}, {67, 1, 152, 0}, {93, 1, 152, 0}, {2, 1, 152, 1},
+        {85, 1, 155, 0}, {67, 1, 155, 0}, {93, 1, 155, 0}, {2, 1, 155, 1},
+        {85, 1, 157, 0}, {67, 1, 157, 0}, {93, 1, 157, 0}, {2, 1, 157, 1},
+        {85, 1, 158, 0}, {67, 1, 158, 0}, {93, 1, 158, 0}, {2, 1, 158, 1}
+    },
+    /* 174 */
+    {
+        {86, 1, 152, 0}, {130, 1, 152, 0}, {68, 1, 152, 0}, {82, 1, 152, 0},
+        {99, 1, 152, 0}, {94, 1, 152, 0}, {104, 1, 152, 0}, {3, 1, 152, 1},
+        {86, 1, 155, 0}, {130, 1, 155, 0}, {68, 1, 155, 0}, {82, 1, 155, 0},
+        {99, 1, 155, 0}, {94, 1, 155, 0}, {104, 1, 155, 0}, {3, 1, 155, 1}
+    },
+    /* 175 */
+    {
+        {85, 1, 224, 0}, {67, 1, 224, 0}, {93, 1, 224, 0}, {2, 1, 224, 1},
+        {85, 1, 226, 0}, {67, 1, 226, 0}, {93, 1, 226, 0}, {2, 1, 226, 1},
+        {66, 1, 153, 0}, {1, 1, 153, 1}, {66, 1, 161, 0}, {1, 1, 161, 1},
+        {66, 1, 167, 0}, {1, 1, 167, 1}, {66, 1, 172, 0}, {1, 1, 172, 1}
+    },
+    /* 176 */
+    {
+        {85, 1, 153, 0}, {67, 1, 153, 0}, {93, 1, 153, 0}, {2, 1, 153, 1},
+        {85, 1, 161, 0}, {67, 1, 161, 0}, {93, 1, 161, 0}, {2, 1, 161, 1},
+        {85, 1, 167, 0}, {67, 1, 167, 0}, {93, 1, 167, 0}, {2, 1, 167, 1},
+        {85, 1, 172, 0}, {67, 1, 172, 0}, {93, 1, 172, 0}, {2, 1, 172, 1}
+    },
+    /* 177 */
+    {
+        {86, 1, 153, 0}, {130, 1, 153, 0}, {68, 1, 153, 0}, {82, 1, 153, 0},
+        {99, 1, 153, 0}, {94, 1, 153, 0}, {104, 1, 153, 0}, {3, 1, 153, 1},
+        {86, 1, 161, 0}, {130, 1, 161, 0}, {68, 1, 161, 0}, {82, 1, 161, 0},
+        {99, 1, 161, 0}, {94, 1, 161, 0}, {104, 1, 161, 0}, {3, 1, 161, 1}
+    },
+    /* 178 */
+    {
+        {66, 1, 154, 0}, {1, 1, 154, 1}, {66, 1, 156, 0}, {1, 1, 156, 1},
+        {66, 1, 160, 0}, {1, 1, 160, 1}, {66, 1, 163, 0}, {1, 1, 163, 1},
+        {66, 1, 164, 0}, {1, 1, 164, 1}, {66, 1, 169, 0}, {1, 1, 169, 1},
+        {66, 1, 170, 0}, {1, 1, 170, 1}, {66, 1, 173, 0}, {1, 1, 173, 1}
+    },
+    /* 179 */
+    {
+        {85, 1, 154, 0}, {67, 1, 154, 0}, {93, 1, 154, 0}, {2, 1, 154, 1},
+        {85, 1, 156, 0}, {67, 1, 156, 0}, {93, 1, 156, 0}, {2, 1, 156, 1},
+        {85, 1, 160, 0}, {67, 1, 160, 0}, {93, 1, 160, 0}, {2, 1, 160, 1},
+        {85, 1, 163, 0}, {67, 1, 163, 0}, {93, 1, 163, 0}, {2, 1, 163, 1}
+    },
+    /* 180 */
+    {
+        {86, 1, 154, 0}, {130, 1, 154, 0}, {68, 1, 154, 0}, {82, 1, 154, 0},
+        {99, 1, 154, 0}, {94, 1, 154, 0}, {104, 1, 154, 0}, {3, 1, 154, 1},
+        {86, 1, 156, 0}, {130, 1, 156, 0}, {68, 1, 156, 0}, {82, 1, 156, 0},
+        {99, 1, 156, 0}, {94, 1, 156, 0}, {104, 1, 156, 0}, {3, 1, 156, 1}
+    },
+    /* 181 */
+    {
+        {86, 1, 157, 0}, {130, 1, 157, 0}, {68, 1, 157, 0}, {82, 1, 157, 0},
+        {99, 1, 157, 0}, {94, 1, 157, 0}, {104, 1, 157, 0}, {3, 1, 157, 1},
+        {86, 1, 158, 0}, {130, 1, 158, 0}, {68, 1, 158, 0}, {82, 1, 158, 0},
+        {99, 1, 158, 0}, {94, 1, 158, 0}, {104, 1, 158, 0}, {3, 1, 158, 1}
+    },
+    /* 182 */
+    {
+        {86, 1, 160, 0}, {130, 1, 160, 0}, {68, 1, 160, 0}, {82, 1, 160, 0},
+        {99, 1, 160, 0}, {94, 1, 160, 0}, {104, 1, 160, 0}, {3, 1, 160, 1},
+        {86, 1, 163, 0}, {130, 1, 163, 0}, {68, 1, 163, 0}, {82, 1, 163, 0},
+        {99, 1, 163, 0}, {94, 1, 163, 0}, {104, 1, 163, 0}, {3, 1, 163, 1}
+    },
+    /* 183 */
+    {
+        {85, 1, 164, 0}, {67, 1, 164, 0}, {93, 1, 164, 0}, {2, 1, 164, 1},
+        {85, 1, 169, 0}, {67, 1, 169, 0}, {93, 1, 169, 0}, {2, 1, 169, 1},
+        {85, 1, 170, 0}, {67, 1, 170, 0}, {93, 1, 170, 0}, {2, 1, 170, 1},
+        {85, 1, 173, 0}, {67, 1, 173, 0}, {93, 1, 173, 0}, {2, 1, 173, 1}
+    },
+    /* 184 */
+    {
+        {86, 1, 164, 0}, {130, 1, 164, 0}, {68, 1, 164, 0}, {82, 1, 164, 0},
+        {99, 1, 164, 0}, {94, 1, 164, 0}, {104, 1, 164, 0}, {3, 1, 164, 1},
+        {86, 1, 169, 0}, {130, 1, 169, 0}, {68, 1, 169, 0}, {82, 1, 169, 0},
+        {99, 1, 169, 0}, {94, 1, 169, 0}, {104, 1, 169, 0}, {3, 1, 169, 1}
+    },
+    /* 185 */
+    {
+        {66, 1, 165, 0}, {1, 1, 165, 1}, {66, 1, 166, 0}, {1, 1, 166, 1},
+        {66, 1, 168, 0}, {1, 1, 168, 1}, {66, 1, 174, 0}, {1, 1, 174, 1},
+        {66, 1, 175, 0}, {1, 1, 175, 1}, {66, 1, 180, 0}, {1, 1, 180, 1},
+        {66, 1, 182, 0}, {1, 1, 182, 1}, {66, 1, 183, 0}, {1, 1, 183, 1}
+    },
+    /* 186 */
+    {
+        {85, 1, 165, 0}, {67, 1, 165, 0}, {93, 1, 165, 0}, {2, 1, 165, 1},
+        {85, 1, 166, 0}, {67, 1, 166, 0}, {93, 1, 166, 0}, {2, 1, 166, 1},
+        {85, 1, 168, 0}, {67, 1, 168, 0}, {93, 1, 168, 0}, {2, 1, 168, 1},
+        {85, 1, 174, 0}, {67, 1, 174, 0}, {93, 1, 174, 0}, {2, 1, 174, 1}
+    },
+    /* 187 */
+    {
+        {86, 1, 165, 0}, {130, 1, 165, 0}, {68, 1, 165, 0}, {82, 1, 165, 0},
+        {99, 1, 165, 0}, {94, 1, 165, 0}, {104, 1, 165, 0}, {3, 1, 165, 1},
+        {86, 1, 166, 0}, {130, 1, 166, 0}, {68, 1, 166, 0}, {82, 1, 166, 0},
+        {99, 1, 166, 0}, {94, 1, 166, 0}, {104, 1, 166, 0}, {3, 1, 166, 1}
+    },
+    /* 188 */
+    {
+        {86, 1, 167, 0}, {130, 1, 167, 0}, {68, 1, 167, 0}, {82, 1, 167, 0},
+        {99, 1, 167, 0}, {94, 1, 167, 0}, {104, 1, 167, 0}, {3, 1, 167, 1},
+        {86, 1, 172, 0}, {130, 1, 172, 0}, {68, 1, 172, 0}, {82, 1, 172, 0},
+        {99, 1, 172, 0}, {94, 1, 172, 0}, {104, 1, 172, 0}, {3, 1, 172, 1}
+    },
+    /* 189 */
+    {
+        {86, 1, 168, 0}, {130, 1, 168, 0}, {68, 1, 168, 0}, {82, 1, 168, 0},
+        {99, 1, 168, 0}, {94, 1, 168, 0}, {104, 1, 168, 0}, {3, 1, 168, 1},
+        {86, 1, 174, 0}, {130, 1, 174, 0}, {68, 1, 174, 0}, {82, 1, 174, 0},
+        {99, 1, 174, 0}, {94, 1, 174, 0}, {104, 1, 174, 0}, {3, 1, 174, 1}
+    },
+    /* 190 */
+    {
+        {86, 1, 170, 0}, {130, 1, 170, 0}, {68, 1, 170, 0}, {82, 1, 170, 0},
+        {99, 1, 170, 0}, {94, 1, 170, 0}, {104, 1, 170, 0}, {3, 1, 170, 1},
+        {86, 1, 173, 0}, {130, 1, 173, 0}, {68, 1, 173, 0}, {82, 1, 173, 0},
+        {99, 1, 173, 0}, {94, 1, 173, 0}, {104, 1, 173, 0}, {3, 1, 173, 1}
+    },
+    /* 191 */
+    {
+        {66, 1, 171, 0}, {1, 1, 171, 1}, {66, 1, 206, 0}, {1, 1, 206, 1},
+        {66, 1, 215, 0}, {1, 1, 215, 1}, {66, 1, 225, 0}, {1, 1, 225, 1},
+        {66, 1, 236, 0}, {1, 1, 236, 1}, {66, 1, 237, 0}, {1, 1, 237, 1},
+        {0, 1, 199, 1}, {0, 1, 207, 1}, {0, 1, 234, 1}, {0, 1, 235, 1}
+    },
+    /* 192 */
+    {
+        {85, 1, 171, 0}, {67, 1, 171, 0}, {93, 1, 171, 0}, {2, 1, 171, 1},
+        {85, 1, 206, 0}, {67, 1, 206, 0}, {93, 1, 206, 0}, {2, 1, 206, 1},
+        {85, 1, 215, 0}, {67, 1, 215, 0}, {93, 1, 215, 0}, {2, 1, 215, 1},
+        {85, 1, 225, 0}, {67, 1, 225, 0}, {93, 1, 225, 0}, {2, 1, 225, 1}
+    },
+    /* 193 */
+    {
+        {86, 1, 171, 0}, {130, 1, 171, 0}, {68, 1, 171, 0}, {82, 1, 171, 0},
+        {99, 1, 171, 0}, {94, 1, 171, 0}, {104, 1, 171, 0}, {3, 1, 171, 1},
+        {86, 1, 206, 0}, {130, 1, 206, 0}, {68, 1, 206, 0}, {82, 1, 206, 0},
+        {99, 1, 206, 0}, {94, 1, 206, 0}, {104, 1, 206, 0}, {3, 1, 206, 1}
+    },
+    /* 194 */
+    {
+        {85, 1, 175, 0}, {67, 1, 175, 0}, {93, 1, 175, 0}, {2, 1, 175, 1},
+        {85, 1, 180, 0}, {67, 1, 180, 0}, {93, 1, 180, 0}, {2, 1, 180, 1},
+        {85, 1, 182, 0}, {67, 1, 182, 0}, {93, 1, 182, 0}, {2, 1, 182, 1},
+        {85, 1, 183, 0}, {67, 1, 183, 0}, {93, 1, 183, 0}, {2, 1, 183, 1}
+    },
+    /* 195 */
+    {
+        {86, 1, 175, 0}, {130, 1, 175, 0}, {68, 1, 175, 0}, {82, 1, 175, 0},
+        {99, 1, 175, 0}, {94, 1, 175, 0}, {104, 1, 175, 0}, {3, 1, 175, 1},
+        {86, 1, 180, 0}, {130, 1, 180, 0}, {68, 1, 180, 0}, {82, 1, 180, 0},
+        {99, 1, 180, 0}, {94, 1, 180, 0}, {104, 1, 180, 0}, {3, 1, 180, 1}
+    },
+    /* 196 */
+    {
+        {66, 1, 176, 0}, {1, 1, 176, 1}, {66, 1, 177, 0}, {1, 1, 177, 1},
+        {66, 1, 179, 0}, {1, 1, 179, 1}, {66, 1, 209, 0}, {1, 1, 209, 1},
+        {66, 1, 216, 0}, {1, 1, 216, 1}, {66, 1, 217, 0}, {1, 1, 217, 1},
+        {66, 1, 227, 0}, {1, 1, 227, 1}, {66, 1, 229, 0}, {1, 1, 229, 1}
+    },
+    /* 197 */
+    {
+        {85, 1, 176, 0}, {67, 1, 176, 0}, {93, 1, 176, 0}, {2, 1, 176, 1},
+        {85, 1, 177, 0}, {67, 1, 177, 0}, {93, 1, 177, 0}, {2, 1, 177, 1},
+        {85, 1, 179, 0}, {67, 1, 179, 0}, {93, 1, 179, 0}, {2, 1, 179, 1},
+        {85, 1, 209, 0}, {67, 1, 209, 0}, {93, 1, 209, 0}, {2, 1, 209, 1}
+    },
+    /* 198 */
+    {
+        {86, 1, 176, 0}, {130, 1, 176, 0}, {68, 1, 176, 0}, {82, 1, 176, 0},
+        {99, 1, 176, 0}, {94, 1, 176, 0}, {104, 1, 176, 0}, {3, 1, 176, 1},
+        {86, 1, 177, 0}, {130, 1, 177, 0}, {68, 1, 177, 0}, {82, 1, 177, 0},
+        {99, 1, 177, 0}, {94, 1, 177, 0}, {104, 1, 177, 0}, {3, 1, 177, 1}
+    },
+    /* 199 */
+    {
+        {66, 1, 178, 0}, {1, 1, 178, 1}, {66, 1, 181, 0}, {1, 1, 181, 1},
+        {66, 1, 185, 0}, {1, 1, 185, 1}, {66, 1, 186, 0}, {1, 1, 186, 1},
+        {66, 1, 187, 0}, {1, 1, 187, 1}, {66, 1, 189, 0}, {1, 1, 189, 1},
+        {66, 1, 190, 0}, {1, 1, 190, 1}, {66, 1, 196, 0}, {1, 1, 196, 1}
+    },
+    /* 200 */
+    {
+        {85, 1, 178, 0}, {67, 1, 178, 0}, {93, 1, 178, 0}, {2, 1, 178, 1},
+        {85, 1, 181, 0}, {67, 1, 181, 0}, {93, 1, 181, 0}, {2, 1, 181, 1},
+        {85, 1, 185, 0}, {67, 1, 185, 0}, {93, 1, 185, 0}, {2, 1, 185, 1},
+        {85, 1, 186, 0}, {67, 1, 186, 0}, {93, 1, 186, 0}, {2, 1, 186, 1}
+    },
+    /* 201 */
+    {
+        {86, 1, 178, 0}, {130, 1, 178, 0}, {68, 1, 178, 0}, {82, 1, 178, 0},
+        {99, 1, 178, 0}, {94, 1, 178, 0}, {104, 1, 178, 0}, {3, 1, 178, 1},
+        {86, 1, 181, 0}, {130, 1, 181, 0}, {68, 1, 181, 0}, {82, 1, 181, 0},
+        {99, 1, 181, 0}, {94, 1, 181, 0}, {104, 1, 181, 0}, {3, 1, 181, 1}
+    },
+    /* 202 */
+    {
+        {86, 1, 179, 0}, {130, 1, 179, 0}, {68, 1, 179, 0}, {82, 1, 179, 0},
+        {99, 1, 179, 0}, {94, 1, 179, 0}, {104, 1, 179, 0}, {3, 1, 179, 1},
+        {86, 1, 209, 0}, {130, 1, 209, 0}, {68, 1, 209, 0}, {82, 1, 209, 0},
+        {99, 1, 209, 0}, {94, 1, 209, 0}, {104, 1, 209, 0}, {3, 1, 209, 1}
+    },
+    /* 203 */
+    {
+        {86, 1, 182, 0}, {130, 1, 182, 0}, {68, 1, 182, 0}, {82, 1, 182, 0},
+        {99, 1, 182, 0}, {94, 1, 182, 0}, {104, 1, 182, 0}, {3, 1, 182, 1},
+        {86, 1, 183, 0}, {130, 1, 183, 0}, {68, 1, 183, 0}, {82, 1, 183, 0},
+        {99, 1, 183, 0}, {94, 1, 183, 0}, {104, 1, 183, 0}, {3, 1, 183, 1}
+    },
+    /* 204 */
+    {
+        {86, 1, 184, 0}, {130, 1, 184, 0}, {68, 1, 184, 0}, {82, 1, 184, 0},
+        {99, 1, 184, 0}, {94, 1, 184, 0}, {104, 1, 184, 0}, {3, 1, 184, 1},
+        {86, 1, 194, 0}, {130, 1, 194, 0}, {68, 1, 194, 0}, {82, 1, 194, 0},
+        {99, 1, 194, 0}, {94, 1, 194, 0}, {104, 1, 194, 0}, {3, 1, 194, 1}
+    },
+    /* 205 */
+    {
+        {86, 1, 185, 0}, {130, 1, 185, 0}, {68, 1, 185, 0}, {82, 1, 185, 0},
+        {99, 1, 185, 0}, {94, 1, 185, 0}, {104, 1, 185, 0}, {3, 1, 185, 1},
+        {86, 1, 186, 0}, {130, 1, 186, 0}, {68, 1, 186, 0}, {82, 1, 186, 0},
+        {99, 1, 186, 0}, {94, 1, 186, 0}, {104, 1, 186, 0}, {3, 1, 186, 1}
+    },
+    /* 206 */
+    {
+        {85, 1, 187, 0}, {67, 1, 187, 0}, {93, 1, 187, 0}, {2, 1, 187, 1},
+        {85, 1, 189, 0}, {67, 1, 189, 0}, {93, 1, 189, 0}, {2, 1, 189, 1},
+        {85, 1, 190, 0}, {67, 1, 190, 0}, {93, 1, 190, 0}, {2, 1, 190, 1},
+        {85, 1, 196, 0}, {67, 1, 196, 0}, {93, 1, 196, 0}, {2, 1, 196, 1}
+    },
+    /* 207 */
+    {
+        {86, 1, 187, 0}, {130, 1, 187, 0}, {68, 1, 187, 0}, {82, 1, 187, 0},
+        {99, 1, 187, 0}, {94, 1, 187, 0}, {104, 1, 187, 0}, {3, 1, 187, 1},
+        {86, 1, 189, 0}, {130, 1, 189, 0}, {68, 1, 189, 0}, {82, 1, 189, 0},
+        {99, 1, 189, 0}, {94, 1, 189, 0}, {104, 1, 189, 0}, {3, 1, 189, 1}
+    },
+    /* 208 */
+    {
+        {85, 1, 188, 0}, {67, 1, 188, 0}, {93, 1, 188, 0}, {2, 1, 188, 1},
+        {85, 1, 191, 0}, {67, 1, 191, 0}, {93, 1, 191, 0}, {2, 1, 191, 1},
+        {85, 1, 197, 0}, {67, 1, 197, 0}, {93, 1, 197, 0}, {2, 1, 197, 1},
+        {85, 1, 231, 0}, {67, 1, 231, 0}, {93, 1, 231, 0}, {2, 1, 231, 1}
+    },
+    /* 209 */
+    {
+        {86, 1, 188, 0}, {130, 1, 188, 0}, {68, 1, 188, 0}, {82, 1, 188, 0},
+        {99, 1, 188, 0}, {94, 1, 188, 0}, {104, 1, 188, 0}, {3, 1, 188, 1},
+        {86, 1, 191, 0}, {130, 1, 191, 0}, {68, 1, 191, 0}, {82, 1, 191, 0},
+        {99, 1, 191, 0}, {94, 1, 191, 0}, {104, 1, 191, 0}, {3, 1, 191, 1}
+    },
+    /* 210 */
+    {
+        {86, 1, 190, 0}, {130, 1, 190, 0}, {68, 1, 190, 0}, {82, 1, 190, 0},
+        {99, 1, 190, 0}, {94, 1, 190, 0}, {104, 1, 190, 0}, {3, 1, 190, 1},
+        {86, 1, 196, 0}, {130, 1, 196, 0}, {68, 1, 196, 0}, {82, 1, 196, 0},
+        {99, 1, 196, 0}, {94, 1, 196, 0}, {104, 1, 196, 0}, {3, 1, 196, 1}
+    },
+    /* 211 */
+    {
+        {0, 1, 192, 1}, {0, 1, 193, 1}, {0, 1, 200, 1}, {0, 1, 201, 1},
+        {0, 1, 202, 1}, {0, 1, 205, 1}, {0, 1, 210, 1}, {0, 1, 213, 1},
+        {0, 1, 218, 1}, {0, 1, 219, 1}, {0, 1, 238, 1}, {0, 1, 240, 1},
+        {0, 1, 242, 1}, {0, 1, 243, 1}, {0, 1, 255, 1}, {227, 0, 0, 0}
+    },
+    /* 212 */
+    {
+        {66, 1, 192, 0}, {1, 1, 192, 1}, {66, 1, 193, 0}, {1, 1, 193, 1},
+        {66, 1, 200, 0}, {1, 1, 200, 1}, {66, 1, 201, 0}, {1, 1, 201, 1},
+        {66, 1, 202, 0}, {1, 1, 202, 1}, {66, 1, 205, 0}, {1, 1, 205, 1},
+        {66, 1, 210, 0}, {1, 1, 210, 1}, {66, 1, 213, 0}, {1, 1, 213, 1}
+    },
+    /* 213 */
+    {
+        {85, 1, 192, 0}, {67, 1, 192, 0}, {93, 1, 192, 0}, {2, 1, 192, 1},
+        {85, 1, 193, 0}, {67, 1, 193, 0}, {93, 1, 193, 0}, {2, 1, 193, 1},
+        {85, 1, 200, 0}, {67, 1, 200, 0}, {93, 1, 200, 0}, {2, 1, 200, 1},
+        {85, 1, 201, 0}, {67, 1, 201, 0}, {93, 1, 201, 0}, {2, 1, 201, 1}
+    },
+    /* 214 */
+    {
+        {86, 1, 192, 0}, {130, 1, 192, 0}, {68, 1, 192, 0}, {82, 1, 192, 0},
+        {99, 1, 192, 0}, {94, 1, 192, 0}, {104, 1, 192, 0}, {3, 1, 192, 1},
+        {86, 1, 193, 0}, {130, 1, 193, 0}, {68, 1, 193, 0}, {82, 1, 193, 0},
+        {99, 1, 193, 0}, {94, 1, 193, 0}, {104, 1, 193, 0}, {3, 1, 193, 1}
+    },
+    /* 215 */
+    {
+        {86, 1, 197, 0}, {130, 1, 197, 0}, {68, 1, 197, 0}, {82, 1, 197, 0},
+        {99, 1, 197, 0}, {94, 1, 197, 0}, {104, 1, 197, 0}, {3, 1, 197, 1},
+        {86, 1, 231, 0}, {130, 1, 231, 0}, {68, 1, 231, 0}, {82, 1, 231, 0},
+        {99, 1, 231, 0}, {94, 1, 231, 0}, {104, 1, 231, 0}, {3, 1, 231, 1}
+    },
+    /* 216 */
+    {
+        {85, 1, 198, 0}, {67, 1, 198, 0}, {93, 1, 198, 0}, {2, 1, 198, 1},
+        {85, 1, 228, 0}, {67, 1, 228, 0}, {93, 1, 228, 0}, {2, 1, 228, 1},
+        {85, 1, 232, 0}, {67, 1, 232, 0}, {93, 1, 232, 0}, {2, 1, 232, 1},
+        {85, 1, 233, 0}, {67, 1, 233, 0}, {93, 1, 233, 0}, {2, 1, 233, 1}
+    },
+    /* 217 */
+    {
+        {86, 1, 198, 0}, {130, 1, 198, 0}, {68, 1, 198, 0}, {82, 1, 198, 0},
+        {99, 1, 198, 0}, {94, 1, 198, 0}, {104, 1, 198, 0}, {3, 1, 198, 1},
+        {86, 1, 228, 0}, {130, 1, 228, 0}, {68, 1, 228, 0}, {82, 1, 228, 0},
+        {99, 1, 228, 0}, {94, 1, 228, 0}, {104, 1, 228, 0}, {3, 1, 228, 1}
+    },
+    /* 218 */
+    {
+        {85, 1, 236, 0}, {67, 1, 236, 0}, {93, 1, 236, 0}, {2, 1, 236, 1},
+        {85, 1, 237, 0}, {67, 1, 237, 0}, {93, 1, 237, 0}, {2, 1, 237, 1},
+        {66, 1, 199, 0}, {1, 1, 199, 1}, {66, 1, 207, 0}, {1, 1, 207, 1},
+        {66, 1, 234, 0}, {1, 1, 234, 1}, {66, 1, 235, 0}, {1, 1, 235, 1}
+    },
+    /* 219 */
+    {
+        {85, 1, 199, 0}, {67, 1, 199, 0}, {93, 1, 199, 0}, {2, 1, 199, 1},
+        {85, 1, 207, 0}, {67, 1, 207, 0}, {93, 1, 207, 0}, {2, 1, 207, 1},
+        {85, 1, 234, 0}, {67, 1, 234, 0}, {93, 1, 234, 0}, {2, 1, 234, 1},
+        {85, 1, 235, 0}, {67, 1, 235, 0}, {93, 1, 235, 0}, {2, 1, 235, 1}
+    },
+    /* 220 */
+    {
+        {86, 1, 199, 0}, {130, 1, 199, 0}, {68, 1, 199, 0}, {82, 1, 199, 0},
+        {99, 1, 199, 0}, {94, 1, 199, 0}, {104, 1, 199, 0}, {3, 1, 199, 1},
+        {86, 1, 207, 0}, {130, 1, 207, 0}, {68, 1, 207, 0}, {82, 1, 207, 0},
+        {99, 1, 207, 0}, {94, 1, 207, 0}, {104, 1, 207, 0}, {3, 1, 207, 1}
+    },
+    /* 221 */
+    {
+        {86, 1, 200, 0}, {130, 1, 200, 0}, {68, 1, 200, 0}, {82, 1, 200, 0},
+        {99, 1, 200, 0}, {94, 1, 200, 0}, {104, 1, 200, 0}, {3, 1, 200, 1},
+        {86, 1, 201, 0}, {130, 1, 201, 0}, {68, 1, 201, 0}, {82, 1, 201, 0},
+        {99, 1, 201, 0}, {94, 1, 201, 0}, {104, 1, 201, 0}, {3, 1, 201, 1}
+    },
+    /* 222 */
+    {
+        {85, 1, 202, 0}, {67, 1, 202, 0}, {93, 1, 202, 0}, {2, 1, 202, 1},
+        {85, 1, 205, 0}, {67, 1, 205, 0}, {93, 1, 205, 0}, {2, 1, 205, 1},
+        {85, 1, 210, 0}, {67, 1, 210, 0}, {93, 1, 210, 0}, {2, 1, 210, 1},
+        {85, 1, 213, 0}, {67, 1, 213, 0}, {93, 1, 213, 0}, {2, 1, 213, 1}
+    },
+    /* 223 */
+    {
+        {86, 1, 202, 0}, {130, 1, 202, 0}, {68, 1, 202, 0}, {82, 1, 202, 0},
+        {99, 1, 202, 0}, {94, 1, 202, 0}, {104, 1, 202, 0}, {3, 1, 202, 1},
+        {86, 1, 205, 0}, {130, 1, 205, 0}, {68, 1, 205, 0}, {82, 1, 205, 0},
+        {99, 1, 205, 0}, {94, 1, 205, 0}, {104, 1, 205, 0}, {3, 1, 205, 1}
+    },
+    /* 224 */
+    {
+        {66, 1, 218, 0}, {1, 1, 218, 1}, {66, 1, 219, 0}, {1, 1, 219, 1},
+        {66, 1, 238, 0}, {1, 1, 238, 1}, {66, 1, 240, 0}, {1, 1, 240, 1},
+        {66, 1, 242, 0}, {1, 1, 242, 1}, {66, 1, 243, 0}, {1, 1, 243, 1},
+        {66, 1, 255, 0}, {1, 1, 255, 1}, {0, 1, 203, 1}, {0, 1, 204, 1}
+    },
+    /* 225 */
+    {
+        {85, 1, 242, 0}, {67, 1, 242, 0}, {93, 1, 242, 0}, {2, 1, 242, 1},
+        {85, 1, 243, 0}, {67, 1, 243, 0}, {93, 1, 243, 0}, {2, 1, 243, 1},
+        {85, 1, 255, 0}, {67, 1, 255, 0}, {93, 1, 255, 0}, {2, 1, 255, 1},
+        {66, 1, 203, 0}, {1, 1, 203, 1}, {66, 1, 204, 0}, {1, 1, 204, 1}
+    },
+    /* 226 */
+    {
+        {86, 1, 255, 0}, {130, 1, 255, 0}, {68, 1, 255, 0}, {82, 1, 255, 0},
+        {99, 1, 255, 0}, {94, 1, 255, 0}, {104, 1, 255, 0}, {3, 1, 255, 1},
+        {85, 1, 203, 0}, {67, 1, 203, 0}, {93, 1, 203, 0}, {2, 1, 203, 1},
+        {85, 1, 204, 0}, {67, 1, 204, 0}, {93, 1, 204, 0}, {2, 1, 204, 1}
+    },
+    /* 227 */
+    {
+        {86, 1, 203, 0}, {130, 1, 203, 0}, {68, 1, 203, 0}, {82, 1, 203, 0},
+        {99, 1, 203, 0}, {94, 1, 203, 0}, {104, 1, 203, 0}, {3, 1, 203, 1},
+        {86, 1, 204, 0}, {130, 1, 204, 0}, {68, 1, 204, 0}, {82, 1, 204, 0},
+        {99, 1, 204, 0}, {94, 1, 204, 0}, {104, 1, 204, 0}, {3, 1, 204, 1}
+    },
+    /* 228 */
+    {
+        {86, 1, 210, 0}, {130, 1, 210, 0}, {68, 1, 210, 0}, {82, 1, 210, 0},
+        {99, 1, 210, 0}, {94, 1, 210, 0}, {104, 1, 210, 0}, {3, 1, 210, 1},
+        {86, 1, 213, 0}, {130, 1, 213, 0}, {68, 1, 213, 0}, {82, 1, 213, 0},
+        {99, 1, 213, 0}, {94, 1, 213, 0}, {104, 1, 213, 0}, {3, 1, 213, 1}
+    },
+    /* 229 */
+    {
+        {0, 1, 211, 1}, {0, 1, 212, 1}, {0, 1, 214, 1}, {0, 1, 221, 1},
+        {0, 1, 222, 1}, {0, 1, 223, 1}, {0, 1, 241, 1}, {0, 1, 244, 1},
+        {0, 1, 245, 1}, {0, 1, 246, 1}, {0, 1, 247, 1}, {0, 1, 248, 1},
+        {0, 1, 250, 1}, {0, 1, 251, 1}, {0, 1, 252, 1}, {0, 1, 253, 1}
+    },
+    /* 230 */
+    {
+        {66, 1, 211, 0}, {1, 1, 211, 1}, {66, 1, 212, 0}, {1, 1, 212, 1},
+        {66, 1, 214, 0}, {1, 1, 214, 1}, {66, 1, 221, 0}, {1, 1, 221, 1},
+        {66, 1, 222, 0}, {1, 1, 222, 1}, {66, 1, 223, 0}, {1, 1, 223, 1},
+        {66, 1, 241, 0}, {1, 1, 241, 1}, {66, 1, 244, 0}, {1, 1, 244, 1}
+    },
+    /* 231 */
+    {
+        {85, 1, 211, 0}, {67, 1, 211, 0}, {93, 1, 211, 0}, {2, 1, 211, 1},
+        {85, 1, 212, 0}, {67, 1, 212, 0}, {93, 1, 212, 0}, {2, 1, 212, 1},
+        {85, 1, 214, 0}, {67, 1, 214, 0}, {93, 1, 214, 0}, {2, 1, 214, 1},
+        {85, 1, 221, 0}, {67, 1, 221, 0}, {93, 1, 221, 0}, {2, 1, 221, 1}
+    },
+    /* 232 */
+    {
+        {86, 1, 211, 0}, {130, 1, 211, 0}, {68, 1, 211, 0}, {82, 1, 211, 0},
+        {99, 1, 211, 0}, {94, 1, 211, 0}, {104, 1, 211, 0}, {3, 1, 211, 1},
+        {86, 1, 212, 0}, {130, 1, 212, 0}, {68, 1, 212, 0}, {82, 1, 212, 0},
+        {99, 1, 212, 0}, {94, 1, 212, 0}, {104, 1, 212, 0}, {3, 1, 212, 1}
+    },
+    /* 233 */
+    {
+        {86, 1, 214, 0}, {130, 1, 214, 0}, {68, 1, 214, 0}, {82, 1, 214, 0},
+        {99, 1, 214, 0}, {94, 1, 214, 0}, {104, 1, 214, 0}, {3, 1, 214, 1},
+        {86, 1, 221, 0}, {130, 1, 221, 0}, {68, 1, 221, 0}, {82, 1, 221, 0},
+        {99, 1, 221, 0}, {94, 1, 221, 0}, {104, 1, 221, 0}, {3, 1, 221, 1}
+    },
+    /* 234 */
+    {
+        {86, 1, 215, 0}, {130, 1, 215, 0}, {68, 1, 215, 0}, {82, 1, 215, 0},
+        {99, 1, 215, 0}, {94, 1, 215, 0}, {104, 1, 215, 0}, {3, 1, 215, 1},
+        {86, 1, 225, 0}, {130, 1, 225, 0}, {68, 1, 225, 0}, {82, 1, 225, 0},
+        {99, 1, 225, 0}, {94, 1, 225, 0}, {104, 1, 225, 0}, {3, 1, 225, 1}
+    },
+    /* 235 */
+    {
+        {85, 1, 216, 0}, {67, 1, 216, 0}, {93, 1, 216, 0}, {2, 1, 216, 1},
+        {85, 1, 217, 0}, {67, 1, 217, 0}, {93, 1, 217, 0}, {2, 1, 217, 1},
+        {85, 1, 227, 0}, {67, 1, 227, 0}, {93, 1, 227, 0}, {2, 1, 227, 1},
+        {85, 1, 229, 0}, {67, 1, 229, 0}, {93, 1, 229, 0}, {2, 1, 229, 1}
+    },
+    /* 236 */
+    {
+        {86, 1, 216, 0}, {130, 1, 216, 0}, {68, 1, 216, 0}, {82, 1, 216, 0},
+        {99, 1, 216, 0}, {94, 1, 216, 0}, {104, 1, 216, 0}, {3, 1, 216, 1},
+        {86, 1, 217, 0}, {130, 1, 217, 0}, {68, 1, 217, 0}, {82, 1, 217, 0},
+        {99, 1, 217, 0}, {94, 1, 217, 0}, {104, 1, 217, 0}, {3, 1, 217, 1}
+    },
+    /* 237 */
+    {
+        {85, 1, 218, 0}, {67, 1, 218, 0}, {93, 1, 218, 0}, {2, 1, 218, 1},
+        {85, 1, 219, 0}, {67, 1, 219, 0}, {93, 1, 219, 0}, {2, 1, 219, 1},
+        {85, 1, 238, 0}, {67, 1, 238, 0}, {93, 1, 238, 0}, {2, 1, 238, 1},
+        {85, 1, 240, 0}, {67, 1, 240, 0}, {93, 1, 240, 0}, {2, 1, 240, 1}
+    },
+    /* 238 */
+    {
+        {86, 1, 218, 0}, {130, 1, 218, 0}, {68, 1, 218, 0}, {82, 1, 218, 0},
+        {99, 1, 218, 0}, {94, 1, 218, 0}, {104, 1, 218, 0}, {3, 1, 218, 1},
+        {86, 1, 219, 0}, {130, 1, 219, 0}, {68, 1, 219, 0}, {82, 1, 219, 0},
+        {99, 1, 219, 0}, {94, 1, 219, 0}, {104, 1, 219, 0}, {3, 1, 219, 1}
+    },
+    /* 239 */
+    {
+        {85, 1, 222, 0}, {67, 1, 222, 0}, {93, 1, 222, 0}, {2, 1, 222, 1},
+        {85, 1, 223, 0}, {67, 1, 223, 0}, {93, 1, 223, 0}, {2, 1, 223, 1},
+        {85, 1, 241, 0}, {67, 1, 241, 0}, {93, 1, 241, 0}, {2, 1, 241, 1},
+        {85, 1, 244, 0}, {67, 1, 244, 0}, {93, 1, 244, 0}, {2, 1, 244, 1}
+    },
+    /* 240 */
+    {
+        {86, 1, 222, 0}, {130, 1, 222, 0}, {68, 1, 222, 0}, {82, 1, 222, 0},
+        {99, 1, 222, 0}, {94, 1, 222, 0}, {104, 1, 222, 0}, {3, 1, 222, 1},
+        {86, 1, 223, 0}, {130, 1, 223, 0}, {68, 1, 223, 0}, {82, 1, 223, 0},
+        {99, 1, 223, 0}, {94, 1, 223, 0}, {104, 1, 223, 0}, {3, 1, 223, 1}
+    },
+    /* 241 */
+    {
+        {86, 1, 224, 0}, {130, 1, 224, 0}, {68, 1, 224, 0}, {82, 1, 224, 0},
+        {99, 1, 224, 0}, {94, 1, 224, 0}, {104, 1, 224, 0}, {3, 1, 224, 1},
+        {86, 1, 226, 0}, {130, 1, 226, 0}, {68, 1, 226, 0}, {82, 1, 226, 0},
+        {99, 1, 226, 0}, {94, 1, 226, 0}, {104, 1, 226, 0}, {3, 1, 226, 1}
+    },
+    /* 242 */
+    {
+        {86, 1, 227, 0}, {130, 1, 227, 0}, {68, 1, 227, 0}, {82, 1, 227, 0},
+        {99, 1, 227, 0}, {94, 1, 227, 0}, {104, 1, 227, 0}, {3, 1, 227, 1},
+        {86, 1, 229, 0}, {130, 1, 229, 0}, {68, 1, 229, 0}, {82, 1, 229, 0},
+        {99, 1, 229, 0}, {94, 1, 229, 0}, {104, 1, 229, 0}, {3, 1, 229, 1}
+    },
+    /* 243 */
+    {
+        {86, 1, 232, 0}, {130, 1, 232, 0}, {68, 1, 232, 0}, {82, 1, 232, 0},
+        {99, 1, 232, 0}, {94, 1, 232, 0}, {104, 1, 232, 0}, {3, 1, 232, 1},
+        {86, 1, 233, 0}, {130, 1, 233, 0}, {68, 1, 233, 0}, {82, 1, 233, 0},
+        {99, 1, 233, 0}, {94, 1, 233, 0}, {104, 1, 233, 0}, {3, 1, 233, 1}
+    },
+    /* 244 */
+    {
+        {86, 1, 234, 0}, {130, 1, 234, 0}, {68, 1, 234, 0}, {82, 1, 234, 0},
+        {99, 1, 234, 0}, {94, 1, 234, 0}, {104, 1, 234, 0}, {3, 1, 234, 1},
+        {86, 1, 235, 0}, {130, 1, 235, 0}, {68, 1, 235, 0}, {82, 1, 235, 0},
+        {99, 1, 235, 0}, {94, 1, 235, 0}, {104, 1, 235, 0}, {3, 1, 235, 1}
+    },
+    /* 245 */
+    {
+        {86, 1, 236, 0}, {130, 1, 236, 0}, {68, 1, 236, 0}, {82, 1, 236, 0},
+        {99, 1, 236, 0}, {94, 1, 236, 0}, {104, 1, 236, 0}, {3, 1, 236, 1},
+        {86, 1, 237, 0}, {130, 1, 237, 0}, {68, 1, 237, 0}, {82, 1, 237, 0},
+        {99, 1, 237, 0}, {94, 1, 237, 0}, {104, 1, 237, 0}, {3, 1, 237, 1}
+    },
+    /* 246 */
+    {
+        {86, 1, 238, 0}, {130, 1, 238, 0}, {68, 1, 238, 0}, {82, 1, 238, 0},
+        {99, 1, 238, 0}, {94, 1, 238, 0}, {104, 1, 238, 0}, {3, 1, 238, 1},
+        {86, 1, 240, 0}, {130, 1, 240, 0}, {68, 1, 240, 0}, {82, 1, 240, 0},
+        {99, 1, 240, 0}, {94, 1, 240, 0}, {104, 1, 240, 0}, {3, 1, 240, 1}
+    },
+    /* 247 */
+    {
+        {86, 1, 241, 0}, {130, 1, 241, 0}, {68, 1, 241, 0}, {82, 1, 241, 0},
+        {99, 1, 241, 0}, {94, 1, 241, 0}, {104, 1, 241, 0}, {3, 1, 241, 1},
+        {86, 1, 244, 0}, {130, 1, 244, 0}, {68, 1, 244, 0}, {82, 1, 244, 0},
+        {99, 1, 244, 0}, {94, 1, 244, 0}, {104, 1, 244, 0}, {3, 1, 244, 1}
+    },
+    /* 248 */
+    {
+        {86, 1, 242, 0}, {130, 1, 242, 0}, {68, 1, 242, 0}, {82, 1, 242, 0},
+        {99, 1, 242, 0}, {94, 1, 242, 0}, {104, 1, 242, 0}, {3, 1, 242, 1},
+        {86, 1, 243, 0}, {130, 1, 243, 0}, {68, 1, 243, 0}, {82, 1, 243, 0},
+        {99, 1, 243, 0}, {94, 1, 243, 0}, {104, 1, 243, 0}, {3, 1, 243, 1}
+    },
+    /* 249 */
+    {
+        {66, 1, 245, 0}, {1, 1, 245, 1}, {66, 1, 246, 0}, {1, 1, 246, 1},
+        {66, 1, 247, 0}, {1, 1, 247, 1}, {66, 1, 248, 0}, {1, 1, 248, 1},
+        {66, 1, 250, 0}, {1, 1, 250, 1}, {66, 1, 251, 0}, {1, 1, 251, 1},
+        {66, 1, 252, 0}, {1, 1, 252, 1}, {66, 1, 253, 0}, {1, 1, 253, 1}
+    },
+    /* 250 */
+    {
+        {85, 1, 245, 0}, {67, 1, 245, 0}, {93, 1, 245, 0}, {2, 1, 245, 1},
+        {85, 1, 246, 0}, {67, 1, 246, 0}, {93, 1, 246, 0}, {2, 1, 246, 1},
+        {85, 1, 247, 0}, {67, 1, 247, 0}, {93, 1, 247, 0}, {2, 1, 247, 1},
+        {85, 1, 248, 0}, {67, 1, 248, 0}, {93, 1, 248, 0}, {2, 1, 248, 1}
+    },
+    /* 251 */
+    {
+        {86, 1, 245, 0}, {130, 1, 245, 0}, {68, 1, 245, 0}, {82, 1, 245, 0},
+        {99, 1, 245, 0}, {94, 1, 245, 0}, {104, 1, 245, 0}, {3, 1, 245, 1},
+        {86, 1, 246, 0}, {130, 1, 246, 0}, {68, 1, 246, 0}, {82, 1, 246, 0},
+        {99, 1, 246, 0}, {94, 1, 246, 0}, {104, 1, 246, 0}, {3, 1, 246, 1}
+    },
+    /* 252 */
+    {
+        {86, 1, 247, 0}, {130, 1, 247, 0}, {68, 1, 247, 0}, {82, 1, 247, 0},
+        {99, 1, 247, 0}, {94, 1, 247, 0}, {104, 1, 247, 0}, {3, 1, 247, 1},
+        {86, 1, 248, 0}, {130, 1, 248, 0}, {68, 1, 248, 0}, {82, 1, 248, 0},
+        {99, 1, 248, 0}, {94, 1, 248, 0}, {104, 1, 248, 0}, {3, 1, 248, 1}
+    },
+    /* 253 */
+    {
+        {85, 1, 250, 0}, {67, 1, 250, 0}, {93, 1, 250, 0}, {2, 1, 250, 1},
+        {85, 1, 251, 0}, {67, 1, 251, 0}, {93, 1, 251, 0}, {2, 1, 251, 1},
+        {85, 1, 252, 0}, {67, 1, 252, 0}, {93, 1, 252, 0}, {2, 1, 252, 1},
+        {85, 1, 253, 0}, {67, 1, 253, 0}, {93, 1, 253, 0}, {2, 1, 253, 1}
+    },
+    /* 254 */
+    {
+        {86, 1, 250, 0}, {130, 1, 250, 0}, {68, 1, 250, 0}, {82, 1, 250, 0},
+        {99, 1, 250, 0}, {94, 1, 250, 0}, {104, 1, 250, 0}, {3, 1, 250, 1},
+        {86, 1, 251, 0}, {130, 1, 251, 0}, {68, 1, 251, 0}, {82, 1, 251, 0},
+        {99, 1, 251, 0}, {94, 1, 251, 0}, {104, 1, 251, 0}, {3, 1, 251, 1}
+    },
+    /* 255 */
+    {
+        {86, 1, 252, 0}, {130, 1, 252, 0}, {68, 1, 252, 0}, {82, 1, 252, 0},
+        {99, 1, 252, 0}, {94, 1, 252, 0}, {104, 1, 252, 0}, {3, 1, 252, 1},
+        {86, 1, 253, 0}, {130, 1, 253, 0}, {68, 1, 253, 0}, {82, 1, 253, 0},
+        {99, 1, 253, 0}, {94, 1, 253, 0}, {104, 1, 253, 0}, {3, 1, 253, 1}
+    }
+};
+
+
+ngx_int_t
+ngx_http_v2_huff_decode(u_char *state, u_char *src, size_t len, u_char **dst,
+    ngx_uint_t last, ngx_log_t *log)
+{
+    u_char  *end, ch, ending;
+
+    ch = 0;
+    ending = 1;
+
+    end = src + len;
+
+    while (src != end) {
+        ch = *src++;
+
+        if (ngx_http_v2_huff_decode_bits(state, &ending, ch >> 4, dst)
+            != NGX_OK)
+        {
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error at state %d: "
+                           "bad code 0x%Xd", *state, ch >> 4);
+
+            return NGX_ERROR;
+        }
+
+        if (ngx_http_v2_huff_decode_bits(state, &ending, ch & 0xf, dst)
+            != NGX_OK)
+        {
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error at state %d: "
+                           "bad code 0x%Xd", *state, ch & 0xf);
+
+            return NGX_ERROR;
+        }
+    }
+
+    if (last) {
+        if (!ending) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error: "
+                           "incomplete code 0x%Xd", ch);
+
+            return NGX_ERROR;
+        }
+
+        *state = 0;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_inline ngx_int_t
+ngx_http_v2_huff_decode_bits(u_char *state, u_char *ending, ngx_uint_t bits,
+    u_char **dst)
+{
+    ngx_http_v2_huff_decode_code_t  code;
+
+    code = ngx_http_v2_huff_decode_codes[*state][bits];
+
+    if (code.next == 0 && !code.emit) {
+        return NGX_ERROR;
+    }
+
+    if (code.emit) {
+        **dst = code.sym;
+        (*dst)++;
+    }
+
+    *ending = code.ending;
+    *state = code.next;
+
+    return NGX_OK;
+}
@@ -5,8 +5,8 @@
  */
 
 
-#ifndef _NGX_HTTP_SPDY_MODULE_H_INCLUDED_
-#define _NGX_HTTP_SPDY_MODULE_H_INCLUDED_
+#ifndef _NGX_HTTP_V2_MODULE_H_INCLUDED_
+#define _NGX_HTTP_V2_MODULE_H_INCLUDED_
 
 
 #include <ngx_config.h>
@@ -17,25 +17,26 @@
 typedef struct {
     size_t                          recv_buffer_size;
     u_char                         *recv_buffer;
-} ngx_http_spdy_main_conf_t;
+} ngx_http_v2_main_conf_t;
 
 
 typedef struct {
     size_t                          pool_size;
     ngx_uint_t                      concurrent_streams;
+    size_t                          max_field_size;
+    size_t                          max_header_size;
     ngx_uint_t                      streams_index_mask;
     ngx_msec_t                      recv_timeout;
-    ngx_msec_t                      keepalive_timeout;
-    ngx_int_t                       headers_comp;
-} ngx_http_spdy_srv_conf_t;
+    ngx_msec_t                      idle_timeout;
+} ngx_http_v2_srv_conf_t;
 
 
 typedef struct {
     size_t                          chunk_size;
-} ngx_http_spdy_loc_conf_t;
+} ngx_http_v2_loc_conf_t;
 
 
-extern ngx_module_t  ngx_http_spdy_module;
+extern ngx_module_t  ngx_http_v2_module;
 
 
-#endif /* _NGX_HTTP_SPDY_MODULE_H_INCLUDED_ */
+#endif /* _NGX_HTTP_V2_MODULE_H_INCLUDED_ */
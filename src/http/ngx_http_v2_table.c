@@ -0,0 +1,333 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/* RFC 7541, 4.1: an entry costs its name and value plus 32 octets */
+#define NGX_HTTP_V2_ENTRY_OVERHEAD  32
+
+#define ngx_http_v2_entry_size(e)                                             \
+    ((e)->name_len + (e)->value_len + NGX_HTTP_V2_ENTRY_OVERHEAD)
+
+
+static ngx_int_t ngx_http_v2_table_account(ngx_http_v2_connection_t *h2c,
+    size_t size);
+static void ngx_http_v2_table_copy(ngx_http_v2_hpack_t *hpack, u_char *dst,
+    size_t offset, size_t len);
+
+
+static ngx_http_v2_header_t  ngx_http_v2_static_table[] = {
+    { ngx_string(":authority"), ngx_string("") },
+    { ngx_string(":method"), ngx_string("GET") },
+    { ngx_string(":method"), ngx_string("POST") },
+    { ngx_string(":path"), ngx_string("/") },
+    { ngx_string(":path"), ngx_string("/index.html") },
+    { ngx_string(":scheme"), ngx_string("http") },
+    { ngx_string(":scheme"), ngx_string("https") },
+    { ngx_string(":status"), ngx_string("200") },
+    { ngx_string(":status"), ngx_string("204") },
+    { ngx_string(":status"), ngx_string("206") },
+    { ngx_string(":status"), ngx_string("304") },
+    { ngx_string(":status"), ngx_string("400") },
+    { ngx_string(":status"), ngx_string("404") },
+    { ngx_string(":status"), ngx_string("500") },
+    { ngx_string("accept-charset"), ngx_string("") },
+    { ngx_string("accept-encoding"), ngx_string("gzip, deflate") },
+    { ngx_string("accept-language"), ngx_string("") },
+    { ngx_string("accept-ranges"), ngx_string("") },
+    { ngx_string("accept"), ngx_string("") },
+    { ngx_string("access-control-allow-origin"), ngx_string("") },
+    { ngx_string("age"), ngx_string("") },
+    { ngx_string("allow"), ngx_string("") },
+    { ngx_string("authorization"), ngx_string("") },
+    { ngx_string("cache-control"), ngx_string("") },
+    { ngx_string("content-disposition"), ngx_string("") },
+    { ngx_string("content-encoding"), ngx_string("") },
+    { ngx_string("content-language"), ngx_string("") },
+    { ngx_string("content-length"), ngx_string("") },
+    { ngx_string("content-location"), ngx_string("") },
+    { ngx_string("content-range"), ngx_string("") },
+    { ngx_string("content-type"), ngx_string("") },
+    { ngx_string("cookie"), ngx_string("") },
+    { ngx_string("date"), ngx_string("") },
+    { ngx_string("etag"), ngx_string("") },
+    { ngx_string("expect"), ngx_string("") },
+    { ngx_string("expires"), ngx_string("") },
+    { ngx_string("from"), ngx_string("") },
+    { ngx_string("host"), ngx_string("") },
+    { ngx_string("if-match"), ngx_string("") },
+    { ngx_string("if-modified-since"), ngx_string("") },
+    { ngx_string("if-none-match"), ngx_string("") },
+    { ngx_string("if-range"), ngx_string("") },
+    { ngx_string("if-unmodified-since"), ngx_string("") },
+    { ngx_string("last-modified"), ngx_string("") },
+    { ngx_string("link"), ngx_string("") },
+    { ngx_string("location"), ngx_string("") },
+    { ngx_string("max-forwards"), ngx_string("") },
+    { ngx_string("proxy-authenticate"), ngx_string("") },
+    { ngx_string("proxy-authorization"), ngx_string("") },
+    { ngx_string("range"), ngx_string("") },
+    { ngx_string("referer"), ngx_string("") },
+    { ngx_string("refresh"), ngx_string("") },
+    { ngx_string("retry-after"), ngx_string("") },
+    { ngx_string("server"), ngx_string("") },
+    { ngx_string("set-cookie"), ngx_string("") },
+    { ngx_string("strict-transport-security"), ngx_string("") },
+    { ngx_string("transfer-encoding"), ngx_string("") },
+    { ngx_string("user-agent"), ngx_string("") },
+    { ngx_string("vary"), ngx_string("") },
+    { ngx_string("via"), ngx_string("") },
+    { ngx_string("www-authenticate"), ngx_string("") },
+};
+
+#define NGX_HTTP_V2_STATIC_TABLE_ENTRIES                                      \
+    (sizeof(ngx_http_v2_static_table)                                         \
+     / sizeof(ngx_http_v2_header_t))
+
+
+ngx_int_t
+ngx_http_v2_get_indexed_header(ngx_http_v2_connection_t *h2c, ngx_uint_t index,
+    ngx_uint_t name_only)
+{
+    u_char                     *p;
+    ngx_http_v2_hpack_t        *hpack;
+    ngx_http_v2_header_t       *header;
+    ngx_http_v2_hpack_entry_t  *entry;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 get indexed %s: %ui",
+                   name_only ? "header name" : "header", index);
+
+    if (index == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent invalid hpack table index 0");
+        return NGX_ERROR;
+    }
+
+    index--;
+
+    if (index < NGX_HTTP_V2_STATIC_TABLE_ENTRIES) {
+        header = &ngx_http_v2_static_table[index];
+
+        h2c->state.header.name = header->name;
+
+        if (name_only) {
+            return NGX_OK;
+        }
+
+        h2c->state.header.value = header->value;
+
+        return NGX_OK;
+    }
+
+    index -= NGX_HTTP_V2_STATIC_TABLE_ENTRIES;
+
+    hpack = &h2c->hpack;
+
+    if (index >= hpack->added - hpack->deleted) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent out of bound hpack table index: %ui",
+                      index + NGX_HTTP_V2_STATIC_TABLE_ENTRIES + 1);
+        return NGX_ERROR;
+    }
+
+    /* the most recently added entry has the lowest index */
+
+    entry = &hpack->entries[(hpack->added - index - 1) % hpack->allocated];
+
+    /*
+     * Entries may wrap around the end of the storage ring and may be
+     * evicted while the header is still in use, so they are copied.
+     */
+
+    p = ngx_pnalloc(h2c->state.pool, entry->name_len + 1
+                                     + (name_only ? 0 : entry->value_len + 1));
+    if (p == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_http_v2_table_copy(hpack, p, entry->offset, entry->name_len);
+    p[entry->name_len] = '\0';
+
+    h2c->state.header.name.len = entry->name_len;
+    h2c->state.header.name.data = p;
+
+    if (name_only) {
+        return NGX_OK;
+    }
+
+    p += entry->name_len + 1;
+
+    ngx_http_v2_table_copy(hpack, p, entry->offset + entry->name_len,
+                           entry->value_len);
+    p[entry->value_len] = '\0';
+
+    h2c->state.header.value.len = entry->value_len;
+    h2c->state.header.value.data = p;
+
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_http_v2_add_header(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_header_t *header)
+{
+    size_t                      size, n, offset;
+    ngx_http_v2_hpack_t        *hpack;
+    ngx_http_v2_hpack_entry_t  *entry;
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 add header to hpack table: \"%V: %V\" (%ui/%uz)",
+                   &header->name, &header->value,
+                   h2c->hpack.added - h2c->hpack.deleted, h2c->hpack.free);
+
+    hpack = &h2c->hpack;
+
+    if (hpack->storage == NULL) {
+        hpack->storage = ngx_palloc(h2c->connection->pool,
+                                    NGX_HTTP_V2_TABLE_SIZE);
+        if (hpack->storage == NULL) {
+            return NGX_ERROR;
+        }
+
+        hpack->allocated = NGX_HTTP_V2_TABLE_SIZE
+                           / NGX_HTTP_V2_ENTRY_OVERHEAD;
+
+        hpack->entries = ngx_palloc(h2c->connection->pool,
+                                    hpack->allocated
+                                    * sizeof(ngx_http_v2_hpack_entry_t));
+        if (hpack->entries == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    size = header->name.len + header->value.len + NGX_HTTP_V2_ENTRY_OVERHEAD;
+
+    if (size > hpack->size) {
+
+        /*
+         * RFC 7541, 4.4: an entry larger than the table empties it
+         * and is not added.
+         */
+
+        hpack->deleted = hpack->added;
+        hpack->free = hpack->size;
+
+        return NGX_OK;
+    }
+
+    if (ngx_http_v2_table_account(h2c, size) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    offset = hpack->pos;
+
+    entry = &hpack->entries[hpack->added % hpack->allocated];
+
+    entry->name_len = header->name.len;
+    entry->value_len = header->value.len;
+    entry->offset = offset;
+
+    /* the data is written into the ring, possibly wrapping around */
+
+    n = ngx_min(header->name.len, NGX_HTTP_V2_TABLE_SIZE - offset);
+
+    ngx_memcpy(hpack->storage + offset, header->name.data, n);
+    ngx_memcpy(hpack->storage, header->name.data + n, header->name.len - n);
+
+    offset = (offset + header->name.len) % NGX_HTTP_V2_TABLE_SIZE;
+
+    n = ngx_min(header->value.len, NGX_HTTP_V2_TABLE_SIZE - offset);
+
+    ngx_memcpy(hpack->storage + offset, header->value.data, n);
+    ngx_memcpy(hpack->storage, header->value.data + n, header->value.len - n);
+
+    hpack->pos = (offset + header->value.len) % NGX_HTTP_V2_TABLE_SIZE;
+
+    hpack->added++;
+    hpack->free -= size;
+
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_http_v2_table_size(ngx_http_v2_connection_t *h2c, size_t size)
+{
+    ngx_http_v2_hpack_t  *hpack;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 new hpack table size: %uz", size);
+
+    if (size > NGX_HTTP_V2_TABLE_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent invalid table size update: %uz", size);
+
+        return NGX_ERROR;
+    }
+
+    hpack = &h2c->hpack;
+
+    if (size < hpack->size
+        && ngx_http_v2_table_account(h2c, hpack->size - size) != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    hpack->free -= hpack->size - size;
+    hpack->size = size;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_table_account(ngx_http_v2_connection_t *h2c, size_t size)
+{
+    ngx_http_v2_hpack_t        *hpack;
+    ngx_http_v2_hpack_entry_t  *entry;
+
+    hpack = &h2c->hpack;
+
+    while (size > hpack->free) {
+
+        if (hpack->deleted == hpack->added) {
+            ngx_log_error(NGX_LOG_ALERT, h2c->connection->log, 0,
+                          "hpack table accounting is broken");
+            return NGX_ERROR;
+        }
+
+        entry = &hpack->entries[hpack->deleted % hpack->allocated];
+
+        hpack->free += ngx_http_v2_entry_size(entry);
+        hpack->deleted++;
+
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                       "http2 hpack table evicted entry, free: %uz",
+                       hpack->free);
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_table_copy(ngx_http_v2_hpack_t *hpack, u_char *dst, size_t offset,
+    size_t len)
+{
+    size_t  n;
+
+    offset %= NGX_HTTP_V2_TABLE_SIZE;
+
+    n = ngx_min(len, NGX_HTTP_V2_TABLE_SIZE - offset);
+
+    ngx_memcpy(dst, hpack->storage + offset, n);
+    ngx_memcpy(dst + n, hpack->storage, len - n);
+}
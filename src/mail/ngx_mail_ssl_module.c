@@ -128,7 +128,7 @@ static ngx_command_t  ngx_mail_ssl_commands[] = {
       NULL },
 
     { ngx_string("ssl_session_cache"),
-      NGX_MAIL_MAIN_CONF|NGX_MAIL_SRV_CONF|NGX_CONF_TAKE12,
+      NGX_MAIL_MAIN_CONF|NGX_MAIL_SRV_CONF|NGX_CONF_TAKE123,
       ngx_mail_ssl_session_cache,
       NGX_MAIL_SRV_CONF_OFFSET,
       0,
@@ -553,10 +553,12 @@ ngx_mail_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     size_t       len;
     ngx_str_t   *value, name, size;
     ngx_int_t    n;
-    ngx_uint_t   i, j;
+    ngx_uint_t   i, j, shards;
 
     value = cf->args->elts;
 
+    shards = 0;
+
     for (i = 1; i < cf->args->nelts; i++) {
 
         if (ngx_strcmp(value[i].data, "off") == 0) {
@@ -590,6 +592,19 @@ ngx_mail_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             continue;
         }
 
+        if (ngx_strncmp(value[i].data, "shards=", 7) == 0) {
+
+            n = ngx_atoi(value[i].data + 7, value[i].len - 7);
+
+            if (n < 1 || n > NGX_SSL_MAX_SCACHE_SHARDS) {
+                goto invalid;
+            }
+
+            shards = n;
+
+            continue;
+        }
+
         if (value[i].len > sizeof("shared:") - 1
             && ngx_strncmp(value[i].data, "shared:", sizeof("shared:") - 1)
                == 0)
@@ -642,6 +657,20 @@ ngx_mail_ssl_session_cache(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         goto invalid;
     }
 
+    if (scf->shm_zone == NULL) {
+
+        if (shards) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "\"shards\" requires a shared session cache");
+            return NGX_CONF_ERROR;
+        }
+
+    } else if (ngx_ssl_session_cache_shards(cf, scf->shm_zone, shards)
+               != NGX_OK)
+    {
+        return NGX_CONF_ERROR;
+    }
+
     if (scf->shm_zone && scf->builtin_session_cache == NGX_CONF_UNSET) {
         scf->builtin_session_cache = NGX_SSL_NO_BUILTIN_SCACHE;
     }
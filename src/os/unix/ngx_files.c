@@ -426,6 +426,45 @@ failed:
 }
 
 
+ngx_int_t
+ngx_open_file_mapping(ngx_file_mapping_t *fm)
+{
+    ngx_file_info_t  fi;
+
+    fm->fd = ngx_open_file(fm->name, NGX_FILE_RDONLY, NGX_FILE_OPEN, 0);
+    if (fm->fd == NGX_INVALID_FILE) {
+        ngx_log_error(NGX_LOG_CRIT, fm->log, ngx_errno,
+                      ngx_open_file_n " \"%s\" failed", fm->name);
+        return NGX_ERROR;
+    }
+
+    if (ngx_fd_info(fm->fd, &fi) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, fm->log, ngx_errno,
+                      ngx_fd_info_n " \"%s\" failed", fm->name);
+        goto failed;
+    }
+
+    fm->size = (size_t) ngx_file_size(&fi);
+
+    fm->addr = mmap(NULL, fm->size, PROT_READ, MAP_SHARED, fm->fd, 0);
+    if (fm->addr != MAP_FAILED) {
+        return NGX_OK;
+    }
+
+    ngx_log_error(NGX_LOG_CRIT, fm->log, ngx_errno,
+                  "mmap(%uz) \"%s\" failed", fm->size, fm->name);
+
+failed:
+
+    if (ngx_close_file(fm->fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, fm->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", fm->name);
+    }
+
+    return NGX_ERROR;
+}
+
+
 void
 ngx_close_file_mapping(ngx_file_mapping_t *fm)
 {
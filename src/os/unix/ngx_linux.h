@@ -13,4 +13,22 @@ ngx_chain_t *ngx_linux_sendfile_chain(ngx_connection_t *c, ngx_chain_t *in,
     off_t limit);
 
 
+#if (NGX_HAVE_SPLICE)
+
+typedef struct {
+    ngx_fd_t     fd[2];
+    size_t       size;
+    size_t       capacity;
+    ngx_log_t   *log;
+} ngx_splice_pipe_t;
+
+
+ngx_splice_pipe_t *ngx_splice_pipe(ngx_pool_t *pool, ngx_log_t *log);
+ssize_t ngx_splice_recv(ngx_connection_t *c, ngx_splice_pipe_t *p,
+    size_t size);
+ssize_t ngx_splice_send(ngx_connection_t *c, ngx_splice_pipe_t *p);
+
+#endif
+
+
 #endif /* _NGX_LINUX_H_INCLUDED_ */
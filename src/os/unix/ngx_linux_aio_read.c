@@ -13,6 +13,13 @@
 extern int            ngx_eventfd;
 extern aio_context_t  ngx_aio_ctx;
 
+#if (NGX_HAVE_IOURING)
+extern ngx_uint_t     ngx_iouring_aio;
+
+ngx_int_t ngx_iouring_aio_read(ngx_event_t *ev, ngx_fd_t fd, u_char *buf,
+    size_t size, off_t offset);
+#endif
+
 
 static void ngx_file_aio_event_handler(ngx_event_t *ev);
 
@@ -93,6 +100,24 @@ ngx_file_aio_read(ngx_file_t *file, u_char *buf, size_t size, off_t offset,
         return NGX_ERROR;
     }
 
+#if (NGX_HAVE_IOURING)
+
+    if (ngx_iouring_aio) {
+        ev->handler = ngx_file_aio_event_handler;
+
+        if (ngx_iouring_aio_read(ev, file->fd, buf, size, offset) == NGX_OK) {
+            ev->active = 1;
+            ev->ready = 0;
+            ev->complete = 0;
+
+            return NGX_AGAIN;
+        }
+
+        return ngx_read_file(file, buf, size, offset);
+    }
+
+#endif
+
     ngx_memzero(&aio->aiocb, sizeof(struct iocb));
 
     aio->aiocb.aio_data = (uint64_t) (uintptr_t) ev;
@@ -0,0 +1,176 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+
+
+static void ngx_splice_pipe_cleanup(void *data);
+
+
+ngx_splice_pipe_t *
+ngx_splice_pipe(ngx_pool_t *pool, ngx_log_t *log)
+{
+    int                  n;
+    ngx_splice_pipe_t   *p;
+    ngx_pool_cleanup_t  *cln;
+
+    cln = ngx_pool_cleanup_add(pool, sizeof(ngx_splice_pipe_t));
+    if (cln == NULL) {
+        return NULL;
+    }
+
+    p = cln->data;
+
+    if (pipe2(p->fd, O_NONBLOCK|O_CLOEXEC) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, log, ngx_errno, "pipe2() failed");
+        return NULL;
+    }
+
+    cln->handler = ngx_splice_pipe_cleanup;
+
+    p->size = 0;
+    p->log = log;
+
+    n = fcntl(p->fd[0], F_GETPIPE_SZ);
+
+    p->capacity = (n > 0) ? (size_t) n : 65536;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, log, 0,
+                   "splice pipe: %d:%d %uz", p->fd[0], p->fd[1], p->capacity);
+
+    return p;
+}
+
+
+static void
+ngx_splice_pipe_cleanup(void *data)
+{
+    ngx_splice_pipe_t  *p = data;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_EVENT, p->log, 0,
+                   "splice pipe close: %d:%d", p->fd[0], p->fd[1]);
+
+    if (close(p->fd[0]) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, p->log, ngx_errno, "close() pipe failed");
+    }
+
+    if (close(p->fd[1]) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, p->log, ngx_errno, "close() pipe failed");
+    }
+}
+
+
+/*
+ * moves data from the socket into the pipe; EAGAIN may also mean
+ * that the pipe is full, so the socket is only marked as not ready
+ * if the pipe is empty, and short reads never reset readiness
+ */
+
+ssize_t
+ngx_splice_recv(ngx_connection_t *c, ngx_splice_pipe_t *p, size_t size)
+{
+    ssize_t       n;
+    ngx_err_t     err;
+    ngx_event_t  *rev;
+
+    rev = c->read;
+
+    for ( ;; ) {
+        n = splice(c->fd, NULL, p->fd[1], NULL, size,
+                   SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+
+        ngx_log_debug3(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "splice recv: fd:%d %z of %uz", c->fd, n, size);
+
+        if (n > 0) {
+            p->size += n;
+            return n;
+        }
+
+        if (n == 0) {
+            rev->ready = 0;
+            rev->eof = 1;
+            return 0;
+        }
+
+        err = ngx_socket_errno;
+
+        if (err == NGX_EINTR) {
+            continue;
+        }
+
+        if (err == NGX_EAGAIN) {
+            ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, err,
+                           "splice() not ready");
+
+            if (p->size == 0) {
+                rev->ready = 0;
+            }
+
+            return NGX_AGAIN;
+        }
+
+        rev->ready = 0;
+        rev->error = 1;
+
+        ngx_connection_error(c, err, "splice() from socket failed");
+
+        return NGX_ERROR;
+    }
+}
+
+
+ssize_t
+ngx_splice_send(ngx_connection_t *c, ngx_splice_pipe_t *p)
+{
+    ssize_t       n;
+    ngx_err_t     err;
+    ngx_event_t  *wev;
+
+    wev = c->write;
+
+    for ( ;; ) {
+        n = splice(p->fd[0], NULL, c->fd, NULL, p->size,
+                   SPLICE_F_MOVE|SPLICE_F_NONBLOCK);
+
+        ngx_log_debug3(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                       "splice send: fd:%d %z of %uz", c->fd, n, p->size);
+
+        if (n > 0) {
+            p->size -= n;
+            c->sent += n;
+
+            if (p->size) {
+                wev->ready = 0;
+            }
+
+            return n;
+        }
+
+        err = (n == 0) ? NGX_EAGAIN : ngx_socket_errno;
+
+        if (err == NGX_EINTR) {
+            continue;
+        }
+
+        if (err == NGX_EAGAIN) {
+            ngx_log_debug0(NGX_LOG_DEBUG_EVENT, c->log, err,
+                           "splice() not ready");
+
+            wev->ready = 0;
+            return NGX_AGAIN;
+        }
+
+        wev->error = 1;
+
+        ngx_connection_error(c, err, "splice() to socket failed");
+
+        return NGX_ERROR;
+    }
+}
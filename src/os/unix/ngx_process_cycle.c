@@ -765,8 +765,7 @@ ngx_worker_process_cycle(ngx_cycle_t *cycle, void *data)
 
             ngx_event_cancel_timers();
 
-            if (ngx_event_timer_rbtree.root == ngx_event_timer_rbtree.sentinel)
-            {
+            if (ngx_event_no_timers_left() == NGX_OK) {
                 ngx_log_error(NGX_LOG_NOTICE, cycle->log, 0, "exiting");
 
                 ngx_worker_process_exit(cycle);
@@ -48,6 +48,8 @@ typedef struct {
     /* server ctx */
     ngx_stream_conf_ctx_t  *ctx;
 
+    int                     type;
+
     unsigned                bind:1;
     unsigned                wildcard:1;
 #if (NGX_STREAM_SSL)
@@ -102,6 +104,7 @@ typedef struct {
 
 typedef struct {
     int                     family;
+    int                     type;
     in_port_t               port;
     ngx_array_t             addrs;       /* array of ngx_stream_conf_addr_t */
 } ngx_stream_conf_port_t;
@@ -19,9 +19,11 @@ typedef struct {
     ngx_msec_t                       next_upstream_timeout;
     size_t                           downstream_buf_size;
     size_t                           upstream_buf_size;
+    ngx_uint_t                       responses;
     ngx_uint_t                       next_upstream_tries;
     ngx_flag_t                       next_upstream;
     ngx_flag_t                       proxy_protocol;
+    ngx_flag_t                       splice;
     ngx_addr_t                      *local;
 
 #if (NGX_STREAM_SSL)
@@ -56,6 +58,10 @@ static void ngx_stream_proxy_connect_handler(ngx_event_t *ev);
 static ngx_int_t ngx_stream_proxy_test_connect(ngx_connection_t *c);
 static ngx_int_t ngx_stream_proxy_process(ngx_stream_session_t *s,
     ngx_uint_t from_upstream, ngx_uint_t do_write);
+#if (NGX_HAVE_SPLICE)
+static ngx_int_t ngx_stream_proxy_splice(ngx_stream_session_t *s,
+    ngx_uint_t from_upstream, ngx_uint_t do_write);
+#endif
 static void ngx_stream_proxy_next_upstream(ngx_stream_session_t *s);
 static void ngx_stream_proxy_finalize(ngx_stream_session_t *s, ngx_int_t rc);
 static u_char *ngx_stream_proxy_log_error(ngx_log_t *log, u_char *buf,
@@ -137,6 +143,13 @@ static ngx_command_t  ngx_stream_proxy_commands[] = {
       offsetof(ngx_stream_proxy_srv_conf_t, upstream_buf_size),
       NULL },
 
+    { ngx_string("proxy_responses"),
+      NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_STREAM_SRV_CONF_OFFSET,
+      offsetof(ngx_stream_proxy_srv_conf_t, responses),
+      NULL },
+
     { ngx_string("proxy_next_upstream"),
       NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_FLAG,
       ngx_conf_set_flag_slot,
@@ -165,6 +178,13 @@ static ngx_command_t  ngx_stream_proxy_commands[] = {
       offsetof(ngx_stream_proxy_srv_conf_t, proxy_protocol),
       NULL },
 
+    { ngx_string("proxy_splice"),
+      NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_STREAM_SRV_CONF_OFFSET,
+      offsetof(ngx_stream_proxy_srv_conf_t, splice),
+      NULL },
+
 #if (NGX_STREAM_SSL)
 
     { ngx_string("proxy_ssl"),
@@ -321,6 +341,7 @@ ngx_stream_proxy_handler(ngx_stream_session_t *s)
     u->peer.log_error = NGX_ERROR_ERR;
 
     u->peer.local = pscf->local;
+    u->peer.type = c->type;
 
     uscf = pscf->upstream;
 
@@ -337,7 +358,9 @@ ngx_stream_proxy_handler(ngx_stream_session_t *s)
         u->peer.tries = pscf->next_upstream_tries;
     }
 
-    u->proxy_protocol = pscf->proxy_protocol;
+    /* the PROXY protocol header cannot be sent over datagrams */
+
+    u->proxy_protocol = (c->type == SOCK_STREAM) ? pscf->proxy_protocol : 0;
 
     p = ngx_pnalloc(c->pool, pscf->downstream_buf_size);
     if (p == NULL) {
@@ -815,14 +838,28 @@ done:
 static void
 ngx_stream_proxy_downstream_handler(ngx_event_t *ev)
 {
-    ngx_connection_t       *c;
-    ngx_stream_session_t   *s;
-    ngx_stream_upstream_t  *u;
+    ngx_connection_t             *c;
+    ngx_stream_session_t         *s;
+    ngx_stream_upstream_t        *u;
+    ngx_stream_proxy_srv_conf_t  *pscf;
 
     c = ev->data;
     s = c->data;
 
     if (ev->timedout) {
+
+        if (c->type == SOCK_DGRAM) {
+            pscf = ngx_stream_get_module_srv_conf(s, ngx_stream_proxy_module);
+
+            if (pscf->responses == NGX_MAX_INT32_VALUE) {
+
+                /* no expected number of responses, the session is over */
+
+                ngx_stream_proxy_finalize(s, NGX_OK);
+                return;
+            }
+        }
+
         ngx_connection_error(c, NGX_ETIMEDOUT, "connection timed out");
         ngx_stream_proxy_finalize(s, NGX_DECLINED);
         return;
@@ -940,13 +977,18 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
     size_t                        size;
     ssize_t                       n;
     ngx_buf_t                    *b;
-    ngx_uint_t                    flags;
+    ngx_uint_t                    flags, sent, busy;
     ngx_connection_t             *c, *pc, *src, *dst;
     ngx_log_handler_pt            handler;
     ngx_stream_upstream_t        *u;
     ngx_stream_proxy_srv_conf_t  *pscf;
+#if (NGX_HAVE_SPLICE)
+    ngx_int_t                     rc;
+    ngx_splice_pipe_t            *p;
+#endif
 
     u = s->upstream;
+    sent = 0;
 
     c = s->connection;
     pc = u->upstream_buf.start ? u->peer.connection : NULL;
@@ -962,6 +1004,23 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
         b = &u->downstream_buf;
     }
 
+#if (NGX_HAVE_SPLICE)
+
+    if (dst && b->pos == b->last) {
+        rc = ngx_stream_proxy_splice(s, from_upstream, do_write);
+
+        if (rc == NGX_ERROR) {
+            ngx_stream_proxy_finalize(s, NGX_DECLINED);
+            return NGX_ERROR;
+        }
+
+        if (rc == NGX_OK) {
+            goto done;
+        }
+    }
+
+#endif
+
     for ( ;; ) {
 
         if (do_write) {
@@ -977,12 +1036,23 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
                     return NGX_ERROR;
                 }
 
+                if (n == NGX_AGAIN && dst->shared) {
+
+                    /* a datagram to the client cannot be queued, drop it */
+
+                    n = size;
+                }
+
                 if (n > 0) {
                     b->pos += n;
 
                     if (b->pos == b->last) {
                         b->pos = b->start;
                         b->last = b->start;
+
+                        if (dst->type == SOCK_DGRAM) {
+                            sent = 1;
+                        }
                     }
                 }
             }
@@ -990,6 +1060,12 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
 
         size = b->end - b->last;
 
+        /* keep datagram boundaries: receive only into an empty buffer */
+
+        if (src->type == SOCK_DGRAM && b->pos != b->last) {
+            size = 0;
+        }
+
         if (size && src->read->ready) {
 
             n = src->recv(src, b->last, size);
@@ -1002,6 +1078,10 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
                 if (from_upstream) {
                     u->received += n;
 
+                    if (src->type == SOCK_DGRAM) {
+                        u->responses++;
+                    }
+
                 } else {
                     s->received += n;
                 }
@@ -1019,9 +1099,44 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
         break;
     }
 
+#if (NGX_HAVE_SPLICE)
+done:
+#endif
+
+    busy = (b->pos != b->last);
+
+#if (NGX_HAVE_SPLICE)
+
+    p = from_upstream ? u->upstream_pipe : u->downstream_pipe;
+
+    if (p && p->size) {
+        busy = 1;
+    }
+
+#endif
+
     pscf = ngx_stream_get_module_srv_conf(s, ngx_stream_proxy_module);
 
-    if (src->read->eof && (b->pos == b->last || (dst && dst->read->eof))) {
+    if (c->type == SOCK_DGRAM && sent
+        && ((!from_upstream && pscf->responses == 0)
+            || (from_upstream && u->responses >= pscf->responses)))
+    {
+        handler = c->log->handler;
+        c->log->handler = NULL;
+
+        ngx_log_error(NGX_LOG_INFO, c->log, 0,
+                      "udp session done"
+                      ", bytes from/to client:%O/%O"
+                      ", bytes from/to upstream:%O/%O",
+                      s->received, c->sent, u->received, pc ? pc->sent : 0);
+
+        c->log->handler = handler;
+
+        ngx_stream_proxy_finalize(s, NGX_OK);
+        return NGX_DONE;
+    }
+
+    if (src->read->eof && (!busy || (dst && dst->read->eof))) {
         handler = c->log->handler;
         c->log->handler = NULL;
 
@@ -1040,13 +1155,13 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
 
     flags = src->read->eof ? NGX_CLOSE_EVENT : 0;
 
-    if (ngx_handle_read_event(src->read, flags) != NGX_OK) {
+    if (!src->shared && ngx_handle_read_event(src->read, flags) != NGX_OK) {
         ngx_stream_proxy_finalize(s, NGX_ERROR);
         return NGX_ERROR;
     }
 
     if (dst) {
-        if (ngx_handle_write_event(dst->write, 0) != NGX_OK) {
+        if (!dst->shared && ngx_handle_write_event(dst->write, 0) != NGX_OK) {
             ngx_stream_proxy_finalize(s, NGX_ERROR);
             return NGX_ERROR;
         }
@@ -1058,6 +1173,107 @@ ngx_stream_proxy_process(ngx_stream_session_t *s, ngx_uint_t from_upstream,
 }
 
 
+#if (NGX_HAVE_SPLICE)
+
+static ngx_int_t
+ngx_stream_proxy_splice(ngx_stream_session_t *s, ngx_uint_t from_upstream,
+    ngx_uint_t do_write)
+{
+    size_t                        size;
+    ssize_t                       n;
+    ngx_connection_t             *c, *pc, *src, *dst;
+    ngx_splice_pipe_t           **pp, *p;
+    ngx_stream_upstream_t        *u;
+    ngx_stream_proxy_srv_conf_t  *pscf;
+
+    pscf = ngx_stream_get_module_srv_conf(s, ngx_stream_proxy_module);
+
+    if (!pscf->splice) {
+        return NGX_DECLINED;
+    }
+
+    u = s->upstream;
+
+    c = s->connection;
+    pc = u->peer.connection;
+
+    if (c->type != SOCK_STREAM || pc->type != SOCK_STREAM) {
+        return NGX_DECLINED;
+    }
+
+#if (NGX_STREAM_SSL)
+    if (c->ssl || pc->ssl) {
+        return NGX_DECLINED;
+    }
+#endif
+
+    if (from_upstream) {
+        src = pc;
+        dst = c;
+        pp = &u->upstream_pipe;
+
+    } else {
+        src = c;
+        dst = pc;
+        pp = &u->downstream_pipe;
+    }
+
+    if (*pp == NULL) {
+        *pp = ngx_splice_pipe(c->pool, c->log);
+        if (*pp == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    p = *pp;
+
+    for ( ;; ) {
+
+        if (do_write && p->size && dst->write->ready) {
+
+            n = ngx_splice_send(dst, p);
+
+            if (n == NGX_ERROR) {
+                return NGX_ERROR;
+            }
+        }
+
+        size = p->capacity - p->size;
+
+        if (size && src->read->ready) {
+
+            n = ngx_splice_recv(src, p, size);
+
+            if (n == NGX_AGAIN || n == 0) {
+                break;
+            }
+
+            if (n > 0) {
+                if (from_upstream) {
+                    u->received += n;
+
+                } else {
+                    s->received += n;
+                }
+
+                do_write = 1;
+                continue;
+            }
+
+            if (n == NGX_ERROR) {
+                src->read->eof = 1;
+            }
+        }
+
+        break;
+    }
+
+    return NGX_OK;
+}
+
+#endif
+
+
 static void
 ngx_stream_proxy_next_upstream(ngx_stream_session_t *s)
 {
@@ -1215,9 +1431,11 @@ ngx_stream_proxy_create_srv_conf(ngx_conf_t *cf)
     conf->next_upstream_timeout = NGX_CONF_UNSET_MSEC;
     conf->downstream_buf_size = NGX_CONF_UNSET_SIZE;
     conf->upstream_buf_size = NGX_CONF_UNSET_SIZE;
+    conf->responses = NGX_CONF_UNSET_UINT;
     conf->next_upstream_tries = NGX_CONF_UNSET_UINT;
     conf->next_upstream = NGX_CONF_UNSET;
     conf->proxy_protocol = NGX_CONF_UNSET;
+    conf->splice = NGX_CONF_UNSET;
     conf->local = NGX_CONF_UNSET_PTR;
 
 #if (NGX_STREAM_SSL)
@@ -1254,6 +1472,9 @@ ngx_stream_proxy_merge_srv_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_conf_merge_size_value(conf->upstream_buf_size,
                               prev->upstream_buf_size, 16384);
 
+    ngx_conf_merge_uint_value(conf->responses,
+                              prev->responses, NGX_MAX_INT32_VALUE);
+
     ngx_conf_merge_uint_value(conf->next_upstream_tries,
                               prev->next_upstream_tries, 0);
 
@@ -1261,6 +1482,8 @@ ngx_stream_proxy_merge_srv_conf(ngx_conf_t *cf, void *parent, void *child)
 
     ngx_conf_merge_value(conf->proxy_protocol, prev->proxy_protocol, 0);
 
+    ngx_conf_merge_value(conf->splice, prev->splice, 0);
+
     ngx_conf_merge_ptr_value(conf->local, prev->local, NULL);
 
 #if (NGX_STREAM_SSL)
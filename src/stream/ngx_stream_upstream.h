@@ -82,7 +82,12 @@ typedef struct {
     ngx_peer_connection_t              peer;
     ngx_buf_t                          downstream_buf;
     ngx_buf_t                          upstream_buf;
+#if (NGX_HAVE_SPLICE)
+    ngx_splice_pipe_t                 *downstream_pipe;
+    ngx_splice_pipe_t                 *upstream_pipe;
+#endif
     off_t                              received;
+    ngx_uint_t                         responses;
 #if (NGX_STREAM_SSL)
     ngx_str_t                          ssl_name;
 #endif